@@ -11,25 +11,65 @@
 #include "PDVIObjectFactory.h"
 #include "PDVFile.h"
 #include "PDVITopo.h"
+#include "pdvgeometrycache.h"
+#include "pdvgltfwriter.h"
+#include "pdvloader.h"
+#include "pdvlod.h"
+#include "pdvmeshwriter.h"
+#include "pdvprofiler.h"
+#include "pdvsceneindex.h"
+#include "pdvsimplify.h"
+#include "pdvstlwriter.h"
+#include "pdvthreadpool.h"
+#include "pdvtransform.h"
 #include <fstream>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
 using namespace std;
 using namespace kernel::pdv;
 
-DftBool ConvertToStl(ISceneData* iSceneData, const CUnicodeString& iStlPath)
+namespace
 {
-    if (!iSceneData)
-        return FALSE;
 
-    // iSceneData->RevertBatchedAndInstanced();
+/** STL输出的工作单元：一个节点下的一个主体网格 */
+struct StlWorkItem
+{
+    PDVMatrix4F _worldTrans;         ///< 节点的世界变换
+    IRenderGeometry* _geometry;      ///< 网格几何
+    IRenderVertex* _vertex;          ///< 顶点数据
+    SimplifyTarget _target;          ///< 简化目标
+    size_t _node;                    ///< 所属节点在简化报告中的序号
+};
+
+/** 回收复用的编码缓冲区上限，更大的缓冲区写出后即释放，避免每个在编码中的单元都保留最大网格的容量 */
+const size_t STL_SPARE_BUFFER_LIMIT = 16 * 1024 * 1024;
+
+/** 工作单元编码后的STL数据 */
+struct StlWorkResult
+{
+    std::vector<DftByte> _data;      ///< 编码缓冲区，不超过STL_SPARE_BUFFER_LIMIT时回收复用
+    size_t _size;                    ///< 有效字节数
+    DftUInt64 _facetCount;           ///< 三角面数
+    DftFloat _error;                 ///< 简化误差
+
+    StlWorkResult() : _size(0), _facetCount(0), _error(0.0f) {}
+};
+
+// 按遍历顺序枚举所有主体网格并选择层级，同时按索引个数统计三角面数；需要简化时按节点的三角面总数确定每个几何的目标
+void CollectStlWorkItems(const CSceneIndex& iSceneIndex, const LodSelectOptions* iLod, const SimplifyOptions* iSimplify,
+    std::vector<StlWorkItem>& oItems, DftUInt64& oFacetCount, std::vector<NodeSimplifyReport>* oReports)
+{
+    oItems.clear();
+    oFacetCount = 0;
+    if (oReports)
+        oReports->clear();
 
     // 获取所有模型树节点，将其网格数据转换到stl文件中
-    ofstream ofStl(iStlPath.ToMultiByte());
-    ofStl << "solid block" << endl;
     std::vector<IModelTree*> modelTreeArray;
-    iSceneData->GetModelTreeArray(modelTreeArray);
-
+    iSceneIndex.GetSceneData()->GetModelTreeArray(modelTreeArray);
+    std::vector<LodMeshSelection> meshes;
     for (DftUInt t = 0; t < (DftUInt)modelTreeArray.size(); t++)
     {
         IModelTree* tree = modelTreeArray[t];
@@ -48,94 +88,198 @@ DftBool ConvertToStl(ISceneData* iSceneData, const CUnicodeString& iStlPath)
             if (!model)
                 continue;
 
-            IBRep* bRep = model->GetBRep(n);
-            IAttribute* attr = model->GetAttribute();
-            
             //升级3.0 zhangheng20250612
-            DftUInt renderBodyCount = model->GetRenderBodyCount();
-            if (renderBodyCount == 0)
+            if (model->GetRenderBodyCount() == 0)
                 continue;
-            CUnicodeString nodeName;
-            node->GetName(nodeName);
-            // 组
-            //ofObj << "g " << nodeName.ToMultiByte() << endl;
-            DftUInt64 tempRenderBodyID;
-            IRenderBody* tempRenderBody = NULL;
-            IRenderMesh* tempRenderMesh = NULL;
-            IRenderGeometry* tempRenderGeometry = NULL;
-            kernel::pdv::IRenderVertex* tempRenderVertex = NULL;
-            DftUInt64 tempRenderMeshID = DFT_INVALID_ID;
-            for (DftUInt i = 0; i < renderBodyCount; i++)
+            StlWorkItem item;
+            node->GetWorldTransform(item._worldTrans);
+            item._node = oReports ? oReports->size() : 0;
+            size_t firstItem = oItems.size();
+            DftUInt64 nodeFacetCount = 0;
+            SelectModelGeometries(iSceneIndex, model, iLod, meshes);
+            for (size_t j = 0; j < meshes.size(); j++)
+            {
+                item._geometry = meshes[j]._geometry;
+                item._vertex = meshes[j]._vertex;
+                oItems.push_back(item);
+                nodeFacetCount += item._geometry->GetIndexCount() / 3;
+            }
+            oFacetCount += nodeFacetCount;
+            if (oReports)
             {
-                tempRenderBodyID = model->GetRenderBodyID(i);
-                tempRenderBody = iSceneData->FindRenderBodyByID(tempRenderBodyID);
-                std::vector<DftUInt64> faceMeshIDs;
-                tempRenderBody->GetFaceMeshIDs(faceMeshIDs);
-
-                for (DftUInt j = 0; j < faceMeshIDs.size(); j++)
-                {
-                    tempRenderMesh = iSceneData->FindRenderMeshByID(faceMeshIDs[j]);
-                    if (tempRenderMesh->GetType() != RENDER_MESH_TYPE_MAIN)
-                        continue;
-
-                    tempRenderMeshID = tempRenderMesh->GetID();
-                    tempRenderGeometry = iSceneData->FindRenderGeometryByID(tempRenderMesh->GetFirstRenderGeometryID());
-                    tempRenderVertex = iSceneData->FindRenderVertexByID(tempRenderGeometry->GetVertexID());
-
-                    std::vector<kernel::pdv::VertexData> tempVertexData;
-                    tempRenderVertex->GetVertexes(tempVertexData);
-
-                    std::vector<PDVVector3F> coords;
-                    std::vector<PDVVector3F> normals;
-                    std::vector<DftUInt> vecOfIndex;
-
-                    for (DftUInt v = 0; v < tempVertexData.size(); v++)
-                    {
-                        coords.push_back(tempVertexData[v]._position);
-                        normals.push_back(tempVertexData[v]._normal);
-                    }
-                    tempRenderGeometry->GetIndexes(vecOfIndex);
-
-                    PDVMatrix4F worldTrans;
-                    node->GetWorldTransform(worldTrans);
-                    DftUInt triangleCount = (DftUInt)vecOfIndex.size() / 3;
-                    for (DftUInt c = 0; c < triangleCount; c++)
-                    {
-                        PDVVector3F worldNormal, worldP1, worldP2, worldP3;
-                        DftStatus status = DftTransformVector3F(normals[vecOfIndex[c * 3]], worldTrans._data, worldNormal);
-                        status = DftTransformPoint3F(coords[vecOfIndex[c * 3]], worldTrans._data, worldP1);
-                        status = DftTransformPoint3F(coords[vecOfIndex[c * 3 + 1]], worldTrans._data, worldP2);
-                        status = DftTransformPoint3F(coords[vecOfIndex[c * 3 + 2]], worldTrans._data, worldP3);
-                        ofStl << "   facet normal " << worldNormal.x() << " " << worldNormal.y() << " " << worldNormal.z() << endl;
-                        ofStl << "      outer loop" << endl;
-                        ofStl << "         vertex " << worldP1.x() << " " << worldP1.y() << " " << worldP1.z() << endl;
-                        ofStl << "         vertex " << worldP2.x() << " " << worldP2.y() << " " << worldP2.z() << endl;
-                        ofStl << "         vertex " << worldP3.x() << " " << worldP3.y() << " " << worldP3.z() << endl;
-                        ofStl << "      endloop" << endl;
-                        ofStl << "   endfacet" << endl;
-                    }
-                }
+                NodeSimplifyReport report;
+                report._nodeID = node->GetID();
+                CUnicodeString name;
+                if (node->GetName(name) == PDV_RESULT_NO_ERROR)
+                    report._name = name.ToMultiByte();
+                report._sourceTriangles = nodeFacetCount;
+                oReports->push_back(report);
             }
+            if (!iSimplify)
+                continue;
+            for (size_t k = firstItem; k < oItems.size(); k++)
+                oItems[k]._target = GetSimplifyTarget(*iSimplify, oItems[k]._geometry->GetIndexCount() / 3, nodeFacetCount);
         }
     }
+    if (!iSimplify)
+        return;
+
+    // 多个节点引用同一几何时取最小的目标，缓存中每个几何只简化一次，结果与线程数无关
+    std::unordered_map<DftUInt64, DftUInt> targets;
+    for (size_t k = 0; k < oItems.size(); k++)
+    {
+        std::pair<std::unordered_map<DftUInt64, DftUInt>::iterator, bool> inserted =
+            targets.insert(std::make_pair(oItems[k]._geometry->GetID(), oItems[k]._target._triangles));
+        if (!inserted.second && oItems[k]._target._triangles < inserted.first->second)
+            inserted.first->second = oItems[k]._target._triangles;
+    }
+    for (size_t k = 0; k < oItems.size(); k++)
+        oItems[k]._target._triangles = targets[oItems[k]._geometry->GetID()];
+}
+
+// 按遍历顺序累计节点的简化结果
+void AddToReport(const StlWorkItem& iItem, const StlWorkResult& iResult, std::vector<NodeSimplifyReport>* ioReports)
+{
+    if (!ioReports)
+        return;
+    NodeSimplifyReport& report = (*ioReports)[iItem._node];
+    report._resultTriangles += iResult._facetCount;
+    if (iResult._error > report._error)
+        report._error = iResult._error;
+}
+
+// 变换并编码一个工作单元，渲染几何数据经缓存获取，未命中时在iSceneMutex内串行读取
+void EncodeStlWorkItem(const StlWorkItem& iItem, StlFormat iFormat, CGeometryCache& ioCache, std::mutex& iSceneMutex,
+    StlWorkResult& oResult)
+{
+    static thread_local TransformedVertexes worldVertexes;
+
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_SERIALIZE);
+    oResult._size = 0;
+    oResult._facetCount = 0;
+    oResult._error = 0.0f;
+    CachedGeometryPtr geometry = ioCache.Get(iItem._geometry, iItem._vertex, &iSceneMutex, &iItem._target);
+    if (!geometry)
+        return;
+    oResult._error = geometry->_error;
+    const std::vector<DftUInt>& vecOfIndex = geometry->_indexes;
+
+    // 每个实例只做变换，每个顶点只变换一次，三角面按索引取变换结果
+    TransformVertexes(geometry->GetPositions(), geometry->GetNormals(), iItem._worldTrans, worldVertexes);
+    DftUInt triangleCount = (DftUInt)vecOfIndex.size() / 3;
+    size_t capacity = (size_t)triangleCount * GetStlFacetMaxSize(iFormat);
+    if (oResult._data.size() < capacity)
+        oResult._data.resize(capacity);
+    for (DftUInt c = 0; c < triangleCount; c++)
+    {
+        const DftUInt* tri = &vecOfIndex[c * 3];
+        oResult._size += EncodeStlFacet(iFormat, worldVertexes.Normal(tri[0]), worldVertexes.Position(tri[0]),
+            worldVertexes.Position(tri[1]), worldVertexes.Position(tri[2]), &oResult._data[oResult._size]);
+    }
+    oResult._facetCount = triangleCount;
+    PDV_PROFILE_COUNT(PROFILE_COUNTER_TRIANGLES, triangleCount);
+}
+
+} // namespace
+
+/**
+ * @brief 将场景中所有主体网格输出为STL文件
+ * @return DftBool 是否成功
+ * @param[in] iSceneData 场景数据
+ * @param[in] iStlPath STL文件路径
+ * @param[in] iFormat STL格式
+ * @param[in] iThreadCount 编码线程数，为0时取CPU逻辑核数，为1时在当前线程中执行；输出与线程数无关，逐字节一致
+ * @param[in,out] ioCache 渲染几何缓存，只能在同一场景数据上复用，为NULL时使用默认内存上限的临时缓存
+ * @param[in] iSimplify 简化参数，为NULL时输出原网格；简化在编码线程中按几何并行进行
+ * @param[out] oReports 每个零件节点的简化结果，按遍历顺序排列，可为NULL
+ * @param[in] iLod LOD选择参数，为NULL时输出每个网格的第一个渲染几何；简化在选中的层级上进行
+ */
+DftBool ConvertToStl(ISceneData* iSceneData, const CUnicodeString& iStlPath, StlFormat iFormat = STL_FORMAT_ASCII,
+    DftUInt iThreadCount = 0, CGeometryCache* ioCache = NULL, const SimplifyOptions* iSimplify = NULL,
+    std::vector<NodeSimplifyReport>* oReports = NULL, const LodSelectOptions* iLod = NULL)
+{
+    if (!iSceneData)
+        return FALSE;
+
+    CGeometryCache localCache;
+    CGeometryCache& cache = ioCache ? *ioCache : localCache;
+
+    // iSceneData->RevertBatchedAndInstanced();
+
+    // 二进制格式需要在文件头写入三角面数，枚举工作单元时按索引个数统计，简化后的实际面数在关闭时回写
+    std::vector<StlWorkItem> items;
+    DftUInt64 facetCount = 0;
+    if (iSimplify && !iSimplify->IsEnabled())
+        iSimplify = NULL;
+    CollectStlWorkItems(CSceneIndex(iSceneData), iLod, iSimplify, items, facetCount, oReports);
+
+    IStlWriter* stlWriter = CreateStlWriter(iFormat);
+    if (!stlWriter->Open(iStlPath.ToMultiByte(), "block", facetCount))
+    {
+        SAFE_DELETE(stlWriter);
+        return FALSE;
+    }
+
+    // 各单元并行编码，按遍历顺序写出；写出后的编码缓冲区回收给之后交给线程的单元
+    std::mutex sceneMutex;
+    std::vector<StlWorkResult> results(items.size());
+    std::vector<std::vector<DftByte> > spareBuffers;
+    RunOrdered(iThreadCount, items.size(), 4,
+        [&](size_t index) { EncodeStlWorkItem(items[index], iFormat, cache, sceneMutex, results[index]); },
+        [&](size_t index) {
+            StlWorkResult& result = results[index];
+            stlWriter->AddEncodedFacets(result._size > 0 ? &result._data[0] : NULL, result._size, result._facetCount);
+            AddToReport(items[index], result, oReports);
+            if (result._data.size() <= STL_SPARE_BUFFER_LIMIT)
+            {
+                spareBuffers.push_back(std::vector<DftByte>());
+                spareBuffers.back().swap(result._data);
+            }
+            else
+                std::vector<DftByte>().swap(result._data);
+            return true;
+        },
+        [&](size_t index) {
+            if (spareBuffers.empty())
+                return;
+            results[index]._data.swap(spareBuffers.back());
+            spareBuffers.pop_back();
+        });
 
-    ofStl << "endsolid" << endl;
+    DftBool result = stlWriter->Close();
+    SAFE_DELETE(stlWriter);
 
-    return TRUE;
+    return result;
 }
 
-DftBool Convert(const CUnicodeString& iPdvPath, const CUnicodeString& iStlPath)
+DftBool Convert(const CUnicodeString& iPdvPath, const CUnicodeString& iStlPath, StlFormat iFormat = STL_FORMAT_ASCII,
+    DftUInt iThreadCount = 0)
 {
     IObjectFactory* piObjectFactory = IObjectFactory::GetObjectFactory();
     if (!piObjectFactory)
         return FALSE;
+    CMappedFile mapping;
     ISceneData* sceneData = NULL;
     PDV_RESULT res = piObjectFactory->CreateSceneData(sceneData);
-    if (!sceneData)
+    if (res != PDV_RESULT_NO_ERROR || !sceneData)
         return FALSE;
-    res = PDVFileServices::LoadSceneData(sceneData, iPdvPath);
+    res = LoadSceneDataMapped(sceneData, iPdvPath, mapping);
+    if (res != PDV_RESULT_NO_ERROR)
+    {
+        sceneData->Release();
+        return FALSE;
+    }
 
-    DftBool result = ConvertToStl(sceneData, iStlPath);
+    // 输出路径为.ply、.obj时按节点分组输出带索引的网格，为.glb时输出glTF，否则输出STL
+    DftBool result;
+    MeshFormat meshFormat;
+    std::string outputPath = iStlPath.ToMultiByte();
+    if (IsGlbPath(outputPath))
+        result = ExportSceneGlb(sceneData, outputPath);
+    else if (GetMeshFormatFromPath(outputPath, meshFormat))
+        result = ExportSceneMesh(sceneData, outputPath, meshFormat);
+    else
+        result = ConvertToStl(sceneData, iStlPath, iFormat, iThreadCount);
     // 释放内存
     sceneData->Release();
     sceneData = NULL;
@@ -0,0 +1,333 @@
+#include "pdvbatch.h"
+#include "PDVISceneData.h"
+#include "PDVIObjectFactory.h"
+#include "PDVFile.h"
+#include "pdvloader.h"
+#include "pdvprofiler.h"
+#include "pdvthreadpool.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <dirent.h>
+#endif
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+#ifdef _WIN32
+const char PATH_SEPARATOR = '\\';
+#else
+const char PATH_SEPARATOR = '/';
+#endif
+
+// 预读的文件内容
+struct PrefetchedFile
+{
+    size_t _index;         ///< 任务序号
+    bool _read;            ///< 是否读取成功
+    DftDouble _seconds;    ///< 读取耗时
+    vector<DftByte> _data; ///< 文件内容
+};
+
+// 有界的预读队列，预读线程写入，工作线程取出
+class CPrefetchQueue
+{
+public:
+    explicit CPrefetchQueue(size_t iCapacity) : m_Capacity(iCapacity), m_Finished(false) {}
+
+    void Push(PrefetchedFile& ioFile)
+    {
+        unique_lock<mutex> lock(m_Mutex);
+        m_NotFull.wait(lock, [this] { return m_Files.size() < m_Capacity; });
+        m_Files.push_back(std::move(ioFile));
+        m_NotEmpty.notify_one();
+    }
+
+    void Finish()
+    {
+        lock_guard<mutex> lock(m_Mutex);
+        m_Finished = true;
+        m_NotEmpty.notify_all();
+    }
+
+    // 队列为空且预读结束时返回false
+    bool Pop(PrefetchedFile& oFile)
+    {
+        unique_lock<mutex> lock(m_Mutex);
+        m_NotEmpty.wait(lock, [this] { return !m_Files.empty() || m_Finished; });
+        if (m_Files.empty())
+            return false;
+        oFile = std::move(m_Files.front());
+        m_Files.pop_front();
+        m_NotFull.notify_one();
+        return true;
+    }
+
+private:
+    size_t m_Capacity;
+    bool m_Finished;
+    deque<PrefetchedFile> m_Files;
+    mutex m_Mutex;
+    condition_variable m_NotEmpty;
+    condition_variable m_NotFull;
+};
+
+DftDouble SecondsSince(const chrono::steady_clock::time_point& iStart)
+{
+    return chrono::duration<DftDouble>(chrono::steady_clock::now() - iStart).count();
+}
+
+// 读取整个文件
+bool ReadFileBytes(const string& iPath, vector<DftByte>& oData)
+{
+    ifstream file(iPath.c_str(), ios::binary | ios::ate);
+    if (!file.is_open())
+        return false;
+    streamoff size = file.tellg();
+    if (size <= 0)
+        return false;
+    oData.resize(static_cast<size_t>(size));
+    file.seekg(0, ios::beg);
+    return file.read(reinterpret_cast<char*>(&oData[0]), size) ? true : false;
+}
+
+// 处理一个文件：解析、导出，并清空场景数据供下一个文件使用
+void ConvertFile(ISceneData* iSceneData, const BatchJob& iJob, PrefetchedFile& ioFile, const BatchExportFunc& iExport,
+    BatchFileResult& oResult)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    CMappedFile mapping;
+    PDV_RESULT res;
+    if (ioFile._read)
+    {
+        PDV_PROFILE_SCOPE(PROFILE_PHASE_LOAD);
+        oResult._bytes = ioFile._data.size();
+        res = PDVFileServices::LoadSceneData(iSceneData, &ioFile._data[0], static_cast<DftLong64>(ioFile._data.size()));
+    }
+    else
+    {
+        // 预读失败时按路径加载，由库给出具体错误
+        LoadStatistics stats;
+        res = LoadSceneDataMapped(iSceneData, CUnicodeString(iJob._inputPath.c_str()), mapping, &stats);
+        oResult._bytes = stats._bytes;
+    }
+    oResult._loadSeconds = SecondsSince(start);
+
+    if (res != PDV_RESULT_NO_ERROR)
+    {
+        ostringstream error;
+        error << "load failed (" << res << ")";
+        oResult._error = error.str();
+    }
+    else
+    {
+        start = chrono::steady_clock::now();
+        try
+        {
+            oResult._success = iExport(iSceneData, iJob) ? true : false;
+            if (!oResult._success)
+                oResult._error = "export failed";
+        }
+        catch (const exception& e)
+        {
+            oResult._error = string("export exception: ") + e.what();
+        }
+        catch (...)
+        {
+            oResult._error = "export exception";
+        }
+        oResult._exportSeconds = SecondsSince(start);
+    }
+
+    // 数据流重载不保证解析后不再引用输入，预读的数据和映射都在清空场景数据之后才释放
+    iSceneData->Clear();
+    vector<DftByte>().swap(ioFile._data);
+}
+
+// CSV字段转义
+string EscapeCsv(const string& iText)
+{
+    if (iText.find_first_of(",\"\r\n") == string::npos)
+        return iText;
+    string escaped = "\"";
+    for (size_t i = 0; i < iText.size(); i++)
+    {
+        if (iText[i] == '"')
+            escaped += '"';
+        escaped += iText[i];
+    }
+    escaped += '"';
+    return escaped;
+}
+
+bool HasPdvExtension(const string& iName)
+{
+    if (iName.size() < 4)
+        return false;
+    string ext = iName.substr(iName.size() - 4);
+    transform(ext.begin(), ext.end(), ext.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+    return ext == ".pdv";
+}
+
+} // namespace
+
+CBatchConverter::CBatchConverter(DftUInt iWorkerCount, DftUInt iPrefetchDepth)
+    : m_WorkerCount(CThreadPool::ResolveThreadCount(iWorkerCount))
+    , m_PrefetchDepth(iPrefetchDepth ? iPrefetchDepth : m_WorkerCount)
+{
+}
+
+DftBool CBatchConverter::Run(const vector<BatchJob>& iJobs, const BatchExportFunc& iExport, vector<BatchFileResult>& oResults)
+{
+    oResults.assign(iJobs.size(), BatchFileResult());
+    for (size_t i = 0; i < iJobs.size(); i++)
+        oResults[i]._inputPath = iJobs[i]._inputPath;
+    if (iJobs.empty())
+        return TRUE;
+
+    // 场景数据在主线程中创建，每个工作线程独占一个
+    IObjectFactory* piObjectFactory = IObjectFactory::GetObjectFactory();
+    if (!piObjectFactory)
+        return FALSE;
+    DftUInt workerCount = static_cast<DftUInt>(min<size_t>(m_WorkerCount, iJobs.size()));
+    vector<ISceneData*> sceneDatas;
+    for (DftUInt i = 0; i < workerCount; i++)
+    {
+        ISceneData* sceneData = NULL;
+        piObjectFactory->CreateSceneData(sceneData);
+        if (!sceneData)
+            break;
+        sceneDatas.push_back(sceneData);
+    }
+    if (sceneDatas.empty())
+        return FALSE;
+
+    CPrefetchQueue queue(m_PrefetchDepth);
+    thread prefetcher([&iJobs, &queue] {
+        for (size_t i = 0; i < iJobs.size(); i++)
+        {
+            PrefetchedFile file;
+            file._index = i;
+            chrono::steady_clock::time_point start = chrono::steady_clock::now();
+            file._read = ReadFileBytes(iJobs[i]._inputPath, file._data);
+            file._seconds = SecondsSince(start);
+            queue.Push(file);
+        }
+        queue.Finish();
+    });
+
+    // 每个结果只由处理该文件的工作线程写入
+    vector<thread> workers;
+    for (size_t w = 0; w < sceneDatas.size(); w++)
+    {
+        workers.push_back(thread([&, w] {
+            PrefetchedFile file;
+            while (queue.Pop(file))
+            {
+                BatchFileResult& result = oResults[file._index];
+                result._worker = static_cast<DftUInt>(w);
+                result._readSeconds = file._seconds;
+                ConvertFile(sceneDatas[w], iJobs[file._index], file, iExport, result);
+            }
+        }));
+    }
+
+    prefetcher.join();
+    for (size_t w = 0; w < workers.size(); w++)
+        workers[w].join();
+
+    for (size_t w = 0; w < sceneDatas.size(); w++)
+        sceneDatas[w]->Release();
+    return TRUE;
+}
+
+DftBool ListPdvFiles(const string& iDirectory, vector<string>& oFiles)
+{
+    oFiles.clear();
+#ifdef _WIN32
+    WIN32_FIND_DATAA findData;
+    HANDLE find = FindFirstFileA((iDirectory + PATH_SEPARATOR + "*.pdv").c_str(), &findData);
+    if (find == INVALID_HANDLE_VALUE)
+        return GetLastError() == ERROR_FILE_NOT_FOUND ? TRUE : FALSE;
+    do
+    {
+        if (!(findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && HasPdvExtension(findData.cFileName))
+            oFiles.push_back(iDirectory + PATH_SEPARATOR + findData.cFileName);
+    } while (FindNextFileA(find, &findData));
+    FindClose(find);
+#else
+    DIR* dir = opendir(iDirectory.c_str());
+    if (!dir)
+        return FALSE;
+    while (dirent* entry = readdir(dir))
+    {
+        if (entry->d_type != DT_DIR && HasPdvExtension(entry->d_name))
+            oFiles.push_back(iDirectory + PATH_SEPARATOR + entry->d_name);
+    }
+    closedir(dir);
+#endif
+    sort(oFiles.begin(), oFiles.end());
+    return TRUE;
+}
+
+DftBool ReadBatchManifest(const string& iManifestPath, vector<string>& oFiles)
+{
+    oFiles.clear();
+    ifstream manifest(iManifestPath.c_str());
+    if (!manifest.is_open())
+        return FALSE;
+
+    string line;
+    while (getline(manifest, line))
+    {
+        size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == string::npos || line[begin] == '#')
+            continue;
+        size_t end = line.find_last_not_of(" \t\r");
+        oFiles.push_back(line.substr(begin, end - begin + 1));
+    }
+    return TRUE;
+}
+
+string GetFileStem(const string& iPath)
+{
+    size_t slash = iPath.find_last_of("\\/");
+    string name = slash == string::npos ? iPath : iPath.substr(slash + 1);
+    size_t dot = name.find_last_of('.');
+    return dot == string::npos || dot == 0 ? name : name.substr(0, dot);
+}
+
+DftBool WriteBatchSummary(const vector<BatchFileResult>& iResults, const string& iReportPath)
+{
+    ofstream report(iReportPath.c_str());
+    if (!report.is_open())
+        return FALSE;
+
+    report << "File,Status,Worker,Bytes,ReadSeconds,LoadSeconds,ExportSeconds,Error\n";
+    for (size_t i = 0; i < iResults.size(); i++)
+    {
+        const BatchFileResult& result = iResults[i];
+        report << EscapeCsv(result._inputPath) << ","
+            << (result._success ? "OK" : "FAILED") << ","
+            << result._worker << ","
+            << result._bytes << ","
+            << result._readSeconds << ","
+            << result._loadSeconds << ","
+            << result._exportSeconds << ","
+            << EscapeCsv(result._error) << "\n";
+    }
+    return report.good() ? TRUE : FALSE;
+}
@@ -0,0 +1,119 @@
+/**
+ * @file pdvbatch.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：pdv文件批量转换
+ * @details 一个进程内用多个工作线程转换大量pdv文件。每个工作线程创建一个场景数据并在文件之间用Clear()复用，
+ *          不再反复创建和释放；预读线程把后续文件的内容读入有界队列，工作线程导出当前文件时下一个文件已在内存中。
+ *          每个文件的读取、解析、导出耗时和失败原因汇总到报告中。
+ */
+
+#ifndef PDVBATCH_H
+#define PDVBATCH_H
+
+#include "DftBase.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+class ISceneData;
+} // namespace pdv
+} // namespace kernel
+
+/** @brief 一个转换任务 */
+struct BatchJob
+{
+    std::string _inputPath; ///< pdv文件路径
+    std::string _outputDir; ///< 输出目录
+};
+
+/** @brief 一个文件的转换结果 */
+struct BatchFileResult
+{
+    std::string _inputPath;   ///< pdv文件路径
+    bool _success;            ///< 是否成功
+    DftUInt _worker;          ///< 处理该文件的工作线程序号
+    DftUInt64 _bytes;         ///< 文件长度
+    DftDouble _readSeconds;   ///< 预读耗时
+    DftDouble _loadSeconds;   ///< 解析耗时
+    DftDouble _exportSeconds; ///< 导出耗时
+    std::string _error;       ///< 失败原因
+
+    BatchFileResult()
+        : _success(false), _worker(0), _bytes(0), _readSeconds(0.0), _loadSeconds(0.0), _exportSeconds(0.0) {}
+};
+
+/**
+ * @brief 导出函数，在工作线程中调用，同一工作线程的调用不会并发
+ * @return DftBool 是否成功
+ * @param[in] iSceneData 已加载的场景数据
+ * @param[in] iJob 转换任务
+ */
+typedef std::function<DftBool(kernel::pdv::ISceneData* iSceneData, const BatchJob& iJob)> BatchExportFunc;
+
+/** @brief 批量转换 */
+class CBatchConverter
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] iWorkerCount 工作线程数，为0时取CPU逻辑核数
+     * @param[in] iPrefetchDepth 预读队列长度，为0时与工作线程数相同
+     */
+    explicit CBatchConverter(DftUInt iWorkerCount = 0, DftUInt iPrefetchDepth = 0);
+
+    /**
+     * @brief 转换所有任务
+     * @return DftBool 场景数据全部创建失败时为FALSE，单个文件失败只记录在结果中
+     * @param[in] iJobs 转换任务
+     * @param[in] iExport 导出函数
+     * @param[out] oResults 转换结果，与任务一一对应
+     */
+    DftBool Run(const std::vector<BatchJob>& iJobs, const BatchExportFunc& iExport, std::vector<BatchFileResult>& oResults);
+
+    /** @brief 工作线程数 */
+    DftUInt GetWorkerCount() const { return m_WorkerCount; }
+    /** @brief 预读队列长度 */
+    DftUInt GetPrefetchDepth() const { return m_PrefetchDepth; }
+
+private:
+    DftUInt m_WorkerCount;   ///< 工作线程数
+    DftUInt m_PrefetchDepth; ///< 预读队列长度
+};
+
+/**
+ * @brief 列出目录下的pdv文件（不含子目录），按路径排序
+ * @return DftBool 目录是否可以访问
+ * @param[in] iDirectory 目录
+ * @param[out] oFiles 文件路径
+ */
+DftBool ListPdvFiles(const std::string& iDirectory, std::vector<std::string>& oFiles);
+
+/**
+ * @brief 读取清单文件，每行一个pdv文件路径，忽略空行和以#开头的行
+ * @return DftBool 清单是否可以读取
+ * @param[in] iManifestPath 清单文件
+ * @param[out] oFiles 文件路径
+ */
+DftBool ReadBatchManifest(const std::string& iManifestPath, std::vector<std::string>& oFiles);
+
+/**
+ * @brief 取文件名中不含扩展名的部分
+ * @return std::string 文件名
+ * @param[in] iPath 文件路径
+ */
+std::string GetFileStem(const std::string& iPath);
+
+/**
+ * @brief 把转换结果写成CSV报告
+ * @return DftBool 是否成功
+ * @param[in] iResults 转换结果
+ * @param[in] iReportPath 报告路径
+ */
+DftBool WriteBatchSummary(const std::vector<BatchFileResult>& iResults, const std::string& iReportPath);
+
+#endif
@@ -0,0 +1,354 @@
+#include "pdvbench.h"
+#include "pdvmemscene.h"
+#include "pdvtextformat.h"
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <dirent.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+#ifdef _WIN32
+const char PATH_SEPARATOR = '\\';
+#else
+const char PATH_SEPARATOR = '/';
+#endif
+
+#ifdef PDV_BENCH_COUNT_ALLOCATIONS
+// 静态初始化之前也可能分配内存，计数器必须是常量初始化的
+atomic<DftUInt64> g_AllocationCount(0);
+atomic<DftUInt64> g_AllocatedBytes(0);
+#endif
+
+DftBool MakeDirectory(const string& iPath)
+{
+#ifdef _WIN32
+    return CreateDirectoryA(iPath.c_str(), NULL) || GetLastError() == ERROR_ALREADY_EXISTS ? TRUE : FALSE;
+#else
+    return mkdir(iPath.c_str(), 0755) == 0 || errno == EEXIST ? TRUE : FALSE;
+#endif
+}
+
+// 目录下所有文件的总字节数，包含子目录
+DftUInt64 GetDirectorySize(const string& iPath)
+{
+    DftUInt64 size = 0;
+#ifdef _WIN32
+    WIN32_FIND_DATAA findData;
+    HANDLE find = FindFirstFileA((iPath + PATH_SEPARATOR + "*").c_str(), &findData);
+    if (find == INVALID_HANDLE_VALUE)
+        return 0;
+    do
+    {
+        string name = findData.cFileName;
+        if (name == "." || name == "..")
+            continue;
+        if (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            size += GetDirectorySize(iPath + PATH_SEPARATOR + name);
+        else
+            size += (static_cast<DftUInt64>(findData.nFileSizeHigh) << 32) | findData.nFileSizeLow;
+    } while (FindNextFileA(find, &findData));
+    FindClose(find);
+#else
+    DIR* dir = opendir(iPath.c_str());
+    if (!dir)
+        return 0;
+    while (dirent* entry = readdir(dir))
+    {
+        string name = entry->d_name;
+        if (name == "." || name == "..")
+            continue;
+        string path = iPath + PATH_SEPARATOR + name;
+        struct stat info;
+        if (stat(path.c_str(), &info) != 0)
+            continue;
+        if (S_ISDIR(info.st_mode))
+            size += GetDirectorySize(path);
+        else
+            size += static_cast<DftUInt64>(info.st_size);
+    }
+    closedir(dir);
+#endif
+    return size;
+}
+
+void AppendJsonField(CTextWriter& ioWriter, const char* iName, DftUInt64 iValue)
+{
+    ioWriter.Append(",\n      ").AppendQuoted(iName).Append(": ").AppendUInt(iValue);
+}
+
+void AppendJsonField(CTextWriter& ioWriter, const char* iName, DftDouble iValue)
+{
+    ioWriter.Append(",\n      ").AppendQuoted(iName).Append(": ").AppendFixed(iValue);
+}
+
+void AppendJsonNull(CTextWriter& ioWriter, const char* iName)
+{
+    ioWriter.Append(",\n      ").AppendQuoted(iName).Append(": null");
+}
+
+} // namespace
+
+#ifdef PDV_BENCH_COUNT_ALLOCATIONS
+// 替换全局分配函数以统计分配次数；数组和nothrow版本默认转调operator new(size_t)，
+// 释放函数全部替换，保证与malloc配对
+void* operator new(size_t iSize)
+{
+    g_AllocationCount.fetch_add(1, memory_order_relaxed);
+    g_AllocatedBytes.fetch_add(iSize, memory_order_relaxed);
+    void* memory = malloc(iSize ? iSize : 1);
+    if (!memory)
+        throw bad_alloc();
+    return memory;
+}
+
+void operator delete(void* iMemory) noexcept
+{
+    free(iMemory);
+}
+
+void operator delete(void* iMemory, size_t /*iSize*/) noexcept
+{
+    free(iMemory);
+}
+
+void operator delete[](void* iMemory) noexcept
+{
+    free(iMemory);
+}
+
+void operator delete[](void* iMemory, size_t /*iSize*/) noexcept
+{
+    free(iMemory);
+}
+
+DftBool IsBenchAllocationCounted()
+{
+    return TRUE;
+}
+
+DftUInt64 GetBenchAllocationCount()
+{
+    return g_AllocationCount.load(memory_order_relaxed);
+}
+
+DftUInt64 GetBenchAllocatedBytes()
+{
+    return g_AllocatedBytes.load(memory_order_relaxed);
+}
+#else
+DftBool IsBenchAllocationCounted()
+{
+    return FALSE;
+}
+
+DftUInt64 GetBenchAllocationCount()
+{
+    return 0;
+}
+
+DftUInt64 GetBenchAllocatedBytes()
+{
+    return 0;
+}
+#endif
+
+DftUInt64 GetPeakResidentBytes()
+{
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+        return 0;
+    return counters.PeakWorkingSetSize;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0)
+        return 0;
+    return static_cast<DftUInt64>(usage.ru_maxrss) * 1024; // Linux下单位为KB
+#endif
+}
+
+SceneGenOptions GetBenchSceneOptions(BenchSceneSize iSize)
+{
+    SceneGenOptions options;
+    options._fanOut = 10;
+    options._attributeCount = 4;
+    options._seed = 20261018;
+    switch (iSize)
+    {
+    case BENCH_SCENE_SMALL:
+        options._depth = 2;
+        options._trianglesPerPart = 500;
+        options._instancingRatio = 0.0;
+        break;
+    case BENCH_SCENE_MEDIUM:
+        options._depth = 4;
+        options._trianglesPerPart = 200;
+        options._instancingRatio = 0.5;
+        break;
+    default:
+        options._depth = 5;
+        options._trianglesPerPart = 100;
+        options._instancingRatio = 0.95;
+        break;
+    }
+    return options;
+}
+
+const char* GetBenchSceneName(BenchSceneSize iSize)
+{
+    switch (iSize)
+    {
+    case BENCH_SCENE_SMALL:
+        return "small";
+    case BENCH_SCENE_MEDIUM:
+        return "medium";
+    default:
+        return "huge";
+    }
+}
+
+DftBool ParseBenchSceneSize(const string& iName, BenchSceneSize& oSize)
+{
+    const BenchSceneSize sizes[] = { BENCH_SCENE_SMALL, BENCH_SCENE_MEDIUM, BENCH_SCENE_HUGE };
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++)
+    {
+        if (iName == GetBenchSceneName(sizes[i]))
+        {
+            oSize = sizes[i];
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+CBenchmark::CBenchmark(const string& iOutputDir, DftUInt iRepeat) : m_OutputDir(iOutputDir), m_Repeat(iRepeat ? iRepeat : 1)
+{
+}
+
+void CBenchmark::AddStage(const string& iName, const BenchStageFunc& iRun)
+{
+    Stage stage;
+    stage._name = iName;
+    stage._run = iRun;
+    m_Stages.push_back(stage);
+}
+
+DftBool CBenchmark::Run(const vector<BenchSceneSize>& iSizes, vector<BenchResult>& oResults)
+{
+    oResults.clear();
+    if (!MakeDirectory(m_OutputDir))
+        return FALSE;
+
+    for (size_t s = 0; s < iSizes.size(); s++)
+    {
+        const char* sceneName = GetBenchSceneName(iSizes[s]);
+        string sceneDir = m_OutputDir + PATH_SEPARATOR + sceneName;
+        if (!MakeDirectory(sceneDir))
+            return FALSE;
+
+        IMemSceneData* sceneData = CreateMemSceneData();
+        SceneGenStatistics sceneStats;
+        if (!GenerateScene(sceneData, GetBenchSceneOptions(iSizes[s]), &sceneStats))
+        {
+            sceneData->Release();
+            return FALSE;
+        }
+
+        for (size_t k = 0; k < m_Stages.size(); k++)
+        {
+            BenchResult result;
+            result._stage = m_Stages[k]._name;
+            result._scene = sceneName;
+            result._success = true;
+            result._runs = m_Repeat;
+            result._nodeCount = sceneStats._nodeCount;
+            result._triangleCount = sceneStats._triangleCount;
+
+            string stageDir = sceneDir + PATH_SEPARATOR + m_Stages[k]._name;
+            if (!MakeDirectory(stageDir))
+                result._success = false;
+
+            DftDouble totalSeconds = 0.0;
+            DftUInt64 peakBytes = GetPeakResidentBytes();
+            DftUInt64 allocations = GetBenchAllocationCount();
+            DftUInt64 allocatedBytes = GetBenchAllocatedBytes();
+            for (DftUInt r = 0; r < m_Repeat && result._success; r++)
+            {
+                auto start = chrono::steady_clock::now();
+                if (!m_Stages[k]._run(sceneData, stageDir))
+                    result._success = false;
+                DftDouble seconds = chrono::duration<DftDouble>(chrono::steady_clock::now() - start).count();
+                totalSeconds += seconds;
+                if (r == 0 || seconds < result._bestSeconds)
+                    result._bestSeconds = seconds;
+            }
+            result._meanSeconds = totalSeconds / m_Repeat;
+            result._allocations = (GetBenchAllocationCount() - allocations) / m_Repeat;
+            result._allocatedBytes = (GetBenchAllocatedBytes() - allocatedBytes) / m_Repeat;
+
+            // 每次运行覆盖同一目录下的同名文件，目录大小即单次运行的输出量
+            result._outputBytes = GetDirectorySize(stageDir);
+            result._processPeakBytes = GetPeakResidentBytes();
+            result._peakGrowthBytes = result._processPeakBytes > peakBytes ? result._processPeakBytes - peakBytes : 0;
+            oResults.push_back(result);
+        }
+        sceneData->Release();
+    }
+    return TRUE;
+}
+
+DftBool WriteBenchReport(const vector<BenchResult>& iResults, const string& iReportPath)
+{
+    CTextWriter report(6);
+    if (!report.Open(iReportPath))
+        return FALSE;
+
+    report.Append("{\n  \"results\": [");
+    for (size_t i = 0; i < iResults.size(); i++)
+    {
+        const BenchResult& result = iResults[i];
+        report.Append(i ? ",\n    {" : "\n    {");
+        report.Append("\n      \"stage\": ").AppendQuoted(result._stage.c_str());
+        report.Append(",\n      \"scene\": ").AppendQuoted(result._scene.c_str());
+        report.Append(",\n      \"success\": ").Append(result._success ? "true" : "false");
+        AppendJsonField(report, "runs", static_cast<DftUInt64>(result._runs));
+        AppendJsonField(report, "nodes", result._nodeCount);
+        AppendJsonField(report, "triangles", result._triangleCount);
+        AppendJsonField(report, "bestSeconds", result._bestSeconds);
+        AppendJsonField(report, "meanSeconds", result._meanSeconds);
+        AppendJsonField(report, "nodesPerSecond", result.GetNodesPerSecond());
+        AppendJsonField(report, "trianglesPerSecond", result.GetTrianglesPerSecond());
+        AppendJsonField(report, "outputBytes", result._outputBytes);
+        AppendJsonField(report, "outputMBPerSecond", result.GetOutputThroughput());
+        if (IsBenchAllocationCounted())
+        {
+            AppendJsonField(report, "allocations", result._allocations);
+            AppendJsonField(report, "allocatedBytes", result._allocatedBytes);
+        }
+        else
+        {
+            AppendJsonNull(report, "allocations");
+            AppendJsonNull(report, "allocatedBytes");
+        }
+        AppendJsonField(report, "processPeakResidentBytes", result._processPeakBytes);
+        AppendJsonField(report, "peakResidentGrowthBytes", result._peakGrowthBytes);
+        report.Append("\n    }");
+    }
+    report.Append(iResults.empty() ? "]\n}\n" : "\n  ]\n}\n");
+    return report.Close();
+}
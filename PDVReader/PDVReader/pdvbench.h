@@ -0,0 +1,158 @@
+/**
+ * @file pdvbench.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：导出流程的基准测试
+ * @details 按小、中、大三种规模在内存中生成装配场景，每个测试阶段在每个场景上重复运行，记录耗时、输出字节数、
+ *          内存分配次数和峰值内存，换算为节点/秒、三角面/秒和输出MB/秒，结果写成JSON报告，便于比较不同版本。
+ *          分配次数通过替换全局operator new统计，只计次数和字节数，不改变分配行为；替换会作用于整个程序，
+ *          只在定义了PDV_BENCH_COUNT_ALLOCATIONS的构建中启用，否则报告中的分配次数为null。
+ *          峰值内存是进程级的最高水位，不能按阶段清零，除进程峰值外另记每个阶段使最高水位上升的字节数。
+ */
+
+#ifndef PDVBENCH_H
+#define PDVBENCH_H
+
+#include "DftBase.h"
+#include "pdvscenegen.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+class ISceneData;
+} // namespace pdv
+} // namespace kernel
+
+/** @brief 基准测试场景规模 */
+enum BenchSceneSize
+{
+    BENCH_SCENE_SMALL = 0,  ///< 111个节点，100个零件
+    BENCH_SCENE_MEDIUM = 1, ///< 11111个节点，10000个零件
+    BENCH_SCENE_HUGE = 2,   ///< 111111个节点，100000个零件，大量共用几何
+};
+
+/**
+ * @brief 测试阶段，在场景上运行一次
+ * @return DftBool 是否成功
+ * @param[in] iSceneData 场景数据
+ * @param[in] iOutputDir 本阶段的输出目录，已创建，输出字节数按目录下的文件统计
+ */
+typedef std::function<DftBool(kernel::pdv::ISceneData* iSceneData, const std::string& iOutputDir)> BenchStageFunc;
+
+/** @brief 一个阶段在一个场景上的测试结果 */
+struct BenchResult
+{
+    std::string _stage;           ///< 阶段名称
+    std::string _scene;           ///< 场景规模名称
+    bool _success;                ///< 每次运行是否都成功
+    DftUInt _runs;                ///< 运行次数
+    DftUInt64 _nodeCount;         ///< 场景节点数
+    DftUInt64 _triangleCount;     ///< 场景三角面数（按零件展开）
+    DftDouble _bestSeconds;       ///< 最短耗时
+    DftDouble _meanSeconds;       ///< 平均耗时
+    DftUInt64 _outputBytes;       ///< 单次运行的输出字节数
+    DftUInt64 _allocations;       ///< 单次运行的平均分配次数
+    DftUInt64 _allocatedBytes;    ///< 单次运行的平均分配字节数
+    DftUInt64 _processPeakBytes;  ///< 阶段结束时的进程峰值内存，包含之前的阶段和场景生成
+    DftUInt64 _peakGrowthBytes;   ///< 本阶段使进程峰值内存上升的字节数，未超过之前的峰值时为0
+
+    BenchResult()
+        : _success(false), _runs(0), _nodeCount(0), _triangleCount(0), _bestSeconds(0.0), _meanSeconds(0.0), _outputBytes(0)
+        , _allocations(0), _allocatedBytes(0), _processPeakBytes(0), _peakGrowthBytes(0)
+    {
+    }
+
+    /** @brief 节点/秒 */
+    DftDouble GetNodesPerSecond() const { return _bestSeconds > 0.0 ? _nodeCount / _bestSeconds : 0.0; }
+    /** @brief 三角面/秒 */
+    DftDouble GetTrianglesPerSecond() const { return _bestSeconds > 0.0 ? _triangleCount / _bestSeconds : 0.0; }
+    /** @brief 输出MB/秒 */
+    DftDouble GetOutputThroughput() const { return _bestSeconds > 0.0 ? _outputBytes / _bestSeconds / (1024.0 * 1024.0) : 0.0; }
+};
+
+/** @brief 基准测试 */
+class CBenchmark
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] iOutputDir 输出根目录，每个场景和阶段使用其下的子目录
+     * @param[in] iRepeat 每个阶段在每个场景上的运行次数，为0时按1次
+     */
+    explicit CBenchmark(const std::string& iOutputDir, DftUInt iRepeat = 3);
+
+    /**
+     * @brief 添加测试阶段，按添加顺序运行
+     * @param[in] iName 阶段名称
+     * @param[in] iRun 阶段函数
+     */
+    void AddStage(const std::string& iName, const BenchStageFunc& iRun);
+
+    /**
+     * @brief 在各规模的场景上运行所有阶段，同一规模的场景只生成一次
+     * @return DftBool 输出目录不能创建或场景生成失败时为FALSE，单个阶段失败只记录在结果中
+     * @param[in] iSizes 场景规模
+     * @param[out] oResults 测试结果，按场景、阶段排列
+     */
+    DftBool Run(const std::vector<BenchSceneSize>& iSizes, std::vector<BenchResult>& oResults);
+
+private:
+    /** 一个测试阶段 */
+    struct Stage
+    {
+        std::string _name;   ///< 阶段名称
+        BenchStageFunc _run; ///< 阶段函数
+    };
+
+    std::string m_OutputDir;     ///< 输出根目录
+    DftUInt m_Repeat;            ///< 运行次数
+    std::vector<Stage> m_Stages; ///< 测试阶段
+};
+
+/**
+ * @brief 场景规模对应的生成参数
+ * @return SceneGenOptions 生成参数
+ * @param[in] iSize 场景规模
+ */
+SceneGenOptions GetBenchSceneOptions(BenchSceneSize iSize);
+
+/**
+ * @brief 场景规模的名称
+ * @return const char* small、medium或huge
+ * @param[in] iSize 场景规模
+ */
+const char* GetBenchSceneName(BenchSceneSize iSize);
+
+/**
+ * @brief 按名称解析场景规模
+ * @return DftBool 名称是否有效
+ * @param[in] iName small、medium或huge
+ * @param[out] oSize 场景规模
+ */
+DftBool ParseBenchSceneSize(const std::string& iName, BenchSceneSize& oSize);
+
+/**
+ * @brief 把测试结果写成JSON报告
+ * @return DftBool 是否成功
+ * @param[in] iResults 测试结果
+ * @param[in] iReportPath 报告路径
+ */
+DftBool WriteBenchReport(const std::vector<BenchResult>& iResults, const std::string& iReportPath);
+
+/** @brief 是否统计分配次数，即构建时是否定义了PDV_BENCH_COUNT_ALLOCATIONS */
+DftBool IsBenchAllocationCounted();
+
+/** @brief 进程启动以来的分配次数，不统计时为0 */
+DftUInt64 GetBenchAllocationCount();
+
+/** @brief 进程启动以来的分配字节数，不统计时为0 */
+DftUInt64 GetBenchAllocatedBytes();
+
+/** @brief 进程的峰值内存（字节） */
+DftUInt64 GetPeakResidentBytes();
+
+#endif
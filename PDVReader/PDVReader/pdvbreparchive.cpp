@@ -0,0 +1,1292 @@
+#include "pdvbreparchive.h"
+#include "pdvprofiler.h"
+#include "PDVIBRep.h"
+#include "PDVITopo.h"
+#include "PDVIGeomPointData.h"
+#include "PDVIGeomCurveData.h"
+#include "PDVIGeomSurfaceData.h"
+#include "PDVICurve.h"
+#include "PDVICurveOnSurface.h"
+#include "PDVISurface.h"
+#include "PDVILine.h"
+#include "PDVICircle.h"
+#include "PDVIEllipse.h"
+#include "PDVINurbsCurve.h"
+#include "PDVINurbsSurface.h"
+#include "PDVIPlane.h"
+#include "PDVICylinder.h"
+#include "PDVICone.h"
+#include "PDVITorus.h"
+#include "PDVISphere.h"
+#include <algorithm>
+#include <cstring>
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+// 文件头：标识、版本、段索引偏移(8)、段数(4)、保留(4)
+const char BREP_ARCHIVE_MAGIC[4] = { 'P', 'B', 'R', 'P' };
+const DftUInt32 BREP_ARCHIVE_VERSION = 1;
+const size_t BREP_ARCHIVE_HEADER_SIZE = 24;
+const size_t BREP_ARCHIVE_INDEX_OFFSET_POS = 8;
+// 段索引的每一项：段类型(4)、保留(4)、记录数、记录偏移、记录长度、查找表偏移、查找表长度(各8)
+const size_t BREP_ARCHIVE_INDEX_ENTRY_SIZE = 48;
+// ULEB128编码的64位整数最多10字节
+const int ULEB128_MAX_BYTES = 10;
+
+void AppendByte(vector<DftByte>& ioBuffer, DftUInt8 iValue)
+{
+    ioBuffer.push_back(iValue);
+}
+
+void AppendULEB128(vector<DftByte>& ioBuffer, DftUInt64 iValue)
+{
+    do
+    {
+        DftByte byte = static_cast<DftByte>(iValue & 0x7F);
+        iValue >>= 7;
+        if (iValue)
+            byte |= 0x80;
+        ioBuffer.push_back(byte);
+    } while (iValue);
+}
+
+// iValue与iBase的差值做ZigZag变换后按ULEB128写出，小的负差值也只占一两个字节
+void AppendDelta(vector<DftByte>& ioBuffer, DftUInt64 iValue, DftUInt64 iBase)
+{
+    DftInt64 delta = static_cast<DftInt64>(iValue - iBase);
+    AppendULEB128(ioBuffer, (static_cast<DftUInt64>(delta) << 1) ^ static_cast<DftUInt64>(delta >> 63));
+}
+
+void AppendDoubles(vector<DftByte>& ioBuffer, const DftDouble* iValues, size_t iCount)
+{
+    if (!iCount)
+        return;
+    size_t size = ioBuffer.size();
+    ioBuffer.resize(size + iCount * sizeof(DftDouble));
+    memcpy(&ioBuffer[size], iValues, iCount * sizeof(DftDouble));
+}
+
+void AppendDouble(vector<DftByte>& ioBuffer, DftDouble iValue)
+{
+    AppendDoubles(ioBuffer, &iValue, 1);
+}
+
+void AppendDoubleArray(vector<DftByte>& ioBuffer, const vector<DftDouble>& iValues)
+{
+    AppendULEB128(ioBuffer, iValues.size());
+    AppendDoubles(ioBuffer, iValues.empty() ? NULL : &iValues[0], iValues.size());
+}
+
+template <class TVector>
+void AppendVectorArray(vector<DftByte>& ioBuffer, const vector<TVector>& iValues)
+{
+    AppendULEB128(ioBuffer, iValues.size());
+    for (size_t i = 0; i < iValues.size(); i++)
+        AppendDoubles(ioBuffer, iValues[i]._data, sizeof(iValues[i]._data) / sizeof(DftDouble));
+}
+
+// 原点和X、Y、Z方向
+void AppendFrame(vector<DftByte>& ioBuffer, const PDVVector3D& iOrigin, const PDVVector3D& iX, const PDVVector3D& iY,
+    const PDVVector3D& iZ)
+{
+    AppendDoubles(ioBuffer, iOrigin._data, 3);
+    AppendDoubles(ioBuffer, iX._data, 3);
+    AppendDoubles(ioBuffer, iY._data, 3);
+    AppendDoubles(ioBuffer, iZ._data, 3);
+}
+
+void AppendUInt32(DftByte* oBuffer, DftUInt32 iValue)
+{
+    memcpy(oBuffer, &iValue, 4);
+}
+
+void AppendUInt64(DftByte* oBuffer, DftUInt64 iValue)
+{
+    memcpy(oBuffer, &iValue, 8);
+}
+
+// 二维曲线的参数块
+void EncodeCurve2d(const ICurve2d* iCurve, vector<DftByte>& ioBuffer)
+{
+    if (!iCurve)
+    {
+        AppendByte(ioBuffer, CT_UNDIFINED);
+        return;
+    }
+
+    ICurve2d* curve = const_cast<ICurve2d*>(iCurve);
+    CurveType type = curve->GetType();
+    const ILine2d* line = type == CT_LINE ? dynamic_cast<ILine2d*>(curve) : NULL;
+    const ICircle2d* circle = type == CT_CIRCLE ? dynamic_cast<ICircle2d*>(curve) : NULL;
+    const IEllipse2d* ellipse = type == CT_ELLIPSE ? dynamic_cast<IEllipse2d*>(curve) : NULL;
+    const INurbsCurve2d* nurbs = type == CT_BSPLINECURVE ? dynamic_cast<INurbsCurve2d*>(curve) : NULL;
+    if (line)
+    {
+        AppendByte(ioBuffer, CT_LINE);
+        AppendDoubles(ioBuffer, line->GetOrigin()._data, 2);
+        AppendDoubles(ioBuffer, line->GetDirection()._data, 2);
+    }
+    else if (circle || ellipse)
+    {
+        const IConic2d* conic = circle ? static_cast<const IConic2d*>(circle) : static_cast<const IConic2d*>(ellipse);
+        AppendByte(ioBuffer, static_cast<DftUInt8>(type));
+        AppendDoubles(ioBuffer, conic->GetOrigin()._data, 2);
+        AppendDoubles(ioBuffer, conic->GetXDirection()._data, 2);
+        AppendDoubles(ioBuffer, conic->GetYDirection()._data, 2);
+        if (circle)
+            AppendDouble(ioBuffer, circle->GetRadius());
+        else
+        {
+            AppendDouble(ioBuffer, ellipse->GetMajorRadius());
+            AppendDouble(ioBuffer, ellipse->GetMinorRadius());
+        }
+    }
+    else if (nurbs)
+    {
+        NurbsCurve2dData data;
+        nurbs->GetNurbsCurve(data);
+        AppendByte(ioBuffer, CT_BSPLINECURVE);
+        AppendByte(ioBuffer, data._bitMask);
+        AppendByte(ioBuffer, data._periodic);
+        AppendByte(ioBuffer, data._degree);
+        AppendVectorArray(ioBuffer, data._ctrlPoints);
+        AppendDoubleArray(ioBuffer, data._weights);
+        AppendDoubleArray(ioBuffer, data._knots);
+    }
+    else
+        AppendByte(ioBuffer, CT_UNDIFINED);
+}
+
+void EncodeCurve(const ICurve* iCurve, vector<DftByte>& ioBuffer)
+{
+    if (!iCurve)
+    {
+        AppendByte(ioBuffer, CT_UNDIFINED);
+        return;
+    }
+
+    ICurve* curve = const_cast<ICurve*>(iCurve);
+    CurveType type = curve->GetType();
+    const ILine* line = type == CT_LINE ? dynamic_cast<ILine*>(curve) : NULL;
+    const ICircle* circle = type == CT_CIRCLE ? dynamic_cast<ICircle*>(curve) : NULL;
+    const IEllipse* ellipse = type == CT_ELLIPSE ? dynamic_cast<IEllipse*>(curve) : NULL;
+    const INurbsCurve* nurbs = type == CT_BSPLINECURVE ? dynamic_cast<INurbsCurve*>(curve) : NULL;
+    if (line)
+    {
+        AppendByte(ioBuffer, CT_LINE);
+        AppendDoubles(ioBuffer, line->GetOrigin()._data, 3);
+        AppendDoubles(ioBuffer, line->GetDirection()._data, 3);
+    }
+    else if (circle || ellipse)
+    {
+        const IConic* conic = circle ? static_cast<const IConic*>(circle) : static_cast<const IConic*>(ellipse);
+        AppendByte(ioBuffer, static_cast<DftUInt8>(type));
+        AppendFrame(ioBuffer, conic->GetOrigin(), conic->GetXDirection(), conic->GetYDirection(), conic->GetZDirection());
+        if (circle)
+            AppendDouble(ioBuffer, circle->GetRadius());
+        else
+        {
+            AppendDouble(ioBuffer, ellipse->GetMajorRadius());
+            AppendDouble(ioBuffer, ellipse->GetMinorRadius());
+        }
+    }
+    else if (nurbs)
+    {
+        NurbsCurveData data;
+        nurbs->GetNurbsCurve(data);
+        AppendByte(ioBuffer, CT_BSPLINECURVE);
+        AppendByte(ioBuffer, data._bitMask);
+        AppendByte(ioBuffer, data._periodic);
+        AppendByte(ioBuffer, data._degree);
+        AppendVectorArray(ioBuffer, data._ctrlPoints);
+        AppendDoubleArray(ioBuffer, data._weights);
+        AppendDoubleArray(ioBuffer, data._knots);
+    }
+    else
+        AppendByte(ioBuffer, CT_UNDIFINED);
+}
+
+void EncodeSurface(const ISurface* iSurface, vector<DftByte>& ioBuffer)
+{
+    if (!iSurface)
+    {
+        AppendByte(ioBuffer, ST_UNDIFINED);
+        return;
+    }
+
+    ISurface* surface = const_cast<ISurface*>(iSurface);
+    SurfaceType type = surface->GetType();
+    if (type == ST_BSPLINESURFACE)
+    {
+        const INurbsSurface* nurbs = dynamic_cast<INurbsSurface*>(surface);
+        if (!nurbs)
+        {
+            AppendByte(ioBuffer, ST_UNDIFINED);
+            return;
+        }
+        NurbsSurfaceData data;
+        nurbs->GetNurbsSurface(data);
+        AppendByte(ioBuffer, ST_BSPLINESURFACE);
+        AppendByte(ioBuffer, data._bitMask);
+        AppendByte(ioBuffer, data._uPeriodic);
+        AppendByte(ioBuffer, data._vPeriodic);
+        AppendByte(ioBuffer, data._uDegree);
+        AppendByte(ioBuffer, data._vDegree);
+        AppendULEB128(ioBuffer, data._ctrlRowCount);
+        AppendULEB128(ioBuffer, data._ctrlColumnCount);
+        AppendVectorArray(ioBuffer, data._ctrlPoints);
+        AppendDoubleArray(ioBuffer, data._weights);
+        AppendDoubleArray(ioBuffer, data._uKnots);
+        AppendDoubleArray(ioBuffer, data._vKnots);
+        return;
+    }
+
+    // 初等曲面共用坐标系，其后是各自的尺寸参数
+    const IElementarySurface* elementary = NULL;
+    if (type >= ST_PLANE && type <= ST_SPHERE)
+        elementary = dynamic_cast<IElementarySurface*>(surface);
+    if (!elementary)
+    {
+        AppendByte(ioBuffer, ST_UNDIFINED);
+        return;
+    }
+    const ICylinder* cylinder = type == ST_CYLINDER ? dynamic_cast<const ICylinder*>(elementary) : NULL;
+    const ICone* cone = type == ST_CONE ? dynamic_cast<const ICone*>(elementary) : NULL;
+    const ITorus* torus = type == ST_TORUS ? dynamic_cast<const ITorus*>(elementary) : NULL;
+    const ISphere* sphere = type == ST_SPHERE ? dynamic_cast<const ISphere*>(elementary) : NULL;
+    if (type != ST_PLANE && !cylinder && !cone && !torus && !sphere)
+    {
+        AppendByte(ioBuffer, ST_UNDIFINED);
+        return;
+    }
+
+    AppendByte(ioBuffer, static_cast<DftUInt8>(type));
+    AppendFrame(ioBuffer, elementary->GetOrigin(), elementary->GetXDirection(), elementary->GetYDirection(),
+        elementary->GetZDirection());
+    if (cylinder)
+        AppendDouble(ioBuffer, cylinder->GetRadius());
+    else if (cone)
+    {
+        AppendDouble(ioBuffer, cone->GetRadius());
+        AppendDouble(ioBuffer, cone->GetHalfAngle());
+    }
+    else if (torus)
+    {
+        AppendDouble(ioBuffer, torus->GetMajorRadius());
+        AppendDouble(ioBuffer, torus->GetMinorRadius());
+    }
+    else if (sphere)
+        AppendDouble(ioBuffer, sphere->GetRadius());
+}
+
+// 曲线记录：类型、参数范围、参数块和各曲面上的参数曲线，参数曲线的曲面ID与曲线ID求差
+void EncodeCurveRecord(IGeomCurveData* iCurve, vector<DftByte>& ioBuffer)
+{
+    DftUInt64 id = iCurve->GetID();
+    AppendByte(ioBuffer, iCurve->GetType());
+    AppendDouble(ioBuffer, iCurve->GetStartParameter());
+    AppendDouble(ioBuffer, iCurve->GetEndParameter());
+    EncodeCurve(iCurve->GetCurve(), ioBuffer);
+
+    vector<ICurveOnSurface*> pcurves;
+    iCurve->GetCurveOnSurfaceData(pcurves);
+    vector<ICurveOnSurface*>::iterator last = remove_if(pcurves.begin(), pcurves.end(),
+        [](ICurveOnSurface* iPCurve) { return !iPCurve || !iPCurve->GetPCrvData(); });
+    pcurves.erase(last, pcurves.end());
+    AppendULEB128(ioBuffer, pcurves.size());
+    for (size_t i = 0; i < pcurves.size(); i++)
+    {
+        const IGeomCurve2dData* data = pcurves[i]->GetPCrvData();
+        AppendDelta(ioBuffer, pcurves[i]->GetSrfId(), id);
+        AppendByte(ioBuffer, data->GetType());
+        AppendDouble(ioBuffer, data->GetStartParameter());
+        AppendDouble(ioBuffer, data->GetEndParameter());
+        EncodeCurve2d(data->GetCurve(), ioBuffer);
+    }
+}
+
+// 曲面记录：类型、参数域和参数块
+void EncodeSurfaceRecord(IGeomSurfaceData* iSurface, vector<DftByte>& ioBuffer)
+{
+    AppendByte(ioBuffer, iSurface->GetType());
+    AppendDoubles(ioBuffer, iSurface->GetDomainMin()._data, 2);
+    AppendDoubles(ioBuffer, iSurface->GetDomainMax()._data, 2);
+    EncodeSurface(iSurface->GetSurface(), ioBuffer);
+}
+
+/** 映射数据上的只读游标，越界或编码错误后所有读取返回0 */
+class CArchiveCursor
+{
+public:
+    CArchiveCursor(const DftByte* iData, DftUInt64 iSize) : m_Ptr(iData), m_End(iData + iSize), m_Failed(false) {}
+
+    bool IsFailed() const { return m_Failed; }
+    bool IsEnd() const { return m_Ptr == m_End; }
+    const DftByte* GetPosition() const { return m_Ptr; }
+
+    DftUInt8 ReadByte()
+    {
+        if (m_Ptr == m_End)
+            return Fail();
+        return *m_Ptr++;
+    }
+
+    DftUInt64 ReadULEB128()
+    {
+        DftUInt64 value = 0;
+        for (int i = 0; i < ULEB128_MAX_BYTES && m_Ptr != m_End; i++)
+        {
+            DftByte byte = *m_Ptr++;
+            value |= static_cast<DftUInt64>(byte & 0x7F) << (7 * i);
+            if (!(byte & 0x80))
+                return value;
+        }
+        return Fail();
+    }
+
+    DftUInt64 ReadDelta(DftUInt64 iBase)
+    {
+        DftUInt64 zigzag = ReadULEB128();
+        DftInt64 delta = static_cast<DftInt64>(zigzag >> 1) ^ -static_cast<DftInt64>(zigzag & 1);
+        return iBase + static_cast<DftUInt64>(delta);
+    }
+
+    void ReadDoubles(DftDouble* oValues, size_t iCount)
+    {
+        if (static_cast<DftUInt64>(m_End - m_Ptr) < iCount * sizeof(DftDouble))
+        {
+            memset(oValues, 0, iCount * sizeof(DftDouble));
+            Fail();
+            return;
+        }
+        memcpy(oValues, m_Ptr, iCount * sizeof(DftDouble));
+        m_Ptr += iCount * sizeof(DftDouble);
+    }
+
+    DftDouble ReadDouble()
+    {
+        DftDouble value;
+        ReadDoubles(&value, 1);
+        return value;
+    }
+
+    // 读取数组长度，长度超过剩余数据能容纳的元素数时视为损坏，避免按错误长度分配内存
+    size_t ReadCount(size_t iElementSize)
+    {
+        DftUInt64 count = ReadULEB128();
+        if (count > static_cast<DftUInt64>(m_End - m_Ptr) / iElementSize)
+            return static_cast<size_t>(Fail());
+        return static_cast<size_t>(count);
+    }
+
+    void ReadDoubleArray(vector<DftDouble>& oValues)
+    {
+        oValues.resize(ReadCount(sizeof(DftDouble)));
+        if (!oValues.empty())
+            ReadDoubles(&oValues[0], oValues.size());
+    }
+
+    template <class TVector>
+    void ReadVectorArray(vector<TVector>& oValues)
+    {
+        const size_t dimension = sizeof(oValues[0]._data) / sizeof(DftDouble);
+        oValues.resize(ReadCount(dimension * sizeof(DftDouble)));
+        for (size_t i = 0; i < oValues.size(); i++)
+            ReadDoubles(oValues[i]._data, dimension);
+    }
+
+    void ReadFrame(PDVVector3D& oOrigin, PDVVector3D& oX, PDVVector3D& oY, PDVVector3D& oZ)
+    {
+        ReadDoubles(oOrigin._data, 3);
+        ReadDoubles(oX._data, 3);
+        ReadDoubles(oY._data, 3);
+        ReadDoubles(oZ._data, 3);
+    }
+
+    // 跳过iSize字节，返回跳过部分的起始地址
+    const DftByte* Skip(DftUInt64 iSize)
+    {
+        if (static_cast<DftUInt64>(m_End - m_Ptr) < iSize)
+        {
+            Fail();
+            return NULL;
+        }
+        const DftByte* begin = m_Ptr;
+        m_Ptr += iSize;
+        return begin;
+    }
+
+private:
+    DftUInt8 Fail()
+    {
+        m_Failed = true;
+        m_Ptr = m_End;
+        return 0;
+    }
+
+    const DftByte* m_Ptr;
+    const DftByte* m_End;
+    bool m_Failed;
+};
+
+void DecodeCurve2d(CArchiveCursor& ioCursor, BRepArchiveCurve2d& oCurve)
+{
+    oCurve._parameterType = ioCursor.ReadByte();
+    switch (oCurve._parameterType)
+    {
+    case CT_LINE:
+        ioCursor.ReadDoubles(oCurve._origin._data, 2);
+        ioCursor.ReadDoubles(oCurve._xDirection._data, 2);
+        break;
+    case CT_CIRCLE:
+    case CT_ELLIPSE:
+        ioCursor.ReadDoubles(oCurve._origin._data, 2);
+        ioCursor.ReadDoubles(oCurve._xDirection._data, 2);
+        ioCursor.ReadDoubles(oCurve._yDirection._data, 2);
+        oCurve._radius = ioCursor.ReadDouble();
+        if (oCurve._parameterType == CT_ELLIPSE)
+            oCurve._minorRadius = ioCursor.ReadDouble();
+        break;
+    case CT_BSPLINECURVE:
+        oCurve._nurbs._bitMask = ioCursor.ReadByte();
+        oCurve._nurbs._periodic = ioCursor.ReadByte();
+        oCurve._nurbs._degree = ioCursor.ReadByte();
+        ioCursor.ReadVectorArray(oCurve._nurbs._ctrlPoints);
+        ioCursor.ReadDoubleArray(oCurve._nurbs._weights);
+        ioCursor.ReadDoubleArray(oCurve._nurbs._knots);
+        break;
+    case CT_UNDIFINED:
+        break;
+    default:
+        // 未知的参数块无法跳过
+        ioCursor.Skip(~0ull);
+        break;
+    }
+}
+
+void DecodeCurve(CArchiveCursor& ioCursor, BRepArchiveCurve& oCurve)
+{
+    oCurve._type = ioCursor.ReadByte();
+    oCurve._start = ioCursor.ReadDouble();
+    oCurve._end = ioCursor.ReadDouble();
+    oCurve._parameterType = ioCursor.ReadByte();
+    switch (oCurve._parameterType)
+    {
+    case CT_LINE:
+        ioCursor.ReadDoubles(oCurve._origin._data, 3);
+        ioCursor.ReadDoubles(oCurve._xDirection._data, 3);
+        break;
+    case CT_CIRCLE:
+    case CT_ELLIPSE:
+        ioCursor.ReadFrame(oCurve._origin, oCurve._xDirection, oCurve._yDirection, oCurve._zDirection);
+        oCurve._radius = ioCursor.ReadDouble();
+        if (oCurve._parameterType == CT_ELLIPSE)
+            oCurve._minorRadius = ioCursor.ReadDouble();
+        break;
+    case CT_BSPLINECURVE:
+        oCurve._nurbs._bitMask = ioCursor.ReadByte();
+        oCurve._nurbs._periodic = ioCursor.ReadByte();
+        oCurve._nurbs._degree = ioCursor.ReadByte();
+        ioCursor.ReadVectorArray(oCurve._nurbs._ctrlPoints);
+        ioCursor.ReadDoubleArray(oCurve._nurbs._weights);
+        ioCursor.ReadDoubleArray(oCurve._nurbs._knots);
+        break;
+    case CT_UNDIFINED:
+        break;
+    default:
+        ioCursor.Skip(~0ull);
+        break;
+    }
+
+    // 参数曲线：曲面ID、曲线类型、参数范围和参数块
+    oCurve._pcurves.resize(ioCursor.ReadCount(1));
+    for (size_t i = 0; i < oCurve._pcurves.size(); i++)
+    {
+        BRepArchiveCurve2d& pcurve = oCurve._pcurves[i];
+        pcurve._surfaceID = ioCursor.ReadDelta(oCurve._id);
+        pcurve._type = ioCursor.ReadByte();
+        pcurve._start = ioCursor.ReadDouble();
+        pcurve._end = ioCursor.ReadDouble();
+        DecodeCurve2d(ioCursor, pcurve);
+    }
+}
+
+void DecodeSurface(CArchiveCursor& ioCursor, BRepArchiveSurface& oSurface)
+{
+    oSurface._type = ioCursor.ReadByte();
+    ioCursor.ReadDoubles(oSurface._domainMin._data, 2);
+    ioCursor.ReadDoubles(oSurface._domainMax._data, 2);
+    oSurface._parameterType = ioCursor.ReadByte();
+    switch (oSurface._parameterType)
+    {
+    case ST_PLANE:
+    case ST_CYLINDER:
+    case ST_CONE:
+    case ST_TORUS:
+    case ST_SPHERE:
+        ioCursor.ReadFrame(oSurface._origin, oSurface._xDirection, oSurface._yDirection, oSurface._zDirection);
+        if (oSurface._parameterType != ST_PLANE)
+            oSurface._radius = ioCursor.ReadDouble();
+        if (oSurface._parameterType == ST_CONE)
+            oSurface._halfAngle = ioCursor.ReadDouble();
+        else if (oSurface._parameterType == ST_TORUS)
+            oSurface._minorRadius = ioCursor.ReadDouble();
+        break;
+    case ST_BSPLINESURFACE:
+        oSurface._nurbs._bitMask = ioCursor.ReadByte();
+        oSurface._nurbs._uPeriodic = ioCursor.ReadByte();
+        oSurface._nurbs._vPeriodic = ioCursor.ReadByte();
+        oSurface._nurbs._uDegree = ioCursor.ReadByte();
+        oSurface._nurbs._vDegree = ioCursor.ReadByte();
+        oSurface._nurbs._ctrlRowCount = ioCursor.ReadULEB128();
+        oSurface._nurbs._ctrlColumnCount = ioCursor.ReadULEB128();
+        ioCursor.ReadVectorArray(oSurface._nurbs._ctrlPoints);
+        ioCursor.ReadDoubleArray(oSurface._nurbs._weights);
+        ioCursor.ReadDoubleArray(oSurface._nurbs._uKnots);
+        ioCursor.ReadDoubleArray(oSurface._nurbs._vKnots);
+        break;
+    case ST_UNDIFINED:
+        break;
+    default:
+        ioCursor.Skip(~0ull);
+        break;
+    }
+}
+
+} // namespace
+
+CBRepArchiveWriter::CBRepArchiveWriter()
+    : m_Section(-1), m_LastID(0)
+{
+    memset(m_Sections, 0, sizeof(m_Sections));
+    memset(m_LastGeometryIDs, 0, sizeof(m_LastGeometryIDs));
+}
+
+DftBool CBRepArchiveWriter::Open(const std::string& iPath)
+{
+    if (!m_File.Open(iPath))
+        return FALSE;
+
+    memset(m_Sections, 0, sizeof(m_Sections));
+    memset(m_LastGeometryIDs, 0, sizeof(m_LastGeometryIDs));
+    m_Section = -1;
+    m_LastID = 0;
+    m_Table.clear();
+
+    // 段索引偏移在关闭时回填
+    DftByte header[BREP_ARCHIVE_HEADER_SIZE];
+    memset(header, 0, sizeof(header));
+    memcpy(header, BREP_ARCHIVE_MAGIC, 4);
+    AppendUInt32(header + 4, BREP_ARCHIVE_VERSION);
+    AppendUInt32(header + 16, BREP_SECTION_COUNT);
+    m_File.Write(header, sizeof(header));
+    return TRUE;
+}
+
+DftBool CBRepArchiveWriter::EnterSection(BRepArchiveSection iSection)
+{
+    if (!m_File.IsOpen() || static_cast<DftInt>(iSection) < m_Section)
+        return FALSE;
+    while (m_Section < static_cast<DftInt>(iSection))
+    {
+        if (m_Section >= 0)
+            EndSection();
+        m_Section++;
+        m_Sections[m_Section]._offset = m_File.GetBytesWritten();
+        m_LastID = 0;
+    }
+    return TRUE;
+}
+
+void CBRepArchiveWriter::EndSection()
+{
+    SectionInfo& section = m_Sections[m_Section];
+    section._length = m_File.GetBytesWritten() - section._offset;
+    section._tableOffset = m_File.GetBytesWritten();
+    section._tableLength = m_Table.size();
+    if (!m_Table.empty())
+        m_File.Write(&m_Table[0], m_Table.size());
+    m_Table.clear();
+}
+
+void CBRepArchiveWriter::CommitRecord(DftUInt64 iID)
+{
+    if (!m_Record.empty())
+        m_File.Write(&m_Record[0], m_Record.size());
+    m_Sections[m_Section]._count++;
+    // 拓扑段整体解码，不需要查找表
+    if (m_Section != BREP_SECTION_TOPO)
+    {
+        AppendDelta(m_Table, iID, m_LastID);
+        AppendULEB128(m_Table, m_Record.size());
+    }
+    m_LastID = iID;
+}
+
+DftBool CBRepArchiveWriter::WriteTopo(ITopo* iTopo)
+{
+    if (!iTopo || !EnterSection(BREP_SECTION_TOPO))
+        return FALSE;
+
+    // 内容标识按实际数据补全，读取时据此判断后续字段是否存在
+    CUnicodeString originalIDText = iTopo->GetOriginalID();
+    const char* originalID = originalIDText.AsUTF8();
+    size_t originalIDLength = originalID ? strlen(originalID) : 0;
+    DftUInt8 orientation = iTopo->GetOrientation();
+    DftUInt8 geometryType = iTopo->GetGeometryType();
+    DftUInt64 geometryID = iTopo->GetGeometryID();
+    const vector<DftUInt64>& children = iTopo->GetTopoIDs();
+    DftUInt8 mask = iTopo->GetBitMask();
+    if (originalIDLength)
+        mask |= TOPO_MASK_PERSISTENTID;
+    if (orientation != ORIENTATION_FORWARD)
+        mask |= TOPO_MASK_ORIENTATION;
+    if (geometryType != GEOMTYPE_NULL || geometryID != 0)
+        mask |= TOPO_MASK_GEOMETRY;
+    if (!children.empty())
+        mask |= TOPO_MASK_TOPODATA;
+
+    DftUInt64 id = iTopo->GetID();
+    m_Record.clear();
+    AppendByte(m_Record, mask);
+    AppendByte(m_Record, iTopo->GetTopoType());
+    AppendDelta(m_Record, id, m_LastID);
+    if (mask & TOPO_MASK_ORIENTATION)
+        AppendByte(m_Record, orientation);
+    if (mask & TOPO_MASK_PERSISTENTID)
+    {
+        AppendULEB128(m_Record, originalIDLength);
+        m_Record.insert(m_Record.end(), originalID, originalID + originalIDLength);
+    }
+    if (mask & TOPO_MASK_GEOMETRY)
+    {
+        AppendByte(m_Record, geometryType);
+        DftUInt64& lastGeometryID = m_LastGeometryIDs[geometryType & 3];
+        AppendDelta(m_Record, geometryID, lastGeometryID);
+        lastGeometryID = geometryID;
+    }
+    if (mask & TOPO_MASK_TOPODATA)
+    {
+        AppendULEB128(m_Record, children.size());
+        DftUInt64 last = id;
+        for (size_t i = 0; i < children.size(); i++)
+        {
+            AppendDelta(m_Record, children[i], last);
+            last = children[i];
+        }
+    }
+    CommitRecord(id);
+    return TRUE;
+}
+
+DftBool CBRepArchiveWriter::WritePoint(IGeomPointData* iPoint)
+{
+    if (!iPoint || !EnterSection(BREP_SECTION_POINT))
+        return FALSE;
+
+    m_Record.clear();
+    AppendDoubles(m_Record, iPoint->GetPosition()._data, 3);
+    CommitRecord(iPoint->GetID());
+    return TRUE;
+}
+
+DftBool CBRepArchiveWriter::WriteCurve(IGeomCurveData* iCurve)
+{
+    if (!iCurve || !EnterSection(BREP_SECTION_CURVE))
+        return FALSE;
+
+    m_Record.clear();
+    EncodeCurveRecord(iCurve, m_Record);
+    CommitRecord(iCurve->GetID());
+    return TRUE;
+}
+
+DftBool CBRepArchiveWriter::WriteSurface(IGeomSurfaceData* iSurface)
+{
+    if (!iSurface || !EnterSection(BREP_SECTION_SURFACE))
+        return FALSE;
+
+    m_Record.clear();
+    EncodeSurfaceRecord(iSurface, m_Record);
+    CommitRecord(iSurface->GetID());
+    return TRUE;
+}
+
+DftBool CBRepArchiveWriter::Close(BRepArchiveStatistics* oStatistics)
+{
+    if (!m_File.IsOpen())
+        return FALSE;
+
+    // 没有写入记录的段也写出空的索引项
+    EnterSection(static_cast<BRepArchiveSection>(BREP_SECTION_COUNT - 1));
+    EndSection();
+
+    DftUInt64 indexOffset = m_File.GetBytesWritten();
+    for (int i = 0; i < BREP_SECTION_COUNT; i++)
+    {
+        DftByte entry[BREP_ARCHIVE_INDEX_ENTRY_SIZE];
+        memset(entry, 0, sizeof(entry));
+        AppendUInt32(entry, static_cast<DftUInt32>(i));
+        AppendUInt64(entry + 8, m_Sections[i]._count);
+        AppendUInt64(entry + 16, m_Sections[i]._offset);
+        AppendUInt64(entry + 24, m_Sections[i]._length);
+        AppendUInt64(entry + 32, m_Sections[i]._tableOffset);
+        AppendUInt64(entry + 40, m_Sections[i]._tableLength);
+        m_File.Write(entry, sizeof(entry));
+    }
+
+    DftByte offset[8];
+    AppendUInt64(offset, indexOffset);
+    DftBool result = m_File.WriteAt(BREP_ARCHIVE_INDEX_OFFSET_POS, offset, sizeof(offset));
+    DftUInt64 bytes = m_File.GetBytesWritten();
+    if (!m_File.Close())
+        result = FALSE;
+    m_Section = -1;
+
+    if (oStatistics)
+    {
+        oStatistics->_topoCount = m_Sections[BREP_SECTION_TOPO]._count;
+        oStatistics->_pointCount = m_Sections[BREP_SECTION_POINT]._count;
+        oStatistics->_curveCount = m_Sections[BREP_SECTION_CURVE]._count;
+        oStatistics->_surfaceCount = m_Sections[BREP_SECTION_SURFACE]._count;
+        oStatistics->_bytes = bytes;
+    }
+    return result;
+}
+
+DftBool WriteBRepArchive(IBRep* iBRep, const string& iPath, BRepArchiveStatistics* oStatistics)
+{
+    if (!iBRep)
+        return FALSE;
+
+    CBRepArchiveWriter writer;
+    if (!writer.Open(iPath))
+        return FALSE;
+
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_WRITE);
+    vector<ITopo*> topos;
+    if (iBRep->GetTopoArray(topos) == PDV_RESULT_NO_ERROR)
+    {
+        for (size_t i = 0; i < topos.size(); i++)
+            writer.WriteTopo(topos[i]);
+    }
+    vector<IGeomPointData*> points;
+    if (iBRep->GetGeomPointDataArray(points) == PDV_RESULT_NO_ERROR)
+    {
+        for (size_t i = 0; i < points.size(); i++)
+            writer.WritePoint(points[i]);
+    }
+    vector<IGeomCurveData*> curves;
+    if (iBRep->GetGeomCurveDataArray(curves) == PDV_RESULT_NO_ERROR)
+    {
+        for (size_t i = 0; i < curves.size(); i++)
+            writer.WriteCurve(curves[i]);
+    }
+    vector<IGeomSurfaceData*> surfaces;
+    if (iBRep->GetGeomSurfaceDataArray(surfaces) == PDV_RESULT_NO_ERROR)
+    {
+        for (size_t i = 0; i < surfaces.size(); i++)
+            writer.WriteSurface(surfaces[i]);
+    }
+    return writer.Close(oStatistics);
+}
+
+CBRepArchiveReader::CBRepArchiveReader()
+{
+}
+
+DftBool CBRepArchiveReader::Open(const CUnicodeString& iPath)
+{
+    Close();
+    if (!m_File.Open(iPath))
+        return FALSE;
+
+    const DftByte* data = m_File.GetData();
+    DftUInt64 size = m_File.GetSize();
+    DftUInt32 version = 0;
+    DftUInt64 indexOffset = 0;
+    DftUInt32 sectionCount = 0;
+    if (size < BREP_ARCHIVE_HEADER_SIZE || memcmp(data, BREP_ARCHIVE_MAGIC, 4) != 0)
+    {
+        Close();
+        return FALSE;
+    }
+    memcpy(&version, data + 4, 4);
+    memcpy(&indexOffset, data + BREP_ARCHIVE_INDEX_OFFSET_POS, 8);
+    memcpy(&sectionCount, data + 16, 4);
+    if (version != BREP_ARCHIVE_VERSION || sectionCount < BREP_SECTION_COUNT || indexOffset > size ||
+        (size - indexOffset) / BREP_ARCHIVE_INDEX_ENTRY_SIZE < sectionCount)
+    {
+        Close();
+        return FALSE;
+    }
+
+    // 段索引，记录区和查找表都必须在文件内
+    DftUInt64 counts[BREP_SECTION_COUNT];
+    const DftByte* records[BREP_SECTION_COUNT];
+    const DftByte* tables[BREP_SECTION_COUNT];
+    DftUInt64 recordLengths[BREP_SECTION_COUNT];
+    DftUInt64 tableLengths[BREP_SECTION_COUNT];
+    for (int i = 0; i < BREP_SECTION_COUNT; i++)
+    {
+        const DftByte* entry = data + indexOffset + i * BREP_ARCHIVE_INDEX_ENTRY_SIZE;
+        DftUInt64 fields[5];
+        memcpy(fields, entry + 8, sizeof(fields));
+        if (fields[1] > size || fields[2] > size - fields[1] || fields[3] > size || fields[4] > size - fields[3])
+        {
+            Close();
+            return FALSE;
+        }
+        counts[i] = fields[0];
+        records[i] = data + fields[1];
+        recordLengths[i] = fields[2];
+        tables[i] = data + fields[3];
+        tableLengths[i] = fields[4];
+    }
+
+    // 拓扑段整体解码，子拓扑ID集中存放
+    CArchiveCursor topoCursor(records[BREP_SECTION_TOPO], recordLengths[BREP_SECTION_TOPO]);
+    DftUInt64 lastID = 0;
+    DftUInt64 lastGeometryIDs[4] = { 0, 0, 0, 0 };
+    if (counts[BREP_SECTION_TOPO] > recordLengths[BREP_SECTION_TOPO])
+    {
+        Close();
+        return FALSE;
+    }
+    m_Topos.resize(static_cast<size_t>(counts[BREP_SECTION_TOPO]));
+    for (size_t i = 0; i < m_Topos.size() && !topoCursor.IsFailed(); i++)
+    {
+        BRepArchiveTopo& topo = m_Topos[i];
+        topo._bitMask = topoCursor.ReadByte();
+        topo._type = topoCursor.ReadByte();
+        topo._id = lastID = topoCursor.ReadDelta(lastID);
+        topo._orientation = (topo._bitMask & TOPO_MASK_ORIENTATION) ? topoCursor.ReadByte() : static_cast<DftUInt8>(ORIENTATION_FORWARD);
+        topo._originalIDOffset = 0;
+        topo._originalIDLength = 0;
+        if (topo._bitMask & TOPO_MASK_PERSISTENTID)
+        {
+            topo._originalIDLength = static_cast<DftUInt>(topoCursor.ReadCount(1));
+            const DftByte* text = topoCursor.Skip(topo._originalIDLength);
+            topo._originalIDOffset = text ? static_cast<DftUInt64>(text - data) : 0;
+        }
+        topo._geometryType = GEOMTYPE_NULL;
+        topo._geometryID = 0;
+        if (topo._bitMask & TOPO_MASK_GEOMETRY)
+        {
+            topo._geometryType = topoCursor.ReadByte();
+            DftUInt64& lastGeometryID = lastGeometryIDs[topo._geometryType & 3];
+            topo._geometryID = lastGeometryID = topoCursor.ReadDelta(lastGeometryID);
+        }
+        topo._firstChild = static_cast<DftUInt>(m_ChildIDs.size());
+        topo._childCount = 0;
+        if (topo._bitMask & TOPO_MASK_TOPODATA)
+        {
+            topo._childCount = static_cast<DftUInt>(topoCursor.ReadCount(1));
+            DftUInt64 last = topo._id;
+            for (DftUInt j = 0; j < topo._childCount; j++)
+            {
+                last = topoCursor.ReadDelta(last);
+                m_ChildIDs.push_back(last);
+            }
+        }
+        m_TopoIndexes[topo._id] = static_cast<DftUInt>(i);
+    }
+    if (topoCursor.IsFailed() || !topoCursor.IsEnd())
+    {
+        Close();
+        return FALSE;
+    }
+
+    // 几何段只解码查找表，记录按长度累加得到偏移
+    for (int i = BREP_SECTION_POINT; i < BREP_SECTION_COUNT; i++)
+    {
+        CArchiveCursor tableCursor(tables[i], tableLengths[i]);
+        if (counts[i] > tableLengths[i])
+        {
+            Close();
+            return FALSE;
+        }
+        m_Geometries[i].resize(static_cast<size_t>(counts[i]));
+        DftUInt64 id = 0;
+        DftUInt64 offset = static_cast<DftUInt64>(records[i] - data);
+        DftUInt64 end = offset + recordLengths[i];
+        for (size_t j = 0; j < m_Geometries[i].size() && !tableCursor.IsFailed(); j++)
+        {
+            id = tableCursor.ReadDelta(id);
+            GeometryEntry& entry = m_Geometries[i][j];
+            entry._offset = offset;
+            entry._length = tableCursor.ReadULEB128();
+            // 记录超出几何段即为损坏，不能留下未建立索引的记录
+            if (entry._length > end - offset)
+            {
+                Close();
+                return FALSE;
+            }
+            offset += entry._length;
+            m_GeometryIndexes[i][id] = static_cast<DftUInt>(j);
+        }
+        if (tableCursor.IsFailed() || !tableCursor.IsEnd() || offset != end)
+        {
+            Close();
+            return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+void CBRepArchiveReader::Close()
+{
+    m_Topos.clear();
+    m_ChildIDs.clear();
+    m_TopoIndexes.clear();
+    for (int i = 0; i < BREP_SECTION_COUNT; i++)
+    {
+        m_Geometries[i].clear();
+        m_GeometryIndexes[i].clear();
+    }
+    m_File.Close();
+}
+
+DftInt CBRepArchiveReader::FindTopo(DftUInt64 iID) const
+{
+    unordered_map<DftUInt64, DftUInt>::const_iterator it = m_TopoIndexes.find(iID);
+    return it == m_TopoIndexes.end() ? -1 : static_cast<DftInt>(it->second);
+}
+
+string CBRepArchiveReader::GetOriginalID(const BRepArchiveTopo& iTopo) const
+{
+    if (!iTopo._originalIDLength || !m_File.GetData())
+        return string();
+    return string(reinterpret_cast<const char*>(m_File.GetData() + iTopo._originalIDOffset), iTopo._originalIDLength);
+}
+
+void CBRepArchiveReader::GetFaces(vector<DftUInt>& oIndexes) const
+{
+    oIndexes.clear();
+    for (size_t i = 0; i < m_Topos.size(); i++)
+    {
+        if (m_Topos[i]._type == TOPOTYPE_FACE)
+            oIndexes.push_back(static_cast<DftUInt>(i));
+    }
+}
+
+DftUInt CBRepArchiveReader::GetGeometryCount(BRepArchiveSection iSection) const
+{
+    return iSection == BREP_SECTION_TOPO ? GetTopoCount() : static_cast<DftUInt>(m_Geometries[iSection].size());
+}
+
+const CBRepArchiveReader::GeometryEntry* CBRepArchiveReader::FindGeometry(BRepArchiveSection iSection, DftUInt64 iID) const
+{
+    unordered_map<DftUInt64, DftUInt>::const_iterator it = m_GeometryIndexes[iSection].find(iID);
+    return it == m_GeometryIndexes[iSection].end() ? NULL : &m_Geometries[iSection][it->second];
+}
+
+DftBool CBRepArchiveReader::ReadPoint(DftUInt64 iID, PDVVector3D& oPosition) const
+{
+    const GeometryEntry* entry = FindGeometry(BREP_SECTION_POINT, iID);
+    if (!entry)
+        return FALSE;
+    CArchiveCursor cursor(m_File.GetData() + entry->_offset, entry->_length);
+    cursor.ReadDoubles(oPosition._data, 3);
+    return cursor.IsFailed() ? FALSE : TRUE;
+}
+
+DftBool CBRepArchiveReader::ReadCurve(DftUInt64 iID, BRepArchiveCurve& oCurve) const
+{
+    const GeometryEntry* entry = FindGeometry(BREP_SECTION_CURVE, iID);
+    if (!entry)
+        return FALSE;
+    oCurve = BRepArchiveCurve();
+    oCurve._id = iID;
+    CArchiveCursor cursor(m_File.GetData() + entry->_offset, entry->_length);
+    DecodeCurve(cursor, oCurve);
+    return cursor.IsFailed() || !cursor.IsEnd() ? FALSE : TRUE;
+}
+
+DftBool CBRepArchiveReader::ReadSurface(DftUInt64 iID, BRepArchiveSurface& oSurface) const
+{
+    const GeometryEntry* entry = FindGeometry(BREP_SECTION_SURFACE, iID);
+    if (!entry)
+        return FALSE;
+    oSurface = BRepArchiveSurface();
+    oSurface._id = iID;
+    CArchiveCursor cursor(m_File.GetData() + entry->_offset, entry->_length);
+    DecodeSurface(cursor, oSurface);
+    return cursor.IsFailed() || !cursor.IsEnd() ? FALSE : TRUE;
+}
+
+DftBool CBRepArchiveReader::LoadEdge(const BRepArchiveTopo* iCoedge, const BRepArchiveTopo& iEdge, BRepArchiveEdge& oEdge) const
+{
+    oEdge._coedgeID = iCoedge ? iCoedge->_id : 0;
+    oEdge._edgeID = iEdge._id;
+    oEdge._orientation = iCoedge ? iCoedge->_orientation : iEdge._orientation;
+
+    // 曲线优先取边关联的，边没有曲线时取共边关联的
+    const BRepArchiveTopo* curveOwner = iEdge._geometryType == GEOMTYPE_CURVE ? &iEdge
+        : (iCoedge && iCoedge->_geometryType == GEOMTYPE_CURVE ? iCoedge : NULL);
+    oEdge._hasCurve = FALSE;
+    if (curveOwner && FindGeometry(BREP_SECTION_CURVE, curveOwner->_geometryID))
+    {
+        if (!ReadCurve(curveOwner->_geometryID, oEdge._curve))
+            return FALSE;
+        oEdge._hasCurve = TRUE;
+    }
+
+    oEdge._vertices.clear();
+    const DftUInt64* children = GetChildIDs(iEdge);
+    for (DftUInt i = 0; i < iEdge._childCount; i++)
+    {
+        DftInt index = FindTopo(children[i]);
+        if (index < 0)
+            continue;
+        const BRepArchiveTopo& vertex = m_Topos[index];
+        if (vertex._type != TOPOTYPE_VERTEX || vertex._geometryType != GEOMTYPE_POINT ||
+            !FindGeometry(BREP_SECTION_POINT, vertex._geometryID))
+            continue;
+        PDVVector3D position;
+        if (!ReadPoint(vertex._geometryID, position))
+            return FALSE;
+        oEdge._vertices.push_back(position);
+    }
+    return TRUE;
+}
+
+DftBool CBRepArchiveReader::LoadFace(DftUInt iTopoIndex, BRepArchiveFace& oFace) const
+{
+    if (iTopoIndex >= m_Topos.size() || m_Topos[iTopoIndex]._type != TOPOTYPE_FACE)
+        return FALSE;
+
+    const BRepArchiveTopo& face = m_Topos[iTopoIndex];
+    oFace._id = face._id;
+    oFace._orientation = face._orientation;
+    oFace._hasSurface = FALSE;
+    oFace._loops.clear();
+    if (face._geometryType == GEOMTYPE_SURFACE && FindGeometry(BREP_SECTION_SURFACE, face._geometryID))
+    {
+        if (!ReadSurface(face._geometryID, oFace._surface))
+            return FALSE;
+        oFace._hasSurface = TRUE;
+    }
+
+    const DftUInt64* loopIDs = GetChildIDs(face);
+    for (DftUInt i = 0; i < face._childCount; i++)
+    {
+        DftInt loopIndex = FindTopo(loopIDs[i]);
+        if (loopIndex < 0 || m_Topos[loopIndex]._type != TOPOTYPE_LOOP)
+            continue;
+        const BRepArchiveTopo& loop = m_Topos[loopIndex];
+        oFace._loops.push_back(BRepArchiveLoop());
+        BRepArchiveLoop& loopData = oFace._loops.back();
+        loopData._id = loop._id;
+
+        const DftUInt64* edgeIDs = GetChildIDs(loop);
+        for (DftUInt j = 0; j < loop._childCount; j++)
+        {
+            DftInt index = FindTopo(edgeIDs[j]);
+            if (index < 0)
+                continue;
+            const BRepArchiveTopo& child = m_Topos[index];
+            const BRepArchiveTopo* coedge = NULL;
+            const BRepArchiveTopo* edge = NULL;
+            if (child._type == TOPOTYPE_EDGE)
+                edge = &child;
+            else if (child._type == TOPOTYPE_COEDGE)
+            {
+                coedge = &child;
+                const DftUInt64* coedgeChildren = GetChildIDs(child);
+                for (DftUInt k = 0; k < child._childCount && !edge; k++)
+                {
+                    DftInt edgeIndex = FindTopo(coedgeChildren[k]);
+                    if (edgeIndex >= 0 && m_Topos[edgeIndex]._type == TOPOTYPE_EDGE)
+                        edge = &m_Topos[edgeIndex];
+                }
+            }
+            if (!edge)
+                continue;
+            loopData._edges.push_back(BRepArchiveEdge());
+            if (!LoadEdge(coedge, *edge, loopData._edges.back()))
+                return FALSE;
+        }
+    }
+    return TRUE;
+}
+
+DftBool LoadBRepCurve(IGeomCurveData* iCurve, BRepArchiveCurve& oCurve)
+{
+    if (!iCurve)
+        return FALSE;
+    vector<DftByte> record;
+    EncodeCurveRecord(iCurve, record);
+    oCurve = BRepArchiveCurve();
+    oCurve._id = iCurve->GetID();
+    CArchiveCursor cursor(&record[0], record.size());
+    DecodeCurve(cursor, oCurve);
+    return cursor.IsFailed() || !cursor.IsEnd() ? FALSE : TRUE;
+}
+
+DftBool LoadBRepSurface(IGeomSurfaceData* iSurface, BRepArchiveSurface& oSurface)
+{
+    if (!iSurface)
+        return FALSE;
+    vector<DftByte> record;
+    EncodeSurfaceRecord(iSurface, record);
+    oSurface = BRepArchiveSurface();
+    oSurface._id = iSurface->GetID();
+    CArchiveCursor cursor(&record[0], record.size());
+    DecodeSurface(cursor, oSurface);
+    return cursor.IsFailed() || !cursor.IsEnd() ? FALSE : TRUE;
+}
+
+CBRepFaceLoader::CBRepFaceLoader()
+{
+}
+
+DftBool CBRepFaceLoader::Open(IBRep* iBRep)
+{
+    Close();
+    if (!m_Graph.Build(iBRep))
+        return FALSE;
+
+    // 几何数组缺失时按没有该类几何处理，与存档中缺少对应段一致
+    if (iBRep->GetGeomPointDataArray(m_Points) != PDV_RESULT_NO_ERROR)
+        m_Points.clear();
+    if (iBRep->GetGeomCurveDataArray(m_Curves) != PDV_RESULT_NO_ERROR)
+        m_Curves.clear();
+    if (iBRep->GetGeomSurfaceDataArray(m_Surfaces) != PDV_RESULT_NO_ERROR)
+        m_Surfaces.clear();
+
+    m_PointIndexes.Reserve(m_Points.size());
+    for (size_t i = 0; i < m_Points.size(); i++)
+    {
+        if (m_Points[i])
+            m_PointIndexes.Insert(m_Points[i]->GetID(), static_cast<DftUInt>(i));
+    }
+    m_CurveIndexes.Reserve(m_Curves.size());
+    for (size_t i = 0; i < m_Curves.size(); i++)
+    {
+        if (m_Curves[i])
+            m_CurveIndexes.Insert(m_Curves[i]->GetID(), static_cast<DftUInt>(i));
+    }
+    m_SurfaceIndexes.Reserve(m_Surfaces.size());
+    for (size_t i = 0; i < m_Surfaces.size(); i++)
+    {
+        if (m_Surfaces[i])
+            m_SurfaceIndexes.Insert(m_Surfaces[i]->GetID(), static_cast<DftUInt>(i));
+    }
+    return TRUE;
+}
+
+void CBRepFaceLoader::Close()
+{
+    m_Graph.Clear();
+    m_Points.clear();
+    m_Curves.clear();
+    m_Surfaces.clear();
+    m_PointIndexes.Clear();
+    m_CurveIndexes.Clear();
+    m_SurfaceIndexes.Clear();
+}
+
+void CBRepFaceLoader::GetFaces(vector<DftUInt>& oIndexes) const
+{
+    oIndexes.clear();
+    for (DftUInt i = 0; i < m_Graph.GetCount(); i++)
+    {
+        if (m_Graph.GetType(i) == TOPOTYPE_FACE)
+            oIndexes.push_back(i);
+    }
+}
+
+DftBool CBRepFaceLoader::LoadEdge(DftUInt iCoedge, DftUInt iEdge, BRepArchiveEdge& oEdge) const
+{
+    bool hasCoedge = iCoedge != PDV_TOPO_INVALID_INDEX;
+    oEdge._coedgeID = hasCoedge ? m_Graph.GetID(iCoedge) : 0;
+    oEdge._edgeID = m_Graph.GetID(iEdge);
+    oEdge._orientation = m_Graph.GetOrientation(hasCoedge ? iCoedge : iEdge);
+
+    // 曲线优先取边关联的，边没有曲线时取共边关联的
+    DftUInt curveOwner = m_Graph.GetGeometryType(iEdge) == GEOMTYPE_CURVE ? iEdge
+        : (hasCoedge && m_Graph.GetGeometryType(iCoedge) == GEOMTYPE_CURVE ? iCoedge : PDV_TOPO_INVALID_INDEX);
+    DftUInt curve = curveOwner == PDV_TOPO_INVALID_INDEX ? PDV_SCENE_INVALID_SLOT
+        : m_CurveIndexes.Find(m_Graph.GetGeometryID(curveOwner));
+    oEdge._hasCurve = FALSE;
+    if (curve != PDV_SCENE_INVALID_SLOT)
+    {
+        if (!LoadBRepCurve(m_Curves[curve], oEdge._curve))
+            return FALSE;
+        oEdge._hasCurve = TRUE;
+    }
+
+    oEdge._vertices.clear();
+    const DftUInt* children = m_Graph.GetChildren(iEdge);
+    for (DftUInt i = 0; i < m_Graph.GetChildCount(iEdge); i++)
+    {
+        DftUInt vertex = children[i];
+        if (m_Graph.GetType(vertex) != TOPOTYPE_VERTEX || m_Graph.GetGeometryType(vertex) != GEOMTYPE_POINT)
+            continue;
+        DftUInt point = m_PointIndexes.Find(m_Graph.GetGeometryID(vertex));
+        if (point != PDV_SCENE_INVALID_SLOT)
+            oEdge._vertices.push_back(m_Points[point]->GetPosition());
+    }
+    return TRUE;
+}
+
+DftBool CBRepFaceLoader::LoadFace(DftUInt iTopoIndex, BRepArchiveFace& oFace) const
+{
+    if (iTopoIndex >= m_Graph.GetCount() || m_Graph.GetType(iTopoIndex) != TOPOTYPE_FACE)
+        return FALSE;
+
+    oFace._id = m_Graph.GetID(iTopoIndex);
+    oFace._orientation = m_Graph.GetOrientation(iTopoIndex);
+    oFace._hasSurface = FALSE;
+    oFace._loops.clear();
+    DftUInt surface = m_Graph.GetGeometryType(iTopoIndex) == GEOMTYPE_SURFACE
+        ? m_SurfaceIndexes.Find(m_Graph.GetGeometryID(iTopoIndex)) : PDV_SCENE_INVALID_SLOT;
+    if (surface != PDV_SCENE_INVALID_SLOT)
+    {
+        if (!LoadBRepSurface(m_Surfaces[surface], oFace._surface))
+            return FALSE;
+        oFace._hasSurface = TRUE;
+    }
+
+    const DftUInt* loops = m_Graph.GetChildren(iTopoIndex);
+    for (DftUInt i = 0; i < m_Graph.GetChildCount(iTopoIndex); i++)
+    {
+        DftUInt loop = loops[i];
+        if (m_Graph.GetType(loop) != TOPOTYPE_LOOP)
+            continue;
+        oFace._loops.push_back(BRepArchiveLoop());
+        BRepArchiveLoop& loopData = oFace._loops.back();
+        loopData._id = m_Graph.GetID(loop);
+
+        const DftUInt* children = m_Graph.GetChildren(loop);
+        for (DftUInt j = 0; j < m_Graph.GetChildCount(loop); j++)
+        {
+            DftUInt child = children[j];
+            DftUInt coedge = PDV_TOPO_INVALID_INDEX;
+            DftUInt edge = PDV_TOPO_INVALID_INDEX;
+            if (m_Graph.GetType(child) == TOPOTYPE_EDGE)
+                edge = child;
+            else if (m_Graph.GetType(child) == TOPOTYPE_COEDGE)
+            {
+                coedge = child;
+                const DftUInt* coedgeChildren = m_Graph.GetChildren(child);
+                for (DftUInt k = 0; k < m_Graph.GetChildCount(child) && edge == PDV_TOPO_INVALID_INDEX; k++)
+                {
+                    if (m_Graph.GetType(coedgeChildren[k]) == TOPOTYPE_EDGE)
+                        edge = coedgeChildren[k];
+                }
+            }
+            if (edge == PDV_TOPO_INVALID_INDEX)
+                continue;
+            loopData._edges.push_back(BRepArchiveEdge());
+            if (!LoadEdge(coedge, edge, loopData._edges.back()))
+                return FALSE;
+        }
+    }
+    return TRUE;
+}
@@ -0,0 +1,421 @@
+/**
+ * @file pdvbreparchive.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：BRep的二进制存档
+ * @details 一个IBRep写为一个文件，依次为文件头、拓扑段、点段、曲线段、曲面段和段索引。整数按ULEB128编码，
+ *          有符号的差值先做ZigZag变换；字符串和数组先写ULEB128长度再写内容，与DftBufferStream的*ULEB128Length/ArrayULEB128读取方式一致；
+ *          浮点数按小端8字节原样写出，不损失精度。
+ *          拓扑段逐条记录内容标识、类型、方向、原生标识、关联几何和子拓扑，拓扑ID与前一条记录求差，子拓扑ID与前一个子拓扑求差，
+ *          几何ID与同类几何的前一个ID求差。几何段的记录按类型写出参数块（直线、圆、椭圆、NURBS曲线，平面、圆柱、圆锥、圆环、球、NURBS曲面），
+ *          记录之后是查找表（ID差值和记录长度），读取时只解码拓扑段和查找表，面的几何按需从映射的文件中解码。
+ *          写出时记录逐条编码后进入大块缓冲，内存中只保留查找表。
+ *          CBRepFaceLoader按同样的规则从内存中的IBRep加载面，曲线和曲面经同一套编解码转换为存档的数据结构，
+ *          因此曲面细分等使用方可以不区分数据来自存档还是PDV文件。
+ */
+
+#ifndef PDVBREPARCHIVE_H
+#define PDVBREPARCHIVE_H
+
+#include "PDVBase.h"
+#include "PDVIGeomFactory.h"
+#include "pdvfilewriter.h"
+#include "pdvloader.h"
+#include "pdvtopograph.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+class IBRep;
+class ITopo;
+class IGeomPointData;
+class IGeomCurveData;
+class IGeomSurfaceData;
+} // namespace pdv
+} // namespace kernel
+
+/** @brief 存档中的段，按此顺序写出 */
+enum BRepArchiveSection
+{
+    BREP_SECTION_TOPO = 0,    ///< 拓扑
+    BREP_SECTION_POINT = 1,   ///< 几何点
+    BREP_SECTION_CURVE = 2,   ///< 几何曲线
+    BREP_SECTION_SURFACE = 3, ///< 几何曲面
+    BREP_SECTION_COUNT = 4,   ///< 段数
+};
+
+/** @brief 存档中的拓扑记录 */
+struct BRepArchiveTopo
+{
+    DftUInt64 _id;               ///< 拓扑ID
+    DftUInt64 _geometryID;       ///< 关联的几何ID
+    DftUInt8 _bitMask;           ///< 内容标识，见TopoMask
+    DftUInt8 _type;              ///< 拓扑类型，见TOPOTYPE
+    DftUInt8 _orientation;       ///< 方向，见ORIENTATION
+    DftUInt8 _geometryType;      ///< 关联的几何类型，见GEOMTYPE
+    DftUInt _firstChild;         ///< 子拓扑ID在读取对象子拓扑数组中的起始位置
+    DftUInt _childCount;         ///< 子拓扑数
+    DftUInt64 _originalIDOffset; ///< 原生标识（UTF-8）在文件中的偏移
+    DftUInt _originalIDLength;   ///< 原生标识的字节数
+};
+
+/** @brief 曲面上的二维参数曲线 */
+struct BRepArchiveCurve2d
+{
+    DftUInt64 _surfaceID;                  ///< 所在曲面的ID
+    DftUInt8 _type;                        ///< 曲线类型，见CurveType
+    DftUInt8 _parameterType;               ///< 参数块的类型，没有曲线接口或类型不支持时为CT_UNDIFINED
+    DftDouble _start;                      ///< 起始参数
+    DftDouble _end;                        ///< 终止参数
+    PDVVector2D _origin;                   ///< 原点
+    PDVVector2D _xDirection;               ///< X方向，直线时为方向
+    PDVVector2D _yDirection;               ///< Y方向
+    DftDouble _radius;                     ///< 圆的半径，椭圆的长半轴
+    DftDouble _minorRadius;                ///< 椭圆的短半轴
+    kernel::pdv::NurbsCurve2dData _nurbs;  ///< NURBS曲线数据
+
+    BRepArchiveCurve2d() : _surfaceID(0), _type(0), _parameterType(0), _start(0.0), _end(0.0), _radius(0.0), _minorRadius(0.0) {}
+};
+
+/** @brief 几何曲线 */
+struct BRepArchiveCurve
+{
+    DftUInt64 _id;                             ///< 曲线ID
+    DftUInt8 _type;                            ///< 曲线类型，见CurveType
+    DftUInt8 _parameterType;                   ///< 参数块的类型，没有曲线接口或类型不支持时为CT_UNDIFINED
+    DftDouble _start;                          ///< 起始参数
+    DftDouble _end;                            ///< 终止参数
+    PDVVector3D _origin;                       ///< 原点
+    PDVVector3D _xDirection;                   ///< X方向，直线时为方向
+    PDVVector3D _yDirection;                   ///< Y方向
+    PDVVector3D _zDirection;                   ///< Z方向
+    DftDouble _radius;                         ///< 圆的半径，椭圆的长半轴
+    DftDouble _minorRadius;                    ///< 椭圆的短半轴
+    kernel::pdv::NurbsCurveData _nurbs;        ///< NURBS曲线数据
+    std::vector<BRepArchiveCurve2d> _pcurves;  ///< 各曲面上的参数曲线
+
+    BRepArchiveCurve() : _id(0), _type(0), _parameterType(0), _start(0.0), _end(0.0), _radius(0.0), _minorRadius(0.0) {}
+};
+
+/** @brief 几何曲面 */
+struct BRepArchiveSurface
+{
+    DftUInt64 _id;                         ///< 曲面ID
+    DftUInt8 _type;                        ///< 曲面类型，见SurfaceType
+    DftUInt8 _parameterType;               ///< 参数块的类型，没有曲面接口或类型不支持时为ST_UNDIFINED
+    PDVVector2D _domainMin;                ///< 参数域最小值
+    PDVVector2D _domainMax;                ///< 参数域最大值
+    PDVVector3D _origin;                   ///< 原点
+    PDVVector3D _xDirection;               ///< X方向
+    PDVVector3D _yDirection;               ///< Y方向
+    PDVVector3D _zDirection;               ///< Z方向，平面的法向、回转面的轴向
+    DftDouble _radius;                     ///< 圆柱、圆锥、球的半径，圆环的大半径
+    DftDouble _minorRadius;                ///< 圆环的小半径
+    DftDouble _halfAngle;                  ///< 圆锥的半角
+    kernel::pdv::NurbsSurfaceData _nurbs;  ///< NURBS曲面数据
+
+    BRepArchiveSurface() : _id(0), _type(0), _parameterType(0), _radius(0.0), _minorRadius(0.0), _halfAngle(0.0) {}
+};
+
+/** @brief 按需加载的面中的一条边 */
+struct BRepArchiveEdge
+{
+    DftUInt64 _coedgeID;                 ///< 共边ID，环中直接是边时为0
+    DftUInt64 _edgeID;                   ///< 边ID
+    DftUInt8 _orientation;               ///< 共边（没有共边时为边）的方向
+    DftBool _hasCurve;                   ///< 是否有关联的几何曲线
+    BRepArchiveCurve _curve;             ///< 几何曲线
+    std::vector<PDVVector3D> _vertices;  ///< 边的顶点位置
+
+    BRepArchiveEdge() : _coedgeID(0), _edgeID(0), _orientation(0), _hasCurve(FALSE) {}
+};
+
+/** @brief 按需加载的面中的一个环 */
+struct BRepArchiveLoop
+{
+    DftUInt64 _id;                        ///< 环ID
+    std::vector<BRepArchiveEdge> _edges;  ///< 按顺序排列的边
+};
+
+/** @brief 按需加载的面 */
+struct BRepArchiveFace
+{
+    DftUInt64 _id;                        ///< 面ID
+    DftUInt8 _orientation;                ///< 面的方向
+    DftBool _hasSurface;                  ///< 是否有关联的几何曲面
+    BRepArchiveSurface _surface;          ///< 几何曲面
+    std::vector<BRepArchiveLoop> _loops;  ///< 面的环
+
+    BRepArchiveFace() : _id(0), _orientation(0), _hasSurface(FALSE) {}
+};
+
+/** @brief 存档统计 */
+struct BRepArchiveStatistics
+{
+    DftUInt64 _topoCount;     ///< 拓扑数
+    DftUInt64 _pointCount;    ///< 几何点数
+    DftUInt64 _curveCount;    ///< 几何曲线数
+    DftUInt64 _surfaceCount;  ///< 几何曲面数
+    DftUInt64 _bytes;         ///< 文件长度
+
+    BRepArchiveStatistics() : _topoCount(0), _pointCount(0), _curveCount(0), _surfaceCount(0), _bytes(0) {}
+};
+
+/** @brief BRep存档的流式输出类，记录须按段的顺序写入 */
+class CBRepArchiveWriter
+{
+public:
+    CBRepArchiveWriter();
+
+    /**
+     * @brief 创建存档文件并写入文件头
+     * @return DftBool 是否成功
+     * @param[in] iPath 文件路径
+     */
+    DftBool Open(const std::string& iPath);
+
+    /**
+     * @brief 写出最后一段的查找表和段索引，回填文件头后关闭文件
+     * @return DftBool 所有数据是否都已成功写入
+     * @param[out] oStatistics 存档统计，可为NULL
+     */
+    DftBool Close(BRepArchiveStatistics* oStatistics = NULL);
+
+    /**
+     * @brief 写入一条拓扑记录
+     * @return DftBool 是否成功，点、曲线或曲面段已开始时为FALSE
+     * @param[in] iTopo 拓扑对象
+     */
+    DftBool WriteTopo(kernel::pdv::ITopo* iTopo);
+
+    /**
+     * @brief 写入一个几何点
+     * @return DftBool 是否成功，曲线或曲面段已开始时为FALSE
+     * @param[in] iPoint 几何点
+     */
+    DftBool WritePoint(kernel::pdv::IGeomPointData* iPoint);
+
+    /**
+     * @brief 写入一条几何曲线及其参数曲线
+     * @return DftBool 是否成功，曲面段已开始时为FALSE
+     * @param[in] iCurve 几何曲线
+     */
+    DftBool WriteCurve(kernel::pdv::IGeomCurveData* iCurve);
+
+    /**
+     * @brief 写入一个几何曲面
+     * @return DftBool 是否成功
+     * @param[in] iSurface 几何曲面
+     */
+    DftBool WriteSurface(kernel::pdv::IGeomSurfaceData* iSurface);
+
+private:
+    CBRepArchiveWriter(const CBRepArchiveWriter&);
+    CBRepArchiveWriter& operator=(const CBRepArchiveWriter&);
+
+    /** 切换到iSection，写出之前各段的查找表 */
+    DftBool EnterSection(BRepArchiveSection iSection);
+    /** 结束当前段 */
+    void EndSection();
+    /** 把m_Record作为当前段的一条记录写出 */
+    void CommitRecord(DftUInt64 iID);
+
+    /** @brief 段的位置 */
+    struct SectionInfo
+    {
+        DftUInt64 _count;        ///< 记录数
+        DftUInt64 _offset;       ///< 记录的起始偏移
+        DftUInt64 _length;       ///< 记录的总字节数
+        DftUInt64 _tableOffset;  ///< 查找表的偏移
+        DftUInt64 _tableLength;  ///< 查找表的字节数
+    };
+
+    CBufferedFileWriter m_File;                  ///< 输出文件
+    SectionInfo m_Sections[BREP_SECTION_COUNT];  ///< 各段的位置
+    DftInt m_Section;                            ///< 当前段，未开始时为-1
+    DftUInt64 m_LastID;                          ///< 当前段上一条记录的ID
+    DftUInt64 m_LastGeometryIDs[4];              ///< 拓扑记录中各类几何的上一个ID，按GEOMTYPE索引
+    std::vector<DftByte> m_Record;               ///< 当前记录的编码，可复用
+    std::vector<DftByte> m_Table;                ///< 当前几何段的查找表
+};
+
+/**
+ * @brief 将IBRep写为二进制存档
+ * @return DftBool 是否成功
+ * @param[in] iBRep BRep对象
+ * @param[in] iPath 文件路径
+ * @param[out] oStatistics 存档统计，可为NULL
+ */
+DftBool WriteBRepArchive(kernel::pdv::IBRep* iBRep, const std::string& iPath, BRepArchiveStatistics* oStatistics = NULL);
+
+/**
+ * @brief BRep存档的读取类
+ * @details 打开时映射整个文件并解码拓扑段和几何查找表，几何记录和面在调用时才从映射数据中解码；
+ *          打开后各读取方法只读访问，可在多个线程中同时调用。
+ */
+class CBRepArchiveReader
+{
+public:
+    CBRepArchiveReader();
+
+    /**
+     * @brief 打开存档
+     * @return DftBool 是否成功，文件头、段索引、拓扑段或查找表损坏时为FALSE
+     * @param[in] iPath 文件路径
+     */
+    DftBool Open(const CUnicodeString& iPath);
+
+    /** @brief 关闭存档，释放拓扑表和映射 */
+    void Close();
+
+    /** @brief 拓扑数 */
+    DftUInt GetTopoCount() const { return static_cast<DftUInt>(m_Topos.size()); }
+    /** @brief 按存档中的顺序获取拓扑记录 */
+    const BRepArchiveTopo& GetTopo(DftUInt iIndex) const { return m_Topos[iIndex]; }
+    /** @brief 拓扑记录的子拓扑ID，共iTopo._childCount个 */
+    const DftUInt64* GetChildIDs(const BRepArchiveTopo& iTopo) const { return iTopo._childCount ? &m_ChildIDs[iTopo._firstChild] : NULL; }
+
+    /**
+     * @brief 按ID查找拓扑记录
+     * @return DftInt 拓扑记录的序号，不存在时为-1
+     * @param[in] iID 拓扑ID
+     */
+    DftInt FindTopo(DftUInt64 iID) const;
+
+    /** @brief 拓扑记录的原生标识（UTF-8） */
+    std::string GetOriginalID(const BRepArchiveTopo& iTopo) const;
+
+    /** @brief 按存档中的顺序列出所有面的拓扑序号 */
+    void GetFaces(std::vector<DftUInt>& oIndexes) const;
+
+    /** @brief 几何点、曲线或曲面的数目 */
+    DftUInt GetGeometryCount(BRepArchiveSection iSection) const;
+
+    /**
+     * @brief 解码几何点
+     * @return DftBool 是否成功，ID不存在或记录损坏时为FALSE
+     * @param[in] iID 几何点ID
+     * @param[out] oPosition 点的位置
+     */
+    DftBool ReadPoint(DftUInt64 iID, PDVVector3D& oPosition) const;
+
+    /**
+     * @brief 解码几何曲线
+     * @return DftBool 是否成功，ID不存在或记录损坏时为FALSE
+     * @param[in] iID 几何曲线ID
+     * @param[out] oCurve 曲线数据
+     */
+    DftBool ReadCurve(DftUInt64 iID, BRepArchiveCurve& oCurve) const;
+
+    /**
+     * @brief 解码几何曲面
+     * @return DftBool 是否成功，ID不存在或记录损坏时为FALSE
+     * @param[in] iID 几何曲面ID
+     * @param[out] oSurface 曲面数据
+     */
+    DftBool ReadSurface(DftUInt64 iID, BRepArchiveSurface& oSurface) const;
+
+    /**
+     * @brief 加载一个面及其环、边、曲线、顶点和曲面
+     * @return DftBool 是否成功，iTopoIndex不是面或引用的几何记录损坏时为FALSE
+     * @param[in] iTopoIndex 面的拓扑序号
+     * @param[out] oFace 面数据
+     * @note 环下直接是边（没有共边）时也按边处理；不存在的子拓扑和几何被跳过
+     */
+    DftBool LoadFace(DftUInt iTopoIndex, BRepArchiveFace& oFace) const;
+
+private:
+    CBRepArchiveReader(const CBRepArchiveReader&);
+    CBRepArchiveReader& operator=(const CBRepArchiveReader&);
+
+    /** @brief 几何记录的位置 */
+    struct GeometryEntry
+    {
+        DftUInt64 _offset;  ///< 记录在文件中的偏移
+        DftUInt64 _length;  ///< 记录的字节数
+    };
+
+    /** 查找几何记录，不存在时返回NULL */
+    const GeometryEntry* FindGeometry(BRepArchiveSection iSection, DftUInt64 iID) const;
+    /** 加载共边或边，iEdge为边时iCoedge为NULL */
+    DftBool LoadEdge(const BRepArchiveTopo* iCoedge, const BRepArchiveTopo& iEdge, BRepArchiveEdge& oEdge) const;
+
+    CMappedFile m_File;                                                       ///< 映射的存档文件
+    std::vector<BRepArchiveTopo> m_Topos;                                     ///< 拓扑表
+    std::vector<DftUInt64> m_ChildIDs;                                        ///< 所有拓扑的子拓扑ID
+    std::unordered_map<DftUInt64, DftUInt> m_TopoIndexes;                     ///< 拓扑ID到序号
+    std::vector<GeometryEntry> m_Geometries[BREP_SECTION_COUNT];              ///< 各几何段的记录位置
+    std::unordered_map<DftUInt64, DftUInt> m_GeometryIndexes[BREP_SECTION_COUNT]; ///< 各几何段的ID到记录序号
+};
+
+/**
+ * @brief 由几何曲线接口得到曲线数据，与写入存档后读出的结果一致
+ * @return DftBool 是否成功
+ * @param[in] iCurve 几何曲线
+ * @param[out] oCurve 曲线数据
+ */
+DftBool LoadBRepCurve(kernel::pdv::IGeomCurveData* iCurve, BRepArchiveCurve& oCurve);
+
+/**
+ * @brief 由几何曲面接口得到曲面数据，与写入存档后读出的结果一致
+ * @return DftBool 是否成功
+ * @param[in] iSurface 几何曲面
+ * @param[out] oSurface 曲面数据
+ */
+DftBool LoadBRepSurface(kernel::pdv::IGeomSurfaceData* iSurface, BRepArchiveSurface& oSurface);
+
+/**
+ * @brief 从内存中的IBRep按需加载面
+ * @details 打开时建立拓扑图和几何的ID索引，面、环、共边、边和顶点的查找规则与CBRepArchiveReader::LoadFace相同。
+ *          加载时调用IBRep的几何接口，多个线程使用同一场景时须由调用方加锁。
+ */
+class CBRepFaceLoader
+{
+public:
+    CBRepFaceLoader();
+
+    /**
+     * @brief 建立拓扑图和几何索引
+     * @return DftBool 是否成功，iBRep为NULL或取不到拓扑数组时为FALSE
+     * @param[in] iBRep BRep对象，加载期间须保持有效
+     */
+    DftBool Open(kernel::pdv::IBRep* iBRep);
+
+    /** @brief 释放拓扑图和索引 */
+    void Close();
+
+    /** @brief 拓扑图，序号即LoadFace使用的拓扑序号 */
+    const CTopoGraph& GetGraph() const { return m_Graph; }
+
+    /** @brief 按拓扑数组的顺序列出所有面的拓扑序号 */
+    void GetFaces(std::vector<DftUInt>& oIndexes) const;
+
+    /**
+     * @brief 加载面及其曲面、环、边、曲线和顶点
+     * @return DftBool 是否成功，iTopoIndex不是面时为FALSE
+     * @param[in] iTopoIndex 面的拓扑序号
+     * @param[out] oFace 面
+     */
+    DftBool LoadFace(DftUInt iTopoIndex, BRepArchiveFace& oFace) const;
+
+private:
+    CBRepFaceLoader(const CBRepFaceLoader&);
+    CBRepFaceLoader& operator=(const CBRepFaceLoader&);
+
+    /** 加载共边或边，iEdge为边时iCoedge为PDV_TOPO_INVALID_INDEX */
+    DftBool LoadEdge(DftUInt iCoedge, DftUInt iEdge, BRepArchiveEdge& oEdge) const;
+
+    CTopoGraph m_Graph;                                     ///< 拓扑图
+    std::vector<kernel::pdv::IGeomPointData*> m_Points;     ///< 几何点
+    std::vector<kernel::pdv::IGeomCurveData*> m_Curves;     ///< 几何曲线
+    std::vector<kernel::pdv::IGeomSurfaceData*> m_Surfaces; ///< 几何曲面
+    CIdSlotMap m_PointIndexes;                              ///< 几何点ID到序号
+    CIdSlotMap m_CurveIndexes;                              ///< 几何曲线ID到序号
+    CIdSlotMap m_SurfaceIndexes;                            ///< 几何曲面ID到序号
+};
+
+#endif
@@ -33,6 +33,7 @@
 #include "PDVIRenderMesh.h"  
 #include "PDVIRenderVertex.h"  
 #include "PDVIReferenceGeometry.h"  
+#include "PDVITileSet.h"  
 
 // 属性相关头文件  
 #include "PDVIAttribute.h"  
@@ -55,54 +56,55 @@
 #include <map>  
 #include <set>  
 #include <functional>  
+#include <algorithm>  
+#include <chrono>  
+#include <cmath>  
+#include <cstring>  
+#include <cstdlib>  
 #include <Windows.h> // 用于创建目录  
 
+#include "pdvbatch.h"
+#include "pdvbench.h"
+#include "pdvbreparchive.h"
+#include "pdvgeometrycache.h"
+#include "pdvloader.h"
+#include "pdvlod.h"
+#include "pdvmemscene.h"
+#include "pdvnodetable.h"
+#include "pdvprofiler.h"
+#include "pdvsceneindex.h"
+#include "pdvsimplify.h"
+#include "pdvstlwriter.h"
+#include "pdvtessellate.h"
+#include "pdvtextformat.h"
+#include "pdvtilebuilder.h"
+#include "pdvtileswriter.h"
+#include "pdvtopograph.h"
+#include "pdvtransform.h"
+#include "pdvtreewalker.h"
+#include "pdvvertexstreams.h"
+
 using namespace std;
 using namespace kernel::pdv;
 
-// 数据结构定义  
-struct NodeInfo {
-    DftUInt64 nodeID;
-    string nodeName;
-    string modelName;
-    PDVMatrix4F worldTransform;
-    DftUInt64 parentID;
-    bool hasModel;
-    map<string, string> attributes;
-
-    // 新增PMI相关信息  
-    struct PMIData {
-        DftUInt64 annotationID;
-        string annotationType;
-        string annotationName;
-        string viewMode;
-        map<string, string> properties;
-    };
 string CurveTypeToString(DftUInt8 curveType);
 string SurfaceTypeToString(DftUInt8 surfaceType);
-    vector<PMIData> pmiData;  // 一个节点可能有多个PMI标注  
-};
-
-// 全局变量存储节点信息  
-vector<NodeInfo> g_nodeInfos;
 
 // 函数声明  
-void CollectNodeInfo(ISceneData* iSceneData, const string& outputDir);
-void CollectPMIData(IAnnotation* annotation, vector<NodeInfo::PMIData>& pmiData);
-void CollectAttributes(IAttribute* attr, map<string, string>& attributes);
 void MatrixToTransform(const PDVMatrix4F& matrix, float& x, float& y, float& z,
     float& qx, float& qy, float& qz, float& qw,
     float& sx, float& sy, float& sz);
-void GenerateCSVFiles(const string& outputDir);
-void TraverseModelTree(ISceneData* iSceneData, const string& outputDir);
-void ProcessTreeNode(IModelTreeNode* node, int depth, ISceneData* sceneData, const string& outputDir);
+DftBool GenerateCSVFiles(const CNodeTable& nodeTable, const string& outputDir);
 void PrintAttributeInfo(IAttribute* attr, int depth);
 void PrintPMIInfo(IAnnotation* annotation, int depth);
-void ExportBRepAsText(IBRep* bRep, const string& filename);
 string TopoTypeToString(DftUInt8 topoType);
 string OrientationToString(DftUInt8 orientation);
 string GeomTypeToString(DftUInt8 geomType);
-bool ExportNodeToStl(ISceneData* iSceneData, IModelTreeNode* node, const string& stlPath);
+bool ExportNodeToStl(const CSceneIndex& sceneIndex, IModelTreeNode* node, const string& stlPath, StlFormat format = STL_FORMAT_ASCII,
+    CGeometryCache* geometryCache = NULL, const SimplifyOptions* simplify = NULL, NodeSimplifyReport* report = NULL,
+    const LodSelectOptions* lod = NULL);
+DftBool ConvertToStl(ISceneData* iSceneData, const CUnicodeString& iStlPath, StlFormat iFormat, DftUInt iThreadCount,
+    CGeometryCache* ioCache, const SimplifyOptions* iSimplify, vector<NodeSimplifyReport>* oReports, const LodSelectOptions* iLod);
 
 // 矩阵转换为位置和旋转（PDV已经是全局坐标系）  
 void MatrixToTransform(const PDVMatrix4F& matrix, float& x, float& y, float& z,
@@ -130,401 +132,171 @@ void MatrixToTransform(const PDVMatrix4F& matrix, float& x, float& y, float& z,
     qw = 1.0f;
 }
 
-// 收集节点信息的遍历函数  
-void CollectNodeInfo(ISceneData* iSceneData, const string& outputDir)
+// 按键名排序的全部键（字符串编号），iUsed标记出现过的键  
+vector<DftUInt> SortKeys(const CNodeTable& nodeTable, const vector<char>& used)
 {
-    if (!iSceneData) return;
-
-    g_nodeInfos.clear();
-
-    std::vector<IModelTree*> modelTreeArray;
-    iSceneData->GetModelTreeArray(modelTreeArray);
-
-    for (DftUInt t = 0; t < modelTreeArray.size(); t++)
+    vector<DftUInt> keys;
+    for (DftUInt id = 0; id < used.size(); id++)
     {
-        IModelTree* tree = modelTreeArray[t];
-        if (!tree) continue;
-
-        IModelTreeNode* rootNode = nullptr;
-        if (tree->GetRootNode(rootNode) == PDV_RESULT_NO_ERROR && rootNode)
-        {
-            stack<pair<pair<IModelTreeNode*, int>, DftUInt64>> nodeStack;
-            nodeStack.push(make_pair(make_pair(rootNode, 0), 0));
-
-            while (!nodeStack.empty())
-            {
-                IModelTreeNode* currentNode = nodeStack.top().first.first;
-                int depth = nodeStack.top().first.second;
-                DftUInt64 parentID = nodeStack.top().second;
-                nodeStack.pop();
-
-                NodeInfo nodeInfo;
-                nodeInfo.nodeID = currentNode->GetID();
-                nodeInfo.parentID = parentID;
-
-                CUnicodeString nodeName;
-                currentNode->GetName(nodeName);
-                nodeInfo.nodeName = nodeName.ToMultiByte();
-
-                // 修正：检查变换标志位并正确获取变换矩阵  
-                if (currentNode->GetWorldTransformFlag())
-                {
-                    PDV_RESULT result = currentNode->GetWorldTransform(nodeInfo.worldTransform);
-                    if (result != PDV_RESULT_NO_ERROR)
-                    {
-                        if (currentNode->GetLocalTransformFlag())
-                        {
-                            currentNode->GetLocalTransform(nodeInfo.worldTransform);
-                        }
-                        else
-                        {
-                            nodeInfo.worldTransform.SetIdentity();
-                        }
-                    }
-                }
-                else if (currentNode->GetLocalTransformFlag())
-                {
-                    currentNode->GetLocalTransform(nodeInfo.worldTransform);
-                }
-                else
-                {
-                    nodeInfo.worldTransform.SetIdentity();
-                }
-
-                nodeInfo.hasModel = currentNode->GetModelFlag();
-                if (nodeInfo.hasModel)
-                {
-                    IModel* model = currentNode->GetModel();
-                    if (model)
-                    {
-                        CUnicodeString modelName;
-                        model->GetName(modelName);
-                        nodeInfo.modelName = modelName.ToMultiByte();
-
-                        IAttribute* attr = model->GetAttribute();
-                        if (attr)
-                        {
-                            CollectAttributes(attr, nodeInfo.attributes);
-                        }
-
-                        IAnnotation* annotation = model->GetAnnotation();
-                        if (annotation)
-                        {
-                            CollectPMIData(annotation, nodeInfo.pmiData);
-                        }
-                    }
-                }
-
-                g_nodeInfos.push_back(nodeInfo);
-
-                std::vector<IModelTreeNode*> children;
-                if (currentNode->GetChildren(children) == PDV_RESULT_NO_ERROR)
-                {
-                    for (int i = static_cast<int>(children.size()) - 1; i >= 0; i--)
-                    {
-                        if (children[i])
-                        {
-                            nodeStack.push(make_pair(make_pair(children[i], depth + 1), nodeInfo.nodeID));
-                        }
-                    }
-                }
-            }
-        }
+        if (used[id])
+            keys.push_back(id);
     }
+    sort(keys.begin(), keys.end(), [&nodeTable](DftUInt a, DftUInt b) {
+        return strcmp(nodeTable.GetString(a), nodeTable.GetString(b)) < 0;
+    });
+    return keys;
 }
 
-// 新增PMI数据收集函数  
-void CollectPMIData(IAnnotation* annotation, vector<NodeInfo::PMIData>& pmiData)
+// 按表头顺序写出一组键值对，缺少的键写空值  
+void WritePairColumns(CTextWriter& file, const CNodeTable& nodeTable, const vector<DftUInt>& keys, DftUInt begin, DftUInt end)
 {
-    if (!annotation) return;
-
-    DftUInt itemCount = annotation->GetAnnotationItemCount();
-
-    for (DftUInt i = 0; i < itemCount; i++)
+    // 表头和键值对都按键名排序，顺序合并即可  
+    DftUInt pair = begin;
+    for (DftUInt k = 0; k < keys.size(); k++)
     {
-        IAnnotationItem* item = annotation->GetAnnotationItemByIndex(i);
-        if (!item) continue;
-
-        NodeInfo::PMIData pmi;
-        pmi.annotationID = item->GetID();
-
-        // 获取标注项类型  
-        CUnicodeString itemType = item->GetType();
-        pmi.annotationType = itemType.ToMultiByte();
-
-        // 获取标注项名称  
-        CUnicodeString itemName;
-        if (item->GetName(itemName) == PDV_RESULT_NO_ERROR)
+        const char* key = nodeTable.GetString(keys[k]);
+        while (pair < end && strcmp(nodeTable.GetString(nodeTable.GetPairKey(pair)), key) < 0)
+            pair++;
+        if (pair < end && nodeTable.GetPairKey(pair) == keys[k])
         {
-            pmi.annotationName = itemName.ToMultiByte();
+            file.Append(',').AppendQuoted(nodeTable.GetString(nodeTable.GetPairValue(pair)));
+            pair++;
         }
-
-        // 获取显示模式  
-        DftUInt8 viewMode = item->GetFaceViewMode();
-        switch (viewMode)
-        {
-        case ANNOTATIONVIEWMODE_DEFAULTVIEW:
-            pmi.viewMode = "Default View";
-            break;
-        case ANNOTATIONVIEWMODE_PARALLELSCREEN:
-            pmi.viewMode = "Parallel Screen";
-            break;
-        case ANNOTATIONVIEWMODE_FIXEDSCREEN:
-            pmi.viewMode = "Fixed Screen";
-            break;
-        default:
-            pmi.viewMode = "Unknown";
-            break;
-        }
-
-        // 收集其他PMI属性  
-        DftUInt64 renderBodyID = item->GetRenderBodyID();
-        if (renderBodyID != 0)
+        else
         {
-            pmi.properties["RenderBodyID"] = to_string(renderBodyID);
+            file.Append(",\"\"");
         }
-
-        RGBColor triangleColor = item->GetTriangleColor();
-        stringstream colorStr;
-        colorStr << "RGB(" << static_cast<int>(triangleColor._red) << ","
-            << static_cast<int>(triangleColor._green) << ","
-            << static_cast<int>(triangleColor._blue) << ")";
-        pmi.properties["TriangleColor"] = colorStr.str();
-
-        pmiData.push_back(pmi);
     }
 }
 
-// 收集属性信息  
-void CollectAttributes(IAttribute* attr, map<string, string>& attributes)
+// 创建文件并写出内容，创建失败时不写入，返回是否创建并写入成功  
+bool WriteCsvFile(const string& path, const function<void(CTextWriter&)>& write)
 {
-    if (!attr) return;
+    CTextWriter file;
+    if (!file.Open(path))
+        return false;
+    write(file);
+    return file.Close() ? true : false;
+}
 
-    std::vector<IAttributeGroup*> attributeGroups;
-    if (attr->GetAttributeGroupArray(attributeGroups) == PDV_RESULT_NO_ERROR)
-    {
-        for (DftUInt i = 0; i < attributeGroups.size(); i++)
-        {
-            IAttributeGroup* group = attributeGroups[i];
-            if (!group) continue;
+// 生成CSV文件，返回是否全部创建并写入成功  
+DftBool GenerateCSVFiles(const CNodeTable& nodeTable, const string& outputDir)
+{
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_SERIALIZE);
+    DftUInt nodeCount = nodeTable.GetCount();
+    bool succeeded = true;
 
-            std::vector<IAttributeItem*> attributeItems;
-            if (group->GetAttributeItemArray(attributeItems) == PDV_RESULT_NO_ERROR)
-            {
-                for (DftUInt j = 0; j < attributeItems.size(); j++)
-                {
-                    IAttributeItem* item = attributeItems[j];
-                    if (!item) continue;
+    // 1. 生成 produce_models.csv  
+    succeeded = WriteCsvFile(outputDir + "\\produce_models.csv", [&](CTextWriter& modelsFile) {
+        modelsFile.Append("UUID,实例名称,引用模型名称,X,Y,Z,QX,QY,QZ,QW,SX,SY,SZ\n");
 
-                    CUnicodeString key;
-                    if (item->GetKey(key) == PDV_RESULT_NO_ERROR)
-                    {
-                        string keyStr = key.ToMultiByte();
-                        string valueStr = "";
+        for (DftUInt n = 0; n < nodeCount; n++)
+        {
+            if (nodeTable.HasModel(n))
+            {
+                float x, y, z, qx, qy, qz, qw, sx, sy, sz;
+                MatrixToTransform(nodeTable.GetWorldTransform(n), x, y, z, qx, qy, qz, qw, sx, sy, sz);
 
-                        DftUInt valueType = item->GetValueType();
-                        switch (valueType)
-                        {
-                        case DATATYPE_BOOL:
-                        {
-                            DftBool boolValue;
-                            if (item->GetBoolean(boolValue) == PDV_RESULT_NO_ERROR)
-                                valueStr = boolValue ? "true" : "false";
-                        }
-                        break;
-                        case DATATYPE_INT32:
-                        {
-                            DftInt intValue;
-                            if (item->GetInteger(intValue) == PDV_RESULT_NO_ERROR)
-                                valueStr = to_string(intValue);
-                        }
-                        break;
-                        case DATATYPE_FLOAT:
-                        {
-                            DftFloat floatValue;
-                            if (item->GetFloat(floatValue) == PDV_RESULT_NO_ERROR)
-                                valueStr = to_string(floatValue);
-                        }
-                        break;
-                        case DATATYPE_DOUBLE:
-                        {
-                            DftDouble doubleValue;
-                            if (item->GetDouble(doubleValue) == PDV_RESULT_NO_ERROR)
-                                valueStr = to_string(doubleValue);
-                        }
-                        break;
-                        case DATATYPE_STRING:
-                        {
-                            CUnicodeString stringValue;
-                            if (item->GetString(stringValue) == PDV_RESULT_NO_ERROR)
-                                valueStr = stringValue.ToMultiByte();
-                        }
-                        break;
-                        case DATATYPE_VECTOR3F:
-                        {
-                            PDVVector3F vectorValue;
-                            if (item->GetVectorFloat3(vectorValue) == PDV_RESULT_NO_ERROR)
-                            {
-                                stringstream ss;
-                                ss << "(" << vectorValue.x() << "," << vectorValue.y() << "," << vectorValue.z() << ")";
-                                valueStr = ss.str();
-                            }
-                        }
-                        break;
-                        case DATATYPE_VECTOR3D:
-                        {
-                            PDVVector3D vectorValue;
-                            if (item->GetVectorDouble3(vectorValue) == PDV_RESULT_NO_ERROR)
-                            {
-                                stringstream ss;
-                                ss << "(" << vectorValue.x() << "," << vectorValue.y() << "," << vectorValue.z() << ")";
-                                valueStr = ss.str();
-                            }
-                        }
-                        break;
-                        }
+                modelsFile.AppendUInt(nodeTable.GetNodeID(n)).Append(',')
+                    .AppendQuoted(nodeTable.GetName(n)).Append(',')
+                    .AppendQuoted(nodeTable.GetModelName(n)).Append(',');
 
-                        attributes[keyStr] = valueStr;
-                    }
+                // 定点格式，保留6位小数  
+                const float values[] = { x, y, z, qx, qy, qz, qw, sx, sy, sz };
+                for (int v = 0; v < 10; v++)
+                {
+                    if (v)
+                        modelsFile.Append(',');
+                    modelsFile.AppendFixed(values[v]);
                 }
+                modelsFile.Append('\n');
             }
         }
-    }
-}
+    }) && succeeded;
 
-// 生成三个CSV文件  
-void GenerateCSVFiles(const string& outputDir)
-{
-    // 1. 生成 produce_models.csv  
-    ofstream modelsFile(outputDir + "\\produce_models.csv");
-    modelsFile << "UUID,实例名称,引用模型名称,X,Y,Z,QX,QY,QZ,QW,SX,SY,SZ\n";
+    // 2. 生成 product_tree.csv  
+    succeeded = WriteCsvFile(outputDir + "\\product_tree.csv", [&](CTextWriter& treeFile) {
+        treeFile.Append("父UUID,显示名称,产品UUID,实例名称\n");
 
-    for (const auto& nodeInfo : g_nodeInfos)
-    {
-        if (nodeInfo.hasModel)
+        for (DftUInt n = 0; n < nodeCount; n++)
         {
-            float x, y, z, qx, qy, qz, qw, sx, sy, sz;
-            MatrixToTransform(nodeInfo.worldTransform, x, y, z, qx, qy, qz, qw, sx, sy, sz);
-
-            modelsFile << nodeInfo.nodeID << ","
-                << "\"" << nodeInfo.nodeName << "\","
-                << "\"" << nodeInfo.modelName << "\","
-                << fixed << setprecision(6) << x << ","
-                << y << "," << z << ","
-                << qx << "," << qy << "," << qz << "," << qw << ","
-                << sx << "," << sy << "," << sz << "\n";
+            treeFile.AppendUInt(nodeTable.GetParentID(n)).Append(',')
+                .AppendQuoted(nodeTable.GetName(n)).Append(',')
+                .AppendUInt(nodeTable.GetNodeID(n)).Append(',')
+                .AppendQuoted(nodeTable.GetName(n)).Append('\n');
         }
-    }
-    modelsFile.close();
-
-    // 2. 生成 product_tree.csv  
-    ofstream treeFile(outputDir + "\\product_tree.csv");
-    treeFile << "父UUID,显示名称,产品UUID,实例名称\n";
-
-    for (const auto& nodeInfo : g_nodeInfos)
-    {
-        treeFile << nodeInfo.parentID << ","
-            << "\"" << nodeInfo.nodeName << "\","
-            << nodeInfo.nodeID << ","
-            << "\"" << nodeInfo.nodeName << "\"\n";
-    }
-    treeFile.close();
+    }) && succeeded;
 
     // 3. 生成 product_properties.csv  
-    ofstream propsFile(outputDir + "\\product_properties.csv");
-
-    set<string> allAttributeKeys;
-    for (const auto& nodeInfo : g_nodeInfos)
-    {
-        for (const auto& attr : nodeInfo.attributes)
+    succeeded = WriteCsvFile(outputDir + "\\product_properties.csv", [&](CTextWriter& propsFile) {
+        vector<char> usedKeys(nodeTable.GetStringCount(), 0);
+        for (DftUInt n = 0; n < nodeCount; n++)
         {
-            allAttributeKeys.insert(attr.first);
+            for (DftUInt a = nodeTable.GetAttributeBegin(n); a < nodeTable.GetAttributeEnd(n); a++)
+                usedKeys[nodeTable.GetPairKey(a)] = 1;
         }
-    }
-
-    propsFile << "UUID,实例名称,零件号,定义,版本";
-    for (const auto& key : allAttributeKeys)
-    {
-        propsFile << ",\"" << key << "\"";
-    }
-    propsFile << "\n";
+        vector<DftUInt> allAttributeKeys = SortKeys(nodeTable, usedKeys);
 
-    for (const auto& nodeInfo : g_nodeInfos)
-    {
-        propsFile << nodeInfo.nodeID << ","
-            << "\"" << nodeInfo.nodeName << "\","
-            << "\"" << nodeInfo.modelName << "\","
-            << "\"\","
-            << "\"\"";
+        propsFile.Append("UUID,实例名称,零件号,定义,版本");
+        for (DftUInt k = 0; k < allAttributeKeys.size(); k++)
+        {
+            propsFile.Append(',').AppendQuoted(nodeTable.GetString(allAttributeKeys[k]));
+        }
+        propsFile.Append('\n');
 
-        for (const auto& key : allAttributeKeys)
+        for (DftUInt n = 0; n < nodeCount; n++)
         {
-            auto it = nodeInfo.attributes.find(key);
-            if (it != nodeInfo.attributes.end())
-            {
-                propsFile << ",\"" << it->second << "\"";
-            }
-            else
-            {
-                propsFile << ",\"\"";
-            }
+            propsFile.AppendUInt(nodeTable.GetNodeID(n)).Append(',')
+                .AppendQuoted(nodeTable.GetName(n)).Append(',')
+                .AppendQuoted(nodeTable.GetModelName(n)).Append(',')
+                .Append("\"\",")
+                .Append("\"\"");
+
+            WritePairColumns(propsFile, nodeTable, allAttributeKeys, nodeTable.GetAttributeBegin(n), nodeTable.GetAttributeEnd(n));
+            propsFile.Append('\n');
         }
-        propsFile << "\n";
-    }
-    propsFile.close();
+    }) && succeeded;
 
     // 4. 生成 product_pmi.csv - 统一处理PMI数据  
-    ofstream pmiFile(outputDir + "\\product_pmi.csv");
-
-    // 收集所有PMI属性键  
-    set<string> allPMIKeys;
-    for (const auto& nodeInfo : g_nodeInfos)
-    {
-        for (const auto& pmi : nodeInfo.pmiData)
+    succeeded = WriteCsvFile(outputDir + "\\product_pmi.csv", [&](CTextWriter& pmiFile) {
+        // 收集所有PMI属性键  
+        vector<char> usedKeys(nodeTable.GetStringCount(), 0);
+        for (DftUInt n = 0; n < nodeCount; n++)
         {
-            for (const auto& prop : pmi.properties)
+            for (DftUInt p = nodeTable.GetPMIBegin(n); p < nodeTable.GetPMIEnd(n); p++)
             {
-                allPMIKeys.insert(prop.first);
+                for (DftUInt a = nodeTable.GetPMIPropertyBegin(p); a < nodeTable.GetPMIPropertyEnd(p); a++)
+                    usedKeys[nodeTable.GetPairKey(a)] = 1;
             }
         }
-    }
+        vector<DftUInt> allPMIKeys = SortKeys(nodeTable, usedKeys);
 
-    // 写入PMI表头  
-    pmiFile << "节点UUID,节点名称,标注ID,标注类型,标注名称,显示模式";
-    for (const auto& key : allPMIKeys)
-    {
-        pmiFile << ",\"" << key << "\"";
-    }
-    pmiFile << "\n";
+        // 写入PMI表头  
+        pmiFile.Append("节点UUID,节点名称,标注ID,标注类型,标注名称,显示模式");
+        for (DftUInt k = 0; k < allPMIKeys.size(); k++)
+        {
+            pmiFile.Append(',').AppendQuoted(nodeTable.GetString(allPMIKeys[k]));
+        }
+        pmiFile.Append('\n');
 
-    // 写入PMI数据行  
-    for (const auto& nodeInfo : g_nodeInfos)
-    {
-        for (const auto& pmi : nodeInfo.pmiData)
+        // 写入PMI数据行  
+        for (DftUInt n = 0; n < nodeCount; n++)
         {
-            pmiFile << nodeInfo.nodeID << ","
-                << "\"" << nodeInfo.nodeName << "\","
-                << pmi.annotationID << ","
-                << "\"" << pmi.annotationType << "\","
-                << "\"" << pmi.annotationName << "\","
-                << "\"" << pmi.viewMode << "\"";
-
-            for (const auto& key : allPMIKeys)
+            for (DftUInt p = nodeTable.GetPMIBegin(n); p < nodeTable.GetPMIEnd(n); p++)
             {
-                auto it = pmi.properties.find(key);
-                if (it != pmi.properties.end())
-                {
-                    pmiFile << ",\"" << it->second << "\"";
-                }
-                else
-                {
-                    pmiFile << ",\"\"";
-                }
+                pmiFile.AppendUInt(nodeTable.GetNodeID(n)).Append(',')
+                    .AppendQuoted(nodeTable.GetName(n)).Append(',')
+                    .AppendUInt(nodeTable.GetPMIAnnotationID(p)).Append(',')
+                    .AppendQuoted(nodeTable.GetPMIType(p)).Append(',')
+                    .AppendQuoted(nodeTable.GetPMIName(p)).Append(',')
+                    .AppendQuoted(nodeTable.GetPMIViewMode(p));
+
+                WritePairColumns(pmiFile, nodeTable, allPMIKeys, nodeTable.GetPMIPropertyBegin(p), nodeTable.GetPMIPropertyEnd(p));
+                pmiFile.Append('\n');
             }
-            pmiFile << "\n";
         }
-    }
-    pmiFile.close();
+    }) && succeeded;
+    return succeeded ? TRUE : FALSE;
 }
 
 // 拓扑类型转换为字符串  
@@ -589,218 +361,801 @@ string GeomTypeToString(DftUInt8 geomType)
 {
     switch (geomType)
     {
-    case GEOMTYPE_POINT:   return "POINT";
-    case GEOMTYPE_CURVE:   return "CURVE";
-    case GEOMTYPE_SURFACE: return "SURFACE";
-    default:               return "UNKNOWN";
+    case GEOMTYPE_POINT:   return "POINT";
+    case GEOMTYPE_CURVE:   return "CURVE";
+    case GEOMTYPE_SURFACE: return "SURFACE";
+    default:               return "UNKNOWN";
+    }
+}
+
+// 节点输出目录，不存在时创建  
+string PrepareNodeDir(const string& outputDir, DftUInt64 nodeID)
+{
+    string nodeDir = outputDir + "\\Node_" + to_string(nodeID);
+    CreateDirectoryA(nodeDir.c_str(), NULL);
+    return nodeDir;
+}
+
+// 控制台输出节点信息  
+class CConsoleReportSink : public INodeSink
+{
+public:
+    DftUInt GetRequiredFields() const
+    {
+        return NODE_FIELD_NAME | NODE_FIELD_TRANSFORM | NODE_FIELD_VISIBLE | NODE_FIELD_MODEL_NAME;
+    }
+
+    void OnBegin(ISceneData* /*sceneData*/, const vector<IModelTree*>& trees)
+    {
+        cout << "Found " << trees.size() << " model trees" << endl;
+    }
+
+    void OnTree(IModelTree* tree)
+    {
+        // 获取模型树名称  
+        CUnicodeString treeName;
+        tree->GetName(treeName);
+        cout << "\nModel Tree: " << treeName.ToMultiByte() << endl;
+    }
+
+    void OnNode(CNodeContext& node)
+    {
+        int depth = node.GetDepth();
+
+        // 打印节点信息  
+        string indent(depth * 2, ' ');
+        cout << "\n" << indent << "Node: " << node.GetName()
+            << " (ID: " << node.GetID() << ")" << endl;
+
+        // 打印可见性  
+        cout << indent << "  Visible: " << (node.GetVisible() ? "Yes" : "No") << endl;
+
+        // 打印变换信息  
+        if (node.HasWorldTransform())
+        {
+            const PDVMatrix4F& worldTransform = node.GetWorldTransform();
+            cout << indent << "  World Transform:" << endl;
+            for (int i = 0; i < 4; i++) {
+                m_Line.Clear();
+                m_Line.Append(indent).Append("    ");
+                for (int j = 0; j < 4; j++) {
+                    // 使用固定浮点数格式，精度为6位，右对齐到12个字符  
+                    size_t start = m_Line.GetSize();
+                    m_Line.AppendFixed(worldTransform._data[i][j]).PadLeft(start, 12).Append(' ');
+                }
+                cout << m_Line.GetText() << endl;
+            }
+        }
+
+        // 检查是否关联模型  
+        IModel* model = node.GetModel();
+        if (!model)
+            return;
+
+        cout << indent << "  Model: " << node.GetModelName() << endl;
+
+        // 打印属性表  
+        IAttribute* attr = model->GetAttribute();
+        if (attr)
+        {
+            PrintAttributeInfo(attr, depth);
+        }
+        else
+        {
+            cout << indent << "  No Attributes" << endl;
+        }
+
+        // 打印PMI信息  
+        IAnnotation* annotation = model->GetAnnotation();
+        if (annotation)
+        {
+            PrintPMIInfo(annotation, depth);
+        }
+        else
+        {
+            cout << indent << "  No PMI Information" << endl;
+        }
+
+        cout << indent << "  BRep Count: " << model->GetBRepCount() << endl;
+    }
+
+private:
+    CTextBuilder m_Line; ///< 变换矩阵的一行
+};
+
+// 导出节点整体STL，重复引用的渲染几何只读取一次；指定LOD选择参数时输出选中的层级，
+// 指定简化参数时输出简化后的网格并生成simplify_report.csv  
+class CNodeStlSink : public INodeSink
+{
+public:
+    explicit CNodeStlSink(const string& outputDir, StlFormat format = STL_FORMAT_ASCII, bool verbose = true,
+        const SimplifyOptions* simplify = NULL, const LodSelectOptions* lod = NULL)
+        : m_OutputDir(outputDir), m_Format(format), m_Verbose(verbose), m_Simplify(simplify && simplify->IsEnabled() ? simplify : NULL),
+          m_Lod(lod), m_Failed(false) {}
+
+    DftUInt GetRequiredFields() const { return NODE_FIELD_NAME; }
+
+    void OnBegin(ISceneData* sceneData, const vector<IModelTree*>& /*trees*/)
+    {
+        m_SceneIndex.Build(sceneData);
+        m_GeometryCache.Clear();
+        m_Reports.clear();
+        m_Failed = false;
+    }
+
+    void OnNode(CNodeContext& node)
+    {
+        if (!node.GetModel())
+            return;
+
+        string indent(node.GetDepth() * 2, ' ');
+        string nodeStlPath = PrepareNodeDir(m_OutputDir, node.GetID()) + "\\" + node.GetName() + ".stl";
+        NodeSimplifyReport report;
+        report._nodeID = node.GetID();
+        report._name = node.GetName();
+        if (ExportNodeToStl(m_SceneIndex, node.GetNode(), nodeStlPath, m_Format, &m_GeometryCache, m_Simplify, &report, m_Lod))
+        {
+            if (m_Verbose)
+            {
+                cout << indent << "    Exported Node STL to: " << nodeStlPath << endl;
+                if (m_Simplify)
+                    cout << indent << "    Simplified " << report._sourceTriangles << " -> " << report._resultTriangles
+                         << " triangles, error " << report._error << endl;
+            }
+        }
+        else if (node.GetModel()->GetRenderBodyCount() > 0)
+        {
+            // 没有渲染主体的模型本来就不输出网格，其余情况是文件创建或写入失败  
+            cerr << "Failed to write node STL: " << nodeStlPath << endl;
+            m_Failed = true;
+        }
+        if (m_Simplify)
+            m_Reports.push_back(report);
+    }
+
+    void OnEnd()
+    {
+        if (m_Simplify && !WriteSimplifyReport(m_Reports, m_OutputDir + "\\simplify_report.csv"))
+            m_Failed = true;
+        if (!m_Verbose)
+            return;
+        cout << "\nGeometry cache: " << m_GeometryCache.GetHitCount() << " hits, "
+            << m_GeometryCache.GetMissCount() << " misses, "
+            << m_GeometryCache.GetEvictionCount() << " evictions" << endl;
+    }
+
+    // 是否有文件创建或写入失败  
+    bool HasFailed() const { return m_Failed; }
+
+private:
+    string m_OutputDir;
+    StlFormat m_Format;
+    bool m_Verbose;
+    const SimplifyOptions* m_Simplify;
+    const LodSelectOptions* m_Lod;
+    CSceneIndex m_SceneIndex;
+    CGeometryCache m_GeometryCache;
+    vector<NodeSimplifyReport> m_Reports;
+    bool m_Failed;
+};
+
+// 导出节点模型的BRep二进制存档  
+class CBRepArchiveSink : public INodeSink
+{
+public:
+    explicit CBRepArchiveSink(const string& outputDir, bool verbose = true) : m_OutputDir(outputDir), m_Verbose(verbose), m_Failed(false) {}
+
+    DftUInt GetRequiredFields() const { return NODE_FIELD_NONE; }
+
+    void OnNode(CNodeContext& node)
+    {
+        IModel* model = node.GetModel();
+        if (!model)
+            return;
+
+        string indent(node.GetDepth() * 2, ' ');
+        DftUInt brepCount = model->GetBRepCount();
+        for (DftUInt i = 0; i < brepCount; i++)
+        {
+            IBRep* brep = model->GetBRep(i);
+            if (brep)
+            {
+                stringstream filename;
+                filename << PrepareNodeDir(m_OutputDir, node.GetID()) << "\\BRep_" << i << ".pbrep";
+
+                BRepArchiveStatistics stats;
+                if (!WriteBRepArchive(brep, filename.str(), &stats))
+                {
+                    cerr << "Failed to create BRep archive: " << filename.str() << endl;
+                    m_Failed = true;
+                }
+                else if (m_Verbose)
+                    cout << indent << "    Exported BRep archive to: " << filename.str() << " (" << stats._topoCount << " topos, "
+                         << stats._bytes << " bytes)" << endl;
+            }
+        }
+    }
+
+    // 是否有存档写入失败  
+    bool HasFailed() const { return m_Failed; }
+
+private:
+    string m_OutputDir;
+    bool m_Verbose;
+    bool m_Failed;
+};
+
+// 遍历时建立节点表，遍历结束后生成CSV文件  
+class CCsvSink : public INodeSink
+{
+public:
+    explicit CCsvSink(const string& outputDir, bool verbose = true) : m_OutputDir(outputDir), m_Verbose(verbose), m_Failed(false) {}
+
+    DftUInt GetRequiredFields() const
+    {
+        return NODE_FIELD_NAME | NODE_FIELD_TRANSFORM | NODE_FIELD_MODEL_NAME | NODE_FIELD_ATTRIBUTES | NODE_FIELD_PMI;
+    }
+
+    void OnBegin(ISceneData* /*sceneData*/, const vector<IModelTree*>& /*trees*/)
+    {
+        m_NodeTable.Clear();
+    }
+
+    void OnNode(CNodeContext& node)
+    {
+        m_NodeTable.AddNode(node);
+    }
+
+    void OnEnd()
+    {
+        m_NodeTable.Finalize();
+
+        // 生成CSV文件  
+        m_Failed = !GenerateCSVFiles(m_NodeTable, m_OutputDir);
+        if (m_Failed)
+            cerr << "Failed to write CSV files to: " << m_OutputDir << endl;
+        if (!m_Verbose || m_Failed)
+            return;
+
+        cout << "Generated CSV files:" << endl;
+        cout << "  - produce_models.csv" << endl;
+        cout << "  - product_tree.csv" << endl;
+        cout << "  - product_properties.csv" << endl;
+        cout << "  - product_pmi.csv" << endl;
+    }
+
+    // CSV文件是否写入失败  
+    bool HasFailed() const { return m_Failed; }
+
+private:
+    string m_OutputDir;
+    bool m_Verbose;
+    CNodeTable m_NodeTable;
+    bool m_Failed;
+};
+
+// 只建立节点表，不输出文件  
+class CNodeTableSink : public INodeSink
+{
+public:
+    explicit CNodeTableSink(CNodeTable& nodeTable) : m_NodeTable(nodeTable) {}
+
+    DftUInt GetRequiredFields() const
+    {
+        return NODE_FIELD_NAME | NODE_FIELD_TRANSFORM | NODE_FIELD_MODEL_NAME | NODE_FIELD_ATTRIBUTES | NODE_FIELD_PMI;
+    }
+
+    void OnBegin(ISceneData* /*sceneData*/, const vector<IModelTree*>& /*trees*/)
+    {
+        m_NodeTable.Clear();
+    }
+
+    void OnNode(CNodeContext& node)
+    {
+        m_NodeTable.AddNode(node);
+    }
+
+    void OnEnd()
+    {
+        m_NodeTable.Finalize();
+    }
+
+private:
+    CNodeTable& m_NodeTable;
+};
+
+// 导出已加载的场景：控制台信息、节点STL、BRep存档和CSV文件，任一文件创建或写入失败时返回FALSE  
+DftBool ExportScene(ISceneData* sceneData, const string& outputDir, bool verbose, const SimplifyOptions* simplify = NULL,
+    const LodSelectOptions* lod = NULL)
+{
+    // 确保输出目录存在  
+    if (!CreateDirectoryA(outputDir.c_str(), NULL)) {
+        if (GetLastError() != ERROR_ALREADY_EXISTS) {
+            cerr << "Failed to create output directory: " << outputDir << endl;
+            return FALSE;
+        }
+    }
+
+    // 单次遍历模型树，每个节点依次交给各输出对象  
+    CConsoleReportSink reportSink;
+    CNodeStlSink stlSink(outputDir, STL_FORMAT_ASCII, verbose, simplify, lod);
+    CBRepArchiveSink brepSink(outputDir, verbose);
+    CCsvSink csvSink(outputDir, verbose);
+
+    CModelTreeWalker walker;
+    if (verbose)
+        walker.AddSink(&reportSink);
+    walker.AddSink(&stlSink);
+    walker.AddSink(&brepSink);
+    walker.AddSink(&csvSink);
+    walker.Walk(sceneData);
+    return stlSink.HasFailed() || brepSink.HasFailed() || csvSink.HasFailed() ? FALSE : TRUE;
+}
+
+// 修改后的主转换函数  
+DftBool Convert(const CUnicodeString& iPdvPath, const string& outputDir, const SimplifyOptions* simplify = NULL,
+    const LodSelectOptions* lod = NULL)
+{
+    IObjectFactory* piObjectFactory = IObjectFactory::GetObjectFactory();
+    if (!piObjectFactory)
+        return FALSE;
+
+    CMappedFile mapping;
+    ISceneData* sceneData = nullptr;
+    PDV_RESULT res = piObjectFactory->CreateSceneData(sceneData);
+    if (!sceneData)
+        return FALSE;
+
+    LoadStatistics loadStats;
+    res = LoadSceneDataMapped(sceneData, iPdvPath, mapping, &loadStats);
+    if (res != PDV_RESULT_NO_ERROR)
+    {
+        cout << "Error loading PDV file: " << res << endl;
+        sceneData->Release();
+        return FALSE;
+    }
+    if (loadStats._mapped)
+        cout << "Loaded " << loadStats._bytes << " bytes in " << fixed << setprecision(3) << loadStats._seconds
+             << " s (" << setprecision(1) << loadStats.GetThroughput() << " MB/s)" << defaultfloat << endl;
+    else
+        cout << "Loaded PDV file by path in " << fixed << setprecision(3) << loadStats._seconds << " s" << defaultfloat << endl;
+
+    DftBool result = ExportScene(sceneData, outputDir, true, simplify, lod);
+
+    // 释放资源  
+    sceneData->Release();
+    return result;
+}
+
+// 批量转换目录下或清单中的pdv文件，每个文件输出到outputRoot下与文件同名的子目录  
+int ConvertBatch(const string& input, const string& outputRoot, DftUInt workerCount, DftUInt prefetchDepth)
+{
+    // 输入是目录时列出其中的pdv文件，否则视为清单文件  
+    vector<string> files;
+    DWORD attributes = GetFileAttributesA(input.c_str());
+    bool listed = attributes != INVALID_FILE_ATTRIBUTES && (attributes & FILE_ATTRIBUTE_DIRECTORY)
+        ? ListPdvFiles(input, files) == TRUE
+        : ReadBatchManifest(input, files) == TRUE;
+    if (!listed)
+    {
+        cerr << "Failed to read batch input: " << input << endl;
+        return 1;
+    }
+    if (!CreateDirectoryA(outputRoot.c_str(), NULL) && GetLastError() != ERROR_ALREADY_EXISTS)
+    {
+        cerr << "Failed to create output directory: " << outputRoot << endl;
+        return 1;
+    }
+
+    // 同名文件依次加序号，直到得到未用过的目录名（不区分大小写），避免与x_1.pdv这类文件名冲突  
+    vector<BatchJob> jobs(files.size());
+    set<string> usedStems;
+    auto toLower = [](string text) {
+        transform(text.begin(), text.end(), text.begin(), [](char c) { return static_cast<char>(tolower(static_cast<unsigned char>(c))); });
+        return text;
+    };
+    for (size_t i = 0; i < files.size(); i++)
+    {
+        string stem = GetFileStem(files[i]);
+        string name = stem;
+        for (int count = 1; !usedStems.insert(toLower(name)).second; count++)
+            name = stem + "_" + to_string(count);
+        jobs[i]._inputPath = files[i];
+        jobs[i]._outputDir = outputRoot + "\\" + name;
+    }
+
+    CBatchConverter converter(workerCount, prefetchDepth);
+    cout << "Converting " << jobs.size() << " files with " << converter.GetWorkerCount() << " workers" << endl;
+
+    auto start = chrono::steady_clock::now();
+    vector<BatchFileResult> results;
+    if (!converter.Run(jobs, [](ISceneData* sceneData, const BatchJob& job) {
+            return ExportScene(sceneData, job._outputDir, false);
+        }, results))
+    {
+        cerr << "Failed to create scene data" << endl;
+        return 1;
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    // 汇总  
+    size_t failed = 0;
+    DftUInt64 bytes = 0;
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        bytes += results[i]._bytes;
+        if (!results[i]._success)
+        {
+            failed++;
+            cerr << "FAILED " << results[i]._inputPath << ": " << results[i]._error << endl;
+        }
+    }
+    string reportPath = outputRoot + "\\batch_summary.csv";
+    WriteBatchSummary(results, reportPath);
+
+    cout << "Converted " << results.size() - failed << "/" << results.size() << " files in "
+        << fixed << setprecision(2) << seconds << " s";
+    if (seconds > 0.0)
+        cout << " (" << setprecision(1) << bytes / seconds / (1024.0 * 1024.0) << " MB/s)";
+    cout << defaultfloat << endl;
+    cout << "Summary: " << reportPath << endl;
+    return failed ? 2 : 0;
+}
+
+// 为pdv文件中的主体网格生成LOD层级，另存为outputPath  
+int BuildLodFile(const CUnicodeString& inputPath, const CUnicodeString& outputPath, const LodOptions& options)
+{
+    IObjectFactory* piObjectFactory = IObjectFactory::GetObjectFactory();
+    if (!piObjectFactory)
+        return 1;
+    CMappedFile mapping;
+    ISceneData* sceneData = nullptr;
+    piObjectFactory->CreateSceneData(sceneData);
+    if (!sceneData)
+        return 1;
+
+    PDV_RESULT res = LoadSceneDataMapped(sceneData, inputPath, mapping);
+    if (res != PDV_RESULT_NO_ERROR)
+    {
+        cerr << "Error loading PDV file: " << res << endl;
+        sceneData->Release();
+        return 1;
+    }
+
+    LodStatistics stats;
+    if (!BuildLodChains(sceneData, options, &stats))
+    {
+        cerr << "Failed to create LOD geometries" << endl;
+        sceneData->Release();
+        return 1;
+    }
+    cout << "Generated " << stats._levelCount << " LOD levels for " << stats._geometryCount << " geometries ("
+        << stats._meshCount << " meshes): " << stats._sourceTriangles << " -> " << stats._levelTriangles << " triangles, max error "
+        << stats._maxError << ", " << fixed << setprecision(3) << stats._seconds << " s" << defaultfloat << endl;
+
+    res = PDVFileServices::SaveSceneData(sceneData, outputPath);
+    sceneData->Release();
+    if (res != PDV_RESULT_NO_ERROR)
+    {
+        cerr << "Error saving PDV file: " << res << endl;
+        return 1;
+    }
+    return 0;
+}
+
+// 为pdv文件中有BRep而没有主体网格的模型细分BRep，另存为outputPath  
+int BuildBRepMeshesFile(const CUnicodeString& inputPath, const CUnicodeString& outputPath, const TessellateOptions& options)
+{
+    IObjectFactory* piObjectFactory = IObjectFactory::GetObjectFactory();
+    if (!piObjectFactory)
+        return 1;
+    CMappedFile mapping;
+    ISceneData* sceneData = nullptr;
+    piObjectFactory->CreateSceneData(sceneData);
+    if (!sceneData)
+        return 1;
+
+    PDV_RESULT res = LoadSceneDataMapped(sceneData, inputPath, mapping);
+    if (res != PDV_RESULT_NO_ERROR)
+    {
+        cerr << "Error loading PDV file: " << res << endl;
+        sceneData->Release();
+        return 1;
+    }
+
+    TessellateStatistics stats;
+    if (!BuildBRepMeshes(sceneData, options, &stats))
+    {
+        cerr << "Failed to create BRep meshes" << endl;
+        sceneData->Release();
+        return 1;
+    }
+    cout << "Tessellated " << stats._brepCount << " BReps for " << stats._modelCount << " models: " << stats._faceCount << " faces ("
+        << stats._skippedFaceCount << " skipped), " << stats._vertexCount << " vertices, " << stats._triangleCount << " triangles, "
+        << fixed << setprecision(3) << stats._seconds << " s" << defaultfloat << endl;
+
+    res = PDVFileServices::SaveSceneData(sceneData, outputPath);
+    sceneData->Release();
+    if (res != PDV_RESULT_NO_ERROR)
+    {
+        cerr << "Error saving PDV file: " << res << endl;
+        return 1;
     }
+    return 0;
 }
 
-// 修改后的主转换函数  
-DftBool Convert(const CUnicodeString& iPdvPath, const string& outputDir)
+// 按pdv文件的瓦片集输出3D Tiles到outputDir，buildOptions不为NULL时按八叉树重新划分瓦片  
+int ExportTilesFile(const CUnicodeString& inputPath, const string& outputDir, DftUInt threadCount,
+    const TileBuildOptions* buildOptions)
 {
     IObjectFactory* piObjectFactory = IObjectFactory::GetObjectFactory();
     if (!piObjectFactory)
-        return FALSE;
-
+        return 1;
+    CMappedFile mapping;
     ISceneData* sceneData = nullptr;
-    PDV_RESULT res = piObjectFactory->CreateSceneData(sceneData);
+    piObjectFactory->CreateSceneData(sceneData);
     if (!sceneData)
-        return FALSE;
+        return 1;
 
-    res = PDVFileServices::LoadSceneData(sceneData, iPdvPath);
+    PDV_RESULT res = LoadSceneDataMapped(sceneData, inputPath, mapping);
     if (res != PDV_RESULT_NO_ERROR)
     {
-        cout << "Error loading PDV file: " << res << endl;
+        cerr << "Error loading PDV file: " << res << endl;
         sceneData->Release();
-        return FALSE;
+        return 1;
     }
 
-    // 确保输出目录存在  
-    if (!CreateDirectoryA(outputDir.c_str(), NULL)) {
-        if (GetLastError() != ERROR_ALREADY_EXISTS) {
-            cerr << "Failed to create output directory: " << outputDir << endl;
+    TileData root;
+    if (buildOptions)
+    {
+        TileBuildOptions options = *buildOptions;
+        options._threadCount = threadCount;
+        TileBuildStatistics buildStats;
+        if (!BuildOctreeTiles(sceneData, options, root, &buildStats))
+        {
+            cerr << "No render body with a bounding volume to build tiles" << endl;
             sceneData->Release();
-            return FALSE;
+            return 1;
         }
+        cout << "Built " << buildStats._tileCount << " tiles (" << buildStats._splitTileCount << " split by node), depth "
+            << buildStats._maxDepth << ", " << buildStats._itemCount << " render bodies, " << buildStats._triangleCount
+            << " triangles, max " << buildStats._maxTileTriangles << " per tile, " << fixed << setprecision(3)
+            << buildStats._seconds << " s" << defaultfloat << endl;
     }
 
-    // 收集节点信息  
-    CollectNodeInfo(sceneData, outputDir);
-
-    // 生成CSV文件  
-    GenerateCSVFiles(outputDir);
-
-    cout << "Generated CSV files:" << endl;
-    cout << "  - produce_models.csv" << endl;
-    cout << "  - product_tree.csv" << endl;
-    cout << "  - product_properties.csv" << endl;
-    cout << "  - product_pmi.csv" << endl;
-
-    // 如果需要，仍然可以遍历模型树并输出详细信息  
-    TraverseModelTree(sceneData, outputDir);
-
-    // 释放资源  
+    TilesStatistics stats;
+    DftBool result = ExportSceneTiles(sceneData, outputDir, threadCount, NULL, &stats, buildOptions ? &root : NULL);
     sceneData->Release();
-    return TRUE;
+    if (!result)
+    {
+        cerr << "Failed to export 3D Tiles to " << outputDir << endl;
+        return 1;
+    }
+    cout << "Exported " << stats._tileCount << " tiles, " << stats._contentCount << " GLB files (" << stats._bodyCount
+        << " render bodies, " << stats._sharedBodyCount << " shared), " << stats._triangleCount << " triangles, "
+        << stats._bytes << " bytes, " << fixed << setprecision(3) << stats._seconds << " s" << defaultfloat << endl;
+    return 0;
 }
 
-void TraverseModelTree(ISceneData* iSceneData, const string& outputDir)
+// 打开BRep存档，按需加载所有面并输出拓扑和几何的统计  
+int PrintBRepArchive(const CUnicodeString& inputPath)
 {
-    if (!iSceneData)
-        return;
-
-    // 获取所有模型树  
-    std::vector<IModelTree*> modelTreeArray;
-    iSceneData->GetModelTreeArray(modelTreeArray);
-
-    cout << "Found " << modelTreeArray.size() << " model trees" << endl;
-
-    for (DftUInt t = 0; t < modelTreeArray.size(); t++)
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    CBRepArchiveReader reader;
+    if (!reader.Open(inputPath))
     {
-        IModelTree* tree = modelTreeArray[t];
-        if (!tree)
+        cerr << "Failed to open BRep archive" << endl;
+        return 1;
+    }
+    double openSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    map<DftUInt8, DftUInt> topoCounts;
+    for (DftUInt i = 0; i < reader.GetTopoCount(); i++)
+        topoCounts[reader.GetTopo(i)._type]++;
+    cout << "Topology (" << reader.GetTopoCount() << "):" << endl;
+    for (map<DftUInt8, DftUInt>::const_iterator it = topoCounts.begin(); it != topoCounts.end(); ++it)
+        cout << "  " << TopoTypeToString(it->first) << ": " << it->second << endl;
+    cout << "Points: " << reader.GetGeometryCount(BREP_SECTION_POINT) << ", curves: " << reader.GetGeometryCount(BREP_SECTION_CURVE)
+         << ", surfaces: " << reader.GetGeometryCount(BREP_SECTION_SURFACE) << endl;
+
+    // 逐个加载面，统计面的曲面类型和边的曲线类型  
+    start = chrono::steady_clock::now();
+    vector<DftUInt> faces;
+    reader.GetFaces(faces);
+    map<DftUInt8, DftUInt> surfaceCounts;
+    map<DftUInt8, DftUInt> curveCounts;
+    DftUInt64 loopCount = 0;
+    DftUInt64 edgeCount = 0;
+    DftUInt failedCount = 0;
+    BRepArchiveFace face;
+    for (size_t i = 0; i < faces.size(); i++)
+    {
+        if (!reader.LoadFace(faces[i], face))
+        {
+            failedCount++;
             continue;
-
-        // 获取模型树名称  
-        CUnicodeString treeName;
-        tree->GetName(treeName);
-        cout << "\nModel Tree: " << treeName.ToMultiByte() << endl;
-
-        // 获取根节点  
-        IModelTreeNode* rootNode = nullptr;
-        if (tree->GetRootNode(rootNode) == PDV_RESULT_NO_ERROR && rootNode)
+        }
+        if (face._hasSurface)
+            surfaceCounts[face._surface._type]++;
+        loopCount += face._loops.size();
+        for (size_t j = 0; j < face._loops.size(); j++)
         {
-            // 使用栈进行非递归深度优先遍历  
-            stack<pair<IModelTreeNode*, int>> nodeStack;
-            nodeStack.push(make_pair(rootNode, 0));
-
-            while (!nodeStack.empty())
+            const vector<BRepArchiveEdge>& edges = face._loops[j]._edges;
+            edgeCount += edges.size();
+            for (size_t k = 0; k < edges.size(); k++)
             {
-                IModelTreeNode* currentNode = nodeStack.top().first;
-                int depth = nodeStack.top().second;
-                nodeStack.pop();
-
-                // 处理当前节点  
-                ProcessTreeNode(currentNode, depth, iSceneData, outputDir);
-
-                // 获取子节点  
-                std::vector<IModelTreeNode*> children;
-                if (currentNode->GetChildren(children) == PDV_RESULT_NO_ERROR)
-                {
-                    // 反向添加子节点以保证原始顺序  
-                    for (int i = static_cast<int>(children.size()) - 1; i >= 0; i--)
-                    {
-                        if (children[i])
-                        {
-                            nodeStack.push(make_pair(children[i], depth + 1));
-                        }
-                    }
-                }
+                if (edges[k]._hasCurve)
+                    curveCounts[edges[k]._curve._type]++;
             }
         }
     }
+    double loadSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Faces: " << faces.size() << ", loops: " << loopCount << ", edge uses: " << edgeCount << endl;
+    for (map<DftUInt8, DftUInt>::const_iterator it = surfaceCounts.begin(); it != surfaceCounts.end(); ++it)
+        cout << "  Surface " << SurfaceTypeToString(it->first) << ": " << it->second << endl;
+    for (map<DftUInt8, DftUInt>::const_iterator it = curveCounts.begin(); it != curveCounts.end(); ++it)
+        cout << "  Curve " << CurveTypeToString(it->first) << ": " << it->second << endl;
+    if (failedCount)
+        cerr << failedCount << " faces reference damaged geometry records" << endl;
+
+    // 建立拓扑图，按使用边的面数区分边界边（1）、流形边（2）和非流形边（>2）  
+    CTopoGraph graph;
+    TopoGraphStatistics graphStatistics;
+    graph.Build(reader, &graphStatistics);
+    DftUInt64 freeEdgeCount = 0;
+    DftUInt64 boundaryEdgeCount = 0;
+    DftUInt64 manifoldEdgeCount = 0;
+    DftUInt64 nonManifoldEdgeCount = 0;
+    for (DftUInt i = 0; i < graph.GetCount(); i++)
+    {
+        if (graph.GetType(i) != TOPOTYPE_EDGE)
+            continue;
+        DftUInt faceCount = graph.GetEdgeFaceCount(i);
+        if (faceCount == 0)
+            freeEdgeCount++;
+        else if (faceCount == 1)
+            boundaryEdgeCount++;
+        else if (faceCount == 2)
+            manifoldEdgeCount++;
+        else
+            nonManifoldEdgeCount++;
+    }
+    map<DftUInt8, DftUInt> rootCounts;
+    for (size_t i = 0; i < graph.GetRoots().size(); i++)
+        rootCounts[graph.GetType(graph.GetRoots()[i])]++;
+    cout << "Topology links: " << graphStatistics._linkCount << ", roots: " << graphStatistics._rootCount << endl;
+    for (map<DftUInt8, DftUInt>::const_iterator it = rootCounts.begin(); it != rootCounts.end(); ++it)
+        cout << "  Root " << TopoTypeToString(it->first) << ": " << it->second << endl;
+    cout << "Edges by face count: free " << freeEdgeCount << ", boundary " << boundaryEdgeCount << ", manifold "
+         << manifoldEdgeCount << ", non-manifold " << nonManifoldEdgeCount << endl;
+    if (graphStatistics._missingLinkCount || graphStatistics._cycleLinkCount || graphStatistics._duplicateIDCount)
+        cerr << "Topology skipped " << graphStatistics._missingLinkCount << " missing and " << graphStatistics._cycleLinkCount
+             << " cyclic links, " << graphStatistics._duplicateIDCount << " duplicate IDs" << endl;
+
+    cout << "Opened in " << fixed << setprecision(3) << openSeconds << " s, loaded faces in " << loadSeconds
+         << " s, built topology in " << graphStatistics._seconds << " s" << defaultfloat << endl;
+    return failedCount ? 1 : 0;
 }
 
-void ProcessTreeNode(IModelTreeNode* node, int depth, ISceneData* sceneData, const string& outputDir)
+// 在内存生成的场景上测试各导出阶段，结果写入outputRoot下的bench.json  
+int RunBenchmark(const string& outputRoot, const vector<BenchSceneSize>& sizes, DftUInt repeat)
 {
-    if (!node) return;
-
-    // 获取节点信息  
-    CUnicodeString nodeName;
-    node->GetName(nodeName);
-    DftUInt64 nodeID = node->GetID();
-
-    // 打印节点信息  
-    string indent(depth * 2, ' ');
-    cout << "\n" << indent << "Node: " << nodeName.ToMultiByte()
-        << " (ID: " << nodeID << ")" << endl;
-
-    // 打印可见性  
-    cout << indent << "  Visible: " << (node->GetVisible() ? "Yes" : "No") << endl;
+    CBenchmark benchmark(outputRoot, repeat);
+
+    // 整个场景输出为一个二进制STL文件  
+    benchmark.AddStage("ConvertToStl", [](ISceneData* sceneData, const string& dir) {
+        return ConvertToStl(sceneData, CUnicodeString((dir + "\\scene.stl").c_str()), STL_FORMAT_BINARY, 0, NULL, NULL, NULL, NULL);
+    });
+
+    // 同上，每个几何简化到四分之一  
+    benchmark.AddStage("SimplifiedStl", [](ISceneData* sceneData, const string& dir) {
+        SimplifyOptions simplify;
+        simplify._targetRatio = 0.25f;
+        return ConvertToStl(sceneData, CUnicodeString((dir + "\\scene.stl").c_str()), STL_FORMAT_BINARY, 0, NULL, &simplify, NULL, NULL);
+    });
+
+    // 每个零件节点输出一个ASCII STL文件  
+    benchmark.AddStage("ExportNodeToStl", [](ISceneData* sceneData, const string& dir) {
+        CNodeStlSink stlSink(dir, STL_FORMAT_ASCII, false);
+        CModelTreeWalker walker;
+        walker.AddSink(&stlSink);
+        walker.Walk(sceneData);
+        return stlSink.HasFailed() ? FALSE : TRUE;
+    });
+
+    // 建立节点表，之后的GenerateCSVFiles阶段使用同一张表  
+    CNodeTable nodeTable;
+    benchmark.AddStage("CollectNodeInfo", [&nodeTable](ISceneData* sceneData, const string& /*dir*/) {
+        CNodeTableSink tableSink(nodeTable);
+        CModelTreeWalker walker;
+        walker.AddSink(&tableSink);
+        walker.Walk(sceneData);
+        return nodeTable.GetCount() > 0 ? TRUE : FALSE;
+    });
+    benchmark.AddStage("GenerateCSVFiles", [&nodeTable](ISceneData* /*sceneData*/, const string& dir) {
+        return GenerateCSVFiles(nodeTable, dir);
+    });
+
+    // 按ID查找每个渲染网格的渲染几何和顶点数据：场景索引与ISceneData::Find*ByID对比  
+    benchmark.AddStage("SceneIndexLookup", [](ISceneData* sceneData, const string& /*dir*/) {
+        CSceneIndex sceneIndex(sceneData);
+        vector<IRenderMesh*> meshes;
+        sceneData->GetRenderMeshArray(meshes);
+        size_t found = 0;
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            IRenderGeometry* geometry = sceneIndex.FindRenderGeometry(meshes[i]->GetFirstRenderGeometryID());
+            if (geometry && sceneIndex.FindRenderVertex(geometry->GetVertexID()))
+                found++;
+        }
+        return found == meshes.size() ? TRUE : FALSE;
+    });
+    benchmark.AddStage("FindByIDLookup", [](ISceneData* sceneData, const string& /*dir*/) {
+        vector<IRenderMesh*> meshes;
+        sceneData->GetRenderMeshArray(meshes);
+        size_t found = 0;
+        for (size_t i = 0; i < meshes.size(); i++)
+        {
+            IRenderGeometry* geometry = sceneData->FindRenderGeometryByID(meshes[i]->GetFirstRenderGeometryID());
+            if (geometry && sceneData->FindRenderVertexByID(geometry->GetVertexID()))
+                found++;
+        }
+        return found == meshes.size() ? TRUE : FALSE;
+    });
+
+    // 读取全部顶点数据：GetVertexes整条记录拷贝与按标识位提取坐标和法向对比  
+    benchmark.AddStage("GetVertexes", [](ISceneData* sceneData, const string& /*dir*/) {
+        vector<IRenderVertex*> vertexes;
+        sceneData->GetRenderVertexArray(vertexes);
+        vector<VertexData> data;
+        for (size_t i = 0; i < vertexes.size(); i++)
+        {
+            if (vertexes[i]->GetVertexes(data) != PDV_RESULT_NO_ERROR)
+                return FALSE;
+        }
+        return TRUE;
+    });
+    benchmark.AddStage("ExtractVertexStreams", [](ISceneData* sceneData, const string& /*dir*/) {
+        vector<IRenderVertex*> vertexes;
+        sceneData->GetRenderVertexArray(vertexes);
+        VertexStreams streams;
+        for (size_t i = 0; i < vertexes.size(); i++)
+        {
+            if (!ExtractVertexStreams(vertexes[i], RENDER_VERTEX_MASK_POSITION | RENDER_VERTEX_MASK_NORMAL, streams))
+                return FALSE;
+        }
+        return TRUE;
+    });
 
-    // 获取变换信息 - 修正矩阵打印  
-    PDVMatrix4F worldTransform;
-    if (node->GetWorldTransform(worldTransform) == PDV_RESULT_NO_ERROR)
+    vector<BenchResult> results;
+    if (!benchmark.Run(sizes, results))
     {
-        cout << indent << "  World Transform:" << endl;
-        // 正确打印矩阵元素值  
-        for (int i = 0; i < 4; i++) {
-            cout << indent << "    ";
-            for (int j = 0; j < 4; j++) {
-                // 使用固定浮点数格式，设置精度为6位  
-                cout << fixed << setw(12) << setprecision(6)
-                    << worldTransform._data[i * 4 + j] << " ";
-            }
-            cout << endl;
-        }
+        cerr << "Failed to prepare benchmark scenes in: " << outputRoot << endl;
+        return 1;
     }
 
-    // 检查是否关联模型  
-    if (node->GetModelFlag())
+    size_t failed = 0;
+    for (size_t i = 0; i < results.size(); i++)
     {
-        IModel* model = node->GetModel();
-        if (model)
-        {
-            // 获取模型名称  
-            CUnicodeString modelName;
-            model->GetName(modelName);
-            cout << indent << "  Model: " << modelName.ToMultiByte() << endl;
-
-            // 打印属性表  
-            IAttribute* attr = model->GetAttribute();
-            if (attr)
-            {
-                PrintAttributeInfo(attr, depth);
-            }
-            else
-            {
-                cout << indent << "  No Attributes" << endl;
-            }
-
-            // 打印PMI信息  
-            IAnnotation* annotation = model->GetAnnotation();
-            if (annotation)
-            {
-                PrintPMIInfo(annotation, depth);
-            }
-            else
-            {
-                cout << indent << "  No PMI Information" << endl;
-            }
-
-            // 处理BRep数据  
-            DftUInt brepCount = model->GetBRepCount();
-            cout << indent << "  BRep Count: " << brepCount << endl;
-
-            // 为节点创建子目录  
-            string nodeDir = outputDir + "\\Node_" + to_string(nodeID);
-            CreateDirectoryA(nodeDir.c_str(), NULL);
-
-            // 导出节点整体STL  
-            string nodeStlPath = nodeDir + "\\" + nodeName.ToMultiByte() + ".stl";
-            if (ExportNodeToStl(sceneData, node, nodeStlPath))
-            {
-                cout << indent << "    Exported Node STL to: " << nodeStlPath << endl;
-            }
-
-            // 处理每个BRep  
-            for (DftUInt i = 0; i < brepCount; i++)
-            {
-                IBRep* brep = model->GetBRep(i);
-                if (brep)
-                {
-                    // 生成基础文件名  
-                    stringstream filename;
-                    filename << nodeDir << "\\BRep_" << i;
+        const BenchResult& result = results[i];
+        failed += result._success ? 0 : 1;
+        cout << setw(8) << left << result._scene << setw(18) << result._stage << right
+            << fixed << setprecision(3) << setw(10) << result._bestSeconds << " s"
+            << setprecision(0) << setw(14) << result.GetNodesPerSecond() << " nodes/s"
+            << setw(14) << result.GetTrianglesPerSecond() << " tris/s"
+            << setprecision(1) << setw(10) << result.GetOutputThroughput() << " MB/s"
+            << (result._success ? "" : "  FAILED") << defaultfloat << endl;
+    }
 
-                    // 导出BRep文本描述  
-                    ExportBRepAsText(brep, filename.str());
-                    cout << indent << "    Exported BRep text to: " << filename.str() << ".brep" << endl;
-                }
-            }
-        }
+    string reportPath = outputRoot + "\\bench.json";
+    if (!WriteBenchReport(results, reportPath))
+    {
+        cerr << "Failed to write benchmark report: " << reportPath << endl;
+        return 1;
     }
+    cout << "Report: " << reportPath << endl;
+    return failed ? 2 : 0;
 }
 
 void PrintAttributeInfo(IAttribute* attr, int depth)
@@ -808,6 +1163,7 @@ void PrintAttributeInfo(IAttribute* attr, int depth)
     if (!attr) return;
 
     string indent(depth * 2 + 4, ' ');
+    CTextBuilder value;
 
     // 获取属性组数量    
     DftUInt groupCount = attr->GetAttributeGroupCount();
@@ -854,62 +1210,66 @@ void PrintAttributeInfo(IAttribute* attr, int depth)
                         DftUInt valueType = item->GetValueType();
                         cout << " (Type: " << valueType << ") = ";
 
+                        // 数值经pdvtextformat格式化，不受cout上遗留的浮点格式影响  
+                        value.Clear();
                         switch (valueType)
                         {
                         case DATATYPE_BOOL:
                         {
                             DftBool boolValue;
                             if (item->GetBoolean(boolValue) == PDV_RESULT_NO_ERROR)
-                                cout << (boolValue ? "true" : "false");
+                                value.Append(boolValue ? "true" : "false");
                         }
                         break;
                         case DATATYPE_INT32:
                         {
                             DftInt intValue;
                             if (item->GetInteger(intValue) == PDV_RESULT_NO_ERROR)
-                                cout << intValue;
+                                value.AppendInt(intValue);
                         }
                         break;
                         case DATATYPE_FLOAT:
                         {
                             DftFloat floatValue;
                             if (item->GetFloat(floatValue) == PDV_RESULT_NO_ERROR)
-                                cout << floatValue;
+                                value.AppendGeneral(floatValue);
                         }
                         break;
                         case DATATYPE_DOUBLE:
                         {
                             DftDouble doubleValue;
                             if (item->GetDouble(doubleValue) == PDV_RESULT_NO_ERROR)
-                                cout << doubleValue;
+                                value.AppendGeneral(doubleValue);
                         }
                         break;
                         case DATATYPE_STRING:
                         {
                             CUnicodeString stringValue;
                             if (item->GetString(stringValue) == PDV_RESULT_NO_ERROR)
-                                cout << "\"" << stringValue.ToMultiByte() << "\"";
+                                value.Append('"').Append(stringValue.ToMultiByte()).Append('"');
                         }
                         break;
                         case DATATYPE_VECTOR3F:
                         {
                             PDVVector3F vectorValue;
                             if (item->GetVectorFloat3(vectorValue) == PDV_RESULT_NO_ERROR)
-                                cout << "(" << vectorValue.x() << ", " << vectorValue.y() << ", " << vectorValue.z() << ")";
+                                value.Append('(').AppendGeneral(vectorValue.x()).Append(", ").AppendGeneral(vectorValue.y())
+                                    .Append(", ").AppendGeneral(vectorValue.z()).Append(')');
                         }
                         break;
                         case DATATYPE_VECTOR3D:
                         {
                             PDVVector3D vectorValue;
                             if (item->GetVectorDouble3(vectorValue) == PDV_RESULT_NO_ERROR)
-                                cout << "(" << vectorValue.x() << ", " << vectorValue.y() << ", " << vectorValue.z() << ")";
+                                value.Append('(').AppendGeneral(vectorValue.x()).Append(", ").AppendGeneral(vectorValue.y())
+                                    .Append(", ").AppendGeneral(vectorValue.z()).Append(')');
                         }
                         break;
                         default:
-                            cout << "[Unknown Type]";
+                            value.Append("[Unknown Type]");
                             break;
                         }
-                        cout << endl;
+                        cout << value.GetText() << endl;
                     }
                 }
             }
@@ -921,11 +1281,22 @@ void PrintAttributeInfo(IAttribute* attr, int depth)
     }
 }
 
+// 以"(x, y, z)"格式输出坐标，数值为通用格式  
+template <typename Vector>
+const string& FormatPoint(CTextBuilder& text, const Vector& vector)
+{
+    text.Clear();
+    text.Append('(').AppendGeneral(vector.x()).Append(", ").AppendGeneral(vector.y()).Append(", ").AppendGeneral(vector.z()).Append(')');
+    return text.GetText();
+}
+
 void PrintPMIInfo(IAnnotation* annotation, int depth)
 {
     if (!annotation) return;
 
     string indent(depth * 2 + 4, ' ');
+    CTextBuilder line;
+    CTextBuilder point;
 
     // 获取各类标注对象的数量    
     DftUInt itemCount = annotation->GetAnnotationItemCount();
@@ -976,18 +1347,20 @@ void PrintPMIInfo(IAnnotation* annotation, int depth)
         }
         cout << indent << "    View Mode: " << viewModeStr << endl;
 
-        // 获取变换矩阵    
+        // 获取变换矩阵，定点4位小数，每个数右对齐到10个字符    
         PDVMatrix4F transformation = item->GetTransformation();
         cout << indent << "    Transformation Matrix:" << endl;
+        line.SetPrecision(4);
         for (int row = 0; row < 4; row++)
         {
-            cout << indent << "      ";
+            line.Clear();
+            line.Append(indent).Append("      ");
             for (int col = 0; col < 4; col++)
             {
-                cout << fixed << setw(10) << setprecision(4)
-                    << transformation._data[row * 4 + col] << " ";
+                size_t start = line.GetSize();
+                line.AppendFixed(transformation._data[row][col]).PadLeft(start, 10).Append(' ');
             }
-            cout << endl;
+            cout << line.GetText() << endl;
         }
 
         // 获取渲染主体ID    
@@ -1012,10 +1385,10 @@ void PrintPMIInfo(IAnnotation* annotation, int depth)
 
         // 获取三角形颜色    
         RGBColor triangleColor = item->GetTriangleColor();
-        cout << indent << "    Triangle Color: RGB("
-            << static_cast<int>(triangleColor._red) << ", "
-            << static_cast<int>(triangleColor._green) << ", "
-            << static_cast<int>(triangleColor._blue) << ")" << endl;
+        line.Clear();
+        line.Append(indent).Append("    Triangle Color: RGB(").AppendInt(triangleColor._red).Append(", ")
+            .AppendInt(triangleColor._green).Append(", ").AppendInt(triangleColor._blue).Append(')');
+        cout << line.GetText() << endl;
 
         // 获取线框数据    
         std::vector<WireFrame2DData> wires;
@@ -1165,10 +1538,8 @@ void PrintPMIInfo(IAnnotation* annotation, int depth)
                     {
                         const PlaneData& plane = clippingPlanes[p];
                         cout << indent << "        Plane " << p + 1 << ":" << endl;
-                        cout << indent << "          Origin: (" << plane._vOrigin.x() << ", "
-                            << plane._vOrigin.y() << ", " << plane._vOrigin.z() << ")" << endl;
-                        cout << indent << "          Normal: (" << plane._vAxisZ.x() << ", "
-                            << plane._vAxisZ.y() << ", " << plane._vAxisZ.z() << ")" << endl;
+                        cout << indent << "          Origin: " << FormatPoint(point, plane._vOrigin) << endl;
+                        cout << indent << "          Normal: " << FormatPoint(point, plane._vAxisZ) << endl;
                     }
                 }
             }
@@ -1232,13 +1603,14 @@ void PrintPMIInfo(IAnnotation* annotation, int depth)
             cout << indent << "      Transformation Matrix:" << endl;
             for (int row = 0; row < 4; row++)
             {
-                cout << indent << "        ";
+                line.Clear();
+                line.Append(indent).Append("        ");
                 for (int col = 0; col < 4; col++)
                 {
-                    cout << fixed << setw(10) << setprecision(4)
-                        << matrix._data[row * 4 + col] << " ";
+                    size_t start = line.GetSize();
+                    line.AppendFixed(matrix._data[row][col]).PadLeft(start, 10).Append(' ');
                 }
-                cout << endl;
+                cout << line.GetText() << endl;
             }
 
             // 获取外包盒    
@@ -1246,14 +1618,10 @@ void PrintPMIInfo(IAnnotation* annotation, int depth)
             if (geom->GetBox(boundingBox) == PDV_RESULT_NO_ERROR)
             {
                 cout << indent << "      Bounding Box:" << endl;
-                cout << indent << "        Center: (" << boundingBox._center.x() << ", "
-                    << boundingBox._center.y() << ", " << boundingBox._center.z() << ")" << endl;
-                cout << indent << "        X Axis: (" << boundingBox._axisX.x() << ", "
-                    << boundingBox._axisX.y() << ", " << boundingBox._axisX.z() << ")" << endl;
-                cout << indent << "        Y Axis: (" << boundingBox._axisY.x() << ", "
-                    << boundingBox._axisY.y() << ", " << boundingBox._axisY.z() << ")" << endl;
-                cout << indent << "        Z Axis: (" << boundingBox._axisZ.x() << ", "
-                    << boundingBox._axisZ.y() << ", " << boundingBox._axisZ.z() << ")" << endl;
+                cout << indent << "        Center: " << FormatPoint(point, boundingBox._center) << endl;
+                cout << indent << "        X Axis: " << FormatPoint(point, boundingBox._axisX) << endl;
+                cout << indent << "        Y Axis: " << FormatPoint(point, boundingBox._axisY) << endl;
+                cout << indent << "        Z Axis: " << FormatPoint(point, boundingBox._axisZ) << endl;
             }
 
             // 获取渲染主体ID    
@@ -1268,438 +1636,308 @@ void PrintPMIInfo(IAnnotation* annotation, int depth)
     }
 }
 
-void ExportBRepAsText(IBRep* bRep, const string& filenameBase)
+bool ExportNodeToStl(const CSceneIndex& sceneIndex, IModelTreeNode* node, const string& stlPath, StlFormat format,
+    CGeometryCache* geometryCache, const SimplifyOptions* simplify, NodeSimplifyReport* report, const LodSelectOptions* lod)
 {
-    if (!bRep) return;
+    if (!node || !node->GetModelFlag())
+        return false;
+
+    IModel* model = node->GetModel();
+    if (!model)
+        return false;
 
-    // 创建文本文件  
-    ofstream outFile((filenameBase + ".brep").c_str());
-    if (!outFile.is_open())
+    // 二进制格式需要预先知道三角面数，简化后的实际面数在关闭时回写；按节点上限简化时也需要节点的三角面总数
+    if (simplify && !simplify->IsEnabled())
+        simplify = NULL;
+    DftUInt64 facetCount = 0;
+    if (format == STL_FORMAT_BINARY || simplify)
+        facetCount = CountModelStlFacets(sceneIndex, model, lod);
+    if (report)
     {
-        cerr << "Failed to create BREP file: " << filenameBase << ".brep" << endl;
-        return;
+        report->_sourceTriangles = 0;
+        report->_resultTriangles = 0;
+        report->_error = 0.0f;
     }
 
-    // 文件头  
-    outFile << "BRep Text Format" << endl;
-    outFile << "=================" << endl << endl;
+    IStlWriter* stlWriter = CreateStlWriter(format);
+    if (!stlWriter->Open(stlPath, stlPath, facetCount))
+    {
+        SAFE_DELETE(stlWriter);
+        return false;
+    }
 
-    // 1. 拓扑信息  
-    std::vector<ITopo*> topos;
-    if (bRep->GetTopoArray(topos) == PDV_RESULT_NO_ERROR)
+    if (model->GetRenderBodyCount() == 0)
     {
-        outFile << "Topology Elements (" << topos.size() << "):" << endl;
-        outFile << "-------------------" << endl;
+        stlWriter->Close();
+        SAFE_DELETE(stlWriter);
+        return false;
+    }
 
-        // 使用映射存储拓扑对象，便于后续引用  
-        map<DftUInt64, ITopo*> topoMap;
+    PDVMatrix4F worldTrans;
+    node->GetWorldTransform(worldTrans);
 
-        for (size_t i = 0; i < topos.size(); i++)
+    CGeometryCache localCache(0);
+    CGeometryCache& cache = geometryCache ? *geometryCache : localCache;
+    TransformedVertexes worldVertexes;
+    vector<LodMeshSelection> meshes;
+    SelectModelGeometries(sceneIndex, model, lod, meshes);
+    for (size_t j = 0; j < meshes.size(); j++)
+    {
+        IRenderGeometry* renderGeometry = meshes[j]._geometry;
+        IRenderVertex* renderVertex = meshes[j]._vertex;
+
+        // 读取、变换按各自阶段计时，自身耗时即编码  
+        PDV_PROFILE_SCOPE(PROFILE_PHASE_SERIALIZE);
+
+        // 同一渲染几何只读取一次，之后的实例只做变换  
+        SimplifyTarget target;
+        if (simplify)
+            target = GetSimplifyTarget(*simplify, renderGeometry->GetIndexCount() / 3, facetCount);
+        CachedGeometryPtr geometry = cache.Get(renderGeometry, renderVertex, NULL, &target);
+        if (!geometry)
+            continue;
+        const std::vector<DftUInt>& indexes = geometry->_indexes;
+        if (report)
         {
-            ITopo* topo = topos[i];
-            if (!topo) continue;
-
-            DftUInt64 topoID = topo->GetID();
-            topoMap[topoID] = topo;
-
-            // 输出拓扑基本信息  
-            outFile << "Topo ID: " << topoID << endl;
-            outFile << "  Type: " << TopoTypeToString(topo->GetTopoType()) << endl;
-            outFile << "  Original ID: " << topo->GetOriginalID().ToMultiByte() << endl;
-            outFile << "  Orientation: " << OrientationToString(topo->GetOrientation()) << endl;
-
-            // 输出关联的几何信息  
-            outFile << "  Geometry:" << endl;
-            outFile << "    Type: " << GeomTypeToString(topo->GetGeometryType()) << endl;
-            outFile << "    ID: " << topo->GetGeometryID() << endl;
-
-            // 输出子拓扑  
-            const std::vector<DftUInt64>& subTopoIDs = topo->GetTopoIDs();
-            if (!subTopoIDs.empty())
-            {
-                outFile << "  Sub-Topos (" << subTopoIDs.size() << "):" << endl;
-                for (size_t j = 0; j < subTopoIDs.size(); j++)
-                {
-                    outFile << "    - " << subTopoIDs[j] << endl;
-                }
-            }
-            outFile << endl;
+            report->_sourceTriangles += geometry->_sourceTriangles;
+            report->_resultTriangles += geometry->GetTriangleCount();
+            report->_error = max(report->_error, geometry->_error);
         }
 
-        // 2. 拓扑层次结构  
-        outFile << endl << "Topology Hierarchy:" << endl;
-        outFile << "-------------------" << endl;
+        // 应用世界变换，每个顶点只变换一次  
+        TransformVertexes(geometry->GetPositions(), geometry->GetNormals(), worldTrans, worldVertexes);
 
-        // 查找顶级拓扑（没有父拓扑的）  
-        set<DftUInt64> childTopos;
-        for (auto& pair : topoMap)
+        DftUInt triangleCount = static_cast<DftUInt>(indexes.size()) / 3;
+        for (DftUInt c = 0; c < triangleCount; c++)
         {
-            const std::vector<DftUInt64>& subIDs = pair.second->GetTopoIDs();
-            for (DftUInt64 id : subIDs)
-            {
-                childTopos.insert(id);
-            }
-        }
+            const DftUInt* tri = &indexes[c * 3];
 
-        // 递归打印拓扑层次  
-        std::function<void(DftUInt64, int)> printTopoHierarchy = [&](DftUInt64 topoID, int level) {
-            auto it = topoMap.find(topoID);
-            if (it == topoMap.end()) return;
+            // 写入STL格式  
+            stlWriter->AddFacet(worldVertexes.Normal(tri[0]), worldVertexes.Position(tri[0]),
+                worldVertexes.Position(tri[1]), worldVertexes.Position(tri[2]));
+        }
+        PDV_PROFILE_COUNT(PROFILE_COUNTER_TRIANGLES, triangleCount);
+    }
 
-            ITopo* topo = it->second;
-            string indent(level * 2, ' ');
+    bool result = stlWriter->Close() ? true : false;
+    SAFE_DELETE(stlWriter);
+    return result;
+}
 
-            outFile << indent << TopoTypeToString(topo->GetTopoType())
-                << " [ID: " << topoID << "]" << endl;
+// 用法：  
+//   pdvexport <input.pdv> <outputDir> [--simplify ratio] [--max-error E] [--node-budget N]  
+//             [--lod-level N | --lod-error E | --lod-budget N]  
+//   pdvexport --batch <directory|manifest> <outputRoot> [--workers N] [--prefetch N]  
+//   pdvexport --bench <outputRoot> [--scene small|medium|huge]... [--repeat N]  
+//   pdvexport --lod <input.pdv> <output.pdv> [--levels N] [--ratio R] [--min-triangles N] [--max-error E] [--threads N]  
+//   pdvexport --tessellate <input.pdv> <output.pdv> [--tolerance T] [--relative-tolerance R] [--max-segments N] [--threads N]  
+// 设置环境变量PDV_PROFILE为报告路径时，退出时输出分阶段耗时报告  
+int main(int argc, char* argv[])
+{
+    StartProfilerFromEnvironment();
 
-            // 递归打印子拓扑  
-            const std::vector<DftUInt64>& subIDs = topo->GetTopoIDs();
-            for (DftUInt64 subID : subIDs)
-            {
-                printTopoHierarchy(subID, level + 1);
-            }
-            };
+    if (argc < 2)
+    {
+        // 使用实际PDV文件路径和输出目录  
+        Convert(
+            "D:\\work\\code\\DevelopmentCode\\PDVReader\\test\\pdv_top\\top.pdv",
+            "D:\\work\\code\\DevelopmentCode\\PDVReader\\test\\output"
+        );
+        return 0;
+    }
 
-        // 打印所有顶级拓扑  
-        for (auto& pair : topoMap)
+    if (strcmp(argv[1], "--batch") == 0)
+    {
+        if (argc < 4)
+        {
+            cerr << "Usage: " << argv[0] << " --batch <directory|manifest> <outputRoot> [--workers N] [--prefetch N]" << endl;
+            return 1;
+        }
+        DftUInt workerCount = 0;
+        DftUInt prefetchDepth = 0;
+        for (int i = 4; i + 1 < argc; i += 2)
         {
-            if (childTopos.find(pair.first) == childTopos.end())
+            if (strcmp(argv[i], "--workers") == 0)
+                workerCount = static_cast<DftUInt>(strtoul(argv[i + 1], NULL, 10));
+            else if (strcmp(argv[i], "--prefetch") == 0)
+                prefetchDepth = static_cast<DftUInt>(strtoul(argv[i + 1], NULL, 10));
+            else
             {
-                printTopoHierarchy(pair.first, 0);
-                outFile << endl;
+                cerr << "Unknown option: " << argv[i] << endl;
+                return 1;
             }
         }
-    }
-    else
-    {
-        outFile << "No topology information available" << endl;
+        return ConvertBatch(argv[2], argv[3], workerCount, prefetchDepth);
     }
 
-    // 3. 几何点信息  
-    std::vector<IGeomPointData*> points;
-    if (bRep->GetGeomPointDataArray(points) == PDV_RESULT_NO_ERROR)
+    if (strcmp(argv[1], "--bench") == 0)
     {
-        outFile << endl << "Points (" << points.size() << "):" << endl;
-        outFile << "-------" << endl;
-
-        for (size_t i = 0; i < points.size(); i++)
+        if (argc < 3)
         {
-            IGeomPointData* point = points[i];
-            if (point)
+            cerr << "Usage: " << argv[0] << " --bench <outputRoot> [--scene small|medium|huge]... [--repeat N]" << endl;
+            return 1;
+        }
+        vector<BenchSceneSize> sizes;
+        DftUInt repeat = 3;
+        for (int i = 3; i + 1 < argc; i += 2)
+        {
+            BenchSceneSize size;
+            if (strcmp(argv[i], "--scene") == 0 && ParseBenchSceneSize(argv[i + 1], size))
+                sizes.push_back(size);
+            else if (strcmp(argv[i], "--repeat") == 0)
+                repeat = static_cast<DftUInt>(strtoul(argv[i + 1], NULL, 10));
+            else
             {
-                PDVVector3D position = point->GetPosition();
-                outFile << "Point " << i + 1 << " (ID: " << point->GetID() << "): ("
-                    << position.x() << ", " << position.y() << ", " << position.z() << ")" << endl;
+                cerr << "Unknown option: " << argv[i] << " " << argv[i + 1] << endl;
+                return 1;
             }
         }
+        if (sizes.empty())
+        {
+            sizes.push_back(BENCH_SCENE_SMALL);
+            sizes.push_back(BENCH_SCENE_MEDIUM);
+            sizes.push_back(BENCH_SCENE_HUGE);
+        }
+        return RunBenchmark(argv[2], sizes, repeat);
     }
 
-                outFile << "  Type: " << CurveTypeToString(curve->GetType()) << endl;
-                ICurve* baseCurve = curve->GetCurve();
-                if (baseCurve)
-                {
-                    switch (baseCurve->GetType())
-                    {
-                    case CT_LINE:
-                    {
-                        ILine* line = dynamic_cast<ILine*>(baseCurve);
-                        if (line)
-                        {
-                            PDVVector3D origin = line->GetOrigin();
-                            PDVVector3D dir = line->GetDirection();
-                            outFile << "  Origin: (" << origin.x() << ", " << origin.y() << ", " << origin.z() << ")" << endl;
-                            outFile << "  Direction: (" << dir.x() << ", " << dir.y() << ", " << dir.z() << ")" << endl;
-                        }
-                        break;
-                    }
-                    case CT_CIRCLE:
-                    {
-                        ICircle* circle = dynamic_cast<ICircle*>(baseCurve);
-                        if (circle)
-                        {
-                            PDVVector3D origin = circle->GetOrigin();
-                            PDVVector3D xDir = circle->GetXDirection();
-                            PDVVector3D yDir = circle->GetYDirection();
-                            outFile << "  Origin: (" << origin.x() << ", " << origin.y() << ", " << origin.z() << ")" << endl;
-                            outFile << "  XDirection: (" << xDir.x() << ", " << xDir.y() << ", " << xDir.z() << ")" << endl;
-                            outFile << "  YDirection: (" << yDir.x() << ", " << yDir.y() << ", " << yDir.z() << ")" << endl;
-                            outFile << "  Radius: " << circle->GetRadius() << endl;
-                        }
-                        break;
-                    }
-                    case CT_ELLIPSE:
-                    {
-                        IEllipse* ellipse = dynamic_cast<IEllipse*>(baseCurve);
-                        if (ellipse)
-                        {
-                            PDVVector3D origin = ellipse->GetOrigin();
-                            PDVVector3D xDir = ellipse->GetXDirection();
-                            PDVVector3D yDir = ellipse->GetYDirection();
-                            outFile << "  Origin: (" << origin.x() << ", " << origin.y() << ", " << origin.z() << ")" << endl;
-                            outFile << "  XDirection: (" << xDir.x() << ", " << xDir.y() << ", " << xDir.z() << ")" << endl;
-                            outFile << "  YDirection: (" << yDir.x() << ", " << yDir.y() << ", " << yDir.z() << ")" << endl;
-                            outFile << "  Major Radius: " << ellipse->GetMajorRadius() << endl;
-                            outFile << "  Minor Radius: " << ellipse->GetMinorRadius() << endl;
-                        }
-                        break;
-                    }
-                    case CT_BSPLINECURVE:
-                    {
-                        INurbsCurve* nc = dynamic_cast<INurbsCurve*>(baseCurve);
-                        if (nc)
-                        {
-                            NurbsCurveData data;
-                            nc->GetNurbsCurve(data);
-                            outFile << "  Degree: " << static_cast<int>(data._degree) << endl;
-                            outFile << "  Control Points: " << data._ctrlPoints.size() << endl;
-                            for (size_t cpi = 0; cpi < data._ctrlPoints.size(); ++cpi)
-                            {
-                                const PDVVector3D& p = data._ctrlPoints[cpi];
-                                outFile << "    CP" << cpi + 1 << ": (" << p.x() << ", " << p.y() << ", " << p.z() << ")";
-                                if (cpi < data._weights.size())
-                                    outFile << " w=" << data._weights[cpi];
-                                outFile << endl;
-                            }
-                            outFile << "  Knots: ";
-                            for (size_t ki = 0; ki < data._knots.size(); ++ki)
-                            {
-                                outFile << data._knots[ki];
-                                if (ki + 1 < data._knots.size()) outFile << ", ";
-                            }
-                            outFile << endl;
-                        }
-                        break;
-                    }
-                    }
-                }
-                outFile << "  Type: " << SurfaceTypeToString(surface->GetType()) << endl;
-                ISurface* srf = surface->GetSurface();
-                if (srf)
-                {
-                    switch (srf->GetType())
-                    {
-                    case ST_PLANE:
-                    {
-                        IPlane* plane = dynamic_cast<IPlane*>(srf);
-                        if (plane)
-                        {
-                            PDVVector3D origin = plane->GetOrigin();
-                            PDVVector3D normal = plane->GetZDirection();
-                            outFile << "  Origin: (" << origin.x() << ", " << origin.y() << ", " << origin.z() << ")" << endl;
-                            outFile << "  Normal: (" << normal.x() << ", " << normal.y() << ", " << normal.z() << ")" << endl;
-                        }
-                        break;
-                    }
-                    case ST_CYLINDER:
-                    {
-                        ICylinder* cyl = dynamic_cast<ICylinder*>(srf);
-                        if (cyl)
-                        {
-                            PDVVector3D origin = cyl->GetOrigin();
-                            PDVVector3D axis = cyl->GetZDirection();
-                            outFile << "  Origin: (" << origin.x() << ", " << origin.y() << ", " << origin.z() << ")" << endl;
-                            outFile << "  Axis: (" << axis.x() << ", " << axis.y() << ", " << axis.z() << ")" << endl;
-                            outFile << "  Radius: " << cyl->GetRadius() << endl;
-                        }
-                        break;
-                    }
-                    case ST_CONE:
-                    {
-                        ICone* cone = dynamic_cast<ICone*>(srf);
-                        if (cone)
-                        {
-                            PDVVector3D origin = cone->GetOrigin();
-                            PDVVector3D axis = cone->GetZDirection();
-                            outFile << "  Origin: (" << origin.x() << ", " << origin.y() << ", " << origin.z() << ")" << endl;
-                            outFile << "  Axis: (" << axis.x() << ", " << axis.y() << ", " << axis.z() << ")" << endl;
-                            outFile << "  Radius: " << cone->GetRadius() << endl;
-                            outFile << "  Half Angle: " << cone->GetHalfAngle() << endl;
-                        }
-                        break;
-                    }
-                    case ST_TORUS:
-                    {
-                        ITorus* torus = dynamic_cast<ITorus*>(srf);
-                        if (torus)
-                        {
-                            PDVVector3D origin = torus->GetOrigin();
-                            PDVVector3D axis = torus->GetZDirection();
-                            outFile << "  Origin: (" << origin.x() << ", " << origin.y() << ", " << origin.z() << ")" << endl;
-                            outFile << "  Axis: (" << axis.x() << ", " << axis.y() << ", " << axis.z() << ")" << endl;
-                            outFile << "  Major Radius: " << torus->GetMajorRadius() << endl;
-                            outFile << "  Minor Radius: " << torus->GetMinorRadius() << endl;
-                        }
-                        break;
-                    }
-                    case ST_SPHERE:
-                    {
-                        ISphere* sphere = dynamic_cast<ISphere*>(srf);
-                        if (sphere)
-                        {
-                            PDVVector3D origin = sphere->GetOrigin();
-                            outFile << "  Origin: (" << origin.x() << ", " << origin.y() << ", " << origin.z() << ")" << endl;
-                            outFile << "  Radius: " << sphere->GetRadius() << endl;
-                        }
-                        break;
-                    }
-                    case ST_BSPLINESURFACE:
-                    {
-                        INurbsSurface* ns = dynamic_cast<INurbsSurface*>(srf);
-                        if (ns)
-                        {
-                            NurbsSurfaceData d;
-                            ns->GetNurbsSurface(d);
-                            outFile << "  U Degree: " << static_cast<int>(d._uDegree) << endl;
-                            outFile << "  V Degree: " << static_cast<int>(d._vDegree) << endl;
-                            outFile << "  Control Net: " << d._ctrlRowCount << " x " << d._ctrlColumnCount << endl;
-                            outFile << "  Knots U: ";
-                            for(size_t ki=0; ki<d._uKnots.size(); ++ki){ outFile << d._uKnots[ki]; if(ki+1<d._uKnots.size()) outFile << ", "; }
-                            outFile << endl;
-                            outFile << "  Knots V: ";
-                            for(size_t ki=0; ki<d._vKnots.size(); ++ki){ outFile << d._vKnots[ki]; if(ki+1<d._vKnots.size()) outFile << ", "; }
-                            outFile << endl;
-                        }
-                        break;
-                    }
-                    }
-                }
-    if (bRep->GetGeomCurveDataArray(curves) == PDV_RESULT_NO_ERROR)
+    if (strcmp(argv[1], "--lod") == 0)
     {
-        outFile << endl << "Curves (" << curves.size() << "):" << endl;
-        outFile << "-------" << endl;
-
-        for (size_t i = 0; i < curves.size(); i++)
+        if (argc < 4)
         {
-            IGeomCurveData* curve = curves[i];
-            if (curve)
+            cerr << "Usage: " << argv[0] << " --lod <input.pdv> <output.pdv> [--levels N] [--ratio R] [--min-triangles N] [--max-error E] [--threads N]" << endl;
+            return 1;
+        }
+        LodOptions options;
+        for (int i = 4; i + 1 < argc; i += 2)
+        {
+            if (strcmp(argv[i], "--levels") == 0)
+                options._levelCount = static_cast<DftUInt>(strtoul(argv[i + 1], NULL, 10));
+            else if (strcmp(argv[i], "--ratio") == 0)
+                options._levelRatio = static_cast<DftFloat>(atof(argv[i + 1]));
+            else if (strcmp(argv[i], "--min-triangles") == 0)
+                options._minTriangles = static_cast<DftUInt>(strtoul(argv[i + 1], NULL, 10));
+            else if (strcmp(argv[i], "--max-error") == 0)
+                options._maxError = static_cast<DftFloat>(atof(argv[i + 1]));
+            else if (strcmp(argv[i], "--threads") == 0)
+                options._threadCount = static_cast<DftUInt>(strtoul(argv[i + 1], NULL, 10));
+            else
             {
-                outFile << "Curve " << i + 1 << " (ID: " << curve->GetID() << "):" << endl;
-                outFile << "  Type: " << static_cast<int>(curve->GetType()) << endl;
-                outFile << "  Start Parameter: " << curve->GetStartParameter() << endl;
-                outFile << "  End Parameter: " << curve->GetEndParameter() << endl;
+                cerr << "Unknown option: " << argv[i] << endl;
+                return 1;
             }
         }
+        return BuildLodFile(argv[2], argv[3], options);
     }
 
-    // 5. 几何曲面信息  
-    std::vector<IGeomSurfaceData*> surfaces;
-    if (bRep->GetGeomSurfaceDataArray(surfaces) == PDV_RESULT_NO_ERROR)
+    if (strcmp(argv[1], "--tessellate") == 0)
     {
-        outFile << endl << "Surfaces (" << surfaces.size() << "):" << endl;
-        outFile << "---------" << endl;
-
-        for (size_t i = 0; i < surfaces.size(); i++)
+        if (argc < 4)
         {
-            IGeomSurfaceData* surface = surfaces[i];
-            if (surface)
+            cerr << "Usage: " << argv[0]
+                << " --tessellate <input.pdv> <output.pdv> [--tolerance T] [--relative-tolerance R] [--max-segments N] [--threads N]" << endl;
+            return 1;
+        }
+        TessellateOptions options;
+        for (int i = 4; i + 1 < argc; i += 2)
+        {
+            if (strcmp(argv[i], "--tolerance") == 0)
+                options._chordTolerance = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--relative-tolerance") == 0)
+                options._relativeTolerance = atof(argv[i + 1]);
+            else if (strcmp(argv[i], "--max-segments") == 0)
+                options._maxSegments = static_cast<DftUInt>(strtoul(argv[i + 1], NULL, 10));
+            else if (strcmp(argv[i], "--threads") == 0)
+                options._threadCount = static_cast<DftUInt>(strtoul(argv[i + 1], NULL, 10));
+            else
             {
-                outFile << "Surface " << i + 1 << " (ID: " << surface->GetID() << "):" << endl;
-                outFile << "  Type: " << static_cast<int>(surface->GetType()) << endl;
-
-                PDVVector2D domainMin = surface->GetDomainMin();
-                PDVVector2D domainMax = surface->GetDomainMax();
-                outFile << "  Domain Min: (" << domainMin.x() << ", " << domainMin.y() << ")" << endl;
-                outFile << "  Domain Max: (" << domainMax.x() << ", " << domainMax.y() << ")" << endl;
+                cerr << "Unknown option: " << argv[i] << endl;
+                return 1;
             }
         }
+        return BuildBRepMeshesFile(argv[2], argv[3], options);
     }
 
-    outFile.close();
-}
-
-bool ExportNodeToStl(ISceneData* iSceneData, IModelTreeNode* node, const string& stlPath)
-{
-    if (!node || !node->GetModelFlag() || !iSceneData)
-        return false;
-
-    IModel* model = node->GetModel();
-    if (!model)
-        return false;
-
-    ofstream ofStl(stlPath);
-    if (!ofStl.is_open())
-        return false;
-
-    ofStl << "solid " << stlPath << endl;
-
-    DftUInt renderBodyCount = model->GetRenderBodyCount();
-    if (renderBodyCount == 0)
+    if (strcmp(argv[1], "--brep-info") == 0)
     {
-        ofStl << "endsolid" << endl;
-        ofStl.close();
-        return false;
+        if (argc < 3)
+        {
+            cerr << "Usage: " << argv[0] << " --brep-info <input.pbrep>" << endl;
+            return 1;
+        }
+        return PrintBRepArchive(argv[2]);
     }
 
-    PDVMatrix4F worldTrans;
-    node->GetWorldTransform(worldTrans);
-
-    for (DftUInt i = 0; i < renderBodyCount; i++)
+    if (strcmp(argv[1], "--tiles") == 0)
     {
-        DftUInt64 renderBodyID = model->GetRenderBodyID(i);
-        IRenderBody* renderBody = iSceneData->FindRenderBodyByID(renderBodyID);
-        if (!renderBody)
-            continue;
-
-        std::vector<DftUInt64> faceMeshIDs;
-        renderBody->GetFaceMeshIDs(faceMeshIDs);
-
-        for (DftUInt j = 0; j < faceMeshIDs.size(); j++)
+        if (argc < 4)
         {
-            IRenderMesh* renderMesh = iSceneData->FindRenderMeshByID(faceMeshIDs[j]);
-            if (!renderMesh || renderMesh->GetType() != RENDER_MESH_TYPE_MAIN)
-                continue;
-
-            IRenderGeometry* renderGeometry = iSceneData->FindRenderGeometryByID(renderMesh->GetFirstRenderGeometryID());
-            if (!renderGeometry)
-                continue;
-
-            IRenderVertex* renderVertex = iSceneData->FindRenderVertexByID(renderGeometry->GetVertexID());
-            if (!renderVertex)
-                continue;
-
-            std::vector<kernel::pdv::VertexData> vertexData;
-            renderVertex->GetVertexes(vertexData);
-
-            std::vector<DftUInt> indexes;
-            renderGeometry->GetIndexes(indexes);
-
-            DftUInt triangleCount = static_cast<DftUInt>(indexes.size()) / 3;
-            for (DftUInt c = 0; c < triangleCount; c++)
+            cerr << "Usage: " << argv[0]
+                << " --tiles <input.pdv> <outputDir> [--threads N] [--tile-triangles N] [--max-depth N]" << endl;
+            return 1;
+        }
+        DftUInt threadCount = 0;
+        TileBuildOptions buildOptions;
+        DftBool octree = FALSE;
+        for (int i = 4; i + 1 < argc; i += 2)
+        {
+            if (strcmp(argv[i], "--threads") == 0)
+                threadCount = static_cast<DftUInt>(strtoul(argv[i + 1], NULL, 10));
+            else if (strcmp(argv[i], "--tile-triangles") == 0)
+            {
+                buildOptions._maxTriangles = strtoull(argv[i + 1], NULL, 10);
+                octree = TRUE;
+            }
+            else if (strcmp(argv[i], "--max-depth") == 0)
+            {
+                buildOptions._maxDepth = static_cast<DftUInt>(strtoul(argv[i + 1], NULL, 10));
+                octree = TRUE;
+            }
+            else
             {
-                PDVVector3F worldNormal, worldP1, worldP2, worldP3;
-                const VertexData& v1 = vertexData[indexes[c * 3]];
-                const VertexData& v2 = vertexData[indexes[c * 3 + 1]];
-                const VertexData& v3 = vertexData[indexes[c * 3 + 2]];
-
-                // 应用世界变换  
-                DftTransformVector3F(v1._normal, worldTrans._data, worldNormal);
-                DftTransformPoint3F(v1._position, worldTrans._data, worldP1);
-                DftTransformPoint3F(v2._position, worldTrans._data, worldP2);
-                DftTransformPoint3F(v3._position, worldTrans._data, worldP3);
-
-                // 写入STL格式  
-                ofStl << "   facet normal " << worldNormal.x() << " " << worldNormal.y() << " " << worldNormal.z() << endl;
-                ofStl << "      outer loop" << endl;
-                ofStl << "         vertex " << worldP1.x() << " " << worldP1.y() << " " << worldP1.z() << endl;
-                ofStl << "         vertex " << worldP2.x() << " " << worldP2.y() << " " << worldP2.z() << endl;
-                ofStl << "         vertex " << worldP3.x() << " " << worldP3.y() << " " << worldP3.z() << endl;
-                ofStl << "      endloop" << endl;
-                ofStl << "   endfacet" << endl;
+                cerr << "Unknown option: " << argv[i] << endl;
+                return 1;
             }
         }
+        return ExportTilesFile(argv[2], argv[3], threadCount, octree ? &buildOptions : NULL);
     }
 
-    ofStl << "endsolid" << endl;
-    ofStl.close();
-    return true;
+    if (argc < 3)
+    {
+        cerr << "Usage: " << argv[0] << " <input.pdv> <outputDir> [--simplify ratio] [--max-error E] [--node-budget N]"
+             << " [--lod-level N | --lod-error E | --lod-budget N]" << endl;
+        return 1;
+    }
+    SimplifyOptions simplify;
+    LodSelectOptions lod;
+    for (int i = 3; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--simplify") == 0)
+            simplify._targetRatio = static_cast<DftFloat>(atof(argv[i + 1]));
+        else if (strcmp(argv[i], "--max-error") == 0)
+            simplify._maxError = static_cast<DftFloat>(atof(argv[i + 1]));
+        else if (strcmp(argv[i], "--node-budget") == 0)
+            simplify._nodeTriangleBudget = strtoull(argv[i + 1], NULL, 10);
+        else if (strcmp(argv[i], "--lod-level") == 0)
+        {
+            lod._mode = LOD_SELECT_LEVEL;
+            lod._level = static_cast<DftUInt>(strtoul(argv[i + 1], NULL, 10));
+        }
+        else if (strcmp(argv[i], "--lod-error") == 0)
+        {
+            lod._mode = LOD_SELECT_ERROR;
+            lod._maxError = static_cast<DftFloat>(atof(argv[i + 1]));
+        }
+        else if (strcmp(argv[i], "--lod-budget") == 0)
+        {
+            lod._mode = LOD_SELECT_BUDGET;
+            lod._nodeTriangleBudget = strtoull(argv[i + 1], NULL, 10);
+        }
+        else
+        {
+            cerr << "Unknown option: " << argv[i] << endl;
+            return 1;
+        }
+    }
+    return Convert(argv[1], argv[2], &simplify, &lod) ? 0 : 1;
 }
-
-int main()
-{
-    // 使用实际PDV文件路径和输出目录  
-    Convert(
-        "D:\\work\\code\\DevelopmentCode\\PDVReader\\test\\pdv_top\\top.pdv",
-        "D:\\work\\code\\DevelopmentCode\\PDVReader\\test\\output"
-    );
-    return 0;
-}
\ No newline at end of file
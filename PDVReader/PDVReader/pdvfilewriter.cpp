@@ -0,0 +1,147 @@
+#include "pdvfilewriter.h"
+#include "pdvprofiler.h"
+#include <cstring>
+
+using namespace std;
+
+CBufferedFileWriter::CBufferedFileWriter(size_t iChunkSize)
+    : m_Buffer(iChunkSize > 0 ? iChunkSize : PDV_WRITER_DEFAULT_CHUNK_SIZE)
+    , m_Used(0)
+    , m_Flushed(0)
+    , m_Failed(FALSE)
+{
+}
+
+CBufferedFileWriter::~CBufferedFileWriter()
+{
+    Close();
+}
+
+DftBool CBufferedFileWriter::Open(const string& iPath)
+{
+    Close();
+    m_Used = 0;
+    m_Flushed = 0;
+    m_Failed = FALSE;
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_WRITE);
+    m_File.open(iPath.c_str(), ios::out | ios::binary | ios::trunc);
+    return IsOpen();
+}
+
+DftBool CBufferedFileWriter::Close()
+{
+    // 未打开时丢弃未写盘的数据，有数据被丢弃即为失败
+    if (!m_File.is_open())
+        return Flush();
+
+    Flush();
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_WRITE);
+    m_File.close();
+    if (m_File.fail())
+        m_Failed = TRUE;
+    return !m_Failed;
+}
+
+DftBool CBufferedFileWriter::Flush()
+{
+    if (m_Used == 0)
+        return !m_Failed;
+    if (!m_File.is_open())
+    {
+        // 文件未打开时丢弃缓冲区中的数据，之后的写入操作仍有空间可用，不会反复尝试写盘或越界
+        m_Failed = TRUE;
+        m_Used = 0;
+        return FALSE;
+    }
+
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_WRITE);
+    PDV_PROFILE_COUNT(PROFILE_COUNTER_BYTES_WRITTEN, m_Used);
+    m_File.write(reinterpret_cast<const char*>(&m_Buffer[0]), static_cast<streamsize>(m_Used));
+    if (!m_File)
+        m_Failed = TRUE;
+    m_Flushed += m_Used;
+    m_Used = 0;
+    return !m_Failed;
+}
+
+void CBufferedFileWriter::Write(const void* iData, size_t iSize)
+{
+    const DftByte* src = static_cast<const DftByte*>(iData);
+    while (iSize > 0)
+    {
+        if (m_Used == m_Buffer.size())
+            Flush();
+
+        // 大块数据在缓冲区为空时直接写盘，省去一次拷贝
+        if (m_Used == 0 && iSize >= m_Buffer.size() && m_File.is_open())
+        {
+            PDV_PROFILE_SCOPE(PROFILE_PHASE_WRITE);
+            PDV_PROFILE_COUNT(PROFILE_COUNTER_BYTES_WRITTEN, iSize);
+            m_File.write(reinterpret_cast<const char*>(src), static_cast<streamsize>(iSize));
+            if (!m_File)
+                m_Failed = TRUE;
+            m_Flushed += iSize;
+            return;
+        }
+
+        size_t count = m_Buffer.size() - m_Used;
+        if (count > iSize)
+            count = iSize;
+        memcpy(&m_Buffer[m_Used], src, count);
+        m_Used += count;
+        src += count;
+        iSize -= count;
+    }
+}
+
+void CBufferedFileWriter::WriteZeros(size_t iSize)
+{
+    while (iSize > 0)
+    {
+        if (m_Used == m_Buffer.size())
+            Flush();
+        size_t count = m_Buffer.size() - m_Used;
+        if (count > iSize)
+            count = iSize;
+        memset(&m_Buffer[m_Used], 0, count);
+        m_Used += count;
+        iSize -= count;
+    }
+}
+
+DftByte* CBufferedFileWriter::Reserve(size_t iSize)
+{
+    if (iSize > m_Buffer.size())
+        m_Buffer.resize(iSize);
+    if (m_Buffer.size() - m_Used < iSize)
+        Flush();
+    DftByte* ptr = &m_Buffer[m_Used];
+    m_Used += iSize;
+    return ptr;
+}
+
+DftBool CBufferedFileWriter::WriteAt(DftUInt64 iOffset, const void* iData, size_t iSize)
+{
+    if (!m_File.is_open())
+        return FALSE;
+
+    // 目标区间仍在缓冲区中时直接覆盖
+    if (iOffset >= m_Flushed && iOffset + iSize <= m_Flushed + m_Used)
+    {
+        memcpy(&m_Buffer[static_cast<size_t>(iOffset - m_Flushed)], iData, iSize);
+        return TRUE;
+    }
+
+    if (!Flush())
+        return FALSE;
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_WRITE);
+    m_File.seekp(static_cast<streamoff>(iOffset), ios::beg);
+    m_File.write(static_cast<const char*>(iData), static_cast<streamsize>(iSize));
+    m_File.seekp(0, ios::end);
+    if (!m_File)
+    {
+        m_Failed = TRUE;
+        return FALSE;
+    }
+    return TRUE;
+}
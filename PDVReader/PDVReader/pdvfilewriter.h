@@ -0,0 +1,100 @@
+/**
+ * @file pdvfilewriter.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：带大块缓冲的文件输出
+ * @details 数据先写入可复用的内存缓冲区，缓冲区满后以MB级的数据块整体写盘，避免逐字段格式化和频繁的系统调用
+ */
+
+#ifndef PDVFILEWRITER_H
+#define PDVFILEWRITER_H
+
+#include "DftBase.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+/** @brief 默认的缓冲区大小（4MB） */
+#define PDV_WRITER_DEFAULT_CHUNK_SIZE (4u << 20)
+
+/** @brief 带缓冲的二进制文件输出类，文件未打开时写入的数据被丢弃，Close返回FALSE */
+class CBufferedFileWriter
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] iChunkSize 缓冲区大小，缓冲区写满后整体写盘
+     */
+    explicit CBufferedFileWriter(size_t iChunkSize = PDV_WRITER_DEFAULT_CHUNK_SIZE);
+    /** 析构函数，未关闭的文件会自动写盘并关闭 */
+    ~CBufferedFileWriter();
+
+    /**
+     * @brief 以二进制方式创建文件
+     * @return DftBool 是否成功
+     * @param[in] iPath 文件路径
+     */
+    DftBool Open(const std::string& iPath);
+
+    /**
+     * @brief 写盘并关闭文件
+     * @return DftBool 所有数据是否都已成功写入
+     */
+    DftBool Close();
+
+    /** @brief 文件是否已打开 */
+    DftBool IsOpen() const { return m_File.is_open() ? TRUE : FALSE; }
+
+    /**
+     * @brief 追加数据
+     * @param[in] iData 数据首地址
+     * @param[in] iSize 数据字节数
+     */
+    void Write(const void* iData, size_t iSize);
+
+    /** @brief 追加字符串 */
+    void Write(const std::string& iText) { Write(iText.data(), iText.size()); }
+
+    /**
+     * @brief 追加iSize个0字节，按缓冲区大小分段填充
+     * @param[in] iSize 字节数
+     */
+    void WriteZeros(size_t iSize);
+
+    /**
+     * @brief 在缓冲区中预留一段连续空间，调用方直接填充，避免额外拷贝
+     * @return DftByte* 预留空间的首地址，在下一次写入操作之前有效
+     * @param[in] iSize 预留字节数，不能超过缓冲区大小
+     */
+    DftByte* Reserve(size_t iSize);
+
+    /**
+     * @brief 收回Reserve预留但未使用的尾部空间
+     * @param[in] iUnused 未使用的字节数
+     */
+    void Unreserve(size_t iUnused) { m_Used -= iUnused; }
+
+    /**
+     * @brief 覆盖文件中已写入的数据，用于回填文件头
+     * @return DftBool 是否成功
+     * @param[in] iOffset 文件偏移
+     * @param[in] iData 数据首地址
+     * @param[in] iSize 数据字节数
+     */
+    DftBool WriteAt(DftUInt64 iOffset, const void* iData, size_t iSize);
+
+    /** @brief 将缓冲区中的数据写盘 */
+    DftBool Flush();
+
+    /** @brief 已输出的总字节数（含缓冲区中未写盘的部分） */
+    DftUInt64 GetBytesWritten() const { return m_Flushed + m_Used; }
+
+private:
+    std::ofstream m_File;          ///< 输出文件
+    std::vector<DftByte> m_Buffer; ///< 可复用的输出缓冲区
+    size_t m_Used;                 ///< 缓冲区已使用的字节数
+    DftUInt64 m_Flushed;           ///< 已写盘的字节数
+    DftBool m_Failed;              ///< 是否发生过写入错误
+};
+
+#endif
@@ -0,0 +1,181 @@
+#include "pdvgeometrycache.h"
+#include "PDVIRenderGeometry.h"
+#include "pdvprofiler.h"
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+// 从场景数据中读取一份渲染几何
+bool LoadGeometry(IRenderGeometry* iGeometry, IRenderVertex* iVertex, CachedGeometry& oGeometry)
+{
+    {
+        PDV_PROFILE_SCOPE(PROFILE_PHASE_INDEX_FETCH);
+        if (iGeometry->GetIndexes(oGeometry._indexes) != PDV_RESULT_NO_ERROR)
+            return false;
+        oGeometry._sourceTriangles = oGeometry.GetTriangleCount();
+        PDV_PROFILE_COUNT(PROFILE_COUNTER_INDEXES, oGeometry._indexes.size());
+    }
+
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_VERTEX_FETCH);
+    CVertexView view;
+    if (!view.Attach(iVertex))
+        return false;
+    PDV_PROFILE_COUNT(PROFILE_COUNTER_VERTEXES, view.GetCount());
+
+    const StridedSpan<PDVVector3F>& positions = view.GetPositions();
+    oGeometry._positions.resize(positions.Size());
+    for (size_t i = 0; i < positions.Size(); i++)
+        oGeometry._positions[i] = positions[i];
+
+    const StridedSpan<PDVVector3F>& normals = view.GetNormals();
+    oGeometry._normals.resize(normals.Size());
+    for (size_t i = 0; i < normals.Size(); i++)
+        oGeometry._normals[i] = normals[i];
+    return true;
+}
+
+} // namespace
+
+CGeometryCache::CGeometryCache(size_t iBudget)
+    : m_Budget(iBudget)
+    , m_Usage(0)
+    , m_Hits(0)
+    , m_Misses(0)
+    , m_Evictions(0)
+{
+}
+
+CachedGeometryPtr CGeometryCache::Get(IRenderGeometry* iGeometry, IRenderVertex* iVertex, mutex* iSceneMutex,
+    const SimplifyTarget* iTarget)
+{
+    if (!iGeometry || !iVertex)
+        return CachedGeometryPtr();
+
+    SimplifyTarget target = iTarget ? *iTarget : SimplifyTarget();
+    DftUInt64 id = iGeometry->GetID();
+    {
+        lock_guard<mutex> lock(m_Mutex);
+        unordered_map<DftUInt64, EntryList::iterator>::iterator it = m_Lookup.find(id);
+        if (it != m_Lookup.end() && it->second->second->_target == target)
+        {
+            m_Hits++;
+            m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+            return it->second->second;
+        }
+        m_Misses++;
+    }
+
+    // 读取数据时不持有缓存锁，其他线程的命中不受影响
+    shared_ptr<CachedGeometry> geometry = make_shared<CachedGeometry>();
+    bool loaded;
+    if (iSceneMutex)
+    {
+        lock_guard<mutex> sceneLock(*iSceneMutex);
+        loaded = LoadGeometry(iGeometry, iVertex, *geometry);
+    }
+    else
+    {
+        loaded = LoadGeometry(iGeometry, iVertex, *geometry);
+    }
+    if (!loaded)
+        return CachedGeometryPtr();
+
+    if (target._triangles < geometry->GetTriangleCount())
+    {
+        PDV_PROFILE_SCOPE(PROFILE_PHASE_SIMPLIFY);
+        shared_ptr<CachedGeometry> simplified = make_shared<CachedGeometry>();
+        if (!SimplifyGeometry(*geometry, target, *simplified))
+            return CachedGeometryPtr();
+        geometry = simplified;
+    }
+    geometry->_target = target;
+
+    size_t size = geometry->GetMemorySize();
+    lock_guard<mutex> lock(m_Mutex);
+    unordered_map<DftUInt64, EntryList::iterator>::iterator it = m_Lookup.find(id);
+    if (it != m_Lookup.end())
+    {
+        if (it->second->second->_target == target)
+        {
+            // 其他线程已经放入了同一份数据
+            m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+            return it->second->second;
+        }
+        RemoveEntry(it);
+    }
+    if (size > m_Budget)
+        return geometry;
+
+    m_Entries.push_front(make_pair(id, CachedGeometryPtr(geometry)));
+    m_Lookup[id] = m_Entries.begin();
+    m_Usage += size;
+    EvictToBudget();
+    return geometry;
+}
+
+void CGeometryCache::EvictToBudget()
+{
+    while (m_Usage > m_Budget && !m_Entries.empty())
+    {
+        const pair<DftUInt64, CachedGeometryPtr>& last = m_Entries.back();
+        m_Usage -= last.second->GetMemorySize();
+        m_Lookup.erase(last.first);
+        m_Entries.pop_back();
+        m_Evictions++;
+    }
+}
+
+void CGeometryCache::RemoveEntry(unordered_map<DftUInt64, EntryList::iterator>::iterator iEntry)
+{
+    m_Usage -= iEntry->second->second->GetMemorySize();
+    m_Entries.erase(iEntry->second);
+    m_Lookup.erase(iEntry);
+}
+
+void CGeometryCache::Clear()
+{
+    lock_guard<mutex> lock(m_Mutex);
+    m_Entries.clear();
+    m_Lookup.clear();
+    m_Usage = 0;
+}
+
+void CGeometryCache::SetBudget(size_t iBudget)
+{
+    lock_guard<mutex> lock(m_Mutex);
+    m_Budget = iBudget;
+    EvictToBudget();
+}
+
+size_t CGeometryCache::GetBudget() const
+{
+    lock_guard<mutex> lock(m_Mutex);
+    return m_Budget;
+}
+
+size_t CGeometryCache::GetMemoryUsage() const
+{
+    lock_guard<mutex> lock(m_Mutex);
+    return m_Usage;
+}
+
+DftUInt64 CGeometryCache::GetHitCount() const
+{
+    lock_guard<mutex> lock(m_Mutex);
+    return m_Hits;
+}
+
+DftUInt64 CGeometryCache::GetMissCount() const
+{
+    lock_guard<mutex> lock(m_Mutex);
+    return m_Misses;
+}
+
+DftUInt64 CGeometryCache::GetEvictionCount() const
+{
+    lock_guard<mutex> lock(m_Mutex);
+    return m_Evictions;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file pdvgeometrycache.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：渲染几何数据缓存
+ * @details 以渲染几何ID为键缓存解码后的索引、顶点坐标与法向，按最近最少使用的顺序在内存上限内淘汰。
+ *          多个节点引用同一渲染几何（如重复出现的标准件）时，只在第一次出现时读取数据，之后每个实例只需做变换。
+ *          指定简化目标时缓存简化后的几何，同一渲染几何只保留最近一次使用的目标对应的结果。
+ */
+
+#ifndef PDVGEOMETRYCACHE_H
+#define PDVGEOMETRYCACHE_H
+
+#include "pdvsimplify.h"
+#include "pdvvertexview.h"
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+class IRenderGeometry;
+} // namespace pdv
+} // namespace kernel
+
+/** @brief 默认的缓存内存上限（256MB） */
+#define PDV_GEOMETRY_CACHE_DEFAULT_BUDGET (256u << 20)
+
+/** @brief 缓存中的一份渲染几何数据（局部坐标系） */
+struct CachedGeometry
+{
+    std::vector<DftUInt> _indexes;        ///< 三角形索引
+    std::vector<PDVVector3F> _positions;  ///< 顶点坐标
+    std::vector<PDVVector3F> _normals;    ///< 顶点法向，数据中不包含法向时为空
+    DftUInt _sourceTriangles;             ///< 简化前的三角面数
+    DftFloat _error;                      ///< 简化误差，未简化时为0
+    SimplifyTarget _target;               ///< 简化目标，未简化时为默认值
+
+    CachedGeometry() : _sourceTriangles(0), _error(0.0f) {}
+
+    /** 三角面数 */
+    DftUInt GetTriangleCount() const { return static_cast<DftUInt>(_indexes.size() / 3); }
+    /** 顶点坐标 */
+    StridedSpan<PDVVector3F> GetPositions() const
+    {
+        return StridedSpan<PDVVector3F>(_positions.empty() ? NULL : &_positions[0], sizeof(PDVVector3F), _positions.size());
+    }
+    /** 顶点法向 */
+    StridedSpan<PDVVector3F> GetNormals() const
+    {
+        return StridedSpan<PDVVector3F>(_normals.empty() ? NULL : &_normals[0], sizeof(PDVVector3F), _normals.size());
+    }
+    /** 占用的内存字节数 */
+    size_t GetMemorySize() const
+    {
+        return sizeof(CachedGeometry) + _indexes.capacity() * sizeof(DftUInt) +
+            (_positions.capacity() + _normals.capacity()) * sizeof(PDVVector3F);
+    }
+};
+
+/** @brief 缓存数据的共享指针，被淘汰的数据在最后一个使用者释放后才析构 */
+typedef std::shared_ptr<const CachedGeometry> CachedGeometryPtr;
+
+/** @brief 渲染几何数据的LRU缓存，可在多个线程中同时使用 */
+class CGeometryCache
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] iBudget 内存上限（字节），为0时不缓存
+     */
+    explicit CGeometryCache(size_t iBudget = PDV_GEOMETRY_CACHE_DEFAULT_BUDGET);
+
+    /**
+     * @brief 获取渲染几何数据，未命中时从场景数据中读取并放入缓存
+     * @return CachedGeometryPtr 几何数据，读取失败时为空
+     * @param[in] iGeometry 渲染几何
+     * @param[in] iVertex 渲染几何对应的顶点数据
+     * @param[in] iSceneMutex 读取场景数据时加的锁，为NULL时不加锁；简化在锁外进行，多个线程可同时简化不同的几何
+     * @param[in] iTarget 简化目标，为NULL时不简化；缓存中同一几何的目标不同时视为未命中并替换
+     */
+    CachedGeometryPtr Get(kernel::pdv::IRenderGeometry* iGeometry, kernel::pdv::IRenderVertex* iVertex,
+        std::mutex* iSceneMutex = NULL, const SimplifyTarget* iTarget = NULL);
+
+    /** @brief 清空缓存，统计计数保留 */
+    void Clear();
+
+    /** @brief 设置内存上限，超出部分立即淘汰 */
+    void SetBudget(size_t iBudget);
+    /** @brief 内存上限 */
+    size_t GetBudget() const;
+    /** @brief 当前占用的内存 */
+    size_t GetMemoryUsage() const;
+    /** @brief 命中次数 */
+    DftUInt64 GetHitCount() const;
+    /** @brief 未命中次数 */
+    DftUInt64 GetMissCount() const;
+    /** @brief 淘汰次数 */
+    DftUInt64 GetEvictionCount() const;
+
+private:
+    CGeometryCache(const CGeometryCache&);
+    CGeometryCache& operator=(const CGeometryCache&);
+
+    typedef std::list<std::pair<DftUInt64, CachedGeometryPtr> > EntryList;
+
+    void EvictToBudget();
+    void RemoveEntry(std::unordered_map<DftUInt64, EntryList::iterator>::iterator iEntry);
+
+    mutable std::mutex m_Mutex;                                   ///< 缓存锁
+    EntryList m_Entries;                                          ///< 按最近使用排序，表头最新
+    std::unordered_map<DftUInt64, EntryList::iterator> m_Lookup;  ///< 渲染几何ID到缓存项的索引
+    size_t m_Budget;                                              ///< 内存上限
+    size_t m_Usage;                                               ///< 当前占用的内存
+    DftUInt64 m_Hits;                                             ///< 命中次数
+    DftUInt64 m_Misses;                                           ///< 未命中次数
+    DftUInt64 m_Evictions;                                        ///< 淘汰次数
+};
+
+#endif
@@ -0,0 +1,765 @@
+#include "pdvgltfwriter.h"
+#include "pdvfilewriter.h"
+#include "pdvgeometrycache.h"
+#include "pdvlod.h"
+#include "pdvmeshwriter.h"
+#include "pdvprofiler.h"
+#include "pdvsceneindex.h"
+#include "pdvtextformat.h"
+#include "PDVISceneData.h"
+#include "PDVIRenderMesh.h"
+#include "PDVIRenderGeometry.h"
+#include "PDVIRenderVertex.h"
+#include "PDVIInstancedMesh.h"
+#include "PDVIBatchedMesh.h"
+#include <cctype>
+#include <cmath>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+const DftUInt GLTF_ARRAY_BUFFER = 34962;
+const DftUInt GLTF_ELEMENT_ARRAY_BUFFER = 34963;
+const DftUInt GLTF_UNSIGNED_INT = 5125;
+const DftUInt GLTF_FLOAT = 5126;
+const int GLTF_NONE = -1;
+
+/** 一个渲染几何及引用它的实例 */
+struct GlbGeometry
+{
+    IRenderGeometry* _geometry;     ///< 渲染几何
+    IRenderVertex* _vertex;         ///< 顶点数据
+    string _name;                   ///< 第一个实例所在节点的名称
+    vector<PDVMatrix4F> _instances; ///< 实例的世界变换，合批几何没有实例
+
+    // 第一遍读取后确定的数据布局
+    bool _loaded;                   ///< 是否读取成功
+    DftUInt _vertexCount;           ///< 顶点数
+    DftUInt _indexCount;            ///< 索引数
+    bool _hasNormals;               ///< 是否带法向
+    DftFloat _min[3];               ///< 坐标最小值
+    DftFloat _max[3];               ///< 坐标最大值
+    DftUInt64 _offset;              ///< 在二进制数据块中的起始位置，依次为坐标、法向、索引
+    int _positionAccessor;          ///< 坐标访问器
+    int _normalAccessor;            ///< 法向访问器
+    int _indexView;                 ///< 索引缓冲视图
+
+    GlbGeometry()
+        : _geometry(NULL), _vertex(NULL), _loaded(false), _vertexCount(0), _indexCount(0), _hasNormals(false), _offset(0)
+        , _positionAccessor(GLTF_NONE), _normalAccessor(GLTF_NONE), _indexView(GLTF_NONE)
+    {
+        for (int i = 0; i < 3; i++)
+            _min[i] = _max[i] = 0.0f;
+    }
+
+    DftUInt64 GetPositionSize() const { return static_cast<DftUInt64>(_vertexCount) * 12; }
+    DftUInt64 GetNormalSize() const { return _hasNormals ? static_cast<DftUInt64>(_vertexCount) * 12 : 0; }
+    DftUInt64 GetIndexSize() const { return static_cast<DftUInt64>(_indexCount) * 4; }
+    DftUInt64 GetDataSize() const { return GetPositionSize() + GetNormalSize() + GetIndexSize(); }
+    /** 是否输出为带网格的节点；实例数据的填充与节点的输出都按此判断，保证实例访问器的偏移一致 */
+    bool HasMeshNode() const { return _loaded && !_instances.empty() && _indexCount > 0; }
+};
+
+/** 合批几何中的一段索引 */
+struct GlbRange
+{
+    size_t _geometry; ///< 合批几何
+    DftUInt _first;   ///< 起始索引
+    DftUInt _count;   ///< 索引个数
+};
+
+/** 合批网格中属于同一节点的索引区间 */
+struct GlbBatchedNode
+{
+    string _name;             ///< 节点名称
+    vector<GlbRange> _ranges; ///< 索引区间
+};
+
+/** 场景中的全部几何、实例和合批区间 */
+class CGlbScene
+{
+public:
+    size_t AddGeometry(IRenderGeometry* iGeometry, IRenderVertex* iVertex, const string& iName)
+    {
+        unordered_map<DftUInt64, size_t>::iterator it = m_Lookup.find(iGeometry->GetID());
+        if (it != m_Lookup.end())
+            return it->second;
+        m_Geometries.push_back(GlbGeometry());
+        m_Geometries.back()._geometry = iGeometry;
+        m_Geometries.back()._vertex = iVertex;
+        m_Geometries.back()._name = iName;
+        m_Lookup[iGeometry->GetID()] = m_Geometries.size() - 1;
+        return m_Geometries.size() - 1;
+    }
+
+    void AddInstance(IRenderGeometry* iGeometry, IRenderVertex* iVertex, const string& iName, const PDVMatrix4F& iWorldTrans)
+    {
+        m_Geometries[AddGeometry(iGeometry, iVertex, iName)]._instances.push_back(iWorldTrans);
+    }
+
+    GlbBatchedNode& GetBatchedNode(DftUInt64 iNodeID, const string& iName)
+    {
+        unordered_map<DftUInt64, size_t>::iterator it = m_BatchedLookup.find(iNodeID);
+        if (it != m_BatchedLookup.end())
+            return m_BatchedNodes[it->second];
+        m_BatchedLookup[iNodeID] = m_BatchedNodes.size();
+        m_BatchedNodes.push_back(GlbBatchedNode());
+        m_BatchedNodes.back()._name = iName;
+        return m_BatchedNodes.back();
+    }
+
+    vector<GlbGeometry>& GetGeometries() { return m_Geometries; }
+    vector<GlbBatchedNode>& GetBatchedNodes() { return m_BatchedNodes; }
+
+private:
+    vector<GlbGeometry> m_Geometries;
+    unordered_map<DftUInt64, size_t> m_Lookup;
+    vector<GlbBatchedNode> m_BatchedNodes;
+    unordered_map<DftUInt64, size_t> m_BatchedLookup;
+};
+
+string JsonUInt(DftUInt64 iValue)
+{
+    char buffer[PDV_TEXT_SHORT_NUMBER_MAX_SIZE];
+    return string(buffer, FormatUInt(buffer, iValue));
+}
+
+// 9位有效数字可以无损还原float
+string JsonFloat(DftDouble iValue)
+{
+    if (!std::isfinite(iValue))
+        return "0";
+    char buffer[PDV_TEXT_SHORT_NUMBER_MAX_SIZE];
+    return string(buffer, FormatGeneral(buffer, iValue, 9));
+}
+
+string JsonString(const string& iText)
+{
+    string text = "\"";
+    for (size_t i = 0; i < iText.size(); i++)
+    {
+        unsigned char c = static_cast<unsigned char>(iText[i]);
+        if (c == '"' || c == '\\')
+        {
+            text += '\\';
+            text += static_cast<char>(c);
+        }
+        else if (c < 0x20)
+        {
+            static const char digits[] = "0123456789abcdef";
+            text += "\\u00";
+            text += digits[c >> 4];
+            text += digits[c & 0xF];
+        }
+        else
+        {
+            text += static_cast<char>(c);
+        }
+    }
+    text += '"';
+    return text;
+}
+
+string JsonArray(const vector<string>& iItems)
+{
+    string text = "[";
+    for (size_t i = 0; i < iItems.size(); i++)
+    {
+        if (i)
+            text += ',';
+        text += iItems[i];
+    }
+    text += ']';
+    return text;
+}
+
+bool IsIdentity(const PDVMatrix4F& iMatrix)
+{
+    for (int r = 0; r < 4; r++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            if (iMatrix._data[r][c] != (r == c ? 1.0f : 0.0f))
+                return false;
+        }
+    }
+    return true;
+}
+
+// 行向量约定的矩阵按行展开，正好是glTF列向量约定下按列主序存放的矩阵
+string JsonMatrix(const PDVMatrix4F& iMatrix)
+{
+    vector<string> values;
+    for (int r = 0; r < 4; r++)
+    {
+        for (int c = 0; c < 4; c++)
+            values.push_back(JsonFloat(iMatrix._data[r][c]));
+    }
+    return JsonArray(values);
+}
+
+// 按行向量约定分解为平移、旋转（四元数x、y、z、w）、缩放，行列式为负时翻转x轴缩放
+void DecomposeMatrix(const PDVMatrix4F& iMatrix, DftFloat oTranslation[3], DftFloat oRotation[4], DftFloat oScale[3])
+{
+    const DftFloat (*m)[4] = iMatrix._data;
+    for (int i = 0; i < 3; i++)
+    {
+        oTranslation[i] = m[3][i];
+        oScale[i] = std::sqrt(m[i][0] * m[i][0] + m[i][1] * m[i][1] + m[i][2] * m[i][2]);
+    }
+    DftFloat det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1])
+        - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0])
+        + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+    if (det < 0.0f)
+        oScale[0] = -oScale[0];
+
+    // r[i][j]为去掉缩放后的旋转矩阵（行向量约定），glTF列向量约定下的元素(row, col)为r[col][row]
+    DftFloat r[3][3];
+    for (int i = 0; i < 3; i++)
+    {
+        for (int j = 0; j < 3; j++)
+            r[i][j] = oScale[i] != 0.0f ? m[i][j] / oScale[i] : (i == j ? 1.0f : 0.0f);
+    }
+    DftFloat a00 = r[0][0], a01 = r[1][0], a02 = r[2][0];
+    DftFloat a10 = r[0][1], a11 = r[1][1], a12 = r[2][1];
+    DftFloat a20 = r[0][2], a21 = r[1][2], a22 = r[2][2];
+
+    DftFloat trace = a00 + a11 + a22;
+    DftFloat x, y, z, w;
+    if (trace > 0.0f)
+    {
+        DftFloat s = std::sqrt(trace + 1.0f) * 2.0f;
+        w = 0.25f * s;
+        x = (a21 - a12) / s;
+        y = (a02 - a20) / s;
+        z = (a10 - a01) / s;
+    }
+    else if (a00 > a11 && a00 > a22)
+    {
+        DftFloat s = std::sqrt(1.0f + a00 - a11 - a22) * 2.0f;
+        w = (a21 - a12) / s;
+        x = 0.25f * s;
+        y = (a01 + a10) / s;
+        z = (a02 + a20) / s;
+    }
+    else if (a11 > a22)
+    {
+        DftFloat s = std::sqrt(1.0f + a11 - a00 - a22) * 2.0f;
+        w = (a02 - a20) / s;
+        x = (a01 + a10) / s;
+        y = 0.25f * s;
+        z = (a12 + a21) / s;
+    }
+    else
+    {
+        DftFloat s = std::sqrt(1.0f + a22 - a00 - a11) * 2.0f;
+        w = (a10 - a01) / s;
+        x = (a02 + a20) / s;
+        y = (a12 + a21) / s;
+        z = 0.25f * s;
+    }
+    DftFloat length = std::sqrt(x * x + y * y + z * z + w * w);
+    if (length <= 0.0f)
+    {
+        x = y = z = 0.0f;
+        w = length = 1.0f;
+    }
+    oRotation[0] = x / length;
+    oRotation[1] = y / length;
+    oRotation[2] = z / length;
+    oRotation[3] = w / length;
+}
+
+// 行向量约定：先做实例矩阵，再做节点世界变换
+PDVMatrix4F Multiply(const PDVMatrix4F& iLeft, const PDVMatrix4F& iRight)
+{
+    PDVMatrix4F result;
+    for (int r = 0; r < 4; r++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            DftFloat sum = 0.0f;
+            for (int k = 0; k < 4; k++)
+                sum += iLeft._data[r][k] * iRight._data[k][c];
+            result._data[r][c] = sum;
+        }
+    }
+    return result;
+}
+
+// 按场景收集几何、实例和合批区间
+void CollectGlbScene(ISceneData* iSceneData, const LodSelectOptions* iLod, CGlbScene& oScene)
+{
+    CSceneIndex sceneIndex(iSceneData);
+    vector<MeshItem> items;
+    MeshLayout layout;
+    CollectMeshItems(sceneIndex, items, layout, iLod);
+
+    // 节点世界变换和名称，供实例化、合批信息按节点ID查找
+    unordered_map<DftUInt64, size_t> nodeItems;
+    for (size_t i = 0; i < items.size(); i++)
+        nodeItems.insert(make_pair(items[i]._nodeID, i));
+
+    // 普通网格按渲染几何合并实例，属于实例化或合批网格的在下面单独处理
+    for (size_t i = 0; i < items.size(); i++)
+    {
+        const MeshItem& item = items[i];
+        if (item._renderMesh->GetInstancedMeshID() != DFT_INVALID_ID || item._renderMesh->GetBatchedMeshID() != DFT_INVALID_ID)
+            continue;
+        oScene.AddInstance(item._geometry, item._vertex, layout._groupNames[item._group], item._worldTrans);
+    }
+
+    vector<IInstancedMesh*> instancedMeshes;
+    iSceneData->GetInstancedMeshArray(instancedMeshes);
+    for (size_t m = 0; m < instancedMeshes.size(); m++)
+    {
+        InstancedRenderMeshInfoArray infos;
+        if (!instancedMeshes[m] || instancedMeshes[m]->GetInstancedRenderMeshInfoArray(infos) != PDV_RESULT_NO_ERROR)
+            continue;
+        for (size_t i = 0; i < infos.size(); i++)
+        {
+            IRenderMesh* renderMesh = sceneIndex.FindRenderMesh(infos[i]._renderMeshID);
+            if (!renderMesh || renderMesh->GetType() != RENDER_MESH_TYPE_MAIN)
+                continue;
+            IRenderGeometry* geometry = SelectMeshGeometry(sceneIndex, renderMesh, iLod);
+            IRenderVertex* vertex = geometry ? sceneIndex.FindRenderVertex(geometry->GetVertexID()) : NULL;
+            if (!vertex)
+                continue;
+
+            // 实例矩阵把共享几何放到该渲染网格的位置，再经节点世界变换
+            unordered_map<DftUInt64, size_t>::const_iterator it = nodeItems.find(infos[i]._treeNodeID);
+            if (it == nodeItems.end())
+            {
+                oScene.AddInstance(geometry, vertex, "Node_" + to_string(infos[i]._treeNodeID), infos[i]._instancedMatrix);
+            }
+            else
+            {
+                const MeshItem& item = items[it->second];
+                oScene.AddInstance(geometry, vertex, layout._groupNames[item._group],
+                    Multiply(infos[i]._instancedMatrix, item._worldTrans));
+            }
+        }
+    }
+
+    // 合批几何的顶点已经位于场景坐标系中，各节点以索引区间引用
+    vector<IBatchedMesh*> batchedMeshes;
+    iSceneData->GetBatchedMeshArray(batchedMeshes);
+    for (size_t m = 0; m < batchedMeshes.size(); m++)
+    {
+        BatchedRenderMeshInfoArray infos;
+        if (!batchedMeshes[m] || batchedMeshes[m]->GetBatchedRenderMeshInfoArray(infos) != PDV_RESULT_NO_ERROR)
+            continue;
+        for (size_t i = 0; i < infos.size(); i++)
+        {
+            unordered_map<DftUInt64, size_t>::const_iterator it = nodeItems.find(infos[i]._treeNodeID);
+            string name = it != nodeItems.end() ? layout._groupNames[items[it->second]._group] : "Node_" + to_string(infos[i]._treeNodeID);
+            const RenderGeometryRangeInfoArray& ranges = infos[i]._renderGeometryRangeInfos;
+            for (size_t r = 0; r < ranges.size(); r++)
+            {
+                IRenderGeometry* geometry = sceneIndex.FindRenderGeometry(ranges[r]._renderGeometryID);
+                IRenderVertex* vertex = geometry ? sceneIndex.FindRenderVertex(geometry->GetVertexID()) : NULL;
+                if (!vertex || ranges[r]._indexMax < ranges[r]._indexMin)
+                    continue;
+
+                // 区间是否包含_indexMax没有约定，取使索引个数为3的倍数的一种
+                GlbRange range;
+                range._geometry = oScene.AddGeometry(geometry, vertex, name);
+                range._first = ranges[r]._indexMin;
+                range._count = ranges[r]._indexMax - ranges[r]._indexMin;
+                if ((range._count + 1) % 3 == 0)
+                    range._count++;
+                range._count -= range._count % 3;
+                if (range._count > 0)
+                    oScene.GetBatchedNode(infos[i]._treeNodeID, name)._ranges.push_back(range);
+            }
+        }
+    }
+}
+
+} // namespace
+
+bool IsGlbPath(const string& iPath)
+{
+    size_t dot = iPath.find_last_of('.');
+    if (dot == string::npos || iPath.size() - dot != 4)
+        return false;
+    for (size_t i = 1; i < 4; i++)
+    {
+        if (tolower(static_cast<unsigned char>(iPath[dot + i])) != "glb"[i - 1])
+            return false;
+    }
+    return true;
+}
+
+DftBool ExportSceneGlb(ISceneData* iSceneData, const string& iPath, CGeometryCache* ioCache, GlbStatistics* oStatistics,
+    const LodSelectOptions* iLod)
+{
+    if (!iSceneData)
+        return FALSE;
+
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_SERIALIZE);
+    CGlbScene scene;
+    CollectGlbScene(iSceneData, iLod, scene);
+    vector<GlbGeometry>& geometries = scene.GetGeometries();
+    vector<GlbBatchedNode>& batchedNodes = scene.GetBatchedNodes();
+
+    CGeometryCache localCache;
+    CGeometryCache& cache = ioCache ? *ioCache : localCache;
+
+    // 第一遍：读取几何，确定数据布局和包围盒
+    DftUInt64 binSize = 0;
+    for (size_t g = 0; g < geometries.size(); g++)
+    {
+        GlbGeometry& geometry = geometries[g];
+        CachedGeometryPtr data = cache.Get(geometry._geometry, geometry._vertex);
+        if (!data || data->_positions.empty())
+            continue;
+        geometry._loaded = true;
+        geometry._vertexCount = static_cast<DftUInt>(data->_positions.size());
+        geometry._indexCount = static_cast<DftUInt>(data->_indexes.size());
+        geometry._hasNormals = data->_normals.size() == data->_positions.size();
+        for (int i = 0; i < 3; i++)
+            geometry._min[i] = geometry._max[i] = data->_positions[0]._data[i];
+        for (size_t v = 1; v < data->_positions.size(); v++)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                DftFloat value = data->_positions[v]._data[i];
+                geometry._min[i] = value < geometry._min[i] ? value : geometry._min[i];
+                geometry._max[i] = value > geometry._max[i] ? value : geometry._max[i];
+            }
+        }
+        geometry._offset = binSize;
+        binSize += geometry.GetDataSize();
+    }
+
+    // 多实例的平移、旋转、缩放，依次存放在几何数据之后
+    vector<DftFloat> instanceData;
+    for (size_t g = 0; g < geometries.size(); g++)
+    {
+        const GlbGeometry& geometry = geometries[g];
+        if (!geometry.HasMeshNode() || geometry._instances.size() < 2)
+            continue;
+        size_t count = geometry._instances.size();
+        size_t base = instanceData.size();
+        instanceData.resize(base + count * 10);
+        for (size_t i = 0; i < count; i++)
+        {
+            DecomposeMatrix(geometry._instances[i], &instanceData[base + i * 3], &instanceData[base + count * 3 + i * 4],
+                &instanceData[base + count * 7 + i * 3]);
+        }
+    }
+    DftUInt64 instanceOffset = binSize;
+    binSize += instanceData.size() * sizeof(DftFloat);
+
+    // JSON
+    vector<string> bufferViews, accessors, meshes, nodes, sceneNodes;
+    GlbStatistics statistics;
+    int instanceView = GLTF_NONE;
+    if (!instanceData.empty())
+    {
+        instanceView = static_cast<int>(bufferViews.size());
+        bufferViews.push_back("{\"buffer\":0,\"byteOffset\":" + JsonUInt(instanceOffset) +
+            ",\"byteLength\":" + JsonUInt(instanceData.size() * sizeof(DftFloat)) + "}");
+    }
+    for (size_t g = 0; g < geometries.size(); g++)
+    {
+        GlbGeometry& geometry = geometries[g];
+        if (!geometry._loaded)
+            continue;
+        statistics._geometryCount++;
+
+        DftUInt64 offset = geometry._offset;
+        geometry._positionAccessor = static_cast<int>(accessors.size());
+        accessors.push_back("{\"bufferView\":" + JsonUInt(bufferViews.size()) + ",\"componentType\":" + JsonUInt(GLTF_FLOAT) +
+            ",\"count\":" + JsonUInt(geometry._vertexCount) + ",\"type\":\"VEC3\",\"min\":[" + JsonFloat(geometry._min[0]) + "," +
+            JsonFloat(geometry._min[1]) + "," + JsonFloat(geometry._min[2]) + "],\"max\":[" + JsonFloat(geometry._max[0]) + "," +
+            JsonFloat(geometry._max[1]) + "," + JsonFloat(geometry._max[2]) + "]}");
+        bufferViews.push_back("{\"buffer\":0,\"byteOffset\":" + JsonUInt(offset) + ",\"byteLength\":" +
+            JsonUInt(geometry.GetPositionSize()) + ",\"target\":" + JsonUInt(GLTF_ARRAY_BUFFER) + "}");
+        offset += geometry.GetPositionSize();
+
+        if (geometry._hasNormals)
+        {
+            geometry._normalAccessor = static_cast<int>(accessors.size());
+            accessors.push_back("{\"bufferView\":" + JsonUInt(bufferViews.size()) + ",\"componentType\":" + JsonUInt(GLTF_FLOAT) +
+                ",\"count\":" + JsonUInt(geometry._vertexCount) + ",\"type\":\"VEC3\"}");
+            bufferViews.push_back("{\"buffer\":0,\"byteOffset\":" + JsonUInt(offset) + ",\"byteLength\":" +
+                JsonUInt(geometry.GetNormalSize()) + ",\"target\":" + JsonUInt(GLTF_ARRAY_BUFFER) + "}");
+            offset += geometry.GetNormalSize();
+        }
+
+        if (geometry._indexCount > 0)
+        {
+            geometry._indexView = static_cast<int>(bufferViews.size());
+            bufferViews.push_back("{\"buffer\":0,\"byteOffset\":" + JsonUInt(offset) + ",\"byteLength\":" +
+                JsonUInt(geometry.GetIndexSize()) + ",\"target\":" + JsonUInt(GLTF_ELEMENT_ARRAY_BUFFER) + "}");
+        }
+    }
+
+    // 整个几何作为一个图元
+    size_t instanceFloat = 0;
+    for (size_t g = 0; g < geometries.size(); g++)
+    {
+        const GlbGeometry& geometry = geometries[g];
+        if (!geometry.HasMeshNode())
+            continue;
+
+        string attributes = "{\"POSITION\":" + JsonUInt(geometry._positionAccessor);
+        if (geometry._normalAccessor != GLTF_NONE)
+            attributes += ",\"NORMAL\":" + JsonUInt(geometry._normalAccessor);
+        attributes += "}";
+        string indexAccessor = JsonUInt(accessors.size());
+        accessors.push_back("{\"bufferView\":" + JsonUInt(geometry._indexView) + ",\"componentType\":" +
+            JsonUInt(GLTF_UNSIGNED_INT) + ",\"count\":" + JsonUInt(geometry._indexCount) + ",\"type\":\"SCALAR\"}");
+        string mesh = JsonUInt(meshes.size());
+        meshes.push_back("{\"primitives\":[{\"attributes\":" + attributes + ",\"indices\":" + indexAccessor + ",\"mode\":4}]}");
+
+        size_t count = geometry._instances.size();
+        statistics._instanceCount += count;
+        string node = "{\"name\":" + JsonString(geometry._name) + ",\"mesh\":" + mesh;
+        if (count == 1)
+        {
+            if (!IsIdentity(geometry._instances[0]))
+                node += ",\"matrix\":" + JsonMatrix(geometry._instances[0]);
+        }
+        else
+        {
+            // 平移、旋转、缩放在实例数据中按块连续存放
+            const char* names[3] = { "TRANSLATION", "ROTATION", "SCALE" };
+            const char* types[3] = { "VEC3", "VEC4", "VEC3" };
+            const size_t widths[3] = { 3, 4, 3 };
+            string instancing;
+            for (int a = 0; a < 3; a++)
+            {
+                if (a)
+                    instancing += ",";
+                instancing += string("\"") + names[a] + "\":" + JsonUInt(accessors.size());
+                accessors.push_back("{\"bufferView\":" + JsonUInt(instanceView) + ",\"byteOffset\":" +
+                    JsonUInt(instanceFloat * sizeof(DftFloat)) + ",\"componentType\":" + JsonUInt(GLTF_FLOAT) +
+                    ",\"count\":" + JsonUInt(count) + ",\"type\":\"" + types[a] + "\"}");
+                instanceFloat += count * widths[a];
+            }
+            node += ",\"extensions\":{\"EXT_mesh_gpu_instancing\":{\"attributes\":{" + instancing + "}}}";
+        }
+        node += "}";
+        sceneNodes.push_back(JsonUInt(nodes.size()));
+        nodes.push_back(node);
+    }
+
+    // 合批几何的每个节点引用索引缓冲中的一段
+    for (size_t b = 0; b < batchedNodes.size(); b++)
+    {
+        vector<string> primitives;
+        for (size_t r = 0; r < batchedNodes[b]._ranges.size(); r++)
+        {
+            const GlbRange& range = batchedNodes[b]._ranges[r];
+            const GlbGeometry& geometry = geometries[range._geometry];
+            if (!geometry._loaded || geometry._indexView == GLTF_NONE ||
+                static_cast<DftUInt64>(range._first) + range._count > geometry._indexCount)
+                continue;
+            string attributes = "{\"POSITION\":" + JsonUInt(geometry._positionAccessor);
+            if (geometry._normalAccessor != GLTF_NONE)
+                attributes += ",\"NORMAL\":" + JsonUInt(geometry._normalAccessor);
+            attributes += "}";
+            string indexAccessor = JsonUInt(accessors.size());
+            accessors.push_back("{\"bufferView\":" + JsonUInt(geometry._indexView) + ",\"byteOffset\":" +
+                JsonUInt(static_cast<DftUInt64>(range._first) * 4) + ",\"componentType\":" + JsonUInt(GLTF_UNSIGNED_INT) +
+                ",\"count\":" + JsonUInt(range._count) + ",\"type\":\"SCALAR\"}");
+            primitives.push_back("{\"attributes\":" + attributes + ",\"indices\":" + indexAccessor + ",\"mode\":4}");
+            statistics._batchedRanges++;
+        }
+        if (primitives.empty())
+            continue;
+        string mesh = JsonUInt(meshes.size());
+        meshes.push_back("{\"primitives\":" + JsonArray(primitives) + "}");
+        sceneNodes.push_back(JsonUInt(nodes.size()));
+        nodes.push_back("{\"name\":" + JsonString(batchedNodes[b]._name) + ",\"mesh\":" + mesh + "}");
+    }
+
+    string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"PDVReader\"}";
+    if (instanceView != GLTF_NONE)
+        json += ",\"extensionsUsed\":[\"EXT_mesh_gpu_instancing\"]";
+    json += ",\"scene\":0,\"scenes\":[{\"nodes\":" + JsonArray(sceneNodes) + "}]";
+    if (!nodes.empty())
+        json += ",\"nodes\":" + JsonArray(nodes) + ",\"meshes\":" + JsonArray(meshes) + ",\"accessors\":" + JsonArray(accessors) +
+            ",\"bufferViews\":" + JsonArray(bufferViews);
+    if (binSize > 0)
+        json += ",\"buffers\":[{\"byteLength\":" + JsonUInt(binSize) + "}]";
+    json += "}";
+
+    // GLB：12字节文件头，JSON块以空格补齐到4字节，二进制块以0补齐（几何数据本身是4字节对齐的）
+    json.resize((json.size() + 3) & ~static_cast<size_t>(3), ' ');
+    DftUInt64 totalSize = 12 + 8 + json.size() + (binSize > 0 ? 8 + binSize : 0);
+    if (totalSize > 0xFFFFFFFFull)
+        return FALSE;
+
+    CBufferedFileWriter writer;
+    if (!writer.Open(iPath))
+        return FALSE;
+    DftUInt32 header[3] = { GLB_MAGIC, 2, static_cast<DftUInt32>(totalSize) };
+    writer.Write(header, sizeof(header));
+    DftUInt32 jsonChunk[2] = { static_cast<DftUInt32>(json.size()), GLB_CHUNK_JSON };
+    writer.Write(jsonChunk, sizeof(jsonChunk));
+    writer.Write(json);
+
+    // 第二遍：按第一遍的布局写出几何数据，读取失败时以0填充保持布局不变
+    if (binSize > 0)
+    {
+        DftUInt32 binChunk[2] = { static_cast<DftUInt32>(binSize), GLB_CHUNK_BIN };
+        writer.Write(binChunk, sizeof(binChunk));
+        for (size_t g = 0; g < geometries.size(); g++)
+        {
+            const GlbGeometry& geometry = geometries[g];
+            if (!geometry._loaded)
+                continue;
+            CachedGeometryPtr data = cache.Get(geometry._geometry, geometry._vertex);
+            bool valid = data && data->_positions.size() == geometry._vertexCount && data->_indexes.size() == geometry._indexCount;
+            // 按缓冲区分段写出，大几何体不会撑大共用的输出缓冲区
+            if (valid)
+                writer.Write(&data->_positions[0], static_cast<size_t>(geometry.GetPositionSize()));
+            else
+                writer.WriteZeros(static_cast<size_t>(geometry.GetPositionSize()));
+            if (geometry._hasNormals)
+            {
+                if (valid && data->_normals.size() == geometry._vertexCount)
+                    writer.Write(&data->_normals[0], static_cast<size_t>(geometry.GetNormalSize()));
+                else
+                    writer.WriteZeros(static_cast<size_t>(geometry.GetNormalSize()));
+            }
+            if (geometry._indexCount > 0)
+            {
+                if (valid)
+                    writer.Write(&data->_indexes[0], static_cast<size_t>(geometry.GetIndexSize()));
+                else
+                    writer.WriteZeros(static_cast<size_t>(geometry.GetIndexSize()));
+            }
+        }
+        if (!instanceData.empty())
+            writer.Write(&instanceData[0], instanceData.size() * sizeof(DftFloat));
+    }
+
+    statistics._bytes = writer.GetBytesWritten();
+    if (oStatistics)
+        *oStatistics = statistics;
+    return writer.Close();
+}
+
+DftBool WriteGlbMeshes(const vector<GlbMesh>& iMeshes, const DftDouble* iRootMatrix, const string& iPath, DftUInt64* oBytes)
+{
+    // 每个网格依次存放坐标、法向、索引，都是4字节对齐的
+    vector<string> bufferViews, accessors, meshes, nodes, children;
+    DftUInt64 binSize = 0;
+    nodes.push_back(string());
+    for (size_t m = 0; m < iMeshes.size(); m++)
+    {
+        const GlbMesh& mesh = iMeshes[m];
+        DftUInt64 vertexCount = mesh._positions.size() / 3;
+        if (vertexCount == 0 || mesh._indexes.empty())
+            continue;
+        DftFloat minValue[3], maxValue[3];
+        for (int i = 0; i < 3; i++)
+            minValue[i] = maxValue[i] = mesh._positions[i];
+        for (size_t v = 3; v < vertexCount * 3; v += 3)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                DftFloat value = mesh._positions[v + i];
+                minValue[i] = value < minValue[i] ? value : minValue[i];
+                maxValue[i] = value > maxValue[i] ? value : maxValue[i];
+            }
+        }
+
+        string attributes = "{\"POSITION\":" + JsonUInt(accessors.size());
+        accessors.push_back("{\"bufferView\":" + JsonUInt(bufferViews.size()) + ",\"componentType\":" + JsonUInt(GLTF_FLOAT) +
+            ",\"count\":" + JsonUInt(vertexCount) + ",\"type\":\"VEC3\",\"min\":[" + JsonFloat(minValue[0]) + "," +
+            JsonFloat(minValue[1]) + "," + JsonFloat(minValue[2]) + "],\"max\":[" + JsonFloat(maxValue[0]) + "," +
+            JsonFloat(maxValue[1]) + "," + JsonFloat(maxValue[2]) + "]}");
+        bufferViews.push_back("{\"buffer\":0,\"byteOffset\":" + JsonUInt(binSize) + ",\"byteLength\":" +
+            JsonUInt(vertexCount * 12) + ",\"target\":" + JsonUInt(GLTF_ARRAY_BUFFER) + "}");
+        binSize += vertexCount * 12;
+        if (mesh._normals.size() == mesh._positions.size())
+        {
+            attributes += ",\"NORMAL\":" + JsonUInt(accessors.size());
+            accessors.push_back("{\"bufferView\":" + JsonUInt(bufferViews.size()) + ",\"componentType\":" + JsonUInt(GLTF_FLOAT) +
+                ",\"count\":" + JsonUInt(vertexCount) + ",\"type\":\"VEC3\"}");
+            bufferViews.push_back("{\"buffer\":0,\"byteOffset\":" + JsonUInt(binSize) + ",\"byteLength\":" +
+                JsonUInt(vertexCount * 12) + ",\"target\":" + JsonUInt(GLTF_ARRAY_BUFFER) + "}");
+            binSize += vertexCount * 12;
+        }
+        attributes += "}";
+
+        string indexAccessor = JsonUInt(accessors.size());
+        accessors.push_back("{\"bufferView\":" + JsonUInt(bufferViews.size()) + ",\"componentType\":" +
+            JsonUInt(GLTF_UNSIGNED_INT) + ",\"count\":" + JsonUInt(mesh._indexes.size()) + ",\"type\":\"SCALAR\"}");
+        bufferViews.push_back("{\"buffer\":0,\"byteOffset\":" + JsonUInt(binSize) + ",\"byteLength\":" +
+            JsonUInt(mesh._indexes.size() * 4) + ",\"target\":" + JsonUInt(GLTF_ELEMENT_ARRAY_BUFFER) + "}");
+        binSize += mesh._indexes.size() * 4;
+
+        string meshIndex = JsonUInt(meshes.size());
+        meshes.push_back("{\"primitives\":[{\"attributes\":" + attributes + ",\"indices\":" + indexAccessor + ",\"mode\":4}]}");
+        children.push_back(JsonUInt(nodes.size()));
+        nodes.push_back("{\"name\":" + JsonString(mesh._name) + ",\"mesh\":" + meshIndex + "}");
+    }
+
+    // 根节点矩阵的平移部分可能很大，按17位有效数字输出
+    string root = "{\"name\":\"root\"";
+    if (iRootMatrix)
+    {
+        vector<string> values;
+        for (int i = 0; i < 16; i++)
+        {
+            char buffer[PDV_TEXT_SHORT_NUMBER_MAX_SIZE];
+            values.push_back(std::isfinite(iRootMatrix[i]) ? string(buffer, FormatGeneral(buffer, iRootMatrix[i], 17)) : "0");
+        }
+        root += ",\"matrix\":" + JsonArray(values);
+    }
+    if (!children.empty())
+        root += ",\"children\":" + JsonArray(children);
+    nodes[0] = root + "}";
+
+    string json = "{\"asset\":{\"version\":\"2.0\",\"generator\":\"PDVReader\"},\"scene\":0,\"scenes\":[{\"nodes\":[0]}],\"nodes\":" +
+        JsonArray(nodes);
+    if (!meshes.empty())
+        json += ",\"meshes\":" + JsonArray(meshes) + ",\"accessors\":" + JsonArray(accessors) + ",\"bufferViews\":" +
+            JsonArray(bufferViews) + ",\"buffers\":[{\"byteLength\":" + JsonUInt(binSize) + "}]";
+    json += "}";
+
+    json.resize((json.size() + 3) & ~static_cast<size_t>(3), ' ');
+    DftUInt64 totalSize = 12 + 8 + json.size() + (binSize > 0 ? 8 + binSize : 0);
+    if (totalSize > 0xFFFFFFFFull)
+        return FALSE;
+
+    CBufferedFileWriter writer;
+    if (!writer.Open(iPath))
+        return FALSE;
+    DftUInt32 header[3] = { GLB_MAGIC, 2, static_cast<DftUInt32>(totalSize) };
+    writer.Write(header, sizeof(header));
+    DftUInt32 jsonChunk[2] = { static_cast<DftUInt32>(json.size()), GLB_CHUNK_JSON };
+    writer.Write(jsonChunk, sizeof(jsonChunk));
+    writer.Write(json);
+    if (binSize > 0)
+    {
+        DftUInt32 binChunk[2] = { static_cast<DftUInt32>(binSize), GLB_CHUNK_BIN };
+        writer.Write(binChunk, sizeof(binChunk));
+        for (size_t m = 0; m < iMeshes.size(); m++)
+        {
+            const GlbMesh& mesh = iMeshes[m];
+            if (mesh._positions.size() < 3 || mesh._indexes.empty())
+                continue;
+            writer.Write(&mesh._positions[0], (mesh._positions.size() / 3) * 12);
+            if (mesh._normals.size() == mesh._positions.size())
+                writer.Write(&mesh._normals[0], (mesh._normals.size() / 3) * 12);
+            writer.Write(&mesh._indexes[0], mesh._indexes.size() * 4);
+        }
+    }
+
+    if (oBytes)
+        *oBytes = writer.GetBytesWritten();
+    return writer.Close();
+}
@@ -0,0 +1,87 @@
+/**
+ * @file pdvgltfwriter.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：glTF 2.0二进制（GLB）输出
+ * @details 每个渲染几何的顶点和索引只写入一次，引用同一几何的所有实例通过EXT_mesh_gpu_instancing扩展
+ *          输出平移、旋转、缩放，只有一个实例时输出普通节点。实例化网格（IInstancedMesh）的实例矩阵与节点世界变换合成后
+ *          参与同样的合并；合批网格（IBatchedMesh）的每个渲染网格以索引访问器的子区间引用合批几何，不再展开。
+ */
+
+#ifndef PDVGLTFWRITER_H
+#define PDVGLTFWRITER_H
+
+#include "DftBase.h"
+#include <string>
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+class ISceneData;
+} // namespace pdv
+} // namespace kernel
+
+struct LodSelectOptions;
+class CGeometryCache;
+
+/** @brief GLB文件头中的标识"glTF" */
+#define GLB_MAGIC 0x46546C67u
+/** @brief JSON数据块类型 */
+#define GLB_CHUNK_JSON 0x4E4F534Au
+/** @brief 二进制数据块类型 */
+#define GLB_CHUNK_BIN 0x004E4942u
+
+/** @brief 导出统计 */
+struct GlbStatistics
+{
+    DftUInt64 _geometryCount;  ///< 写入的渲染几何数
+    DftUInt64 _instanceCount;  ///< 实例总数
+    DftUInt64 _batchedRanges;  ///< 合批几何的子区间数
+    DftUInt64 _bytes;          ///< 文件长度
+
+    GlbStatistics() : _geometryCount(0), _instanceCount(0), _batchedRanges(0), _bytes(0) {}
+};
+
+/** @brief 已变换到输出坐标系的网格，坐标、法向按xyz紧密排列 */
+struct GlbMesh
+{
+    std::string _name;                ///< 节点名称
+    std::vector<DftFloat> _positions; ///< 顶点坐标
+    std::vector<DftFloat> _normals;   ///< 顶点法向，为空时不输出法向
+    std::vector<DftUInt> _indexes;    ///< 三角形索引
+};
+
+/**
+ * @brief 按扩展名（.glb，不区分大小写）判断是否输出GLB文件
+ * @return bool 是否为GLB文件
+ * @param[in] iPath 文件路径
+ */
+bool IsGlbPath(const std::string& iPath);
+
+/**
+ * @brief 将场景中所有主体网格输出为GLB文件
+ * @return DftBool 是否成功
+ * @param[in] iSceneData 场景数据
+ * @param[in] iPath 文件路径
+ * @param[in,out] ioCache 渲染几何缓存，为NULL时使用默认内存上限的临时缓存
+ * @param[out] oStatistics 导出统计，为NULL时不统计
+ * @param[in] iLod LOD选择参数，为NULL时输出每个网格的第一个渲染几何；合批网格的几何不受影响
+ * @note 先读取全部几何计算包围盒和数据布局，再写出JSON和二进制数据，第二遍的几何数据通常命中缓存
+ */
+DftBool ExportSceneGlb(kernel::pdv::ISceneData* iSceneData, const std::string& iPath, CGeometryCache* ioCache = NULL,
+    GlbStatistics* oStatistics = NULL, const LodSelectOptions* iLod = NULL);
+
+/**
+ * @brief 将一组已变换的网格输出为GLB文件，每个网格为根节点下的一个子节点
+ * @return DftBool 是否成功
+ * @param[in] iMeshes 网格，没有三角形的网格不输出
+ * @param[in] iRootMatrix 根节点矩阵，按glTF列主序排列的16个数，为NULL时不设置；以双精度输出，用于放置以局部原点存放的坐标
+ * @param[in] iPath 文件路径
+ * @param[out] oBytes 文件长度，可为NULL
+ */
+DftBool WriteGlbMeshes(const std::vector<GlbMesh>& iMeshes, const DftDouble* iRootMatrix, const std::string& iPath,
+    DftUInt64* oBytes = NULL);
+
+#endif
@@ -0,0 +1,177 @@
+#include "pdvloader.h"
+#include "PDVFile.h"
+#include "pdvprofiler.h"
+#include <chrono>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace kernel::pdv;
+
+#ifdef _WIN32
+namespace
+{
+
+// PrefetchVirtualMemory从Windows 8开始提供，动态获取以兼容旧系统
+typedef BOOL(WINAPI* PrefetchVirtualMemoryFunc)(HANDLE, ULONG_PTR, PWIN32_MEMORY_RANGE_ENTRY, ULONG);
+
+void PrefetchMapping(const void* iData, DftUInt64 iSize)
+{
+    static PrefetchVirtualMemoryFunc s_prefetch = reinterpret_cast<PrefetchVirtualMemoryFunc>(
+        GetProcAddress(GetModuleHandleW(L"kernel32.dll"), "PrefetchVirtualMemory"));
+    if (!s_prefetch)
+        return;
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<void*>(iData);
+    range.NumberOfBytes = static_cast<SIZE_T>(iSize);
+    s_prefetch(GetCurrentProcess(), 1, &range, 0);
+}
+
+} // namespace
+#endif
+
+CMappedFile::CMappedFile()
+    : m_Data(NULL)
+    , m_Size(0)
+#ifdef _WIN32
+    , m_File(INVALID_HANDLE_VALUE)
+    , m_Mapping(NULL)
+#else
+    , m_File(-1)
+#endif
+{
+}
+
+CMappedFile::~CMappedFile()
+{
+    Close();
+}
+
+#ifdef _WIN32
+DftBool CMappedFile::Open(const CUnicodeString& iPath)
+{
+    Close();
+
+    // 顺序访问提示让系统加大预读
+    m_File = CreateFileW(reinterpret_cast<LPCWSTR>(static_cast<const DftWChar*>(iPath)), GENERIC_READ, FILE_SHARE_READ,
+        NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+    if (m_File == INVALID_HANDLE_VALUE)
+        return FALSE;
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(m_File, &size) || size.QuadPart <= 0 ||
+        static_cast<DftUInt64>(size.QuadPart) > static_cast<DftUInt64>(static_cast<SIZE_T>(-1)))
+    {
+        Close();
+        return FALSE;
+    }
+
+    m_Mapping = CreateFileMappingW(m_File, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!m_Mapping)
+    {
+        Close();
+        return FALSE;
+    }
+    m_Data = static_cast<const DftByte*>(MapViewOfFile(m_Mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!m_Data)
+    {
+        Close();
+        return FALSE;
+    }
+    m_Size = static_cast<DftUInt64>(size.QuadPart);
+    PrefetchMapping(m_Data, m_Size);
+    return TRUE;
+}
+
+void CMappedFile::Close()
+{
+    if (m_Data)
+        UnmapViewOfFile(m_Data);
+    if (m_Mapping)
+        CloseHandle(m_Mapping);
+    if (m_File != INVALID_HANDLE_VALUE)
+        CloseHandle(m_File);
+    m_Data = NULL;
+    m_Mapping = NULL;
+    m_File = INVALID_HANDLE_VALUE;
+    m_Size = 0;
+}
+#else
+DftBool CMappedFile::Open(const CUnicodeString& iPath)
+{
+    Close();
+
+    m_File = open(iPath.ToMultiByte(), O_RDONLY);
+    if (m_File < 0)
+        return FALSE;
+
+    struct stat info;
+    if (fstat(m_File, &info) != 0 || info.st_size <= 0)
+    {
+        Close();
+        return FALSE;
+    }
+
+    void* data = mmap(NULL, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, m_File, 0);
+    if (data == MAP_FAILED)
+    {
+        Close();
+        return FALSE;
+    }
+    m_Data = static_cast<const DftByte*>(data);
+    m_Size = static_cast<DftUInt64>(info.st_size);
+
+    // 顺序访问并提前预读
+    madvise(data, static_cast<size_t>(m_Size), MADV_SEQUENTIAL);
+    madvise(data, static_cast<size_t>(m_Size), MADV_WILLNEED);
+    return TRUE;
+}
+
+void CMappedFile::Close()
+{
+    if (m_Data)
+        munmap(const_cast<DftByte*>(m_Data), static_cast<size_t>(m_Size));
+    if (m_File >= 0)
+        close(m_File);
+    m_Data = NULL;
+    m_File = -1;
+    m_Size = 0;
+}
+#endif
+
+PDV_RESULT LoadSceneDataMapped(ISceneData* iSceneData, const CUnicodeString& iPath, CMappedFile& oMapping,
+    LoadStatistics* oStatistics)
+{
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_LOAD);
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    PDV_RESULT result;
+    DftUInt64 bytes = 0;
+    DftBool isMapped = oMapping.Open(iPath) && oMapping.GetSize() <= static_cast<DftUInt64>(0x7FFFFFFFFFFFFFFFll);
+    if (isMapped)
+    {
+        // 映射保留在oMapping中，直到调用方释放场景数据之后
+        bytes = oMapping.GetSize();
+        result = PDVFileServices::LoadSceneData(iSceneData, oMapping.GetData(), static_cast<DftLong64>(bytes));
+    }
+    else
+    {
+        // 映射失败时由库按路径读取
+        oMapping.Close();
+        result = PDVFileServices::LoadSceneData(iSceneData, iPath);
+    }
+
+    if (oStatistics)
+    {
+        oStatistics->_bytes = bytes;
+        oStatistics->_mapped = isMapped;
+        oStatistics->_seconds = std::chrono::duration<DftDouble>(std::chrono::steady_clock::now() - start).count();
+    }
+    return result;
+}
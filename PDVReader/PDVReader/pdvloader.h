@@ -0,0 +1,87 @@
+/**
+ * @file pdvloader.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：基于内存映射的pdv文件加载
+ * @details 以顺序访问方式把pdv文件映射到内存，再交给PDVFileServices::LoadSceneData的数据流重载解析，
+ *          省去库内部的文件读取和缓冲拷贝；映射失败时退回按路径加载。
+ *          数据流重载没有说明解析后是否仍引用输入数据，映射由调用方持有，在场景数据释放或清空之后才解除。
+ */
+
+#ifndef PDVLOADER_H
+#define PDVLOADER_H
+
+#include "DftBase.h"
+#include "PDVBase.h"
+
+namespace kernel
+{
+namespace pdv
+{
+class ISceneData;
+} // namespace pdv
+} // namespace kernel
+
+/** @brief 只读的文件内存映射 */
+class CMappedFile
+{
+public:
+    CMappedFile();
+    /** 析构函数，自动解除映射 */
+    ~CMappedFile();
+
+    /**
+     * @brief 以只读、顺序访问方式映射整个文件
+     * @return DftBool 是否成功，空文件视为失败
+     * @param[in] iPath 文件路径
+     */
+    DftBool Open(const CUnicodeString& iPath);
+
+    /** @brief 解除映射并关闭文件 */
+    void Close();
+
+    /** @brief 映射的数据，未映射时为NULL */
+    const DftByte* GetData() const { return m_Data; }
+    /** @brief 文件长度 */
+    DftUInt64 GetSize() const { return m_Size; }
+
+private:
+    CMappedFile(const CMappedFile&);
+    CMappedFile& operator=(const CMappedFile&);
+
+    const DftByte* m_Data; ///< 映射地址
+    DftUInt64 m_Size;      ///< 文件长度
+#ifdef _WIN32
+    void* m_File;          ///< 文件句柄
+    void* m_Mapping;       ///< 映射句柄
+#else
+    int m_File;            ///< 文件描述符
+#endif
+};
+
+/** @brief 加载统计 */
+struct LoadStatistics
+{
+    DftUInt64 _bytes;   ///< 文件长度
+    DftDouble _seconds; ///< 映射与解析的总耗时
+    DftBool _mapped;    ///< 是否通过内存映射加载，否则为按路径加载
+
+    LoadStatistics() : _bytes(0), _seconds(0.0), _mapped(FALSE) {}
+
+    /** 加载速度（MB/s） */
+    DftDouble GetThroughput() const { return _seconds > 0.0 ? _bytes / _seconds / (1024.0 * 1024.0) : 0.0; }
+};
+
+/**
+ * @brief 通过内存映射加载pdv文件
+ * @return PDV_RESULT 与PDVFileServices::LoadSceneData相同
+ * @param[in] iSceneData 场景数据
+ * @param[in] iPath pdv文件路径
+ * @param[out] oMapping 文件映射，加载前先关闭；映射失败而按路径加载时保持关闭
+ * @param[out] oStatistics 加载统计，为NULL时不统计
+ * @note oMapping须在iSceneData释放或清空之后才关闭或析构，调用方一般把它声明在场景数据的使用范围之外
+ */
+kernel::pdv::PDV_RESULT LoadSceneDataMapped(kernel::pdv::ISceneData* iSceneData, const CUnicodeString& iPath, CMappedFile& oMapping,
+    LoadStatistics* oStatistics = NULL);
+
+#endif
@@ -0,0 +1,410 @@
+#include "pdvlod.h"
+#include "PDVISceneData.h"
+#include "PDVIModel.h"
+#include "PDVIRenderBody.h"
+#include "PDVIObjectFactory.h"
+#include "PDVIRenderGeometry.h"
+#include "PDVIRenderMesh.h"
+#include "PDVIRenderVertex.h"
+#include "pdvgeometrycache.h"
+#include "pdvprofiler.h"
+#include "pdvsceneindex.h"
+#include "pdvsimplify.h"
+#include "pdvthreadpool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+// 一层的三角面数少于上一层的这个比例时才保留，简化受误差上限或网格结构限制而收效不足时停止
+const DftFloat MIN_LEVEL_REDUCTION = 0.9f;
+
+/** 一份原几何及引用它的主体网格 */
+struct LodWorkItem
+{
+    IRenderGeometry* _geometry;          ///< 原几何
+    IRenderVertex* _vertex;              ///< 原几何的顶点数据
+    RenderGeomInfo _source;              ///< 网格中原几何的记录
+    vector<IRenderMesh*> _meshes;        ///< 引用原几何的网格
+
+    LodWorkItem() : _geometry(NULL), _vertex(NULL) {}
+};
+
+/** 一个简化层级 */
+struct LodLevel
+{
+    vector<DftUInt32> _indexes;          ///< 三角形索引
+    vector<VertexData> _vertexes;        ///< 原顶点的子集
+    DftFloat _detail;                    ///< LOD系数，即三角面数与原几何之比
+    DftFloat _error;                     ///< 相对原几何的误差
+
+    LodLevel() : _detail(0.0f), _error(0.0f) {}
+};
+
+/** 一份原几何的简化结果 */
+struct LodWorkResult
+{
+    vector<LodLevel> _levels;            ///< 各层级，三角面数递减
+    DftUInt8 _vertexMask;                ///< 原顶点数据的标识位
+    DftUInt _sourceTriangles;            ///< 原几何的三角面数
+
+    LodWorkResult() : _vertexMask(RENDER_VERTEX_MASK_NULL), _sourceTriangles(0) {}
+};
+
+// 按几何ID归并只有一个渲染几何的主体网格，按网格顺序排列
+void CollectLodWorkItems(ISceneData* iSceneData, const LodOptions& iOptions, vector<LodWorkItem>& oItems)
+{
+    CSceneIndex sceneIndex(iSceneData);
+    vector<IRenderMesh*> meshes;
+    iSceneData->GetRenderMeshArray(meshes);
+
+    unordered_map<DftUInt64, size_t> itemOfGeometry;
+    RenderGeomInfoArray geomInfos;
+    for (size_t m = 0; m < meshes.size(); m++)
+    {
+        IRenderMesh* mesh = meshes[m];
+        if (!mesh || mesh->GetType() != RENDER_MESH_TYPE_MAIN)
+            continue;
+        if (mesh->GetRenderGeomInfoArray(geomInfos) != PDV_RESULT_NO_ERROR || geomInfos.size() != 1)
+            continue;
+
+        DftUInt64 geometryID = geomInfos[0]._renderGeometryID;
+        unordered_map<DftUInt64, size_t>::iterator it = itemOfGeometry.find(geometryID);
+        if (it != itemOfGeometry.end())
+        {
+            oItems[it->second]._meshes.push_back(mesh);
+            continue;
+        }
+
+        LodWorkItem item;
+        item._geometry = sceneIndex.FindRenderGeometry(geometryID);
+        if (!item._geometry || item._geometry->GetIndexCount() / 3 < iOptions._minTriangles)
+            continue;
+        item._vertex = sceneIndex.FindRenderVertex(item._geometry->GetVertexID());
+        if (!item._vertex)
+            continue;
+        item._source = geomInfos[0];
+        item._meshes.push_back(mesh);
+        itemOfGeometry[geometryID] = oItems.size();
+        oItems.push_back(item);
+    }
+}
+
+// 读取原几何并逐层简化，读取时持有iSceneMutex，简化在锁外进行
+void BuildLodLevels(const LodWorkItem& iItem, const LodOptions& iOptions, mutex& iSceneMutex, LodWorkResult& oResult)
+{
+    oResult._levels.clear();
+    CachedGeometry current;
+    vector<VertexData> vertexes;
+    {
+        lock_guard<mutex> sceneLock(iSceneMutex);
+        {
+            PDV_PROFILE_SCOPE(PROFILE_PHASE_INDEX_FETCH);
+            if (iItem._geometry->GetIndexes(current._indexes) != PDV_RESULT_NO_ERROR)
+                return;
+            PDV_PROFILE_COUNT(PROFILE_COUNTER_INDEXES, current._indexes.size());
+        }
+        PDV_PROFILE_SCOPE(PROFILE_PHASE_VERTEX_FETCH);
+        if (iItem._vertex->GetVertexes(vertexes) != PDV_RESULT_NO_ERROR)
+            return;
+        oResult._vertexMask = iItem._vertex->GetVertexMask();
+        PDV_PROFILE_COUNT(PROFILE_COUNTER_VERTEXES, vertexes.size());
+    }
+
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_SIMPLIFY);
+    bool hasNormals = (oResult._vertexMask & RENDER_VERTEX_MASK_NORMAL) != 0;
+    current._positions.resize(vertexes.size());
+    current._normals.resize(hasNormals ? vertexes.size() : 0);
+    for (size_t v = 0; v < vertexes.size(); v++)
+    {
+        current._positions[v] = vertexes[v]._position;
+        if (hasNormals)
+            current._normals[v] = vertexes[v]._normal;
+    }
+    oResult._sourceTriangles = current.GetTriangleCount();
+
+    // 每层从上一层简化，顶点序号经各层的对应关系换算回原顶点
+    vector<DftUInt> sourceVertexes;
+    vector<DftUInt> levelVertexes;
+    CachedGeometry next;
+    DftFloat error = 0.0f;
+    for (DftUInt level = 1; level <= iOptions._levelCount; level++)
+    {
+        DftDouble ratio = pow(static_cast<DftDouble>(iOptions._levelRatio), static_cast<DftDouble>(level));
+        SimplifyTarget target;
+        target._triangles = static_cast<DftUInt>(oResult._sourceTriangles * ratio);
+        if (target._triangles < iOptions._minTriangles)
+            break;
+        if (iOptions._maxError > 0.0f)
+        {
+            target._maxError = iOptions._maxError - error;
+            if (target._maxError <= 0.0f)
+                break;
+        }
+        if (!SimplifyGeometry(current, target, next, &levelVertexes))
+            break;
+        DftUInt triangles = next.GetTriangleCount();
+        if (triangles == 0 || triangles > current.GetTriangleCount() * MIN_LEVEL_REDUCTION)
+            break;
+
+        if (level > 1)
+        {
+            for (size_t v = 0; v < levelVertexes.size(); v++)
+                levelVertexes[v] = sourceVertexes[levelVertexes[v]];
+        }
+        sourceVertexes.swap(levelVertexes);
+        error += next._error;
+
+        oResult._levels.push_back(LodLevel());
+        LodLevel& result = oResult._levels.back();
+        result._indexes = next._indexes;
+        result._vertexes.resize(sourceVertexes.size());
+        for (size_t v = 0; v < sourceVertexes.size(); v++)
+            result._vertexes[v] = vertexes[sourceVertexes[v]];
+        result._detail = static_cast<DftFloat>(triangles) / oResult._sourceTriangles;
+        result._error = error;
+
+        swap(current, next);
+    }
+}
+
+// 把简化结果创建为顶点数据和渲染几何，追加到引用原几何的网格中
+bool WriteLodLevels(IObjectFactory* iFactory, ISceneData* ioSceneData, const LodWorkItem& iItem, const LodWorkResult& iResult,
+    LodStatistics& ioStatistics)
+{
+    if (iResult._levels.empty())
+        return true;
+
+    RenderGeomInfoArray geomInfos(1, iItem._source);
+    geomInfos[0]._lodDetail = 1.0f;
+    for (size_t l = 0; l < iResult._levels.size(); l++)
+    {
+        const LodLevel& level = iResult._levels[l];
+        IRenderVertex* vertex = NULL;
+        IRenderGeometry* geometry = NULL;
+        if (iFactory->CreateRenderVertex(ioSceneData, vertex) != PDV_RESULT_NO_ERROR || !vertex)
+            return false;
+        vertex->SetVertexMask(iResult._vertexMask);
+        vertex->SetVertexes(level._vertexes);
+        if (iFactory->CreateRenderGeometry(ioSceneData, geometry) != PDV_RESULT_NO_ERROR || !geometry)
+            return false;
+        geometry->SetIndexes(level._indexes);
+        geometry->SetVertexID(vertex->GetID());
+
+        RenderGeomInfo info;
+        info._renderGeometryID = geometry->GetID();
+        info._lodDetail = level._detail;
+        geomInfos.push_back(info);
+
+        ioStatistics._levelTriangles += level._indexes.size() / 3;
+        if (level._error > ioStatistics._maxError)
+            ioStatistics._maxError = level._error;
+    }
+    for (size_t m = 0; m < iItem._meshes.size(); m++)
+        iItem._meshes[m]->SetRenderGeomeInfoArray(geomInfos);
+
+    ioStatistics._meshCount += iItem._meshes.size();
+    ioStatistics._geometryCount++;
+    ioStatistics._levelCount += iResult._levels.size();
+    ioStatistics._sourceTriangles += iResult._sourceTriangles;
+    return true;
+}
+
+/** 网格的一个层级 */
+struct LodMeshLevel
+{
+    IRenderGeometry* _geometry;  ///< 渲染几何
+    DftUInt _triangles;          ///< 三角面数
+
+    bool operator<(const LodMeshLevel& iOther) const { return _triangles > iOther._triangles; }
+};
+
+// 取网格的各层级，按三角面数从多到少排列，即从最细到最粗
+void GetMeshLevels(const CSceneIndex& iSceneIndex, IRenderMesh* iMesh, vector<LodMeshLevel>& oLevels)
+{
+    oLevels.clear();
+    RenderGeomInfoArray geomInfos;
+    if (iMesh->GetRenderGeomInfoArray(geomInfos) != PDV_RESULT_NO_ERROR)
+        return;
+    for (size_t i = 0; i < geomInfos.size(); i++)
+    {
+        LodMeshLevel level;
+        level._geometry = iSceneIndex.FindRenderGeometry(geomInfos[i]._renderGeometryID);
+        if (!level._geometry)
+            continue;
+        level._triangles = level._geometry->GetIndexCount() / 3;
+        oLevels.push_back(level);
+    }
+    stable_sort(oLevels.begin(), oLevels.end());
+}
+
+// 把网格视为包围盒大小的光滑曲面，按三角面数估计弦高误差：边长h满足n·h²/2 ≈ 表面积A，
+// 曲率半径取包围盒对角线的一半R，误差约为h²/(8R) = A/(4Rn)；包围盒无效时返回负值
+DftDouble EstimateLevelError(const OrientedBoundingBox& iBox, DftUInt iTriangles)
+{
+    const PDVVector3F* axes[3] = { &iBox._axisX, &iBox._axisY, &iBox._axisZ };
+    DftDouble half[3];
+    for (int a = 0; a < 3; a++)
+    {
+        const DftFloat* v = axes[a]->_data;
+        half[a] = sqrt(static_cast<DftDouble>(v[0]) * v[0] + static_cast<DftDouble>(v[1]) * v[1] + static_cast<DftDouble>(v[2]) * v[2]);
+    }
+    DftDouble radius = sqrt(half[0] * half[0] + half[1] * half[1] + half[2] * half[2]);
+    if (radius <= 0.0 || iTriangles == 0)
+        return -1.0;
+    DftDouble area = 8.0 * (half[0] * half[1] + half[1] * half[2] + half[2] * half[0]);
+    return area / (4.0 * radius * iTriangles);
+}
+
+// 按单个网格的参数选择层级序号，iLevels非空
+size_t SelectLevel(IRenderMesh* iMesh, const vector<LodMeshLevel>& iLevels, const LodSelectOptions& iOptions)
+{
+    size_t last = iLevels.size() - 1;
+    if (iOptions._mode == LOD_SELECT_LEVEL)
+        return min(static_cast<size_t>(iOptions._level), last);
+    if (iOptions._mode != LOD_SELECT_ERROR || last == 0)
+        return 0;
+
+    OrientedBoundingBox box;
+    if (iMesh->GetBox(box) != PDV_RESULT_NO_ERROR)
+        return 0;
+    for (size_t l = last; l > 0; l--)
+    {
+        DftDouble error = EstimateLevelError(box, iLevels[l]._triangles);
+        if (error >= 0.0 && error <= iOptions._maxError)
+            return l;
+    }
+    return 0;
+}
+
+} // namespace
+
+DftBool BuildLodChains(ISceneData* ioSceneData, const LodOptions& iOptions, LodStatistics* oStatistics)
+{
+    LodStatistics statistics;
+    if (oStatistics)
+        *oStatistics = statistics;
+    IObjectFactory* factory = IObjectFactory::GetObjectFactory();
+    if (!ioSceneData || !factory)
+        return FALSE;
+    if (iOptions._levelCount == 0 || iOptions._levelRatio <= 0.0f || iOptions._levelRatio >= 1.0f)
+        return TRUE;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<LodWorkItem> items;
+    CollectLodWorkItems(ioSceneData, iOptions, items);
+
+    // 各几何并行简化，按网格顺序创建对象，结果与线程数无关
+    mutex sceneMutex;
+    vector<LodWorkResult> results(items.size());
+    DftBool success = RunOrdered(iOptions._threadCount, items.size(), 2,
+        [&](size_t index) { BuildLodLevels(items[index], iOptions, sceneMutex, results[index]); },
+        [&](size_t index) {
+            bool written;
+            {
+                lock_guard<mutex> sceneLock(sceneMutex);
+                written = WriteLodLevels(factory, ioSceneData, items[index], results[index], statistics);
+            }
+            vector<LodLevel>().swap(results[index]._levels);
+            return written;
+        });
+
+    statistics._seconds = chrono::duration<DftDouble>(chrono::steady_clock::now() - start).count();
+    if (oStatistics)
+        *oStatistics = statistics;
+    return success;
+}
+
+IRenderGeometry* SelectMeshGeometry(const CSceneIndex& iSceneIndex, IRenderMesh* iMesh, const LodSelectOptions* iOptions)
+{
+    if (!iMesh)
+        return NULL;
+    if (!iOptions || iOptions->_mode == LOD_SELECT_FINEST)
+        return iSceneIndex.FindRenderGeometry(iMesh->GetFirstRenderGeometryID());
+
+    vector<LodMeshLevel> levels;
+    GetMeshLevels(iSceneIndex, iMesh, levels);
+    return levels.empty() ? NULL : levels[SelectLevel(iMesh, levels, *iOptions)]._geometry;
+}
+
+void SelectModelGeometries(const CSceneIndex& iSceneIndex, IModel* iModel, const LodSelectOptions* iOptions,
+    vector<LodMeshSelection>& oMeshes)
+{
+    oMeshes.clear();
+    if (!iModel)
+        return;
+    bool budget = iOptions && iOptions->_mode == LOD_SELECT_BUDGET;
+
+    // 按节点上限选择时先取出所有网格的层级，再统一确定层级序号
+    vector<vector<LodMeshLevel> > meshLevels;
+    vector<DftUInt64> faceMeshIDs;
+    DftUInt renderBodyCount = iModel->GetRenderBodyCount();
+    for (DftUInt i = 0; i < renderBodyCount; i++)
+    {
+        IRenderBody* renderBody = iSceneIndex.FindRenderBody(iModel->GetRenderBodyID(i));
+        if (!renderBody)
+            continue;
+        renderBody->GetFaceMeshIDs(faceMeshIDs);
+        for (size_t j = 0; j < faceMeshIDs.size(); j++)
+        {
+            LodMeshSelection selection;
+            selection._mesh = iSceneIndex.FindRenderMesh(faceMeshIDs[j]);
+            if (!selection._mesh || selection._mesh->GetType() != RENDER_MESH_TYPE_MAIN)
+                continue;
+            if (budget)
+            {
+                meshLevels.push_back(vector<LodMeshLevel>());
+                GetMeshLevels(iSceneIndex, selection._mesh, meshLevels.back());
+                if (meshLevels.back().empty())
+                {
+                    meshLevels.pop_back();
+                    continue;
+                }
+                selection._geometry = meshLevels.back()[0]._geometry;
+            }
+            else
+            {
+                selection._geometry = SelectMeshGeometry(iSceneIndex, selection._mesh, iOptions);
+                if (!selection._geometry)
+                    continue;
+            }
+            oMeshes.push_back(selection);
+        }
+    }
+
+    if (budget)
+    {
+        size_t levelCount = 0;
+        for (size_t m = 0; m < meshLevels.size(); m++)
+            levelCount = max(levelCount, meshLevels[m].size());
+        size_t level = 0;
+        for (; level + 1 < levelCount; level++)
+        {
+            DftUInt64 triangles = 0;
+            for (size_t m = 0; m < meshLevels.size(); m++)
+                triangles += meshLevels[m][min(level, meshLevels[m].size() - 1)]._triangles;
+            if (triangles <= iOptions->_nodeTriangleBudget)
+                break;
+        }
+        for (size_t m = 0; m < meshLevels.size(); m++)
+            oMeshes[m]._geometry = meshLevels[m][min(level, meshLevels[m].size() - 1)]._geometry;
+    }
+
+    // 顶点数据找不到的网格不列出
+    size_t count = 0;
+    for (size_t m = 0; m < oMeshes.size(); m++)
+    {
+        oMeshes[m]._vertex = iSceneIndex.FindRenderVertex(oMeshes[m]._geometry->GetVertexID());
+        if (oMeshes[m]._vertex)
+            oMeshes[count++] = oMeshes[m];
+    }
+    oMeshes.resize(count);
+}
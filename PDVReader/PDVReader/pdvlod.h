@@ -0,0 +1,122 @@
+/**
+ * @file pdvlod.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：为渲染网格生成LOD层级并写回场景数据，导出时按参数选择层级
+ * @details IRenderMesh可以关联多个渲染几何（RenderGeomInfo），每个带有LOD系数，但读入的文件中每个网格只有原几何一层。
+ *          这里对每个主体网格的原几何按固定比例逐层简化，每一层从上一层简化得到，层级之间的顶点只取原顶点的子集，
+ *          UV、颜色与透明度随顶点保留。新层级经IObjectFactory创建为顶点数据和渲染几何，追加到网格的渲染几何列表中，
+ *          原几何的LOD系数为1，各层为其三角面数与原几何之比；引用同一几何的网格共用生成的层级。
+ *          简化在线程池中按几何并行进行，创建对象在当前线程中按网格顺序进行，生成的对象ID与线程数无关。
+ *          导出时可按固定层级、误差上限或节点的三角面数上限为每个网格选择一层，只读取选中层级的数据。
+ *          文件中不保存各层的误差，按网格包围盒把网格视为光滑曲面，由三角面数估计弦高误差，对平面较多的网格偏保守。
+ */
+
+#ifndef PDVLOD_H
+#define PDVLOD_H
+
+#include "DftBase.h"
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+class ISceneData;
+class IModel;
+class IRenderMesh;
+class IRenderGeometry;
+class IRenderVertex;
+} // namespace pdv
+} // namespace kernel
+
+class CSceneIndex;
+
+/** @brief LOD生成参数 */
+struct LodOptions
+{
+    DftUInt _levelCount;     ///< 在原几何之外生成的层级数
+    DftFloat _levelRatio;    ///< 相邻两层的三角面数之比，取值(0, 1)
+    DftUInt _minTriangles;   ///< 原几何少于此三角面数时不生成，层级的目标少于此值时停止
+    DftFloat _maxError;      ///< 层级相对原几何的误差上限（按各层误差之和估计），为0时不限制
+    DftUInt _threadCount;    ///< 简化线程数，为0时取CPU逻辑核数
+
+    LodOptions() : _levelCount(3), _levelRatio(0.5f), _minTriangles(64), _maxError(0.0f), _threadCount(0) {}
+};
+
+/** @brief LOD生成统计 */
+struct LodStatistics
+{
+    DftUInt64 _meshCount;         ///< 写入了LOD层级的渲染网格数
+    DftUInt64 _geometryCount;     ///< 生成了层级的原几何数
+    DftUInt64 _levelCount;        ///< 新建的层级数
+    DftUInt64 _sourceTriangles;   ///< 这些原几何的三角面数
+    DftUInt64 _levelTriangles;    ///< 新建层级的三角面数
+    DftFloat _maxError;           ///< 各层级误差的最大值
+    DftDouble _seconds;           ///< 总耗时
+
+    LodStatistics()
+        : _meshCount(0), _geometryCount(0), _levelCount(0), _sourceTriangles(0), _levelTriangles(0), _maxError(0.0f), _seconds(0.0) {}
+};
+
+/**
+ * @brief 为场景中的主体网格生成LOD层级
+ * @return DftBool 对象工厂不可用或创建对象失败时为FALSE
+ * @param[in,out] ioSceneData 场景数据，新建的顶点数据和渲染几何属于该场景
+ * @param[in] iOptions 生成参数
+ * @param[out] oStatistics 生成统计，可为NULL
+ * @note 已经关联多个渲染几何的网格保持不变，因此对同一场景重复调用不会再次生成
+ */
+DftBool BuildLodChains(kernel::pdv::ISceneData* ioSceneData, const LodOptions& iOptions, LodStatistics* oStatistics = NULL);
+
+/** @brief LOD层级的选择方式 */
+enum LodSelectMode
+{
+    LOD_SELECT_FINEST = 0,  ///< 网格的第一个渲染几何，即不选择
+    LOD_SELECT_LEVEL = 1,   ///< 固定层级序号，0为最细，超出时取最粗的层级
+    LOD_SELECT_ERROR = 2,   ///< 估计误差不超过上限的最粗层级，都超过时取最细的层级
+    LOD_SELECT_BUDGET = 3,  ///< 节点下所有网格取同一层级序号，取三角面总数不超过上限的最细层级，都超过时取最粗的层级
+};
+
+/** @brief LOD选择参数 */
+struct LodSelectOptions
+{
+    DftUInt8 _mode;                  ///< 选择方式，见LodSelectMode
+    DftUInt _level;                  ///< 层级序号，用于LOD_SELECT_LEVEL
+    DftFloat _maxError;              ///< 误差上限（模型单位），用于LOD_SELECT_ERROR
+    DftUInt64 _nodeTriangleBudget;   ///< 节点的三角面数上限，用于LOD_SELECT_BUDGET
+
+    LodSelectOptions() : _mode(LOD_SELECT_FINEST), _level(0), _maxError(0.0f), _nodeTriangleBudget(0) {}
+};
+
+/** @brief 一个主体网格选中的层级 */
+struct LodMeshSelection
+{
+    kernel::pdv::IRenderMesh* _mesh;          ///< 渲染网格
+    kernel::pdv::IRenderGeometry* _geometry;  ///< 选中层级的渲染几何
+    kernel::pdv::IRenderVertex* _vertex;      ///< 选中层级的顶点数据
+
+    LodMeshSelection() : _mesh(NULL), _geometry(NULL), _vertex(NULL) {}
+};
+
+/**
+ * @brief 为一个渲染网格选择层级
+ * @return IRenderGeometry* 选中层级的渲染几何，找不到时为NULL
+ * @param[in] iSceneIndex 场景索引
+ * @param[in] iMesh 渲染网格
+ * @param[in] iOptions 选择参数，为NULL时取第一个渲染几何；按节点上限选择时只看该网格自身
+ */
+kernel::pdv::IRenderGeometry* SelectMeshGeometry(const CSceneIndex& iSceneIndex, kernel::pdv::IRenderMesh* iMesh,
+    const LodSelectOptions* iOptions);
+
+/**
+ * @brief 按渲染主体的顺序枚举模型的主体网格，并为每个网格选择层级
+ * @param[in] iSceneIndex 场景索引
+ * @param[in] iModel 模型
+ * @param[in] iOptions 选择参数，为NULL时取每个网格的第一个渲染几何
+ * @param[out] oMeshes 选择结果，渲染几何或顶点数据找不到的网格不列出
+ */
+void SelectModelGeometries(const CSceneIndex& iSceneIndex, kernel::pdv::IModel* iModel, const LodSelectOptions* iOptions,
+    std::vector<LodMeshSelection>& oMeshes);
+
+#endif
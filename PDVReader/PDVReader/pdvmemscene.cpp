@@ -0,0 +1,1162 @@
+#include "pdvmemscene.h"
+#include "PDVIModelTree.h"
+#include "PDVIModelTreeNode.h"
+#include "PDVIModel.h"
+#include "PDVIRenderBody.h"
+#include "PDVIRenderMesh.h"
+#include "PDVIRenderGeometry.h"
+#include "PDVIRenderVertex.h"
+#include "PDVIAttribute.h"
+#include "PDVIAttributeGroup.h"
+#include "PDVIAttributeItem.h"
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+/** 场景内的对象ID分配 */
+struct IdAllocator
+{
+    DftUInt64 _last; ///< 最后分配的ID
+
+    IdAllocator() : _last(DFT_INVALID_ID) {}
+    DftUInt64 Next() { return ++_last; }
+};
+
+/** 按ID查找的对象表，持有对象 */
+template <class T>
+class CObjectTable
+{
+public:
+    ~CObjectTable() { Clear(); }
+
+    void Add(T* iObject)
+    {
+        m_Objects.push_back(iObject);
+        m_Lookup[iObject->GetID()] = iObject;
+    }
+
+    T* Find(DftUInt64 iID) const
+    {
+        typename unordered_map<DftUInt64, T*>::const_iterator it = m_Lookup.find(iID);
+        return it == m_Lookup.end() ? NULL : it->second;
+    }
+
+    template <class I>
+    void GetArray(vector<I*>& oArray) const
+    {
+        oArray.assign(m_Objects.begin(), m_Objects.end());
+    }
+
+    void Clear()
+    {
+        for (size_t i = 0; i < m_Objects.size(); i++)
+            delete m_Objects[i];
+        m_Objects.clear();
+        m_Lookup.clear();
+    }
+
+private:
+    vector<T*> m_Objects;
+    unordered_map<DftUInt64, T*> m_Lookup;
+};
+
+/** IDataObject的公共实现，内存对象不支持序列化 */
+template <class T>
+class CMemDataObject : public T
+{
+public:
+    CMemDataObject(ISceneData* iOwner, DftUInt64 iID) : m_Owner(iOwner), m_ID(iID) {}
+    virtual ~CMemDataObject() {}
+
+    DftUInt64 GetID() { return m_ID; }
+    ISceneData* GetOwner() { return m_Owner; }
+    PDV_RESULT SetOwner(ISceneData* iSceneData)
+    {
+        m_Owner = iSceneData;
+        return PDV_RESULT_NO_ERROR;
+    }
+    DftInt64 GetDataLength() const { return 0; }
+    DftInt64 ReadData(const PDV_CHAR* /*iStreamBuffer*/, DftInt64 /*iBufferLength*/) { return 0; }
+    DftInt64 WriteData(PDV_CHAR* /*ioStreamBuffer*/, DftInt64 /*iBufferLength*/) const { return 0; }
+    void Output(DftJson /*iJsonNode*/) const {}
+
+protected:
+    ISceneData* m_Owner; ///< 所属场景数据
+    DftUInt64 m_ID;      ///< 对象ID
+};
+
+PDV_RESULT GetIndexed(const vector<DftUInt64>& iIDs, DftUInt iIndex, DftUInt64& oID)
+{
+    if (iIndex >= iIDs.size())
+        return PDV_RESULT_INPUT_ERROR;
+    oID = iIDs[iIndex];
+    return PDV_RESULT_NO_ERROR;
+}
+
+DftUInt64 GetIndexedID(const vector<DftUInt64>& iIDs, DftUInt iIndex)
+{
+    return iIndex < iIDs.size() ? iIDs[iIndex] : DFT_INVALID_ID;
+}
+
+/** 属性项 */
+class CMemAttributeItem : public IAttributeItem
+{
+public:
+    CMemAttributeItem(const CUnicodeString& iKey, DftUInt iValueType)
+        : m_Key(iKey), m_ValueType(iValueType), m_Boolean(FALSE), m_Integer(0), m_Float(0.0f), m_Double(0.0)
+    {
+    }
+    virtual ~CMemAttributeItem() {}
+
+    PDV_RESULT GetKey(CUnicodeString& oKey) { oKey = m_Key; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetKey(const CUnicodeString& iKey) { m_Key = iKey; return PDV_RESULT_NO_ERROR; }
+    DftUInt GetValueType() { return m_ValueType; }
+    PDV_RESULT SetValueType(const DftUInt& iValueType) { m_ValueType = iValueType; return PDV_RESULT_NO_ERROR; }
+
+    PDV_RESULT GetBoolean(DftBool& oBoolean) { oBoolean = m_Boolean; return Check(DATATYPE_BOOL); }
+    PDV_RESULT SetBoolean(const DftBool& iBoolean) { m_Boolean = iBoolean; return Check(DATATYPE_BOOL); }
+    PDV_RESULT GetInteger(DftInt& oInteger) { oInteger = m_Integer; return Check(DATATYPE_INT32); }
+    PDV_RESULT SetInteger(const DftInt& iInteger) { m_Integer = iInteger; return Check(DATATYPE_INT32); }
+    PDV_RESULT GetFloat(DftFloat& oFloat) { oFloat = m_Float; return Check(DATATYPE_FLOAT); }
+    PDV_RESULT SetFloat(const DftFloat& iFloat) { m_Float = iFloat; return Check(DATATYPE_FLOAT); }
+    PDV_RESULT GetDouble(DftDouble& oDouble) { oDouble = m_Double; return Check(DATATYPE_DOUBLE); }
+    PDV_RESULT SetDouble(const DftDouble& iDouble) { m_Double = iDouble; return Check(DATATYPE_DOUBLE); }
+    PDV_RESULT GetVectorFloat3(PDVVector3F& oVector) { oVector = m_VectorFloat3; return Check(DATATYPE_VECTOR3F); }
+    PDV_RESULT SetVectorFloat3(const PDVVector3F& iVector) { m_VectorFloat3 = iVector; return Check(DATATYPE_VECTOR3F); }
+    PDV_RESULT GetVectorDouble3(PDVVector3D& oVector) { oVector = m_VectorDouble3; return Check(DATATYPE_VECTOR3D); }
+    PDV_RESULT SetVectorDouble3(const PDVVector3D& iVector) { m_VectorDouble3 = iVector; return Check(DATATYPE_VECTOR3D); }
+    PDV_RESULT GetString(CUnicodeString& oString) { oString = m_String; return Check(DATATYPE_STRING); }
+    PDV_RESULT SetString(const CUnicodeString& iString) { m_String = iString; return Check(DATATYPE_STRING); }
+
+private:
+    // 值与类型不符时仍然读写，但返回错误
+    PDV_RESULT Check(DftUInt iValueType) const
+    {
+        return m_ValueType == iValueType ? PDV_RESULT_NO_ERROR : PDV_RESULT_INPUT_ERROR;
+    }
+
+private:
+    CUnicodeString m_Key;
+    DftUInt m_ValueType;
+    DftBool m_Boolean;
+    DftInt m_Integer;
+    DftFloat m_Float;
+    DftDouble m_Double;
+    PDVVector3F m_VectorFloat3;
+    PDVVector3D m_VectorDouble3;
+    CUnicodeString m_String;
+};
+
+/** 属性组 */
+class CMemAttributeGroup : public IAttributeGroup
+{
+public:
+    CMemAttributeGroup(IAttribute* iOwner, DftUInt64 iID, const CUnicodeString& iName) : m_Owner(iOwner), m_ID(iID), m_Name(iName) {}
+    virtual ~CMemAttributeGroup() { ClearAttributeItem(); }
+
+    DftUInt64 GetID() { return m_ID; }
+    PDV_RESULT GetName(CUnicodeString& oName) { oName = m_Name; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetName(const CUnicodeString& iName) { m_Name = iName; return PDV_RESULT_NO_ERROR; }
+    IAttribute* GetOwner() { return m_Owner; }
+
+    PDV_RESULT AddBooleanAttributeItem(const CUnicodeString& iKey, DftBool iValue, IAttributeItem*& oNewAttributeItem)
+    {
+        CMemAttributeItem* item = AddItem(iKey, DATATYPE_BOOL, oNewAttributeItem);
+        return item->SetBoolean(iValue);
+    }
+    PDV_RESULT AddIntegerAttributeItem(const CUnicodeString& iKey, DftInt iValue, IAttributeItem*& oNewAttributeItem)
+    {
+        CMemAttributeItem* item = AddItem(iKey, DATATYPE_INT32, oNewAttributeItem);
+        return item->SetInteger(iValue);
+    }
+    PDV_RESULT AddFloatAttributeItem(const CUnicodeString& iKey, DftFloat iValue, IAttributeItem*& oNewAttributeItem)
+    {
+        CMemAttributeItem* item = AddItem(iKey, DATATYPE_FLOAT, oNewAttributeItem);
+        return item->SetFloat(iValue);
+    }
+    PDV_RESULT AddDoubleAttributeItem(const CUnicodeString& iKey, DftDouble iValue, IAttributeItem*& oNewAttributeItem)
+    {
+        CMemAttributeItem* item = AddItem(iKey, DATATYPE_DOUBLE, oNewAttributeItem);
+        return item->SetDouble(iValue);
+    }
+    PDV_RESULT AddVectorFloat3AttributeItem(const CUnicodeString& iKey, const PDVVector3F& iValue, IAttributeItem*& oNewAttributeItem)
+    {
+        CMemAttributeItem* item = AddItem(iKey, DATATYPE_VECTOR3F, oNewAttributeItem);
+        return item->SetVectorFloat3(iValue);
+    }
+    PDV_RESULT AddVectorDouble3AttributeItem(const CUnicodeString& iKey, const PDVVector3D& iValue, IAttributeItem*& oNewAttributeItem)
+    {
+        CMemAttributeItem* item = AddItem(iKey, DATATYPE_VECTOR3D, oNewAttributeItem);
+        return item->SetVectorDouble3(iValue);
+    }
+    PDV_RESULT AddStringAttributeItem(const CUnicodeString& iKey, const CUnicodeString& iValue, IAttributeItem*& oNewAttributeItem)
+    {
+        CMemAttributeItem* item = AddItem(iKey, DATATYPE_STRING, oNewAttributeItem);
+        return item->SetString(iValue);
+    }
+
+    PDV_RESULT ClearAttributeItem()
+    {
+        for (size_t i = 0; i < m_Items.size(); i++)
+            delete m_Items[i];
+        m_Items.clear();
+        return PDV_RESULT_NO_ERROR;
+    }
+    DftUInt GetAttributeItemCount() { return static_cast<DftUInt>(m_Items.size()); }
+    PDV_RESULT GetAttributeItemArray(vector<IAttributeItem*>& oAttributeItemArray)
+    {
+        oAttributeItemArray.assign(m_Items.begin(), m_Items.end());
+        return PDV_RESULT_NO_ERROR;
+    }
+
+private:
+    CMemAttributeItem* AddItem(const CUnicodeString& iKey, DftUInt iValueType, IAttributeItem*& oNewAttributeItem)
+    {
+        m_Items.push_back(new CMemAttributeItem(iKey, iValueType));
+        oNewAttributeItem = m_Items.back();
+        return m_Items.back();
+    }
+
+private:
+    IAttribute* m_Owner;
+    DftUInt64 m_ID;
+    CUnicodeString m_Name;
+    vector<CMemAttributeItem*> m_Items;
+};
+
+/** 属性表 */
+class CMemAttribute : public CMemDataObject<IAttribute>
+{
+public:
+    CMemAttribute(ISceneData* iOwner, DftUInt64 iID, IdAllocator* iIds) : CMemDataObject<IAttribute>(iOwner, iID), m_Ids(iIds) {}
+    ~CMemAttribute() { ClearAttributeGroup(); }
+
+    DftUInt GetAttributeGroupCount() { return static_cast<DftUInt>(m_Groups.size()); }
+    PDV_RESULT AddAttributeGroup(const CUnicodeString& iGroupName, IAttributeGroup*& oNewAttributeGroup)
+    {
+        m_Groups.push_back(new CMemAttributeGroup(this, m_Ids->Next(), iGroupName));
+        oNewAttributeGroup = m_Groups.back();
+        return PDV_RESULT_NO_ERROR;
+    }
+    PDV_RESULT ClearAttributeGroup()
+    {
+        for (size_t i = 0; i < m_Groups.size(); i++)
+            delete m_Groups[i];
+        m_Groups.clear();
+        return PDV_RESULT_NO_ERROR;
+    }
+    PDV_RESULT GetAttributeGroupArray(vector<IAttributeGroup*>& oAttributeGroupArray)
+    {
+        oAttributeGroupArray.assign(m_Groups.begin(), m_Groups.end());
+        return PDV_RESULT_NO_ERROR;
+    }
+
+private:
+    IdAllocator* m_Ids;
+    vector<CMemAttributeGroup*> m_Groups;
+};
+
+// 顶点按标识位紧密排列：坐标12、法向12、UV 8、颜色与透明度4、索引4
+size_t GetVertexStride(DftUInt8 iMask)
+{
+    size_t stride = 0;
+    if (iMask & RENDER_VERTEX_MASK_POSITION)
+        stride += sizeof(PDVVector3F);
+    if (iMask & RENDER_VERTEX_MASK_NORMAL)
+        stride += sizeof(PDVVector3F);
+    if (iMask & RENDER_VERTEX_MASK_UV)
+        stride += sizeof(PDVVector2F);
+    if (iMask & RENDER_VERTEX_MASK_COLOR_OPACITY)
+        stride += 4;
+    if (iMask & RENDER_VERTEX_MASK_INDEX)
+        stride += sizeof(DftUInt32);
+    return stride;
+}
+
+void PackVertex(const VertexData& iVertex, DftUInt8 iMask, DftByte* oRecord)
+{
+    if (iMask & RENDER_VERTEX_MASK_POSITION)
+    {
+        memcpy(oRecord, iVertex._position._data, sizeof(PDVVector3F));
+        oRecord += sizeof(PDVVector3F);
+    }
+    if (iMask & RENDER_VERTEX_MASK_NORMAL)
+    {
+        memcpy(oRecord, iVertex._normal._data, sizeof(PDVVector3F));
+        oRecord += sizeof(PDVVector3F);
+    }
+    if (iMask & RENDER_VERTEX_MASK_UV)
+    {
+        memcpy(oRecord, iVertex._uv._data, sizeof(PDVVector2F));
+        oRecord += sizeof(PDVVector2F);
+    }
+    if (iMask & RENDER_VERTEX_MASK_COLOR_OPACITY)
+    {
+        *oRecord++ = iVertex._color._red;
+        *oRecord++ = iVertex._color._green;
+        *oRecord++ = iVertex._color._blue;
+        *oRecord++ = iVertex._opacity;
+    }
+    if (iMask & RENDER_VERTEX_MASK_INDEX)
+        memcpy(oRecord, &iVertex._index, sizeof(DftUInt32));
+}
+
+void UnpackVertex(const DftByte* iRecord, DftUInt8 iMask, VertexData& oVertex)
+{
+    oVertex.Clear();
+    if (iMask & RENDER_VERTEX_MASK_POSITION)
+    {
+        memcpy(oVertex._position._data, iRecord, sizeof(PDVVector3F));
+        iRecord += sizeof(PDVVector3F);
+    }
+    if (iMask & RENDER_VERTEX_MASK_NORMAL)
+    {
+        memcpy(oVertex._normal._data, iRecord, sizeof(PDVVector3F));
+        iRecord += sizeof(PDVVector3F);
+    }
+    if (iMask & RENDER_VERTEX_MASK_UV)
+    {
+        memcpy(oVertex._uv._data, iRecord, sizeof(PDVVector2F));
+        iRecord += sizeof(PDVVector2F);
+    }
+    if (iMask & RENDER_VERTEX_MASK_COLOR_OPACITY)
+    {
+        oVertex._color._red = *iRecord++;
+        oVertex._color._green = *iRecord++;
+        oVertex._color._blue = *iRecord++;
+        oVertex._opacity = *iRecord++;
+    }
+    if (iMask & RENDER_VERTEX_MASK_INDEX)
+        memcpy(&oVertex._index, iRecord, sizeof(DftUInt32));
+}
+
+/** 顶点数据，按标识位紧密排列保存 */
+class CMemRenderVertex : public CMemDataObject<IRenderVertex>
+{
+public:
+    CMemRenderVertex(ISceneData* iOwner, DftUInt64 iID, DftUInt8 iMask)
+        : CMemDataObject<IRenderVertex>(iOwner, iID), m_Mask(iMask), m_Count(0)
+    {
+    }
+
+    DftUInt GetVertexCount() const { return m_Count; }
+
+    PDV_RESULT GetVertexes(vector<VertexData>& oVertexes)
+    {
+        size_t stride = GetVertexStride(m_Mask);
+        oVertexes.resize(m_Count);
+        for (DftUInt i = 0; i < m_Count; i++)
+            UnpackVertex(&m_Data[i * stride], m_Mask, oVertexes[i]);
+        return PDV_RESULT_NO_ERROR;
+    }
+
+    PDV_RESULT SetVertexes(const vector<VertexData>& iVertexes)
+    {
+        m_Data.clear();
+        m_Count = 0;
+        return AddVertexes(iVertexes);
+    }
+
+    PDV_RESULT AddVertexes(const vector<VertexData>& iVertexes)
+    {
+        size_t stride = GetVertexStride(m_Mask);
+        size_t offset = m_Data.size();
+        m_Data.resize(offset + iVertexes.size() * stride);
+        for (size_t i = 0; i < iVertexes.size(); i++)
+            PackVertex(iVertexes[i], m_Mask, &m_Data[offset + i * stride]);
+        m_Count += static_cast<DftUInt>(iVertexes.size());
+        return PDV_RESULT_NO_ERROR;
+    }
+
+    PDV_RESULT GetVertexesBuffer(DftByte*& oVertexesBuffer, DftUInt32& oSize)
+    {
+        oVertexesBuffer = m_Data.empty() ? NULL : &m_Data[0];
+        oSize = static_cast<DftUInt32>(m_Data.size());
+        return PDV_RESULT_NO_ERROR;
+    }
+
+    PDV_RESULT SetVertexesBuffer(DftByte* iVertexesBuffer, DftUInt32 iSize)
+    {
+        size_t stride = GetVertexStride(m_Mask);
+        if (stride == 0 || iSize % stride != 0 || (iSize > 0 && !iVertexesBuffer))
+            return PDV_RESULT_INPUT_ERROR;
+        m_Data.assign(iVertexesBuffer, iVertexesBuffer + iSize);
+        m_Count = static_cast<DftUInt>(iSize / stride);
+        return PDV_RESULT_NO_ERROR;
+    }
+
+    DftUInt8 GetVertexMask() { return m_Mask; }
+
+    // 标识位改变时按新的布局重新排列已有数据
+    PDV_RESULT SetVertexMask(const DftUInt8& iVertexMask)
+    {
+        if (iVertexMask == m_Mask)
+            return PDV_RESULT_NO_ERROR;
+        vector<VertexData> vertexes;
+        GetVertexes(vertexes);
+        m_Mask = iVertexMask;
+        return SetVertexes(vertexes);
+    }
+
+private:
+    DftUInt8 m_Mask;
+    DftUInt m_Count;
+    vector<DftByte> m_Data;
+};
+
+/** 渲染几何 */
+class CMemRenderGeometry : public CMemDataObject<IRenderGeometry>
+{
+public:
+    CMemRenderGeometry(ISceneData* iOwner, DftUInt64 iID) : CMemDataObject<IRenderGeometry>(iOwner, iID), m_VertexID(DFT_INVALID_ID) {}
+
+    DftUInt GetIndexCount() const { return static_cast<DftUInt>(m_Indexes.size()); }
+    PDV_RESULT GetIndexes(vector<DftUInt32>& oIndexes) { oIndexes = m_Indexes; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetIndexes(const vector<DftUInt32>& iIndexes) { m_Indexes = iIndexes; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT AddIndexes(const vector<DftUInt32>& iIndexes)
+    {
+        m_Indexes.insert(m_Indexes.end(), iIndexes.begin(), iIndexes.end());
+        return PDV_RESULT_NO_ERROR;
+    }
+    DftUInt64 GetVertexID() { return m_VertexID; }
+    PDV_RESULT SetVertexID(const DftUInt64& iVertexID) { m_VertexID = iVertexID; return PDV_RESULT_NO_ERROR; }
+
+private:
+    vector<DftUInt32> m_Indexes;
+    DftUInt64 m_VertexID;
+};
+
+/** 渲染网格 */
+class CMemRenderMesh : public CMemDataObject<IRenderMesh>
+{
+public:
+    CMemRenderMesh(ISceneData* iOwner, DftUInt64 iID, DftUInt8 iType)
+        : CMemDataObject<IRenderMesh>(iOwner, iID), m_Type(iType), m_MaterialID(DFT_INVALID_ID)
+        , m_RenderMethod(RENDER_METHOD_TYPE_COMMON), m_BatchedMeshID(DFT_INVALID_ID), m_InstancedMeshID(DFT_INVALID_ID)
+    {
+    }
+
+    DftUInt8 GetType() { return m_Type; }
+    PDV_RESULT SetType(const DftUInt8& iType) { m_Type = iType; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetRenderGeomInfoArray(RenderGeomInfoArray& oRenderGeomInfoArray)
+    {
+        oRenderGeomInfoArray = m_GeomInfos;
+        return PDV_RESULT_NO_ERROR;
+    }
+    PDV_RESULT SetRenderGeomeInfoArray(const RenderGeomInfoArray& iRenderGeomInfoArray)
+    {
+        m_GeomInfos = iRenderGeomInfoArray;
+        return PDV_RESULT_NO_ERROR;
+    }
+    DftUInt64 GetFirstRenderGeometryID() { return m_GeomInfos.empty() ? DFT_INVALID_ID : m_GeomInfos[0]._renderGeometryID; }
+    PDV_RESULT SetFirstRenderGeometryID(DftUInt64 iID)
+    {
+        if (m_GeomInfos.empty())
+            m_GeomInfos.push_back(RenderGeomInfo());
+        m_GeomInfos[0]._renderGeometryID = iID;
+        return PDV_RESULT_NO_ERROR;
+    }
+    DftUInt64 GetMaterialID() { return m_MaterialID; }
+    PDV_RESULT SetMaterialID(const DftUInt64& iMaterialID) { m_MaterialID = iMaterialID; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetBox(OrientedBoundingBox& oBox) { oBox = m_Box; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetBox(const OrientedBoundingBox& iBox) { m_Box = iBox; return PDV_RESULT_NO_ERROR; }
+
+    // 按第一个渲染几何的顶点坐标计算与坐标轴对齐的外包盒
+    PDV_RESULT BuildBoxByVertexData()
+    {
+        IRenderGeometry* geometry = m_Owner ? m_Owner->FindRenderGeometryByID(GetFirstRenderGeometryID()) : NULL;
+        IRenderVertex* vertex = geometry ? m_Owner->FindRenderVertexByID(geometry->GetVertexID()) : NULL;
+        vector<VertexData> vertexes;
+        if (!vertex || vertex->GetVertexes(vertexes) != PDV_RESULT_NO_ERROR || vertexes.empty())
+            return PDV_RESULT_GENERAL_ERROR;
+        PDVVector3F minimum = vertexes[0]._position;
+        PDVVector3F maximum = vertexes[0]._position;
+        for (size_t i = 1; i < vertexes.size(); i++)
+        {
+            for (int k = 0; k < 3; k++)
+            {
+                minimum._data[k] = vertexes[i]._position._data[k] < minimum._data[k] ? vertexes[i]._position._data[k] : minimum._data[k];
+                maximum._data[k] = vertexes[i]._position._data[k] > maximum._data[k] ? vertexes[i]._position._data[k] : maximum._data[k];
+            }
+        }
+        m_Box._center = PDVVector3F((minimum._data[0] + maximum._data[0]) * 0.5f, (minimum._data[1] + maximum._data[1]) * 0.5f,
+            (minimum._data[2] + maximum._data[2]) * 0.5f);
+        m_Box._axisX = PDVVector3F((maximum._data[0] - minimum._data[0]) * 0.5f, 0.0f, 0.0f);
+        m_Box._axisY = PDVVector3F(0.0f, (maximum._data[1] - minimum._data[1]) * 0.5f, 0.0f);
+        m_Box._axisZ = PDVVector3F(0.0f, 0.0f, (maximum._data[2] - minimum._data[2]) * 0.5f);
+        return PDV_RESULT_NO_ERROR;
+    }
+
+    DftUInt8 GetRenderMethod() { return m_RenderMethod; }
+    PDV_RESULT SetRenderMethod(const DftUInt8& iRenderMethod) { m_RenderMethod = iRenderMethod; return PDV_RESULT_NO_ERROR; }
+    DftUInt64 GetBatchedMeshID() { return m_BatchedMeshID; }
+    PDV_RESULT SetBatchedMeshID(const DftUInt64& iBatchedMeshID) { m_BatchedMeshID = iBatchedMeshID; return PDV_RESULT_NO_ERROR; }
+    DftUInt64 GetInstancedMeshID() { return m_InstancedMeshID; }
+    PDV_RESULT SetInstancedMeshID(const DftUInt64& iInstancedMeshID) { m_InstancedMeshID = iInstancedMeshID; return PDV_RESULT_NO_ERROR; }
+
+private:
+    DftUInt8 m_Type;
+    RenderGeomInfoArray m_GeomInfos;
+    DftUInt64 m_MaterialID;
+    OrientedBoundingBox m_Box;
+    DftUInt8 m_RenderMethod;
+    DftUInt64 m_BatchedMeshID;
+    DftUInt64 m_InstancedMeshID;
+};
+
+/** 渲染主体 */
+class CMemRenderBody : public CMemDataObject<IRenderBody>
+{
+public:
+    CMemRenderBody(ISceneData* iOwner, DftUInt64 iID)
+        : CMemDataObject<IRenderBody>(iOwner, iID), m_BitMask(0), m_BrepID(DFT_INVALID_ID), m_RenderBodySubsetID(DFT_INVALID_ID)
+    {
+        m_Matrix.SetIdentity();
+    }
+
+    DftUInt8 GetBitMask() { return m_BitMask; }
+    PDV_RESULT SetBitMask(const DftUInt8& iBitMask) { m_BitMask = iBitMask; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetName(CUnicodeString& oName) { oName = m_Name; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetName(const CUnicodeString& iName) { m_Name = iName; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetPointMeshIDs(vector<DftUInt64>& oPointMeshIDs) { oPointMeshIDs = m_PointMeshIDs; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetPointMeshIDs(const vector<DftUInt64>& iPointMeshIDs) { m_PointMeshIDs = iPointMeshIDs; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetLineMeshIDs(vector<DftUInt64>& oLineMeshIDs) { oLineMeshIDs = m_LineMeshIDs; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetLineMeshIDs(const vector<DftUInt64>& iLineMeshIDs) { m_LineMeshIDs = iLineMeshIDs; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetFaceMeshIDs(vector<DftUInt64>& oFaceMeshIDs) { oFaceMeshIDs = m_FaceMeshIDs; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetFaceMeshIDs(const vector<DftUInt64>& iFaceMeshIDs) { m_FaceMeshIDs = iFaceMeshIDs; return PDV_RESULT_NO_ERROR; }
+    DftUInt64 GetBrepID() { return m_BrepID; }
+    PDV_RESULT SetBrepID(const DftUInt64& iBrepID) { m_BrepID = iBrepID; return PDV_RESULT_NO_ERROR; }
+    DftUInt64 GetRenderBodySubsetID() { return m_RenderBodySubsetID; }
+    PDV_RESULT SetRenderBodySubsetID(const DftUInt64& iRenderBodySubsetID)
+    {
+        m_RenderBodySubsetID = iRenderBodySubsetID;
+        return PDV_RESULT_NO_ERROR;
+    }
+
+    // 按面网格的渲染几何统计
+    PDV_RESULT GetStatistics(Statistics& oStatistics)
+    {
+        oStatistics = Statistics();
+        oStatistics._faceMeshCount = static_cast<DftUInt>(m_FaceMeshIDs.size());
+        oStatistics._lineMeshCount = static_cast<DftUInt>(m_LineMeshIDs.size());
+        oStatistics._pointMeshCount = static_cast<DftUInt>(m_PointMeshIDs.size());
+        for (size_t i = 0; m_Owner && i < m_FaceMeshIDs.size(); i++)
+        {
+            IRenderMesh* mesh = m_Owner->FindRenderMeshByID(m_FaceMeshIDs[i]);
+            IRenderGeometry* geometry = mesh ? m_Owner->FindRenderGeometryByID(mesh->GetFirstRenderGeometryID()) : NULL;
+            if (geometry)
+                oStatistics._faceCount += geometry->GetIndexCount() / 3;
+        }
+        return PDV_RESULT_NO_ERROR;
+    }
+
+    PDVMatrix4F GetMatrix() { return m_Matrix; }
+    PDV_RESULT SetMatrix(const PDVMatrix4F& iMatrix) { m_Matrix = iMatrix; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetBox(OrientedBoundingBox& oBox) { oBox = m_Box; return PDV_RESULT_NO_ERROR; }
+
+private:
+    DftUInt8 m_BitMask;
+    CUnicodeString m_Name;
+    vector<DftUInt64> m_PointMeshIDs;
+    vector<DftUInt64> m_LineMeshIDs;
+    vector<DftUInt64> m_FaceMeshIDs;
+    DftUInt64 m_BrepID;
+    DftUInt64 m_RenderBodySubsetID;
+    PDVMatrix4F m_Matrix;
+    OrientedBoundingBox m_Box;
+};
+
+/** 模型，只关联渲染主体和属性表 */
+class CMemModel : public CMemDataObject<IModel>
+{
+public:
+    CMemModel(ISceneData* iOwner, DftUInt64 iID, const CUnicodeString& iName)
+        : CMemDataObject<IModel>(iOwner, iID), m_BitMask(0), m_ExtendBitMask(0), m_Name(iName)
+        , m_Volume(0.0f), m_SurfaceArea(0.0f), m_Mass(0.0f), m_AnnotationID(DFT_INVALID_ID), m_AttributeID(DFT_INVALID_ID)
+        , m_ResultConfigID(DFT_INVALID_ID), m_ResultID(DFT_INVALID_ID), m_ReferenceGeometryGroupID(DFT_INVALID_ID)
+    {
+    }
+
+    DftUInt8 GetBitMask() { return m_BitMask; }
+    PDV_RESULT SetBitMask(const DftUInt8& iBitMask) { m_BitMask = iBitMask; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetName(CUnicodeString& oName) { oName = m_Name; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetName(const CUnicodeString& iName) { m_Name = iName; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetBoundingBox(BoundingBox& oBox) { oBox = m_Box; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetBoundingBox(const BoundingBox& iBox) { m_Box = iBox; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetBoundingBoxCornerPoints(DftPoint3F oCornerPoints[8])
+    {
+        for (int i = 0; i < 8; i++)
+        {
+            oCornerPoints[i][0] = (i & 1) ? m_Box._max._data[0] : m_Box._min._data[0];
+            oCornerPoints[i][1] = (i & 2) ? m_Box._max._data[1] : m_Box._min._data[1];
+            oCornerPoints[i][2] = (i & 4) ? m_Box._max._data[2] : m_Box._min._data[2];
+        }
+        return PDV_RESULT_NO_ERROR;
+    }
+    PDV_RESULT GetMassProperty(DftFloat& oVolume, DftFloat& oSurfaceArea, DftFloat& oMass, PDVVector3F& oCenterOfGravity)
+    {
+        oVolume = m_Volume;
+        oSurfaceArea = m_SurfaceArea;
+        oMass = m_Mass;
+        oCenterOfGravity = m_CenterOfGravity;
+        return PDV_RESULT_NO_ERROR;
+    }
+    PDV_RESULT SetMassProperty(DftFloat iVolume, DftFloat iSurfaceArea, DftFloat iMass, const PDVVector3F& iCenterOfGravity)
+    {
+        m_Volume = iVolume;
+        m_SurfaceArea = iSurfaceArea;
+        m_Mass = iMass;
+        m_CenterOfGravity = iCenterOfGravity;
+        return PDV_RESULT_NO_ERROR;
+    }
+
+    DftUInt GetMeshCount() { return static_cast<DftUInt>(m_MeshIDs.size()); }
+    IMesh* GetMesh(DftUInt iIndex) { return m_Owner ? m_Owner->FindMeshByID(GetIndexedID(m_MeshIDs, iIndex)) : NULL; }
+    DftUInt64 GetMeshID(DftUInt iIndex) { return GetIndexedID(m_MeshIDs, iIndex); }
+    PDV_RESULT AddMeshID(DftUInt64 iID) { m_MeshIDs.push_back(iID); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT ClearMeshID() { m_MeshIDs.clear(); return PDV_RESULT_NO_ERROR; }
+
+    DftUInt GetPrimityCount() { return static_cast<DftUInt>(m_PrimityIDs.size()); }
+    IPrimity* GetPrimity(DftUInt iIndex) { return m_Owner ? m_Owner->FindPrimityByID(GetIndexedID(m_PrimityIDs, iIndex)) : NULL; }
+    DftUInt64 GetPrimityID(DftUInt iIndex) { return GetIndexedID(m_PrimityIDs, iIndex); }
+    PDV_RESULT AddPrimityID(DftUInt64 iID) { m_PrimityIDs.push_back(iID); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT ClearPrimityID() { m_PrimityIDs.clear(); return PDV_RESULT_NO_ERROR; }
+
+    DftUInt GetBRepCount() { return static_cast<DftUInt>(m_BRepIDs.size()); }
+    DftUInt64 GetBRepID(DftUInt iIndex) { return GetIndexedID(m_BRepIDs, iIndex); }
+    IBRep* GetBRep(DftUInt iIndex) { return m_Owner ? m_Owner->FindBRepByID(GetIndexedID(m_BRepIDs, iIndex)) : NULL; }
+    PDV_RESULT AddBRepID(DftUInt64 iID) { m_BRepIDs.push_back(iID); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT ClearBRepID() { m_BRepIDs.clear(); return PDV_RESULT_NO_ERROR; }
+
+    DftUInt64 GetAnnotationID() { return m_AnnotationID; }
+    IAnnotation* GetAnnotation() { return m_Owner ? m_Owner->FindAnnotationByID(m_AnnotationID) : NULL; }
+    PDV_RESULT SetAnnotationID(DftUInt64 iAnnotationID) { m_AnnotationID = iAnnotationID; return PDV_RESULT_NO_ERROR; }
+    DftUInt64 GetAttributeID() { return m_AttributeID; }
+    PDV_RESULT SetAttributeID(DftUInt64 iAttributeID) { m_AttributeID = iAttributeID; return PDV_RESULT_NO_ERROR; }
+    IAttribute* GetAttribute() { return m_Owner ? m_Owner->FindAttributeByID(m_AttributeID) : NULL; }
+    DftUInt8 GetExtendBitMask() { return m_ExtendBitMask; }
+    PDV_RESULT SetExtendBitMask(const DftUInt8& iBitMask) { m_ExtendBitMask = iBitMask; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetBoundingVolume(BoundingVolume& oBoundingVolume)
+    {
+        oBoundingVolume._box = m_VolumeBox;
+        oBoundingVolume._sphere = m_VolumeSphere;
+        return PDV_RESULT_NO_ERROR;
+    }
+    PDV_RESULT SetBoundingVolume(const BoundingVolume& iBoundingVolume)
+    {
+        m_VolumeBox = iBoundingVolume._box;
+        m_VolumeSphere = iBoundingVolume._sphere;
+        return PDV_RESULT_NO_ERROR;
+    }
+    PDV_RESULT GetModelStatistics(Statistics& oStatistics) { oStatistics = m_ModelStatistics; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetModelStatistics(const Statistics& iStatistics) { m_ModelStatistics = iStatistics; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetPMIStatistics(Statistics& oStatistics) { oStatistics = m_PMIStatistics; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetPMIStatistics(const Statistics& iStatistics) { m_PMIStatistics = iStatistics; return PDV_RESULT_NO_ERROR; }
+
+    DftUInt GetRenderBodyCount() { return static_cast<DftUInt>(m_RenderBodyIDs.size()); }
+    DftUInt64 GetRenderBodyID(DftUInt iIndex) { return GetIndexedID(m_RenderBodyIDs, iIndex); }
+    PDV_RESULT AddRenderBodyID(DftUInt64 iID) { m_RenderBodyIDs.push_back(iID); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT ClearRenderBodyID() { m_RenderBodyIDs.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetRenderBodyIDs(vector<DftUInt64>& oRenderBodyIDs) { oRenderBodyIDs = m_RenderBodyIDs; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetRenderBodyIDs(const vector<DftUInt64>& iRenderBodyIDs) { m_RenderBodyIDs = iRenderBodyIDs; return PDV_RESULT_NO_ERROR; }
+
+    DftUInt64 GetResultConfigID() { return m_ResultConfigID; }
+    PDV_RESULT SetResultConfigID(DftUInt64 iResultConfigID) { m_ResultConfigID = iResultConfigID; return PDV_RESULT_NO_ERROR; }
+    DftUInt64 GetResultID() { return m_ResultID; }
+    PDV_RESULT SetResultID(DftUInt64 iResultID) { m_ResultID = iResultID; return PDV_RESULT_NO_ERROR; }
+    DftUInt64 GetReferenceGeometryGroupID() { return m_ReferenceGeometryGroupID; }
+    PDV_RESULT SetReferenceGeometryGroupID(DftUInt64 iReferenceGeometryGroupID)
+    {
+        m_ReferenceGeometryGroupID = iReferenceGeometryGroupID;
+        return PDV_RESULT_NO_ERROR;
+    }
+
+private:
+    DftUInt8 m_BitMask;
+    DftUInt8 m_ExtendBitMask;
+    CUnicodeString m_Name;
+    BoundingBox m_Box;
+    DftFloat m_Volume;
+    DftFloat m_SurfaceArea;
+    DftFloat m_Mass;
+    PDVVector3F m_CenterOfGravity;
+    vector<DftUInt64> m_MeshIDs;
+    vector<DftUInt64> m_PrimityIDs;
+    vector<DftUInt64> m_BRepIDs;
+    vector<DftUInt64> m_RenderBodyIDs;
+    DftUInt64 m_AnnotationID;
+    DftUInt64 m_AttributeID;
+    DftUInt64 m_ResultConfigID;
+    DftUInt64 m_ResultID;
+    DftUInt64 m_ReferenceGeometryGroupID;
+    // BoundingVolume的默认构造不是内联函数，分开保存以免依赖PDVCore
+    OrientedBoundingBox m_VolumeBox;
+    BoundingSphere m_VolumeSphere;
+    Statistics m_ModelStatistics;
+    Statistics m_PMIStatistics;
+};
+
+class CMemModelTree;
+
+/** 模型树节点 */
+class CMemModelTreeNode : public IModelTreeNode
+{
+public:
+    CMemModelTreeNode(CMemModelTree* iTree, ISceneData* iSceneData, DftUInt64 iID, const CUnicodeString& iName)
+        : m_Tree(iTree), m_SceneData(iSceneData), m_ID(iID), m_Name(iName), m_RootNode(FALSE), m_Visible(TRUE)
+        , m_ModelFlag(FALSE), m_LocalTransformFlag(FALSE), m_WorldTransformFlag(FALSE), m_AttributeFlag(FALSE)
+        , m_MaterialFlag(FALSE), m_LineMaterialFlag(FALSE), m_ModelID(DFT_INVALID_ID), m_AttributeID(DFT_INVALID_ID)
+        , m_MaterialID(DFT_INVALID_ID), m_LineMaterialID(DFT_INVALID_ID), m_ParentID(DFT_INVALID_ID), m_SiblingID(DFT_INVALID_ID)
+        , m_Parent(NULL)
+    {
+        m_LocalTransform.SetIdentity();
+        m_WorldTransform.SetIdentity();
+        m_LeverMatrix.SetIdentity();
+    }
+    virtual ~CMemModelTreeNode() {}
+
+    DftUInt64 GetID() { return m_ID; }
+    PDV_RESULT SetID(DftUInt64 iID) { m_ID = iID; return PDV_RESULT_NO_ERROR; }
+    IModelTree* GetOwner();
+    PDV_RESULT GetName(CUnicodeString& oName) { oName = m_Name; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetName(const CUnicodeString& iName) { m_Name = iName; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetOriginID(CUnicodeString& oOriginID) { oOriginID = m_OriginID; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetOriginID(const CUnicodeString& iOriginID) { m_OriginID = iOriginID; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetOriginName(CUnicodeString& oOriginName) { oOriginName = m_OriginName; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetOriginName(const CUnicodeString& iOriginName) { m_OriginName = iOriginName; return PDV_RESULT_NO_ERROR; }
+    DftBool IsRootNode() { return m_RootNode; }
+    PDV_RESULT SetRootNode(DftBool iRootNode) { m_RootNode = iRootNode; return PDV_RESULT_NO_ERROR; }
+    DftBool GetVisible() { return m_Visible; }
+    PDV_RESULT SetVisible(DftBool iVisible) { m_Visible = iVisible; return PDV_RESULT_NO_ERROR; }
+    DftBool GetModelFlag() { return m_ModelFlag; }
+    PDV_RESULT SetModelFlag(DftBool iModelFlag) { m_ModelFlag = iModelFlag; return PDV_RESULT_NO_ERROR; }
+    DftBool GetLocalTransformFlag() { return m_LocalTransformFlag; }
+    PDV_RESULT SetLocalTransformFlag(DftBool iFlag) { m_LocalTransformFlag = iFlag; return PDV_RESULT_NO_ERROR; }
+    DftBool GetWorldTransformFlag() { return m_WorldTransformFlag; }
+    PDV_RESULT SetWorldTransformFlag(DftBool iFlag) { m_WorldTransformFlag = iFlag; return PDV_RESULT_NO_ERROR; }
+    DftBool GetAttributeFlag() { return m_AttributeFlag; }
+    PDV_RESULT SetAttributeFlag(DftBool iAttributeFlag) { m_AttributeFlag = iAttributeFlag; return PDV_RESULT_NO_ERROR; }
+    DftBool GetMaterialFlag() { return m_MaterialFlag; }
+    PDV_RESULT SetMaterialFlag(DftBool iMaterialFlag) { m_MaterialFlag = iMaterialFlag; return PDV_RESULT_NO_ERROR; }
+
+    PDV_RESULT GetLocalTransform(PDVMatrix4F& oLocalTransform)
+    {
+        oLocalTransform = m_LocalTransform;
+        return m_LocalTransformFlag ? PDV_RESULT_NO_ERROR : PDV_RESULT_MODELTREENODE_NO_LOCAL_TRANSFORM;
+    }
+    PDV_RESULT SetLocalTransform(const PDVMatrix4F& iLocalTransform)
+    {
+        m_LocalTransform = iLocalTransform;
+        m_LocalTransformFlag = TRUE;
+        return PDV_RESULT_NO_ERROR;
+    }
+    PDV_RESULT SetWorldTransform(const PDVMatrix4F& iWorldTransform)
+    {
+        m_WorldTransform = iWorldTransform;
+        m_WorldTransformFlag = TRUE;
+        return PDV_RESULT_NO_ERROR;
+    }
+    PDV_RESULT GetWorldTransform(PDVMatrix4F& oWorldTransform)
+    {
+        oWorldTransform = m_WorldTransform;
+        return m_WorldTransformFlag ? PDV_RESULT_NO_ERROR : PDV_RESULT_MODELTREENODE_NO_WORLD_TRANSFORM;
+    }
+
+    IModel* GetModel() { return m_ModelFlag ? m_SceneData->FindModelByID(m_ModelID) : NULL; }
+    DftUInt64 GetModelID() const { return m_ModelID; }
+    PDV_RESULT SetModelID(DftUInt64 iModelID)
+    {
+        m_ModelID = iModelID;
+        m_ModelFlag = iModelID != DFT_INVALID_ID ? TRUE : FALSE;
+        return PDV_RESULT_NO_ERROR;
+    }
+    IAttribute* GetAttribute() { return m_AttributeFlag ? m_SceneData->FindAttributeByID(m_AttributeID) : NULL; }
+    DftUInt64 GetAttributeID() const { return m_AttributeID; }
+    PDV_RESULT SetAttributeID(DftUInt64 iAttributeID)
+    {
+        m_AttributeID = iAttributeID;
+        m_AttributeFlag = iAttributeID != DFT_INVALID_ID ? TRUE : FALSE;
+        return PDV_RESULT_NO_ERROR;
+    }
+    IMaterial* GetMaterial() { return m_MaterialFlag ? m_SceneData->FindMaterialByID(m_MaterialID) : NULL; }
+    DftUInt64 GetMaterialID() const { return m_MaterialID; }
+    PDV_RESULT SetMaterialID(DftUInt64 iMaterialID)
+    {
+        m_MaterialID = iMaterialID;
+        m_MaterialFlag = iMaterialID != DFT_INVALID_ID ? TRUE : FALSE;
+        return PDV_RESULT_NO_ERROR;
+    }
+
+    PDV_RESULT GetParent(IModelTreeNode*& oParentNode)
+    {
+        oParentNode = m_Parent;
+        return m_Parent ? PDV_RESULT_NO_ERROR : PDV_RESULT_GENERAL_ERROR;
+    }
+    DftUInt64 GetParentID() const { return m_ParentID; }
+    PDV_RESULT SetParentID(const DftUInt64 iParentID) { m_ParentID = iParentID; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetChildren(vector<IModelTreeNode*>& oChildren)
+    {
+        oChildren.assign(m_Children.begin(), m_Children.end());
+        return PDV_RESULT_NO_ERROR;
+    }
+
+    DftBool GetLineMaterialFlag() { return m_LineMaterialFlag; }
+    PDV_RESULT SetLineMaterialFlag(DftBool iMaterialFlag) { m_LineMaterialFlag = iMaterialFlag; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetLeverMatrix(PDVMatrix4F& oLeverMatrix) { oLeverMatrix = m_LeverMatrix; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetLeverMatrix(const PDVMatrix4F& iLeverMatrix) { m_LeverMatrix = iLeverMatrix; return PDV_RESULT_NO_ERROR; }
+    DftUInt64 GetLineMaterialID() const { return m_LineMaterialID; }
+    PDV_RESULT SetLineMaterialID(DftUInt64 iLineMaterialID) { m_LineMaterialID = iLineMaterialID; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetSiblingID(DftUInt64 iSiblingID) { m_SiblingID = iSiblingID; return PDV_RESULT_NO_ERROR; }
+    DftUInt64 GetSiblingID() const { return m_SiblingID; }
+
+    /** 挂接到父节点之下，成为最后一个子节点 */
+    void AttachTo(CMemModelTreeNode* iParent)
+    {
+        m_Parent = iParent;
+        m_ParentID = iParent->m_ID;
+        if (!iParent->m_Children.empty())
+            iParent->m_Children.back()->SetSiblingID(m_ID);
+        iParent->m_Children.push_back(this);
+    }
+
+private:
+    CMemModelTree* m_Tree;
+    ISceneData* m_SceneData;
+    DftUInt64 m_ID;
+    CUnicodeString m_Name;
+    CUnicodeString m_OriginID;
+    CUnicodeString m_OriginName;
+    DftBool m_RootNode;
+    DftBool m_Visible;
+    DftBool m_ModelFlag;
+    DftBool m_LocalTransformFlag;
+    DftBool m_WorldTransformFlag;
+    DftBool m_AttributeFlag;
+    DftBool m_MaterialFlag;
+    DftBool m_LineMaterialFlag;
+    PDVMatrix4F m_LocalTransform;
+    PDVMatrix4F m_WorldTransform;
+    PDVMatrix4F m_LeverMatrix;
+    DftUInt64 m_ModelID;
+    DftUInt64 m_AttributeID;
+    DftUInt64 m_MaterialID;
+    DftUInt64 m_LineMaterialID;
+    DftUInt64 m_ParentID;
+    DftUInt64 m_SiblingID;
+    CMemModelTreeNode* m_Parent;
+    vector<CMemModelTreeNode*> m_Children;
+};
+
+/** 模型树，持有全部节点，节点按添加顺序保存 */
+class CMemModelTree : public CMemDataObject<IModelTree>
+{
+public:
+    CMemModelTree(ISceneData* iOwner, DftUInt64 iID, IdAllocator* iIds, const CUnicodeString& iName)
+        : CMemDataObject<IModelTree>(iOwner, iID), m_Ids(iIds), m_Name(iName), m_Root(NULL)
+    {
+    }
+    ~CMemModelTree()
+    {
+        for (size_t i = 0; i < m_Nodes.size(); i++)
+            delete m_Nodes[i];
+    }
+
+    PDV_RESULT GetName(CUnicodeString& oName) { oName = m_Name; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetName(const CUnicodeString& iName) { m_Name = iName; return PDV_RESULT_NO_ERROR; }
+    DftUInt GetNodeCount() { return static_cast<DftUInt>(m_Nodes.size()); }
+
+    // 父节点为NULL时添加根节点，每棵树只有一个根节点
+    PDV_RESULT AddNode(const CUnicodeString& iNodeName, IModelTreeNode* iParent, IModelTreeNode*& oNewNode)
+    {
+        oNewNode = NULL;
+        CMemModelTreeNode* parent = NULL;
+        if (iParent)
+        {
+            parent = FindNode(iParent->GetID());
+            if (!parent || static_cast<IModelTreeNode*>(parent) != iParent)
+                return PDV_RESULT_INPUT_ERROR;
+        }
+        else if (m_Root)
+        {
+            return PDV_RESULT_INPUT_ERROR;
+        }
+
+        CMemModelTreeNode* node = new CMemModelTreeNode(this, m_Owner, m_Ids->Next(), iNodeName);
+        if (parent)
+        {
+            node->AttachTo(parent);
+        }
+        else
+        {
+            node->SetRootNode(TRUE);
+            m_Root = node;
+        }
+        m_Nodes.push_back(node);
+        m_Lookup[node->GetID()] = node;
+        oNewNode = node;
+        return PDV_RESULT_NO_ERROR;
+    }
+
+    PDV_RESULT InsertNode(const CUnicodeString& /*iNodeName*/, IModelTreeNode* /*iNode*/, IModelTreeNode*& oNewNode)
+    {
+        oNewNode = NULL;
+        return PDV_RESULT_GENERAL_ERROR;
+    }
+    PDV_RESULT DeleteNode(IModelTreeNode* /*iNode*/) { return PDV_RESULT_GENERAL_ERROR; }
+    PDV_RESULT GetRootNode(IModelTreeNode*& oRootNode)
+    {
+        oRootNode = m_Root;
+        return m_Root ? PDV_RESULT_NO_ERROR : PDV_RESULT_MODELTREE_ERROR;
+    }
+    PDV_RESULT GetTreeNodeByID(DftUInt64 iNodeID, IModelTreeNode*& oNode)
+    {
+        oNode = FindNode(iNodeID);
+        return oNode ? PDV_RESULT_NO_ERROR : PDV_RESULT_INPUT_ERROR;
+    }
+    PDV_RESULT GetChildrenNodes(vector<IModelTreeNode*>& oChildrenArray)
+    {
+        oChildrenArray.assign(m_Nodes.begin(), m_Nodes.end());
+        return PDV_RESULT_NO_ERROR;
+    }
+    PDV_RESULT MergeChildNodeByMaxLevel(DftInt /*iMaxLevel*/) { return PDV_RESULT_GENERAL_ERROR; }
+    PDV_RESULT MergeChildNodeByNodeID(DftUInt64 /*iNodeID*/) { return PDV_RESULT_GENERAL_ERROR; }
+
+private:
+    CMemModelTreeNode* FindNode(DftUInt64 iNodeID) const
+    {
+        unordered_map<DftUInt64, CMemModelTreeNode*>::const_iterator it = m_Lookup.find(iNodeID);
+        return it == m_Lookup.end() ? NULL : it->second;
+    }
+
+private:
+    IdAllocator* m_Ids;
+    CUnicodeString m_Name;
+    CMemModelTreeNode* m_Root;
+    vector<CMemModelTreeNode*> m_Nodes;
+    unordered_map<DftUInt64, CMemModelTreeNode*> m_Lookup;
+};
+
+IModelTree* CMemModelTreeNode::GetOwner()
+{
+    return m_Tree;
+}
+
+/** 内存场景数据 */
+class CMemSceneData : public IMemSceneData
+{
+public:
+    CMemSceneData() : m_DocInfoCreationDate(0) {}
+    virtual ~CMemSceneData() { Clear(); }
+
+    // IMemSceneData
+    IModelTree* CreateModelTree(const CUnicodeString& iName)
+    {
+        CMemModelTree* tree = new CMemModelTree(this, m_Ids.Next(), &m_Ids, iName);
+        m_ModelTrees.Add(tree);
+        return tree;
+    }
+    IModel* CreateModel(const CUnicodeString& iName)
+    {
+        CMemModel* model = new CMemModel(this, m_Ids.Next(), iName);
+        m_Models.Add(model);
+        return model;
+    }
+    IRenderBody* CreateRenderBody()
+    {
+        CMemRenderBody* renderBody = new CMemRenderBody(this, m_Ids.Next());
+        m_RenderBodies.Add(renderBody);
+        return renderBody;
+    }
+    IRenderMesh* CreateRenderMesh(DftUInt8 iType)
+    {
+        CMemRenderMesh* renderMesh = new CMemRenderMesh(this, m_Ids.Next(), iType);
+        m_RenderMeshes.Add(renderMesh);
+        return renderMesh;
+    }
+    IRenderGeometry* CreateRenderGeometry()
+    {
+        CMemRenderGeometry* renderGeometry = new CMemRenderGeometry(this, m_Ids.Next());
+        m_RenderGeometries.Add(renderGeometry);
+        return renderGeometry;
+    }
+    IRenderVertex* CreateRenderVertex(DftUInt8 iVertexMask)
+    {
+        CMemRenderVertex* renderVertex = new CMemRenderVertex(this, m_Ids.Next(), iVertexMask);
+        m_RenderVertexes.Add(renderVertex);
+        return renderVertex;
+    }
+    IAttribute* CreateAttribute()
+    {
+        CMemAttribute* attribute = new CMemAttribute(this, m_Ids.Next(), &m_Ids);
+        m_Attributes.Add(attribute);
+        return attribute;
+    }
+    DftUInt64 GetObjectCount() const { return m_Ids._last; }
+
+    // ISceneData
+    PDV_RESULT Clear()
+    {
+        m_ModelTrees.Clear();
+        m_Models.Clear();
+        m_RenderBodies.Clear();
+        m_RenderMeshes.Clear();
+        m_RenderGeometries.Clear();
+        m_RenderVertexes.Clear();
+        m_Attributes.Clear();
+        m_Ids = IdAllocator();
+        return PDV_RESULT_NO_ERROR;
+    }
+    PDV_RESULT Release()
+    {
+        delete this;
+        return PDV_RESULT_NO_ERROR;
+    }
+
+    IScene* GetScene() { return NULL; }
+    ITileSet* GetTileSet() { return NULL; }
+    PDV_RESULT BuildTileSet() { return PDV_RESULT_GENERAL_ERROR; }
+    PDV_RESULT BuildTileSetToCGo(TreeNodeInfo* /*iTreeNodeInfoData*/, DftUInt64& oLength, DftByte*& oStreamBuffer)
+    {
+        oLength = 0;
+        oStreamBuffer = NULL;
+        return PDV_RESULT_GENERAL_ERROR;
+    }
+
+    PDV_RESULT GetModelTreeArray(vector<IModelTree*>& oArray) { m_ModelTrees.GetArray(oArray); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetModelArray(vector<IModel*>& oArray) { m_Models.GetArray(oArray); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetMeshArray(vector<IMesh*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetBRepArray(vector<IBRep*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetAttributeArray(vector<IAttribute*>& oArray) { m_Attributes.GetArray(oArray); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetCameraArray(vector<ICamera*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetAnnotationArray(vector<IAnnotation*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetReviewArray(vector<IReview*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetViewArray(vector<IView*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetMaterialArray(vector<IMaterial*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetAnimationArray(vector<IAnimation*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetPrimityArray(vector<IPrimity*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetLightArray(vector<ILight*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetTextureArray(vector<ITexture*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetResourceArray(vector<IResource*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetPhysicalQuantityArray(vector<IPhysicalQuantity*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetRenderBodyArray(vector<IRenderBody*>& oArray) { m_RenderBodies.GetArray(oArray); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetRenderBodySubsetArray(vector<IRenderBodySubset*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetRenderVertexArray(vector<IRenderVertex*>& oArray) { m_RenderVertexes.GetArray(oArray); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetRenderGeometryArray(vector<IRenderGeometry*>& oArray) { m_RenderGeometries.GetArray(oArray); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetResultConfigArray(vector<IResultConfig*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetRenderMeshArray(vector<IRenderMesh*>& oArray) { m_RenderMeshes.GetArray(oArray); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetReferenceGeometryGroupArray(vector<IReferenceGeometryGroup*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetNodeSubsetMaterialArray(vector<INodeSubsetMaterial*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetInstancedMeshArray(vector<IInstancedMesh*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetBatchedMeshArray(vector<IBatchedMesh*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT GetAnalysisResultArray(vector<IAnalysisResult*>& oArray) { oArray.clear(); return PDV_RESULT_NO_ERROR; }
+
+    ISecurity* GetSecurity() { return NULL; }
+    IUserData* GetUserData() { return NULL; }
+    IExternalLink* GetExternalLink() { return NULL; }
+
+    IModelTree* FindModelTreeByID(DftUInt64 iID) { return m_ModelTrees.Find(iID); }
+    IModel* FindModelByID(DftUInt64 iID) { return m_Models.Find(iID); }
+    IMesh* FindMeshByID(DftUInt64 /*iID*/) { return NULL; }
+    IBRep* FindBRepByID(DftUInt64 /*iID*/) { return NULL; }
+    IAttribute* FindAttributeByID(DftUInt64 iID) { return m_Attributes.Find(iID); }
+    ICamera* FindCameraByID(DftUInt64 /*iID*/) { return NULL; }
+    IAnnotation* FindAnnotationByID(DftUInt64 /*iID*/) { return NULL; }
+    IReview* FindReviewByID(DftUInt64 /*iID*/) { return NULL; }
+    IView* FindViewByID(DftUInt64 /*iID*/) { return NULL; }
+    IMaterial* FindMaterialByID(DftUInt64 /*iID*/) { return NULL; }
+    IAnimation* FindAnimationByID(DftUInt64 /*iID*/) { return NULL; }
+    IResource* FindResourceByID(DftUInt64 /*iID*/) { return NULL; }
+    IPrimity* FindPrimityByID(DftUInt64 /*iID*/) { return NULL; }
+    ILight* FindLightByID(DftUInt64 /*iID*/) { return NULL; }
+    ITexture* FindTextureByID(DftUInt64 /*iID*/) { return NULL; }
+    IPhysicalQuantity* FindPhysicalQuantityByID(DftUInt64 /*iID*/) { return NULL; }
+    IRenderBody* FindRenderBodyByID(DftUInt64 iID) { return m_RenderBodies.Find(iID); }
+    IRenderBodySubset* FindRenderBodySubsetByID(DftUInt64 /*iID*/) { return NULL; }
+    IRenderVertex* FindRenderVertexByID(DftUInt64 iID) { return m_RenderVertexes.Find(iID); }
+    IRenderGeometry* FindRenderGeometryByID(DftUInt64 iID) { return m_RenderGeometries.Find(iID); }
+    IResultConfig* FindResultConfigByID(DftUInt64 /*iID*/) { return NULL; }
+    IRenderMesh* FindRenderMeshByID(DftUInt64 iID) { return m_RenderMeshes.Find(iID); }
+    IReferenceGeometryGroup* FindReferenceGeometryGroupByID(DftUInt64 /*iID*/) { return NULL; }
+    INodeSubsetMaterial* FindNodeSubsetMaterialByID(DftUInt64 /*iID*/) { return NULL; }
+    IInstancedMesh* FindInstancedMeshByID(DftUInt64 /*iID*/) { return NULL; }
+    IBatchedMesh* FindBatchedMeshByID(DftUInt64 /*iID*/) { return NULL; }
+    IAnalysisResult* FindAnalysisResultByID(DftUInt64 /*iID*/) { return NULL; }
+
+    PDV_RESULT ChangeObjectID(IDataObject* /*iObject*/, DftUInt64 /*iNewID*/) { return PDV_RESULT_GENERAL_ERROR; }
+    PDV_RESULT OptimizeMesh() { return PDV_RESULT_GENERAL_ERROR; }
+    PDV_RESULT DeleteUnreferencedMesh() { return PDV_RESULT_GENERAL_ERROR; }
+    PDV_RESULT AddPDV(DftUInt64 /*iNodeID*/, const vector<CUnicodeString>& /*iPDVPaths*/, const vector<PDVMatrix4F>& /*iMatrices*/,
+        const vector<CUnicodeString>& /*iNewNodeNames*/)
+    {
+        return PDV_RESULT_GENERAL_ERROR;
+    }
+
+    CUnicodeString GetDocInfoDocID() { return m_DocInfoDocID; }
+    CUnicodeString GetDocInfoTitle() { return m_DocInfoTitle; }
+    CUnicodeString GetDocInfoAuthor() { return m_DocInfoAuthor; }
+    CUnicodeString GetDocInfoCopyright() { return m_DocInfoCopyright; }
+    DftUInt64 GetDocInfoCreationDate() { return m_DocInfoCreationDate; }
+    CUnicodeString GetDocInfoProducer() { return m_DocInfoProducer; }
+    CUnicodeString GetDocInfoCreator() { return m_DocInfoCreator; }
+    PDV_RESULT SetDocInfoDocID(CUnicodeString iDocID) { m_DocInfoDocID = iDocID; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetDocInfoTitle(CUnicodeString iTitle) { m_DocInfoTitle = iTitle; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetDocInfoAuthor(CUnicodeString iAuthor) { m_DocInfoAuthor = iAuthor; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetDocInfoCopyright(CUnicodeString iCopyright) { m_DocInfoCopyright = iCopyright; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetDocInfoCreationDate(DftUInt64 iCreationDate) { m_DocInfoCreationDate = iCreationDate; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetDocInfoProducer(CUnicodeString iProducer) { m_DocInfoProducer = iProducer; return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT SetDocInfoCreator(CUnicodeString iCreator) { m_DocInfoCreator = iCreator; return PDV_RESULT_NO_ERROR; }
+
+    PDV_RESULT ExportXML(DftBool /*iExportAttr*/, const CUnicodeString& /*iXMLPath*/) { return PDV_RESULT_GENERAL_ERROR; }
+    PDV_RESULT BuildNodeSubsetMaterial() { return PDV_RESULT_GENERAL_ERROR; }
+    PDV_RESULT RunBatchedAndInstanced(DftUInt /*iInstancedMinVertexCount*/, DftInt /*iInstancedVertexCompareDecimalPlaces*/,
+        DftUInt /*iBatchedMaxVertexCount*/, DftUInt /*iBatchedOctreeNodeReserveDepth*/)
+    {
+        return PDV_RESULT_GENERAL_ERROR;
+    }
+    PDV_RESULT RunBatchedAndInstanced2(DftUInt /*iInstancedMinVertexCount*/, DftInt /*iInstancedVertexCompareDecimalPlaces*/,
+        DftUInt /*iBatchedMaxVertexCount*/, DftUInt /*iBatchedOctreeNodeReserveDepth*/)
+    {
+        return PDV_RESULT_GENERAL_ERROR;
+    }
+    // 内存场景不做合批和实例化，无需还原
+    PDV_RESULT RevertBatchedAndInstanced() { return PDV_RESULT_NO_ERROR; }
+    PDV_RESULT MergeModeltreeNodesWithMultiBody(const vector<DftUInt64>& /*iNodeIDs*/) { return PDV_RESULT_GENERAL_ERROR; }
+    PDV_RESULT MergeModeltreeNodesWithOneBody(const vector<DftUInt64>& /*iNodeIDs*/) { return PDV_RESULT_GENERAL_ERROR; }
+    PDV_RESULT RemoveUnReferenceData() { return PDV_RESULT_GENERAL_ERROR; }
+    PDV_RESULT StatisticsRenderDataCount(CUnicodeString& /*oInfo*/) { return PDV_RESULT_GENERAL_ERROR; }
+    PDV_RESULT SetDefaultCameraByBox(const BoundingBox& /*iBox*/, DftUInt8 /*iCameraType*/, const PDVVector3F& /*iUpDir*/,
+        const PDVVector3F& /*iRightDir*/)
+    {
+        return PDV_RESULT_GENERAL_ERROR;
+    }
+
+private:
+    IdAllocator m_Ids;
+    CObjectTable<CMemModelTree> m_ModelTrees;
+    CObjectTable<CMemModel> m_Models;
+    CObjectTable<CMemRenderBody> m_RenderBodies;
+    CObjectTable<CMemRenderMesh> m_RenderMeshes;
+    CObjectTable<CMemRenderGeometry> m_RenderGeometries;
+    CObjectTable<CMemRenderVertex> m_RenderVertexes;
+    CObjectTable<CMemAttribute> m_Attributes;
+    CUnicodeString m_DocInfoDocID;
+    CUnicodeString m_DocInfoTitle;
+    CUnicodeString m_DocInfoAuthor;
+    CUnicodeString m_DocInfoCopyright;
+    DftUInt64 m_DocInfoCreationDate;
+    CUnicodeString m_DocInfoProducer;
+    CUnicodeString m_DocInfoCreator;
+};
+
+} // namespace
+
+IMemSceneData* CreateMemSceneData()
+{
+    return new CMemSceneData();
+}
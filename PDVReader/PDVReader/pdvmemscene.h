@@ -0,0 +1,71 @@
+/**
+ * @file pdvmemscene.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：内存中的场景数据
+ * @details 实现ISceneData以及模型树、模型、渲染主体、渲染网格、渲染几何、顶点数据和属性表的接口，数据全部保存在内存中，
+ *          不依赖PDVCore.dll读取文件。用于构造可重复的大规模场景，测试和比较各个导出流程的性能。
+ *          顶点数据按标识位紧密排列，GetVertexesBuffer返回的数据流与PDV文件加载后的布局一致。
+ *          与导出无关的接口（B-Rep、标注、材质、动画等）返回空对象或PDV_RESULT_GENERAL_ERROR。
+ */
+
+#ifndef PDVMEMSCENE_H
+#define PDVMEMSCENE_H
+
+#include "PDVISceneData.h"
+
+/**
+ * @brief 内存场景数据接口
+ * @note 创建的对象由场景数据持有，Clear或Release时释放；对象ID在场景内唯一，从1开始连续分配
+ */
+class IMemSceneData : public kernel::pdv::ISceneData
+{
+public:
+    /**
+     * @brief 创建模型树，之后通过IModelTree::AddNode添加节点
+     * @return IModelTree* 模型树
+     * @param[in] iName 模型树名称
+     */
+    virtual kernel::pdv::IModelTree* CreateModelTree(const CUnicodeString& iName) = 0;
+
+    /**
+     * @brief 创建模型，之后通过IModel的接口关联渲染主体和属性表
+     * @return IModel* 模型
+     * @param[in] iName 模型名称
+     */
+    virtual kernel::pdv::IModel* CreateModel(const CUnicodeString& iName) = 0;
+
+    /** @brief 创建渲染主体 */
+    virtual kernel::pdv::IRenderBody* CreateRenderBody() = 0;
+
+    /**
+     * @brief 创建渲染网格
+     * @return IRenderMesh* 渲染网格
+     * @param[in] iType 网格类型，见RenderMeshType
+     */
+    virtual kernel::pdv::IRenderMesh* CreateRenderMesh(DftUInt8 iType) = 0;
+
+    /** @brief 创建渲染几何 */
+    virtual kernel::pdv::IRenderGeometry* CreateRenderGeometry() = 0;
+
+    /**
+     * @brief 创建顶点数据
+     * @return IRenderVertex* 顶点数据
+     * @param[in] iVertexMask 顶点标识位，见RenderVertexBitMask
+     */
+    virtual kernel::pdv::IRenderVertex* CreateRenderVertex(DftUInt8 iVertexMask) = 0;
+
+    /** @brief 创建属性表，之后通过IAttribute::AddAttributeGroup添加属性 */
+    virtual kernel::pdv::IAttribute* CreateAttribute() = 0;
+
+    /** @brief 已分配的对象ID个数 */
+    virtual DftUInt64 GetObjectCount() const = 0;
+};
+
+/**
+ * @brief 创建内存场景数据
+ * @return IMemSceneData* 场景数据，使用完毕后调用Release释放
+ */
+IMemSceneData* CreateMemSceneData();
+
+#endif
@@ -0,0 +1,385 @@
+#include "pdvmeshwriter.h"
+#include "pdvfilewriter.h"
+#include "pdvgeometrycache.h"
+#include "pdvlod.h"
+#include "pdvprofiler.h"
+#include "pdvsceneindex.h"
+#include "pdvtextformat.h"
+#include "pdvtransform.h"
+#include "PDVISceneData.h"
+#include "PDVIModelTree.h"
+#include "PDVIModelTreeNode.h"
+#include "PDVIModel.h"
+#include "PDVIRenderMesh.h"
+#include "PDVIRenderGeometry.h"
+#include "PDVIRenderVertex.h"
+#include <cctype>
+#include <cstring>
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+/** PLY文件头中元素个数的字段宽度，关闭时可原位回填 */
+const size_t PLY_COUNT_WIDTH = 20;
+/** PLY单个顶点的字节数：坐标和法向各3个float */
+const size_t PLY_VERTEX_SIZE = 24;
+/** PLY单个三角面的字节数：uchar个数、3个uint索引、uint分组序号 */
+const size_t PLY_FACE_SIZE = 17;
+/** 无效的分组序号 */
+const DftUInt MESH_INVALID_GROUP = 0xFFFFFFFFu;
+
+// 元素个数，右侧补空格到固定宽度
+string FormatPlyCount(DftUInt64 iCount)
+{
+    char buffer[PDV_TEXT_SHORT_NUMBER_MAX_SIZE];
+    string text(buffer, FormatUInt(buffer, iCount));
+    text.resize(PLY_COUNT_WIDTH, ' ');
+    return text;
+}
+
+// 分组名称中的换行、空白会破坏文件结构，替换为下划线
+string SanitizeGroupName(const string& iName)
+{
+    string name = iName;
+    for (size_t i = 0; i < name.size(); i++)
+    {
+        if (name[i] == ' ' || name[i] == '\t' || name[i] == '\r' || name[i] == '\n')
+            name[i] = '_';
+    }
+    return name;
+}
+
+// 二进制小端PLY
+class CPlyMeshWriter : public IMeshWriter
+{
+public:
+    CPlyMeshWriter()
+        : m_VertexCount(0), m_TriangleCount(0), m_DeclaredVertexCount(0), m_DeclaredTriangleCount(0)
+        , m_VertexCountOffset(0), m_TriangleCountOffset(0), m_Group(0) {}
+
+    DftBool Open(const string& iPath, const MeshLayout& iLayout)
+    {
+        m_VertexCount = 0;
+        m_TriangleCount = 0;
+        m_Group = 0;
+        m_DeclaredVertexCount = iLayout._vertexCount;
+        m_DeclaredTriangleCount = iLayout._triangleCount;
+
+        // 索引为32位无符号整数
+        if (iLayout._vertexCount > 0xFFFFFFFFull || !m_Writer.Open(iPath))
+            return FALSE;
+
+        string header = "ply\nformat binary_little_endian 1.0\ncomment PDVReader indexed mesh\n";
+        for (size_t i = 0; i < iLayout._groupNames.size(); i++)
+            header += "comment group " + to_string(i) + " " + SanitizeGroupName(iLayout._groupNames[i]) + "\n";
+        header += "element vertex ";
+        m_VertexCountOffset = header.size();
+        header += FormatPlyCount(iLayout._vertexCount) + "\n"
+            "property float x\nproperty float y\nproperty float z\n"
+            "property float nx\nproperty float ny\nproperty float nz\n"
+            "element face ";
+        m_TriangleCountOffset = header.size();
+        header += FormatPlyCount(iLayout._triangleCount) + "\n"
+            "property list uchar uint vertex_indices\n"
+            "property uint group\n"
+            "end_header\n";
+        m_Writer.Write(header);
+        return TRUE;
+    }
+
+    bool IsInterleaved() const { return false; }
+
+    void BeginGroup(DftUInt iGroup) { m_Group = iGroup; }
+
+    void AddVertexes(const TransformedVertexes& iVertexes)
+    {
+        for (DftUInt i = 0; i < iVertexes._count; i++)
+        {
+            DftByte* ptr = m_Writer.Reserve(PLY_VERTEX_SIZE);
+            memcpy(ptr, iVertexes.Position(i), 12);
+            memcpy(ptr + 12, iVertexes.Normal(i), 12);
+        }
+        m_VertexCount += iVertexes._count;
+    }
+
+    void AddTriangles(const DftUInt* iIndexes, size_t iTriangleCount, DftUInt64 iBaseVertex)
+    {
+        DftUInt32 base = static_cast<DftUInt32>(iBaseVertex);
+        for (size_t t = 0; t < iTriangleCount; t++)
+        {
+            DftUInt32 face[4] = { base + iIndexes[t * 3], base + iIndexes[t * 3 + 1], base + iIndexes[t * 3 + 2], m_Group };
+            DftByte* ptr = m_Writer.Reserve(PLY_FACE_SIZE);
+            ptr[0] = 3;
+            memcpy(ptr + 1, face, sizeof(face));
+        }
+        m_TriangleCount += iTriangleCount;
+    }
+
+    DftBool Close()
+    {
+        if (!m_Writer.IsOpen())
+            return FALSE;
+        if (m_VertexCount != m_DeclaredVertexCount)
+            m_Writer.WriteAt(m_VertexCountOffset, FormatPlyCount(m_VertexCount).data(), PLY_COUNT_WIDTH);
+        if (m_TriangleCount != m_DeclaredTriangleCount)
+            m_Writer.WriteAt(m_TriangleCountOffset, FormatPlyCount(m_TriangleCount).data(), PLY_COUNT_WIDTH);
+        return m_Writer.Close();
+    }
+
+    DftUInt64 GetVertexCount() const { return m_VertexCount; }
+    DftUInt64 GetTriangleCount() const { return m_TriangleCount; }
+    DftUInt64 GetBytesWritten() const { return m_Writer.GetBytesWritten(); }
+
+private:
+    CBufferedFileWriter m_Writer;      ///< 缓冲输出
+    DftUInt64 m_VertexCount;           ///< 已输出的顶点数
+    DftUInt64 m_TriangleCount;         ///< 已输出的三角面数
+    DftUInt64 m_DeclaredVertexCount;   ///< 文件头中的顶点数
+    DftUInt64 m_DeclaredTriangleCount; ///< 文件头中的三角面数
+    size_t m_VertexCountOffset;        ///< 文件头中顶点数的位置
+    size_t m_TriangleCountOffset;      ///< 文件头中三角面数的位置
+    DftUInt32 m_Group;                 ///< 当前分组
+};
+
+// Wavefront OBJ
+class CObjMeshWriter : public IMeshWriter
+{
+public:
+    CObjMeshWriter() : m_VertexCount(0), m_TriangleCount(0) {}
+
+    DftBool Open(const string& iPath, const MeshLayout& iLayout)
+    {
+        m_VertexCount = 0;
+        m_TriangleCount = 0;
+        m_GroupNames.resize(iLayout._groupNames.size());
+        for (size_t i = 0; i < iLayout._groupNames.size(); i++)
+            m_GroupNames[i] = SanitizeGroupName(iLayout._groupNames[i]);
+        if (!m_Writer.Open(iPath))
+            return FALSE;
+        m_Writer.Append("# PDVReader indexed mesh\n");
+        return TRUE;
+    }
+
+    bool IsInterleaved() const { return true; }
+
+    void BeginGroup(DftUInt iGroup)
+    {
+        m_Writer.Append("g ");
+        if (iGroup < m_GroupNames.size() && !m_GroupNames[iGroup].empty())
+            m_Writer.Append(m_GroupNames[iGroup]);
+        else
+            m_Writer.Append("Group_").AppendUInt(iGroup);
+        m_Writer.Append('\n');
+    }
+
+    void AddVertexes(const TransformedVertexes& iVertexes)
+    {
+        for (DftUInt i = 0; i < iVertexes._count; i++)
+            AppendVector("v ", iVertexes.Position(i));
+        for (DftUInt i = 0; i < iVertexes._count; i++)
+            AppendVector("vn ", iVertexes.Normal(i));
+        m_VertexCount += iVertexes._count;
+    }
+
+    void AddTriangles(const DftUInt* iIndexes, size_t iTriangleCount, DftUInt64 iBaseVertex)
+    {
+        // OBJ的索引从1开始，顶点和法向一一对应
+        DftUInt64 base = iBaseVertex + 1;
+        for (size_t t = 0; t < iTriangleCount; t++)
+        {
+            m_Writer.Append('f');
+            for (int k = 0; k < 3; k++)
+            {
+                DftUInt64 index = base + iIndexes[t * 3 + k];
+                m_Writer.Append(' ').AppendUInt(index).Append("//").AppendUInt(index);
+            }
+            m_Writer.Append('\n');
+        }
+        m_TriangleCount += iTriangleCount;
+    }
+
+    DftBool Close()
+    {
+        if (!m_Writer.IsOpen())
+            return FALSE;
+        return m_Writer.Close();
+    }
+
+    DftUInt64 GetVertexCount() const { return m_VertexCount; }
+    DftUInt64 GetTriangleCount() const { return m_TriangleCount; }
+    DftUInt64 GetBytesWritten() const { return m_Writer.GetBytesWritten(); }
+
+private:
+    void AppendVector(const char* iPrefix, const DftFloat* iVector)
+    {
+        m_Writer.Append(iPrefix).AppendGeneral(iVector[0]).Append(' ').AppendGeneral(iVector[1]).Append(' ')
+            .AppendGeneral(iVector[2]).Append('\n');
+    }
+
+    CTextWriter m_Writer;        ///< 缓冲输出
+    vector<string> m_GroupNames; ///< 分组名称
+    DftUInt64 m_VertexCount;     ///< 已输出的顶点数
+    DftUInt64 m_TriangleCount;   ///< 已输出的三角面数
+};
+
+} // namespace
+
+IMeshWriter* CreateMeshWriter(MeshFormat iFormat)
+{
+    if (iFormat == MESH_FORMAT_OBJ)
+        return new CObjMeshWriter();
+    return new CPlyMeshWriter();
+}
+
+bool GetMeshFormatFromPath(const string& iPath, MeshFormat& oFormat)
+{
+    size_t dot = iPath.find_last_of('.');
+    if (dot == string::npos)
+        return false;
+    string ext = iPath.substr(dot + 1);
+    for (size_t i = 0; i < ext.size(); i++)
+        ext[i] = static_cast<char>(tolower(static_cast<unsigned char>(ext[i])));
+    if (ext == "ply")
+        oFormat = MESH_FORMAT_PLY;
+    else if (ext == "obj")
+        oFormat = MESH_FORMAT_OBJ;
+    else
+        return false;
+    return true;
+}
+
+void CollectMeshItems(const CSceneIndex& iSceneIndex, vector<MeshItem>& oItems, MeshLayout& oLayout, const LodSelectOptions* iLod)
+{
+    oItems.clear();
+    oLayout = MeshLayout();
+    ISceneData* sceneData = iSceneIndex.GetSceneData();
+    if (!sceneData)
+        return;
+
+    vector<IModelTree*> modelTreeArray;
+    sceneData->GetModelTreeArray(modelTreeArray);
+    vector<LodMeshSelection> meshes;
+    for (size_t t = 0; t < modelTreeArray.size(); t++)
+    {
+        IModelTree* tree = modelTreeArray[t];
+        if (!tree)
+            continue;
+        vector<IModelTreeNode*> modelTreeNodeArray;
+        tree->GetChildrenNodes(modelTreeNodeArray);
+        for (size_t n = 0; n < modelTreeNodeArray.size(); n++)
+        {
+            IModelTreeNode* node = modelTreeNodeArray[n];
+            if (!node || !node->GetModelFlag())
+                continue;
+            IModel* model = node->GetModel();
+            if (!model || model->GetRenderBodyCount() == 0)
+                continue;
+
+            MeshItem item;
+            node->GetWorldTransform(item._worldTrans);
+            item._nodeID = node->GetID();
+            item._group = static_cast<DftUInt>(oLayout._groupNames.size());
+            size_t firstItem = oItems.size();
+            SelectModelGeometries(iSceneIndex, model, iLod, meshes);
+            for (size_t j = 0; j < meshes.size(); j++)
+            {
+                item._renderMesh = meshes[j]._mesh;
+                item._geometry = meshes[j]._geometry;
+                item._vertex = meshes[j]._vertex;
+                oItems.push_back(item);
+                oLayout._vertexCount += item._vertex->GetVertexCount();
+                oLayout._triangleCount += item._geometry->GetIndexCount() / 3;
+            }
+
+            // 只有输出了网格的节点才占用分组
+            if (oItems.size() > firstItem)
+            {
+                CUnicodeString name;
+                node->GetName(name);
+                string groupName = name.ToMultiByte();
+                oLayout._groupNames.push_back(groupName.empty() ? "Node_" + to_string(item._nodeID) : groupName);
+            }
+        }
+    }
+}
+
+DftBool ExportSceneMesh(ISceneData* iSceneData, const string& iPath, MeshFormat iFormat, CGeometryCache* ioCache,
+    const LodSelectOptions* iLod)
+{
+    if (!iSceneData)
+        return FALSE;
+
+    vector<MeshItem> items;
+    MeshLayout layout;
+    CollectMeshItems(CSceneIndex(iSceneData), items, layout, iLod);
+
+    IMeshWriter* writer = CreateMeshWriter(iFormat);
+    if (!writer->Open(iPath, layout))
+    {
+        SAFE_DELETE(writer);
+        return FALSE;
+    }
+
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_SERIALIZE);
+    CGeometryCache localCache;
+    CGeometryCache& cache = ioCache ? *ioCache : localCache;
+    TransformedVertexes worldVertexes;
+    DftUInt group = MESH_INVALID_GROUP;
+    if (writer->IsInterleaved())
+    {
+        // 每个实例的顶点之后紧跟它的三角面
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            CachedGeometryPtr geometry = cache.Get(items[i]._geometry, items[i]._vertex);
+            if (!geometry)
+                continue;
+            if (items[i]._group != group)
+            {
+                group = items[i]._group;
+                writer->BeginGroup(group);
+            }
+            TransformVertexes(geometry->GetPositions(), geometry->GetNormals(), items[i]._worldTrans, worldVertexes);
+            DftUInt64 baseVertex = writer->GetVertexCount();
+            writer->AddVertexes(worldVertexes);
+            writer->AddTriangles(geometry->_indexes.data(), geometry->_indexes.size() / 3, baseVertex);
+            PDV_PROFILE_COUNT(PROFILE_COUNTER_TRIANGLES, geometry->_indexes.size() / 3);
+        }
+    }
+    else
+    {
+        // 先输出全部顶点并记录每个实例的起始序号，再输出全部三角面，第二遍的几何数据通常命中缓存
+        const DftUInt64 skipped = ~0ull;
+        vector<DftUInt64> baseVertexes(items.size(), skipped);
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            CachedGeometryPtr geometry = cache.Get(items[i]._geometry, items[i]._vertex);
+            if (!geometry)
+                continue;
+            TransformVertexes(geometry->GetPositions(), geometry->GetNormals(), items[i]._worldTrans, worldVertexes);
+            baseVertexes[i] = writer->GetVertexCount();
+            writer->AddVertexes(worldVertexes);
+        }
+        for (size_t i = 0; i < items.size(); i++)
+        {
+            if (baseVertexes[i] == skipped)
+                continue;
+            CachedGeometryPtr geometry = cache.Get(items[i]._geometry, items[i]._vertex);
+            if (!geometry)
+                continue;
+            if (items[i]._group != group)
+            {
+                group = items[i]._group;
+                writer->BeginGroup(group);
+            }
+            writer->AddTriangles(geometry->_indexes.data(), geometry->_indexes.size() / 3, baseVertexes[i]);
+            PDV_PROFILE_COUNT(PROFILE_COUNTER_TRIANGLES, geometry->_indexes.size() / 3);
+        }
+    }
+
+    DftBool result = writer->Close();
+    SAFE_DELETE(writer);
+    return result;
+}
@@ -0,0 +1,153 @@
+/**
+ * @file pdvmeshwriter.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：带索引的网格文件输出（PLY、OBJ）
+ * @details 与STL逐个三角面展开不同，渲染几何的顶点数组和索引数组按原样输出，共享顶点只写一次。
+ *          场景中每个模型树节点对应一个分组：OBJ写为g分组，PLY在文件头中以comment记录分组名称，三角面带分组序号属性。
+ */
+
+#ifndef PDVMESHWRITER_H
+#define PDVMESHWRITER_H
+
+#include "DftBase.h"
+#include "PDVMath.h"
+#include <string>
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+class ISceneData;
+class IRenderMesh;
+class IRenderGeometry;
+class IRenderVertex;
+} // namespace pdv
+} // namespace kernel
+
+struct TransformedVertexes;
+struct LodSelectOptions;
+class CGeometryCache;
+class CSceneIndex;
+
+/** @brief 网格文件格式 */
+enum MeshFormat
+{
+    MESH_FORMAT_PLY = 0, ///< 二进制PLY（小端），顶点带法向，三角面带分组序号
+    MESH_FORMAT_OBJ = 1, ///< Wavefront OBJ，顶点带法向
+};
+
+/** @brief 输出前需要确定的网格规模 */
+struct MeshLayout
+{
+    DftUInt64 _vertexCount;               ///< 顶点总数
+    DftUInt64 _triangleCount;             ///< 三角面总数
+    std::vector<std::string> _groupNames; ///< 分组名称
+
+    MeshLayout() : _vertexCount(0), _triangleCount(0) {}
+};
+
+/** @brief 带索引的网格文件输出接口 */
+class IMeshWriter
+{
+public:
+    virtual ~IMeshWriter() {}
+
+    /**
+     * @brief 创建文件并写入文件头
+     * @return DftBool 是否成功
+     * @param[in] iPath 文件路径
+     * @param[in] iLayout 网格规模，PLY据此写入元素个数，关闭时若与实际数量不符会回填
+     */
+    virtual DftBool Open(const std::string& iPath, const MeshLayout& iLayout) = 0;
+
+    /**
+     * @brief 顶点和三角面是否可以按分组交替输出
+     * @return bool 为false时必须先输出全部顶点，再输出全部三角面
+     */
+    virtual bool IsInterleaved() const = 0;
+
+    /**
+     * @brief 开始一个分组，之后输出的三角面属于该分组
+     * @param[in] iGroup 分组序号，对应MeshLayout::_groupNames
+     */
+    virtual void BeginGroup(DftUInt iGroup) = 0;
+
+    /**
+     * @brief 输出一组顶点，顶点序号从已输出的顶点数开始连续编号
+     * @param[in] iVertexes 变换后的顶点
+     */
+    virtual void AddVertexes(const TransformedVertexes& iVertexes) = 0;
+
+    /**
+     * @brief 输出三角面
+     * @param[in] iIndexes 三角面顶点索引，每三个一组
+     * @param[in] iTriangleCount 三角面个数
+     * @param[in] iBaseVertex 索引0对应的全局顶点序号
+     */
+    virtual void AddTriangles(const DftUInt* iIndexes, size_t iTriangleCount, DftUInt64 iBaseVertex) = 0;
+
+    /**
+     * @brief 关闭文件
+     * @return DftBool 所有数据是否都已成功写入
+     */
+    virtual DftBool Close() = 0;
+
+    /** @brief 已输出的顶点数 */
+    virtual DftUInt64 GetVertexCount() const = 0;
+    /** @brief 已输出的三角面数 */
+    virtual DftUInt64 GetTriangleCount() const = 0;
+    /** @brief 已输出的字节数 */
+    virtual DftUInt64 GetBytesWritten() const = 0;
+};
+
+/**
+ * @brief 创建网格文件输出对象
+ * @return IMeshWriter* 输出对象，使用完毕后由调用方delete
+ * @param[in] iFormat 文件格式
+ */
+IMeshWriter* CreateMeshWriter(MeshFormat iFormat);
+
+/**
+ * @brief 按扩展名（.ply、.obj，不区分大小写）确定网格文件格式
+ * @return bool 是否为支持的网格格式
+ * @param[in] iPath 文件路径
+ * @param[out] oFormat 文件格式
+ */
+bool GetMeshFormatFromPath(const std::string& iPath, MeshFormat& oFormat);
+
+/** @brief 场景中的一个网格实例 */
+struct MeshItem
+{
+    PDVMatrix4F _worldTrans;                  ///< 节点的世界变换
+    DftUInt64 _nodeID;                        ///< 节点ID
+    kernel::pdv::IRenderMesh* _renderMesh;    ///< 渲染网格
+    kernel::pdv::IRenderGeometry* _geometry;  ///< 网格几何
+    kernel::pdv::IRenderVertex* _vertex;      ///< 顶点数据
+    DftUInt _group;                           ///< 所属分组
+};
+
+/**
+ * @brief 按遍历顺序枚举所有关联模型的节点下的主体网格，每个节点为一个分组
+ * @param[in] iSceneIndex 场景对象索引
+ * @param[out] oItems 网格实例
+ * @param[out] oLayout 网格规模，只读取顶点个数和索引个数，不读取数据
+ * @param[in] iLod LOD选择参数，为NULL时取每个网格的第一个渲染几何
+ */
+void CollectMeshItems(const CSceneIndex& iSceneIndex, std::vector<MeshItem>& oItems, MeshLayout& oLayout,
+    const LodSelectOptions* iLod = NULL);
+
+/**
+ * @brief 将场景中所有主体网格按节点分组输出为带索引的网格文件
+ * @return DftBool 是否成功
+ * @param[in] iSceneData 场景数据
+ * @param[in] iPath 文件路径
+ * @param[in] iFormat 文件格式
+ * @param[in,out] ioCache 渲染几何缓存，为NULL时使用默认内存上限的临时缓存
+ * @param[in] iLod LOD选择参数，为NULL时输出每个网格的第一个渲染几何
+ */
+DftBool ExportSceneMesh(kernel::pdv::ISceneData* iSceneData, const std::string& iPath, MeshFormat iFormat,
+    CGeometryCache* ioCache = NULL, const LodSelectOptions* iLod = NULL);
+
+#endif
@@ -0,0 +1,161 @@
+#include "pdvnodetable.h"
+#include "PDVIModel.h"
+#include <cstring>
+
+using namespace std;
+using namespace kernel::pdv;
+
+size_t CNodeTable::StringHash::operator()(DftUInt iStringID) const
+{
+    // FNV-1a
+    size_t hash = 2166136261u;
+    for (const char* p = _table->GetString(iStringID); *p; p++)
+        hash = (hash ^ static_cast<unsigned char>(*p)) * 16777619u;
+    return hash;
+}
+
+bool CNodeTable::StringEqual::operator()(DftUInt iLeft, DftUInt iRight) const
+{
+    return strcmp(_table->GetString(iLeft), _table->GetString(iRight)) == 0;
+}
+
+CNodeTable::CNodeTable()
+    : m_StringLookup(64, StringHash{ this }, StringEqual{ this })
+{
+    Clear();
+}
+
+void CNodeTable::Clear()
+{
+    m_NodeIDs.clear();
+    m_ParentIndexes.clear();
+    m_ModelIDs.clear();
+    m_HasModel.clear();
+    m_WorldTransforms.clear();
+    m_NameIDs.clear();
+    m_ModelNameIDs.clear();
+    m_AttributeOffsets.assign(1, 0);
+    m_PMIOffsets.assign(1, 0);
+    m_ChildOffsets.assign(1, 0);
+    m_Children.clear();
+    m_PMIAnnotationIDs.clear();
+    m_PMITypeIDs.clear();
+    m_PMINameIDs.clear();
+    m_PMIViewModeIDs.clear();
+    m_PMIPropertyOffsets.assign(1, 0);
+    m_PairKeys.clear();
+    m_PairValues.clear();
+    m_StringData.clear();
+    m_StringOffsets.clear();
+    m_StringLookup.clear();
+    m_IndexLookup.clear();
+
+    // 0号字符串固定为空串
+    Intern(string());
+}
+
+DftUInt CNodeTable::Intern(const string& iText)
+{
+    // 先把字符串追加到池尾，以它的编号在哈希表中查找，已存在时撤销追加
+    DftUInt candidate = static_cast<DftUInt>(m_StringOffsets.size());
+    m_StringOffsets.push_back(static_cast<DftUInt>(m_StringData.size()));
+    m_StringData.insert(m_StringData.end(), iText.begin(), iText.end());
+    m_StringData.push_back('\0');
+
+    unordered_set<DftUInt, StringHash, StringEqual>::const_iterator it = m_StringLookup.find(candidate);
+    if (it != m_StringLookup.end())
+    {
+        m_StringData.resize(m_StringOffsets.back());
+        m_StringOffsets.pop_back();
+        return *it;
+    }
+    m_StringLookup.insert(candidate);
+    return candidate;
+}
+
+void CNodeTable::AddPairs(const map<string, string>& iPairs)
+{
+    for (map<string, string>::const_iterator it = iPairs.begin(); it != iPairs.end(); ++it)
+    {
+        m_PairKeys.push_back(Intern(it->first));
+        m_PairValues.push_back(Intern(it->second));
+    }
+}
+
+DftUInt CNodeTable::AddNode(CNodeContext& ioNode)
+{
+    DftUInt index = GetCount();
+    DftUInt parent = ioNode.GetDepth() == 0 ? PDV_NODE_INVALID_INDEX : FindIndex(ioNode.GetParentID());
+
+    m_NodeIDs.push_back(ioNode.GetID());
+    m_ParentIndexes.push_back(parent);
+    m_HasModel.push_back(ioNode.HasModel() ? 1 : 0);
+    m_ModelIDs.push_back(ioNode.GetModel() ? ioNode.GetModel()->GetID() : DFT_INVALID_ID);
+    m_WorldTransforms.push_back(ioNode.GetWorldTransform());
+    m_NameIDs.push_back(Intern(ioNode.GetName()));
+    m_ModelNameIDs.push_back(Intern(ioNode.GetModelName()));
+
+    AddPairs(ioNode.GetAttributes());
+    m_AttributeOffsets.push_back(static_cast<DftUInt>(m_PairKeys.size()));
+
+    const vector<NodePMIData>& pmiData = ioNode.GetPMIData();
+    for (size_t i = 0; i < pmiData.size(); i++)
+    {
+        const NodePMIData& pmi = pmiData[i];
+        m_PMIAnnotationIDs.push_back(pmi.annotationID);
+        m_PMITypeIDs.push_back(Intern(pmi.annotationType));
+        m_PMINameIDs.push_back(Intern(pmi.annotationName));
+        m_PMIViewModeIDs.push_back(Intern(pmi.viewMode));
+        AddPairs(pmi.properties);
+        m_PMIPropertyOffsets.push_back(static_cast<DftUInt>(m_PairKeys.size()));
+    }
+    m_PMIOffsets.push_back(static_cast<DftUInt>(m_PMIAnnotationIDs.size()));
+
+    // 节点ID重复时保留第一次出现的节点
+    m_IndexLookup.insert(make_pair(ioNode.GetID(), index));
+    return index;
+}
+
+void CNodeTable::Finalize()
+{
+    DftUInt count = GetCount();
+
+    // 先统计每个节点的子节点数，再按父节点序号连续存放
+    m_ChildOffsets.assign(count + 1, 0);
+    for (DftUInt i = 0; i < count; i++)
+    {
+        if (m_ParentIndexes[i] != PDV_NODE_INVALID_INDEX)
+            m_ChildOffsets[m_ParentIndexes[i] + 1]++;
+    }
+    for (DftUInt i = 0; i < count; i++)
+        m_ChildOffsets[i + 1] += m_ChildOffsets[i];
+
+    m_Children.resize(m_ChildOffsets[count]);
+    vector<DftUInt> cursor(m_ChildOffsets.begin(), m_ChildOffsets.end() - 1);
+    for (DftUInt i = 0; i < count; i++)
+    {
+        if (m_ParentIndexes[i] != PDV_NODE_INVALID_INDEX)
+            m_Children[cursor[m_ParentIndexes[i]]++] = i;
+    }
+}
+
+DftUInt CNodeTable::FindIndex(DftUInt64 iNodeID) const
+{
+    unordered_map<DftUInt64, DftUInt>::const_iterator it = m_IndexLookup.find(iNodeID);
+    return it == m_IndexLookup.end() ? PDV_NODE_INVALID_INDEX : it->second;
+}
+
+size_t CNodeTable::GetMemoryUsage() const
+{
+    return m_NodeIDs.capacity() * sizeof(DftUInt64) +
+        m_ParentIndexes.capacity() * sizeof(DftUInt) +
+        m_ModelIDs.capacity() * sizeof(DftUInt64) +
+        m_HasModel.capacity() * sizeof(DftUInt8) +
+        m_WorldTransforms.capacity() * sizeof(PDVMatrix4F) +
+        (m_NameIDs.capacity() + m_ModelNameIDs.capacity() + m_AttributeOffsets.capacity() + m_PMIOffsets.capacity() +
+            m_ChildOffsets.capacity() + m_Children.capacity()) * sizeof(DftUInt) +
+        m_PMIAnnotationIDs.capacity() * sizeof(DftUInt64) +
+        (m_PMITypeIDs.capacity() + m_PMINameIDs.capacity() + m_PMIViewModeIDs.capacity() + m_PMIPropertyOffsets.capacity() +
+            m_PairKeys.capacity() + m_PairValues.capacity() + m_StringOffsets.capacity()) * sizeof(DftUInt) +
+        m_StringData.capacity();
+}
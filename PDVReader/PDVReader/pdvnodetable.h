@@ -0,0 +1,165 @@
+/**
+ * @file pdvnodetable.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：紧凑的模型树节点表
+ * @details 节点按遍历顺序编号，节点ID、父节点、模型ID、世界矩阵等按字段分别存放在连续数组中（结构数组）。
+ *          名称、属性键值、PMI文本统一存放在去重的字符串池中，节点只保存字符串编号和属性区间，
+ *          避免每个节点若干个std::string、map和vector带来的大量小块内存分配。
+ */
+
+#ifndef PDVNODETABLE_H
+#define PDVNODETABLE_H
+
+#include "pdvtreewalker.h"
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/** @brief 无效的节点序号 */
+#define PDV_NODE_INVALID_INDEX 0xFFFFFFFFu
+
+/** @brief 模型树节点表 */
+class CNodeTable
+{
+public:
+    CNodeTable();
+
+    /** @brief 清空节点表 */
+    void Clear();
+
+    /**
+     * @brief 添加节点，父节点必须先于子节点添加
+     * @return DftUInt 节点序号
+     * @param[in,out] ioNode 遍历中的节点，读取名称、变换、模型名称、属性表和PMI字段
+     */
+    DftUInt AddNode(CNodeContext& ioNode);
+
+    /** @brief 所有节点添加完毕后建立子节点索引，之后才能查询子节点 */
+    void Finalize();
+
+    /** @brief 节点个数 */
+    DftUInt GetCount() const { return static_cast<DftUInt>(m_NodeIDs.size()); }
+
+    /**
+     * @brief 按节点ID查找节点序号
+     * @return DftUInt 节点序号，不存在时为PDV_NODE_INVALID_INDEX
+     * @param[in] iNodeID 节点ID
+     */
+    DftUInt FindIndex(DftUInt64 iNodeID) const;
+
+    /** @brief 节点ID */
+    DftUInt64 GetNodeID(DftUInt iIndex) const { return m_NodeIDs[iIndex]; }
+    /** @brief 父节点序号，根节点为PDV_NODE_INVALID_INDEX */
+    DftUInt GetParentIndex(DftUInt iIndex) const { return m_ParentIndexes[iIndex]; }
+    /** @brief 父节点ID，根节点为0 */
+    DftUInt64 GetParentID(DftUInt iIndex) const
+    {
+        DftUInt parent = m_ParentIndexes[iIndex];
+        return parent == PDV_NODE_INVALID_INDEX ? 0 : m_NodeIDs[parent];
+    }
+    /** @brief 是否关联模型 */
+    bool HasModel(DftUInt iIndex) const { return m_HasModel[iIndex] != 0; }
+    /** @brief 模型ID，未关联模型时为DFT_INVALID_ID */
+    DftUInt64 GetModelID(DftUInt iIndex) const { return m_ModelIDs[iIndex]; }
+    /** @brief 世界变换 */
+    const PDVMatrix4F& GetWorldTransform(DftUInt iIndex) const { return m_WorldTransforms[iIndex]; }
+    /** @brief 节点名称 */
+    const char* GetName(DftUInt iIndex) const { return GetString(m_NameIDs[iIndex]); }
+    /** @brief 模型名称 */
+    const char* GetModelName(DftUInt iIndex) const { return GetString(m_ModelNameIDs[iIndex]); }
+
+    /** @brief 子节点个数 */
+    DftUInt GetChildCount(DftUInt iIndex) const { return m_ChildOffsets[iIndex + 1] - m_ChildOffsets[iIndex]; }
+    /** @brief 第iChild个子节点的序号，子节点按添加顺序排列 */
+    DftUInt GetChild(DftUInt iIndex, DftUInt iChild) const { return m_Children[m_ChildOffsets[iIndex] + iChild]; }
+
+    /** @brief 字符串池中的字符串 */
+    const char* GetString(DftUInt iStringID) const { return &m_StringData[m_StringOffsets[iStringID]]; }
+    /** @brief 字符串池中的字符串个数 */
+    DftUInt GetStringCount() const { return static_cast<DftUInt>(m_StringOffsets.size()); }
+
+    /** @brief 节点属性在键值对池中的起始位置 */
+    DftUInt GetAttributeBegin(DftUInt iIndex) const { return m_AttributeOffsets[iIndex]; }
+    /** @brief 节点属性在键值对池中的结束位置 */
+    DftUInt GetAttributeEnd(DftUInt iIndex) const { return m_AttributeOffsets[iIndex + 1]; }
+
+    /** @brief 节点PMI在标注数组中的起始位置 */
+    DftUInt GetPMIBegin(DftUInt iIndex) const { return m_PMIOffsets[iIndex]; }
+    /** @brief 节点PMI在标注数组中的结束位置 */
+    DftUInt GetPMIEnd(DftUInt iIndex) const { return m_PMIOffsets[iIndex + 1]; }
+    /** @brief 标注ID */
+    DftUInt64 GetPMIAnnotationID(DftUInt iPMI) const { return m_PMIAnnotationIDs[iPMI]; }
+    /** @brief 标注类型 */
+    const char* GetPMIType(DftUInt iPMI) const { return GetString(m_PMITypeIDs[iPMI]); }
+    /** @brief 标注名称 */
+    const char* GetPMIName(DftUInt iPMI) const { return GetString(m_PMINameIDs[iPMI]); }
+    /** @brief 标注显示模式 */
+    const char* GetPMIViewMode(DftUInt iPMI) const { return GetString(m_PMIViewModeIDs[iPMI]); }
+    /** @brief 标注属性在键值对池中的起始位置 */
+    DftUInt GetPMIPropertyBegin(DftUInt iPMI) const { return m_PMIPropertyOffsets[iPMI]; }
+    /** @brief 标注属性在键值对池中的结束位置 */
+    DftUInt GetPMIPropertyEnd(DftUInt iPMI) const { return m_PMIPropertyOffsets[iPMI + 1]; }
+
+    /** @brief 键值对的键（字符串编号），同一区间内按键名排序 */
+    DftUInt GetPairKey(DftUInt iPair) const { return m_PairKeys[iPair]; }
+    /** @brief 键值对的值（字符串编号） */
+    DftUInt GetPairValue(DftUInt iPair) const { return m_PairValues[iPair]; }
+
+    /** @brief 节点表占用的内存字节数（不含查找用的哈希表） */
+    size_t GetMemoryUsage() const;
+
+private:
+    /** 按字符串池内容计算哈希 */
+    struct StringHash
+    {
+        const CNodeTable* _table;
+        size_t operator()(DftUInt iStringID) const;
+    };
+    /** 按字符串池内容比较 */
+    struct StringEqual
+    {
+        const CNodeTable* _table;
+        bool operator()(DftUInt iLeft, DftUInt iRight) const;
+    };
+
+    CNodeTable(const CNodeTable&);
+    CNodeTable& operator=(const CNodeTable&);
+
+    DftUInt Intern(const std::string& iText);
+    void AddPairs(const std::map<std::string, std::string>& iPairs);
+
+    // 节点字段，下标为节点序号
+    std::vector<DftUInt64> m_NodeIDs;            ///< 节点ID
+    std::vector<DftUInt> m_ParentIndexes;        ///< 父节点序号
+    std::vector<DftUInt64> m_ModelIDs;           ///< 模型ID
+    std::vector<DftUInt8> m_HasModel;            ///< 是否关联模型
+    std::vector<PDVMatrix4F> m_WorldTransforms;  ///< 世界变换
+    std::vector<DftUInt> m_NameIDs;              ///< 节点名称
+    std::vector<DftUInt> m_ModelNameIDs;         ///< 模型名称
+    std::vector<DftUInt> m_AttributeOffsets;     ///< 属性区间，长度为节点数+1
+    std::vector<DftUInt> m_PMIOffsets;           ///< PMI区间，长度为节点数+1
+
+    // 子节点，按父节点连续存放
+    std::vector<DftUInt> m_ChildOffsets;         ///< 子节点区间，长度为节点数+1
+    std::vector<DftUInt> m_Children;             ///< 子节点序号
+
+    // PMI标注
+    std::vector<DftUInt64> m_PMIAnnotationIDs;   ///< 标注ID
+    std::vector<DftUInt> m_PMITypeIDs;           ///< 标注类型
+    std::vector<DftUInt> m_PMINameIDs;           ///< 标注名称
+    std::vector<DftUInt> m_PMIViewModeIDs;       ///< 显示模式
+    std::vector<DftUInt> m_PMIPropertyOffsets;   ///< 标注属性区间，长度为标注数+1
+
+    // 属性与标注属性共用的键值对池
+    std::vector<DftUInt> m_PairKeys;             ///< 键
+    std::vector<DftUInt> m_PairValues;           ///< 值
+
+    // 字符串池，每个字符串以'\0'结尾
+    std::vector<char> m_StringData;              ///< 字符数据
+    std::vector<DftUInt> m_StringOffsets;        ///< 每个字符串的起始位置
+    std::unordered_set<DftUInt, StringHash, StringEqual> m_StringLookup; ///< 字符串去重
+    std::unordered_map<DftUInt64, DftUInt> m_IndexLookup;                ///< 节点ID到序号
+};
+
+#endif
@@ -0,0 +1,431 @@
+#include "pdvnurbs.h"
+#include "PDVIGeomFactory.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PDV_NURBS_SSE2 1
+#include <emmintrin.h>
+#endif
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+// 每批的参数个数，批内的中间结果放在栈上
+const size_t NURBS_BATCH_SIZE = 64;
+
+// 一个参数的基函数及一阶导数，iSpan满足U[span] < U[span+1]，因此递推中的分母都为正
+void EvaluateBasisScalar(const DftDouble* iKnots, int iDegree, DftUInt iSpan, DftDouble iParam, DftDouble* oBasis,
+    DftDouble* oDerivatives)
+{
+    DftDouble left[PDV_NURBS_MAX_DEGREE + 1];
+    DftDouble right[PDV_NURBS_MAX_DEGREE + 1];
+    DftDouble lower[PDV_NURBS_MAX_DEGREE + 1];
+    oBasis[0] = 1.0;
+    lower[0] = 1.0;
+    for (int j = 1; j <= iDegree; j++)
+    {
+        if (j == iDegree)
+        {
+            for (int r = 0; r < j; r++)
+                lower[r] = oBasis[r];
+        }
+        left[j] = iParam - iKnots[iSpan + 1 - j];
+        right[j] = iKnots[iSpan + j] - iParam;
+        DftDouble saved = 0.0;
+        for (int r = 0; r < j; r++)
+        {
+            DftDouble temp = oBasis[r] / (right[r + 1] + left[j - r]);
+            oBasis[r] = saved + right[r + 1] * temp;
+            saved = left[j - r] * temp;
+        }
+        oBasis[j] = saved;
+    }
+
+    // N'(i,p) = p·N(i,p-1)/(U[i+p]-U[i]) - p·N(i+1,p-1)/(U[i+p+1]-U[i+1])，i = span-p+r
+    for (int r = 0; r <= iDegree; r++)
+    {
+        DftDouble d = 0.0;
+        if (r >= 1)
+        {
+            DftDouble den = iKnots[iSpan + r] - iKnots[iSpan + r - iDegree];
+            if (den > 0.0)
+                d += lower[r - 1] / den;
+        }
+        if (r < iDegree)
+        {
+            DftDouble den = iKnots[iSpan + r + 1] - iKnots[iSpan + r + 1 - iDegree];
+            if (den > 0.0)
+                d -= lower[r] / den;
+        }
+        oDerivatives[r] = iDegree * d;
+    }
+}
+
+#if defined(PDV_NURBS_SSE2)
+// 两个参数同步递推，低位为第一个参数；运算次序与EvaluateBasisScalar相同
+void EvaluateBasisPair(const DftDouble* iKnots, int iDegree, const DftUInt* iSpans, const DftDouble* iParams, DftDouble* oBasis,
+    DftDouble* oDerivatives)
+{
+    __m128d n[PDV_NURBS_MAX_DEGREE + 1];
+    __m128d left[PDV_NURBS_MAX_DEGREE + 1];
+    __m128d right[PDV_NURBS_MAX_DEGREE + 1];
+    __m128d lower[PDV_NURBS_MAX_DEGREE + 1];
+    const DftUInt s0 = iSpans[0];
+    const DftUInt s1 = iSpans[1];
+    const __m128d u = _mm_loadu_pd(iParams);
+    const __m128d zero = _mm_setzero_pd();
+    const __m128d one = _mm_set1_pd(1.0);
+    n[0] = one;
+    lower[0] = one;
+    for (int j = 1; j <= iDegree; j++)
+    {
+        if (j == iDegree)
+        {
+            for (int r = 0; r < j; r++)
+                lower[r] = n[r];
+        }
+        left[j] = _mm_sub_pd(u, _mm_set_pd(iKnots[s1 + 1 - j], iKnots[s0 + 1 - j]));
+        right[j] = _mm_sub_pd(_mm_set_pd(iKnots[s1 + j], iKnots[s0 + j]), u);
+        __m128d saved = zero;
+        for (int r = 0; r < j; r++)
+        {
+            __m128d temp = _mm_div_pd(n[r], _mm_add_pd(right[r + 1], left[j - r]));
+            n[r] = _mm_add_pd(saved, _mm_mul_pd(right[r + 1], temp));
+            saved = _mm_mul_pd(left[j - r], temp);
+        }
+        n[j] = saved;
+    }
+
+    const __m128d degree = _mm_set1_pd(static_cast<DftDouble>(iDegree));
+    for (int r = 0; r <= iDegree; r++)
+    {
+        __m128d d = zero;
+        // 分母为0的通道除以1后清零，与标量路径跳过该项的结果相同
+        if (r >= 1)
+        {
+            __m128d den = _mm_set_pd(iKnots[s1 + r] - iKnots[s1 + r - iDegree], iKnots[s0 + r] - iKnots[s0 + r - iDegree]);
+            __m128d valid = _mm_cmpgt_pd(den, zero);
+            den = _mm_or_pd(_mm_and_pd(valid, den), _mm_andnot_pd(valid, one));
+            d = _mm_add_pd(d, _mm_and_pd(valid, _mm_div_pd(lower[r - 1], den)));
+        }
+        if (r < iDegree)
+        {
+            __m128d den = _mm_set_pd(iKnots[s1 + r + 1] - iKnots[s1 + r + 1 - iDegree],
+                iKnots[s0 + r + 1] - iKnots[s0 + r + 1 - iDegree]);
+            __m128d valid = _mm_cmpgt_pd(den, zero);
+            den = _mm_or_pd(_mm_and_pd(valid, den), _mm_andnot_pd(valid, one));
+            d = _mm_sub_pd(d, _mm_and_pd(valid, _mm_div_pd(lower[r], den)));
+        }
+        __m128d derivative = _mm_mul_pd(degree, d);
+        _mm_storel_pd(oDerivatives + r, derivative);
+        _mm_storeh_pd(oDerivatives + iDegree + 1 + r, derivative);
+        _mm_storel_pd(oBasis + r, n[r]);
+        _mm_storeh_pd(oBasis + iDegree + 1 + r, n[r]);
+    }
+}
+#endif
+
+// 齐次坐标的控制点转为三维点和导矢：C = A/w，C' = (A' - w'·C)/w
+void Dehomogenize(const DftDouble* iPoint, const DftDouble* iDerivative, DftDouble* oPoint, DftDouble* oDerivative)
+{
+    DftDouble w = iPoint[3] != 0.0 ? iPoint[3] : 1.0;
+    for (int c = 0; c < 3; c++)
+        oPoint[c] = iPoint[c] / w;
+    if (oDerivative)
+    {
+        for (int c = 0; c < 3; c++)
+            oDerivative[c] = (iDerivative[c] - iDerivative[3] * oPoint[c]) / w;
+    }
+}
+
+// 控制点与权重转为齐次坐标，权重为空时按非有理处理
+bool BuildHomogeneousPoints(const DftDouble* iPoints, size_t iCount, size_t iStride, size_t iDimension,
+    const vector<DftDouble>& iWeights, vector<DftDouble>& oPoints)
+{
+    if (!iWeights.empty() && iWeights.size() != iCount)
+        return false;
+    oPoints.assign(iCount * 4, 0.0);
+    for (size_t i = 0; i < iCount; i++)
+    {
+        DftDouble w = iWeights.empty() ? 1.0 : iWeights[i];
+        if (!(w > 0.0))
+            return false;
+        for (size_t c = 0; c < iDimension; c++)
+            oPoints[i * 4 + c] = iPoints[i * iStride + c] * w;
+        oPoints[i * 4 + 3] = w;
+    }
+    return true;
+}
+
+} // namespace
+
+CBSplineBasis::CBSplineBasis()
+    : m_Degree(0), m_CtrlCount(0), m_Periodic(FALSE)
+{
+}
+
+DftBool CBSplineBasis::Init(DftUInt iDegree, const vector<DftDouble>& iKnots, size_t iCtrlCount, DftBool iPeriodic)
+{
+    m_Knots.clear();
+    m_CtrlCount = 0;
+    if (iDegree > PDV_NURBS_MAX_DEGREE || iCtrlCount <= iDegree)
+        return FALSE;
+
+    if (iKnots.size() == iCtrlCount + iDegree + 1)
+        m_Knots = iKnots;
+    else if (iDegree > 0 && iKnots.size() == iCtrlCount + iDegree - 1)
+    {
+        // 缺少首尾各一个节点，按重复端点补齐
+        m_Knots.reserve(iKnots.size() + 2);
+        m_Knots.push_back(iKnots.front());
+        m_Knots.insert(m_Knots.end(), iKnots.begin(), iKnots.end());
+        m_Knots.push_back(iKnots.back());
+    }
+    else
+        return FALSE;
+
+    for (size_t i = 1; i < m_Knots.size(); i++)
+    {
+        if (!(m_Knots[i] >= m_Knots[i - 1]))
+        {
+            m_Knots.clear();
+            return FALSE;
+        }
+    }
+    if (!(m_Knots[iCtrlCount] > m_Knots[iDegree]))
+    {
+        m_Knots.clear();
+        return FALSE;
+    }
+    m_Degree = iDegree;
+    m_CtrlCount = iCtrlCount;
+    m_Periodic = iPeriodic;
+    return TRUE;
+}
+
+void CBSplineBasis::GetBreakpoints(vector<DftDouble>& oValues) const
+{
+    oValues.clear();
+    for (size_t k = m_Degree; k <= m_CtrlCount; k++)
+    {
+        if (oValues.empty() || m_Knots[k] > oValues.back())
+            oValues.push_back(m_Knots[k]);
+    }
+}
+
+DftDouble CBSplineBasis::Normalize(DftDouble iParam) const
+{
+    DftDouble start = GetStart();
+    DftDouble end = GetEnd();
+    if (m_Periodic && (iParam < start || iParam > end))
+    {
+        DftDouble period = end - start;
+        iParam = start + fmod(iParam - start, period);
+        if (iParam < start)
+            iParam += period;
+    }
+    return iParam < start ? start : (iParam > end ? end : iParam);
+}
+
+DftUInt CBSplineBasis::FindSpan(DftDouble iParam) const
+{
+    // 在U[p+1]..U[n-1]中找第一个大于参数的节点，其前一个即所在区间
+    vector<DftDouble>::const_iterator first = m_Knots.begin() + m_Degree + 1;
+    vector<DftDouble>::const_iterator last = m_Knots.begin() + m_CtrlCount;
+    DftUInt span = static_cast<DftUInt>(upper_bound(first, last, iParam) - m_Knots.begin()) - 1;
+    while (span > m_Degree && !(m_Knots[span] < m_Knots[span + 1]))
+        span--;
+    return span;
+}
+
+void CBSplineBasis::Evaluate(const DftDouble* iParams, size_t iCount, DftUInt* oFirst, DftDouble* oBasis, DftDouble* oDerivatives) const
+{
+    const int degree = static_cast<int>(m_Degree);
+    const size_t width = m_Degree + 1;
+    const DftDouble* knots = &m_Knots[0];
+    DftDouble params[NURBS_BATCH_SIZE];
+    DftUInt spans[NURBS_BATCH_SIZE];
+    for (size_t begin = 0; begin < iCount; begin += NURBS_BATCH_SIZE)
+    {
+        size_t count = min(NURBS_BATCH_SIZE, iCount - begin);
+        for (size_t s = 0; s < count; s++)
+        {
+            params[s] = Normalize(iParams[begin + s]);
+            spans[s] = FindSpan(params[s]);
+            oFirst[begin + s] = spans[s] - m_Degree;
+        }
+
+        DftDouble* basis = oBasis + begin * width;
+        DftDouble* derivatives = oDerivatives + begin * width;
+        size_t s = 0;
+#if defined(PDV_NURBS_SSE2)
+        for (; s + 2 <= count; s += 2)
+            EvaluateBasisPair(knots, degree, spans + s, params + s, basis + s * width, derivatives + s * width);
+#endif
+        for (; s < count; s++)
+            EvaluateBasisScalar(knots, degree, spans[s], params[s], basis + s * width, derivatives + s * width);
+    }
+}
+
+CNurbsCurveEvaluator::CNurbsCurveEvaluator()
+{
+}
+
+DftBool CNurbsCurveEvaluator::Init(DftUInt iDegree, DftBool iPeriodic, const vector<DftDouble>& iKnots, const DftDouble* iPoints,
+    size_t iCount, size_t iStride, size_t iDimension, const vector<DftDouble>& iWeights)
+{
+    m_Points.clear();
+    if (!iCount || !m_Basis.Init(iDegree, iKnots, iCount, iPeriodic))
+        return FALSE;
+    return BuildHomogeneousPoints(iPoints, iCount, iStride, iDimension, iWeights, m_Points) ? TRUE : FALSE;
+}
+
+DftBool CNurbsCurveEvaluator::Init(const NurbsCurveData& iData)
+{
+    const vector<PDVVector3D>& points = iData._ctrlPoints;
+    return Init(iData._degree, iData._periodic ? TRUE : FALSE, iData._knots, points.empty() ? NULL : points[0]._data, points.size(),
+        sizeof(PDVVector3D) / sizeof(DftDouble), 3, iData._weights);
+}
+
+DftBool CNurbsCurveEvaluator::Init(const NurbsCurve2dData& iData)
+{
+    const vector<PDVVector2D>& points = iData._ctrlPoints;
+    return Init(iData._degree, iData._periodic ? TRUE : FALSE, iData._knots, points.empty() ? NULL : points[0]._data, points.size(),
+        sizeof(PDVVector2D) / sizeof(DftDouble), 2, iData._weights);
+}
+
+void CNurbsCurveEvaluator::Evaluate(const DftDouble* iParams, size_t iCount, DftDouble* oPoints, DftDouble* oTangents) const
+{
+    if (m_Points.empty())
+        return;
+    const size_t width = m_Basis.GetDegree() + 1;
+    vector<DftUInt> first(NURBS_BATCH_SIZE);
+    vector<DftDouble> basis(NURBS_BATCH_SIZE * width);
+    vector<DftDouble> derivatives(NURBS_BATCH_SIZE * width);
+    for (size_t begin = 0; begin < iCount; begin += NURBS_BATCH_SIZE)
+    {
+        size_t count = min(NURBS_BATCH_SIZE, iCount - begin);
+        m_Basis.Evaluate(iParams + begin, count, &first[0], &basis[0], &derivatives[0]);
+        for (size_t s = 0; s < count; s++)
+        {
+            DftDouble a[4] = { 0.0, 0.0, 0.0, 0.0 };
+            DftDouble da[4] = { 0.0, 0.0, 0.0, 0.0 };
+            const DftDouble* n = &basis[s * width];
+            const DftDouble* dn = &derivatives[s * width];
+            const DftDouble* p = &m_Points[first[s] * 4];
+            for (size_t r = 0; r < width; r++, p += 4)
+            {
+                for (int c = 0; c < 4; c++)
+                {
+                    a[c] += n[r] * p[c];
+                    da[c] += dn[r] * p[c];
+                }
+            }
+            size_t index = begin + s;
+            Dehomogenize(a, da, oPoints + index * 3, oTangents ? oTangents + index * 3 : NULL);
+        }
+    }
+}
+
+CNurbsSurfaceEvaluator::CNurbsSurfaceEvaluator()
+{
+}
+
+DftBool CNurbsSurfaceEvaluator::Init(const NurbsSurfaceData& iData)
+{
+    m_Points.clear();
+    size_t rows = static_cast<size_t>(iData._ctrlRowCount);
+    size_t columns = static_cast<size_t>(iData._ctrlColumnCount);
+    if (!rows || !columns || iData._ctrlPoints.size() != rows * columns)
+        return FALSE;
+
+    // 行数与U向节点相符时行对应U向，否则按转置处理
+    bool rowsAreU = m_UBasis.Init(iData._uDegree, iData._uKnots, rows, iData._uPeriodic ? TRUE : FALSE) &&
+        m_VBasis.Init(iData._vDegree, iData._vKnots, columns, iData._vPeriodic ? TRUE : FALSE);
+    if (!rowsAreU && !(m_UBasis.Init(iData._uDegree, iData._uKnots, columns, iData._uPeriodic ? TRUE : FALSE) &&
+        m_VBasis.Init(iData._vDegree, iData._vKnots, rows, iData._vPeriodic ? TRUE : FALSE)))
+        return FALSE;
+
+    vector<DftDouble> points;
+    if (!BuildHomogeneousPoints(iData._ctrlPoints[0]._data, iData._ctrlPoints.size(), sizeof(PDVVector3D) / sizeof(DftDouble), 3,
+        iData._weights, points))
+        return FALSE;
+    if (rowsAreU)
+        m_Points.swap(points);
+    else
+    {
+        m_Points.resize(points.size());
+        for (size_t r = 0; r < rows; r++)
+        {
+            for (size_t c = 0; c < columns; c++)
+                copy(&points[(r * columns + c) * 4], &points[(r * columns + c) * 4] + 4, &m_Points[(c * rows + r) * 4]);
+        }
+    }
+    return TRUE;
+}
+
+void CNurbsSurfaceEvaluator::Evaluate(const DftDouble* iU, const DftDouble* iV, size_t iCount, DftDouble* oPoints,
+    DftDouble* oDerivatives) const
+{
+    if (m_Points.empty())
+        return;
+    const size_t uWidth = m_UBasis.GetDegree() + 1;
+    const size_t vWidth = m_VBasis.GetDegree() + 1;
+    const size_t vCount = m_VBasis.GetCtrlCount();
+    vector<DftUInt> uFirst(NURBS_BATCH_SIZE);
+    vector<DftUInt> vFirst(NURBS_BATCH_SIZE);
+    vector<DftDouble> uBasis(NURBS_BATCH_SIZE * uWidth);
+    vector<DftDouble> uDerivatives(NURBS_BATCH_SIZE * uWidth);
+    vector<DftDouble> vBasis(NURBS_BATCH_SIZE * vWidth);
+    vector<DftDouble> vDerivatives(NURBS_BATCH_SIZE * vWidth);
+    for (size_t begin = 0; begin < iCount; begin += NURBS_BATCH_SIZE)
+    {
+        size_t count = min(NURBS_BATCH_SIZE, iCount - begin);
+        m_UBasis.Evaluate(iU + begin, count, &uFirst[0], &uBasis[0], &uDerivatives[0]);
+        m_VBasis.Evaluate(iV + begin, count, &vFirst[0], &vBasis[0], &vDerivatives[0]);
+        for (size_t s = 0; s < count; s++)
+        {
+            // 先沿V向收缩每一行，再沿U向合并：A = ΣNu·(ΣNv·P)，Au = ΣNu'·(ΣNv·P)，Av = ΣNu·(ΣNv'·P)
+            DftDouble a[4] = { 0.0, 0.0, 0.0, 0.0 };
+            DftDouble au[4] = { 0.0, 0.0, 0.0, 0.0 };
+            DftDouble av[4] = { 0.0, 0.0, 0.0, 0.0 };
+            const DftDouble* nu = &uBasis[s * uWidth];
+            const DftDouble* dnu = &uDerivatives[s * uWidth];
+            const DftDouble* nv = &vBasis[s * vWidth];
+            const DftDouble* dnv = &vDerivatives[s * vWidth];
+            for (size_t r = 0; r < uWidth; r++)
+            {
+                DftDouble row[4] = { 0.0, 0.0, 0.0, 0.0 };
+                DftDouble rowV[4] = { 0.0, 0.0, 0.0, 0.0 };
+                const DftDouble* p = &m_Points[((uFirst[s] + r) * vCount + vFirst[s]) * 4];
+                for (size_t c = 0; c < vWidth; c++, p += 4)
+                {
+                    for (int k = 0; k < 4; k++)
+                    {
+                        row[k] += nv[c] * p[k];
+                        rowV[k] += dnv[c] * p[k];
+                    }
+                }
+                for (int k = 0; k < 4; k++)
+                {
+                    a[k] += nu[r] * row[k];
+                    au[k] += dnu[r] * row[k];
+                    av[k] += nu[r] * rowV[k];
+                }
+            }
+            size_t index = begin + s;
+            DftDouble* point = oPoints + index * 3;
+            Dehomogenize(a, au, point, oDerivatives ? oDerivatives + index * 6 : NULL);
+            if (oDerivatives)
+            {
+                DftDouble w = a[3] != 0.0 ? a[3] : 1.0;
+                for (int c = 0; c < 3; c++)
+                    oDerivatives[index * 6 + 3 + c] = (av[c] - av[3] * point[c]) / w;
+            }
+        }
+    }
+}
@@ -0,0 +1,163 @@
+/**
+ * @file pdvnurbs.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：B样条、NURBS曲线和曲面的批量求值
+ * @details 基函数按Cox-de Boor递推（Piegl & Tiller A2.2）计算，递推的倒数第二行即p-1次基函数，由它同时得到一阶导数。
+ *          参数成批处理：先逐个二分查找节点区间，再对整批参数同步执行递推，x86上以SSE2每次处理两个参数，其余平台逐个计算；
+ *          两条路径的运算次序相同，结果与批的划分无关。控制点以齐次坐标（x·w, y·w, z·w, w）存放，有理与非有理共用同一路径。
+ *          节点矢量按完整形式（控制点数+次数+1个）使用，缺少首尾各一个节点的形式（控制点数+次数-1个）在初始化时补齐。
+ *          周期方向的控制点须已展开，参数超出节点范围时周期方向按周期折回，非周期方向夹到端点。
+ */
+
+#ifndef PDVNURBS_H
+#define PDVNURBS_H
+
+#include "DftBase.h"
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+struct NurbsCurveData;
+struct NurbsCurve2dData;
+struct NurbsSurfaceData;
+} // namespace pdv
+} // namespace kernel
+
+/** @brief 支持的最高次数 */
+#define PDV_NURBS_MAX_DEGREE 25
+
+/** @brief 一个参数方向上的B样条基函数 */
+class CBSplineBasis
+{
+public:
+    CBSplineBasis();
+
+    /**
+     * @brief 初始化
+     * @return DftBool 是否成功，次数超出范围、节点个数与控制点数不符或节点递减时为FALSE
+     * @param[in] iDegree 次数
+     * @param[in] iKnots 节点矢量
+     * @param[in] iCtrlCount 控制点数
+     * @param[in] iPeriodic 是否为周期方向
+     */
+    DftBool Init(DftUInt iDegree, const std::vector<DftDouble>& iKnots, size_t iCtrlCount, DftBool iPeriodic);
+
+    /** @brief 次数 */
+    DftUInt GetDegree() const { return m_Degree; }
+    /** @brief 控制点数 */
+    size_t GetCtrlCount() const { return m_CtrlCount; }
+    /** @brief 参数范围的起点 */
+    DftDouble GetStart() const { return m_Knots[m_Degree]; }
+    /** @brief 参数范围的终点 */
+    DftDouble GetEnd() const { return m_Knots[m_CtrlCount]; }
+    /** @brief 是否为周期方向 */
+    DftBool IsPeriodic() const { return m_Periodic; }
+
+    /**
+     * @brief 参数范围内互不相同的节点，含首尾，相邻两个之间基函数是多项式
+     * @param[out] oValues 从小到大的节点值
+     */
+    void GetBreakpoints(std::vector<DftDouble>& oValues) const;
+
+    /**
+     * @brief 批量计算非零基函数及其一阶导数
+     * @param[in] iParams 参数
+     * @param[in] iCount 参数个数
+     * @param[out] oFirst 每个参数第一个非零基函数的序号
+     * @param[out] oBasis 基函数，每个参数GetDegree()+1个，依次对应序号oFirst起的控制点
+     * @param[out] oDerivatives 基函数的一阶导数，排列同oBasis
+     */
+    void Evaluate(const DftDouble* iParams, size_t iCount, DftUInt* oFirst, DftDouble* oBasis, DftDouble* oDerivatives) const;
+
+private:
+    /** 按周期折回或夹到参数范围内 */
+    DftDouble Normalize(DftDouble iParam) const;
+    /** 满足U[k] <= u < U[k+1]的节点区间k，参数为终点时取最后一个非空区间 */
+    DftUInt FindSpan(DftDouble iParam) const;
+
+    DftUInt m_Degree;               ///< 次数
+    size_t m_CtrlCount;             ///< 控制点数
+    DftBool m_Periodic;             ///< 是否为周期方向
+    std::vector<DftDouble> m_Knots; ///< 完整的节点矢量
+};
+
+/** @brief NURBS曲线的批量求值，二维曲线的z分量为0 */
+class CNurbsCurveEvaluator
+{
+public:
+    CNurbsCurveEvaluator();
+
+    /**
+     * @brief 由三维NURBS曲线数据初始化
+     * @return DftBool 是否成功，数据不完整时为FALSE
+     * @param[in] iData 曲线数据
+     */
+    DftBool Init(const kernel::pdv::NurbsCurveData& iData);
+
+    /**
+     * @brief 由二维NURBS曲线数据初始化
+     * @return DftBool 是否成功，数据不完整时为FALSE
+     * @param[in] iData 曲线数据
+     */
+    DftBool Init(const kernel::pdv::NurbsCurve2dData& iData);
+
+    /** @brief 基函数 */
+    const CBSplineBasis& GetBasis() const { return m_Basis; }
+
+    /**
+     * @brief 批量求值
+     * @param[in] iParams 参数
+     * @param[in] iCount 参数个数
+     * @param[out] oPoints 曲线上的点，每个参数3个分量
+     * @param[out] oTangents 一阶导矢，每个参数3个分量，可为NULL
+     */
+    void Evaluate(const DftDouble* iParams, size_t iCount, DftDouble* oPoints, DftDouble* oTangents) const;
+
+private:
+    /** 按控制点、权重和节点建立，iPoints每iStride个分量为一个控制点，取前iDimension个 */
+    DftBool Init(DftUInt iDegree, DftBool iPeriodic, const std::vector<DftDouble>& iKnots, const DftDouble* iPoints, size_t iCount,
+        size_t iStride, size_t iDimension, const std::vector<DftDouble>& iWeights);
+
+    CBSplineBasis m_Basis;            ///< 基函数
+    std::vector<DftDouble> m_Points;  ///< 齐次坐标的控制点，每个4个分量
+};
+
+/** @brief NURBS曲面的批量求值 */
+class CNurbsSurfaceEvaluator
+{
+public:
+    CNurbsSurfaceEvaluator();
+
+    /**
+     * @brief 初始化
+     * @return DftBool 是否成功，数据不完整时为FALSE
+     * @param[in] iData 曲面数据
+     * @note 控制点按行存放，行数与U向节点相符时行对应U向，否则与V向节点相符时行对应V向
+     */
+    DftBool Init(const kernel::pdv::NurbsSurfaceData& iData);
+
+    /** @brief U向基函数 */
+    const CBSplineBasis& GetUBasis() const { return m_UBasis; }
+    /** @brief V向基函数 */
+    const CBSplineBasis& GetVBasis() const { return m_VBasis; }
+
+    /**
+     * @brief 批量求值
+     * @param[in] iU U参数
+     * @param[in] iV V参数
+     * @param[in] iCount 参数个数
+     * @param[out] oPoints 曲面上的点，每个参数3个分量
+     * @param[out] oDerivatives U、V方向的一阶偏导，每个参数6个分量，可为NULL
+     */
+    void Evaluate(const DftDouble* iU, const DftDouble* iV, size_t iCount, DftDouble* oPoints, DftDouble* oDerivatives) const;
+
+private:
+    CBSplineBasis m_UBasis;           ///< U向基函数
+    CBSplineBasis m_VBasis;           ///< V向基函数
+    std::vector<DftDouble> m_Points;  ///< 齐次坐标的控制点，按U向序号*V向个数+V向序号排列，每个4个分量
+};
+
+#endif
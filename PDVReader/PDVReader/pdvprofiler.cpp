@@ -0,0 +1,239 @@
+#include "pdvprofiler.h"
+#include "pdvfilewriter.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+using namespace std;
+
+atomic<bool> g_ProfilerEnabled(false);
+
+namespace
+{
+
+const char* const PHASE_NAMES[PROFILE_PHASE_COUNT] = {
+    "load", "traversal", "vertexFetch", "indexFetch", "transform", "serialize", "write", "simplify",
+};
+
+const char* const COUNTER_NAMES[PROFILE_COUNTER_COUNT] = {
+    "nodes", "vertexes", "indexes", "triangles", "bytesWritten",
+};
+
+/** 一个线程的统计记录，只有所属线程写入，报告时其他线程可以随时读取 */
+struct ThreadProfile
+{
+    DftUInt _thread;                                    ///< 线程序号，按第一次记录的顺序分配
+    atomic<DftUInt64> _calls[PROFILE_PHASE_COUNT];      ///< 作用域次数
+    atomic<DftUInt64> _nanos[PROFILE_PHASE_COUNT];      ///< 总耗时，包含嵌套的子阶段
+    atomic<DftUInt64> _selfNanos[PROFILE_PHASE_COUNT];  ///< 自身耗时，不含嵌套的子阶段
+    atomic<DftUInt64> _counters[PROFILE_COUNTER_COUNT]; ///< 计数
+    CProfileScope* _current;                            ///< 当前最内层的作用域
+
+    explicit ThreadProfile(DftUInt iThread) : _thread(iThread), _current(NULL) { Reset(); }
+
+    void Reset()
+    {
+        for (int p = 0; p < PROFILE_PHASE_COUNT; p++)
+        {
+            _calls[p].store(0, memory_order_relaxed);
+            _nanos[p].store(0, memory_order_relaxed);
+            _selfNanos[p].store(0, memory_order_relaxed);
+        }
+        for (int c = 0; c < PROFILE_COUNTER_COUNT; c++)
+            _counters[c].store(0, memory_order_relaxed);
+    }
+};
+
+// 只有一个写入者，不需要带锁的读改写指令
+inline void Accumulate(atomic<DftUInt64>& ioValue, DftUInt64 iDelta)
+{
+    ioValue.store(ioValue.load(memory_order_relaxed) + iDelta, memory_order_relaxed);
+}
+
+/** 所有线程的统计记录，线程结束后记录仍保留到报告输出 */
+struct ProfileRegistry
+{
+    mutex _mutex;
+    vector<unique_ptr<ThreadProfile> > _threads;
+    chrono::steady_clock::time_point _start;
+    string _reportPath;
+};
+
+ProfileRegistry& GetRegistry()
+{
+    static ProfileRegistry registry;
+    return registry;
+}
+
+thread_local ThreadProfile* t_Profile = NULL;
+
+ThreadProfile& GetThreadProfile()
+{
+    if (!t_Profile)
+    {
+        ProfileRegistry& registry = GetRegistry();
+        lock_guard<mutex> lock(registry._mutex);
+        registry._threads.push_back(unique_ptr<ThreadProfile>(new ThreadProfile(static_cast<DftUInt>(registry._threads.size()))));
+        t_Profile = registry._threads.back().get();
+    }
+    return *t_Profile;
+}
+
+inline DftUInt64 NowNanos()
+{
+    return static_cast<DftUInt64>(
+        chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void AddPhases(DftJson iParent, const DftUInt64* iCalls, const DftUInt64* iNanos, const DftUInt64* iSelfNanos)
+{
+    DftJson phases = DftJsonAddObjectToObject(iParent, "phases");
+    for (int p = 0; p < PROFILE_PHASE_COUNT; p++)
+    {
+        DftJson phase = DftJsonAddObjectToObject(phases, PHASE_NAMES[p]);
+        DftJsonAddNumberToObject(phase, "calls", static_cast<DftDouble>(iCalls[p]));
+        DftJsonAddNumberToObject(phase, "seconds", iNanos[p] * 1e-9);
+        DftJsonAddNumberToObject(phase, "selfSeconds", iSelfNanos[p] * 1e-9);
+    }
+}
+
+void AddCounters(DftJson iParent, const DftUInt64* iCounters)
+{
+    DftJson counters = DftJsonAddObjectToObject(iParent, "counters");
+    for (int c = 0; c < PROFILE_COUNTER_COUNT; c++)
+        DftJsonAddNumberToObject(counters, COUNTER_NAMES[c], static_cast<DftDouble>(iCounters[c]));
+}
+
+void WriteProfileAtExit()
+{
+    EnableProfiler(FALSE);
+    WriteProfileReport(GetRegistry()._reportPath);
+}
+
+} // namespace
+
+void EnableProfiler(DftBool iEnable)
+{
+    if (iEnable && !g_ProfilerEnabled.load(memory_order_relaxed))
+        GetRegistry()._start = chrono::steady_clock::now();
+    g_ProfilerEnabled.store(iEnable ? true : false, memory_order_relaxed);
+}
+
+void ResetProfiler()
+{
+    ProfileRegistry& registry = GetRegistry();
+    lock_guard<mutex> lock(registry._mutex);
+    for (size_t t = 0; t < registry._threads.size(); t++)
+        registry._threads[t]->Reset();
+    registry._start = chrono::steady_clock::now();
+}
+
+DftBool StartProfilerFromEnvironment()
+{
+    const char* path = getenv("PDV_PROFILE");
+    if (!path || !*path)
+        return FALSE;
+
+    // 先构造登记表再注册退出函数，保证退出函数执行时登记表尚未析构
+    GetRegistry()._reportPath = path;
+    atexit(WriteProfileAtExit);
+    EnableProfiler(TRUE);
+    return TRUE;
+}
+
+void AddProfileCountSlow(ProfileCounter iCounter, DftUInt64 iValue)
+{
+    Accumulate(GetThreadProfile()._counters[iCounter], iValue);
+}
+
+void CProfileScope::Begin(ProfilePhase iPhase)
+{
+    ThreadProfile& profile = GetThreadProfile();
+    m_Phase = iPhase;
+    m_ChildNanos = 0;
+    m_Parent = profile._current;
+    profile._current = this;
+    m_Start = NowNanos();
+}
+
+void CProfileScope::End()
+{
+    DftUInt64 elapsed = NowNanos() - m_Start;
+    ThreadProfile& profile = *t_Profile;
+    profile._current = m_Parent;
+    if (m_Parent)
+        m_Parent->m_ChildNanos += elapsed;
+    Accumulate(profile._calls[m_Phase], 1);
+    Accumulate(profile._nanos[m_Phase], elapsed);
+    Accumulate(profile._selfNanos[m_Phase], elapsed > m_ChildNanos ? elapsed - m_ChildNanos : 0);
+}
+
+DftJson BuildProfileReport()
+{
+    ProfileRegistry& registry = GetRegistry();
+    lock_guard<mutex> lock(registry._mutex);
+
+    DftJson root = DftJsonCreateObject();
+    DftJsonAddNumberToObject(root, "wallSeconds",
+        chrono::duration<DftDouble>(chrono::steady_clock::now() - registry._start).count());
+    DftJsonAddNumberToObject(root, "threadCount", static_cast<DftDouble>(registry._threads.size()));
+
+    DftUInt64 calls[PROFILE_PHASE_COUNT] = { 0 };
+    DftUInt64 nanos[PROFILE_PHASE_COUNT] = { 0 };
+    DftUInt64 selfNanos[PROFILE_PHASE_COUNT] = { 0 };
+    DftUInt64 counters[PROFILE_COUNTER_COUNT] = { 0 };
+    DftJson threads = DftJsonCreateArray();
+    for (size_t t = 0; t < registry._threads.size(); t++)
+    {
+        const ThreadProfile& profile = *registry._threads[t];
+        DftUInt64 threadCalls[PROFILE_PHASE_COUNT];
+        DftUInt64 threadNanos[PROFILE_PHASE_COUNT];
+        DftUInt64 threadSelfNanos[PROFILE_PHASE_COUNT];
+        DftUInt64 threadCounters[PROFILE_COUNTER_COUNT];
+        for (int p = 0; p < PROFILE_PHASE_COUNT; p++)
+        {
+            threadCalls[p] = profile._calls[p].load(memory_order_relaxed);
+            threadNanos[p] = profile._nanos[p].load(memory_order_relaxed);
+            threadSelfNanos[p] = profile._selfNanos[p].load(memory_order_relaxed);
+            calls[p] += threadCalls[p];
+            nanos[p] += threadNanos[p];
+            selfNanos[p] += threadSelfNanos[p];
+        }
+        for (int c = 0; c < PROFILE_COUNTER_COUNT; c++)
+        {
+            threadCounters[c] = profile._counters[c].load(memory_order_relaxed);
+            counters[c] += threadCounters[c];
+        }
+
+        DftJson thread = DftJsonCreateObject();
+        DftJsonAddNumberToObject(thread, "thread", profile._thread);
+        AddPhases(thread, threadCalls, threadNanos, threadSelfNanos);
+        AddCounters(thread, threadCounters);
+        DftJsonAddItemToArray(threads, thread);
+    }
+
+    // 汇总的耗时是各线程之和，多线程阶段可能超过墙钟时间
+    AddPhases(root, calls, nanos, selfNanos);
+    AddCounters(root, counters);
+    DftJsonAddItemToObject(root, "threads", threads);
+    return root;
+}
+
+DftBool WriteProfileReport(const string& iPath)
+{
+    DftJson report = BuildProfileReport();
+    DftUTF8Char* text = DftJsonPrint(report);
+    DftBool result = FALSE;
+    CBufferedFileWriter writer;
+    if (text && writer.Open(iPath))
+    {
+        writer.Write(text, strlen(text));
+        result = writer.Close();
+    }
+    // DftBase没有提供释放DftJsonPrint结果的接口，报告通常只在退出时生成一次
+    DftJsonDelete(&report);
+    return result;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file pdvprofiler.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：导出热点路径的分阶段计时与计数
+ * @details 加载、模型树遍历、顶点与索引读取、矩阵变换、编码、写盘和网格简化各为一个阶段，用PDV_PROFILE_SCOPE在作用域内计时，
+ *          嵌套的作用域同时记录包含子阶段的总耗时和扣除子阶段后的自身耗时。计时和计数先累加到线程自己的记录中，
+ *          不同线程之间不争用，输出报告时再汇总。未启用时每个作用域只读取一次启用标志；
+ *          定义PDV_PROFILE_DISABLED时宏展开为空，完全没有开销。
+ *          设置环境变量PDV_PROFILE为报告路径即可启用，进程退出时通过DftJson写出JSON报告。
+ */
+
+#ifndef PDVPROFILER_H
+#define PDVPROFILER_H
+
+#include "DftBase.h"
+#include "DftJson.h"
+#include <atomic>
+#include <string>
+
+/** @brief 计时阶段 */
+enum ProfilePhase
+{
+    PROFILE_PHASE_LOAD = 0,         ///< 加载pdv文件
+    PROFILE_PHASE_TRAVERSAL = 1,    ///< 模型树遍历，自身耗时包含输出对象中未单独计时的部分
+    PROFILE_PHASE_VERTEX_FETCH = 2, ///< 读取顶点数据（GetVertexesBuffer/GetVertexes）
+    PROFILE_PHASE_INDEX_FETCH = 3,  ///< 读取索引数据（GetIndexes）
+    PROFILE_PHASE_TRANSFORM = 4,    ///< 顶点变换到世界坐标系
+    PROFILE_PHASE_SERIALIZE = 5,    ///< 编码为输出格式
+    PROFILE_PHASE_WRITE = 6,        ///< 写盘
+    PROFILE_PHASE_SIMPLIFY = 7,     ///< 网格简化
+    PROFILE_PHASE_COUNT = 8,        ///< 阶段个数
+};
+
+/** @brief 计数项 */
+enum ProfileCounter
+{
+    PROFILE_COUNTER_NODES = 0,         ///< 遍历的节点数
+    PROFILE_COUNTER_VERTEXES = 1,      ///< 读取的顶点数
+    PROFILE_COUNTER_INDEXES = 2,       ///< 读取的索引数
+    PROFILE_COUNTER_TRIANGLES = 3,     ///< 编码输出的三角面数
+    PROFILE_COUNTER_BYTES_WRITTEN = 4, ///< 写盘字节数
+    PROFILE_COUNTER_COUNT = 5,         ///< 计数项个数
+};
+
+/** @brief 是否启用，只由EnableProfiler修改 */
+extern std::atomic<bool> g_ProfilerEnabled;
+
+/** @brief 是否启用 */
+inline DftBool IsProfilerEnabled()
+{
+    return g_ProfilerEnabled.load(std::memory_order_relaxed) ? TRUE : FALSE;
+}
+
+/**
+ * @brief 启用或停用，启用时从当前时刻开始统计墙钟时间
+ * @param[in] iEnable 是否启用
+ */
+void EnableProfiler(DftBool iEnable);
+
+/** @brief 清空所有线程的统计结果 */
+void ResetProfiler();
+
+/**
+ * @brief 按环境变量PDV_PROFILE启用，并在进程退出时把报告写到该路径
+ * @return DftBool 是否已启用
+ */
+DftBool StartProfilerFromEnvironment();
+
+/**
+ * @brief 累加当前线程的计数，未启用时不记录
+ * @param[in] iCounter 计数项
+ * @param[in] iValue 增量
+ */
+void AddProfileCountSlow(ProfileCounter iCounter, DftUInt64 iValue);
+
+/** @brief 累加当前线程的计数，未启用时不记录 */
+inline void AddProfileCount(ProfileCounter iCounter, DftUInt64 iValue)
+{
+    if (g_ProfilerEnabled.load(std::memory_order_relaxed))
+        AddProfileCountSlow(iCounter, iValue);
+}
+
+/**
+ * @brief 生成汇总报告
+ * @return DftJson 报告根节点，使用完毕后调用DftJsonDelete释放
+ */
+DftJson BuildProfileReport();
+
+/**
+ * @brief 把汇总报告写成JSON文件
+ * @return DftBool 是否成功
+ * @param[in] iPath 报告路径
+ */
+DftBool WriteProfileReport(const std::string& iPath);
+
+/**
+ * @brief 作用域计时，析构时累加到当前线程对应阶段的记录中
+ * @note 只能在栈上创建，同一线程内的作用域必须严格嵌套
+ */
+class CProfileScope
+{
+public:
+    explicit CProfileScope(ProfilePhase iPhase) : m_Active(g_ProfilerEnabled.load(std::memory_order_relaxed))
+    {
+        if (m_Active)
+            Begin(iPhase);
+    }
+
+    ~CProfileScope()
+    {
+        if (m_Active)
+            End();
+    }
+
+private:
+    void Begin(ProfilePhase iPhase);
+    void End();
+
+    CProfileScope(const CProfileScope&);
+    CProfileScope& operator=(const CProfileScope&);
+
+private:
+    bool m_Active;           ///< 构造时是否已启用
+    ProfilePhase m_Phase;    ///< 阶段
+    DftUInt64 m_Start;       ///< 开始时刻（纳秒）
+    DftUInt64 m_ChildNanos;  ///< 嵌套的子作用域耗时（纳秒）
+    CProfileScope* m_Parent; ///< 外层作用域
+};
+
+#define PDV_PROFILE_CONCAT_INNER(a, b) a##b
+#define PDV_PROFILE_CONCAT(a, b) PDV_PROFILE_CONCAT_INNER(a, b)
+
+#ifdef PDV_PROFILE_DISABLED
+#define PDV_PROFILE_SCOPE(phase)
+#define PDV_PROFILE_COUNT(counter, value)
+#else
+/** @brief 在当前作用域内按阶段计时 */
+#define PDV_PROFILE_SCOPE(phase) CProfileScope PDV_PROFILE_CONCAT(profileScope_, __LINE__)(phase)
+/** @brief 累加计数 */
+#define PDV_PROFILE_COUNT(counter, value) AddProfileCount(counter, value)
+#endif
+
+#endif
@@ -0,0 +1,343 @@
+#include "pdvscenegen.h"
+#include "pdvmemscene.h"
+#include "PDVIModelTree.h"
+#include "PDVIModelTreeNode.h"
+#include "PDVIModel.h"
+#include "PDVIRenderBody.h"
+#include "PDVIRenderMesh.h"
+#include "PDVIRenderGeometry.h"
+#include "PDVIRenderVertex.h"
+#include "PDVIAttribute.h"
+#include "PDVIAttributeGroup.h"
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+/** 单个场景允许的节点数上限，防止参数错误时耗尽内存 */
+const DftUInt64 SCENE_GEN_MAX_NODES = 100000000;
+
+/** 零件网格的边长 */
+const DftFloat PART_SIZE = 1.0f;
+
+/** 可重复的伪随机数（splitmix64） */
+class CSceneRandom
+{
+public:
+    explicit CSceneRandom(DftUInt64 iSeed) : m_State(iSeed) {}
+
+    DftUInt64 Next()
+    {
+        DftUInt64 z = (m_State += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+
+    /** [0, 1)之间的浮点数 */
+    DftFloat NextFloat() { return static_cast<DftFloat>((Next() >> 40) * (1.0 / 16777216.0)); }
+
+private:
+    DftUInt64 m_State;
+};
+
+// 行向量约定下的矩阵乘法：先做iA的变换，再做iB的变换
+PDVMatrix4F MultiplyMatrix(const PDVMatrix4F& iA, const PDVMatrix4F& iB)
+{
+    PDVMatrix4F result;
+    for (int r = 0; r < 4; r++)
+    {
+        for (int c = 0; c < 4; c++)
+        {
+            DftFloat sum = 0.0f;
+            for (int k = 0; k < 4; k++)
+                sum += iA._data[r][k] * iB._data[k][c];
+            result._data[r][c] = sum;
+        }
+    }
+    return result;
+}
+
+// 绕Z轴旋转后平移的局部矩阵
+PDVMatrix4F MakeLocalTransform(DftFloat iAngle, DftFloat iX, DftFloat iY, DftFloat iZ)
+{
+    PDVMatrix4F matrix;
+    matrix.SetIdentity();
+    DftFloat c = cos(iAngle);
+    DftFloat s = sin(iAngle);
+    matrix._data[0][0] = c;
+    matrix._data[0][1] = s;
+    matrix._data[1][0] = -s;
+    matrix._data[1][1] = c;
+    matrix._data[3][0] = iX;
+    matrix._data[3][1] = iY;
+    matrix._data[3][2] = iZ;
+    return matrix;
+}
+
+// 起伏网格面：rows×cols个四边形，每个四边形两个三角面，超出iTriangleCount的三角面舍去
+void BuildPartGeometry(DftUInt iTriangleCount, DftUInt iVariant, vector<VertexData>& oVertexes, vector<DftUInt32>& oIndexes)
+{
+    DftUInt quads = (iTriangleCount + 1) / 2;
+    DftUInt cols = static_cast<DftUInt>(ceil(sqrt(static_cast<double>(quads))));
+    cols = cols > 0 ? cols : 1;
+    DftUInt rows = (quads + cols - 1) / cols;
+    rows = rows > 0 ? rows : 1;
+
+    // 不同几何的起伏频率不同，避免生成的几何数据完全相同
+    DftFloat frequency = 2.0f + static_cast<DftFloat>(iVariant % 17) * 0.25f;
+    DftFloat amplitude = 0.05f * PART_SIZE;
+    oVertexes.resize(static_cast<size_t>(rows + 1) * (cols + 1));
+    for (DftUInt r = 0; r <= rows; r++)
+    {
+        for (DftUInt c = 0; c <= cols; c++)
+        {
+            DftFloat u = static_cast<DftFloat>(c) / cols;
+            DftFloat v = static_cast<DftFloat>(r) / rows;
+            DftFloat su = sin(frequency * u);
+            DftFloat cv = cos(frequency * v);
+            VertexData& vertex = oVertexes[r * (cols + 1) + c];
+            vertex.Clear();
+            vertex._position = PDVVector3F(u * PART_SIZE, v * PART_SIZE, amplitude * su * cv);
+
+            // 高度场z = f(x, y)的法向为(-dz/dx, -dz/dy, 1)
+            DftFloat dzdx = amplitude * frequency * cos(frequency * u) * cv / PART_SIZE;
+            DftFloat dzdy = -amplitude * frequency * su * sin(frequency * v) / PART_SIZE;
+            DftFloat length = sqrt(dzdx * dzdx + dzdy * dzdy + 1.0f);
+            vertex._normal = PDVVector3F(-dzdx / length, -dzdy / length, 1.0f / length);
+            vertex._uv = PDVVector2F(u, v);
+        }
+    }
+
+    oIndexes.clear();
+    oIndexes.reserve(static_cast<size_t>(iTriangleCount) * 3);
+    for (DftUInt q = 0; q < quads; q++)
+    {
+        DftUInt32 v00 = (q / cols) * (cols + 1) + q % cols;
+        DftUInt32 v01 = v00 + 1;
+        DftUInt32 v10 = v00 + cols + 1;
+        DftUInt32 v11 = v10 + 1;
+        oIndexes.push_back(v00);
+        oIndexes.push_back(v01);
+        oIndexes.push_back(v11);
+        if (oIndexes.size() / 3 == iTriangleCount)
+            break;
+        oIndexes.push_back(v00);
+        oIndexes.push_back(v11);
+        oIndexes.push_back(v10);
+    }
+}
+
+/** 装配树中待展开的节点 */
+struct PendingNode
+{
+    IModelTreeNode* _node;    ///< 节点
+    PDVMatrix4F _world;       ///< 世界矩阵
+    DftUInt _level;           ///< 层号
+    DftFloat _spacing;        ///< 子节点之间的间距
+};
+
+/** 场景生成过程 */
+class CSceneGenerator
+{
+public:
+    CSceneGenerator(IMemSceneData* iSceneData, const SceneGenOptions& iOptions, const SceneGenStatistics& iEstimate)
+        : m_SceneData(iSceneData), m_Options(iOptions), m_Statistics(iEstimate), m_Random(iOptions._seed), m_PartIndex(0)
+    {
+    }
+
+    DftBool Run()
+    {
+        BuildGeometries();
+
+        IModelTree* tree = m_SceneData->CreateModelTree(CUnicodeString("Assembly"));
+        IModelTreeNode* root = NULL;
+        if (tree->AddNode(CUnicodeString("Root"), NULL, root) != PDV_RESULT_NO_ERROR)
+            return FALSE;
+
+        PendingNode pending;
+        pending._node = root;
+        pending._world.SetIdentity();
+        pending._level = 0;
+        pending._spacing = RootSpacing();
+        root->SetLocalTransform(pending._world);
+        root->SetWorldTransform(pending._world);
+        if (m_Options._depth == 0)
+            AttachPart(root);
+
+        // 深度优先展开，栈的大小只与层数和子节点数有关
+        vector<PendingNode> stack;
+        stack.push_back(pending);
+        while (!stack.empty())
+        {
+            PendingNode parent = stack.back();
+            stack.pop_back();
+            if (parent._level >= m_Options._depth)
+                continue;
+            DftUInt side = GridSide();
+            for (DftUInt i = 0; i < m_Options._fanOut; i++)
+            {
+                DftUInt level = parent._level + 1;
+                DftBool part = level == m_Options._depth;
+                string name = (part ? "Part_" : "Assembly_") + to_string(level) + "_" + to_string(i);
+                IModelTreeNode* node = NULL;
+                if (tree->AddNode(CUnicodeString(name.c_str()), parent._node, node) != PDV_RESULT_NO_ERROR)
+                    return FALSE;
+
+                // 子节点在父节点的局部坐标系内排成方阵，朝向随机
+                DftFloat x = static_cast<DftFloat>(i % side) * parent._spacing;
+                DftFloat y = static_cast<DftFloat>(i / side) * parent._spacing;
+                DftFloat angle = m_Random.NextFloat() * 6.2831853f;
+                PDVMatrix4F local = MakeLocalTransform(angle, x, y, 0.0f);
+                PendingNode child;
+                child._node = node;
+                child._world = MultiplyMatrix(local, parent._world);
+                child._level = level;
+                child._spacing = parent._spacing / (side + 1);
+                node->SetLocalTransform(local);
+                node->SetWorldTransform(child._world);
+                if (part)
+                    AttachPart(node);
+                else
+                    stack.push_back(child);
+            }
+        }
+        return TRUE;
+    }
+
+    const SceneGenStatistics& GetStatistics() const { return m_Statistics; }
+
+private:
+    // 子节点方阵的边长
+    DftUInt GridSide() const
+    {
+        DftUInt side = static_cast<DftUInt>(ceil(sqrt(static_cast<double>(m_Options._fanOut))));
+        return side > 0 ? side : 1;
+    }
+
+    // 根节点下子节点的间距，保证最深一层的零件之间仍有间隙
+    DftFloat RootSpacing() const
+    {
+        DftFloat spacing = 2.0f * PART_SIZE;
+        for (DftUInt level = 1; level < m_Options._depth; level++)
+            spacing *= static_cast<DftFloat>(GridSide() + 1);
+        return spacing;
+    }
+
+    void BuildGeometries()
+    {
+        vector<VertexData> vertexes;
+        vector<DftUInt32> indexes;
+        m_GeometryIDs.reserve(static_cast<size_t>(m_Statistics._uniqueGeometryCount));
+        for (DftUInt64 g = 0; g < m_Statistics._uniqueGeometryCount; g++)
+        {
+            BuildPartGeometry(m_Options._trianglesPerPart, static_cast<DftUInt>(g), vertexes, indexes);
+            IRenderVertex* vertex = m_SceneData->CreateRenderVertex(RENDER_VERTEX_MASK_POSITION | RENDER_VERTEX_MASK_NORMAL);
+            vertex->SetVertexes(vertexes);
+            IRenderGeometry* geometry = m_SceneData->CreateRenderGeometry();
+            geometry->SetIndexes(indexes);
+            geometry->SetVertexID(vertex->GetID());
+            m_GeometryIDs.push_back(geometry->GetID());
+        }
+    }
+
+    // 零件：模型 → 渲染主体 → 主体网格 → 渲染几何，实例化的零件共用渲染几何
+    void AttachPart(IModelTreeNode* iNode)
+    {
+        DftUInt64 partIndex = m_PartIndex++;
+        string name = "Part_" + to_string(partIndex);
+        IModel* model = m_SceneData->CreateModel(CUnicodeString(name.c_str()));
+
+        IRenderMesh* mesh = m_SceneData->CreateRenderMesh(RENDER_MESH_TYPE_MAIN);
+        RenderGeomInfoArray geomInfos(1);
+        geomInfos[0]._renderGeometryID = m_GeometryIDs[partIndex % m_GeometryIDs.size()];
+        geomInfos[0]._lodDetail = 1.0f;
+        mesh->SetRenderGeomeInfoArray(geomInfos);
+        OrientedBoundingBox box;
+        box._center = PDVVector3F(0.5f * PART_SIZE, 0.5f * PART_SIZE, 0.0f);
+        box._axisX = PDVVector3F(0.5f * PART_SIZE, 0.0f, 0.0f);
+        box._axisY = PDVVector3F(0.0f, 0.5f * PART_SIZE, 0.0f);
+        box._axisZ = PDVVector3F(0.0f, 0.0f, 0.05f * PART_SIZE);
+        mesh->SetBox(box);
+
+        IRenderBody* body = m_SceneData->CreateRenderBody();
+        body->SetName(CUnicodeString(name.c_str()));
+        body->SetFaceMeshIDs(vector<DftUInt64>(1, mesh->GetID()));
+        model->AddRenderBodyID(body->GetID());
+        model->SetExtendBitMask(MODEL_MASK_EXTEND_RENDERBODY);
+
+        BoundingBox modelBox;
+        modelBox._min = PDVVector3F(0.0f, 0.0f, -0.05f * PART_SIZE);
+        modelBox._max = PDVVector3F(PART_SIZE, PART_SIZE, 0.05f * PART_SIZE);
+        model->SetBoundingBox(modelBox);
+
+        if (m_Options._attributeCount > 0)
+        {
+            IAttribute* attribute = m_SceneData->CreateAttribute();
+            IAttributeGroup* group = NULL;
+            attribute->AddAttributeGroup(CUnicodeString("Properties"), group);
+            for (DftUInt a = 0; a < m_Options._attributeCount; a++)
+            {
+                string key = "Attribute" + to_string(a);
+                string value = name + "_" + to_string(m_Random.Next() % 100000);
+                IAttributeItem* item = NULL;
+                group->AddStringAttributeItem(CUnicodeString(key.c_str()), CUnicodeString(value.c_str()), item);
+            }
+            model->SetAttributeID(attribute->GetID());
+            model->SetBitMask(MODEL_MASK_ATTRIBUTE);
+        }
+        iNode->SetModelID(model->GetID());
+    }
+
+private:
+    IMemSceneData* m_SceneData;
+    SceneGenOptions m_Options;
+    SceneGenStatistics m_Statistics;
+    CSceneRandom m_Random;
+    vector<DftUInt64> m_GeometryIDs; ///< 全部渲染几何，零件按序号轮流使用
+    DftUInt64 m_PartIndex;
+};
+
+} // namespace
+
+DftBool EstimateScene(const SceneGenOptions& iOptions, SceneGenStatistics& oStatistics)
+{
+    oStatistics = SceneGenStatistics();
+    if (iOptions._fanOut == 0 || iOptions._trianglesPerPart == 0 || iOptions._instancingRatio < 0.0 ||
+        iOptions._instancingRatio > 1.0)
+        return FALSE;
+
+    DftUInt64 levelCount = 1;
+    oStatistics._nodeCount = 1;
+    for (DftUInt level = 1; level <= iOptions._depth; level++)
+    {
+        levelCount *= iOptions._fanOut;
+        oStatistics._nodeCount += levelCount;
+        if (oStatistics._nodeCount > SCENE_GEN_MAX_NODES)
+            return FALSE;
+    }
+    oStatistics._partCount = levelCount;
+
+    DftDouble unique = floor(static_cast<DftDouble>(levelCount) * (1.0 - iOptions._instancingRatio) + 0.5);
+    oStatistics._uniqueGeometryCount = unique < 1.0 ? 1 : static_cast<DftUInt64>(unique);
+    oStatistics._triangleCount = oStatistics._partCount * iOptions._trianglesPerPart;
+    return TRUE;
+}
+
+DftBool GenerateScene(IMemSceneData* iSceneData, const SceneGenOptions& iOptions, SceneGenStatistics* oStatistics)
+{
+    SceneGenStatistics estimate;
+    if (!iSceneData || iSceneData->GetObjectCount() != 0 || !EstimateScene(iOptions, estimate))
+        return FALSE;
+
+    CSceneGenerator generator(iSceneData, iOptions, estimate);
+    DftBool res = generator.Run();
+    if (oStatistics)
+        *oStatistics = generator.GetStatistics();
+    return res;
+}
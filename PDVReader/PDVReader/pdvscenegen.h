@@ -0,0 +1,60 @@
+/**
+ * @file pdvscenegen.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：合成装配场景生成
+ * @details 在内存场景数据中按层数和每层子节点数生成规则的装配树，叶子节点为零件，每个零件关联一个模型。
+ *          零件网格为起伏的网格面，三角面数可配置；实例化比例决定多少零件共用同一渲染几何。
+ *          相同的参数和随机种子生成完全相同的场景，用于可重复的性能测试。
+ */
+
+#ifndef PDVSCENEGEN_H
+#define PDVSCENEGEN_H
+
+#include "DftBase.h"
+
+class IMemSceneData;
+
+/** @brief 场景生成参数 */
+struct SceneGenOptions
+{
+    DftUInt _depth;             ///< 装配层数，根节点为第0层，零件位于第_depth层
+    DftUInt _fanOut;            ///< 每个装配节点的子节点数
+    DftUInt _trianglesPerPart;  ///< 每个零件的三角面数
+    DftDouble _instancingRatio; ///< 实例化比例，0表示每个零件使用独立的几何，接近1时所有零件共用同一几何
+    DftUInt _attributeCount;    ///< 每个零件的属性项个数，为0时不创建属性表
+    DftUInt64 _seed;            ///< 随机种子，用于零件的位置和朝向
+
+    SceneGenOptions() : _depth(4), _fanOut(10), _trianglesPerPart(200), _instancingRatio(0.0), _attributeCount(0), _seed(1) {}
+};
+
+/** @brief 场景生成结果统计 */
+struct SceneGenStatistics
+{
+    DftUInt64 _nodeCount;           ///< 模型树节点数
+    DftUInt64 _partCount;           ///< 零件数
+    DftUInt64 _uniqueGeometryCount; ///< 不同渲染几何的个数
+    DftUInt64 _triangleCount;       ///< 按零件展开后的三角面总数
+
+    SceneGenStatistics() : _nodeCount(0), _partCount(0), _uniqueGeometryCount(0), _triangleCount(0) {}
+};
+
+/**
+ * @brief 计算生成参数对应的节点数和零件数，不生成场景
+ * @return DftBool 参数是否有效
+ * @param[in] iOptions 生成参数
+ * @param[out] oStatistics 统计结果
+ */
+DftBool EstimateScene(const SceneGenOptions& iOptions, SceneGenStatistics& oStatistics);
+
+/**
+ * @brief 在场景数据中生成装配场景
+ * @return DftBool 是否成功，参数无效或场景数据中已有对象时失败
+ * @param[in] iSceneData 空的内存场景数据
+ * @param[in] iOptions 生成参数
+ * @param[out] oStatistics 统计结果，可为NULL
+ * @note 例如10个子节点、4层时生成11111个节点和10000个零件
+ */
+DftBool GenerateScene(IMemSceneData* iSceneData, const SceneGenOptions& iOptions, SceneGenStatistics* oStatistics = NULL);
+
+#endif
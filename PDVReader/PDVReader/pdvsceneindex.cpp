@@ -0,0 +1,198 @@
+#include "pdvsceneindex.h"
+#include "PDVISceneData.h"
+#include "PDVIRenderBody.h"
+#include "PDVIRenderMesh.h"
+#include "PDVIRenderGeometry.h"
+#include "PDVIRenderVertex.h"
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+// 64位整数混合（splitmix64的最后一步），连续分配的ID也能均匀落到各个桶中
+inline size_t HashID(DftUInt64 iID)
+{
+    iID ^= iID >> 30;
+    iID *= 0xBF58476D1CE4E5B9ull;
+    iID ^= iID >> 27;
+    iID *= 0x94D049BB133111EBull;
+    iID ^= iID >> 31;
+    return static_cast<size_t>(iID);
+}
+
+// 按数组顺序编号，重复的ID保留第一个，与Find*ByID返回第一个匹配对象一致
+template <class T>
+void BuildTable(const vector<T*>& iObjects, vector<T*>& oObjects, CIdSlotMap& oSlots)
+{
+    oObjects.clear();
+    oObjects.reserve(iObjects.size());
+    oSlots.Clear();
+    oSlots.Reserve(iObjects.size());
+    for (size_t i = 0; i < iObjects.size(); i++)
+    {
+        T* object = iObjects[i];
+        if (object && oSlots.Insert(object->GetID(), static_cast<DftUInt>(oObjects.size())))
+            oObjects.push_back(object);
+    }
+}
+
+template <class T>
+inline T* FindInTable(const vector<T*>& iObjects, const CIdSlotMap& iSlots, DftUInt64 iID)
+{
+    DftUInt slot = iSlots.Find(iID);
+    return slot == PDV_SCENE_INVALID_SLOT ? NULL : iObjects[slot];
+}
+
+} // namespace
+
+CIdSlotMap::CIdSlotMap()
+    : m_Count(0)
+{
+}
+
+void CIdSlotMap::Clear()
+{
+    m_Keys.clear();
+    m_Slots.clear();
+    m_Count = 0;
+}
+
+void CIdSlotMap::Reserve(size_t iCount)
+{
+    size_t capacity = 16;
+    while (capacity < iCount * 2)
+        capacity *= 2;
+    if (capacity > m_Keys.size())
+        Rehash(capacity);
+}
+
+bool CIdSlotMap::Insert(DftUInt64 iID, DftUInt iSlot)
+{
+    if (iID == DFT_INVALID_ID)
+        return false;
+    if ((m_Count + 1) * 2 > m_Keys.size())
+        Rehash(m_Keys.empty() ? 16 : m_Keys.size() * 2);
+
+    size_t mask = m_Keys.size() - 1;
+    for (size_t i = HashID(iID) & mask;; i = (i + 1) & mask)
+    {
+        if (m_Keys[i] == iID)
+            return false;
+        if (m_Keys[i] == DFT_INVALID_ID)
+        {
+            m_Keys[i] = iID;
+            m_Slots[i] = iSlot;
+            m_Count++;
+            return true;
+        }
+    }
+}
+
+DftUInt CIdSlotMap::Find(DftUInt64 iID) const
+{
+    if (m_Count == 0 || iID == DFT_INVALID_ID)
+        return PDV_SCENE_INVALID_SLOT;
+
+    // 负载不超过1/2，总能遇到空桶
+    size_t mask = m_Keys.size() - 1;
+    for (size_t i = HashID(iID) & mask;; i = (i + 1) & mask)
+    {
+        if (m_Keys[i] == iID)
+            return m_Slots[i];
+        if (m_Keys[i] == DFT_INVALID_ID)
+            return PDV_SCENE_INVALID_SLOT;
+    }
+}
+
+void CIdSlotMap::Rehash(size_t iCapacity)
+{
+    vector<DftUInt64> keys(iCapacity, DFT_INVALID_ID);
+    vector<DftUInt> slots(iCapacity, PDV_SCENE_INVALID_SLOT);
+    size_t mask = iCapacity - 1;
+    for (size_t k = 0; k < m_Keys.size(); k++)
+    {
+        if (m_Keys[k] == DFT_INVALID_ID)
+            continue;
+        size_t i = HashID(m_Keys[k]) & mask;
+        while (keys[i] != DFT_INVALID_ID)
+            i = (i + 1) & mask;
+        keys[i] = m_Keys[k];
+        slots[i] = m_Slots[k];
+    }
+    m_Keys.swap(keys);
+    m_Slots.swap(slots);
+}
+
+CSceneIndex::CSceneIndex()
+    : m_SceneData(NULL)
+{
+}
+
+CSceneIndex::CSceneIndex(ISceneData* iSceneData)
+    : m_SceneData(NULL)
+{
+    Build(iSceneData);
+}
+
+void CSceneIndex::Build(ISceneData* iSceneData)
+{
+    Clear();
+    m_SceneData = iSceneData;
+    if (!iSceneData)
+        return;
+
+    vector<IRenderBody*> renderBodies;
+    iSceneData->GetRenderBodyArray(renderBodies);
+    BuildTable(renderBodies, m_RenderBodies, m_RenderBodySlots);
+
+    vector<IRenderMesh*> renderMeshes;
+    iSceneData->GetRenderMeshArray(renderMeshes);
+    BuildTable(renderMeshes, m_RenderMeshes, m_RenderMeshSlots);
+
+    vector<IRenderGeometry*> renderGeometries;
+    iSceneData->GetRenderGeometryArray(renderGeometries);
+    BuildTable(renderGeometries, m_RenderGeometries, m_RenderGeometrySlots);
+
+    vector<IRenderVertex*> renderVertexes;
+    iSceneData->GetRenderVertexArray(renderVertexes);
+    BuildTable(renderVertexes, m_RenderVertexes, m_RenderVertexSlots);
+}
+
+void CSceneIndex::Clear()
+{
+    m_SceneData = NULL;
+    m_RenderBodies.clear();
+    m_RenderMeshes.clear();
+    m_RenderGeometries.clear();
+    m_RenderVertexes.clear();
+    m_RenderBodySlots.Clear();
+    m_RenderMeshSlots.Clear();
+    m_RenderGeometrySlots.Clear();
+    m_RenderVertexSlots.Clear();
+}
+
+IRenderBody* CSceneIndex::FindRenderBody(DftUInt64 iID) const
+{
+    IRenderBody* object = FindInTable(m_RenderBodies, m_RenderBodySlots, iID);
+    return object || !m_SceneData ? object : m_SceneData->FindRenderBodyByID(iID);
+}
+
+IRenderMesh* CSceneIndex::FindRenderMesh(DftUInt64 iID) const
+{
+    IRenderMesh* object = FindInTable(m_RenderMeshes, m_RenderMeshSlots, iID);
+    return object || !m_SceneData ? object : m_SceneData->FindRenderMeshByID(iID);
+}
+
+IRenderGeometry* CSceneIndex::FindRenderGeometry(DftUInt64 iID) const
+{
+    IRenderGeometry* object = FindInTable(m_RenderGeometries, m_RenderGeometrySlots, iID);
+    return object || !m_SceneData ? object : m_SceneData->FindRenderGeometryByID(iID);
+}
+
+IRenderVertex* CSceneIndex::FindRenderVertex(DftUInt64 iID) const
+{
+    IRenderVertex* object = FindInTable(m_RenderVertexes, m_RenderVertexSlots, iID);
+    return object || !m_SceneData ? object : m_SceneData->FindRenderVertexByID(iID);
+}
@@ -0,0 +1,136 @@
+/**
+ * @file pdvsceneindex.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：场景对象按ID查找的索引
+ * @details 场景加载后由Get*Array一次性取得渲染主体、渲染网格、渲染几何和顶点数据，对象指针按数组顺序存放为稠密序号，
+ *          ID到序号的映射使用开放寻址（线性探测）的哈希表。导出时每个节点的每个网格都要按ID查找这些对象，
+ *          共享几何的场景中同一ID会被查找成千上万次，查找不再经过ISceneData::Find*ByID。
+ */
+
+#ifndef PDVSCENEINDEX_H
+#define PDVSCENEINDEX_H
+
+#include "DftBase.h"
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+class ISceneData;
+class IRenderBody;
+class IRenderMesh;
+class IRenderGeometry;
+class IRenderVertex;
+} // namespace pdv
+} // namespace kernel
+
+/** @brief 无效的稠密序号 */
+#define PDV_SCENE_INVALID_SLOT 0xFFFFFFFFu
+
+/**
+ * @brief ID到稠密序号的开放寻址哈希表
+ * @note 容量为2的幂，负载不超过1/2，DFT_INVALID_ID作为空位标记，不能插入
+ */
+class CIdSlotMap
+{
+public:
+    CIdSlotMap();
+
+    /** @brief 清空 */
+    void Clear();
+
+    /**
+     * @brief 预留空间，插入不超过iCount个ID时不再扩容
+     * @param[in] iCount ID个数
+     */
+    void Reserve(size_t iCount);
+
+    /**
+     * @brief 插入ID
+     * @return bool 是否插入，ID无效或已存在时为false，已存在的序号不变
+     * @param[in] iID 对象ID
+     * @param[in] iSlot 稠密序号
+     */
+    bool Insert(DftUInt64 iID, DftUInt iSlot);
+
+    /**
+     * @brief 查找ID
+     * @return DftUInt 稠密序号，不存在时为PDV_SCENE_INVALID_SLOT
+     * @param[in] iID 对象ID
+     */
+    DftUInt Find(DftUInt64 iID) const;
+
+    /** @brief ID个数 */
+    size_t GetCount() const { return m_Count; }
+    /** @brief 桶个数 */
+    size_t GetCapacity() const { return m_Keys.size(); }
+
+private:
+    void Rehash(size_t iCapacity);
+
+private:
+    std::vector<DftUInt64> m_Keys; ///< 桶中的ID，空桶为DFT_INVALID_ID
+    std::vector<DftUInt> m_Slots;  ///< 桶中ID对应的序号
+    size_t m_Count;                ///< ID个数
+};
+
+/**
+ * @brief 场景对象索引
+ * @note 建立后场景数据不能再增删对象；索引中找不到的ID仍按ISceneData::Find*ByID查找，结果与直接查找一致
+ */
+class CSceneIndex
+{
+public:
+    CSceneIndex();
+
+    /**
+     * @brief 建立索引
+     * @param[in] iSceneData 已加载的场景数据
+     */
+    explicit CSceneIndex(kernel::pdv::ISceneData* iSceneData);
+
+    /**
+     * @brief 按场景数据重新建立索引
+     * @param[in] iSceneData 已加载的场景数据，为NULL时清空
+     */
+    void Build(kernel::pdv::ISceneData* iSceneData);
+
+    /** @brief 清空 */
+    void Clear();
+
+    /** @brief 场景数据 */
+    kernel::pdv::ISceneData* GetSceneData() const { return m_SceneData; }
+
+    /** @brief 按ID查找渲染主体，不存在时为NULL */
+    kernel::pdv::IRenderBody* FindRenderBody(DftUInt64 iID) const;
+    /** @brief 按ID查找渲染网格，不存在时为NULL */
+    kernel::pdv::IRenderMesh* FindRenderMesh(DftUInt64 iID) const;
+    /** @brief 按ID查找渲染几何，不存在时为NULL */
+    kernel::pdv::IRenderGeometry* FindRenderGeometry(DftUInt64 iID) const;
+    /** @brief 按ID查找顶点数据，不存在时为NULL */
+    kernel::pdv::IRenderVertex* FindRenderVertex(DftUInt64 iID) const;
+
+    /** @brief 索引中的渲染主体个数 */
+    size_t GetRenderBodyCount() const { return m_RenderBodies.size(); }
+    /** @brief 索引中的渲染网格个数 */
+    size_t GetRenderMeshCount() const { return m_RenderMeshes.size(); }
+    /** @brief 索引中的渲染几何个数 */
+    size_t GetRenderGeometryCount() const { return m_RenderGeometries.size(); }
+    /** @brief 索引中的顶点数据个数 */
+    size_t GetRenderVertexCount() const { return m_RenderVertexes.size(); }
+
+private:
+    kernel::pdv::ISceneData* m_SceneData;                          ///< 场景数据
+    std::vector<kernel::pdv::IRenderBody*> m_RenderBodies;         ///< 渲染主体
+    std::vector<kernel::pdv::IRenderMesh*> m_RenderMeshes;         ///< 渲染网格
+    std::vector<kernel::pdv::IRenderGeometry*> m_RenderGeometries; ///< 渲染几何
+    std::vector<kernel::pdv::IRenderVertex*> m_RenderVertexes;     ///< 顶点数据
+    CIdSlotMap m_RenderBodySlots;                                  ///< 渲染主体ID到序号
+    CIdSlotMap m_RenderMeshSlots;                                  ///< 渲染网格ID到序号
+    CIdSlotMap m_RenderGeometrySlots;                              ///< 渲染几何ID到序号
+    CIdSlotMap m_RenderVertexSlots;                                ///< 顶点数据ID到序号
+};
+
+#endif
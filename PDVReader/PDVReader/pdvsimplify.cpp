@@ -0,0 +1,638 @@
+#include "pdvsimplify.h"
+#include "pdvgeometrycache.h"
+#include "pdvtextformat.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <unordered_map>
+
+using namespace std;
+
+namespace
+{
+
+// 边界边垂直平面的误差权重，相对于三角面按面积计的权重
+const double BOUNDARY_WEIGHT = 10.0;
+
+const DftUInt INVALID_VERTEX = ~0u;
+
+inline void Sub(const double* a, const double* b, double* r)
+{
+    r[0] = a[0] - b[0];
+    r[1] = a[1] - b[1];
+    r[2] = a[2] - b[2];
+}
+
+inline void Cross(const double* a, const double* b, double* r)
+{
+    r[0] = a[1] * b[2] - a[2] * b[1];
+    r[1] = a[2] * b[0] - a[0] * b[2];
+    r[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+inline double Dot(const double* a, const double* b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+inline double Normalize(double* v)
+{
+    double length = sqrt(Dot(v, v));
+    if (length > 0.0)
+    {
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+    }
+    return length;
+}
+
+/** 二次误差：对称阵A、向量b与常数c，点p的误差为pᵀAp + 2bᵀp + c */
+struct Quadric
+{
+    double _a[6];    ///< A的上三角：xx、xy、xz、yy、yz、zz
+    double _b[3];    ///< b
+    double _c;       ///< c
+    double _weight;  ///< 三角面面积之和，误差除以它换算为距离的平方
+
+    Quadric() : _c(0.0), _weight(0.0)
+    {
+        memset(_a, 0, sizeof(_a));
+        memset(_b, 0, sizeof(_b));
+    }
+
+    // 平面n·p + d = 0，n为单位向量
+    void AddPlane(const double* n, double d, double w)
+    {
+        _a[0] += w * n[0] * n[0];
+        _a[1] += w * n[0] * n[1];
+        _a[2] += w * n[0] * n[2];
+        _a[3] += w * n[1] * n[1];
+        _a[4] += w * n[1] * n[2];
+        _a[5] += w * n[2] * n[2];
+        _b[0] += w * d * n[0];
+        _b[1] += w * d * n[1];
+        _b[2] += w * d * n[2];
+        _c += w * d * d;
+    }
+
+    void Add(const Quadric& iOther)
+    {
+        for (int i = 0; i < 6; i++)
+            _a[i] += iOther._a[i];
+        for (int i = 0; i < 3; i++)
+            _b[i] += iOther._b[i];
+        _c += iOther._c;
+        _weight += iOther._weight;
+    }
+
+    double Evaluate(const double* p) const
+    {
+        double x = p[0], y = p[1], z = p[2];
+        double e = _a[0] * x * x + 2.0 * _a[1] * x * y + 2.0 * _a[2] * x * z + _a[3] * y * y + 2.0 * _a[4] * y * z +
+            _a[5] * z * z + 2.0 * (_b[0] * x + _b[1] * y + _b[2] * z) + _c;
+        return e > 0.0 ? e : 0.0;
+    }
+};
+
+/** 按位比较的顶点坐标，用于合并重复顶点 */
+struct PositionKey
+{
+    DftUInt32 _bits[3];
+
+    bool operator==(const PositionKey& iOther) const
+    {
+        return _bits[0] == iOther._bits[0] && _bits[1] == iOther._bits[1] && _bits[2] == iOther._bits[2];
+    }
+};
+
+struct PositionKeyHash
+{
+    size_t operator()(const PositionKey& iKey) const
+    {
+        size_t h = iKey._bits[0];
+        h = h * 0x9E3779B1u ^ iKey._bits[1];
+        h = h * 0x9E3779B1u ^ iKey._bits[2];
+        return h;
+    }
+};
+
+PositionKey MakePositionKey(const PDVVector3F& iPosition)
+{
+    PositionKey key;
+    for (int c = 0; c < 3; c++)
+    {
+        // -0与+0视为同一坐标
+        DftFloat value = iPosition._data[c] == 0.0f ? 0.0f : iPosition._data[c];
+        memcpy(&key._bits[c], &value, sizeof(DftUInt32));
+    }
+    return key;
+}
+
+inline DftUInt64 MakeEdgeKey(DftUInt a, DftUInt b)
+{
+    return a < b ? (static_cast<DftUInt64>(a) << 32) | b : (static_cast<DftUInt64>(b) << 32) | a;
+}
+
+/** 一次候选折叠：删除_from，三角面改为引用_to */
+struct Collapse
+{
+    DftUInt _from;   ///< 被删除的顶点
+    DftUInt _to;     ///< 保留的顶点
+    double _error;   ///< 折叠后的误差（距离）
+
+    bool operator<(const Collapse& iOther) const
+    {
+        if (_error != iOther._error)
+            return _error < iOther._error;
+        return _from != iOther._from ? _from < iOther._from : _to < iOther._to;
+    }
+};
+
+/** 一份几何的简化过程，顶点按坐标合并后参与折叠，输出时再换回原顶点 */
+class CQemSimplifier
+{
+public:
+    explicit CQemSimplifier(const CachedGeometry& iSource) : m_Source(iSource), m_LiveCount(0), m_Error(0.0) {}
+
+    bool Initialize();
+    void Run(DftUInt iTargetTriangles, double iMaxError);
+    void Output(CachedGeometry& oResult, vector<DftUInt>* oSourceVertexes) const;
+
+    double GetError() const { return m_Error; }
+
+private:
+    const double* Position(DftUInt iVertex) const { return &m_Positions[iVertex * 3]; }
+    double GetCollapseError(DftUInt iFrom, DftUInt iTo) const;
+    void BuildAdjacency();
+    void CollectCollapses(vector<Collapse>& oCollapses) const;
+    bool CanCollapse(DftUInt iFrom, DftUInt iTo);
+    void ApplyCollapse(DftUInt iFrom, DftUInt iTo);
+    DftUInt SelectCopy(DftUInt iVertex, DftUInt iPrevious) const;
+    void CollectNeighbors(DftUInt iVertex, vector<DftUInt>& oNeighbors) const;
+
+    const CachedGeometry& m_Source;
+    vector<DftUInt> m_Remap;        ///< 原顶点到合并后顶点
+    vector<DftUInt> m_CopyOffsets;  ///< 合并后顶点对应原顶点列表的起始位置
+    vector<DftUInt> m_Copies;       ///< 按合并后顶点排列的原顶点
+    vector<double> m_Positions;     ///< 合并后顶点的坐标
+    vector<Quadric> m_Quadrics;     ///< 合并后顶点的误差
+    vector<DftUInt> m_Triangles;    ///< 三角面，引用合并后顶点
+    vector<DftUInt> m_Corners;      ///< 三角面每个角引用的原顶点
+    vector<char> m_Live;            ///< 三角面是否仍存在
+    DftUInt m_LiveCount;            ///< 存在的三角面数
+    vector<DftUInt> m_AdjOffsets;   ///< 顶点相邻三角面列表的起始位置，每轮重建
+    vector<DftUInt> m_Adjacency;    ///< 按顶点排列的相邻三角面
+    vector<char> m_Touched;         ///< 本轮已参与折叠的顶点
+    vector<DftUInt> m_FromNeighbors;
+    vector<DftUInt> m_ToNeighbors;
+    double m_Error;                 ///< 已执行折叠中的最大误差
+};
+
+bool CQemSimplifier::Initialize()
+{
+    const vector<PDVVector3F>& positions = m_Source._positions;
+    const vector<DftUInt>& indexes = m_Source._indexes;
+    DftUInt vertexCount = static_cast<DftUInt>(positions.size());
+    size_t triangleCount = indexes.size() / 3;
+    for (size_t i = 0; i < triangleCount * 3; i++)
+    {
+        if (indexes[i] >= vertexCount)
+            return false;
+    }
+
+    // 按坐标合并重复顶点，法向不同的硬边两侧因此连通
+    unordered_map<PositionKey, DftUInt, PositionKeyHash> lookup;
+    lookup.reserve(vertexCount);
+    m_Remap.resize(vertexCount);
+    for (DftUInt v = 0; v < vertexCount; v++)
+    {
+        pair<unordered_map<PositionKey, DftUInt, PositionKeyHash>::iterator, bool> inserted =
+            lookup.insert(make_pair(MakePositionKey(positions[v]), static_cast<DftUInt>(m_Positions.size() / 3)));
+        if (inserted.second)
+        {
+            for (int c = 0; c < 3; c++)
+                m_Positions.push_back(positions[v]._data[c]);
+        }
+        m_Remap[v] = inserted.first->second;
+    }
+    DftUInt weldedCount = static_cast<DftUInt>(m_Positions.size() / 3);
+    m_CopyOffsets.assign(weldedCount + 1, 0);
+    for (DftUInt v = 0; v < vertexCount; v++)
+        m_CopyOffsets[m_Remap[v] + 1]++;
+    for (DftUInt w = 0; w < weldedCount; w++)
+        m_CopyOffsets[w + 1] += m_CopyOffsets[w];
+    m_Copies.resize(vertexCount);
+    vector<DftUInt> cursor(m_CopyOffsets.begin(), m_CopyOffsets.end() - 1);
+    for (DftUInt v = 0; v < vertexCount; v++)
+        m_Copies[cursor[m_Remap[v]]++] = v;
+
+    // 合并后退化的三角面直接去掉
+    m_Triangles.reserve(triangleCount * 3);
+    m_Corners.reserve(triangleCount * 3);
+    for (size_t t = 0; t < triangleCount; t++)
+    {
+        const DftUInt* corner = &indexes[t * 3];
+        DftUInt a = m_Remap[corner[0]], b = m_Remap[corner[1]], c = m_Remap[corner[2]];
+        if (a == b || b == c || a == c)
+            continue;
+        m_Triangles.push_back(a);
+        m_Triangles.push_back(b);
+        m_Triangles.push_back(c);
+        m_Corners.insert(m_Corners.end(), corner, corner + 3);
+    }
+    m_LiveCount = static_cast<DftUInt>(m_Triangles.size() / 3);
+    m_Live.assign(m_LiveCount, 1);
+
+    // 每个顶点累加相邻三角面所在平面的误差，按面积加权
+    m_Quadrics.assign(weldedCount, Quadric());
+    vector<double> faceNormals(m_LiveCount * 3);
+    for (DftUInt t = 0; t < m_LiveCount; t++)
+    {
+        const DftUInt* tri = &m_Triangles[t * 3];
+        double e1[3], e2[3];
+        double* n = &faceNormals[t * 3];
+        Sub(Position(tri[1]), Position(tri[0]), e1);
+        Sub(Position(tri[2]), Position(tri[0]), e2);
+        Cross(e1, e2, n);
+        double area = Normalize(n) * 0.5;
+        if (area <= 0.0)
+            continue;
+        double d = -Dot(n, Position(tri[0]));
+        for (int c = 0; c < 3; c++)
+        {
+            m_Quadrics[tri[c]].AddPlane(n, d, area);
+            m_Quadrics[tri[c]]._weight += area;
+        }
+    }
+
+    // 只属于一个三角面的边为边界，附加过该边且垂直于三角面的平面，限制边界顶点沿法向以外的方向移动
+    vector<pair<DftUInt64, DftUInt> > edges;
+    edges.reserve(m_Triangles.size());
+    for (DftUInt t = 0; t < m_LiveCount; t++)
+    {
+        for (DftUInt c = 0; c < 3; c++)
+            edges.push_back(make_pair(MakeEdgeKey(m_Triangles[t * 3 + c], m_Triangles[t * 3 + (c + 1) % 3]), t * 3 + c));
+    }
+    sort(edges.begin(), edges.end());
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        bool shared = (i > 0 && edges[i - 1].first == edges[i].first) ||
+            (i + 1 < edges.size() && edges[i + 1].first == edges[i].first);
+        if (shared)
+            continue;
+        DftUInt t = edges[i].second / 3, c = edges[i].second % 3;
+        DftUInt a = m_Triangles[t * 3 + c], b = m_Triangles[t * 3 + (c + 1) % 3];
+        double e[3], n[3];
+        Sub(Position(b), Position(a), e);
+        Cross(e, &faceNormals[t * 3], n);
+        double length = Normalize(n);
+        if (length <= 0.0)
+            continue;
+        double d = -Dot(n, Position(a));
+        double w = Dot(e, e) * BOUNDARY_WEIGHT;
+        m_Quadrics[a].AddPlane(n, d, w);
+        m_Quadrics[b].AddPlane(n, d, w);
+    }
+    m_Touched.assign(weldedCount, 0);
+    return true;
+}
+
+double CQemSimplifier::GetCollapseError(DftUInt iFrom, DftUInt iTo) const
+{
+    Quadric q = m_Quadrics[iFrom];
+    q.Add(m_Quadrics[iTo]);
+    double error = q.Evaluate(Position(iTo));
+    return q._weight > 0.0 ? sqrt(error / q._weight) : sqrt(error);
+}
+
+void CQemSimplifier::BuildAdjacency()
+{
+    size_t vertexCount = m_Quadrics.size();
+    m_AdjOffsets.assign(vertexCount + 1, 0);
+    DftUInt triangleCount = static_cast<DftUInt>(m_Live.size());
+    for (DftUInt t = 0; t < triangleCount; t++)
+    {
+        if (!m_Live[t])
+            continue;
+        for (int c = 0; c < 3; c++)
+            m_AdjOffsets[m_Triangles[t * 3 + c] + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; v++)
+        m_AdjOffsets[v + 1] += m_AdjOffsets[v];
+    m_Adjacency.resize(m_AdjOffsets[vertexCount]);
+    vector<DftUInt> cursor(m_AdjOffsets.begin(), m_AdjOffsets.end() - 1);
+    for (DftUInt t = 0; t < triangleCount; t++)
+    {
+        if (!m_Live[t])
+            continue;
+        for (int c = 0; c < 3; c++)
+            m_Adjacency[cursor[m_Triangles[t * 3 + c]]++] = t;
+    }
+}
+
+void CQemSimplifier::CollectCollapses(vector<Collapse>& oCollapses) const
+{
+    vector<DftUInt64> edges;
+    edges.reserve(m_LiveCount * 3);
+    DftUInt triangleCount = static_cast<DftUInt>(m_Live.size());
+    for (DftUInt t = 0; t < triangleCount; t++)
+    {
+        if (!m_Live[t])
+            continue;
+        for (int c = 0; c < 3; c++)
+            edges.push_back(MakeEdgeKey(m_Triangles[t * 3 + c], m_Triangles[t * 3 + (c + 1) % 3]));
+    }
+    sort(edges.begin(), edges.end());
+    edges.erase(unique(edges.begin(), edges.end()), edges.end());
+
+    // 每条边取两个方向中误差较小的一个
+    oCollapses.resize(edges.size());
+    for (size_t i = 0; i < edges.size(); i++)
+    {
+        DftUInt a = static_cast<DftUInt>(edges[i] >> 32), b = static_cast<DftUInt>(edges[i]);
+        double ab = GetCollapseError(a, b), ba = GetCollapseError(b, a);
+        Collapse& collapse = oCollapses[i];
+        collapse._from = ab <= ba ? a : b;
+        collapse._to = ab <= ba ? b : a;
+        collapse._error = ab <= ba ? ab : ba;
+    }
+    sort(oCollapses.begin(), oCollapses.end());
+}
+
+void CQemSimplifier::CollectNeighbors(DftUInt iVertex, vector<DftUInt>& oNeighbors) const
+{
+    oNeighbors.clear();
+    for (DftUInt k = m_AdjOffsets[iVertex]; k < m_AdjOffsets[iVertex + 1]; k++)
+    {
+        DftUInt t = m_Adjacency[k];
+        if (!m_Live[t])
+            continue;
+        for (int c = 0; c < 3; c++)
+        {
+            if (m_Triangles[t * 3 + c] != iVertex)
+                oNeighbors.push_back(m_Triangles[t * 3 + c]);
+        }
+    }
+    sort(oNeighbors.begin(), oNeighbors.end());
+    oNeighbors.erase(unique(oNeighbors.begin(), oNeighbors.end()), oNeighbors.end());
+}
+
+bool CQemSimplifier::CanCollapse(DftUInt iFrom, DftUInt iTo)
+{
+    // 两端点本轮都未参与折叠，相邻三角面列表仍然完整
+    DftUInt shared = 0;
+    const double* target = Position(iTo);
+    for (DftUInt k = m_AdjOffsets[iFrom]; k < m_AdjOffsets[iFrom + 1]; k++)
+    {
+        DftUInt t = m_Adjacency[k];
+        if (!m_Live[t])
+            continue;
+        const DftUInt* tri = &m_Triangles[t * 3];
+        if (tri[0] == iTo || tri[1] == iTo || tri[2] == iTo)
+        {
+            shared++;
+            continue;
+        }
+
+        // 移动后的三角面不能翻转或退化
+        const double* p[3];
+        const double* q[3];
+        for (int c = 0; c < 3; c++)
+        {
+            p[c] = Position(tri[c]);
+            q[c] = tri[c] == iFrom ? target : p[c];
+        }
+        double e1[3], e2[3], before[3], after[3];
+        Sub(p[1], p[0], e1);
+        Sub(p[2], p[0], e2);
+        Cross(e1, e2, before);
+        Sub(q[1], q[0], e1);
+        Sub(q[2], q[0], e2);
+        Cross(e1, e2, after);
+        if (Dot(before, after) <= 0.0)
+            return false;
+    }
+    if (shared == 0)
+        return false;
+
+    // 流形条件：两端点的公共相邻顶点只能是共边三角面的第三个顶点
+    CollectNeighbors(iFrom, m_FromNeighbors);
+    CollectNeighbors(iTo, m_ToNeighbors);
+    DftUInt common = 0;
+    size_t i = 0, j = 0;
+    while (i < m_FromNeighbors.size() && j < m_ToNeighbors.size())
+    {
+        if (m_FromNeighbors[i] < m_ToNeighbors[j])
+            i++;
+        else if (m_ToNeighbors[j] < m_FromNeighbors[i])
+            j++;
+        else
+        {
+            common++;
+            i++;
+            j++;
+        }
+    }
+    return common == shared;
+}
+
+DftUInt CQemSimplifier::SelectCopy(DftUInt iVertex, DftUInt iPrevious) const
+{
+    DftUInt best = m_Copies[m_CopyOffsets[iVertex]];
+    const vector<PDVVector3F>& normals = m_Source._normals;
+    if (normals.size() != m_Source._positions.size())
+        return best;
+
+    // 选法向与原来最接近的一份，保持硬边两侧各自的法向
+    const DftFloat* reference = normals[iPrevious]._data;
+    DftFloat bestDot = -2.0f;
+    for (DftUInt k = m_CopyOffsets[iVertex]; k < m_CopyOffsets[iVertex + 1]; k++)
+    {
+        const DftFloat* n = normals[m_Copies[k]]._data;
+        DftFloat dot = n[0] * reference[0] + n[1] * reference[1] + n[2] * reference[2];
+        if (dot > bestDot)
+        {
+            bestDot = dot;
+            best = m_Copies[k];
+        }
+    }
+    return best;
+}
+
+void CQemSimplifier::ApplyCollapse(DftUInt iFrom, DftUInt iTo)
+{
+    m_Quadrics[iTo].Add(m_Quadrics[iFrom]);
+    for (DftUInt k = m_AdjOffsets[iFrom]; k < m_AdjOffsets[iFrom + 1]; k++)
+    {
+        DftUInt t = m_Adjacency[k];
+        if (!m_Live[t])
+            continue;
+        DftUInt* tri = &m_Triangles[t * 3];
+        if (tri[0] == iTo || tri[1] == iTo || tri[2] == iTo)
+        {
+            m_Live[t] = 0;
+            m_LiveCount--;
+            continue;
+        }
+        for (int c = 0; c < 3; c++)
+        {
+            if (tri[c] == iFrom)
+            {
+                tri[c] = iTo;
+                m_Corners[t * 3 + c] = SelectCopy(iTo, m_Corners[t * 3 + c]);
+            }
+        }
+    }
+    m_Touched[iFrom] = 1;
+    m_Touched[iTo] = 1;
+}
+
+void CQemSimplifier::Run(DftUInt iTargetTriangles, double iMaxError)
+{
+    vector<Collapse> collapses;
+    while (m_LiveCount > iTargetTriangles)
+    {
+        BuildAdjacency();
+        CollectCollapses(collapses);
+        if (collapses.empty())
+            break;
+
+        // 一次内部边折叠去掉两个三角面；本轮只考虑误差较小的一批候选，其余在重新计算代价后再比较
+        size_t goal = (m_LiveCount - iTargetTriangles) / 2 + 1;
+        size_t limitIndex = min(collapses.size() - 1, goal + goal / 2);
+        double passLimit = collapses[limitIndex]._error;
+
+        fill(m_Touched.begin(), m_Touched.end(), 0);
+        size_t performed = 0;
+        bool errorReached = false;
+        for (size_t i = 0; i < collapses.size() && m_LiveCount > iTargetTriangles; i++)
+        {
+            const Collapse& collapse = collapses[i];
+            if (iMaxError > 0.0 && collapse._error > iMaxError)
+            {
+                errorReached = true;
+                break;
+            }
+            if (collapse._error > passLimit && performed > 0)
+                break;
+            if (m_Touched[collapse._from] || m_Touched[collapse._to] || !CanCollapse(collapse._from, collapse._to))
+                continue;
+            ApplyCollapse(collapse._from, collapse._to);
+            m_Error = max(m_Error, collapse._error);
+            performed++;
+        }
+        if (performed == 0 || errorReached)
+            break;
+    }
+}
+
+void CQemSimplifier::Output(CachedGeometry& oResult, vector<DftUInt>* oSourceVertexes) const
+{
+    const vector<PDVVector3F>& positions = m_Source._positions;
+    const vector<PDVVector3F>& normals = m_Source._normals;
+    bool hasNormals = normals.size() == positions.size();
+
+    // 保留仍被引用的原顶点，按原顺序重新编号
+    vector<DftUInt> remap(positions.size(), INVALID_VERTEX);
+    DftUInt triangleCount = static_cast<DftUInt>(m_Live.size());
+    for (DftUInt t = 0; t < triangleCount; t++)
+    {
+        if (!m_Live[t])
+            continue;
+        for (int c = 0; c < 3; c++)
+            remap[m_Corners[t * 3 + c]] = 0;
+    }
+    oResult._positions.clear();
+    oResult._normals.clear();
+    if (oSourceVertexes)
+        oSourceVertexes->clear();
+    for (size_t v = 0; v < positions.size(); v++)
+    {
+        if (remap[v] == INVALID_VERTEX)
+            continue;
+        remap[v] = static_cast<DftUInt>(oResult._positions.size());
+        if (oSourceVertexes)
+            oSourceVertexes->push_back(static_cast<DftUInt>(v));
+        oResult._positions.push_back(positions[v]);
+        if (hasNormals)
+            oResult._normals.push_back(normals[v]);
+    }
+
+    oResult._indexes.clear();
+    oResult._indexes.reserve(m_LiveCount * 3);
+    for (DftUInt t = 0; t < triangleCount; t++)
+    {
+        if (!m_Live[t])
+            continue;
+        for (int c = 0; c < 3; c++)
+            oResult._indexes.push_back(remap[m_Corners[t * 3 + c]]);
+    }
+}
+
+} // namespace
+
+SimplifyTarget GetSimplifyTarget(const SimplifyOptions& iOptions, DftUInt iSourceTriangles, DftUInt64 iNodeTriangles)
+{
+    SimplifyTarget target;
+    if (!iOptions.IsEnabled())
+        return target;
+
+    double ratio = iOptions._targetRatio;
+    if (ratio >= 1.0 && iOptions._maxError > 0.0f)
+        ratio = 0.0;
+    if (iOptions._nodeTriangleBudget > 0 && iNodeTriangles > iOptions._nodeTriangleBudget)
+        ratio = min(ratio, static_cast<double>(iOptions._nodeTriangleBudget) / iNodeTriangles);
+    DftUInt triangles = static_cast<DftUInt>(ceil(iSourceTriangles * ratio));
+    target._triangles = triangles > 0 ? triangles : 1;
+    target._maxError = iOptions._maxError;
+    return target;
+}
+
+DftBool SimplifyGeometry(const CachedGeometry& iSource, const SimplifyTarget& iTarget, CachedGeometry& oResult,
+    vector<DftUInt>* oSourceVertexes)
+{
+    oResult._error = 0.0f;
+    DftUInt sourceTriangles = iSource.GetTriangleCount();
+    if (iTarget._triangles >= sourceTriangles)
+    {
+        oResult._indexes = iSource._indexes;
+        oResult._positions = iSource._positions;
+        oResult._normals = iSource._normals;
+        if (oSourceVertexes)
+        {
+            oSourceVertexes->resize(iSource._positions.size());
+            for (size_t v = 0; v < oSourceVertexes->size(); v++)
+                (*oSourceVertexes)[v] = static_cast<DftUInt>(v);
+        }
+    }
+    else
+    {
+        CQemSimplifier simplifier(iSource);
+        if (!simplifier.Initialize())
+            return FALSE;
+        simplifier.Run(iTarget._triangles, iTarget._maxError);
+        simplifier.Output(oResult, oSourceVertexes);
+        oResult._error = static_cast<DftFloat>(simplifier.GetError());
+    }
+    oResult._sourceTriangles = sourceTriangles;
+    oResult._target = iTarget;
+    return TRUE;
+}
+
+DftBool WriteSimplifyReport(const vector<NodeSimplifyReport>& iReports, const string& iReportPath)
+{
+    CTextWriter report(6);
+    if (!report.Open(iReportPath))
+        return FALSE;
+
+    report.Append("NodeID,Name,SourceTriangles,ResultTriangles,Reduction,MaxError\n");
+    for (size_t i = 0; i < iReports.size(); i++)
+    {
+        const NodeSimplifyReport& node = iReports[i];
+        report.AppendUInt(node._nodeID).Append(',').AppendQuoted(node._name.c_str()).Append(',');
+        report.AppendUInt(node._sourceTriangles).Append(',').AppendUInt(node._resultTriangles).Append(',');
+        report.AppendFixed(node.GetReduction()).Append(',').AppendFixed(node._error).Append('\n');
+    }
+    return report.Close();
+}
@@ -0,0 +1,95 @@
+/**
+ * @file pdvsimplify.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：基于二次误差度量的网格简化
+ * @details 按坐标合并重复顶点得到连通关系后，用二次误差度量（QEM）逐步折叠代价最小的边，直到三角面数达到目标或误差超过上限。
+ *          折叠点取边的一个端点，原顶点的法向随顶点保留，硬边两侧的重复顶点各自选用法向最接近的一份，折叠不产生新顶点。
+ *          边界边附加垂直平面的误差，保持开放边界与面片之间的缝；折叠前检查三角面翻转和流形条件。
+ *          每轮按当前误差排序候选边，同一轮内每个顶点只参与一次折叠，之后重新计算代价。
+ */
+
+#ifndef PDVSIMPLIFY_H
+#define PDVSIMPLIFY_H
+
+#include "DftBase.h"
+#include <string>
+#include <vector>
+
+struct CachedGeometry;
+
+/** @brief 简化参数 */
+struct SimplifyOptions
+{
+    DftFloat _targetRatio;           ///< 目标三角面数与原三角面数之比，取值[0, 1]；为1且设置了误差上限时只按误差简化
+    DftFloat _maxError;              ///< 允许的最大误差（模型单位，按面积加权的到原表面距离），为0时不限制
+    DftUInt64 _nodeTriangleBudget;   ///< 每个节点的三角面数上限，超出时按比例收紧节点下每个几何的目标，为0时不限制
+
+    SimplifyOptions() : _targetRatio(1.0f), _maxError(0.0f), _nodeTriangleBudget(0) {}
+
+    /** 是否需要简化 */
+    DftBool IsEnabled() const { return _targetRatio < 1.0f || _maxError > 0.0f || _nodeTriangleBudget > 0 ? TRUE : FALSE; }
+};
+
+/** @brief 一份几何的简化目标，同一几何在缓存中按目标区分 */
+struct SimplifyTarget
+{
+    DftUInt _triangles;  ///< 目标三角面数，不小于原三角面数时不简化
+    DftFloat _maxError;  ///< 允许的最大误差，为0时不限制
+
+    SimplifyTarget() : _triangles(~0u), _maxError(0.0f) {}
+
+    bool operator==(const SimplifyTarget& iOther) const
+    {
+        return _triangles == iOther._triangles && _maxError == iOther._maxError;
+    }
+    bool operator!=(const SimplifyTarget& iOther) const { return !(*this == iOther); }
+};
+
+/** @brief 一个节点的简化结果 */
+struct NodeSimplifyReport
+{
+    DftUInt64 _nodeID;            ///< 节点ID
+    std::string _name;            ///< 节点名称
+    DftUInt64 _sourceTriangles;   ///< 原三角面数
+    DftUInt64 _resultTriangles;   ///< 简化后的三角面数
+    DftFloat _error;              ///< 节点下各几何的最大误差
+
+    NodeSimplifyReport() : _nodeID(0), _sourceTriangles(0), _resultTriangles(0), _error(0.0f) {}
+
+    /** 三角面减少的比例 */
+    DftDouble GetReduction() const
+    {
+        return _sourceTriangles ? 1.0 - static_cast<DftDouble>(_resultTriangles) / _sourceTriangles : 0.0;
+    }
+};
+
+/**
+ * @brief 计算一份几何的简化目标
+ * @return SimplifyTarget 简化目标
+ * @param[in] iOptions 简化参数
+ * @param[in] iSourceTriangles 几何的原三角面数
+ * @param[in] iNodeTriangles 所属节点的原三角面总数，用于按节点上限收紧目标
+ */
+SimplifyTarget GetSimplifyTarget(const SimplifyOptions& iOptions, DftUInt iSourceTriangles, DftUInt64 iNodeTriangles);
+
+/**
+ * @brief 简化一份几何
+ * @return DftBool 是否成功，输入索引越界时为FALSE
+ * @param[in] iSource 原几何
+ * @param[in] iTarget 简化目标
+ * @param[out] oResult 简化后的几何，只包含仍被引用的顶点，同时记录原三角面数、目标和误差；不需要简化时为原几何的拷贝
+ * @param[out] oSourceVertexes 简化后每个顶点在原几何中的序号，用于取出坐标和法向以外的顶点分量，可为NULL
+ */
+DftBool SimplifyGeometry(const CachedGeometry& iSource, const SimplifyTarget& iTarget, CachedGeometry& oResult,
+    std::vector<DftUInt>* oSourceVertexes = NULL);
+
+/**
+ * @brief 把各节点的简化结果写成CSV报告
+ * @return DftBool 是否成功
+ * @param[in] iReports 简化结果
+ * @param[in] iReportPath 报告路径
+ */
+DftBool WriteSimplifyReport(const std::vector<NodeSimplifyReport>& iReports, const std::string& iReportPath);
+
+#endif
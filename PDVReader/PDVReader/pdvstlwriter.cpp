@@ -0,0 +1,202 @@
+#include "pdvstlwriter.h"
+#include "pdvfilewriter.h"
+#include "pdvlod.h"
+#include "pdvsceneindex.h"
+#include "pdvtextformat.h"
+#include "PDVISceneData.h"
+#include "PDVIRenderGeometry.h"
+#include <cstring>
+#include <vector>
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+// 追加字面量，iText为字符串常量
+template <size_t N>
+char* AppendLiteral(char* oBuffer, const char (&iText)[N])
+{
+    memcpy(oBuffer, iText, N - 1);
+    return oBuffer + N - 1;
+}
+
+// 追加" x y z"
+char* AppendVector(char* oBuffer, const DftFloat* iVector)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        *oBuffer++ = ' ';
+        oBuffer = FormatGeneral(oBuffer, iVector[i], PDV_TEXT_DEFAULT_PRECISION);
+    }
+    return oBuffer;
+}
+
+size_t EncodeAsciiFacet(const DftFloat* iNormal, const DftFloat* iP1, const DftFloat* iP2, const DftFloat* iP3, DftByte* oBuffer)
+{
+    // 与ofstream默认的浮点输出一致（%g，6位有效数字），每个数最多13字节，整个面片不会超过STL_ASCII_FACET_MAX_SIZE
+    char* begin = reinterpret_cast<char*>(oBuffer);
+    char* ptr = AppendLiteral(begin, "   facet normal");
+    ptr = AppendVector(ptr, iNormal);
+    ptr = AppendLiteral(ptr, "\n      outer loop\n         vertex");
+    ptr = AppendVector(ptr, iP1);
+    ptr = AppendLiteral(ptr, "\n         vertex");
+    ptr = AppendVector(ptr, iP2);
+    ptr = AppendLiteral(ptr, "\n         vertex");
+    ptr = AppendVector(ptr, iP3);
+    ptr = AppendLiteral(ptr, "\n      endloop\n   endfacet\n");
+    return static_cast<size_t>(ptr - begin);
+}
+
+size_t EncodeBinaryFacet(const DftFloat* iNormal, const DftFloat* iP1, const DftFloat* iP2, const DftFloat* iP3, DftByte* oBuffer)
+{
+    memcpy(oBuffer, iNormal, 12);
+    memcpy(oBuffer + 12, iP1, 12);
+    memcpy(oBuffer + 24, iP2, 12);
+    memcpy(oBuffer + 36, iP3, 12);
+    oBuffer[48] = 0;
+    oBuffer[49] = 0;
+    return STL_BINARY_FACET_SIZE;
+}
+
+} // namespace
+
+// ASCII格式的STL输出
+class CAsciiStlWriter : public IStlWriter
+{
+public:
+    CAsciiStlWriter() : m_FacetCount(0) {}
+
+    // ASCII格式没有三角面数字段，不需要预计的数量
+    DftBool Open(const string& iPath, const string& iSolidName, DftUInt64 /*iFacetCount*/)
+    {
+        m_FacetCount = 0;
+        if (!m_Writer.Open(iPath))
+            return FALSE;
+        m_Writer.Write("solid " + iSolidName + "\n");
+        return TRUE;
+    }
+
+    void AddFacet(const DftFloat* iNormal, const DftFloat* iP1, const DftFloat* iP2, const DftFloat* iP3)
+    {
+        DftByte* ptr = m_Writer.Reserve(STL_ASCII_FACET_MAX_SIZE);
+        m_Writer.Unreserve(STL_ASCII_FACET_MAX_SIZE - EncodeAsciiFacet(iNormal, iP1, iP2, iP3, ptr));
+        m_FacetCount++;
+    }
+
+    void AddEncodedFacets(const DftByte* iData, size_t iSize, DftUInt64 iFacetCount)
+    {
+        m_Writer.Write(iData, iSize);
+        m_FacetCount += iFacetCount;
+    }
+
+    DftBool Close()
+    {
+        if (!m_Writer.IsOpen())
+            return FALSE;
+        m_Writer.Write(string("endsolid\n"));
+        return m_Writer.Close();
+    }
+
+    DftUInt64 GetFacetCount() const { return m_FacetCount; }
+    DftUInt64 GetBytesWritten() const { return m_Writer.GetBytesWritten(); }
+
+private:
+    CBufferedFileWriter m_Writer; ///< 缓冲输出
+    DftUInt64 m_FacetCount;       ///< 已输出的三角面数
+};
+
+// 二进制格式的STL输出：80字节文件头 + 4字节三角面数 + 每个三角面50字节
+class CBinaryStlWriter : public IStlWriter
+{
+public:
+    CBinaryStlWriter() : m_FacetCount(0), m_DeclaredCount(0) {}
+
+    DftBool Open(const string& iPath, const string& iSolidName, DftUInt64 iFacetCount)
+    {
+        m_FacetCount = 0;
+        m_DeclaredCount = iFacetCount;
+        if (!m_Writer.Open(iPath))
+            return FALSE;
+
+        // 文件头不能以"solid"开头，否则部分软件会按ASCII格式解析
+        DftByte header[STL_BINARY_HEADER_SIZE];
+        memset(header, 0, sizeof(header));
+        string title = "PDVReader binary STL: " + iSolidName;
+        memcpy(header, title.data(), title.size() < sizeof(header) ? title.size() : sizeof(header));
+        m_Writer.Write(header, sizeof(header));
+
+        DftUInt32 count = ClampCount(iFacetCount);
+        m_Writer.Write(&count, sizeof(count));
+        return TRUE;
+    }
+
+    void AddFacet(const DftFloat* iNormal, const DftFloat* iP1, const DftFloat* iP2, const DftFloat* iP3)
+    {
+        EncodeBinaryFacet(iNormal, iP1, iP2, iP3, m_Writer.Reserve(STL_BINARY_FACET_SIZE));
+        m_FacetCount++;
+    }
+
+    void AddEncodedFacets(const DftByte* iData, size_t iSize, DftUInt64 iFacetCount)
+    {
+        m_Writer.Write(iData, iSize);
+        m_FacetCount += iFacetCount;
+    }
+
+    DftBool Close()
+    {
+        if (!m_Writer.IsOpen())
+            return FALSE;
+        if (m_FacetCount != m_DeclaredCount)
+        {
+            DftUInt32 count = ClampCount(m_FacetCount);
+            m_Writer.WriteAt(STL_BINARY_HEADER_SIZE, &count, sizeof(count));
+        }
+        return m_Writer.Close();
+    }
+
+    DftUInt64 GetFacetCount() const { return m_FacetCount; }
+    DftUInt64 GetBytesWritten() const { return m_Writer.GetBytesWritten(); }
+
+private:
+    static DftUInt32 ClampCount(DftUInt64 iCount)
+    {
+        return iCount > 0xFFFFFFFFull ? 0xFFFFFFFFu : static_cast<DftUInt32>(iCount);
+    }
+
+    CBufferedFileWriter m_Writer; ///< 缓冲输出
+    DftUInt64 m_FacetCount;       ///< 已输出的三角面数
+    DftUInt64 m_DeclaredCount;    ///< 文件头中写入的三角面数
+};
+
+IStlWriter* CreateStlWriter(StlFormat iFormat)
+{
+    if (iFormat == STL_FORMAT_BINARY)
+        return new CBinaryStlWriter();
+    return new CAsciiStlWriter();
+}
+
+size_t EncodeStlFacet(StlFormat iFormat, const DftFloat* iNormal, const DftFloat* iP1, const DftFloat* iP2, const DftFloat* iP3,
+    DftByte* oBuffer)
+{
+    if (iFormat == STL_FORMAT_BINARY)
+        return EncodeBinaryFacet(iNormal, iP1, iP2, iP3, oBuffer);
+    return EncodeAsciiFacet(iNormal, iP1, iP2, iP3, oBuffer);
+}
+
+size_t GetStlFacetMaxSize(StlFormat iFormat)
+{
+    return iFormat == STL_FORMAT_BINARY ? STL_BINARY_FACET_SIZE : STL_ASCII_FACET_MAX_SIZE;
+}
+
+DftUInt64 CountModelStlFacets(const CSceneIndex& iSceneIndex, IModel* iModel, const LodSelectOptions* iLod)
+{
+    std::vector<LodMeshSelection> meshes;
+    SelectModelGeometries(iSceneIndex, iModel, iLod, meshes);
+
+    DftUInt64 facetCount = 0;
+    for (size_t i = 0; i < meshes.size(); i++)
+        facetCount += meshes[i]._geometry->GetIndexCount() / 3;
+    return facetCount;
+}
@@ -0,0 +1,126 @@
+/**
+ * @file pdvstlwriter.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：STL文件输出接口
+ * @details ASCII与二进制两种格式共用同一接口，输出均经过大块缓冲，二进制格式的三角面数在打开文件时给出
+ */
+
+#ifndef PDVSTLWRITER_H
+#define PDVSTLWRITER_H
+
+#include "DftBase.h"
+#include <string>
+
+namespace kernel
+{
+namespace pdv
+{
+class IModel;
+} // namespace pdv
+} // namespace kernel
+
+class CSceneIndex;
+struct LodSelectOptions;
+
+/** @brief STL文件格式 */
+enum StlFormat
+{
+    STL_FORMAT_ASCII = 0,  ///< ASCII格式
+    STL_FORMAT_BINARY = 1, ///< 二进制格式，每个三角面为50字节的定长记录
+};
+
+/** @brief 二进制STL文件头长度 */
+#define STL_BINARY_HEADER_SIZE 80
+/** @brief 二进制STL单个三角面记录长度 */
+#define STL_BINARY_FACET_SIZE 50
+/** @brief ASCII格式单个三角面编码后的最大长度：固定文字107字节，12个数各带一个空格最多13字节 */
+#define STL_ASCII_FACET_MAX_SIZE 263
+/** @brief 单个三角面编码后的最大长度（两种格式通用） */
+#define STL_FACET_MAX_SIZE STL_ASCII_FACET_MAX_SIZE
+
+/** @brief STL文件输出接口 */
+class IStlWriter
+{
+public:
+    virtual ~IStlWriter() {}
+
+    /**
+     * @brief 创建STL文件并写入文件头
+     * @return DftBool 是否成功
+     * @param[in] iPath 文件路径
+     * @param[in] iSolidName 实体名称
+     * @param[in] iFacetCount 预计输出的三角面数，二进制格式据此写入文件头，关闭时若与实际数量不符会回填
+     */
+    virtual DftBool Open(const std::string& iPath, const std::string& iSolidName, DftUInt64 iFacetCount) = 0;
+
+    /**
+     * @brief 输出一个三角面
+     * @param[in] iNormal 法向
+     * @param[in] iP1 第一个顶点
+     * @param[in] iP2 第二个顶点
+     * @param[in] iP3 第三个顶点
+     */
+    virtual void AddFacet(const DftFloat* iNormal, const DftFloat* iP1, const DftFloat* iP2, const DftFloat* iP3) = 0;
+
+    /**
+     * @brief 输出一段已由EncodeStlFacet编码好的三角面数据
+     * @param[in] iData 数据首地址
+     * @param[in] iSize 数据字节数
+     * @param[in] iFacetCount 数据中包含的三角面数
+     * @note 数据必须按本对象的格式编码
+     */
+    virtual void AddEncodedFacets(const DftByte* iData, size_t iSize, DftUInt64 iFacetCount) = 0;
+
+    /**
+     * @brief 写入文件尾并关闭文件
+     * @return DftBool 所有数据是否都已成功写入
+     */
+    virtual DftBool Close() = 0;
+
+    /** @brief 已输出的三角面数 */
+    virtual DftUInt64 GetFacetCount() const = 0;
+
+    /** @brief 已输出的字节数 */
+    virtual DftUInt64 GetBytesWritten() const = 0;
+};
+
+/**
+ * @brief 创建STL文件输出对象
+ * @return IStlWriter* 输出对象，使用完毕后由调用方delete
+ * @param[in] iFormat 文件格式
+ */
+IStlWriter* CreateStlWriter(StlFormat iFormat);
+
+/**
+ * @brief 将一个三角面编码为STL格式，输出与IStlWriter::AddFacet逐字节一致
+ * @return size_t 编码后的字节数
+ * @param[in] iFormat 文件格式
+ * @param[in] iNormal 法向
+ * @param[in] iP1 第一个顶点
+ * @param[in] iP2 第二个顶点
+ * @param[in] iP3 第三个顶点
+ * @param[out] oBuffer 输出地址，容量不少于GetStlFacetMaxSize(iFormat)
+ * @note 用于在多个线程中分别编码，再按顺序交给IStlWriter::AddEncodedFacets输出
+ */
+size_t EncodeStlFacet(StlFormat iFormat, const DftFloat* iNormal, const DftFloat* iP1, const DftFloat* iP2, const DftFloat* iP3,
+    DftByte* oBuffer);
+
+/**
+ * @brief 单个三角面编码后的最大长度
+ * @return size_t 二进制格式为STL_BINARY_FACET_SIZE，ASCII格式为STL_ASCII_FACET_MAX_SIZE
+ * @param[in] iFormat 文件格式
+ */
+size_t GetStlFacetMaxSize(StlFormat iFormat);
+
+/**
+ * @brief 统计模型主体网格的三角面数
+ * @return DftUInt64 三角面数
+ * @param[in] iSceneIndex 场景对象索引
+ * @param[in] iModel 模型
+ * @param[in] iLod LOD选择参数，为NULL时统计每个网格的第一个渲染几何
+ * @note 只读取索引个数，不读取索引数据
+ */
+DftUInt64 CountModelStlFacets(const CSceneIndex& iSceneIndex, kernel::pdv::IModel* iModel, const LodSelectOptions* iLod = NULL);
+
+#endif
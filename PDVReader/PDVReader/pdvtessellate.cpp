@@ -0,0 +1,2565 @@
+#include "pdvtessellate.h"
+#include "PDVISceneData.h"
+#include "PDVIModel.h"
+#include "PDVIObjectFactory.h"
+#include "PDVIRenderBody.h"
+#include "PDVIRenderGeometry.h"
+#include "PDVIRenderMesh.h"
+#include "PDVICurve.h"
+#include "PDVISurface.h"
+#include "PDVITopo.h"
+#include "pdvnurbs.h"
+#include "pdvsceneindex.h"
+#include "pdvthreadpool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+#include <unordered_map>
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+const double PI = 3.14159265358979323846;
+const double TWO_PI = 2.0 * PI;
+// 圆、椭圆和曲面周期方向初始分段的最大角度
+const double MAX_ANGLE_STEP = PI / 4.0;
+// 边端点与顶点的距离不超过弦高误差的这个倍数时对齐到顶点
+const double VERTEX_SNAP_FACTOR = 100.0;
+// 网格单元平均包含的裁剪点数上限，裁剪点较多时加密网格，限制单元内耳切的规模
+const double TRIM_POINTS_PER_CELL = 8.0;
+// 只有参数曲线的边（如收缩到极点的退化边）的分段数
+const DftUInt PCURVE_SEGMENTS = 16;
+// 网格线与裁剪点坐标的最小间距（相对参数范围），更近时移开网格线
+const double GRID_LINE_EPSILON = 1e-9;
+// 网格线移开的距离（相对相邻单元的宽度）
+const double GRID_LINE_NUDGE = 1e-4;
+const DftUInt INVALID_INDEX = 0xFFFFFFFFu;
+
+inline void Sub(const double* a, const double* b, double* r)
+{
+    r[0] = a[0] - b[0];
+    r[1] = a[1] - b[1];
+    r[2] = a[2] - b[2];
+}
+
+inline void Cross(const double* a, const double* b, double* r)
+{
+    r[0] = a[1] * b[2] - a[2] * b[1];
+    r[1] = a[2] * b[0] - a[0] * b[2];
+    r[2] = a[0] * b[1] - a[1] * b[0];
+}
+
+inline double Dot(const double* a, const double* b)
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+inline double Normalize(double* v)
+{
+    double length = sqrt(Dot(v, v));
+    if (length > 0.0)
+    {
+        v[0] /= length;
+        v[1] /= length;
+        v[2] /= length;
+    }
+    return length;
+}
+
+inline double Distance(const double* a, const double* b)
+{
+    double d[3];
+    Sub(a, b, d);
+    return sqrt(Dot(d, d));
+}
+
+// 点到线段的距离
+double DistanceToSegment(const double* p, const double* a, const double* b)
+{
+    double ab[3];
+    double ap[3];
+    Sub(b, a, ab);
+    Sub(p, a, ap);
+    double length2 = Dot(ab, ab);
+    double t = length2 > 0.0 ? Dot(ap, ab) / length2 : 0.0;
+    t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+    double q[3] = { a[0] + t * ab[0], a[1] + t * ab[1], a[2] + t * ab[2] };
+    return Distance(p, q);
+}
+
+// 二维有向面积的两倍，a、b、c逆时针时为正
+inline double Orient2d(const double* a, const double* b, const double* c)
+{
+    return (b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]);
+}
+
+// 角度折算到[0, 2π)，在原点附近无法确定时为NaN
+double PolarAngle(double iX, double iY, double iScale)
+{
+    if (sqrt(iX * iX + iY * iY) <= iScale * 1e-12)
+        return numeric_limits<double>::quiet_NaN();
+    double angle = atan2(iY, iX);
+    return angle < 0.0 ? angle + TWO_PI : angle;
+}
+
+/** 三维或二维曲线的求值，二维曲线的z为0 */
+class CCurveGeometry
+{
+public:
+    CCurveGeometry() : m_Type(CT_UNDIFINED), m_Radius(0.0), m_MinorRadius(0.0)
+    {
+        fill(m_Origin, m_Origin + 3, 0.0);
+        fill(m_X, m_X + 3, 0.0);
+        fill(m_Y, m_Y + 3, 0.0);
+    }
+
+    bool Init(const BRepArchiveCurve& iCurve)
+    {
+        m_Type = iCurve._parameterType;
+        copy(iCurve._origin._data, iCurve._origin._data + 3, m_Origin);
+        copy(iCurve._xDirection._data, iCurve._xDirection._data + 3, m_X);
+        copy(iCurve._yDirection._data, iCurve._yDirection._data + 3, m_Y);
+        m_Radius = iCurve._radius;
+        m_MinorRadius = iCurve._minorRadius;
+        if (m_Type == CT_BSPLINECURVE)
+            return m_Nurbs.Init(iCurve._nurbs) == TRUE;
+        return m_Type == CT_LINE || m_Type == CT_CIRCLE || m_Type == CT_ELLIPSE;
+    }
+
+    bool Init(const BRepArchiveCurve2d& iCurve)
+    {
+        m_Type = iCurve._parameterType;
+        copy(iCurve._origin._data, iCurve._origin._data + 2, m_Origin);
+        copy(iCurve._xDirection._data, iCurve._xDirection._data + 2, m_X);
+        copy(iCurve._yDirection._data, iCurve._yDirection._data + 2, m_Y);
+        m_Origin[2] = m_X[2] = m_Y[2] = 0.0;
+        m_Radius = iCurve._radius;
+        m_MinorRadius = iCurve._minorRadius;
+        if (m_Type == CT_BSPLINECURVE)
+            return m_Nurbs.Init(iCurve._nurbs) == TRUE;
+        return m_Type == CT_LINE || m_Type == CT_CIRCLE || m_Type == CT_ELLIPSE;
+    }
+
+    DftUInt8 GetType() const { return m_Type; }
+
+    // 直线上点的参数
+    double Project(const double* iPoint) const
+    {
+        double d[3];
+        Sub(iPoint, m_Origin, d);
+        double length2 = Dot(m_X, m_X);
+        return length2 > 0.0 ? Dot(d, m_X) / length2 : 0.0;
+    }
+
+    // 记录的参数范围为空时取曲线本身的范围，直线没有本身的范围
+    bool ResolveRange(double iStart, double iEnd, double& oStart, double& oEnd) const
+    {
+        if (iStart != iEnd && std::isfinite(iStart) && std::isfinite(iEnd))
+        {
+            oStart = iStart;
+            oEnd = iEnd;
+            return true;
+        }
+        if (m_Type == CT_CIRCLE || m_Type == CT_ELLIPSE)
+        {
+            oStart = 0.0;
+            oEnd = TWO_PI;
+            return true;
+        }
+        if (m_Type == CT_BSPLINECURVE)
+        {
+            oStart = m_Nurbs.GetBasis().GetStart();
+            oEnd = m_Nurbs.GetBasis().GetEnd();
+            return true;
+        }
+        return false;
+    }
+
+    // 初始分段点，含两端：NURBS按节点区间（二次以上每个区间再分两段），圆和椭圆按角度，直线一段
+    void GetInitialParams(double iStart, double iEnd, vector<double>& oParams) const
+    {
+        double low = min(iStart, iEnd);
+        double high = max(iStart, iEnd);
+        vector<double> breaks(1, low);
+        if (m_Type == CT_BSPLINECURVE)
+        {
+            vector<double> knots;
+            m_Nurbs.GetBasis().GetBreakpoints(knots);
+            for (size_t k = 0; k < knots.size(); k++)
+            {
+                if (knots[k] > low && knots[k] < high)
+                    breaks.push_back(knots[k]);
+            }
+        }
+        breaks.push_back(high);
+
+        oParams.assign(1, low);
+        for (size_t k = 0; k + 1 < breaks.size(); k++)
+        {
+            double length = breaks[k + 1] - breaks[k];
+            size_t pieces = 1;
+            if (m_Type == CT_CIRCLE || m_Type == CT_ELLIPSE)
+                pieces = max<size_t>(1, static_cast<size_t>(ceil(length / MAX_ANGLE_STEP)));
+            else if (m_Type == CT_BSPLINECURVE && m_Nurbs.GetBasis().GetDegree() >= 2)
+                pieces = 2;
+            for (size_t m = 1; m < pieces; m++)
+                oParams.push_back(breaks[k] + length * m / pieces);
+            oParams.push_back(breaks[k + 1]);
+        }
+        if (iStart > iEnd)
+            reverse(oParams.begin(), oParams.end());
+    }
+
+    void Evaluate(const double* iParams, size_t iCount, double* oPoints) const
+    {
+        if (m_Type == CT_BSPLINECURVE)
+        {
+            m_Nurbs.Evaluate(iParams, iCount, oPoints, NULL);
+            return;
+        }
+        for (size_t i = 0; i < iCount; i++)
+        {
+            double t = iParams[i];
+            double a = t;
+            double b = 0.0;
+            const double* x = m_X;
+            if (m_Type == CT_CIRCLE || m_Type == CT_ELLIPSE)
+            {
+                a = m_Radius * cos(t);
+                b = (m_Type == CT_CIRCLE ? m_Radius : m_MinorRadius) * sin(t);
+            }
+            for (int c = 0; c < 3; c++)
+                oPoints[i * 3 + c] = m_Origin[c] + a * x[c] + b * m_Y[c];
+        }
+    }
+
+private:
+    DftUInt8 m_Type;                 ///< 参数块的类型
+    double m_Origin[3];              ///< 原点
+    double m_X[3];                   ///< X方向，直线时为方向
+    double m_Y[3];                   ///< Y方向
+    double m_Radius;                 ///< 半径或长半轴
+    double m_MinorRadius;            ///< 短半轴
+    CNurbsCurveEvaluator m_Nurbs;    ///< NURBS曲线
+};
+
+/** 曲面的求值与求逆，初等曲面的参数化与常见几何内核一致，法向为Du×Dv的方向 */
+class CSurfaceGeometry
+{
+public:
+    CSurfaceGeometry() : m_Type(ST_UNDIFINED), m_Radius(0.0), m_MinorRadius(0.0), m_HalfAngle(0.0), m_HasDomain(false)
+    {
+        fill(m_Origin, m_Origin + 3, 0.0);
+        fill(m_X, m_X + 3, 0.0);
+        fill(m_Y, m_Y + 3, 0.0);
+        fill(m_Z, m_Z + 3, 0.0);
+        fill(m_Normal, m_Normal + 3, 0.0);
+        fill(m_DomainMin, m_DomainMin + 2, 0.0);
+        fill(m_DomainMax, m_DomainMax + 2, 0.0);
+    }
+
+    bool Init(const BRepArchiveSurface& iSurface)
+    {
+        m_Type = iSurface._parameterType;
+        copy(iSurface._origin._data, iSurface._origin._data + 3, m_Origin);
+        copy(iSurface._xDirection._data, iSurface._xDirection._data + 3, m_X);
+        copy(iSurface._yDirection._data, iSurface._yDirection._data + 3, m_Y);
+        copy(iSurface._zDirection._data, iSurface._zDirection._data + 3, m_Z);
+        m_Radius = iSurface._radius;
+        m_MinorRadius = iSurface._minorRadius;
+        m_HalfAngle = iSurface._halfAngle;
+
+        // 记录的参数域只在有限且非空时用于没有界限的方向
+        m_HasDomain = true;
+        for (int d = 0; d < 2; d++)
+        {
+            m_DomainMin[d] = iSurface._domainMin._data[d];
+            m_DomainMax[d] = iSurface._domainMax._data[d];
+            if (!(m_DomainMax[d] > m_DomainMin[d]) || fabs(m_DomainMin[d]) > 1e100 || fabs(m_DomainMax[d]) > 1e100)
+                m_HasDomain = false;
+        }
+
+        if (m_Type == ST_BSPLINESURFACE)
+            return m_Nurbs.Init(iSurface._nurbs) == TRUE;
+        if (m_Type < ST_PLANE || m_Type > ST_SPHERE)
+            return false;
+        if (Normalize(m_X) == 0.0 || Normalize(m_Y) == 0.0)
+            return false;
+        if (Normalize(m_Z) == 0.0)
+        {
+            Cross(m_X, m_Y, m_Z);
+            Normalize(m_Z);
+        }
+        Cross(m_X, m_Y, m_Normal);
+        Normalize(m_Normal);
+        switch (m_Type)
+        {
+        case ST_CYLINDER:
+        case ST_SPHERE:
+            return m_Radius > 0.0;
+        case ST_CONE:
+            return cos(m_HalfAngle) != 0.0;
+        case ST_TORUS:
+            return m_Radius > 0.0 && m_MinorRadius > 0.0;
+        default:
+            return true;
+        }
+    }
+
+    DftUInt8 GetType() const { return m_Type; }
+    bool CanInvert() const { return m_Type >= ST_PLANE && m_Type <= ST_SPHERE; }
+
+    bool IsPeriodic(int iDirection) const
+    {
+        switch (m_Type)
+        {
+        case ST_CYLINDER:
+        case ST_CONE:
+        case ST_SPHERE:
+            return iDirection == 0;
+        case ST_TORUS:
+            return true;
+        case ST_BSPLINESURFACE:
+            return GetBasis(iDirection).IsPeriodic() == TRUE;
+        default:
+            return false;
+        }
+    }
+
+    double GetPeriod(int iDirection) const
+    {
+        if (m_Type == ST_BSPLINESURFACE)
+            return GetBasis(iDirection).GetEnd() - GetBasis(iDirection).GetStart();
+        return TWO_PI;
+    }
+
+    // 按角度参数化的方向
+    bool IsAngular(int iDirection) const
+    {
+        return m_Type == ST_SPHERE || m_Type == ST_TORUS || ((m_Type == ST_CYLINDER || m_Type == ST_CONE) && iDirection == 0);
+    }
+
+    // 参数方向的取值范围，没有界限时为false
+    bool GetRange(int iDirection, double& oMin, double& oMax) const
+    {
+        if (m_Type == ST_BSPLINESURFACE)
+        {
+            oMin = GetBasis(iDirection).GetStart();
+            oMax = GetBasis(iDirection).GetEnd();
+            return true;
+        }
+        if (IsPeriodic(iDirection))
+        {
+            oMin = 0.0;
+            oMax = TWO_PI;
+            return true;
+        }
+        if (m_Type == ST_SPHERE)
+        {
+            oMin = -0.5 * PI;
+            oMax = 0.5 * PI;
+            return true;
+        }
+        if (m_HasDomain)
+        {
+            oMin = m_DomainMin[iDirection];
+            oMax = m_DomainMax[iDirection];
+            return true;
+        }
+        return false;
+    }
+
+    // 从iValue朝上界或下界一侧的参数域界限，圆锥没有界限时取锥顶
+    bool GetBound(int iDirection, bool iUpper, double iValue, double& oBound) const
+    {
+        double low;
+        double high;
+        if (GetRange(iDirection, low, high))
+        {
+            oBound = iUpper ? high : low;
+            return true;
+        }
+        if (m_Type == ST_CONE && iDirection == 1 && sin(m_HalfAngle) != 0.0)
+        {
+            double apex = -m_Radius / sin(m_HalfAngle);
+            if (iUpper ? apex > iValue : apex < iValue)
+            {
+                oBound = apex;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // [iStart, iEnd]的初始分段点，含两端：NURBS按节点区间（二次以上每个区间再分两段），角度方向按最大角度，其余一段
+    void GetPilotParams(int iDirection, double iStart, double iEnd, vector<double>& oParams) const
+    {
+        vector<double> breaks(1, iStart);
+        size_t pieces = 1;
+        if (m_Type == ST_BSPLINESURFACE)
+        {
+            vector<double> knots;
+            GetBasis(iDirection).GetBreakpoints(knots);
+            for (size_t k = 0; k < knots.size(); k++)
+            {
+                if (knots[k] > iStart && knots[k] < iEnd)
+                    breaks.push_back(knots[k]);
+            }
+            if (GetBasis(iDirection).GetDegree() >= 2)
+                pieces = 2;
+        }
+        breaks.push_back(iEnd);
+
+        oParams.assign(1, iStart);
+        for (size_t k = 0; k + 1 < breaks.size(); k++)
+        {
+            double length = breaks[k + 1] - breaks[k];
+            size_t count = pieces;
+            if (IsAngular(iDirection))
+                count = max<size_t>(1, static_cast<size_t>(ceil(length / MAX_ANGLE_STEP)));
+            for (size_t m = 1; m < count; m++)
+                oParams.push_back(breaks[k] + length * m / count);
+            oParams.push_back(breaks[k + 1]);
+        }
+    }
+
+    // 批量求值点和单位法向
+    void Evaluate(const double* iU, const double* iV, size_t iCount, double* oPoints, double* oNormals) const
+    {
+        if (m_Type == ST_BSPLINESURFACE)
+        {
+            EvaluateNurbs(iU, iV, iCount, oPoints, oNormals);
+            return;
+        }
+        for (size_t i = 0; i < iCount; i++)
+        {
+            double u = iU[i];
+            double v = iV[i];
+            double* point = oPoints + i * 3;
+            double* normal = oNormals + i * 3;
+            if (m_Type == ST_PLANE)
+            {
+                for (int c = 0; c < 3; c++)
+                {
+                    point[c] = m_Origin[c] + u * m_X[c] + v * m_Y[c];
+                    normal[c] = m_Normal[c];
+                }
+                continue;
+            }
+
+            // 回转面：er = cos(u)·X + sin(u)·Y
+            double cu = cos(u);
+            double su = sin(u);
+            double er[3];
+            for (int c = 0; c < 3; c++)
+                er[c] = cu * m_X[c] + su * m_Y[c];
+            double radial = 0.0;
+            double axial = 0.0;
+            double normalRadial = 1.0;
+            double normalAxial = 0.0;
+            switch (m_Type)
+            {
+            case ST_CYLINDER:
+                radial = m_Radius;
+                axial = v;
+                break;
+            case ST_CONE:
+            {
+                radial = m_Radius + v * sin(m_HalfAngle);
+                axial = v * cos(m_HalfAngle);
+                double sign = radial < 0.0 ? -1.0 : 1.0;
+                normalRadial = sign * cos(m_HalfAngle);
+                normalAxial = -sign * sin(m_HalfAngle);
+                break;
+            }
+            case ST_SPHERE:
+                radial = m_Radius * cos(v);
+                axial = m_Radius * sin(v);
+                normalRadial = cos(v);
+                normalAxial = sin(v);
+                break;
+            case ST_TORUS:
+                radial = m_Radius + m_MinorRadius * cos(v);
+                axial = m_MinorRadius * sin(v);
+                normalRadial = cos(v);
+                normalAxial = sin(v);
+                break;
+            }
+            for (int c = 0; c < 3; c++)
+            {
+                point[c] = m_Origin[c] + radial * er[c] + axial * m_Z[c];
+                normal[c] = normalRadial * er[c] + normalAxial * m_Z[c];
+            }
+        }
+    }
+
+    // 三维点换算为参数，u在回转轴上时为NaN
+    bool Invert(const double* iPoint, double& oU, double& oV) const
+    {
+        double d[3];
+        Sub(iPoint, m_Origin, d);
+        double x = Dot(d, m_X);
+        double y = Dot(d, m_Y);
+        double z = Dot(d, m_Z);
+        double scale = max(m_Radius, sqrt(Dot(d, d)));
+        switch (m_Type)
+        {
+        case ST_PLANE:
+            oU = x;
+            oV = y;
+            return true;
+        case ST_CYLINDER:
+            oU = PolarAngle(x, y, scale);
+            oV = z;
+            return true;
+        case ST_CONE:
+            oV = z / cos(m_HalfAngle);
+            oU = m_Radius + oV * sin(m_HalfAngle) < 0.0 ? PolarAngle(-x, -y, scale) : PolarAngle(x, y, scale);
+            return true;
+        case ST_SPHERE:
+            oU = PolarAngle(x, y, scale);
+            oV = atan2(z, sqrt(x * x + y * y));
+            return true;
+        case ST_TORUS:
+            oU = PolarAngle(x, y, scale);
+            oV = atan2(z, sqrt(x * x + y * y) - m_Radius);
+            return true;
+        default:
+            return false;
+        }
+    }
+
+private:
+    const CBSplineBasis& GetBasis(int iDirection) const { return iDirection == 0 ? m_Nurbs.GetUBasis() : m_Nurbs.GetVBasis(); }
+
+    // 法向为两个偏导的叉积；退化处（如收缩为一点的边界）朝参数域中心逐步微移后再取
+    void EvaluateNurbs(const double* iU, const double* iV, size_t iCount, double* oPoints, double* oNormals) const
+    {
+        vector<double> derivatives(iCount * 6);
+        m_Nurbs.Evaluate(iU, iV, iCount, oPoints, &derivatives[0]);
+        vector<size_t> degenerate;
+        for (size_t i = 0; i < iCount; i++)
+        {
+            if (!NurbsNormal(&derivatives[i * 6], oNormals + i * 3))
+                degenerate.push_back(i);
+        }
+
+        double low[2];
+        double high[2];
+        GetRange(0, low[0], high[0]);
+        GetRange(1, low[1], high[1]);
+        const double steps[] = { 1e-6, 1e-4, 1e-2 };
+        vector<double> u;
+        vector<double> v;
+        vector<double> points;
+        for (size_t s = 0; s < sizeof(steps) / sizeof(steps[0]) && !degenerate.empty(); s++)
+        {
+            u.resize(degenerate.size());
+            v.resize(degenerate.size());
+            for (size_t k = 0; k < degenerate.size(); k++)
+            {
+                double du = (high[0] - low[0]) * steps[s];
+                double dv = (high[1] - low[1]) * steps[s];
+                u[k] = iU[degenerate[k]] + (iU[degenerate[k]] <= 0.5 * (low[0] + high[0]) ? du : -du);
+                v[k] = iV[degenerate[k]] + (iV[degenerate[k]] <= 0.5 * (low[1] + high[1]) ? dv : -dv);
+            }
+            points.resize(degenerate.size() * 3);
+            derivatives.resize(degenerate.size() * 6);
+            m_Nurbs.Evaluate(&u[0], &v[0], degenerate.size(), &points[0], &derivatives[0]);
+            size_t remaining = 0;
+            for (size_t k = 0; k < degenerate.size(); k++)
+            {
+                if (!NurbsNormal(&derivatives[k * 6], oNormals + degenerate[k] * 3))
+                    degenerate[remaining++] = degenerate[k];
+            }
+            degenerate.resize(remaining);
+        }
+    }
+
+    static bool NurbsNormal(const double* iDerivatives, double* oNormal)
+    {
+        Cross(iDerivatives, iDerivatives + 3, oNormal);
+        double scale = sqrt(Dot(iDerivatives, iDerivatives) * Dot(iDerivatives + 3, iDerivatives + 3));
+        return Normalize(oNormal) > scale * 1e-12 && scale > 0.0;
+    }
+
+    DftUInt8 m_Type;                   ///< 参数块的类型
+    double m_Origin[3];                ///< 原点
+    double m_X[3];                     ///< X方向
+    double m_Y[3];                     ///< Y方向
+    double m_Z[3];                     ///< Z方向
+    double m_Normal[3];                ///< 平面的法向X×Y
+    double m_Radius;                   ///< 半径或大半径
+    double m_MinorRadius;              ///< 小半径
+    double m_HalfAngle;                ///< 圆锥半角
+    bool m_HasDomain;                  ///< 记录的参数域是否可用
+    double m_DomainMin[2];             ///< 记录的参数域最小值
+    double m_DomainMax[2];             ///< 记录的参数域最大值
+    CNurbsSurfaceEvaluator m_Nurbs;    ///< NURBS曲面
+};
+
+/** 边的三维采样，按曲线的参数方向排列 */
+struct EdgeSamples
+{
+    vector<double> _params;  ///< 曲线参数
+    vector<double> _points;  ///< 三维点，每个3个分量
+    double _start;           ///< 曲线参数范围的起点，用于换算参数曲线的参数
+    double _end;             ///< 曲线参数范围的终点
+
+    EdgeSamples() : _start(0.0), _end(0.0) {}
+    size_t GetCount() const { return _params.size(); }
+};
+
+typedef unordered_map<DftUInt64, EdgeSamples> EdgeSampleMap;
+
+// 采样的首尾对齐到边的顶点，顶点与曲线方向相反时交换后再对齐
+void SnapEdgeEnds(const vector<PDVVector3D>& iVertexes, double iTolerance, vector<double>& ioPoints)
+{
+    if (iVertexes.empty() || ioPoints.size() < 6)
+        return;
+    double* first = &ioPoints[0];
+    double* last = &ioPoints[ioPoints.size() - 3];
+    const double* a = iVertexes[0]._data;
+    const double* b = iVertexes.size() > 1 ? iVertexes[1]._data : a;
+    if (Distance(first, b) + Distance(last, a) < Distance(first, a) + Distance(last, b))
+        swap(a, b);
+    double limit = iTolerance * VERTEX_SNAP_FACTOR;
+    if (Distance(first, a) <= limit)
+        copy(a, a + 3, first);
+    if (Distance(last, b) <= limit)
+        copy(b, b + 3, last);
+}
+
+// 按弦高误差自适应二分采样边的三维曲线；没有可用的曲线时取两个顶点间的线段
+bool SampleEdge(const BRepArchiveEdge& iEdge, double iTolerance, DftUInt iMaxSegments, EdgeSamples& oSamples)
+{
+    oSamples._params.clear();
+    oSamples._points.clear();
+    CCurveGeometry curve;
+    double start = 0.0;
+    double end = 0.0;
+    bool hasCurve = iEdge._hasCurve && curve.Init(iEdge._curve);
+    if (hasCurve && !curve.ResolveRange(iEdge._curve._start, iEdge._curve._end, start, end))
+    {
+        hasCurve = curve.GetType() == CT_LINE && iEdge._vertices.size() >= 2;
+        if (hasCurve)
+        {
+            start = curve.Project(iEdge._vertices[0]._data);
+            end = curve.Project(iEdge._vertices[1]._data);
+            hasCurve = start != end;
+        }
+    }
+
+    if (!hasCurve)
+    {
+        if (iEdge._vertices.size() < 2 || Distance(iEdge._vertices[0]._data, iEdge._vertices[1]._data) == 0.0)
+            return false;
+        oSamples._start = 0.0;
+        oSamples._end = 1.0;
+        oSamples._params.push_back(0.0);
+        oSamples._params.push_back(1.0);
+        oSamples._points.insert(oSamples._points.end(), iEdge._vertices[0]._data, iEdge._vertices[0]._data + 3);
+        oSamples._points.insert(oSamples._points.end(), iEdge._vertices[1]._data, iEdge._vertices[1]._data + 3);
+        return true;
+    }
+
+    oSamples._start = start;
+    oSamples._end = end;
+    vector<double> params;
+    vector<double> points;
+    curve.GetInitialParams(start, end, params);
+    points.resize(params.size() * 3);
+    curve.Evaluate(&params[0], params.size(), &points[0]);
+
+    // 每轮把待检查区间的中点一次求值，中点偏离弦超过误差的区间二分，新区间在下一轮检查
+    vector<char> pending(params.size() - 1, 1);
+    vector<double> mids;
+    vector<double> midPoints;
+    vector<double> nextParams;
+    vector<double> nextPoints;
+    vector<char> nextPending;
+    double minLength = fabs(end - start) * 1e-9;
+    while (params.size() - 1 < iMaxSegments)
+    {
+        mids.clear();
+        for (size_t k = 0; k + 1 < params.size(); k++)
+        {
+            if (pending[k] && fabs(params[k + 1] - params[k]) > minLength)
+                mids.push_back(0.5 * (params[k] + params[k + 1]));
+            else
+                pending[k] = 0;
+        }
+        if (mids.empty())
+            break;
+        midPoints.resize(mids.size() * 3);
+        curve.Evaluate(&mids[0], mids.size(), &midPoints[0]);
+
+        size_t budget = iMaxSegments - (params.size() - 1);
+        size_t m = 0;
+        nextParams.clear();
+        nextPoints.clear();
+        nextPending.clear();
+        for (size_t k = 0; k + 1 < params.size(); k++)
+        {
+            nextParams.push_back(params[k]);
+            nextPoints.insert(nextPoints.end(), &points[k * 3], &points[k * 3] + 3);
+            bool split = false;
+            if (pending[k])
+            {
+                const double* mid = &midPoints[m * 3];
+                split = budget > 0 && DistanceToSegment(mid, &points[k * 3], &points[(k + 1) * 3]) > iTolerance;
+                if (split)
+                {
+                    budget--;
+                    nextPending.push_back(1);
+                    nextParams.push_back(mids[m]);
+                    nextPoints.insert(nextPoints.end(), mid, mid + 3);
+                }
+                m++;
+            }
+            nextPending.push_back(split ? 1 : 0);
+        }
+        nextParams.push_back(params.back());
+        nextPoints.insert(nextPoints.end(), points.end() - 3, points.end());
+        if (nextParams.size() == params.size())
+            break;
+        params.swap(nextParams);
+        points.swap(nextPoints);
+        pending.swap(nextPending);
+    }
+
+    SnapEdgeEnds(iEdge._vertices, iTolerance, points);
+    oSamples._params.swap(params);
+    oSamples._points.swap(points);
+    return true;
+}
+
+// 曲线参数换算为参数曲线的参数，两者范围一致时不变，否则按线性对应
+double MapParameter(double iParam, const EdgeSamples& iSamples, double iStart, double iEnd)
+{
+    double length = iSamples._end - iSamples._start;
+    if (iStart == iEnd || length == 0.0)
+        return iParam;
+    double scale = max(fabs(iStart) + fabs(iEnd), fabs(length)) * 1e-9;
+    if (fabs(iStart - iSamples._start) <= scale && fabs(iEnd - iSamples._end) <= scale)
+        return iParam;
+    return iStart + (iParam - iSamples._start) * (iEnd - iStart) / length;
+}
+
+
+/** 裁剪多边形的点 */
+struct TrimPoint
+{
+    double _uv[2];      ///< 参数坐标
+    double _xyz[3];     ///< 三维位置
+    bool _hasPosition;  ///< 是否有三维位置，没有时在曲面上求值
+    bool _onEdge;       ///< 到下一个点的线段是否在边上，在边上时线段上的交点按三维位置插值
+};
+
+typedef vector<TrimPoint> TrimPolygon;
+
+/** 绕周期方向一整圈的环 */
+struct TrimStrand
+{
+    TrimPolygon _points;  ///< 点列，末点为首点沿_direction平移一个周期
+    int _direction;       ///< 绕行的参数方向
+    int _sign;            ///< 绕行方向，1为递增，-1为递减
+    double _center;       ///< 另一参数方向的平均坐标
+
+    TrimStrand() : _direction(0), _sign(1), _center(0.0) {}
+};
+
+/** 面网格的顶点 */
+struct FaceVertex
+{
+    double _uv[2];      ///< 参数坐标
+    double _xyz[3];     ///< 三维位置
+    bool _hasPosition;  ///< 是否有三维位置，没有时在曲面上求值
+};
+
+/** 裁剪多边形在一个网格单元中的一段，或整个落在单元中的多边形 */
+struct CellChain
+{
+    DftUInt _cell;              ///< 网格单元序号
+    vector<DftUInt> _vertexes;  ///< 顶点序号
+    double _in;                 ///< 进入处在单元周边上的位置，整个多边形时为-1
+    double _out;                ///< 离开处在单元周边上的位置
+
+    CellChain() : _cell(0), _in(-1.0), _out(-1.0) {}
+};
+
+/** 沿裁剪多边形依次遇到的顶点和网格线交点 */
+struct TrimEvent
+{
+    DftUInt _vertex;  ///< 顶点序号
+    bool _crossing;   ///< 是否为网格线交点
+    DftUInt _cellIn;  ///< 交点之后所在的网格单元
+    double _out;      ///< 交点在离开的单元周边上的位置
+    double _in;       ///< 交点在进入的单元周边上的位置
+
+    TrimEvent() : _vertex(0), _crossing(false), _cellIn(0), _out(0.0), _in(0.0) {}
+};
+
+TrimPoint MakeTrimPoint(double iU, double iV, const double* iPosition, bool iOnEdge)
+{
+    TrimPoint point;
+    point._uv[0] = iU;
+    point._uv[1] = iV;
+    point._hasPosition = iPosition != NULL;
+    if (iPosition)
+        copy(iPosition, iPosition + 3, point._xyz);
+    else
+        fill(point._xyz, point._xyz + 3, 0.0);
+    point._onEdge = iOnEdge;
+    return point;
+}
+
+// 线段上的点，线段在边上且两端有三维位置时三维位置按线性插值
+TrimPoint InterpolateTrimPoint(const TrimPoint& iA, const TrimPoint& iB, double iT)
+{
+    TrimPoint point = MakeTrimPoint(iA._uv[0] + (iB._uv[0] - iA._uv[0]) * iT, iA._uv[1] + (iB._uv[1] - iA._uv[1]) * iT, NULL, iA._onEdge);
+    if (iA._onEdge && iA._hasPosition && iB._hasPosition)
+    {
+        point._hasPosition = true;
+        for (int c = 0; c < 3; c++)
+            point._xyz[c] = iA._xyz[c] + (iB._xyz[c] - iA._xyz[c]) * iT;
+    }
+    return point;
+}
+
+// 反转点列，_onEdge随线段移动；不闭合时末点的_onEdge为false
+void ReverseTrimPoints(TrimPolygon& ioPoints, bool iClosed)
+{
+    size_t count = ioPoints.size();
+    if (count < 2)
+        return;
+    vector<bool> onEdge(count);
+    for (size_t k = 0; k < count; k++)
+        onEdge[k] = ioPoints[k]._onEdge;
+    reverse(ioPoints.begin(), ioPoints.end());
+    // 反转后第k个点到下一个点的线段即原来第count-2-k个点到下一个点的线段
+    for (size_t k = 0; k + 1 < count; k++)
+        ioPoints[k]._onEdge = onEdge[count - 2 - k];
+    ioPoints[count - 1]._onEdge = iClosed && onEdge[count - 1];
+}
+
+// 多边形的有向面积，逆时针为正
+double PolygonArea(const vector<const double*>& iPolygon)
+{
+    double area = 0.0;
+    for (size_t k = 1; k + 1 < iPolygon.size(); k++)
+        area += Orient2d(iPolygon[0], iPolygon[k], iPolygon[k + 1]);
+    return 0.5 * area;
+}
+
+// 点是否在多边形内（奇偶规则）
+bool ContainsPoint(const vector<const double*>& iPolygon, const double* iPoint)
+{
+    bool inside = false;
+    for (size_t k = 0, count = iPolygon.size(); k < count; k++)
+    {
+        const double* a = iPolygon[k];
+        const double* b = iPolygon[(k + 1) % count];
+        if ((a[1] > iPoint[1]) != (b[1] > iPoint[1]) && iPoint[0] < a[0] + (iPoint[1] - a[1]) * (b[0] - a[0]) / (b[1] - a[1]))
+            inside = !inside;
+    }
+    return inside;
+}
+
+void GetTrimCoordinates(const TrimPolygon& iPolygon, vector<const double*>& oPoints)
+{
+    oPoints.resize(iPolygon.size());
+    for (size_t k = 0; k < iPolygon.size(); k++)
+        oPoints[k] = iPolygon[k]._uv;
+}
+
+// 两条线段是否在内部相交，端点相接或共线不算
+bool SegmentsCross(const double* iA, const double* iB, const double* iC, const double* iD)
+{
+    double abc = Orient2d(iA, iB, iC);
+    double abd = Orient2d(iA, iB, iD);
+    double cda = Orient2d(iC, iD, iA);
+    double cdb = Orient2d(iC, iD, iB);
+    return ((abc > 0.0 && abd < 0.0) || (abc < 0.0 && abd > 0.0)) && ((cda > 0.0 && cdb < 0.0) || (cda < 0.0 && cdb > 0.0));
+}
+
+/** 一个面的细分：环换算为参数域中的裁剪多边形，在结构化网格上裁剪后三角化 */
+class CFaceTessellator
+{
+public:
+    CFaceTessellator(const CSurfaceGeometry& iSurface, double iTolerance, DftUInt iMaxSegments, EdgeSampleMap& ioSamples)
+        : m_Surface(iSurface), m_Tolerance(iTolerance), m_MaxSegments(iMaxSegments), m_Samples(ioSamples), m_SurfaceID(0), m_Columns(0),
+          m_Rows(0)
+    {
+        for (int d = 0; d < 2; d++)
+        {
+            m_Periodic[d] = iSurface.IsPeriodic(d);
+            m_Period[d] = m_Periodic[d] ? iSurface.GetPeriod(d) : 0.0;
+            double low;
+            double high;
+            if (iSurface.GetType() == ST_BSPLINESURFACE && iSurface.GetRange(d, low, high))
+                m_UvEpsilon[d] = (high - low) * 1e-9;
+            else
+                m_UvEpsilon[d] = iSurface.IsAngular(d) ? 1e-9 : iTolerance * 1e-3;
+        }
+    }
+
+    // 细分一个面，追加到ioMesh；面无法细分时为false
+    bool Tessellate(const BRepArchiveFace& iFace, TessellatedMesh& ioMesh, DftUInt64& oTriangleCount)
+    {
+        oTriangleCount = 0;
+        m_SurfaceID = iFace._surface._id;
+        if (!BuildPolygons(iFace) || !BuildGrid())
+            return false;
+        Trim();
+        return Emit(iFace._orientation == ORIENTATION_REVERSED, ioMesh, oTriangleCount);
+    }
+
+private:
+    CFaceTessellator(const CFaceTessellator&);
+    CFaceTessellator& operator=(const CFaceTessellator&);
+
+    bool Coincident(const double* iA, const double* iB) const
+    {
+        return fabs(iA[0] - iB[0]) <= m_UvEpsilon[0] && fabs(iA[1] - iB[1]) <= m_UvEpsilon[1];
+    }
+
+    // 周期方向上使iValue最接近iTarget的整周期平移量
+    double Shift(int iDirection, double iValue, double iTarget) const
+    {
+        if (!m_Periodic[iDirection] || !(m_Period[iDirection] > 0.0))
+            return 0.0;
+        return floor((iTarget - iValue) / m_Period[iDirection] + 0.5) * m_Period[iDirection];
+    }
+
+    // 周期方向上逐点平移整周期，使点列连续
+    void Unwrap(TrimPolygon& ioPoints) const
+    {
+        for (int d = 0; d < 2; d++)
+        {
+            for (size_t k = 1; k < ioPoints.size() && m_Periodic[d]; k++)
+                ioPoints[k]._uv[d] += Shift(d, ioPoints[k]._uv[d], ioPoints[k - 1]._uv[d]);
+        }
+    }
+
+    // 边的采样，有边ID时各面共用
+    const EdgeSamples* GetSamples(const BRepArchiveEdge& iEdge, EdgeSamples& ioLocal)
+    {
+        EdgeSamples* samples = &ioLocal;
+        if (iEdge._edgeID)
+        {
+            pair<EdgeSampleMap::iterator, bool> result = m_Samples.insert(make_pair(iEdge._edgeID, EdgeSamples()));
+            samples = &result.first->second;
+            if (!result.second)
+                return samples->GetCount() >= 2 ? samples : NULL;
+        }
+        if (!SampleEdge(iEdge, m_Tolerance, m_MaxSegments, *samples))
+        {
+            samples->_params.clear();
+            samples->_points.clear();
+        }
+        return samples->GetCount() >= 2 ? samples : NULL;
+    }
+
+    // 按三维端点的衔接校正边的方向：首尾重合的边保持原方向，第一条边按与第二条边的衔接确定
+    void OrientEdges(const vector<const EdgeSamples*>& iSamples, vector<bool>& ioReversed) const
+    {
+        size_t count = iSamples.size();
+        if (count < 2)
+            return;
+        vector<const double*> starts(count, static_cast<const double*>(NULL));
+        vector<const double*> ends(count, static_cast<const double*>(NULL));
+        vector<bool> closed(count, true);
+        for (size_t i = 0; i < count; i++)
+        {
+            if (!iSamples[i])
+                continue;
+            starts[i] = &iSamples[i]->_points[0];
+            ends[i] = &iSamples[i]->_points[iSamples[i]->_points.size() - 3];
+            closed[i] = Distance(starts[i], ends[i]) <= m_Tolerance;
+            if (ioReversed[i])
+                swap(starts[i], ends[i]);
+        }
+        if (!closed[0] && starts[1])
+        {
+            double keep = min(Distance(ends[0], starts[1]), Distance(ends[0], ends[1]));
+            double flip = min(Distance(starts[0], starts[1]), Distance(starts[0], ends[1]));
+            if (flip < keep)
+            {
+                ioReversed[0] = !ioReversed[0];
+                swap(starts[0], ends[0]);
+            }
+        }
+        for (size_t i = 1; i < count; i++)
+        {
+            if (!closed[i] && ends[i - 1] && Distance(ends[i - 1], ends[i]) < Distance(ends[i - 1], starts[i]))
+            {
+                ioReversed[i] = !ioReversed[i];
+                swap(starts[i], ends[i]);
+            }
+        }
+    }
+
+    // 初等曲面上按三维采样点求逆得到参数，回转轴上的点取相邻点的u
+    bool InvertSamples(const EdgeSamples& iSamples, TrimPolygon& oPoints) const
+    {
+        if (!m_Surface.CanInvert())
+            return false;
+        size_t count = iSamples.GetCount();
+        size_t known = count;
+        oPoints.clear();
+        for (size_t k = 0; k < count; k++)
+        {
+            const double* position = &iSamples._points[k * 3];
+            double u;
+            double v;
+            m_Surface.Invert(position, u, v);
+            oPoints.push_back(MakeTrimPoint(u, v, position, true));
+            if (known == count && !std::isnan(u))
+                known = k;
+        }
+        if (known == count)
+            return false;
+        for (size_t k = known; k-- > 0;)
+            oPoints[k]._uv[0] = oPoints[k + 1]._uv[0];
+        for (size_t k = known + 1; k < count; k++)
+        {
+            if (std::isnan(oPoints[k]._uv[0]))
+                oPoints[k]._uv[0] = oPoints[k - 1]._uv[0];
+        }
+        return true;
+    }
+
+    // 边在参数域中的点列，已按方向排列；同一曲面上有两条参数曲线（接缝边）时每条一个候选
+    void TraceEdge(const BRepArchiveEdge& iEdge, const EdgeSamples* iSamples, bool iReversed, vector<TrimPolygon>& oCandidates) const
+    {
+        oCandidates.clear();
+        vector<double> params;
+        vector<double> uv;
+        for (size_t c = 0; iEdge._hasCurve && c < iEdge._curve._pcurves.size(); c++)
+        {
+            const BRepArchiveCurve2d& pcurve = iEdge._curve._pcurves[c];
+            CCurveGeometry curve;
+            if (pcurve._surfaceID != m_SurfaceID || !curve.Init(pcurve))
+                continue;
+            if (iSamples)
+            {
+                params.resize(iSamples->GetCount());
+                for (size_t k = 0; k < params.size(); k++)
+                    params[k] = MapParameter(iSamples->_params[k], *iSamples, pcurve._start, pcurve._end);
+            }
+            else
+            {
+                double start;
+                double end;
+                if (!curve.ResolveRange(pcurve._start, pcurve._end, start, end))
+                    continue;
+                curve.GetInitialParams(start, end, params);
+                if (params.size() <= PCURVE_SEGMENTS)
+                {
+                    params.resize(PCURVE_SEGMENTS + 1);
+                    for (DftUInt k = 0; k <= PCURVE_SEGMENTS; k++)
+                        params[k] = start + (end - start) * k / PCURVE_SEGMENTS;
+                }
+            }
+            uv.resize(params.size() * 3);
+            curve.Evaluate(&params[0], params.size(), &uv[0]);
+            oCandidates.push_back(TrimPolygon());
+            for (size_t k = 0; k < params.size(); k++)
+                oCandidates.back().push_back(MakeTrimPoint(uv[k * 3], uv[k * 3 + 1], iSamples ? &iSamples->_points[k * 3] : NULL, true));
+        }
+        if (oCandidates.empty() && iSamples)
+        {
+            oCandidates.push_back(TrimPolygon());
+            if (!InvertSamples(*iSamples, oCandidates.back()))
+                oCandidates.pop_back();
+        }
+        for (size_t c = 0; c < oCandidates.size(); c++)
+        {
+            oCandidates[c].back()._onEdge = false;
+            Unwrap(oCandidates[c]);
+            if (iReversed)
+                ReverseTrimPoints(oCandidates[c], false);
+        }
+    }
+
+    // 边的点列接到环的末尾，周期方向平移整周期与末点衔接，与末点重合的首点合并
+    void AppendEdge(TrimPolygon& ioPoints, const TrimPolygon& iEdge) const
+    {
+        double offset[2] = { 0.0, 0.0 };
+        TrimPoint first = iEdge[0];
+        if (!ioPoints.empty())
+        {
+            for (int d = 0; d < 2; d++)
+            {
+                offset[d] = Shift(d, first._uv[d], ioPoints.back()._uv[d]);
+                first._uv[d] += offset[d];
+            }
+            if (Coincident(first._uv, ioPoints.back()._uv))
+            {
+                if (!first._hasPosition && ioPoints.back()._hasPosition)
+                {
+                    first._hasPosition = true;
+                    copy(ioPoints.back()._xyz, ioPoints.back()._xyz + 3, first._xyz);
+                }
+                ioPoints.pop_back();
+            }
+        }
+        ioPoints.push_back(first);
+        for (size_t k = 1; k < iEdge.size(); k++)
+        {
+            ioPoints.push_back(iEdge[k]);
+            ioPoints.back()._uv[0] += offset[0];
+            ioPoints.back()._uv[1] += offset[1];
+        }
+    }
+
+    // 一个环换算为闭合的裁剪多边形，或绕周期方向一整圈的点列；无法换算时为false
+    bool TraceLoop(const BRepArchiveLoop& iLoop, vector<TrimStrand>& ioStrands)
+    {
+        size_t count = iLoop._edges.size();
+        vector<EdgeSamples> local(count);
+        vector<const EdgeSamples*> samples(count);
+        vector<bool> reversed(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            samples[i] = GetSamples(iLoop._edges[i], local[i]);
+            reversed[i] = iLoop._edges[i]._orientation == ORIENTATION_REVERSED;
+        }
+        OrientEdges(samples, reversed);
+
+        // 接缝边的两条参数曲线按与上一条边的衔接选取，因此从第一条只有一个候选的边开始
+        vector<vector<TrimPolygon> > candidates(count);
+        size_t first = count;
+        for (size_t i = 0; i < count; i++)
+        {
+            TraceEdge(iLoop._edges[i], samples[i], reversed[i], candidates[i]);
+            if (first == count && candidates[i].size() == 1)
+                first = i;
+        }
+        if (first == count)
+            first = 0;
+
+        TrimPolygon points;
+        for (size_t k = 0; k < count; k++)
+        {
+            const vector<TrimPolygon>& edge = candidates[(first + k) % count];
+            if (edge.empty())
+                continue;
+            size_t choice = 0;
+            double best = numeric_limits<double>::max();
+            for (size_t c = 0; c < edge.size() && !points.empty(); c++)
+            {
+                double du = edge[c][0]._uv[0] - points.back()._uv[0];
+                double dv = edge[c][0]._uv[1] - points.back()._uv[1];
+                if (du * du + dv * dv < best)
+                {
+                    best = du * du + dv * dv;
+                    choice = c;
+                }
+            }
+            AppendEdge(points, edge[choice]);
+        }
+        if (points.size() < 2)
+            return true;
+
+        // 首尾相差整周期的环绕周期方向一整圈
+        TrimStrand strand;
+        strand._direction = -1;
+        for (int d = 0; d < 2; d++)
+        {
+            if (!m_Periodic[d])
+                continue;
+            double turns = floor((points.back()._uv[d] - points[0]._uv[d]) / m_Period[d] + 0.5);
+            if (turns == 0.0)
+                continue;
+            if (strand._direction >= 0 || fabs(turns) > 1.0)
+                return false;
+            strand._direction = d;
+            strand._sign = turns > 0.0 ? 1 : -1;
+        }
+        if (strand._direction < 0)
+        {
+            if (Coincident(points[0]._uv, points.back()._uv))
+                points.pop_back();
+            m_Polygons.push_back(TrimPolygon());
+            m_Polygons.back().swap(points);
+            return true;
+        }
+        strand._points.swap(points);
+        ioStrands.push_back(strand);
+        return true;
+    }
+
+    // 周期方向上的切开位置，尽量不落在闭合多边形的范围内
+    double ChooseCut(int iDirection) const
+    {
+        double low = 0.0;
+        double high = 0.0;
+        m_Surface.GetRange(iDirection, low, high);
+        double period = m_Period[iDirection];
+        vector<pair<double, double> > spans;
+        for (size_t p = 0; p < m_Polygons.size(); p++)
+        {
+            double minimum = numeric_limits<double>::max();
+            double maximum = -numeric_limits<double>::max();
+            for (size_t k = 0; k < m_Polygons[p].size(); k++)
+            {
+                minimum = min(minimum, m_Polygons[p][k]._uv[iDirection]);
+                maximum = max(maximum, m_Polygons[p][k]._uv[iDirection]);
+            }
+            if (maximum - minimum >= period)
+                return low;
+            double start = minimum - low - floor((minimum - low) / period) * period;
+            spans.push_back(make_pair(start, start + maximum - minimum));
+        }
+        if (spans.empty())
+            return low;
+        sort(spans.begin(), spans.end());
+        double covered = spans[0].second;
+        bool cutCovered = spans[0].first <= 0.0;
+        double gapStart = 0.0;
+        double gapLength = 0.0;
+        for (size_t s = 1; s < spans.size(); s++)
+        {
+            if (spans[s].first > covered && spans[s].first - covered > gapLength)
+            {
+                gapStart = covered;
+                gapLength = spans[s].first - covered;
+            }
+            covered = max(covered, spans[s].second);
+        }
+        if (covered >= period)
+            cutCovered = true;
+        if (!cutCovered)
+            return low;
+        if (spans[0].first + period - covered > gapLength)
+        {
+            gapStart = covered;
+            gapLength = spans[0].first + period - covered;
+        }
+        return low + gapStart + 0.5 * gapLength;
+    }
+
+    // 在周期方向的iCut处切开，得到从一侧到另一侧的点列：递增时从iCut到iCut+P，递减时反之
+    bool CutStrand(TrimStrand& ioStrand, double iCut) const
+    {
+        int w = ioStrand._direction;
+        int sign = ioStrand._sign;
+        double period = m_Period[w];
+        TrimPolygon& points = ioStrand._points;
+        size_t count = points.size();
+
+        // 首点移到[iCut, iCut + P)内，递减时移到(iCut, iCut + P]内
+        double offset = floor((points[0]._uv[w] - iCut) / period) * period;
+        if (sign < 0 && points[0]._uv[w] - offset == iCut)
+            offset -= period;
+        for (size_t k = 0; k < count; k++)
+            points[k]._uv[w] -= offset;
+
+        double bound = sign > 0 ? iCut + period : iCut;
+        size_t segment = count;
+        for (size_t k = 0; k + 1 < count && segment == count; k++)
+        {
+            if ((points[k]._uv[w] - bound) * sign < 0.0 && (points[k + 1]._uv[w] - bound) * sign >= 0.0)
+                segment = k;
+        }
+        if (segment == count)
+            return false;
+
+        const TrimPoint& a = points[segment];
+        const TrimPoint& b = points[segment + 1];
+        TrimPoint cross = InterpolateTrimPoint(a, b, (bound - a._uv[w]) / (b._uv[w] - a._uv[w]));
+        cross._uv[w] = bound;
+        TrimPolygon result;
+        result.push_back(cross);
+        result.back()._uv[w] -= sign * period;
+        for (size_t k = segment + 1; k + 1 < count; k++)
+        {
+            result.push_back(points[k]);
+            result.back()._uv[w] -= sign * period;
+        }
+        result.insert(result.end(), points.begin(), points.begin() + segment + 1);
+        cross._onEdge = false;
+        result.push_back(cross);
+        points.swap(result);
+        return true;
+    }
+
+    // 绕周期方向的点列按另一方向的坐标排序后两两相连；个数为奇数时，左侧朝向参数域边界的一条与该边界相连
+    bool JoinStrands(vector<TrimStrand>& ioStrands, int& oDirection, double& oCut)
+    {
+        oDirection = -1;
+        oCut = 0.0;
+        if (ioStrands.empty())
+            return true;
+        int w = ioStrands[0]._direction;
+        int o = 1 - w;
+        for (size_t s = 1; s < ioStrands.size(); s++)
+        {
+            if (ioStrands[s]._direction != w)
+                return false;
+        }
+        oDirection = w;
+        oCut = ChooseCut(w);
+        for (size_t s = 0; s < ioStrands.size(); s++)
+        {
+            TrimStrand& strand = ioStrands[s];
+            if (!CutStrand(strand, oCut))
+                return false;
+            double sum = 0.0;
+            for (size_t k = 0; k < strand._points.size(); k++)
+                sum += strand._points[k]._uv[o];
+            strand._center = sum / strand._points.size();
+            double offset = s > 0 ? Shift(o, strand._center, ioStrands[0]._center) : 0.0;
+            for (size_t k = 0; k < strand._points.size() && offset != 0.0; k++)
+                strand._points[k]._uv[o] += offset;
+            strand._center += offset;
+        }
+
+        vector<size_t> order(ioStrands.size());
+        for (size_t s = 0; s < order.size(); s++)
+            order[s] = s;
+        sort(order.begin(), order.end(), [&ioStrands](size_t a, size_t b) { return ioStrands[a]._center < ioStrands[b]._center; });
+
+        if (order.size() % 2)
+        {
+            // 左侧即多边形内侧：沿u递增的点列左侧为v较大的一侧，沿v递增的点列左侧为u较小的一侧
+            TrimStrand* single = &ioStrands[order[0]];
+            bool upper = (single->_direction == 0) == (single->_sign > 0);
+            if (upper)
+            {
+                single = &ioStrands[order.back()];
+                upper = (single->_direction == 0) == (single->_sign > 0);
+                order.pop_back();
+            }
+            else
+                order.erase(order.begin());
+            double bound;
+            if (!m_Surface.GetBound(o, upper, single->_center, bound))
+                return false;
+            TrimPolygon polygon(single->_points);
+            TrimPoint corner = MakeTrimPoint(0.0, 0.0, NULL, false);
+            corner._uv[w] = polygon.back()._uv[w];
+            corner._uv[o] = bound;
+            polygon.push_back(corner);
+            corner._uv[w] = polygon[0]._uv[w];
+            polygon.push_back(corner);
+            m_Polygons.push_back(polygon);
+        }
+        for (size_t s = 0; s + 1 < order.size(); s += 2)
+        {
+            TrimStrand& a = ioStrands[order[s]];
+            TrimStrand& b = ioStrands[order[s + 1]];
+            if (a._sign == b._sign)
+                ReverseTrimPoints(b._points, false);
+            m_Polygons.push_back(a._points);
+            m_Polygons.back().insert(m_Polygons.back().end(), b._points.begin(), b._points.end());
+        }
+        return true;
+    }
+
+    // 周期方向上平移各多边形：有绕行的点列时移到切开位置之后的一个周期内，否则靠近范围最大的多边形
+    void AlignPolygons(int iWrapDirection, double iCut)
+    {
+        for (int d = 0; d < 2; d++)
+        {
+            if (!m_Periodic[d] || m_Polygons.empty())
+                continue;
+            vector<double> centers(m_Polygons.size());
+            double target = iCut + 0.5 * m_Period[d];
+            double extent = -1.0;
+            for (size_t p = 0; p < m_Polygons.size(); p++)
+            {
+                double minimum = numeric_limits<double>::max();
+                double maximum = -numeric_limits<double>::max();
+                for (size_t k = 0; k < m_Polygons[p].size(); k++)
+                {
+                    minimum = min(minimum, m_Polygons[p][k]._uv[d]);
+                    maximum = max(maximum, m_Polygons[p][k]._uv[d]);
+                }
+                centers[p] = 0.5 * (minimum + maximum);
+                if (d != iWrapDirection && maximum - minimum > extent)
+                {
+                    extent = maximum - minimum;
+                    target = centers[p];
+                }
+            }
+            for (size_t p = 0; p < m_Polygons.size(); p++)
+            {
+                double offset = Shift(d, centers[p], target);
+                for (size_t k = 0; k < m_Polygons[p].size() && offset != 0.0; k++)
+                    m_Polygons[p][k]._uv[d] += offset;
+            }
+        }
+    }
+
+    // 合并重合的相邻点，去掉点数不足或面积为0的多边形
+    void CleanPolygons()
+    {
+        size_t kept = 0;
+        for (size_t p = 0; p < m_Polygons.size(); p++)
+        {
+            TrimPolygon& polygon = m_Polygons[p];
+            TrimPolygon result;
+            for (size_t k = 0; k < polygon.size(); k++)
+            {
+                if (!result.empty() && Coincident(result.back()._uv, polygon[k]._uv))
+                {
+                    result.back()._onEdge = polygon[k]._onEdge;
+                    if (!result.back()._hasPosition && polygon[k]._hasPosition)
+                    {
+                        result.back()._hasPosition = true;
+                        copy(polygon[k]._xyz, polygon[k]._xyz + 3, result.back()._xyz);
+                    }
+                    continue;
+                }
+                result.push_back(polygon[k]);
+            }
+            while (result.size() > 1 && Coincident(result.back()._uv, result[0]._uv))
+            {
+                if (!result[0]._hasPosition && result.back()._hasPosition)
+                {
+                    result[0]._hasPosition = true;
+                    copy(result.back()._xyz, result.back()._xyz + 3, result[0]._xyz);
+                }
+                result.pop_back();
+            }
+            vector<const double*> points;
+            GetTrimCoordinates(result, points);
+            if (result.size() >= 3 && fabs(PolygonArea(points)) > m_UvEpsilon[0] * m_UvEpsilon[1])
+                m_Polygons[kept++].swap(result);
+        }
+        m_Polygons.resize(kept);
+    }
+
+    // 嵌套层数为偶数的多边形逆时针，奇数的顺时针，内侧总在前进方向的左侧
+    void OrientPolygons()
+    {
+        vector<vector<const double*> > points(m_Polygons.size());
+        for (size_t p = 0; p < m_Polygons.size(); p++)
+            GetTrimCoordinates(m_Polygons[p], points[p]);
+        vector<bool> reverse(m_Polygons.size());
+        for (size_t p = 0; p < m_Polygons.size(); p++)
+        {
+            size_t depth = 0;
+            for (size_t q = 0; q < m_Polygons.size(); q++)
+            {
+                if (q != p && ContainsPoint(points[q], points[p][0]))
+                    depth++;
+            }
+            reverse[p] = (PolygonArea(points[p]) > 0.0) != (depth % 2 == 0);
+        }
+        for (size_t p = 0; p < m_Polygons.size(); p++)
+        {
+            if (reverse[p])
+                ReverseTrimPoints(m_Polygons[p], true);
+        }
+    }
+
+    // 参数域的矩形，用于没有环或环无法换算的面
+    bool BuildDomainPolygon()
+    {
+        double low[2];
+        double high[2];
+        if (!m_Surface.GetRange(0, low[0], high[0]) || !m_Surface.GetRange(1, low[1], high[1]))
+            return false;
+        m_Polygons.assign(1, TrimPolygon());
+        m_Polygons[0].push_back(MakeTrimPoint(low[0], low[1], NULL, false));
+        m_Polygons[0].push_back(MakeTrimPoint(high[0], low[1], NULL, false));
+        m_Polygons[0].push_back(MakeTrimPoint(high[0], high[1], NULL, false));
+        m_Polygons[0].push_back(MakeTrimPoint(low[0], high[1], NULL, false));
+        return true;
+    }
+
+    bool BuildPolygons(const BRepArchiveFace& iFace)
+    {
+        m_Polygons.clear();
+        vector<TrimStrand> strands;
+        bool valid = true;
+        for (size_t l = 0; l < iFace._loops.size() && valid; l++)
+            valid = TraceLoop(iFace._loops[l], strands);
+        int direction = -1;
+        double cut = 0.0;
+        if (valid)
+            valid = JoinStrands(strands, direction, cut);
+        if (valid)
+        {
+            AlignPolygons(direction, cut);
+            CleanPolygons();
+        }
+        if (!valid || m_Polygons.empty())
+        {
+            m_Polygons.clear();
+            if (!BuildDomainPolygon())
+                return false;
+        }
+        OrientPolygons();
+        return true;
+    }
+
+    // 一个参数方向在[iLow[d], iHigh[d]]上的初始分段，每段的分段数由三条等参线中点的弦高偏差确定
+    void MeasureDirection(int iDirection, const double* iLow, const double* iHigh, vector<double>& oPilots, vector<size_t>& oCounts,
+        double& oLength) const
+    {
+        const size_t LINE_COUNT = 3;
+        const size_t SAMPLE_COUNT = 5;
+        int other = 1 - iDirection;
+        m_Surface.GetPilotParams(iDirection, iLow[iDirection], iHigh[iDirection], oPilots);
+        size_t intervals = oPilots.size() - 1;
+        size_t count = intervals * LINE_COUNT * SAMPLE_COUNT;
+        vector<double> params[2];
+        params[0].resize(count);
+        params[1].resize(count);
+        for (size_t k = 0, n = 0; k < intervals; k++)
+        {
+            for (size_t l = 0; l < LINE_COUNT; l++)
+            {
+                for (size_t s = 0; s < SAMPLE_COUNT; s++, n++)
+                {
+                    params[iDirection][n] = oPilots[k] + (oPilots[k + 1] - oPilots[k]) * s / (SAMPLE_COUNT - 1);
+                    params[other][n] = iLow[other] + (iHigh[other] - iLow[other]) * l / (LINE_COUNT - 1);
+                }
+            }
+        }
+        vector<double> points(count * 3);
+        vector<double> normals(count * 3);
+        m_Surface.Evaluate(&params[0][0], &params[1][0], count, &points[0], &normals[0]);
+
+        // 弦高偏差与分段数的平方成反比
+        oCounts.resize(intervals);
+        oLength = 0.0;
+        for (size_t k = 0; k < intervals; k++)
+        {
+            double deviation = 0.0;
+            for (size_t l = 0; l < LINE_COUNT; l++)
+            {
+                const double* line = &points[(k * LINE_COUNT + l) * SAMPLE_COUNT * 3];
+                for (size_t s = 1; s + 1 < SAMPLE_COUNT; s++)
+                    deviation = max(deviation, DistanceToSegment(line + s * 3, line, line + (SAMPLE_COUNT - 1) * 3));
+                for (size_t s = 0; s + 1 < SAMPLE_COUNT && l == LINE_COUNT / 2; s++)
+                    oLength += Distance(line + s * 3, line + (s + 1) * 3);
+            }
+            double segments = ceil(sqrt(deviation / m_Tolerance));
+            oCounts[k] = segments > m_MaxSegments ? m_MaxSegments : max<size_t>(1, static_cast<size_t>(segments));
+        }
+    }
+
+    // 网格线离开裁剪点的坐标，使裁剪点都不在网格线上
+    void NudgeGridLines(vector<double>& ioLines, const vector<double>& iCoordinates) const
+    {
+        double epsilon = (ioLines.back() - ioLines[0]) * GRID_LINE_EPSILON;
+        for (size_t k = 1; k + 1 < ioLines.size(); k++)
+        {
+            double width = min(ioLines[k] - ioLines[k - 1], ioLines[k + 1] - ioLines[k]);
+            double base = ioLines[k];
+            for (int attempt = 0; attempt < 64; attempt++)
+            {
+                vector<double>::const_iterator it = lower_bound(iCoordinates.begin(), iCoordinates.end(), ioLines[k] - epsilon);
+                if (it == iCoordinates.end() || *it > ioLines[k] + epsilon)
+                    break;
+                ioLines[k] = base + (attempt % 2 ? -1.0 : 1.0) * (attempt / 2 + 1) * GRID_LINE_NUDGE * width;
+            }
+        }
+    }
+
+    // 覆盖裁剪多边形的结构化网格
+    bool BuildGrid()
+    {
+        double low[2] = { numeric_limits<double>::max(), numeric_limits<double>::max() };
+        double high[2] = { -numeric_limits<double>::max(), -numeric_limits<double>::max() };
+        vector<double> coordinates[2];
+        for (size_t p = 0; p < m_Polygons.size(); p++)
+        {
+            for (size_t k = 0; k < m_Polygons[p].size(); k++)
+            {
+                for (int d = 0; d < 2; d++)
+                {
+                    low[d] = min(low[d], m_Polygons[p][k]._uv[d]);
+                    high[d] = max(high[d], m_Polygons[p][k]._uv[d]);
+                    coordinates[d].push_back(m_Polygons[p][k]._uv[d]);
+                }
+            }
+        }
+        if (!(high[0] > low[0]) || !(high[1] > low[1]))
+            return false;
+
+        vector<double> pilots[2];
+        vector<size_t> counts[2];
+        double lengths[2];
+        size_t totals[2];
+        for (int d = 0; d < 2; d++)
+        {
+            MeasureDirection(d, low, high, pilots[d], counts[d], lengths[d]);
+            totals[d] = 0;
+            for (size_t k = 0; k < counts[d].size(); k++)
+                totals[d] += counts[d][k];
+        }
+
+        // 裁剪点较多时按两个方向的三维长度之比加密，使单元内的裁剪点数有上限
+        double target = coordinates[0].size() / TRIM_POINTS_PER_CELL;
+        if (static_cast<double>(totals[0]) * totals[1] < target && lengths[0] > 0.0 && lengths[1] > 0.0)
+        {
+            for (int d = 0; d < 2; d++)
+            {
+                double desired = sqrt(target * lengths[d] / lengths[1 - d]);
+                if (desired <= totals[d])
+                    continue;
+                size_t factor = static_cast<size_t>(ceil(desired / totals[d]));
+                for (size_t k = 0; k < counts[d].size(); k++)
+                    counts[d][k] *= factor;
+                totals[d] *= factor;
+            }
+        }
+
+        for (int d = 0; d < 2; d++)
+        {
+            if (totals[d] > m_MaxSegments)
+            {
+                for (size_t k = 0; k < counts[d].size(); k++)
+                    counts[d][k] = max<size_t>(1, counts[d][k] * m_MaxSegments / totals[d]);
+            }
+            vector<double>& lines = m_Grid[d];
+            lines.clear();
+            for (size_t k = 0; k < counts[d].size(); k++)
+            {
+                for (size_t m = 0; m < counts[d][k]; m++)
+                    lines.push_back(pilots[d][k] + (pilots[d][k + 1] - pilots[d][k]) * m / counts[d][k]);
+            }
+            lines.push_back(pilots[d].back());
+            double margin = (high[d] - low[d]) * 1e-6;
+            lines[0] = low[d] - margin;
+            lines.back() = high[d] + margin;
+            sort(coordinates[d].begin(), coordinates[d].end());
+            NudgeGridLines(lines, coordinates[d]);
+        }
+        m_Columns = m_Grid[0].size() - 1;
+        m_Rows = m_Grid[1].size() - 1;
+        return true;
+    }
+
+    size_t FindInterval(int iDirection, double iValue) const
+    {
+        const vector<double>& lines = m_Grid[iDirection];
+        size_t index = upper_bound(lines.begin(), lines.end(), iValue) - lines.begin();
+        return index == 0 ? 0 : min(index - 1, lines.size() - 2);
+    }
+
+    DftUInt AddVertex(const double* iUV, const double* iPosition)
+    {
+        FaceVertex vertex;
+        vertex._uv[0] = iUV[0];
+        vertex._uv[1] = iUV[1];
+        vertex._hasPosition = iPosition != NULL;
+        if (iPosition)
+            copy(iPosition, iPosition + 3, vertex._xyz);
+        m_Vertexes.push_back(vertex);
+        return static_cast<DftUInt>(m_Vertexes.size() - 1);
+    }
+
+    DftUInt GetCorner(size_t iColumn, size_t iRow)
+    {
+        DftUInt& index = m_Corners[iRow * (m_Columns + 1) + iColumn];
+        if (index == INVALID_INDEX)
+        {
+            double uv[2] = { m_Grid[0][iColumn], m_Grid[1][iRow] };
+            index = AddVertex(uv, NULL);
+        }
+        return index;
+    }
+
+    // 线段a→b穿过的网格线，依次记录交点；单元周边上的位置从左下角起逆时针：下边为0~1，右边1~2，上边2~3，左边3~4
+    void WalkSegment(const TrimPoint& iA, const TrimPoint& iB, vector<TrimEvent>& ioEvents)
+    {
+        const vector<double>& columns = m_Grid[0];
+        const vector<double>& rows = m_Grid[1];
+        size_t i = FindInterval(0, iA._uv[0]);
+        size_t j = FindInterval(1, iA._uv[1]);
+        size_t targetI = FindInterval(0, iB._uv[0]);
+        size_t targetJ = FindInterval(1, iB._uv[1]);
+        double du = iB._uv[0] - iA._uv[0];
+        double dv = iB._uv[1] - iA._uv[1];
+        for (size_t guard = m_Columns + m_Rows + 2; (i != targetI || j != targetJ) && guard > 0; guard--)
+        {
+            double tu = numeric_limits<double>::infinity();
+            double tv = numeric_limits<double>::infinity();
+            if (du > 0.0 && i + 1 < m_Columns)
+                tu = (columns[i + 1] - iA._uv[0]) / du;
+            else if (du < 0.0 && i > 0)
+                tu = (columns[i] - iA._uv[0]) / du;
+            if (dv > 0.0 && j + 1 < m_Rows)
+                tv = (rows[j + 1] - iA._uv[1]) / dv;
+            else if (dv < 0.0 && j > 0)
+                tv = (rows[j] - iA._uv[1]) / dv;
+            if (tu == numeric_limits<double>::infinity() && tv == numeric_limits<double>::infinity())
+                break;
+
+            TrimEvent event;
+            event._crossing = true;
+            size_t nextI = i;
+            size_t nextJ = j;
+            double uv[2];
+            double t = min(tu, tv);
+            if (tu < tv)
+            {
+                uv[0] = du > 0.0 ? columns[i + 1] : columns[i];
+                uv[1] = min(max(iA._uv[1] + tu * dv, rows[j]), rows[j + 1]);
+                double f = (uv[1] - rows[j]) / (rows[j + 1] - rows[j]);
+                event._out = du > 0.0 ? 1.0 + f : 4.0 - f;
+                event._in = du > 0.0 ? 4.0 - f : 1.0 + f;
+                nextI = du > 0.0 ? i + 1 : i - 1;
+            }
+            else if (tv < tu)
+            {
+                uv[0] = min(max(iA._uv[0] + tv * du, columns[i]), columns[i + 1]);
+                uv[1] = dv > 0.0 ? rows[j + 1] : rows[j];
+                double g = (uv[0] - columns[i]) / (columns[i + 1] - columns[i]);
+                event._out = dv > 0.0 ? 3.0 - g : g;
+                event._in = dv > 0.0 ? g : 3.0 - g;
+                nextJ = dv > 0.0 ? j + 1 : j - 1;
+            }
+            else
+            {
+                // 正好穿过网格点时沿对角进入相邻单元
+                static const double CORNER_OUT[2][2] = { { 0.0, 3.0 }, { 1.0, 2.0 } };
+                static const double CORNER_IN[2][2] = { { 2.0, 1.0 }, { 3.0, 0.0 } };
+                int su = du > 0.0 ? 1 : 0;
+                int sv = dv > 0.0 ? 1 : 0;
+                event._out = CORNER_OUT[su][sv];
+                event._in = CORNER_IN[su][sv];
+                event._vertex = GetCorner(i + su, j + sv);
+                nextI = su ? i + 1 : i - 1;
+                nextJ = sv ? j + 1 : j - 1;
+            }
+            if (tu != tv)
+            {
+                bool interpolate = iA._onEdge && iA._hasPosition && iB._hasPosition;
+                double position[3];
+                for (int c = 0; c < 3 && interpolate; c++)
+                    position[c] = iA._xyz[c] + (iB._xyz[c] - iA._xyz[c]) * t;
+                event._vertex = AddVertex(uv, interpolate ? position : NULL);
+            }
+            event._cellIn = static_cast<DftUInt>(nextJ * m_Columns + nextI);
+            ioEvents.push_back(event);
+            i = nextI;
+            j = nextJ;
+        }
+    }
+
+    // 多边形按网格单元分为若干段，整个落在一个单元中时为一个闭合的环
+    void TracePolygon(const TrimPolygon& iPolygon, vector<CellChain>& ioChains, vector<char>& ioCrossed)
+    {
+        size_t count = iPolygon.size();
+        vector<TrimEvent> events;
+        size_t first = 0;
+        for (size_t k = 0; k < count; k++)
+        {
+            TrimEvent event;
+            event._vertex = AddVertex(iPolygon[k]._uv, iPolygon[k]._hasPosition ? iPolygon[k]._xyz : NULL);
+            events.push_back(event);
+            WalkSegment(iPolygon[k], iPolygon[(k + 1) % count], events);
+            if (first == 0 && events.size() > k + 1)
+                first = k + 1;
+        }
+
+        CellChain chain;
+        if (first == 0)
+        {
+            chain._cell = static_cast<DftUInt>(FindInterval(1, iPolygon[0]._uv[1]) * m_Columns + FindInterval(0, iPolygon[0]._uv[0]));
+            for (size_t e = 0; e < events.size(); e++)
+                chain._vertexes.push_back(events[e]._vertex);
+            ioChains.push_back(chain);
+            return;
+        }
+        for (size_t e = 0; e < events.size(); e++)
+        {
+            if (events[e]._crossing)
+            {
+                first = e;
+                break;
+            }
+        }
+        for (size_t m = 0; m <= events.size(); m++)
+        {
+            const TrimEvent& event = events[(first + m) % events.size()];
+            if (!event._crossing)
+            {
+                chain._vertexes.push_back(event._vertex);
+                continue;
+            }
+            if (m > 0)
+            {
+                chain._vertexes.push_back(event._vertex);
+                chain._out = event._out;
+                // 只在单元的一点上进出的段不影响单元
+                double gap = fabs(chain._in - chain._out);
+                if (chain._vertexes.size() > 2 || min(gap, 4.0 - gap) > 1e-9)
+                {
+                    ioChains.push_back(chain);
+                    ioCrossed[chain._cell] = 1;
+                }
+            }
+            if (m == events.size())
+                break;
+            chain._vertexes.assign(1, event._vertex);
+            chain._cell = event._cellIn;
+            chain._in = event._in;
+        }
+    }
+
+    // 不含裁剪段的单元是否在面内：裁剪多边形不穿过这样的单元的周边，每行沿中线按奇偶规则判断单元左边的中点；
+    // 不取单元中点，因为整个落在单元中的环会改变中点的判断
+    void ClassifyCells(vector<char>& oInside) const
+    {
+        vector<double> middles(m_Rows);
+        for (size_t j = 0; j < m_Rows; j++)
+            middles[j] = 0.5 * (m_Grid[1][j] + m_Grid[1][j + 1]);
+        vector<vector<double> > crossings(m_Rows);
+        for (size_t p = 0; p < m_Polygons.size(); p++)
+        {
+            const TrimPolygon& polygon = m_Polygons[p];
+            for (size_t k = 0; k < polygon.size(); k++)
+            {
+                const double* a = polygon[k]._uv;
+                const double* b = polygon[(k + 1) % polygon.size()]._uv;
+                if (a[1] == b[1])
+                    continue;
+                size_t begin = lower_bound(middles.begin(), middles.end(), min(a[1], b[1])) - middles.begin();
+                size_t end = lower_bound(middles.begin(), middles.end(), max(a[1], b[1])) - middles.begin();
+                for (size_t j = begin; j < end; j++)
+                    crossings[j].push_back(a[0] + (middles[j] - a[1]) * (b[0] - a[0]) / (b[1] - a[1]));
+            }
+        }
+        oInside.assign(m_Columns * m_Rows, 0);
+        for (size_t j = 0; j < m_Rows; j++)
+        {
+            sort(crossings[j].begin(), crossings[j].end());
+            for (size_t i = 0; i < m_Columns; i++)
+            {
+                size_t before = lower_bound(crossings[j].begin(), crossings[j].end(), m_Grid[0][i]) - crossings[j].begin();
+                oInside[j * m_Columns + i] = before % 2 ? 1 : 0;
+            }
+        }
+    }
+
+    const double* GetUV(DftUInt iVertex) const { return m_Vertexes[iVertex]._uv; }
+
+    // 桥接线段o→h是否与多边形或其余孔的边在内部相交
+    bool BridgeCrosses(const double* iFrom, const double* iTo, const vector<DftUInt>& iPolygon, const vector<vector<DftUInt> >& iHoles,
+        size_t iFirstHole) const
+    {
+        for (size_t k = 0; k < iPolygon.size(); k++)
+        {
+            if (SegmentsCross(iFrom, iTo, GetUV(iPolygon[k]), GetUV(iPolygon[(k + 1) % iPolygon.size()])))
+                return true;
+        }
+        for (size_t h = iFirstHole; h < iHoles.size(); h++)
+        {
+            for (size_t k = 0; k < iHoles[h].size(); k++)
+            {
+                if (SegmentsCross(iFrom, iTo, GetUV(iHoles[h][k]), GetUV(iHoles[h][(k + 1) % iHoles[h].size()])))
+                    return true;
+            }
+        }
+        return false;
+    }
+
+    // 孔按u最大的顶点桥接到外环上最近的可见顶点，合并为一个多边形
+    void BridgeHoles(vector<DftUInt>& ioPolygon, vector<vector<DftUInt> >& ioHoles) const
+    {
+        vector<pair<double, size_t> > order(ioHoles.size());
+        for (size_t h = 0; h < ioHoles.size(); h++)
+        {
+            order[h] = make_pair(-numeric_limits<double>::max(), h);
+            for (size_t k = 0; k < ioHoles[h].size(); k++)
+                order[h].first = max(order[h].first, GetUV(ioHoles[h][k])[0]);
+        }
+        sort(order.rbegin(), order.rend());
+        vector<vector<DftUInt> > holes(ioHoles.size());
+        for (size_t h = 0; h < order.size(); h++)
+            holes[h].swap(ioHoles[order[h].second]);
+
+        for (size_t h = 0; h < holes.size(); h++)
+        {
+            const vector<DftUInt>& hole = holes[h];
+            size_t start = 0;
+            for (size_t k = 1; k < hole.size(); k++)
+            {
+                if (GetUV(hole[k])[0] > GetUV(hole[start])[0])
+                    start = k;
+            }
+            const double* point = GetUV(hole[start]);
+            size_t count = ioPolygon.size();
+            size_t best = count;
+            size_t nearest = 0;
+            double bestDistance = numeric_limits<double>::max();
+            double nearestDistance = numeric_limits<double>::max();
+            for (size_t k = 0; k < count; k++)
+            {
+                const double* a = GetUV(ioPolygon[(k + count - 1) % count]);
+                const double* o = GetUV(ioPolygon[k]);
+                const double* b = GetUV(ioPolygon[(k + 1) % count]);
+                double du = point[0] - o[0];
+                double dv = point[1] - o[1];
+                double distance = du * du + dv * dv;
+                if (distance < nearestDistance)
+                {
+                    nearestDistance = distance;
+                    nearest = k;
+                }
+                if (distance >= bestDistance)
+                    continue;
+                // 桥接线段须从顶点处的内角一侧离开
+                bool inside = Orient2d(a, o, b) >= 0.0 ? Orient2d(a, o, point) > 0.0 && Orient2d(o, b, point) > 0.0
+                                                       : Orient2d(a, o, point) > 0.0 || Orient2d(o, b, point) > 0.0;
+                if (inside && !BridgeCrosses(o, point, ioPolygon, holes, h))
+                {
+                    bestDistance = distance;
+                    best = k;
+                }
+            }
+            if (best == count)
+                best = nearest;
+
+            vector<DftUInt> merged(ioPolygon.begin(), ioPolygon.begin() + best + 1);
+            for (size_t k = 0; k <= hole.size(); k++)
+                merged.push_back(hole[(start + k) % hole.size()]);
+            merged.insert(merged.end(), ioPolygon.begin() + best, ioPolygon.end());
+            ioPolygon.swap(merged);
+        }
+    }
+
+    // 耳切法三角化逆时针的多边形；找不到耳时切去最凸的顶点
+    void ClipEars(const vector<DftUInt>& iPolygon)
+    {
+        size_t count = iPolygon.size();
+        if (count < 3)
+            return;
+        vector<size_t> previous(count);
+        vector<size_t> next(count);
+        for (size_t k = 0; k < count; k++)
+        {
+            previous[k] = (k + count - 1) % count;
+            next[k] = (k + 1) % count;
+        }
+        size_t current = 0;
+        for (size_t remaining = count; remaining > 3; remaining--)
+        {
+            size_t ear = count;
+            size_t convex = current;
+            double convexTurn = -numeric_limits<double>::max();
+            size_t v = current;
+            for (size_t k = 0; k < remaining && ear == count; k++, v = next[v])
+            {
+                DftUInt a = iPolygon[previous[v]];
+                DftUInt b = iPolygon[v];
+                DftUInt c = iPolygon[next[v]];
+                double turn = Orient2d(GetUV(a), GetUV(b), GetUV(c));
+                if (turn > convexTurn)
+                {
+                    convexTurn = turn;
+                    convex = v;
+                }
+                if (turn <= 0.0)
+                    continue;
+                bool empty = true;
+                for (size_t w = next[next[v]]; w != previous[v] && empty; w = next[w])
+                {
+                    DftUInt d = iPolygon[w];
+                    if (d == a || d == b || d == c)
+                        continue;
+                    const double* p = GetUV(d);
+                    empty = !(Orient2d(GetUV(a), GetUV(b), p) >= 0.0 && Orient2d(GetUV(b), GetUV(c), p) >= 0.0 &&
+                        Orient2d(GetUV(c), GetUV(a), p) >= 0.0);
+                }
+                if (empty)
+                    ear = v;
+            }
+            if (ear == count)
+                ear = convex;
+            m_Triangles.push_back(iPolygon[previous[ear]]);
+            m_Triangles.push_back(iPolygon[ear]);
+            m_Triangles.push_back(iPolygon[next[ear]]);
+            next[previous[ear]] = next[ear];
+            previous[next[ear]] = previous[ear];
+            current = next[ear];
+        }
+        m_Triangles.push_back(iPolygon[previous[current]]);
+        m_Triangles.push_back(iPolygon[current]);
+        m_Triangles.push_back(iPolygon[next[current]]);
+    }
+
+    double GetArea(const vector<DftUInt>& iPolygon) const
+    {
+        vector<const double*> points(iPolygon.size());
+        for (size_t k = 0; k < iPolygon.size(); k++)
+            points[k] = GetUV(iPolygon[k]);
+        return PolygonArea(points);
+    }
+
+    // 一个单元的三角化：裁剪段沿单元周边逆时针拼接为多边形，单元内的环按方向作为多边形或孔
+    void TriangulateCell(size_t iCell, bool iInside, const CellChain* iChains, size_t iCount)
+    {
+        size_t column = iCell % m_Columns;
+        size_t row = iCell / m_Columns;
+        DftUInt corners[4] = { GetCorner(column, row), GetCorner(column + 1, row), GetCorner(column + 1, row + 1), GetCorner(column, row + 1) };
+        vector<vector<DftUInt> > polygons;
+        vector<vector<DftUInt> > holes;
+        vector<bool> used(iCount, false);
+        bool hasChain = false;
+        for (size_t s = 0; s < iCount; s++)
+        {
+            if (iChains[s]._in < 0.0)
+            {
+                (GetArea(iChains[s]._vertexes) > 0.0 ? polygons : holes).push_back(iChains[s]._vertexes);
+                continue;
+            }
+            hasChain = true;
+            if (used[s])
+                continue;
+            vector<DftUInt> polygon;
+            for (size_t current = s;;)
+            {
+                used[current] = true;
+                polygon.insert(polygon.end(), iChains[current]._vertexes.begin(), iChains[current]._vertexes.end());
+                double out = iChains[current]._out;
+                size_t next = iCount;
+                double nearest = 5.0;
+                for (size_t c = 0; c < iCount; c++)
+                {
+                    if (iChains[c]._in < 0.0 || (used[c] && c != s))
+                        continue;
+                    double distance = fmod(iChains[c]._in - out + 8.0, 4.0);
+                    if (distance < nearest)
+                    {
+                        nearest = distance;
+                        next = c;
+                    }
+                }
+                if (next == iCount)
+                    break;
+                // 离开处与下一段进入处之间的单元角点
+                for (int k = 1; k <= 4; k++)
+                {
+                    double corner = floor(out) + k;
+                    if (corner - out < nearest && corner > out)
+                        polygon.push_back(corners[static_cast<int>(corner) % 4]);
+                }
+                if (next == s)
+                    break;
+                current = next;
+            }
+            if (polygon.size() >= 3)
+                polygons.push_back(polygon);
+        }
+        if (!hasChain && iInside)
+        {
+            if (holes.empty() && polygons.empty())
+            {
+                const DftUInt triangles[6] = { corners[0], corners[1], corners[2], corners[0], corners[2], corners[3] };
+                m_Triangles.insert(m_Triangles.end(), triangles, triangles + 6);
+                return;
+            }
+            polygons.push_back(vector<DftUInt>(corners, corners + 4));
+        }
+
+        // 孔归入包含它的面积最小的多边形
+        vector<vector<vector<DftUInt> > > polygonHoles(polygons.size());
+        vector<double> areas(polygons.size());
+        vector<vector<const double*> > points(polygons.size());
+        for (size_t p = 0; p < polygons.size(); p++)
+        {
+            areas[p] = GetArea(polygons[p]);
+            for (size_t k = 0; k < polygons[p].size(); k++)
+                points[p].push_back(GetUV(polygons[p][k]));
+        }
+        for (size_t h = 0; h < holes.size(); h++)
+        {
+            size_t owner = polygons.size();
+            for (size_t p = 0; p < polygons.size(); p++)
+            {
+                if ((owner == polygons.size() || areas[p] < areas[owner]) && ContainsPoint(points[p], GetUV(holes[h][0])))
+                    owner = p;
+            }
+            if (owner < polygons.size())
+            {
+                polygonHoles[owner].push_back(vector<DftUInt>());
+                polygonHoles[owner].back().swap(holes[h]);
+            }
+        }
+        for (size_t p = 0; p < polygons.size(); p++)
+        {
+            BridgeHoles(polygons[p], polygonHoles[p]);
+            ClipEars(polygons[p]);
+        }
+    }
+
+    void Trim()
+    {
+        m_Vertexes.clear();
+        m_Triangles.clear();
+        m_Corners.assign((m_Columns + 1) * (m_Rows + 1), INVALID_INDEX);
+        vector<CellChain> chains;
+        vector<char> crossed(m_Columns * m_Rows, 0);
+        for (size_t p = 0; p < m_Polygons.size(); p++)
+            TracePolygon(m_Polygons[p], chains, crossed);
+        stable_sort(chains.begin(), chains.end(), [](const CellChain& a, const CellChain& b) { return a._cell < b._cell; });
+        vector<char> inside;
+        ClassifyCells(inside);
+
+        size_t next = 0;
+        for (size_t cell = 0; cell < m_Columns * m_Rows; cell++)
+        {
+            size_t begin = next;
+            while (next < chains.size() && chains[next]._cell == cell)
+                next++;
+            if (begin == next && !inside[cell])
+                continue;
+            TriangulateCell(cell, !crossed[cell] && inside[cell], begin < next ? &chains[begin] : NULL, next - begin);
+        }
+    }
+
+    // 求值用到的顶点，写出三维面积不为0的三角形
+    bool Emit(bool iReversed, TessellatedMesh& ioMesh, DftUInt64& oTriangleCount)
+    {
+        vector<DftUInt> slots(m_Vertexes.size(), INVALID_INDEX);
+        vector<DftUInt> used;
+        for (size_t k = 0; k < m_Triangles.size(); k++)
+        {
+            if (slots[m_Triangles[k]] == INVALID_INDEX)
+            {
+                slots[m_Triangles[k]] = static_cast<DftUInt>(used.size());
+                used.push_back(m_Triangles[k]);
+            }
+        }
+        if (used.empty())
+            return false;
+
+        size_t count = used.size();
+        vector<double> u(count);
+        vector<double> v(count);
+        for (size_t k = 0; k < count; k++)
+        {
+            u[k] = m_Vertexes[used[k]]._uv[0];
+            v[k] = m_Vertexes[used[k]]._uv[1];
+        }
+        vector<double> points(count * 3);
+        vector<double> normals(count * 3);
+        m_Surface.Evaluate(&u[0], &v[0], count, &points[0], &normals[0]);
+        for (size_t k = 0; k < count; k++)
+        {
+            if (m_Vertexes[used[k]]._hasPosition)
+                copy(m_Vertexes[used[k]]._xyz, m_Vertexes[used[k]]._xyz + 3, &points[k * 3]);
+        }
+        vector<double> rounded(count * 3);
+        for (size_t k = 0; k < rounded.size(); k++)
+            rounded[k] = static_cast<DftFloat>(points[k]);
+
+        vector<DftUInt> outputs(count, INVALID_INDEX);
+        size_t base = ioMesh._vertexes.size();
+        for (size_t k = 0; k + 2 < m_Triangles.size(); k += 3)
+        {
+            DftUInt corners[3] = { slots[m_Triangles[k]], slots[m_Triangles[k + 1]], slots[m_Triangles[k + 2]] };
+            double e1[3];
+            double e2[3];
+            double normal[3];
+            Sub(&points[corners[1] * 3], &points[corners[0] * 3], e1);
+            Sub(&points[corners[2] * 3], &points[corners[0] * 3], e2);
+            Cross(e1, e2, normal);
+            if (sqrt(Dot(normal, normal)) <= sqrt(Dot(e1, e1) * Dot(e2, e2)) * 1e-12)
+                continue;
+            // 网格线贴近边界点时的细条转为单精度后朝向可能翻转，按输出的坐标复核
+            double roundedNormal[3];
+            Sub(&rounded[corners[1] * 3], &rounded[corners[0] * 3], e1);
+            Sub(&rounded[corners[2] * 3], &rounded[corners[0] * 3], e2);
+            Cross(e1, e2, roundedNormal);
+            if (Dot(normal, roundedNormal) <= 0.0)
+                continue;
+            if (iReversed)
+                swap(corners[1], corners[2]);
+            for (int c = 0; c < 3; c++)
+            {
+                DftUInt& output = outputs[corners[c]];
+                if (output == INVALID_INDEX)
+                {
+                    const double* position = &points[corners[c] * 3];
+                    const double* direction = &normals[corners[c] * 3];
+                    double sign = iReversed ? -1.0 : 1.0;
+                    VertexData vertex;
+                    vertex._position = PDVVector3F(static_cast<DftFloat>(position[0]), static_cast<DftFloat>(position[1]),
+                        static_cast<DftFloat>(position[2]));
+                    vertex._normal = PDVVector3F(static_cast<DftFloat>(sign * direction[0]), static_cast<DftFloat>(sign * direction[1]),
+                        static_cast<DftFloat>(sign * direction[2]));
+                    output = static_cast<DftUInt>(ioMesh._vertexes.size());
+                    ioMesh._vertexes.push_back(vertex);
+                }
+                ioMesh._indexes.push_back(output);
+            }
+            oTriangleCount++;
+        }
+        return ioMesh._vertexes.size() > base;
+    }
+
+    const CSurfaceGeometry& m_Surface;    ///< 面的曲面
+    double m_Tolerance;                   ///< 弦高误差上限
+    DftUInt m_MaxSegments;                ///< 一个方向的最多分段数
+    EdgeSampleMap& m_Samples;             ///< 各面共用的边采样
+    DftUInt64 m_SurfaceID;                ///< 面的曲面ID，用于选取边的参数曲线
+    bool m_Periodic[2];                   ///< 参数方向是否周期
+    double m_Period[2];                   ///< 周期
+    double m_UvEpsilon[2];                ///< 参数坐标视为重合的距离
+    vector<TrimPolygon> m_Polygons;       ///< 裁剪多边形，内侧在前进方向左侧
+    vector<double> m_Grid[2];             ///< 两个方向的网格线
+    size_t m_Columns;                     ///< 网格的列数（u方向单元数）
+    size_t m_Rows;                        ///< 网格的行数（v方向单元数）
+    vector<FaceVertex> m_Vertexes;        ///< 顶点
+    vector<DftUInt> m_Corners;            ///< 网格点对应的顶点序号，未用到的为INVALID_INDEX
+    vector<DftUInt> m_Triangles;          ///< 三角形的顶点序号
+};
+
+void ExtendBox(const double* iPoint, double iRadius, double* ioMin, double* ioMax)
+{
+    for (int c = 0; c < 3; c++)
+    {
+        ioMin[c] = min(ioMin[c], iPoint[c] - iRadius);
+        ioMax[c] = max(ioMax[c], iPoint[c] + iRadius);
+    }
+}
+
+// 面和边的几何的大致包围盒：边的顶点、圆和椭圆的外接范围、NURBS的控制点、球和圆环的外接范围
+void ExtendFaceBox(const BRepArchiveFace& iFace, double* ioMin, double* ioMax)
+{
+    const BRepArchiveSurface& surface = iFace._surface;
+    if (iFace._hasSurface)
+    {
+        if (surface._parameterType == ST_BSPLINESURFACE)
+        {
+            for (size_t k = 0; k < surface._nurbs._ctrlPoints.size(); k++)
+                ExtendBox(surface._nurbs._ctrlPoints[k]._data, 0.0, ioMin, ioMax);
+        }
+        else if (surface._parameterType == ST_SPHERE)
+            ExtendBox(surface._origin._data, surface._radius, ioMin, ioMax);
+        else if (surface._parameterType == ST_TORUS)
+            ExtendBox(surface._origin._data, surface._radius + surface._minorRadius, ioMin, ioMax);
+    }
+    for (size_t l = 0; l < iFace._loops.size(); l++)
+    {
+        const vector<BRepArchiveEdge>& edges = iFace._loops[l]._edges;
+        for (size_t e = 0; e < edges.size(); e++)
+        {
+            for (size_t v = 0; v < edges[e]._vertices.size(); v++)
+                ExtendBox(edges[e]._vertices[v]._data, 0.0, ioMin, ioMax);
+            if (!edges[e]._hasCurve)
+                continue;
+            const BRepArchiveCurve& curve = edges[e]._curve;
+            if (curve._parameterType == CT_CIRCLE || curve._parameterType == CT_ELLIPSE)
+                ExtendBox(curve._origin._data, curve._radius, ioMin, ioMax);
+            else if (curve._parameterType == CT_BSPLINECURVE)
+            {
+                for (size_t k = 0; k < curve._nurbs._ctrlPoints.size(); k++)
+                    ExtendBox(curve._nurbs._ctrlPoints[k]._data, 0.0, ioMin, ioMax);
+            }
+        }
+    }
+}
+
+// 加载全部面，返回加载失败的面数
+template <typename Loader>
+DftUInt64 LoadFaces(const Loader& iLoader, vector<BRepArchiveFace>& oFaces)
+{
+    vector<DftUInt> indexes;
+    iLoader.GetFaces(indexes);
+    oFaces.clear();
+    oFaces.reserve(indexes.size());
+    DftUInt64 failed = 0;
+    for (size_t f = 0; f < indexes.size(); f++)
+    {
+        oFaces.push_back(BRepArchiveFace());
+        if (!iLoader.LoadFace(indexes[f], oFaces.back()))
+        {
+            oFaces.pop_back();
+            failed++;
+        }
+    }
+    return failed;
+}
+
+/** 一个BRep及引用它的模型 */
+struct BRepWorkItem
+{
+    IBRep* _brep;            ///< BRep对象
+    DftUInt64 _brepID;       ///< BRep ID
+    vector<IModel*> _models; ///< 引用该BRep的模型
+
+    BRepWorkItem() : _brep(NULL), _brepID(0) {}
+};
+
+/** 一个BRep的细分结果 */
+struct BRepWorkResult
+{
+    TessellatedMesh _mesh;                ///< 网格
+    TessellateStatistics _statistics;     ///< 细分统计
+};
+
+// 模型是否已有主体网格
+bool HasMainMesh(const CSceneIndex& iSceneIndex, IModel* iModel)
+{
+    vector<DftUInt64> faceMeshIDs;
+    DftUInt renderBodyCount = iModel->GetRenderBodyCount();
+    for (DftUInt i = 0; i < renderBodyCount; i++)
+    {
+        IRenderBody* renderBody = iSceneIndex.FindRenderBody(iModel->GetRenderBodyID(i));
+        if (!renderBody)
+            continue;
+        renderBody->GetFaceMeshIDs(faceMeshIDs);
+        for (size_t j = 0; j < faceMeshIDs.size(); j++)
+        {
+            IRenderMesh* mesh = iSceneIndex.FindRenderMesh(faceMeshIDs[j]);
+            if (mesh && mesh->GetType() == RENDER_MESH_TYPE_MAIN)
+                return true;
+        }
+    }
+    return false;
+}
+
+// 收集没有主体网格的模型引用的BRep，同一BRep只细分一次
+void CollectBRepWorkItems(ISceneData* iSceneData, vector<BRepWorkItem>& oItems)
+{
+    CSceneIndex sceneIndex(iSceneData);
+    vector<IModel*> models;
+    iSceneData->GetModelArray(models);
+
+    unordered_map<DftUInt64, size_t> itemOfBRep;
+    for (size_t m = 0; m < models.size(); m++)
+    {
+        IModel* model = models[m];
+        if (!model || model->GetBRepCount() == 0 || HasMainMesh(sceneIndex, model))
+            continue;
+        DftUInt brepCount = model->GetBRepCount();
+        for (DftUInt b = 0; b < brepCount; b++)
+        {
+            DftUInt64 brepID = model->GetBRepID(b);
+            unordered_map<DftUInt64, size_t>::iterator it = itemOfBRep.find(brepID);
+            if (it != itemOfBRep.end())
+            {
+                vector<IModel*>& owners = oItems[it->second]._models;
+                if (find(owners.begin(), owners.end(), model) == owners.end())
+                    owners.push_back(model);
+                continue;
+            }
+            BRepWorkItem item;
+            item._brep = model->GetBRep(b);
+            if (!item._brep)
+                continue;
+            item._brepID = brepID;
+            item._models.push_back(model);
+            itemOfBRep[brepID] = oItems.size();
+            oItems.push_back(item);
+        }
+    }
+}
+
+// 场景对象的读取在锁内进行，细分在锁外进行
+void TessellateWorkItem(const BRepWorkItem& iItem, const TessellateOptions& iOptions, mutex& ioSceneMutex, BRepWorkResult& oResult)
+{
+    vector<BRepArchiveFace> faces;
+    {
+        lock_guard<mutex> lock(ioSceneMutex);
+        CBRepFaceLoader loader;
+        if (!loader.Open(iItem._brep))
+            return;
+        oResult._statistics._skippedFaceCount += LoadFaces(loader, faces);
+    }
+    TessellateFaces(faces, iOptions, oResult._mesh, &oResult._statistics);
+}
+
+// 把细分结果创建为顶点数据、渲染几何、主体网格和渲染主体，添加到引用BRep的模型中
+bool WriteBRepMesh(IObjectFactory* iFactory, ISceneData* ioSceneData, const BRepWorkItem& iItem, const BRepWorkResult& iResult,
+    TessellateStatistics& ioStatistics)
+{
+    ioStatistics._faceCount += iResult._statistics._faceCount;
+    ioStatistics._skippedFaceCount += iResult._statistics._skippedFaceCount;
+    if (iResult._mesh._indexes.empty())
+        return true;
+
+    IRenderVertex* vertex = NULL;
+    IRenderGeometry* geometry = NULL;
+    IRenderMesh* mesh = NULL;
+    IRenderBody* body = NULL;
+    if (iFactory->CreateRenderVertex(ioSceneData, vertex) != PDV_RESULT_NO_ERROR || !vertex)
+        return false;
+    vertex->SetVertexMask(RENDER_VERTEX_MASK_POSITION | RENDER_VERTEX_MASK_NORMAL);
+    vertex->SetVertexes(iResult._mesh._vertexes);
+    if (iFactory->CreateRenderGeometry(ioSceneData, geometry) != PDV_RESULT_NO_ERROR || !geometry)
+        return false;
+    geometry->SetIndexes(iResult._mesh._indexes);
+    geometry->SetVertexID(vertex->GetID());
+
+    if (iFactory->CreateRenderMesh(ioSceneData, mesh) != PDV_RESULT_NO_ERROR || !mesh)
+        return false;
+    mesh->SetType(RENDER_MESH_TYPE_MAIN);
+    RenderGeomInfoArray geomInfos(1);
+    geomInfos[0]._renderGeometryID = geometry->GetID();
+    geomInfos[0]._lodDetail = 1.0f;
+    mesh->SetRenderGeomeInfoArray(geomInfos);
+    mesh->SetFirstRenderGeometryID(geometry->GetID());
+
+    // 包围盒取顶点的轴对齐范围
+    const vector<VertexData>& vertexes = iResult._mesh._vertexes;
+    PDVVector3F minimum = vertexes[0]._position;
+    PDVVector3F maximum = vertexes[0]._position;
+    for (size_t v = 1; v < vertexes.size(); v++)
+    {
+        for (int c = 0; c < 3; c++)
+        {
+            minimum._data[c] = min(minimum._data[c], vertexes[v]._position._data[c]);
+            maximum._data[c] = max(maximum._data[c], vertexes[v]._position._data[c]);
+        }
+    }
+    OrientedBoundingBox box;
+    box._center = PDVVector3F((minimum._data[0] + maximum._data[0]) * 0.5f, (minimum._data[1] + maximum._data[1]) * 0.5f,
+        (minimum._data[2] + maximum._data[2]) * 0.5f);
+    box._axisX = PDVVector3F((maximum._data[0] - minimum._data[0]) * 0.5f, 0.0f, 0.0f);
+    box._axisY = PDVVector3F(0.0f, (maximum._data[1] - minimum._data[1]) * 0.5f, 0.0f);
+    box._axisZ = PDVVector3F(0.0f, 0.0f, (maximum._data[2] - minimum._data[2]) * 0.5f);
+    mesh->SetBox(box);
+
+    if (iFactory->CreateRenderBody(ioSceneData, body) != PDV_RESULT_NO_ERROR || !body)
+        return false;
+    body->SetFaceMeshIDs(vector<DftUInt64>(1, mesh->GetID()));
+    body->SetBrepID(iItem._brepID);
+
+    // 渲染主体没有设置统计的接口，面网格数和三角面数累加到模型统计中
+    DftUInt triangleCount = static_cast<DftUInt>(iResult._mesh._indexes.size() / 3);
+    for (size_t m = 0; m < iItem._models.size(); m++)
+    {
+        IModel* model = iItem._models[m];
+        model->AddRenderBodyID(body->GetID());
+        model->SetExtendBitMask(model->GetExtendBitMask() | MODEL_MASK_EXTEND_RENDERBODY);
+        Statistics modelStatistics;
+        model->GetModelStatistics(modelStatistics);
+        modelStatistics._faceMeshCount++;
+        modelStatistics._faceCount += triangleCount;
+        model->SetModelStatistics(modelStatistics);
+    }
+
+    ioStatistics._brepCount++;
+    ioStatistics._modelCount += iItem._models.size();
+    ioStatistics._vertexCount += iResult._mesh._vertexes.size();
+    ioStatistics._triangleCount += triangleCount;
+    return true;
+}
+
+} // namespace
+
+DftDouble ResolveChordTolerance(const vector<BRepArchiveFace>& iFaces, const TessellateOptions& iOptions)
+{
+    if (iOptions._chordTolerance > 0.0)
+        return iOptions._chordTolerance;
+    double relative = iOptions._relativeTolerance > 0.0 ? iOptions._relativeTolerance : TessellateOptions()._relativeTolerance;
+    double minimum[3] = { numeric_limits<double>::max(), numeric_limits<double>::max(), numeric_limits<double>::max() };
+    double maximum[3] = { -numeric_limits<double>::max(), -numeric_limits<double>::max(), -numeric_limits<double>::max() };
+    for (size_t f = 0; f < iFaces.size(); f++)
+        ExtendFaceBox(iFaces[f], minimum, maximum);
+    // 没有可用的范围时按单位尺寸
+    double diagonal = minimum[0] <= maximum[0] ? Distance(minimum, maximum) : 0.0;
+    return diagonal > 0.0 && std::isfinite(diagonal) ? diagonal * relative : relative;
+}
+
+DftBool TessellateFaces(const vector<BRepArchiveFace>& iFaces, const TessellateOptions& iOptions, TessellatedMesh& oMesh,
+    TessellateStatistics* oStatistics)
+{
+    oMesh.Clear();
+    double tolerance = ResolveChordTolerance(iFaces, iOptions);
+    DftUInt maxSegments = iOptions._maxSegments ? iOptions._maxSegments : 1;
+    EdgeSampleMap samples;
+    DftUInt64 faceCount = 0;
+    DftUInt64 skippedCount = 0;
+    DftUInt64 triangleCount = 0;
+    for (size_t f = 0; f < iFaces.size(); f++)
+    {
+        CSurfaceGeometry surface;
+        DftUInt64 triangles = 0;
+        if (iFaces[f]._hasSurface && surface.Init(iFaces[f]._surface))
+        {
+            CFaceTessellator tessellator(surface, tolerance, maxSegments, samples);
+            if (tessellator.Tessellate(iFaces[f], oMesh, triangles))
+            {
+                faceCount++;
+                triangleCount += triangles;
+                continue;
+            }
+        }
+        skippedCount++;
+    }
+    if (oStatistics)
+    {
+        oStatistics->_faceCount += faceCount;
+        oStatistics->_skippedFaceCount += skippedCount;
+        oStatistics->_vertexCount += oMesh._vertexes.size();
+        oStatistics->_triangleCount += triangleCount;
+    }
+    return faceCount > 0 ? TRUE : FALSE;
+}
+
+DftBool TessellateBRep(IBRep* iBRep, const TessellateOptions& iOptions, TessellatedMesh& oMesh, TessellateStatistics* oStatistics)
+{
+    oMesh.Clear();
+    CBRepFaceLoader loader;
+    if (!loader.Open(iBRep))
+        return FALSE;
+    vector<BRepArchiveFace> faces;
+    DftUInt64 failed = LoadFaces(loader, faces);
+    if (oStatistics)
+        oStatistics->_skippedFaceCount += failed;
+    return TessellateFaces(faces, iOptions, oMesh, oStatistics);
+}
+
+DftBool TessellateBRepArchive(const CBRepArchiveReader& iReader, const TessellateOptions& iOptions, TessellatedMesh& oMesh,
+    TessellateStatistics* oStatistics)
+{
+    vector<BRepArchiveFace> faces;
+    DftUInt64 failed = LoadFaces(iReader, faces);
+    if (oStatistics)
+        oStatistics->_skippedFaceCount += failed;
+    return TessellateFaces(faces, iOptions, oMesh, oStatistics);
+}
+
+DftBool BuildBRepMeshes(ISceneData* ioSceneData, const TessellateOptions& iOptions, TessellateStatistics* oStatistics)
+{
+    TessellateStatistics statistics;
+    if (oStatistics)
+        *oStatistics = statistics;
+    IObjectFactory* factory = IObjectFactory::GetObjectFactory();
+    if (!ioSceneData || !factory)
+        return FALSE;
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<BRepWorkItem> items;
+    CollectBRepWorkItems(ioSceneData, items);
+
+    // 各BRep并行细分，按BRep顺序创建对象，结果与线程数无关
+    mutex sceneMutex;
+    vector<BRepWorkResult> results(items.size());
+    DftBool success = RunOrdered(iOptions._threadCount, items.size(), 2,
+        [&](size_t index) { TessellateWorkItem(items[index], iOptions, sceneMutex, results[index]); },
+        [&](size_t index) {
+            bool written;
+            {
+                lock_guard<mutex> sceneLock(sceneMutex);
+                written = WriteBRepMesh(factory, ioSceneData, items[index], results[index], statistics);
+            }
+            results[index]._mesh = TessellatedMesh();
+            return written;
+        });
+
+    statistics._seconds = chrono::duration<DftDouble>(chrono::steady_clock::now() - start).count();
+    if (oStatistics)
+        *oStatistics = statistics;
+    return success;
+}
@@ -0,0 +1,124 @@
+/**
+ * @file pdvtessellate.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：BRep面的曲面细分，为没有渲染网格的模型生成三角网格
+ * @details 面、环、边和几何经CBRepFaceLoader或CBRepArchiveReader加载为存档的数据结构，按弦高误差细分：
+ *          边先按三维曲线自适应二分采样，同一条边在相邻的面中取相同的采样点，端点对齐到顶点，因此相邻面的边界重合；
+ *          采样点经参数曲线（没有时按初等曲面求逆）换算到面的参数域，展开周期坐标后组成裁剪多边形，
+ *          绕周期方向一整圈的环沿接缝两两相连，不成对的环与参数域边界相连，按嵌套层数区分外环和内环。
+ *          参数域按节点区间或角度分段，每段的分段数由等参线的弦高偏差确定，得到结构化网格；
+ *          裁剪多边形逐段穿过网格单元，在网格线上插入交点，单元内沿边界拼接为多边形后用耳切法三角化，完整的单元直接分为两个三角形。
+ *          NURBS曲面和曲线用pdvnurbs.h的批量求值，一个面的全部网格点一次求值。
+ *          BuildBRepMeshes把结果写为场景的渲染顶点、渲染几何、主体网格和渲染主体，导出STL、PLY、OBJ、glTF和3D Tiles时与原有网格一样处理。
+ */
+
+#ifndef PDVTESSELLATE_H
+#define PDVTESSELLATE_H
+
+#include "PDVIRenderVertex.h"
+#include "pdvbreparchive.h"
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+class ISceneData;
+class IBRep;
+} // namespace pdv
+} // namespace kernel
+
+/** @brief 细分参数 */
+struct TessellateOptions
+{
+    DftDouble _chordTolerance;     ///< 弦高误差上限（模型单位），为0时按_relativeTolerance
+    DftDouble _relativeTolerance;  ///< 弦高误差上限相对BRep包围盒对角线的比例
+    DftUInt _maxSegments;          ///< 一条边、曲面一个参数方向的最多分段数
+    DftUInt _threadCount;          ///< 细分线程数，为0时取CPU逻辑核数
+
+    TessellateOptions() : _chordTolerance(0.0), _relativeTolerance(1e-3), _maxSegments(256), _threadCount(0) {}
+};
+
+/** @brief 细分统计 */
+struct TessellateStatistics
+{
+    DftUInt64 _brepCount;         ///< 细分的BRep数
+    DftUInt64 _modelCount;        ///< 新增了渲染主体的模型数
+    DftUInt64 _faceCount;         ///< 细分的面数
+    DftUInt64 _skippedFaceCount;  ///< 没有曲面、曲面类型不支持或环无法换算到参数域而跳过的面数
+    DftUInt64 _vertexCount;       ///< 生成的顶点数
+    DftUInt64 _triangleCount;     ///< 生成的三角面数
+    DftDouble _seconds;           ///< 总耗时
+
+    TessellateStatistics()
+        : _brepCount(0), _modelCount(0), _faceCount(0), _skippedFaceCount(0), _vertexCount(0), _triangleCount(0), _seconds(0.0) {}
+};
+
+/** @brief 细分得到的三角网格 */
+struct TessellatedMesh
+{
+    std::vector<kernel::pdv::VertexData> _vertexes;  ///< 顶点，含位置和法向
+    std::vector<DftUInt32> _indexes;                 ///< 三角形索引，逆时针为正面
+
+    void Clear()
+    {
+        _vertexes.clear();
+        _indexes.clear();
+    }
+};
+
+/**
+ * @brief 由面的包围盒确定弦高误差上限
+ * @return DftDouble 误差上限，_chordTolerance大于0时即为该值
+ * @param[in] iFaces 面，一般为一个BRep的全部面
+ * @param[in] iOptions 细分参数
+ */
+DftDouble ResolveChordTolerance(const std::vector<BRepArchiveFace>& iFaces, const TessellateOptions& iOptions);
+
+/**
+ * @brief 细分一组面，同一条边在各面中取相同的采样点
+ * @return DftBool 是否至少细分了一个面
+ * @param[in] iFaces 面，一般为一个BRep的全部面
+ * @param[in] iOptions 细分参数
+ * @param[out] oMesh 各面依次追加的网格，面之间不共用顶点
+ * @param[out] oStatistics 细分统计，面数、顶点数和三角面数累加到其中，可为NULL
+ */
+DftBool TessellateFaces(const std::vector<BRepArchiveFace>& iFaces, const TessellateOptions& iOptions, TessellatedMesh& oMesh,
+    TessellateStatistics* oStatistics = NULL);
+
+/**
+ * @brief 细分内存中的IBRep
+ * @return DftBool 是否至少细分了一个面
+ * @param[in] iBRep BRep对象
+ * @param[in] iOptions 细分参数
+ * @param[out] oMesh 网格
+ * @param[out] oStatistics 细分统计，面数、顶点数和三角面数累加到其中，可为NULL
+ */
+DftBool TessellateBRep(kernel::pdv::IBRep* iBRep, const TessellateOptions& iOptions, TessellatedMesh& oMesh,
+    TessellateStatistics* oStatistics = NULL);
+
+/**
+ * @brief 细分已打开的BRep存档
+ * @return DftBool 是否至少细分了一个面
+ * @param[in] iReader 存档读取对象
+ * @param[in] iOptions 细分参数
+ * @param[out] oMesh 网格
+ * @param[out] oStatistics 细分统计，面数、顶点数和三角面数累加到其中，可为NULL
+ */
+DftBool TessellateBRepArchive(const CBRepArchiveReader& iReader, const TessellateOptions& iOptions, TessellatedMesh& oMesh,
+    TessellateStatistics* oStatistics = NULL);
+
+/**
+ * @brief 为有BRep而没有主体网格的模型细分BRep，并写入场景
+ * @return DftBool 对象工厂不可用或创建对象失败时为FALSE
+ * @param[in,out] ioSceneData 场景数据，新建的顶点数据、渲染几何、主体网格和渲染主体属于该场景
+ * @param[in] iOptions 细分参数
+ * @param[out] oStatistics 细分统计，可为NULL
+ * @note 每个BRep生成一个渲染主体，其中一个主体网格；引用同一BRep的模型共用该渲染主体。
+ *       BRep在线程池中并行细分，创建对象在当前线程中按模型顺序进行，生成的对象ID与线程数无关。
+ *       已有主体网格的模型保持不变，因此对同一场景重复调用不会再次生成。
+ */
+DftBool BuildBRepMeshes(kernel::pdv::ISceneData* ioSceneData, const TessellateOptions& iOptions, TessellateStatistics* oStatistics = NULL);
+
+#endif
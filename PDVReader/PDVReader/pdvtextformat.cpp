@@ -0,0 +1,112 @@
+#include "pdvtextformat.h"
+#include <charconv>
+#include <cstring>
+
+using namespace std;
+
+namespace
+{
+
+int ClampPrecision(int iPrecision)
+{
+    if (iPrecision < 0)
+        return PDV_TEXT_DEFAULT_PRECISION;
+    return iPrecision > PDV_TEXT_MAX_PRECISION ? PDV_TEXT_MAX_PRECISION : iPrecision;
+}
+
+} // namespace
+
+char* FormatUInt(char* oBuffer, DftUInt64 iValue)
+{
+    return to_chars(oBuffer, oBuffer + PDV_TEXT_SHORT_NUMBER_MAX_SIZE, iValue).ptr;
+}
+
+char* FormatInt(char* oBuffer, DftInt64 iValue)
+{
+    return to_chars(oBuffer, oBuffer + PDV_TEXT_SHORT_NUMBER_MAX_SIZE, iValue).ptr;
+}
+
+char* FormatFixed(char* oBuffer, DftDouble iValue, int iPrecision)
+{
+    return to_chars(oBuffer, oBuffer + PDV_TEXT_NUMBER_MAX_SIZE, iValue, chars_format::fixed, ClampPrecision(iPrecision)).ptr;
+}
+
+char* FormatGeneral(char* oBuffer, DftDouble iValue, int iPrecision)
+{
+    // printf的%g把精度0视为1
+    int precision = ClampPrecision(iPrecision);
+    return to_chars(oBuffer, oBuffer + PDV_TEXT_SHORT_NUMBER_MAX_SIZE, iValue, chars_format::general, precision ? precision : 1).ptr;
+}
+
+CTextWriter& CTextWriter::Append(const char* iText)
+{
+    m_Writer.Write(iText, strlen(iText));
+    return *this;
+}
+
+CTextWriter& CTextWriter::AppendUInt(DftUInt64 iValue)
+{
+    char* begin = reinterpret_cast<char*>(m_Writer.Reserve(PDV_TEXT_SHORT_NUMBER_MAX_SIZE));
+    m_Writer.Unreserve(PDV_TEXT_SHORT_NUMBER_MAX_SIZE - (FormatUInt(begin, iValue) - begin));
+    return *this;
+}
+
+CTextWriter& CTextWriter::AppendInt(DftInt64 iValue)
+{
+    char* begin = reinterpret_cast<char*>(m_Writer.Reserve(PDV_TEXT_SHORT_NUMBER_MAX_SIZE));
+    m_Writer.Unreserve(PDV_TEXT_SHORT_NUMBER_MAX_SIZE - (FormatInt(begin, iValue) - begin));
+    return *this;
+}
+
+CTextWriter& CTextWriter::AppendFixed(DftDouble iValue)
+{
+    char* begin = reinterpret_cast<char*>(m_Writer.Reserve(PDV_TEXT_NUMBER_MAX_SIZE));
+    m_Writer.Unreserve(PDV_TEXT_NUMBER_MAX_SIZE - (FormatFixed(begin, iValue, m_Precision) - begin));
+    return *this;
+}
+
+CTextWriter& CTextWriter::AppendGeneral(DftDouble iValue)
+{
+    char* begin = reinterpret_cast<char*>(m_Writer.Reserve(PDV_TEXT_SHORT_NUMBER_MAX_SIZE));
+    m_Writer.Unreserve(PDV_TEXT_SHORT_NUMBER_MAX_SIZE - (FormatGeneral(begin, iValue, m_Precision) - begin));
+    return *this;
+}
+
+char* CTextBuilder::Reserve(size_t iSize)
+{
+    size_t used = m_Text.size();
+    m_Text.resize(used + iSize);
+    return &m_Text[used];
+}
+
+CTextBuilder& CTextBuilder::AppendUInt(DftUInt64 iValue)
+{
+    Commit(FormatUInt(Reserve(PDV_TEXT_SHORT_NUMBER_MAX_SIZE), iValue));
+    return *this;
+}
+
+CTextBuilder& CTextBuilder::AppendInt(DftInt64 iValue)
+{
+    Commit(FormatInt(Reserve(PDV_TEXT_SHORT_NUMBER_MAX_SIZE), iValue));
+    return *this;
+}
+
+CTextBuilder& CTextBuilder::AppendFixed(DftDouble iValue)
+{
+    Commit(FormatFixed(Reserve(PDV_TEXT_NUMBER_MAX_SIZE), iValue, m_Precision));
+    return *this;
+}
+
+CTextBuilder& CTextBuilder::AppendGeneral(DftDouble iValue)
+{
+    Commit(FormatGeneral(Reserve(PDV_TEXT_SHORT_NUMBER_MAX_SIZE), iValue, m_Precision));
+    return *this;
+}
+
+CTextBuilder& CTextBuilder::PadLeft(size_t iStart, size_t iWidth)
+{
+    size_t length = m_Text.size() > iStart ? m_Text.size() - iStart : 0;
+    if (iStart <= m_Text.size() && length < iWidth)
+        m_Text.insert(iStart, iWidth - length, ' ');
+    return *this;
+}
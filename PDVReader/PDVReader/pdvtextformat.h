@@ -0,0 +1,199 @@
+/**
+ * @file pdvtextformat.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：不依赖iostream的数值文本格式化
+ * @details 数值基于std::to_chars直接写入字节缓冲区，不经过locale和流状态，结果与printf的"%.Nf"、"%.Ng"逐字节一致。
+ *          CTextWriter在CBufferedFileWriter的缓冲区中原地格式化，供ASCII STL、CSV等文本输出使用；
+ *          CTextBuilder在内存字符串中原地格式化，供属性值、控制台信息等先拼成一行再使用的文本。
+ */
+
+#ifndef PDVTEXTFORMAT_H
+#define PDVTEXTFORMAT_H
+
+#include "DftBase.h"
+#include "pdvfilewriter.h"
+#include <string>
+
+/** @brief 定点格式的最大字节数（双精度最大值的整数部分加小数部分） */
+#define PDV_TEXT_NUMBER_MAX_SIZE 352
+
+/** @brief 整数和通用格式的最大字节数 */
+#define PDV_TEXT_SHORT_NUMBER_MAX_SIZE 32
+
+/** @brief 支持的最大精度 */
+#define PDV_TEXT_MAX_PRECISION 17
+
+/** @brief 默认精度，与iostream默认的setprecision(6)一致 */
+#define PDV_TEXT_DEFAULT_PRECISION 6
+
+/**
+ * @brief 格式化无符号整数
+ * @return char* 写入内容的结束位置
+ * @param[out] oBuffer 输出位置，至少PDV_TEXT_SHORT_NUMBER_MAX_SIZE字节
+ * @param[in] iValue 数值
+ */
+char* FormatUInt(char* oBuffer, DftUInt64 iValue);
+
+/**
+ * @brief 格式化有符号整数
+ * @return char* 写入内容的结束位置
+ * @param[out] oBuffer 输出位置，至少PDV_TEXT_SHORT_NUMBER_MAX_SIZE字节
+ * @param[in] iValue 数值
+ */
+char* FormatInt(char* oBuffer, DftInt64 iValue);
+
+/**
+ * @brief 定点格式，等同于"%.Nf"或fixed << setprecision(N)
+ * @return char* 写入内容的结束位置
+ * @param[out] oBuffer 输出位置，至少PDV_TEXT_NUMBER_MAX_SIZE字节
+ * @param[in] iValue 数值
+ * @param[in] iPrecision 小数位数，超过PDV_TEXT_MAX_PRECISION时按PDV_TEXT_MAX_PRECISION处理
+ */
+char* FormatFixed(char* oBuffer, DftDouble iValue, int iPrecision);
+
+/**
+ * @brief 通用格式，等同于"%.Ng"或流的默认浮点输出
+ * @return char* 写入内容的结束位置
+ * @param[out] oBuffer 输出位置，至少PDV_TEXT_SHORT_NUMBER_MAX_SIZE字节
+ * @param[in] iValue 数值
+ * @param[in] iPrecision 有效数字位数，超过PDV_TEXT_MAX_PRECISION时按PDV_TEXT_MAX_PRECISION处理
+ */
+char* FormatGeneral(char* oBuffer, DftDouble iValue, int iPrecision);
+
+/** @brief 带缓冲的文本文件输出，数值直接格式化到缓冲区中 */
+class CTextWriter
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] iPrecision 浮点数精度
+     */
+    explicit CTextWriter(int iPrecision = PDV_TEXT_DEFAULT_PRECISION) : m_Precision(iPrecision) {}
+
+    /**
+     * @brief 创建文件
+     * @return DftBool 是否成功
+     * @param[in] iPath 文件路径
+     */
+    DftBool Open(const std::string& iPath) { return m_Writer.Open(iPath); }
+
+    /**
+     * @brief 写盘并关闭文件
+     * @return DftBool 所有数据是否都已成功写入
+     */
+    DftBool Close() { return m_Writer.Close(); }
+
+    /** @brief 文件是否已打开 */
+    DftBool IsOpen() const { return m_Writer.IsOpen(); }
+
+    /** @brief 已输出的总字节数 */
+    DftUInt64 GetBytesWritten() const { return m_Writer.GetBytesWritten(); }
+
+    /** @brief 设置浮点数精度 */
+    void SetPrecision(int iPrecision) { m_Precision = iPrecision; }
+    /** @brief 浮点数精度 */
+    int GetPrecision() const { return m_Precision; }
+
+    /** @brief 追加字符 */
+    CTextWriter& Append(char iChar)
+    {
+        *m_Writer.Reserve(1) = static_cast<DftByte>(iChar);
+        return *this;
+    }
+    /** @brief 追加以'\0'结尾的字符串 */
+    CTextWriter& Append(const char* iText);
+    /** @brief 追加字符串 */
+    CTextWriter& Append(const std::string& iText)
+    {
+        m_Writer.Write(iText.data(), iText.size());
+        return *this;
+    }
+    /** @brief 追加以双引号括起的字符串 */
+    CTextWriter& AppendQuoted(const char* iText) { return Append('"').Append(iText).Append('"'); }
+
+    /** @brief 追加无符号整数 */
+    CTextWriter& AppendUInt(DftUInt64 iValue);
+    /** @brief 追加有符号整数 */
+    CTextWriter& AppendInt(DftInt64 iValue);
+    /** @brief 以定点格式追加浮点数，小数位数为当前精度 */
+    CTextWriter& AppendFixed(DftDouble iValue);
+    /** @brief 以通用格式追加浮点数，有效数字位数为当前精度 */
+    CTextWriter& AppendGeneral(DftDouble iValue);
+
+private:
+    CTextWriter(const CTextWriter&);
+    CTextWriter& operator=(const CTextWriter&);
+
+    CBufferedFileWriter m_Writer; ///< 输出缓冲
+    int m_Precision;              ///< 浮点数精度
+};
+
+/** @brief 在内存字符串中拼接文本，数值的格式与CTextWriter相同 */
+class CTextBuilder
+{
+public:
+    /**
+     * @brief 构造函数
+     * @param[in] iPrecision 浮点数精度
+     */
+    explicit CTextBuilder(int iPrecision = PDV_TEXT_DEFAULT_PRECISION) : m_Precision(iPrecision) {}
+
+    /** @brief 清空内容，保留已分配的内存 */
+    void Clear() { m_Text.clear(); }
+    /** @brief 拼接的文本 */
+    const std::string& GetText() const { return m_Text; }
+    /** @brief 文本长度 */
+    size_t GetSize() const { return m_Text.size(); }
+
+    /** @brief 设置浮点数精度 */
+    void SetPrecision(int iPrecision) { m_Precision = iPrecision; }
+    /** @brief 浮点数精度 */
+    int GetPrecision() const { return m_Precision; }
+
+    /** @brief 追加字符 */
+    CTextBuilder& Append(char iChar)
+    {
+        m_Text += iChar;
+        return *this;
+    }
+    /** @brief 追加以'\0'结尾的字符串 */
+    CTextBuilder& Append(const char* iText)
+    {
+        m_Text += iText;
+        return *this;
+    }
+    /** @brief 追加字符串 */
+    CTextBuilder& Append(const std::string& iText)
+    {
+        m_Text += iText;
+        return *this;
+    }
+
+    /** @brief 追加无符号整数 */
+    CTextBuilder& AppendUInt(DftUInt64 iValue);
+    /** @brief 追加有符号整数 */
+    CTextBuilder& AppendInt(DftInt64 iValue);
+    /** @brief 以定点格式追加浮点数，小数位数为当前精度 */
+    CTextBuilder& AppendFixed(DftDouble iValue);
+    /** @brief 以通用格式追加浮点数，有效数字位数为当前精度 */
+    CTextBuilder& AppendGeneral(DftDouble iValue);
+
+    /**
+     * @brief 在iStart处补空格，使其后的内容右对齐到iWidth字节，等同于setw
+     * @param[in] iStart 需要对齐的内容在文本中的起始位置
+     * @param[in] iWidth 对齐宽度，内容已不短于该宽度时不变
+     */
+    CTextBuilder& PadLeft(size_t iStart, size_t iWidth);
+
+private:
+    /** 在末尾预留iSize字节，返回预留的起始地址 */
+    char* Reserve(size_t iSize);
+    /** 把末尾截到iEnd，归还Reserve中未用的部分 */
+    void Commit(const char* iEnd) { m_Text.resize(static_cast<size_t>(iEnd - m_Text.data())); }
+
+    std::string m_Text; ///< 拼接的文本
+    int m_Precision;    ///< 浮点数精度
+};
+
+#endif
@@ -0,0 +1,166 @@
+#include "pdvthreadpool.h"
+
+using namespace std;
+
+CThreadPool::CThreadPool(DftUInt iThreadCount)
+    : m_Queued(0)
+    , m_Unfinished(0)
+    , m_NextQueue(0)
+    , m_Stop(false)
+{
+    DftUInt threadCount = ResolveThreadCount(iThreadCount);
+    for (DftUInt i = 0; i < threadCount; i++)
+        m_Queues.push_back(new WorkerQueue());
+    for (DftUInt i = 0; i < threadCount; i++)
+        m_Workers.push_back(thread(&CThreadPool::WorkerLoop, this, static_cast<size_t>(i)));
+}
+
+CThreadPool::~CThreadPool()
+{
+    Wait();
+    {
+        lock_guard<mutex> lock(m_Mutex);
+        m_Stop = true;
+    }
+    m_WakeCond.notify_all();
+    for (size_t i = 0; i < m_Workers.size(); i++)
+        m_Workers[i].join();
+    for (size_t i = 0; i < m_Queues.size(); i++)
+        SAFE_DELETE(m_Queues[i]);
+}
+
+DftUInt CThreadPool::ResolveThreadCount(DftUInt iThreadCount)
+{
+    if (iThreadCount > 0)
+        return iThreadCount;
+    DftUInt hardware = thread::hardware_concurrency();
+    return hardware > 0 ? hardware : 1;
+}
+
+void CThreadPool::Submit(const function<void()>& iTask)
+{
+    size_t index;
+    {
+        lock_guard<mutex> lock(m_Mutex);
+        index = m_NextQueue;
+        m_NextQueue = (m_NextQueue + 1) % m_Queues.size();
+        m_Unfinished++;
+    }
+    {
+        lock_guard<mutex> lock(m_Queues[index]->_mutex);
+        m_Queues[index]->_tasks.push_back(iTask);
+    }
+    {
+        // 计数在锁内增加，保证休眠中的线程不会漏掉唤醒
+        lock_guard<mutex> lock(m_Mutex);
+        m_Queued++;
+    }
+    m_WakeCond.notify_one();
+}
+
+void CThreadPool::Wait()
+{
+    unique_lock<mutex> lock(m_Mutex);
+    m_DoneCond.wait(lock, [this] { return m_Unfinished == 0; });
+}
+
+bool CThreadPool::PopTask(size_t iIndex, function<void()>& oTask)
+{
+    {
+        WorkerQueue* own = m_Queues[iIndex];
+        lock_guard<mutex> lock(own->_mutex);
+        if (!own->_tasks.empty())
+        {
+            oTask.swap(own->_tasks.front());
+            own->_tasks.pop_front();
+            m_Queued--;
+            return true;
+        }
+    }
+
+    // 自己的队列为空，从其他线程的队列尾部窃取
+    for (size_t i = 1; i < m_Queues.size(); i++)
+    {
+        WorkerQueue* victim = m_Queues[(iIndex + i) % m_Queues.size()];
+        lock_guard<mutex> lock(victim->_mutex);
+        if (!victim->_tasks.empty())
+        {
+            oTask.swap(victim->_tasks.back());
+            victim->_tasks.pop_back();
+            m_Queued--;
+            return true;
+        }
+    }
+    return false;
+}
+
+void CThreadPool::WorkerLoop(size_t iIndex)
+{
+    for (;;)
+    {
+        function<void()> task;
+        if (PopTask(iIndex, task))
+        {
+            task();
+            lock_guard<mutex> lock(m_Mutex);
+            if (--m_Unfinished == 0)
+                m_DoneCond.notify_all();
+            continue;
+        }
+
+        unique_lock<mutex> lock(m_Mutex);
+        m_WakeCond.wait(lock, [this] { return m_Stop || m_Queued > 0; });
+        if (m_Stop && m_Queued == 0)
+            return;
+    }
+}
+
+DftBool RunOrdered(DftUInt iThreadCount, size_t iCount, DftUInt iWindowPerThread, const function<void(size_t)>& iWork,
+    const function<bool(size_t)>& iCommit, const function<void(size_t)>& iPrepare)
+{
+    DftUInt threadCount = CThreadPool::ResolveThreadCount(iThreadCount);
+    if (threadCount <= 1 || iCount <= 1)
+    {
+        for (size_t k = 0; k < iCount; k++)
+        {
+            if (iPrepare)
+                iPrepare(k);
+            iWork(k);
+            if (!iCommit(k))
+                return FALSE;
+        }
+        return TRUE;
+    }
+
+    vector<char> done(iCount, 0);
+    mutex doneMutex;
+    condition_variable doneCond;
+    CThreadPool pool(threadCount);
+    size_t window = static_cast<size_t>(threadCount) * (iWindowPerThread ? iWindowPerThread : 1);
+    size_t submitted = 0;
+    bool success = true;
+    for (size_t next = 0; next < iCount && success; next++)
+    {
+        for (; submitted < iCount && submitted < next + window; submitted++)
+        {
+            if (iPrepare)
+                iPrepare(submitted);
+            size_t index = submitted;
+            pool.Submit([&, index]() {
+                iWork(index);
+                lock_guard<mutex> lock(doneMutex);
+                done[index] = 1;
+                doneCond.notify_all();
+            });
+        }
+
+        {
+            unique_lock<mutex> lock(doneMutex);
+            doneCond.wait(lock, [&done, next]() { return done[next] != 0; });
+        }
+        success = iCommit(next);
+    }
+    // 提交失败时仍要等待已交给工作线程的任务结束
+    pool.Wait();
+    return success ? TRUE : FALSE;
+}
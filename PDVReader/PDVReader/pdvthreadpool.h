@@ -0,0 +1,92 @@
+/**
+ * @file pdvthreadpool.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：工作窃取线程池
+ * @details 每个工作线程拥有自己的任务队列，提交的任务按轮转方式分配到各队列。
+ *          线程优先从自己队列的头部取任务，队列为空时从其他线程队列的尾部窃取，避免个别大任务拖慢整体。
+ *          RunOrdered在线程池中并行处理一组任务，由当前线程按序号依次提交结果，供输出顺序须与线程数无关的流程使用。
+ */
+
+#ifndef PDVTHREADPOOL_H
+#define PDVTHREADPOOL_H
+
+#include "DftBase.h"
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/** @brief 工作窃取线程池 */
+class CThreadPool
+{
+public:
+    /**
+     * @brief 构造函数，创建工作线程
+     * @param[in] iThreadCount 线程数，为0时取CPU逻辑核数
+     */
+    explicit CThreadPool(DftUInt iThreadCount = 0);
+    /** 析构函数，等待已提交的任务完成后退出线程 */
+    ~CThreadPool();
+
+    /** @brief 工作线程数 */
+    DftUInt GetThreadCount() const { return static_cast<DftUInt>(m_Workers.size()); }
+
+    /**
+     * @brief 提交任务
+     * @param[in] iTask 任务
+     */
+    void Submit(const std::function<void()>& iTask);
+
+    /** @brief 等待所有已提交的任务完成 */
+    void Wait();
+
+    /**
+     * @brief 将线程数参数换算为实际线程数
+     * @return DftUInt 实际线程数，不小于1
+     * @param[in] iThreadCount 线程数，为0时取CPU逻辑核数
+     */
+    static DftUInt ResolveThreadCount(DftUInt iThreadCount);
+
+private:
+    CThreadPool(const CThreadPool&);
+    CThreadPool& operator=(const CThreadPool&);
+
+    /** 单个工作线程的任务队列 */
+    struct WorkerQueue
+    {
+        std::mutex _mutex;                         ///< 队列锁
+        std::deque<std::function<void()> > _tasks; ///< 待执行的任务
+    };
+
+    void WorkerLoop(size_t iIndex);
+    bool PopTask(size_t iIndex, std::function<void()>& oTask);
+
+    std::vector<WorkerQueue*> m_Queues;  ///< 各线程的任务队列
+    std::vector<std::thread> m_Workers;  ///< 工作线程
+    std::mutex m_Mutex;                  ///< 保护休眠与完成状态
+    std::condition_variable m_WakeCond;  ///< 有新任务或退出时唤醒工作线程
+    std::condition_variable m_DoneCond;  ///< 全部任务完成时唤醒Wait
+    std::atomic<size_t> m_Queued;        ///< 已提交但尚未被取走的任务数
+    size_t m_Unfinished;                 ///< 已提交但尚未完成的任务数
+    size_t m_NextQueue;                  ///< 下一个任务分配到的队列
+    bool m_Stop;                         ///< 是否退出
+};
+
+/**
+ * @brief 并行处理iCount个任务，当前线程按序号依次提交结果
+ * @return DftBool 所有结果是否都提交成功
+ * @param[in] iThreadCount 线程数，为0时取CPU逻辑核数，为1时全部在当前线程中执行
+ * @param[in] iCount 任务数
+ * @param[in] iWindowPerThread 每个线程对应的未提交任务数，已提交处理但结果尚未提交的任务不超过线程数乘以该值，限制中间结果的内存占用
+ * @param[in] iWork 处理第index个任务，在工作线程中调用
+ * @param[in] iCommit 提交第index个任务的结果，在当前线程中按序号调用；返回false时不再处理之后的任务
+ * @param[in] iPrepare 在当前线程中把第index个任务交给工作线程之前调用，可为空，用于把回收的缓冲区分配给该任务
+ */
+DftBool RunOrdered(DftUInt iThreadCount, size_t iCount, DftUInt iWindowPerThread, const std::function<void(size_t)>& iWork,
+    const std::function<bool(size_t)>& iCommit, const std::function<void(size_t)>& iPrepare = std::function<void(size_t)>());
+
+#endif
@@ -0,0 +1,541 @@
+#include "pdvtilebuilder.h"
+#include "pdvprofiler.h"
+#include "pdvsceneindex.h"
+#include "pdvthreadpool.h"
+#include "PDVISceneData.h"
+#include "PDVITileSet.h"
+#include "PDVIModelTree.h"
+#include "PDVIModelTreeNode.h"
+#include "PDVIModel.h"
+#include "PDVIRenderBody.h"
+#include "PDVIRenderMesh.h"
+#include "PDVIRenderGeometry.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+/** 一个划分单元：某个节点下的一个渲染主体 */
+struct TileItem
+{
+    DftUInt64 _bodyID;      ///< 渲染主体ID
+    DftUInt64 _nodeID;      ///< 节点ID
+    size_t _model;          ///< 节点所关联模型的序号
+    bool _primary;          ///< 该节点是否为引用此渲染主体的第一个节点
+    DftUInt64 _triangles;   ///< 三角面数
+    DftDouble _min[3];      ///< 场景坐标系中的最小值
+    DftDouble _max[3];      ///< 场景坐标系中的最大值
+    DftDouble _size;        ///< 最大边长
+    DftDouble _diagonal;    ///< 对角线长度
+};
+
+/** 划分过程中只读的数据 */
+struct TileBuildContext
+{
+    vector<TileItem> _items;                  ///< 所有划分单元
+    vector<vector<DftUInt64> > _modelBodies;  ///< 各模型的渲染主体ID，已排序
+    TileBuildOptions _options;                ///< 划分参数
+};
+
+/** 八叉树的立方体单元 */
+struct TileCell
+{
+    DftDouble _min[3];  ///< 最小角点
+    DftDouble _size;    ///< 边长
+    DftUInt _depth;     ///< 深度
+};
+
+/** 留待线程池划分的子树 */
+struct PendingTile
+{
+    TileData* _tile;                   ///< 瓦片，已由父瓦片创建
+    vector<size_t> _items;             ///< 子树中的划分单元
+    TileCell _cell;                    ///< 立方体单元
+    TileBuildStatistics _statistics;   ///< 子树的划分统计
+};
+
+// 有向包围盒的8个角点经行向量约定的矩阵变换后，合并到轴对齐包围盒
+void ExpandByBox(const OrientedBoundingBox& iBox, const PDVMatrix4F& iMatrix, bool& ioValid, DftDouble ioMin[3], DftDouble ioMax[3])
+{
+    for (int corner = 0; corner < 8; corner++)
+    {
+        DftDouble local[3];
+        for (int i = 0; i < 3; i++)
+        {
+            local[i] = static_cast<DftDouble>(iBox._center._data[i]) + ((corner & 1) ? iBox._axisX._data[i] : -iBox._axisX._data[i]) +
+                ((corner & 2) ? iBox._axisY._data[i] : -iBox._axisY._data[i]) +
+                ((corner & 4) ? iBox._axisZ._data[i] : -iBox._axisZ._data[i]);
+        }
+        for (int i = 0; i < 3; i++)
+        {
+            DftDouble value = local[0] * iMatrix._data[0][i] + local[1] * iMatrix._data[1][i] + local[2] * iMatrix._data[2][i] +
+                iMatrix._data[3][i];
+            ioMin[i] = !ioValid || value < ioMin[i] ? value : ioMin[i];
+            ioMax[i] = !ioValid || value > ioMax[i] ? value : ioMax[i];
+        }
+        ioValid = true;
+    }
+}
+
+// 渲染主体的三角面数；加载后新建的渲染主体（如BRep细分的结果）没有统计，按面网格的第一个渲染几何计数
+DftUInt64 GetBodyTriangleCount(const CSceneIndex& iSceneIndex, IRenderBody* iBody)
+{
+    Statistics bodyStatistics;
+    if (iBody->GetStatistics(bodyStatistics) == PDV_RESULT_NO_ERROR && bodyStatistics._faceCount > 0)
+        return bodyStatistics._faceCount;
+
+    DftUInt64 triangles = 0;
+    vector<DftUInt64> faceMeshIDs;
+    iBody->GetFaceMeshIDs(faceMeshIDs);
+    for (size_t m = 0; m < faceMeshIDs.size(); m++)
+    {
+        IRenderMesh* mesh = iSceneIndex.FindRenderMesh(faceMeshIDs[m]);
+        IRenderGeometry* geometry = mesh ? iSceneIndex.FindRenderGeometry(mesh->GetFirstRenderGeometryID()) : NULL;
+        if (geometry)
+            triangles += geometry->GetIndexCount() / 3;
+    }
+    return triangles;
+}
+
+// 渲染主体的包围盒，依次尝试渲染主体、面网格和模型的外包区域
+bool GetBodyBounds(const CSceneIndex& iSceneIndex, IRenderBody* iBody, IModel* iModel, const PDVMatrix4F& iWorldTrans,
+    DftDouble oMin[3], DftDouble oMax[3])
+{
+    bool valid = false;
+    OrientedBoundingBox box;
+    if (iBody->GetBox(box) == PDV_RESULT_NO_ERROR && IsBoxValid(box))
+    {
+        ExpandByBox(box, iWorldTrans, valid, oMin, oMax);
+        return true;
+    }
+
+    vector<DftUInt64> faceMeshIDs;
+    iBody->GetFaceMeshIDs(faceMeshIDs);
+    for (size_t m = 0; m < faceMeshIDs.size(); m++)
+    {
+        IRenderMesh* mesh = iSceneIndex.FindRenderMesh(faceMeshIDs[m]);
+        if (mesh && mesh->GetBox(box) == PDV_RESULT_NO_ERROR && IsBoxValid(box))
+            ExpandByBox(box, iWorldTrans, valid, oMin, oMax);
+    }
+    if (valid)
+        return true;
+
+    BoundingVolume volume;
+    if (iModel->GetBoundingVolume(volume) != PDV_RESULT_NO_ERROR)
+        return false;
+    if (IsBoxValid(volume._box))
+    {
+        ExpandByBox(volume._box, iWorldTrans, valid, oMin, oMax);
+    }
+    else if (volume._sphere._radius > 0.0f)
+    {
+        OrientedBoundingBox sphereBox;
+        sphereBox._center = volume._sphere._center;
+        sphereBox._axisX._data[0] = sphereBox._axisY._data[1] = sphereBox._axisZ._data[2] = volume._sphere._radius;
+        ExpandByBox(sphereBox, iWorldTrans, valid, oMin, oMax);
+    }
+    return valid;
+}
+
+// 一组单元的包围盒写为瓦片的外包盒和外包球
+void SetTileVolume(const TileBuildContext& iContext, const vector<size_t>& iItems, TileData& oTile)
+{
+    DftDouble minValue[3], maxValue[3];
+    for (size_t k = 0; k < iItems.size(); k++)
+    {
+        const TileItem& item = iContext._items[iItems[k]];
+        for (int i = 0; i < 3; i++)
+        {
+            minValue[i] = k == 0 || item._min[i] < minValue[i] ? item._min[i] : minValue[i];
+            maxValue[i] = k == 0 || item._max[i] > maxValue[i] ? item._max[i] : maxValue[i];
+        }
+    }
+    DftDouble radius = 0.0;
+    for (int i = 0; i < 3; i++)
+    {
+        DftDouble half = (maxValue[i] - minValue[i]) * 0.5;
+        oTile._boundingVolume._box._center._data[i] = static_cast<DftFloat>((minValue[i] + maxValue[i]) * 0.5);
+        oTile._boundingVolume._sphere._center._data[i] = oTile._boundingVolume._box._center._data[i];
+        radius += half * half;
+    }
+    oTile._boundingVolume._box._axisX = PDVVector3F(static_cast<DftFloat>((maxValue[0] - minValue[0]) * 0.5), 0.0f, 0.0f);
+    oTile._boundingVolume._box._axisY = PDVVector3F(0.0f, static_cast<DftFloat>((maxValue[1] - minValue[1]) * 0.5), 0.0f);
+    oTile._boundingVolume._box._axisZ = PDVVector3F(0.0f, 0.0f, static_cast<DftFloat>((maxValue[2] - minValue[2]) * 0.5));
+    oTile._boundingVolume._sphere._radius = static_cast<DftFloat>(std::sqrt(radius));
+}
+
+// 写入瓦片内容，几何误差暂存为内容中最大单元的对角线长度，由FinishTiles改写
+void SetTileContent(const TileBuildContext& iContext, const vector<size_t>& iItems, DftUInt64 iNodeID, TileData& oTile,
+    TileBuildStatistics& ioStatistics)
+{
+    oTile._refine = REFINE_TYPE_ADD;
+    oTile._geometricError = 0.0f;
+    if (iItems.empty())
+        return;
+    oTile._content._bitMask = TILE_CONTENT_MASK_RENDER_BODY_FLAG;
+    if (iNodeID != DFT_INVALID_ID)
+    {
+        oTile._content._bitMask |= TILE_CONTENT_MASK_TREE_NODE_FLAG;
+        oTile._content._treeNodeID = iNodeID;
+    }
+    DftUInt64 triangles = 0;
+    DftDouble diagonal = 0.0;
+    for (size_t k = 0; k < iItems.size(); k++)
+    {
+        const TileItem& item = iContext._items[iItems[k]];
+        oTile._content._LodRenderBodyIDs.push_back(item._bodyID);
+        triangles += item._triangles;
+        diagonal = item._diagonal > diagonal ? item._diagonal : diagonal;
+    }
+    oTile._geometricError = static_cast<DftFloat>(diagonal);
+    ioStatistics._maxTileTriangles = triangles > ioStatistics._maxTileTriangles ? triangles : ioStatistics._maxTileTriangles;
+}
+
+/**
+ * 导出时瓦片关联的节点只用于该节点模型中的渲染主体，其余渲染主体放到第一个引用它的节点下。
+ * 选三角面最多的非首个引用节点作为瓦片节点，仍然放不对的单元按节点分到子瓦片中。
+ */
+void AssignTileContent(const TileBuildContext& iContext, const vector<size_t>& iItems, TileData& oTile,
+    TileBuildStatistics& ioStatistics)
+{
+    vector<pair<DftUInt64, DftUInt64> > nodeTriangles;
+    unordered_map<DftUInt64, size_t> nodeLookup;
+    for (size_t k = 0; k < iItems.size(); k++)
+    {
+        const TileItem& item = iContext._items[iItems[k]];
+        if (item._primary)
+            continue;
+        unordered_map<DftUInt64, size_t>::iterator it = nodeLookup.insert(make_pair(item._nodeID, nodeTriangles.size())).first;
+        if (it->second == nodeTriangles.size())
+            nodeTriangles.push_back(pair<DftUInt64, DftUInt64>(item._nodeID, 0));
+        nodeTriangles[it->second].second += item._triangles;
+    }
+    DftUInt64 tileNode = DFT_INVALID_ID;
+    size_t tileModel = 0;
+    DftUInt64 best = 0;
+    for (size_t n = 0; n < nodeTriangles.size(); n++)
+    {
+        if (tileNode == DFT_INVALID_ID || nodeTriangles[n].second > best)
+        {
+            tileNode = nodeTriangles[n].first;
+            best = nodeTriangles[n].second;
+        }
+    }
+
+    vector<size_t> content;
+    vector<pair<DftUInt64, vector<size_t> > > spills;
+    unordered_map<DftUInt64, size_t> spillLookup;
+    for (size_t k = 0; k < iItems.size(); k++)
+    {
+        const TileItem& item = iContext._items[iItems[k]];
+        if (item._nodeID == tileNode)
+            tileModel = item._model;
+    }
+    for (size_t k = 0; k < iItems.size(); k++)
+    {
+        const TileItem& item = iContext._items[iItems[k]];
+        bool inTileModel = false;
+        if (tileNode != DFT_INVALID_ID)
+        {
+            const vector<DftUInt64>& bodies = iContext._modelBodies[tileModel];
+            inTileModel = binary_search(bodies.begin(), bodies.end(), item._bodyID);
+        }
+        if (inTileModel ? item._nodeID == tileNode : item._primary)
+        {
+            content.push_back(iItems[k]);
+            continue;
+        }
+        unordered_map<DftUInt64, size_t>::iterator it = spillLookup.insert(make_pair(item._nodeID, spills.size())).first;
+        if (it->second == spills.size())
+            spills.push_back(make_pair(item._nodeID, vector<size_t>()));
+        spills[it->second].second.push_back(iItems[k]);
+    }
+
+    SetTileContent(iContext, content, tileNode, oTile, ioStatistics);
+    for (size_t s = 0; s < spills.size(); s++)
+    {
+        oTile._children.push_back(TileData());
+        TileData& child = oTile._children.back();
+        SetTileVolume(iContext, spills[s].second, child);
+        SetTileContent(iContext, spills[s].second, spills[s].first, child, ioStatistics);
+        ioStatistics._splitTileCount++;
+    }
+}
+
+/**
+ * 划分一个瓦片：放不进子单元的单元留在本瓦片，其余按单元中心分到八个子单元。
+ * oPending为NULL时递归划分子瓦片，否则只创建子瓦片，子树加入oPending。
+ */
+void PartitionTile(const TileBuildContext& iContext, const vector<size_t>& iItems, const TileCell& iCell, TileData& oTile,
+    vector<PendingTile>* oPending, TileBuildStatistics& ioStatistics)
+{
+    ioStatistics._maxDepth = iCell._depth > ioStatistics._maxDepth ? iCell._depth : ioStatistics._maxDepth;
+    SetTileVolume(iContext, iItems, oTile);
+
+    DftUInt64 triangles = 0;
+    for (size_t k = 0; k < iItems.size(); k++)
+        triangles += iContext._items[iItems[k]]._triangles;
+
+    vector<size_t> content;
+    vector<size_t> octants[8];
+    DftDouble childSize = iCell._size * 0.5;
+    if (triangles <= iContext._options._maxTriangles || iCell._depth >= iContext._options._maxDepth || iItems.size() <= 1)
+    {
+        content = iItems;
+    }
+    else
+    {
+        for (size_t k = 0; k < iItems.size(); k++)
+        {
+            const TileItem& item = iContext._items[iItems[k]];
+            if (item._size > childSize)
+            {
+                content.push_back(iItems[k]);
+                continue;
+            }
+            int octant = 0;
+            for (int i = 0; i < 3; i++)
+            {
+                if ((item._min[i] + item._max[i]) * 0.5 >= iCell._min[i] + childSize)
+                    octant |= 1 << i;
+            }
+            octants[octant].push_back(iItems[k]);
+        }
+    }
+
+    // 按节点分出的子瓦片在前，之后是八叉树子瓦片；子瓦片全部创建后再取地址
+    AssignTileContent(iContext, content, oTile, ioStatistics);
+    size_t first = oTile._children.size();
+    for (int o = 0; o < 8; o++)
+    {
+        if (!octants[o].empty())
+            oTile._children.push_back(TileData());
+    }
+    size_t child = first;
+    for (int o = 0; o < 8; o++)
+    {
+        if (octants[o].empty())
+            continue;
+        TileCell cell;
+        for (int i = 0; i < 3; i++)
+            cell._min[i] = iCell._min[i] + ((o >> i) & 1 ? childSize : 0.0);
+        cell._size = childSize;
+        cell._depth = iCell._depth + 1;
+        if (oPending)
+        {
+            oPending->push_back(PendingTile());
+            oPending->back()._tile = &oTile._children[child];
+            oPending->back()._items.swap(octants[o]);
+            oPending->back()._cell = cell;
+        }
+        else
+        {
+            PartitionTile(iContext, octants[o], cell, oTile._children[child], NULL, ioStatistics);
+        }
+        child++;
+    }
+}
+
+// 按先序编号，几何误差改为子树中（不含本瓦片内容）最大单元的对角线长度；返回包括本瓦片内容在内的最大值
+DftFloat FinishTiles(TileData& ioTile, DftUInt64& ioNextID)
+{
+    ioTile._id = ioNextID++;
+    DftFloat own = ioTile._geometricError;
+    DftFloat children = 0.0f;
+    for (size_t c = 0; c < ioTile._children.size(); c++)
+    {
+        DftFloat error = FinishTiles(ioTile._children[c], ioNextID);
+        children = error > children ? error : children;
+    }
+    ioTile._geometricError = children;
+    return own > children ? own : children;
+}
+
+void MergeStatistics(const TileBuildStatistics& iStatistics, TileBuildStatistics& ioStatistics)
+{
+    ioStatistics._splitTileCount += iStatistics._splitTileCount;
+    ioStatistics._maxTileTriangles = max(ioStatistics._maxTileTriangles, iStatistics._maxTileTriangles);
+    ioStatistics._maxDepth = max(ioStatistics._maxDepth, iStatistics._maxDepth);
+}
+
+} // namespace
+
+bool IsBoxValid(const OrientedBoundingBox& iBox)
+{
+    for (int i = 0; i < 3; i++)
+    {
+        if (iBox._axisX._data[i] != 0.0f || iBox._axisY._data[i] != 0.0f || iBox._axisZ._data[i] != 0.0f)
+            return true;
+    }
+    return false;
+}
+
+void CollectTileNodes(ISceneData* iSceneData, unordered_map<DftUInt64, IModelTreeNode*>& oNodes,
+    unordered_map<DftUInt64, IModelTreeNode*>& oBodyNodes, vector<IModelTreeNode*>* oModelNodes)
+{
+    oNodes.clear();
+    oBodyNodes.clear();
+    if (oModelNodes)
+        oModelNodes->clear();
+    if (!iSceneData)
+        return;
+
+    vector<IModelTree*> modelTreeArray;
+    iSceneData->GetModelTreeArray(modelTreeArray);
+    for (size_t t = 0; t < modelTreeArray.size(); t++)
+    {
+        if (!modelTreeArray[t])
+            continue;
+        vector<IModelTreeNode*> modelTreeNodeArray;
+        modelTreeArray[t]->GetChildrenNodes(modelTreeNodeArray);
+        for (size_t n = 0; n < modelTreeNodeArray.size(); n++)
+        {
+            IModelTreeNode* node = modelTreeNodeArray[n];
+            if (!node)
+                continue;
+            oNodes.insert(make_pair(node->GetID(), node));
+            IModel* model = node->GetModelFlag() ? node->GetModel() : NULL;
+            DftUInt renderBodyCount = model ? model->GetRenderBodyCount() : 0;
+            for (DftUInt i = 0; i < renderBodyCount; i++)
+                oBodyNodes.insert(make_pair(model->GetRenderBodyID(i), node));
+            if (renderBodyCount > 0 && oModelNodes)
+                oModelNodes->push_back(node);
+        }
+    }
+}
+
+DftBool BuildOctreeTiles(ISceneData* iSceneData, const TileBuildOptions& iOptions, TileData& oRoot,
+    TileBuildStatistics* oStatistics)
+{
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    oRoot = TileData();
+    if (!iSceneData)
+        return FALSE;
+
+    // 在当前线程中读取所有单元的包围盒和三角面数，同一渲染主体的面数只统计一次
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_TRAVERSAL);
+    TileBuildContext context;
+    context._options = iOptions;
+    CSceneIndex sceneIndex(iSceneData);
+    unordered_map<DftUInt64, IModelTreeNode*> nodes, bodyNodes;
+    vector<IModelTreeNode*> modelNodes;
+    CollectTileNodes(iSceneData, nodes, bodyNodes, &modelNodes);
+
+    unordered_map<IModel*, size_t> models;
+    unordered_map<DftUInt64, DftUInt64> bodyTriangles;
+    TileBuildStatistics statistics;
+    for (size_t n = 0; n < modelNodes.size(); n++)
+    {
+        IModelTreeNode* node = modelNodes[n];
+        IModel* model = node->GetModel();
+        PDVMatrix4F worldTrans;
+        if (node->GetWorldTransform(worldTrans) != PDV_RESULT_NO_ERROR)
+            worldTrans.SetIdentity();
+
+        unordered_map<IModel*, size_t>::iterator found = models.find(model);
+        if (found == models.end())
+        {
+            found = models.insert(make_pair(model, context._modelBodies.size())).first;
+            context._modelBodies.push_back(vector<DftUInt64>());
+            for (DftUInt i = 0; i < model->GetRenderBodyCount(); i++)
+                context._modelBodies.back().push_back(model->GetRenderBodyID(i));
+            sort(context._modelBodies.back().begin(), context._modelBodies.back().end());
+        }
+
+        for (DftUInt i = 0; i < model->GetRenderBodyCount(); i++)
+        {
+            IRenderBody* renderBody = sceneIndex.FindRenderBody(model->GetRenderBodyID(i));
+            TileItem item;
+            if (!renderBody || !GetBodyBounds(sceneIndex, renderBody, model, worldTrans, item._min, item._max))
+                continue;
+            item._bodyID = renderBody->GetID();
+            item._nodeID = node->GetID();
+            item._model = found->second;
+            item._primary = bodyNodes[item._bodyID] == node;
+
+            unordered_map<DftUInt64, DftUInt64>::iterator triangles = bodyTriangles.find(item._bodyID);
+            if (triangles == bodyTriangles.end())
+                triangles = bodyTriangles.insert(make_pair(item._bodyID, GetBodyTriangleCount(sceneIndex, renderBody))).first;
+            item._triangles = triangles->second;
+            item._size = 0.0;
+            DftDouble diagonal = 0.0;
+            for (int a = 0; a < 3; a++)
+            {
+                DftDouble extent = item._max[a] - item._min[a];
+                item._size = extent > item._size ? extent : item._size;
+                diagonal += extent * extent;
+            }
+            item._diagonal = std::sqrt(diagonal);
+            context._items.push_back(item);
+            statistics._triangleCount += item._triangles;
+        }
+    }
+    if (context._items.empty())
+        return FALSE;
+    statistics._itemCount = context._items.size();
+
+    // 根单元为包住所有单元的立方体
+    TileCell root;
+    vector<size_t> items(context._items.size());
+    DftDouble maxValue[3];
+    for (size_t k = 0; k < items.size(); k++)
+    {
+        items[k] = k;
+        const TileItem& item = context._items[k];
+        for (int i = 0; i < 3; i++)
+        {
+            root._min[i] = k == 0 || item._min[i] < root._min[i] ? item._min[i] : root._min[i];
+            maxValue[i] = k == 0 || item._max[i] > maxValue[i] ? item._max[i] : maxValue[i];
+        }
+    }
+    root._size = 0.0;
+    for (int i = 0; i < 3; i++)
+        root._size = maxValue[i] - root._min[i] > root._size ? maxValue[i] - root._min[i] : root._size;
+    root._size = root._size > 0.0 ? root._size : 1.0;
+    root._depth = 0;
+
+    // 逐层展开到待划分的子树足够多，再在线程池中并行划分；逐层展开与递归划分的结果相同
+    DftUInt threadCount = CThreadPool::ResolveThreadCount(iOptions._threadCount);
+    if (threadCount <= 1)
+    {
+        PartitionTile(context, items, root, oRoot, NULL, statistics);
+    }
+    else
+    {
+        vector<PendingTile> pending(1);
+        pending[0]._tile = &oRoot;
+        pending[0]._items.swap(items);
+        pending[0]._cell = root;
+        while (!pending.empty() && pending.size() < static_cast<size_t>(threadCount) * 4)
+        {
+            vector<PendingTile> next;
+            for (size_t p = 0; p < pending.size(); p++)
+                PartitionTile(context, pending[p]._items, pending[p]._cell, *pending[p]._tile, &next, statistics);
+            pending.swap(next);
+        }
+
+        CThreadPool pool(threadCount);
+        for (size_t p = 0; p < pending.size(); p++)
+        {
+            pool.Submit([&, p]() {
+                PartitionTile(context, pending[p]._items, pending[p]._cell, *pending[p]._tile, NULL, pending[p]._statistics);
+            });
+        }
+        pool.Wait();
+        for (size_t p = 0; p < pending.size(); p++)
+            MergeStatistics(pending[p]._statistics, statistics);
+    }
+
+    DftUInt64 nextID = 0;
+    FinishTiles(oRoot, nextID);
+    statistics._tileCount = nextID;
+    statistics._seconds = chrono::duration<DftDouble>(chrono::steady_clock::now() - start).count();
+    if (oStatistics)
+        *oStatistics = statistics;
+    return TRUE;
+}
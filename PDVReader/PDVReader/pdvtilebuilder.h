@@ -0,0 +1,89 @@
+/**
+ * @file pdvtilebuilder.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：按八叉树把渲染主体划分为瓦片层级
+ * @details 与ISceneData::BuildTileSet不同，瓦片的三角面数上限和最大深度可以配置。每个节点下的每个渲染主体是一个划分单元，
+ *          外包区域取IRenderBody::GetBox，无效时取其面网格的包围盒，再无效时取IModel::GetBoundingVolume，经节点世界变换得到
+ *          场景坐标系中的轴对齐包围盒；三角面数取IRenderBody::GetStatistics，为0时按面网格的渲染几何统计。
+ *          单元总面数超过上限的瓦片按立方体单元分为八个子单元，按单元中心分配；放不进子单元的大单元留在本瓦片（松散八叉树），
+ *          所有瓦片的细化方式为ADD，几何误差为子瓦片中最大单元的对角线长度，即不细化时缺少的最大物体尺寸。
+ *          TileContent只能关联一个模型树节点，按ExportSceneTiles的规则无法放到正确节点的单元（同一渲染主体被多个节点引用时）
+ *          移到按节点分出的子瓦片中，这部分计入父瓦片的几何误差。
+ *          划分先在当前线程中逐层展开，待划分的子树足够多时在线程池中并行划分，结果与线程数无关。
+ */
+
+#ifndef PDVTILEBUILDER_H
+#define PDVTILEBUILDER_H
+
+#include "DftBase.h"
+#include <unordered_map>
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+class ISceneData;
+class IModelTreeNode;
+struct TileData;
+struct OrientedBoundingBox;
+} // namespace pdv
+} // namespace kernel
+
+/** @brief 瓦片划分参数 */
+struct TileBuildOptions
+{
+    DftUInt64 _maxTriangles;  ///< 每个瓦片（含子瓦片）三角面数超过此值时继续划分
+    DftUInt _maxDepth;        ///< 最大深度，根瓦片为0
+    DftUInt _threadCount;     ///< 划分线程数，为0时取CPU逻辑核数
+
+    TileBuildOptions() : _maxTriangles(200000), _maxDepth(10), _threadCount(0) {}
+};
+
+/** @brief 瓦片划分统计 */
+struct TileBuildStatistics
+{
+    DftUInt64 _itemCount;         ///< 划分单元数，即节点与渲染主体的组合数
+    DftUInt64 _triangleCount;     ///< 三角面总数
+    DftUInt64 _tileCount;         ///< 瓦片数
+    DftUInt64 _splitTileCount;    ///< 按节点分出的子瓦片数
+    DftUInt64 _maxTileTriangles;  ///< 单个瓦片内容的最大三角面数
+    DftUInt _maxDepth;            ///< 实际最大深度
+    DftDouble _seconds;           ///< 总耗时
+
+    TileBuildStatistics()
+        : _itemCount(0), _triangleCount(0), _tileCount(0), _splitTileCount(0), _maxTileTriangles(0), _maxDepth(0), _seconds(0.0) {}
+};
+
+/**
+ * @brief 有向包围盒是否有效，三个半轴全为0时视为未设置
+ * @return bool 是否有效
+ * @param[in] iBox 有向包围盒
+ */
+bool IsBoxValid(const kernel::pdv::OrientedBoundingBox& iBox);
+
+/**
+ * @brief 建立节点ID到模型树节点、渲染主体ID到第一个引用它的节点（按模型树遍历顺序）的索引
+ * @param[in] iSceneData 场景数据
+ * @param[out] oNodes 所有模型树节点
+ * @param[out] oBodyNodes 渲染主体所在的第一个关联模型的节点
+ * @param[out] oModelNodes 按遍历顺序排列的关联模型的节点，可为NULL
+ */
+void CollectTileNodes(kernel::pdv::ISceneData* iSceneData,
+    std::unordered_map<DftUInt64, kernel::pdv::IModelTreeNode*>& oNodes,
+    std::unordered_map<DftUInt64, kernel::pdv::IModelTreeNode*>& oBodyNodes,
+    std::vector<kernel::pdv::IModelTreeNode*>* oModelNodes = NULL);
+
+/**
+ * @brief 按八叉树划分场景中的渲染主体，生成瓦片层级
+ * @return DftBool 场景中没有带外包区域的渲染主体时为FALSE
+ * @param[in] iSceneData 场景数据
+ * @param[in] iOptions 划分参数
+ * @param[out] oRoot 根瓦片，瓦片ID按先序从0编号
+ * @param[out] oStatistics 划分统计，可为NULL
+ */
+DftBool BuildOctreeTiles(kernel::pdv::ISceneData* iSceneData, const TileBuildOptions& iOptions, kernel::pdv::TileData& oRoot,
+    TileBuildStatistics* oStatistics = NULL);
+
+#endif
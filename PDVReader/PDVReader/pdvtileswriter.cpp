@@ -0,0 +1,556 @@
+#include "pdvtileswriter.h"
+#include "pdvfilewriter.h"
+#include "pdvgeometrycache.h"
+#include "pdvgltfwriter.h"
+#include "pdvlod.h"
+#include "pdvprofiler.h"
+#include "pdvsceneindex.h"
+#include "pdvthreadpool.h"
+#include "pdvtilebuilder.h"
+#include "pdvtransform.h"
+#include "PDVISceneData.h"
+#include "PDVITileSet.h"
+#include "PDVIModelTree.h"
+#include "PDVIModelTreeNode.h"
+#include "PDVIModel.h"
+#include "PDVIRenderBody.h"
+#include "PDVIRenderMesh.h"
+#include "PDVIRenderGeometry.h"
+#include "PDVIRenderVertex.h"
+#include "DftJson.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <cerrno>
+#include <sys/stat.h>
+#endif
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+#ifdef _WIN32
+const char PATH_SEPARATOR = '\\';
+#else
+const char PATH_SEPARATOR = '/';
+#endif
+
+const size_t TILES_NONE = static_cast<size_t>(-1);
+
+/** 瓦片引用的一个渲染主体，同一渲染主体放在不同节点下时视为不同的主体 */
+struct TileBody
+{
+    DftUInt64 _bodyID;                    ///< 渲染主体ID
+    PDVMatrix4F _worldTrans;              ///< 所属节点的世界变换
+    string _name;                         ///< 渲染主体名称
+    vector<LodMeshSelection> _meshes;     ///< 主体网格及其渲染几何
+    size_t _firstTile;                    ///< 第一个引用它的瓦片
+    size_t _lastTile;                     ///< 最近一个引用它的瓦片，用于同一瓦片内去重
+    DftUInt _tileCount;                   ///< 引用它的瓦片数
+    size_t _content;                      ///< 单独存放时的内容文件
+
+    TileBody() : _bodyID(DFT_INVALID_ID), _firstTile(0), _lastTile(TILES_NONE), _tileCount(0), _content(TILES_NONE) {}
+};
+
+/** 一个GLB内容文件及其编码结果 */
+struct TileContentFile
+{
+    string _uri;                ///< 相对tileset.json的路径
+    vector<size_t> _bodies;     ///< 包含的渲染主体
+    DftFloat _origin[3];        ///< 局部原点
+
+    bool _success;              ///< 是否写出成功
+    DftUInt64 _bytes;           ///< 文件长度
+    DftUInt64 _triangles;       ///< 三角面数
+    bool _hasBounds;            ///< 是否有顶点
+    DftDouble _min[3];          ///< 场景坐标系中的最小值
+    DftDouble _max[3];          ///< 场景坐标系中的最大值
+
+    TileContentFile() : _success(false), _bytes(0), _triangles(0), _hasBounds(false)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            _origin[i] = 0.0f;
+            _min[i] = _max[i] = 0.0;
+        }
+    }
+};
+
+/** 按先序展开的瓦片，子瓦片的序号总是大于父瓦片 */
+struct FlatTile
+{
+    const TileData* _data;      ///< 瓦片数据
+    vector<size_t> _children;   ///< 子瓦片
+    vector<size_t> _bodies;     ///< 引用的渲染主体
+    vector<size_t> _contents;   ///< 内容文件，自己的内容在前，共享的渲染主体在后
+    bool _hasBounds;            ///< 是否有轴对齐包围盒
+    DftDouble _min[3];          ///< 外包区域的轴对齐包围盒最小值
+    DftDouble _max[3];          ///< 外包区域的轴对齐包围盒最大值
+
+    FlatTile() : _data(NULL), _hasBounds(false)
+    {
+        for (int i = 0; i < 3; i++)
+            _min[i] = _max[i] = 0.0;
+    }
+};
+
+DftBool MakeDirectory(const string& iPath)
+{
+#ifdef _WIN32
+    return CreateDirectoryA(iPath.c_str(), NULL) || GetLastError() == ERROR_ALREADY_EXISTS ? TRUE : FALSE;
+#else
+    return mkdir(iPath.c_str(), 0755) == 0 || errno == EEXIST ? TRUE : FALSE;
+#endif
+}
+
+void ExpandBounds(bool& ioHasBounds, DftDouble ioMin[3], DftDouble ioMax[3], const DftDouble iMin[3], const DftDouble iMax[3])
+{
+    for (int i = 0; i < 3; i++)
+    {
+        ioMin[i] = !ioHasBounds || iMin[i] < ioMin[i] ? iMin[i] : ioMin[i];
+        ioMax[i] = !ioHasBounds || iMax[i] > ioMax[i] ? iMax[i] : ioMax[i];
+    }
+    ioHasBounds = true;
+}
+
+// 瓦片数据中的外包区域，都无效时返回false
+bool GetVolumeBounds(const BoundingVolume& iVolume, DftDouble oMin[3], DftDouble oMax[3])
+{
+    const OrientedBoundingBox& box = iVolume._box;
+    if (IsBoxValid(box))
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            DftDouble extent = std::fabs(box._axisX._data[i]) + std::fabs(box._axisY._data[i]) + std::fabs(box._axisZ._data[i]);
+            oMin[i] = box._center._data[i] - extent;
+            oMax[i] = box._center._data[i] + extent;
+        }
+        return true;
+    }
+    if (iVolume._sphere._radius > 0.0f)
+    {
+        for (int i = 0; i < 3; i++)
+        {
+            oMin[i] = iVolume._sphere._center._data[i] - iVolume._sphere._radius;
+            oMax[i] = iVolume._sphere._center._data[i] + iVolume._sphere._radius;
+        }
+        return true;
+    }
+    return false;
+}
+
+size_t FlattenTiles(const TileData& iTile, vector<FlatTile>& ioTiles)
+{
+    size_t index = ioTiles.size();
+    ioTiles.push_back(FlatTile());
+    ioTiles[index]._data = &iTile;
+    for (size_t c = 0; c < iTile._children.size(); c++)
+    {
+        size_t child = FlattenTiles(iTile._children[c], ioTiles);
+        ioTiles[index]._children.push_back(child);
+    }
+    return index;
+}
+
+// 变换并写出一个内容文件，渲染几何数据经缓存获取，未命中时在iSceneMutex内串行读取
+void EncodeTileContent(const vector<TileBody>& iBodies, const string& iPath, CGeometryCache& ioCache, mutex& iSceneMutex,
+    TileContentFile& ioContent)
+{
+    static thread_local TransformedVertexes worldVertexes;
+
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_SERIALIZE);
+    vector<GlbMesh> meshes(ioContent._bodies.size());
+    for (size_t b = 0; b < ioContent._bodies.size(); b++)
+    {
+        const TileBody& body = iBodies[ioContent._bodies[b]];
+        GlbMesh& mesh = meshes[b];
+        mesh._name = body._name;
+
+        // 在float矩阵中减去局部原点，变换结果只保留相对坐标
+        PDVMatrix4F matrix = body._worldTrans;
+        for (int i = 0; i < 3; i++)
+            matrix._data[3][i] -= ioContent._origin[i];
+
+        bool hasNormals = true;
+        for (size_t m = 0; m < body._meshes.size(); m++)
+        {
+            CachedGeometryPtr geometry = ioCache.Get(body._meshes[m]._geometry, body._meshes[m]._vertex, &iSceneMutex);
+            if (!geometry || geometry->_positions.empty() || geometry->_indexes.empty())
+                continue;
+            TransformVertexes(geometry->GetPositions(), geometry->GetNormals(), matrix, worldVertexes);
+
+            DftUInt base = static_cast<DftUInt>(mesh._positions.size() / 3);
+            hasNormals = hasNormals && geometry->_normals.size() == geometry->_positions.size();
+            for (DftUInt v = 0; v < worldVertexes._count; v++)
+            {
+                const DftFloat* position = worldVertexes.Position(v);
+                mesh._positions.insert(mesh._positions.end(), position, position + 3);
+                if (hasNormals)
+                {
+                    const DftFloat* normal = worldVertexes.Normal(v);
+                    mesh._normals.insert(mesh._normals.end(), normal, normal + 3);
+                }
+                DftDouble world[3];
+                for (int i = 0; i < 3; i++)
+                    world[i] = static_cast<DftDouble>(position[i]) + ioContent._origin[i];
+                ExpandBounds(ioContent._hasBounds, ioContent._min, ioContent._max, world, world);
+            }
+            for (size_t i = 0; i < geometry->_indexes.size(); i++)
+                mesh._indexes.push_back(base + geometry->_indexes[i]);
+            ioContent._triangles += geometry->_indexes.size() / 3;
+        }
+        // 有一个网格不带法向时整个渲染主体都不输出法向
+        if (!hasNormals)
+            mesh._normals.clear();
+    }
+
+    // 场景Z轴向上，glTF Y轴向上：(x, y, z) -> (x, z, -y)，再平移到局部原点
+    DftDouble rootMatrix[16] = {
+        1.0, 0.0, 0.0, 0.0,
+        0.0, 0.0, -1.0, 0.0,
+        0.0, 1.0, 0.0, 0.0,
+        ioContent._origin[0], ioContent._origin[2], -static_cast<DftDouble>(ioContent._origin[1]), 1.0 };
+    ioContent._success = WriteGlbMeshes(meshes, rootMatrix, iPath, &ioContent._bytes) ? true : false;
+    PDV_PROFILE_COUNT(PROFILE_COUNTER_TRIANGLES, ioContent._triangles);
+}
+
+DftJson CreateNumberArray(const DftDouble* iValues, size_t iCount)
+{
+    DftJson array = DftJsonCreateArray();
+    for (size_t i = 0; i < iCount; i++)
+        DftJsonAddItemToArray(array, DftJsonCreateNumber(std::isfinite(iValues[i]) ? iValues[i] : 0.0));
+    return array;
+}
+
+DftJson BuildTileJson(const vector<FlatTile>& iTiles, const vector<TileContentFile>& iContents, size_t iIndex)
+{
+    const FlatTile& tile = iTiles[iIndex];
+    const TileData& data = *tile._data;
+    DftJson json = DftJsonCreateObject();
+
+    // 3D Tiles的box为中心和三个半轴，与OrientedBoundingBox的定义相同
+    DftJson volume = DftJsonAddObjectToObject(json, "boundingVolume");
+    const OrientedBoundingBox& box = data._boundingVolume._box;
+    if (IsBoxValid(box))
+    {
+        const PDVVector3F* vectors[4] = { &box._center, &box._axisX, &box._axisY, &box._axisZ };
+        DftDouble values[12];
+        for (int v = 0; v < 4; v++)
+        {
+            for (int i = 0; i < 3; i++)
+                values[v * 3 + i] = vectors[v]->_data[i];
+        }
+        DftJsonAddItemToObject(volume, "box", CreateNumberArray(values, 12));
+    }
+    else if (data._boundingVolume._sphere._radius > 0.0f)
+    {
+        const BoundingSphere& sphere = data._boundingVolume._sphere;
+        DftDouble values[4] = { sphere._center._data[0], sphere._center._data[1], sphere._center._data[2], sphere._radius };
+        DftJsonAddItemToObject(volume, "sphere", CreateNumberArray(values, 4));
+    }
+    else
+    {
+        DftDouble values[12] = { 0.0 };
+        if (tile._hasBounds)
+        {
+            for (int i = 0; i < 3; i++)
+            {
+                values[i] = (tile._min[i] + tile._max[i]) * 0.5;
+                values[3 + i * 4] = (tile._max[i] - tile._min[i]) * 0.5;
+            }
+        }
+        DftJsonAddItemToObject(volume, "box", CreateNumberArray(values, 12));
+    }
+
+    DftJsonAddNumberToObject(json, "geometricError", data._geometricError);
+    if (data._refine == REFINE_TYPE_ADD)
+        DftJsonAddStringToObject(json, "refine", "ADD");
+    else if (data._refine == REFINE_TYPE_REPLACE || iIndex == 0)
+        DftJsonAddStringToObject(json, "refine", "REPLACE");
+
+    if (tile._contents.size() == 1)
+    {
+        DftJson content = DftJsonAddObjectToObject(json, "content");
+        DftJsonAddStringToObject(content, "uri", iContents[tile._contents[0]]._uri.c_str());
+    }
+    else if (tile._contents.size() > 1)
+    {
+        DftJson contents = DftJsonAddArrayToObject(json, "contents");
+        for (size_t c = 0; c < tile._contents.size(); c++)
+        {
+            DftJson content = DftJsonCreateObject();
+            DftJsonAddStringToObject(content, "uri", iContents[tile._contents[c]]._uri.c_str());
+            DftJsonAddItemToArray(contents, content);
+        }
+    }
+
+    if (!tile._children.empty())
+    {
+        DftJson children = DftJsonAddArrayToObject(json, "children");
+        for (size_t c = 0; c < tile._children.size(); c++)
+            DftJsonAddItemToArray(children, BuildTileJson(iTiles, iContents, tile._children[c]));
+    }
+    return json;
+}
+
+} // namespace
+
+DftBool ExportSceneTiles(ISceneData* iSceneData, const string& iOutputDir, DftUInt iThreadCount, CGeometryCache* ioCache,
+    TilesStatistics* oStatistics, const TileData* iRoot)
+{
+    if (!iSceneData)
+        return FALSE;
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+    // 瓦片集的几何误差不小于根瓦片；使用传入的根瓦片时取根瓦片外包区域的对角线长度
+    TileData sceneRoot;
+    DftFloat geometricError = 0.0f;
+    if (iRoot)
+    {
+        DftDouble minValue[3], maxValue[3], diagonal = 0.0;
+        if (GetVolumeBounds(iRoot->_boundingVolume, minValue, maxValue))
+        {
+            for (int i = 0; i < 3; i++)
+                diagonal += (maxValue[i] - minValue[i]) * (maxValue[i] - minValue[i]);
+        }
+        geometricError = static_cast<DftFloat>(std::sqrt(diagonal));
+    }
+    else
+    {
+        ITileSet* tileSet = iSceneData->GetTileSet();
+        if (!tileSet && iSceneData->BuildTileSet() == PDV_RESULT_NO_ERROR)
+            tileSet = iSceneData->GetTileSet();
+        if (!tileSet || tileSet->GetTileData(sceneRoot) != PDV_RESULT_NO_ERROR)
+            return FALSE;
+        geometricError = tileSet->GetGeometricError();
+    }
+    const TileData& root = iRoot ? *iRoot : sceneRoot;
+    geometricError = geometricError > root._geometricError ? geometricError : root._geometricError;
+    if (!MakeDirectory(iOutputDir))
+        return FALSE;
+
+    vector<FlatTile> tiles;
+    FlattenTiles(root, tiles);
+
+    CSceneIndex sceneIndex(iSceneData);
+    unordered_map<DftUInt64, IModelTreeNode*> nodes;
+    unordered_map<DftUInt64, IModelTreeNode*> bodyNodes;
+    CollectTileNodes(iSceneData, nodes, bodyNodes);
+
+    // 收集各瓦片引用的渲染主体；瓦片关联了节点时，该节点模型中的渲染主体和不属于任何节点的渲染主体（如LOD渲染主体）
+    // 按该节点放置，其余按第一个引用该渲染主体的节点放置
+    vector<TileBody> bodies;
+    map<pair<DftUInt64, DftUInt64>, size_t> bodyLookup;
+    vector<DftUInt64> bodyIDs, tileBodyIDs, faceMeshIDs;
+    for (size_t t = 0; t < tiles.size(); t++)
+    {
+        const TileContent& content = tiles[t]._data->_content;
+        bodyIDs = content._LodRenderBodyIDs;
+        for (size_t e = 0; e < content._envelopes.size(); e++)
+            bodyIDs.push_back(content._envelopes[e]._renderBodyID);
+
+        IModelTreeNode* tileNode = NULL;
+        tileBodyIDs.clear();
+        if (content._bitMask & TILE_CONTENT_MASK_TREE_NODE_FLAG)
+        {
+            unordered_map<DftUInt64, IModelTreeNode*>::const_iterator it = nodes.find(content._treeNodeID);
+            tileNode = it != nodes.end() ? it->second : NULL;
+            IModel* model = tileNode && tileNode->GetModelFlag() ? tileNode->GetModel() : NULL;
+            DftUInt renderBodyCount = model ? model->GetRenderBodyCount() : 0;
+            for (DftUInt i = 0; i < renderBodyCount; i++)
+                tileBodyIDs.push_back(model->GetRenderBodyID(i));
+        }
+        for (size_t b = 0; b < bodyIDs.size(); b++)
+        {
+            IRenderBody* renderBody = bodyIDs[b] != DFT_INVALID_ID ? sceneIndex.FindRenderBody(bodyIDs[b]) : NULL;
+            if (!renderBody)
+                continue;
+            unordered_map<DftUInt64, IModelTreeNode*>::const_iterator it = bodyNodes.find(bodyIDs[b]);
+            IModelTreeNode* node = it != bodyNodes.end() ? it->second : NULL;
+            if (tileNode && (!node || find(tileBodyIDs.begin(), tileBodyIDs.end(), bodyIDs[b]) != tileBodyIDs.end()))
+                node = tileNode;
+            pair<DftUInt64, DftUInt64> key(bodyIDs[b], node ? node->GetID() : DFT_INVALID_ID);
+            map<pair<DftUInt64, DftUInt64>, size_t>::iterator found = bodyLookup.find(key);
+            if (found == bodyLookup.end())
+            {
+                found = bodyLookup.insert(make_pair(key, bodies.size())).first;
+                bodies.push_back(TileBody());
+                TileBody& body = bodies.back();
+                body._bodyID = bodyIDs[b];
+                body._firstTile = t;
+                if (!node || node->GetWorldTransform(body._worldTrans) != PDV_RESULT_NO_ERROR)
+                    body._worldTrans.SetIdentity();
+                CUnicodeString name;
+                renderBody->GetName(name);
+                body._name = name.ToMultiByte();
+                if (body._name.empty())
+                    body._name = "RenderBody_" + to_string(bodyIDs[b]);
+                renderBody->GetFaceMeshIDs(faceMeshIDs);
+                for (size_t m = 0; m < faceMeshIDs.size(); m++)
+                {
+                    LodMeshSelection selection;
+                    selection._mesh = sceneIndex.FindRenderMesh(faceMeshIDs[m]);
+                    if (!selection._mesh || selection._mesh->GetType() != RENDER_MESH_TYPE_MAIN)
+                        continue;
+                    selection._geometry = SelectMeshGeometry(sceneIndex, selection._mesh, NULL);
+                    selection._vertex = selection._geometry ? sceneIndex.FindRenderVertex(selection._geometry->GetVertexID()) : NULL;
+                    if (selection._vertex)
+                        body._meshes.push_back(selection);
+                }
+            }
+            TileBody& body = bodies[found->second];
+            if (body._lastTile == t)
+                continue;
+            body._lastTile = t;
+            body._tileCount++;
+            tiles[t]._bodies.push_back(found->second);
+        }
+    }
+
+    // 只被一个瓦片引用的渲染主体写入瓦片自己的内容文件，其余的各自单独存放，局部原点取首个引用瓦片的外包盒中心
+    vector<TileContentFile> contents;
+    size_t sharedCount = 0;
+    bool hasTiles = false;
+    for (size_t t = 0; t < tiles.size(); t++)
+    {
+        const BoundingVolume& volume = tiles[t]._data->_boundingVolume;
+        const PDVVector3F& center = IsBoxValid(volume._box) ? volume._box._center : volume._sphere._center;
+        TileContentFile own;
+        for (size_t b = 0; b < tiles[t]._bodies.size(); b++)
+        {
+            TileBody& body = bodies[tiles[t]._bodies[b]];
+            if (body._tileCount == 1)
+            {
+                own._bodies.push_back(tiles[t]._bodies[b]);
+                continue;
+            }
+            if (body._content == TILES_NONE)
+            {
+                body._content = contents.size();
+                contents.push_back(TileContentFile());
+                contents.back()._uri = "bodies/" + to_string(sharedCount++) + ".glb";
+                contents.back()._bodies.push_back(tiles[t]._bodies[b]);
+                for (int i = 0; i < 3; i++)
+                    contents.back()._origin[i] = center._data[i];
+            }
+        }
+        if (!own._bodies.empty())
+        {
+            own._uri = "tiles/" + to_string(t) + ".glb";
+            for (int i = 0; i < 3; i++)
+                own._origin[i] = center._data[i];
+            tiles[t]._contents.push_back(contents.size());
+            contents.push_back(own);
+            hasTiles = true;
+        }
+        for (size_t b = 0; b < tiles[t]._bodies.size(); b++)
+        {
+            const TileBody& body = bodies[tiles[t]._bodies[b]];
+            if (body._tileCount > 1)
+                tiles[t]._contents.push_back(body._content);
+        }
+    }
+    if ((hasTiles && !MakeDirectory(iOutputDir + PATH_SEPARATOR + "tiles")) ||
+        (sharedCount > 0 && !MakeDirectory(iOutputDir + PATH_SEPARATOR + "bodies")))
+        return FALSE;
+
+    // 各内容文件互不依赖，在线程池中并行编码并直接写出
+    CGeometryCache localCache;
+    CGeometryCache& cache = ioCache ? *ioCache : localCache;
+    mutex sceneMutex;
+    vector<string> paths(contents.size());
+    for (size_t c = 0; c < contents.size(); c++)
+    {
+        paths[c] = contents[c]._uri;
+        for (size_t i = 0; i < paths[c].size(); i++)
+            paths[c][i] = paths[c][i] == '/' ? PATH_SEPARATOR : paths[c][i];
+        paths[c] = iOutputDir + PATH_SEPARATOR + paths[c];
+    }
+    DftUInt threadCount = CThreadPool::ResolveThreadCount(iThreadCount);
+    if (threadCount <= 1 || contents.size() <= 1)
+    {
+        for (size_t c = 0; c < contents.size(); c++)
+            EncodeTileContent(bodies, paths[c], cache, sceneMutex, contents[c]);
+    }
+    else
+    {
+        CThreadPool pool(threadCount);
+        for (size_t c = 0; c < contents.size(); c++)
+        {
+            pool.Submit([&, c]() {
+                EncodeTileContent(bodies, paths[c], cache, sceneMutex, contents[c]);
+            });
+        }
+        pool.Wait();
+    }
+
+    TilesStatistics statistics;
+    DftBool success = TRUE;
+    for (size_t c = 0; c < contents.size(); c++)
+    {
+        success = contents[c]._success ? success : FALSE;
+        statistics._bytes += contents[c]._bytes;
+        statistics._triangleCount += contents[c]._triangles;
+        statistics._bodyCount += contents[c]._bodies.size();
+    }
+    statistics._sharedBodyCount = sharedCount;
+
+    // 由子瓦片向上合并轴对齐包围盒，用于没有有效外包区域的瓦片
+    for (size_t t = tiles.size(); t-- > 0;)
+    {
+        FlatTile& tile = tiles[t];
+        for (size_t c = 0; c < tile._contents.size(); c++)
+        {
+            const TileContentFile& content = contents[tile._contents[c]];
+            if (content._hasBounds)
+                ExpandBounds(tile._hasBounds, tile._min, tile._max, content._min, content._max);
+        }
+        for (size_t c = 0; c < tile._children.size(); c++)
+        {
+            const FlatTile& child = tiles[tile._children[c]];
+            DftDouble minValue[3], maxValue[3];
+            if (GetVolumeBounds(child._data->_boundingVolume, minValue, maxValue))
+                ExpandBounds(tile._hasBounds, tile._min, tile._max, minValue, maxValue);
+            else if (child._hasBounds)
+                ExpandBounds(tile._hasBounds, tile._min, tile._max, child._min, child._max);
+        }
+    }
+
+    DftJson json = DftJsonCreateObject();
+    DftJson asset = DftJsonAddObjectToObject(json, "asset");
+    DftJsonAddStringToObject(asset, "version", "1.1");
+    DftJsonAddStringToObject(asset, "generator", "PDVReader");
+    DftJsonAddNumberToObject(json, "geometricError", geometricError);
+    DftJsonAddItemToObject(json, "root", BuildTileJson(tiles, contents, 0));
+    DftUTF8Char* text = DftJsonPrint(json);
+    CBufferedFileWriter writer;
+    if (text && writer.Open(iOutputDir + PATH_SEPARATOR + "tileset.json"))
+    {
+        writer.Write(text, strlen(text));
+        statistics._bytes += writer.GetBytesWritten();
+        success = writer.Close() ? success : FALSE;
+    }
+    else
+    {
+        success = FALSE;
+    }
+    // DftBase没有提供释放DftJsonPrint结果的接口
+    DftJsonDelete(&json);
+
+    statistics._tileCount = tiles.size();
+    statistics._contentCount = contents.size();
+    statistics._seconds = chrono::duration<DftDouble>(chrono::steady_clock::now() - start).count();
+    if (oStatistics)
+        *oStatistics = statistics;
+    return success;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file pdvtileswriter.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：按场景的瓦片集（ITileSet）输出3D Tiles
+ * @details 瓦片层级、外包区域、几何误差和细化方式取自TileData，输出tileset.json（3D Tiles 1.1）和GLB内容文件。
+ *          瓦片引用的渲染主体包括LOD渲染主体和包络的渲染主体；只被一个瓦片引用的渲染主体写入该瓦片自己的tiles/<序号>.glb，
+ *          被多个瓦片引用的渲染主体只写一次，单独存为bodies/<序号>.glb，各瓦片通过contents同时引用。
+ *          渲染主体按所属节点的世界变换放到场景坐标系，再减去内容文件的局部原点（首个引用瓦片的外包盒中心）以保留float精度，
+ *          局部原点和场景Z轴向上到glTF Y轴向上的旋转写在GLB根节点矩阵中，因此外包区域可以直接使用场景坐标。
+ *          内容文件在线程池中并行编码并写出，渲染几何数据经缓存在锁内读取；tileset.json在所有内容写完后写出。
+ */
+
+#ifndef PDVTILESWRITER_H
+#define PDVTILESWRITER_H
+
+#include "DftBase.h"
+#include <string>
+
+namespace kernel
+{
+namespace pdv
+{
+class ISceneData;
+struct TileData;
+} // namespace pdv
+} // namespace kernel
+
+class CGeometryCache;
+
+/** @brief 3D Tiles导出统计 */
+struct TilesStatistics
+{
+    DftUInt64 _tileCount;        ///< 瓦片数
+    DftUInt64 _contentCount;     ///< 写出的GLB内容文件数
+    DftUInt64 _bodyCount;        ///< 写出的渲染主体数
+    DftUInt64 _sharedBodyCount;  ///< 其中被多个瓦片引用、单独存放的渲染主体数
+    DftUInt64 _triangleCount;    ///< 三角面总数
+    DftUInt64 _bytes;            ///< 内容文件和tileset.json的总长度
+    DftDouble _seconds;          ///< 总耗时
+
+    TilesStatistics()
+        : _tileCount(0), _contentCount(0), _bodyCount(0), _sharedBodyCount(0), _triangleCount(0), _bytes(0), _seconds(0.0) {}
+};
+
+/**
+ * @brief 将场景输出为3D Tiles
+ * @return DftBool 是否成功，场景没有瓦片集且无法生成、目录无法创建或任一文件写出失败时为FALSE
+ * @param[in] iSceneData 场景数据，没有传入根瓦片且没有瓦片集时调用BuildTileSet生成
+ * @param[in] iOutputDir 输出目录，其中写出tileset.json、tiles和bodies子目录
+ * @param[in] iThreadCount 编码线程数，为0时取CPU逻辑核数，为1时在当前线程中执行；输出与线程数无关
+ * @param[in,out] ioCache 渲染几何缓存，为NULL时使用默认内存上限的临时缓存
+ * @param[out] oStatistics 导出统计，可为NULL
+ * @param[in] iRoot 根瓦片，如BuildOctreeTiles的结果；为NULL时使用场景的瓦片集
+ * @note 没有有效外包盒和外包球的瓦片，以内容和子瓦片在场景坐标系中的轴对齐包围盒作为外包区域
+ */
+DftBool ExportSceneTiles(kernel::pdv::ISceneData* iSceneData, const std::string& iOutputDir, DftUInt iThreadCount = 0,
+    CGeometryCache* ioCache = NULL, TilesStatistics* oStatistics = NULL, const kernel::pdv::TileData* iRoot = NULL);
+
+#endif
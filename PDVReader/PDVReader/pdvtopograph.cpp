@@ -0,0 +1,385 @@
+#include "pdvtopograph.h"
+#include "pdvbreparchive.h"
+#include "PDVIBRep.h"
+#include "PDVITopo.h"
+#include <algorithm>
+#include <chrono>
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+DftDouble NowSeconds()
+{
+    return chrono::duration<DftDouble>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 面到边的邻接只穿过环和共边，不会经由边走到顶点，也不会走到其他面
+bool IsFaceEdgePath(DftUInt8 iType)
+{
+    return iType == TOPOTYPE_LOOP || iType == TOPOTYPE_COEDGE;
+}
+
+// 按行偏移把iRows中每行的各个值转置为按值分行，iRows按行号从小到大遍历，因此转置后每行有序
+void Transpose(const vector<DftUInt>& iOffsets, const vector<DftUInt>& iValues, DftUInt iCount,
+    vector<DftUInt>& oOffsets, vector<DftUInt>& oValues)
+{
+    oOffsets.assign(iCount + 1, 0);
+    for (size_t i = 0; i < iValues.size(); i++)
+        oOffsets[iValues[i] + 1]++;
+    for (DftUInt i = 0; i < iCount; i++)
+        oOffsets[i + 1] += oOffsets[i];
+
+    oValues.resize(iValues.size());
+    vector<DftUInt> cursor(oOffsets.begin(), oOffsets.end() - 1);
+    for (DftUInt row = 0; row + 1 < iOffsets.size(); row++)
+    {
+        for (DftUInt k = iOffsets[row]; k < iOffsets[row + 1]; k++)
+            oValues[cursor[iValues[k]]++] = row;
+    }
+}
+
+} // namespace
+
+CTopoGraph::CTopoGraph()
+{
+    Clear();
+}
+
+void CTopoGraph::Clear()
+{
+    m_IDs.clear();
+    m_Types.clear();
+    m_Orientations.clear();
+    m_GeometryTypes.clear();
+    m_GeometryIDs.clear();
+    m_Indexes.Clear();
+    m_RawChildIDs.clear();
+    m_Children.clear();
+    m_Parents.clear();
+    m_FaceEdges.clear();
+    m_EdgeFaces.clear();
+    m_Roots.clear();
+    // 行偏移始终比拓扑数多一个，空图的查询也不会越界
+    m_ChildOffsets.assign(1, 0);
+    m_ParentOffsets.assign(1, 0);
+    m_FaceEdgeOffsets.assign(1, 0);
+    m_EdgeFaceOffsets.assign(1, 0);
+}
+
+DftBool CTopoGraph::Build(IBRep* iBRep, TopoGraphStatistics* oStatistics)
+{
+    DftDouble start = NowSeconds();
+    Clear();
+    vector<ITopo*> topos;
+    if (!iBRep || iBRep->GetTopoArray(topos) != PDV_RESULT_NO_ERROR)
+        return FALSE;
+
+    size_t childCount = 0;
+    for (size_t i = 0; i < topos.size(); i++)
+    {
+        if (topos[i])
+            childCount += topos[i]->GetTopoIDs().size();
+    }
+    m_RawChildIDs.reserve(childCount);
+
+    for (size_t i = 0; i < topos.size(); i++)
+    {
+        ITopo* topo = topos[i];
+        if (!topo)
+            continue;
+        const vector<DftUInt64>& children = topo->GetTopoIDs();
+        AddTopo(topo->GetID(), topo->GetTopoType(), topo->GetOrientation(), topo->GetGeometryType(), topo->GetGeometryID(),
+            children.empty() ? NULL : &children[0], children.size());
+    }
+    Finish(oStatistics, start);
+    return TRUE;
+}
+
+DftBool CTopoGraph::Build(const CBRepArchiveReader& iReader, TopoGraphStatistics* oStatistics)
+{
+    DftDouble start = NowSeconds();
+    Clear();
+    for (DftUInt i = 0; i < iReader.GetTopoCount(); i++)
+    {
+        const BRepArchiveTopo& topo = iReader.GetTopo(i);
+        AddTopo(topo._id, topo._type, topo._orientation, topo._geometryType, topo._geometryID, iReader.GetChildIDs(topo),
+            topo._childCount);
+    }
+    Finish(oStatistics, start);
+    return TRUE;
+}
+
+void CTopoGraph::AddTopo(DftUInt64 iID, DftUInt8 iType, DftUInt8 iOrientation, DftUInt8 iGeometryType, DftUInt64 iGeometryID,
+    const DftUInt64* iChildIDs, size_t iChildCount)
+{
+    m_IDs.push_back(iID);
+    m_Types.push_back(iType);
+    m_Orientations.push_back(iOrientation);
+    m_GeometryTypes.push_back(iGeometryType);
+    m_GeometryIDs.push_back(iGeometryID);
+    if (iChildCount)
+        m_RawChildIDs.insert(m_RawChildIDs.end(), iChildIDs, iChildIDs + iChildCount);
+    m_ChildOffsets.push_back(static_cast<DftUInt>(m_RawChildIDs.size()));
+}
+
+void CTopoGraph::Finish(TopoGraphStatistics* oStatistics, DftDouble iStartSeconds)
+{
+    DftUInt count = GetCount();
+    TopoGraphStatistics statistics;
+    statistics._nodeCount = count;
+
+    // ID到序号，重复的ID保留第一个
+    m_Indexes.Reserve(count);
+    for (DftUInt i = 0; i < count; i++)
+    {
+        if (!m_Indexes.Insert(m_IDs[i], i))
+            statistics._duplicateIDCount++;
+    }
+
+    // 子拓扑ID原位换算为序号，m_ChildOffsets在追加时已按原始ID计好，剔除后重新压紧
+    m_Children.resize(m_RawChildIDs.size());
+    DftUInt write = 0;
+    for (DftUInt i = 0; i < count; i++)
+    {
+        DftUInt begin = m_ChildOffsets[i];
+        DftUInt end = m_ChildOffsets[i + 1];
+        m_ChildOffsets[i] = write;
+        for (DftUInt k = begin; k < end; k++)
+        {
+            DftUInt child = m_Indexes.Find(m_RawChildIDs[k]);
+            if (child == PDV_TOPO_INVALID_INDEX || child == i)
+            {
+                statistics._missingLinkCount++;
+                continue;
+            }
+            m_Children[write++] = child;
+        }
+    }
+    m_ChildOffsets[count] = write;
+    m_Children.resize(write);
+    vector<DftUInt64>().swap(m_RawChildIDs);
+
+    statistics._cycleLinkCount = RemoveCycles();
+    statistics._linkCount = m_Children.size();
+
+    Transpose(m_ChildOffsets, m_Children, count, m_ParentOffsets, m_Parents);
+    for (DftUInt i = 0; i < count; i++)
+    {
+        if (m_ParentOffsets[i + 1] == m_ParentOffsets[i])
+            m_Roots.push_back(i);
+    }
+    statistics._rootCount = static_cast<DftUInt>(m_Roots.size());
+
+    BuildFaceEdges();
+    statistics._faceEdgeCount = m_FaceEdges.size();
+
+    statistics._seconds = NowSeconds() - iStartSeconds;
+    if (oStatistics)
+        *oStatistics = statistics;
+}
+
+DftUInt64 CTopoGraph::RemoveCycles()
+{
+    // 三色深度优先：指向仍在栈上（灰色）拓扑的引用即为环上的回边，标记后统一剔除。
+    // 起点按拓扑类型从复合体到顶点排列，环总是在指向上级类型的引用处断开，如顶点误指向实体
+    const DftUInt8 WHITE = 0, GRAY = 1, BLACK = 2;
+    DftUInt count = GetCount();
+    vector<DftUInt> starts(count);
+    for (DftUInt i = 0; i < count; i++)
+        starts[i] = i;
+    const vector<DftUInt8>& types = m_Types;
+    stable_sort(starts.begin(), starts.end(), [&types](DftUInt iLeft, DftUInt iRight) {
+        // TOPOTYPE_NULL排在最后
+        return static_cast<DftUInt8>(types[iLeft] - 1) < static_cast<DftUInt8>(types[iRight] - 1);
+    });
+
+    vector<DftUInt8> colors(count, WHITE);
+    vector<pair<DftUInt, DftUInt> > stack; // 拓扑序号、下一个要访问的子拓扑位置
+    DftUInt64 removed = 0;
+
+    for (DftUInt s = 0; s < count; s++)
+    {
+        DftUInt start = starts[s];
+        if (colors[start] != WHITE)
+            continue;
+        colors[start] = GRAY;
+        stack.push_back(make_pair(start, m_ChildOffsets[start]));
+        while (!stack.empty())
+        {
+            DftUInt node = stack.back().first;
+            DftUInt& next = stack.back().second;
+            if (next == m_ChildOffsets[node + 1])
+            {
+                colors[node] = BLACK;
+                stack.pop_back();
+                continue;
+            }
+            DftUInt& child = m_Children[next++];
+            if (colors[child] == GRAY)
+            {
+                child = PDV_TOPO_INVALID_INDEX;
+                removed++;
+            }
+            else if (colors[child] == WHITE)
+            {
+                colors[child] = GRAY;
+                stack.push_back(make_pair(child, m_ChildOffsets[child]));
+            }
+        }
+    }
+
+    if (removed)
+    {
+        DftUInt write = 0;
+        for (DftUInt i = 0; i < count; i++)
+        {
+            DftUInt begin = m_ChildOffsets[i];
+            DftUInt end = m_ChildOffsets[i + 1];
+            m_ChildOffsets[i] = write;
+            for (DftUInt k = begin; k < end; k++)
+            {
+                if (m_Children[k] != PDV_TOPO_INVALID_INDEX)
+                    m_Children[write++] = m_Children[k];
+            }
+        }
+        m_ChildOffsets[count] = write;
+        m_Children.resize(write);
+    }
+    return removed;
+}
+
+void CTopoGraph::BuildFaceEdges()
+{
+    // 每个面从自己的子拓扑向下，只穿过环和共边；stamps记录拓扑最近一次被哪个面访问（序号加一），同一面内不重复
+    DftUInt count = GetCount();
+    vector<DftUInt> stamps(count, 0);
+    vector<DftUInt> stack;
+    m_FaceEdgeOffsets.assign(count + 1, 0);
+    m_FaceEdges.clear();
+
+    for (DftUInt face = 0; face < count; face++)
+    {
+        m_FaceEdgeOffsets[face] = static_cast<DftUInt>(m_FaceEdges.size());
+        if (m_Types[face] != TOPOTYPE_FACE)
+            continue;
+
+        // 逆序压栈，保持环、共边的原有顺序
+        for (DftUInt k = m_ChildOffsets[face + 1]; k > m_ChildOffsets[face]; k--)
+            stack.push_back(m_Children[k - 1]);
+        while (!stack.empty())
+        {
+            DftUInt node = stack.back();
+            stack.pop_back();
+            if (stamps[node] == face + 1)
+                continue;
+            stamps[node] = face + 1;
+
+            if (m_Types[node] == TOPOTYPE_EDGE)
+                m_FaceEdges.push_back(node);
+            else if (IsFaceEdgePath(m_Types[node]))
+            {
+                for (DftUInt k = m_ChildOffsets[node + 1]; k > m_ChildOffsets[node]; k--)
+                    stack.push_back(m_Children[k - 1]);
+            }
+        }
+    }
+    m_FaceEdgeOffsets[count] = static_cast<DftUInt>(m_FaceEdges.size());
+
+    Transpose(m_FaceEdgeOffsets, m_FaceEdges, count, m_EdgeFaceOffsets, m_EdgeFaces);
+}
+
+void CTopoGraph::CollectDescendants(DftUInt iIndex, DftUInt8 iType, vector<DftUInt>& oIndexes) const
+{
+    oIndexes.clear();
+    if (iIndex >= GetCount())
+        return;
+
+    // 共享的下级拓扑只展开一次；序号加一作为键，避开DFT_INVALID_ID
+    CIdSlotMap visited;
+    vector<DftUInt> stack(1, iIndex);
+    visited.Insert(static_cast<DftUInt64>(iIndex) + 1, iIndex);
+    while (!stack.empty())
+    {
+        DftUInt node = stack.back();
+        stack.pop_back();
+        for (DftUInt k = m_ChildOffsets[node]; k < m_ChildOffsets[node + 1]; k++)
+        {
+            DftUInt child = m_Children[k];
+            if (!visited.Insert(static_cast<DftUInt64>(child) + 1, child))
+                continue;
+            if (m_Types[child] == iType)
+                oIndexes.push_back(child);
+            else
+                stack.push_back(child);
+        }
+    }
+    sort(oIndexes.begin(), oIndexes.end());
+}
+
+void CTopoGraph::CollectAncestors(DftUInt iIndex, DftUInt8 iType, vector<DftUInt>& oIndexes) const
+{
+    oIndexes.clear();
+    if (iIndex >= GetCount())
+        return;
+
+    CIdSlotMap visited;
+    vector<DftUInt> stack(1, iIndex);
+    visited.Insert(static_cast<DftUInt64>(iIndex) + 1, iIndex);
+    while (!stack.empty())
+    {
+        DftUInt node = stack.back();
+        stack.pop_back();
+        for (DftUInt k = m_ParentOffsets[node]; k < m_ParentOffsets[node + 1]; k++)
+        {
+            DftUInt parent = m_Parents[k];
+            if (!visited.Insert(static_cast<DftUInt64>(parent) + 1, parent))
+                continue;
+            if (m_Types[parent] == iType)
+                oIndexes.push_back(parent);
+            else
+                stack.push_back(parent);
+        }
+    }
+    sort(oIndexes.begin(), oIndexes.end());
+}
+
+void CTopoGraph::CollectAdjacentFaces(DftUInt iFace, vector<DftUInt>& oFaces) const
+{
+    oFaces.clear();
+    if (iFace >= GetCount())
+        return;
+
+    for (DftUInt k = m_FaceEdgeOffsets[iFace]; k < m_FaceEdgeOffsets[iFace + 1]; k++)
+    {
+        DftUInt edge = m_FaceEdges[k];
+        for (DftUInt j = m_EdgeFaceOffsets[edge]; j < m_EdgeFaceOffsets[edge + 1]; j++)
+        {
+            if (m_EdgeFaces[j] != iFace)
+                oFaces.push_back(m_EdgeFaces[j]);
+        }
+    }
+    sort(oFaces.begin(), oFaces.end());
+    oFaces.erase(unique(oFaces.begin(), oFaces.end()), oFaces.end());
+}
+
+void CTopoGraph::Traverse(DftUInt iIndex, ITopoVisitor& ioVisitor) const
+{
+    if (iIndex >= GetCount())
+        return;
+
+    // 建立时已剔除环，沿路径展开必然结束；逆序压栈使子拓扑按原有顺序访问
+    vector<pair<DftUInt, DftUInt> > stack(1, make_pair(iIndex, 0u)); // 拓扑序号、深度
+    while (!stack.empty())
+    {
+        DftUInt node = stack.back().first;
+        DftUInt depth = stack.back().second;
+        stack.pop_back();
+        if (!ioVisitor.OnTopo(*this, node, depth))
+            continue;
+        for (DftUInt k = m_ChildOffsets[node + 1]; k > m_ChildOffsets[node]; k--)
+            stack.push_back(make_pair(m_Children[k - 1], depth + 1));
+    }
+}
@@ -0,0 +1,201 @@
+/**
+ * @file pdvtopograph.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：BRep拓扑的稠密序号邻接图
+ * @details 拓扑对象按输入顺序编为稠密序号，ITopo::GetTopoIDs在一次遍历中按原始ID连续存放，全部读完后经CIdSlotMap
+ *          换算为序号，得到压缩稀疏行（CSR）格式的子拓扑表；父拓扑表由子拓扑表计数转置得到。
+ *          找不到的子拓扑、指向自身的引用和构成环的引用在建立时剔除，之后的遍历都用显式栈，不会递归，也不会死循环。
+ *          面到边、边到面的邻接同样以CSR存放：每个面沿环、共边向下找到边为止，同一条边在一个面中只记一次。
+ *          建立后只读，查询可在多个线程中同时调用。
+ */
+
+#ifndef PDVTOPOGRAPH_H
+#define PDVTOPOGRAPH_H
+
+#include "DftBase.h"
+#include "pdvsceneindex.h"
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+class IBRep;
+} // namespace pdv
+} // namespace kernel
+
+class CBRepArchiveReader;
+class CTopoGraph;
+
+/** @brief 无效的拓扑序号 */
+#define PDV_TOPO_INVALID_INDEX 0xFFFFFFFFu
+
+/** @brief 拓扑图统计 */
+struct TopoGraphStatistics
+{
+    DftUInt _nodeCount;          ///< 拓扑数
+    DftUInt64 _linkCount;        ///< 保留的父子引用数
+    DftUInt64 _missingLinkCount; ///< 剔除的找不到或指向自身的引用数
+    DftUInt64 _cycleLinkCount;   ///< 剔除的构成环的引用数
+    DftUInt _duplicateIDCount;   ///< ID重复（或为DFT_INVALID_ID）而无法按ID查找的拓扑数
+    DftUInt _rootCount;          ///< 没有父拓扑的拓扑数
+    DftUInt64 _faceEdgeCount;    ///< 面与边的邻接数
+    DftDouble _seconds;          ///< 建立耗时
+
+    TopoGraphStatistics()
+        : _nodeCount(0), _linkCount(0), _missingLinkCount(0), _cycleLinkCount(0), _duplicateIDCount(0), _rootCount(0),
+          _faceEdgeCount(0), _seconds(0.0) {}
+};
+
+/** @brief 拓扑遍历的访问接口 */
+class ITopoVisitor
+{
+public:
+    virtual ~ITopoVisitor() {}
+
+    /**
+     * @brief 访问一个拓扑
+     * @return DftBool 是否继续访问其子拓扑
+     * @param[in] iGraph 拓扑图
+     * @param[in] iIndex 拓扑序号
+     * @param[in] iDepth 相对遍历起点的深度，起点为0
+     */
+    virtual DftBool OnTopo(const CTopoGraph& iGraph, DftUInt iIndex, DftUInt iDepth) = 0;
+};
+
+/** @brief BRep拓扑的邻接图 */
+class CTopoGraph
+{
+public:
+    CTopoGraph();
+
+    /**
+     * @brief 由IBRep的拓扑数组建立
+     * @return DftBool 是否成功，iBRep为NULL或取不到拓扑数组时为FALSE
+     * @param[in] iBRep BRep对象
+     * @param[out] oStatistics 统计，可为NULL
+     */
+    DftBool Build(kernel::pdv::IBRep* iBRep, TopoGraphStatistics* oStatistics = NULL);
+
+    /**
+     * @brief 由已打开的BRep存档的拓扑表建立
+     * @return DftBool 是否成功
+     * @param[in] iReader 存档读取对象
+     * @param[out] oStatistics 统计，可为NULL
+     */
+    DftBool Build(const CBRepArchiveReader& iReader, TopoGraphStatistics* oStatistics = NULL);
+
+    /** @brief 清空 */
+    void Clear();
+
+    /** @brief 拓扑数 */
+    DftUInt GetCount() const { return static_cast<DftUInt>(m_IDs.size()); }
+    /** @brief 拓扑ID */
+    DftUInt64 GetID(DftUInt iIndex) const { return m_IDs[iIndex]; }
+    /** @brief 拓扑类型，见TOPOTYPE */
+    DftUInt8 GetType(DftUInt iIndex) const { return m_Types[iIndex]; }
+    /** @brief 拓扑方向，见ORIENTATION */
+    DftUInt8 GetOrientation(DftUInt iIndex) const { return m_Orientations[iIndex]; }
+    /** @brief 关联的几何类型，见GEOMTYPE */
+    DftUInt8 GetGeometryType(DftUInt iIndex) const { return m_GeometryTypes[iIndex]; }
+    /** @brief 关联的几何ID */
+    DftUInt64 GetGeometryID(DftUInt iIndex) const { return m_GeometryIDs[iIndex]; }
+
+    /**
+     * @brief 按ID查找拓扑
+     * @return DftUInt 拓扑序号，不存在时为PDV_TOPO_INVALID_INDEX
+     * @param[in] iID 拓扑ID
+     */
+    DftUInt Find(DftUInt64 iID) const { return m_Indexes.Find(iID); }
+
+    /** @brief 子拓扑数 */
+    DftUInt GetChildCount(DftUInt iIndex) const { return m_ChildOffsets[iIndex + 1] - m_ChildOffsets[iIndex]; }
+    /** @brief 子拓扑序号，按GetTopoIDs中的顺序 */
+    const DftUInt* GetChildren(DftUInt iIndex) const { return GetRow(m_ChildOffsets, m_Children, iIndex); }
+    /** @brief 父拓扑数 */
+    DftUInt GetParentCount(DftUInt iIndex) const { return m_ParentOffsets[iIndex + 1] - m_ParentOffsets[iIndex]; }
+    /** @brief 父拓扑序号，按序号从小到大 */
+    const DftUInt* GetParents(DftUInt iIndex) const { return GetRow(m_ParentOffsets, m_Parents, iIndex); }
+
+    /** @brief 面所含的边数，iIndex不是面时为0 */
+    DftUInt GetFaceEdgeCount(DftUInt iIndex) const { return m_FaceEdgeOffsets[iIndex + 1] - m_FaceEdgeOffsets[iIndex]; }
+    /** @brief 面所含的边，按环、共边的顺序 */
+    const DftUInt* GetFaceEdges(DftUInt iIndex) const { return GetRow(m_FaceEdgeOffsets, m_FaceEdges, iIndex); }
+    /** @brief 使用边的面数，iIndex不是边时为0 */
+    DftUInt GetEdgeFaceCount(DftUInt iIndex) const { return m_EdgeFaceOffsets[iIndex + 1] - m_EdgeFaceOffsets[iIndex]; }
+    /** @brief 使用边的面，按序号从小到大 */
+    const DftUInt* GetEdgeFaces(DftUInt iIndex) const { return GetRow(m_EdgeFaceOffsets, m_EdgeFaces, iIndex); }
+
+    /** @brief 没有父拓扑的拓扑，按序号从小到大 */
+    const std::vector<DftUInt>& GetRoots() const { return m_Roots; }
+
+    /**
+     * @brief 收集指定类型的下级拓扑，如实体的面、面的边、边的顶点
+     * @param[in] iIndex 起点拓扑
+     * @param[in] iType 拓扑类型，见TOPOTYPE
+     * @param[out] oIndexes 去重后按序号从小到大的结果，不含起点
+     * @note 遇到iType类型的拓扑后不再向下查找
+     */
+    void CollectDescendants(DftUInt iIndex, DftUInt8 iType, std::vector<DftUInt>& oIndexes) const;
+
+    /**
+     * @brief 收集指定类型的上级拓扑，如面所在的实体、边所在的面
+     * @param[in] iIndex 起点拓扑
+     * @param[in] iType 拓扑类型，见TOPOTYPE
+     * @param[out] oIndexes 去重后按序号从小到大的结果，不含起点
+     * @note 遇到iType类型的拓扑后不再向上查找
+     */
+    void CollectAncestors(DftUInt iIndex, DftUInt8 iType, std::vector<DftUInt>& oIndexes) const;
+
+    /**
+     * @brief 收集与面共边的其他面
+     * @param[in] iFace 面的序号
+     * @param[out] oFaces 去重后按序号从小到大的结果，不含iFace
+     */
+    void CollectAdjacentFaces(DftUInt iFace, std::vector<DftUInt>& oFaces) const;
+
+    /**
+     * @brief 从iIndex开始按先序深度优先遍历
+     * @param[in] iIndex 起点拓扑
+     * @param[in,out] ioVisitor 访问对象
+     * @note 被多个父拓扑引用的拓扑在每条路径上各访问一次，与按层次打印的结果一致
+     */
+    void Traverse(DftUInt iIndex, ITopoVisitor& ioVisitor) const;
+
+private:
+    /** CSR中一行的首地址，空行为NULL */
+    static const DftUInt* GetRow(const std::vector<DftUInt>& iOffsets, const std::vector<DftUInt>& iValues, DftUInt iIndex)
+    {
+        return iOffsets[iIndex + 1] > iOffsets[iIndex] ? &iValues[iOffsets[iIndex]] : NULL;
+    }
+
+    /** 追加一个拓扑，子拓扑ID暂存在m_RawChildIDs中 */
+    void AddTopo(DftUInt64 iID, DftUInt8 iType, DftUInt8 iOrientation, DftUInt8 iGeometryType, DftUInt64 iGeometryID,
+        const DftUInt64* iChildIDs, size_t iChildCount);
+    /** 全部拓扑追加后建立索引、子拓扑表、父拓扑表和面边邻接 */
+    void Finish(TopoGraphStatistics* oStatistics, DftDouble iStartSeconds);
+    /** 剔除构成环的子拓扑引用 */
+    DftUInt64 RemoveCycles();
+    /** 建立面到边、边到面的邻接 */
+    void BuildFaceEdges();
+
+    std::vector<DftUInt64> m_IDs;            ///< 拓扑ID
+    std::vector<DftUInt8> m_Types;           ///< 拓扑类型
+    std::vector<DftUInt8> m_Orientations;    ///< 拓扑方向
+    std::vector<DftUInt8> m_GeometryTypes;   ///< 关联的几何类型
+    std::vector<DftUInt64> m_GeometryIDs;    ///< 关联的几何ID
+    CIdSlotMap m_Indexes;                    ///< 拓扑ID到序号
+    std::vector<DftUInt64> m_RawChildIDs;    ///< 建立过程中按原始ID存放的子拓扑
+    std::vector<DftUInt> m_ChildOffsets;     ///< 子拓扑表的行偏移，共GetCount()+1个
+    std::vector<DftUInt> m_Children;         ///< 子拓扑表
+    std::vector<DftUInt> m_ParentOffsets;    ///< 父拓扑表的行偏移
+    std::vector<DftUInt> m_Parents;          ///< 父拓扑表
+    std::vector<DftUInt> m_FaceEdgeOffsets;  ///< 面到边的行偏移
+    std::vector<DftUInt> m_FaceEdges;        ///< 面到边
+    std::vector<DftUInt> m_EdgeFaceOffsets;  ///< 边到面的行偏移
+    std::vector<DftUInt> m_EdgeFaces;        ///< 边到面
+    std::vector<DftUInt> m_Roots;            ///< 没有父拓扑的拓扑
+};
+
+#endif
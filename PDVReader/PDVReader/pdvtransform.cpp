@@ -0,0 +1,206 @@
+#include "pdvtransform.h"
+#include "pdvprofiler.h"
+#include <algorithm>
+#include <cstddef>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PDV_TRANSFORM_X86 1
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#define PDV_TARGET_AVX2
+#else
+#define PDV_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+using namespace kernel::pdv;
+
+namespace
+{
+
+// 检测CPU与操作系统支持的最高内核
+TransformKernel DetectTransformKernel()
+{
+#if defined(PDV_TRANSFORM_X86)
+#ifdef _MSC_VER
+    int info[4] = { 0, 0, 0, 0 };
+    __cpuid(info, 0);
+    int maxLeaf = info[0];
+    __cpuid(info, 1);
+    if ((info[3] & (1 << 25)) == 0)
+        return TRANSFORM_KERNEL_SCALAR;
+    // AVX2需要OSXSAVE且操作系统保存了YMM寄存器
+    bool osAvx = (info[2] & (1 << 27)) && (info[2] & (1 << 28)) && ((_xgetbv(0) & 0x6) == 0x6);
+    if (osAvx && maxLeaf >= 7)
+    {
+        __cpuidex(info, 7, 0);
+        if (info[1] & (1 << 5))
+            return TRANSFORM_KERNEL_AVX2;
+    }
+    return TRANSFORM_KERNEL_SSE;
+#else
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return TRANSFORM_KERNEL_AVX2;
+    if (__builtin_cpu_supports("sse"))
+        return TRANSFORM_KERNEL_SSE;
+    return TRANSFORM_KERNEL_SCALAR;
+#endif
+#else
+    return TRANSFORM_KERNEL_SCALAR;
+#endif
+}
+
+TransformKernel& CurrentKernel()
+{
+    static TransformKernel s_kernel = DetectTransformKernel();
+    return s_kernel;
+}
+
+// 标量实现，运算顺序与SIMD实现保持一致，保证结果逐位相同
+void TransformScalar(const DftByte* iSrc, size_t iStride, size_t iCount, const DftFloat (*m)[4], bool iTranslate, DftFloat* oDst)
+{
+    for (size_t i = 0; i < iCount; i++)
+    {
+        const DftFloat* p = reinterpret_cast<const DftFloat*>(iSrc + i * iStride);
+        DftFloat* d = oDst + i * PDV_TRANSFORM_STRIDE;
+        for (int c = 0; c < 4; c++)
+        {
+            DftFloat v = p[0] * m[0][c] + p[1] * m[1][c] + p[2] * m[2][c];
+            if (iTranslate)
+                v += m[3][c];
+            d[c] = v;
+        }
+    }
+}
+
+#if defined(PDV_TRANSFORM_X86)
+// SSE实现：每个点广播xyz后与矩阵各行相乘累加，一次写出4个float
+void TransformSSE(const DftByte* iSrc, size_t iStride, size_t iCount, const DftFloat (*m)[4], bool iTranslate, DftFloat* oDst)
+{
+    const __m128 r0 = _mm_loadu_ps(m[0]);
+    const __m128 r1 = _mm_loadu_ps(m[1]);
+    const __m128 r2 = _mm_loadu_ps(m[2]);
+    const __m128 r3 = iTranslate ? _mm_loadu_ps(m[3]) : _mm_setzero_ps();
+    for (size_t i = 0; i < iCount; i++)
+    {
+        const DftFloat* p = reinterpret_cast<const DftFloat*>(iSrc + i * iStride);
+        __m128 v = _mm_mul_ps(_mm_set1_ps(p[0]), r0);
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(p[1]), r1));
+        v = _mm_add_ps(v, _mm_mul_ps(_mm_set1_ps(p[2]), r2));
+        if (iTranslate)
+            v = _mm_add_ps(v, r3);
+        _mm_storeu_ps(oDst + i * PDV_TRANSFORM_STRIDE, v);
+    }
+}
+
+// AVX2实现：两个点共用一个256位寄存器，每次写出8个float
+PDV_TARGET_AVX2 void TransformAVX2(const DftByte* iSrc, size_t iStride, size_t iCount, const DftFloat (*m)[4], bool iTranslate,
+    DftFloat* oDst)
+{
+    const __m256 r0 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m[0]));
+    const __m256 r1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m[1]));
+    const __m256 r2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m[2]));
+    const __m256 r3 = iTranslate ? _mm256_broadcast_ps(reinterpret_cast<const __m128*>(m[3])) : _mm256_setzero_ps();
+    size_t i = 0;
+    for (; i + 2 <= iCount; i += 2)
+    {
+        const DftFloat* p0 = reinterpret_cast<const DftFloat*>(iSrc + i * iStride);
+        const DftFloat* p1 = reinterpret_cast<const DftFloat*>(iSrc + (i + 1) * iStride);
+        __m256 x = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(p0[0])), _mm_set1_ps(p1[0]), 1);
+        __m256 y = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(p0[1])), _mm_set1_ps(p1[1]), 1);
+        __m256 z = _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_set1_ps(p0[2])), _mm_set1_ps(p1[2]), 1);
+        __m256 v = _mm256_mul_ps(x, r0);
+        v = _mm256_add_ps(v, _mm256_mul_ps(y, r1));
+        v = _mm256_add_ps(v, _mm256_mul_ps(z, r2));
+        if (iTranslate)
+            v = _mm256_add_ps(v, r3);
+        _mm256_storeu_ps(oDst + i * PDV_TRANSFORM_STRIDE, v);
+    }
+    if (i < iCount)
+        TransformSSE(iSrc + i * iStride, iStride, iCount - i, m, iTranslate, oDst + i * PDV_TRANSFORM_STRIDE);
+}
+#endif
+
+void Transform(const void* iSrc, size_t iStride, size_t iCount, const PDVMatrix4F& iMatrix, bool iTranslate, DftFloat* oDst)
+{
+    if (iCount == 0)
+        return;
+    const DftByte* src = static_cast<const DftByte*>(iSrc);
+    switch (CurrentKernel())
+    {
+#if defined(PDV_TRANSFORM_X86)
+    case TRANSFORM_KERNEL_AVX2:
+        TransformAVX2(src, iStride, iCount, iMatrix._data, iTranslate, oDst);
+        break;
+    case TRANSFORM_KERNEL_SSE:
+        TransformSSE(src, iStride, iCount, iMatrix._data, iTranslate, oDst);
+        break;
+#endif
+    default:
+        TransformScalar(src, iStride, iCount, iMatrix._data, iTranslate, oDst);
+        break;
+    }
+}
+
+} // namespace
+
+TransformKernel GetTransformKernel()
+{
+    return CurrentKernel();
+}
+
+void SetTransformKernel(TransformKernel iKernel)
+{
+    TransformKernel detected = DetectTransformKernel();
+    CurrentKernel() = iKernel < detected ? iKernel : detected;
+}
+
+void TransformPoints3F(const void* iSrc, size_t iStride, size_t iCount, const PDVMatrix4F& iMatrix, DftFloat* oDst)
+{
+    Transform(iSrc, iStride, iCount, iMatrix, true, oDst);
+}
+
+void TransformVectors3F(const void* iSrc, size_t iStride, size_t iCount, const PDVMatrix4F& iMatrix, DftFloat* oDst)
+{
+    Transform(iSrc, iStride, iCount, iMatrix, false, oDst);
+}
+
+void TransformVertexData(const std::vector<VertexData>& iVertexes, const PDVMatrix4F& iMatrix, TransformedVertexes& oResult)
+{
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_TRANSFORM);
+    size_t count = iVertexes.size();
+    oResult._count = static_cast<DftUInt>(count);
+    oResult._positions.resize(count * PDV_TRANSFORM_STRIDE);
+    oResult._normals.resize(count * PDV_TRANSFORM_STRIDE);
+    if (count == 0)
+        return;
+
+    const DftByte* base = reinterpret_cast<const DftByte*>(&iVertexes[0]);
+    TransformPoints3F(base + offsetof(VertexData, _position), sizeof(VertexData), count, iMatrix, &oResult._positions[0]);
+    TransformVectors3F(base + offsetof(VertexData, _normal), sizeof(VertexData), count, iMatrix, &oResult._normals[0]);
+}
+
+void TransformVertexes(const StridedSpan<PDVVector3F>& iPositions, const StridedSpan<PDVVector3F>& iNormals,
+    const PDVMatrix4F& iMatrix, TransformedVertexes& oResult)
+{
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_TRANSFORM);
+    size_t count = iPositions.Size();
+    oResult._count = static_cast<DftUInt>(count);
+    oResult._positions.resize(count * PDV_TRANSFORM_STRIDE);
+    oResult._normals.resize(count * PDV_TRANSFORM_STRIDE);
+    if (count == 0)
+        return;
+
+    TransformPoints3F(iPositions.Data(), iPositions.Stride(), count, iMatrix, &oResult._positions[0]);
+    if (iNormals.Size() < count)
+        std::fill(oResult._normals.begin(), oResult._normals.end(), 0.0f);
+    else
+        TransformVectors3F(iNormals.Data(), iNormals.Stride(), count, iMatrix, &oResult._normals[0]);
+}
+
+void TransformVertexView(const CVertexView& iView, const PDVMatrix4F& iMatrix, TransformedVertexes& oResult)
+{
+    TransformVertexes(iView.GetPositions(), iView.GetNormals(), iMatrix, oResult);
+}
@@ -0,0 +1,102 @@
+/**
+ * @file pdvtransform.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：顶点数组的批量矩阵变换
+ * @details 每个渲染几何体的顶点只变换一次，三角面再按索引从变换结果中取值。
+ *          内核按CPU能力选择AVX2/SSE实现，不支持时退回标量实现。
+ *          矩阵约定与DftTransformPoint3F一致：行向量右乘矩阵，平移位于第4行。
+ */
+
+#ifndef PDVTRANSFORM_H
+#define PDVTRANSFORM_H
+
+#include "pdvvertexview.h"
+#include <vector>
+
+/** @brief 变换结果中每个顶点占用的float个数（xyz + 1个填充位，便于向量化整行写入） */
+#define PDV_TRANSFORM_STRIDE 4
+
+/** @brief 变换内核的指令集 */
+enum TransformKernel
+{
+    TRANSFORM_KERNEL_SCALAR = 0, ///< 标量实现
+    TRANSFORM_KERNEL_SSE = 1,    ///< SSE实现
+    TRANSFORM_KERNEL_AVX2 = 2,   ///< AVX2实现
+};
+
+/** @brief 变换后的顶点数据，位置与法向均按PDV_TRANSFORM_STRIDE间隔存放 */
+struct TransformedVertexes
+{
+    std::vector<DftFloat> _positions; ///< 变换后的顶点坐标
+    std::vector<DftFloat> _normals;   ///< 变换后的法向
+    DftUInt _count;                   ///< 顶点个数
+
+    TransformedVertexes() : _count(0) {}
+
+    /** 第iIndex个顶点的坐标 */
+    const DftFloat* Position(DftUInt iIndex) const { return &_positions[iIndex * PDV_TRANSFORM_STRIDE]; }
+    /** 第iIndex个顶点的法向 */
+    const DftFloat* Normal(DftUInt iIndex) const { return &_normals[iIndex * PDV_TRANSFORM_STRIDE]; }
+};
+
+/**
+ * @brief 获取当前使用的变换内核
+ * @return TransformKernel 按CPU能力选择的内核
+ */
+TransformKernel GetTransformKernel();
+
+/**
+ * @brief 强制使用指定的变换内核，用于性能对比和结果校验
+ * @param[in] iKernel 内核，超出CPU能力时自动降级
+ */
+void SetTransformKernel(TransformKernel iKernel);
+
+/**
+ * @brief 批量变换点（包含平移）
+ * @param[in] iSrc 第一个点的地址，每个点为连续的3个float
+ * @param[in] iStride 相邻两个点之间的字节间隔
+ * @param[in] iCount 点的个数
+ * @param[in] iMatrix 变换矩阵
+ * @param[out] oDst 输出地址，容量不少于iCount * PDV_TRANSFORM_STRIDE个float
+ */
+void TransformPoints3F(const void* iSrc, size_t iStride, size_t iCount, const PDVMatrix4F& iMatrix, DftFloat* oDst);
+
+/**
+ * @brief 批量变换向量（不包含平移）
+ * @param[in] iSrc 第一个向量的地址，每个向量为连续的3个float
+ * @param[in] iStride 相邻两个向量之间的字节间隔
+ * @param[in] iCount 向量的个数
+ * @param[in] iMatrix 变换矩阵
+ * @param[out] oDst 输出地址，容量不少于iCount * PDV_TRANSFORM_STRIDE个float
+ */
+void TransformVectors3F(const void* iSrc, size_t iStride, size_t iCount, const PDVMatrix4F& iMatrix, DftFloat* oDst);
+
+/**
+ * @brief 将一组顶点的位置与法向整体变换到世界坐标系
+ * @param[in] iVertexes 顶点数据
+ * @param[in] iMatrix 变换矩阵
+ * @param[out] oResult 变换结果，重复使用同一对象可避免反复分配内存
+ */
+void TransformVertexData(const std::vector<kernel::pdv::VertexData>& iVertexes, const PDVMatrix4F& iMatrix,
+    TransformedVertexes& oResult);
+
+/**
+ * @brief 将按字节间隔存放的坐标与法向整体变换到世界坐标系
+ * @param[in] iPositions 顶点坐标
+ * @param[in] iNormals 顶点法向，为空时变换结果中的法向为0
+ * @param[in] iMatrix 变换矩阵
+ * @param[out] oResult 变换结果
+ */
+void TransformVertexes(const StridedSpan<PDVVector3F>& iPositions, const StridedSpan<PDVVector3F>& iNormals,
+    const PDVMatrix4F& iMatrix, TransformedVertexes& oResult);
+
+/**
+ * @brief 将顶点视图中的坐标与法向整体变换到世界坐标系
+ * @param[in] iView 顶点视图
+ * @param[in] iMatrix 变换矩阵
+ * @param[out] oResult 变换结果，视图中不包含法向时法向为0
+ */
+void TransformVertexView(const CVertexView& iView, const PDVMatrix4F& iMatrix, TransformedVertexes& oResult);
+
+#endif
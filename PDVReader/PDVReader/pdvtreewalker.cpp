@@ -0,0 +1,347 @@
+#include "pdvtreewalker.h"
+#include "PDVISceneData.h"
+#include "PDVIModelTree.h"
+#include "PDVIModelTreeNode.h"
+#include "PDVIModel.h"
+#include "PDVIAttribute.h"
+#include "PDVIAttributeGroup.h"
+#include "PDVIAttributeItem.h"
+#include "PDVIAnnotation.h"
+#include "PDVIAnnotationItem.h"
+#include "pdvprofiler.h"
+#include "pdvtextformat.h"
+#include <stack>
+
+using namespace std;
+using namespace kernel::pdv;
+
+CNodeContext::CNodeContext(IModelTreeNode* iNode, DftUInt64 iParentID, int iDepth)
+    : m_Node(iNode)
+    , m_Model(NULL)
+    , m_ID(iNode->GetID())
+    , m_ParentID(iParentID)
+    , m_Depth(iDepth)
+    , m_HasModel(iNode->GetModelFlag() ? true : false)
+    , m_Fetched(NODE_FIELD_NONE)
+    , m_HasWorldTransform(false)
+    , m_Visible(false)
+{
+    if (m_HasModel)
+        m_Model = iNode->GetModel();
+}
+
+void CNodeContext::Fetch(DftUInt iFields)
+{
+    DftUInt missing = iFields & ~m_Fetched;
+    if (missing == NODE_FIELD_NONE)
+        return;
+    m_Fetched |= missing;
+
+    if (missing & NODE_FIELD_NAME)
+    {
+        CUnicodeString nodeName;
+        m_Node->GetName(nodeName);
+        m_Name = nodeName.ToMultiByte();
+    }
+    if (missing & NODE_FIELD_TRANSFORM)
+    {
+        // 优先使用世界变换，没有时依次退回局部变换和单位矩阵
+        m_HasWorldTransform = m_Node->GetWorldTransform(m_WorldTransform) == PDV_RESULT_NO_ERROR;
+        if (!m_HasWorldTransform || !m_Node->GetWorldTransformFlag())
+        {
+            if (!m_Node->GetLocalTransformFlag() || m_Node->GetLocalTransform(m_WorldTransform) != PDV_RESULT_NO_ERROR)
+                m_WorldTransform.SetIdentity();
+        }
+    }
+    if (missing & NODE_FIELD_VISIBLE)
+        m_Visible = m_Node->GetVisible() ? true : false;
+    if ((missing & NODE_FIELD_MODEL_NAME) && m_Model)
+    {
+        CUnicodeString modelName;
+        m_Model->GetName(modelName);
+        m_ModelName = modelName.ToMultiByte();
+    }
+    if ((missing & NODE_FIELD_ATTRIBUTES) && m_Model)
+    {
+        IAttribute* attr = m_Model->GetAttribute();
+        if (attr)
+            CollectAttributes(attr, m_Attributes);
+    }
+    if ((missing & NODE_FIELD_PMI) && m_Model)
+    {
+        IAnnotation* annotation = m_Model->GetAnnotation();
+        if (annotation)
+            CollectPMIData(annotation, m_PMIData);
+    }
+}
+
+const string& CNodeContext::GetName()
+{
+    Fetch(NODE_FIELD_NAME);
+    return m_Name;
+}
+
+const PDVMatrix4F& CNodeContext::GetWorldTransform()
+{
+    Fetch(NODE_FIELD_TRANSFORM);
+    return m_WorldTransform;
+}
+
+bool CNodeContext::HasWorldTransform()
+{
+    Fetch(NODE_FIELD_TRANSFORM);
+    return m_HasWorldTransform;
+}
+
+bool CNodeContext::GetVisible()
+{
+    Fetch(NODE_FIELD_VISIBLE);
+    return m_Visible;
+}
+
+const string& CNodeContext::GetModelName()
+{
+    Fetch(NODE_FIELD_MODEL_NAME);
+    return m_ModelName;
+}
+
+const map<string, string>& CNodeContext::GetAttributes()
+{
+    Fetch(NODE_FIELD_ATTRIBUTES);
+    return m_Attributes;
+}
+
+const vector<NodePMIData>& CNodeContext::GetPMIData()
+{
+    Fetch(NODE_FIELD_PMI);
+    return m_PMIData;
+}
+
+void CModelTreeWalker::AddSink(INodeSink* iSink)
+{
+    if (iSink)
+        m_Sinks.push_back(iSink);
+}
+
+void CModelTreeWalker::Walk(ISceneData* iSceneData)
+{
+    if (!iSceneData)
+        return;
+
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_TRAVERSAL);
+
+    // 所有输出对象需要的字段合并后一次读取
+    DftUInt fields = NODE_FIELD_NONE;
+    for (size_t s = 0; s < m_Sinks.size(); s++)
+        fields |= m_Sinks[s]->GetRequiredFields();
+
+    std::vector<IModelTree*> modelTreeArray;
+    iSceneData->GetModelTreeArray(modelTreeArray);
+    for (size_t s = 0; s < m_Sinks.size(); s++)
+        m_Sinks[s]->OnBegin(iSceneData, modelTreeArray);
+
+    for (DftUInt t = 0; t < modelTreeArray.size(); t++)
+    {
+        IModelTree* tree = modelTreeArray[t];
+        if (!tree)
+            continue;
+        for (size_t s = 0; s < m_Sinks.size(); s++)
+            m_Sinks[s]->OnTree(tree);
+
+        IModelTreeNode* rootNode = NULL;
+        if (tree->GetRootNode(rootNode) != PDV_RESULT_NO_ERROR || !rootNode)
+            continue;
+
+        // 使用栈进行非递归深度优先遍历，栈中保存节点、深度和父节点ID
+        stack<pair<pair<IModelTreeNode*, int>, DftUInt64> > nodeStack;
+        nodeStack.push(make_pair(make_pair(rootNode, 0), (DftUInt64)0));
+        std::vector<IModelTreeNode*> children;
+        while (!nodeStack.empty())
+        {
+            IModelTreeNode* currentNode = nodeStack.top().first.first;
+            int depth = nodeStack.top().first.second;
+            DftUInt64 parentID = nodeStack.top().second;
+            nodeStack.pop();
+
+            CNodeContext context(currentNode, parentID, depth);
+            context.Fetch(fields);
+            PDV_PROFILE_COUNT(PROFILE_COUNTER_NODES, 1);
+            for (size_t s = 0; s < m_Sinks.size(); s++)
+                m_Sinks[s]->OnNode(context);
+
+            // 反向添加子节点以保证原始顺序
+            children.clear();
+            if (currentNode->GetChildren(children) == PDV_RESULT_NO_ERROR)
+            {
+                for (int i = static_cast<int>(children.size()) - 1; i >= 0; i--)
+                {
+                    if (children[i])
+                        nodeStack.push(make_pair(make_pair(children[i], depth + 1), context.GetID()));
+                }
+            }
+        }
+    }
+
+    for (size_t s = 0; s < m_Sinks.size(); s++)
+        m_Sinks[s]->OnEnd();
+}
+
+void CollectPMIData(IAnnotation* annotation, vector<NodePMIData>& pmiData)
+{
+    if (!annotation) return;
+
+    DftUInt itemCount = annotation->GetAnnotationItemCount();
+    CTextBuilder text;
+
+    for (DftUInt i = 0; i < itemCount; i++)
+    {
+        IAnnotationItem* item = annotation->GetAnnotationItemByIndex(i);
+        if (!item) continue;
+
+        NodePMIData pmi;
+        pmi.annotationID = item->GetID();
+
+        // 获取标注项类型  
+        CUnicodeString itemType = item->GetType();
+        pmi.annotationType = itemType.ToMultiByte();
+
+        // 获取标注项名称  
+        CUnicodeString itemName;
+        if (item->GetName(itemName) == PDV_RESULT_NO_ERROR)
+        {
+            pmi.annotationName = itemName.ToMultiByte();
+        }
+
+        // 获取显示模式  
+        DftUInt8 viewMode = item->GetFaceViewMode();
+        switch (viewMode)
+        {
+        case ANNOTATIONVIEWMODE_DEFAULTVIEW:
+            pmi.viewMode = "Default View";
+            break;
+        case ANNOTATIONVIEWMODE_PARALLELSCREEN:
+            pmi.viewMode = "Parallel Screen";
+            break;
+        case ANNOTATIONVIEWMODE_FIXEDSCREEN:
+            pmi.viewMode = "Fixed Screen";
+            break;
+        default:
+            pmi.viewMode = "Unknown";
+            break;
+        }
+
+        // 收集其他PMI属性  
+        DftUInt64 renderBodyID = item->GetRenderBodyID();
+        if (renderBodyID != 0)
+        {
+            text.Clear();
+            pmi.properties["RenderBodyID"] = text.AppendUInt(renderBodyID).GetText();
+        }
+
+        RGBColor triangleColor = item->GetTriangleColor();
+        text.Clear();
+        text.Append("RGB(").AppendInt(triangleColor._red).Append(',')
+            .AppendInt(triangleColor._green).Append(',')
+            .AppendInt(triangleColor._blue).Append(')');
+        pmi.properties["TriangleColor"] = text.GetText();
+
+        pmiData.push_back(pmi);
+    }
+}
+
+void CollectAttributes(IAttribute* attr, map<string, string>& attributes)
+{
+    if (!attr) return;
+
+    // 数值直接格式化到复用的缓冲中：整数与to_string相同，单双精度浮点与to_string的"%f"相同，矢量分量与流的默认输出相同  
+    CTextBuilder text;
+
+    std::vector<IAttributeGroup*> attributeGroups;
+    if (attr->GetAttributeGroupArray(attributeGroups) == PDV_RESULT_NO_ERROR)
+    {
+        for (DftUInt i = 0; i < attributeGroups.size(); i++)
+        {
+            IAttributeGroup* group = attributeGroups[i];
+            if (!group) continue;
+
+            std::vector<IAttributeItem*> attributeItems;
+            if (group->GetAttributeItemArray(attributeItems) == PDV_RESULT_NO_ERROR)
+            {
+                for (DftUInt j = 0; j < attributeItems.size(); j++)
+                {
+                    IAttributeItem* item = attributeItems[j];
+                    if (!item) continue;
+
+                    CUnicodeString key;
+                    if (item->GetKey(key) == PDV_RESULT_NO_ERROR)
+                    {
+                        string keyStr = key.ToMultiByte();
+                        text.Clear();
+
+                        DftUInt valueType = item->GetValueType();
+                        switch (valueType)
+                        {
+                        case DATATYPE_BOOL:
+                        {
+                            DftBool boolValue;
+                            if (item->GetBoolean(boolValue) == PDV_RESULT_NO_ERROR)
+                                text.Append(boolValue ? "true" : "false");
+                        }
+                        break;
+                        case DATATYPE_INT32:
+                        {
+                            DftInt intValue;
+                            if (item->GetInteger(intValue) == PDV_RESULT_NO_ERROR)
+                                text.AppendInt(intValue);
+                        }
+                        break;
+                        case DATATYPE_FLOAT:
+                        {
+                            DftFloat floatValue;
+                            if (item->GetFloat(floatValue) == PDV_RESULT_NO_ERROR)
+                                text.AppendFixed(floatValue);
+                        }
+                        break;
+                        case DATATYPE_DOUBLE:
+                        {
+                            DftDouble doubleValue;
+                            if (item->GetDouble(doubleValue) == PDV_RESULT_NO_ERROR)
+                                text.AppendFixed(doubleValue);
+                        }
+                        break;
+                        case DATATYPE_STRING:
+                        {
+                            CUnicodeString stringValue;
+                            if (item->GetString(stringValue) == PDV_RESULT_NO_ERROR)
+                                text.Append(stringValue.ToMultiByte());
+                        }
+                        break;
+                        case DATATYPE_VECTOR3F:
+                        {
+                            PDVVector3F vectorValue;
+                            if (item->GetVectorFloat3(vectorValue) == PDV_RESULT_NO_ERROR)
+                            {
+                                text.Append('(').AppendGeneral(vectorValue.x()).Append(',').AppendGeneral(vectorValue.y())
+                                    .Append(',').AppendGeneral(vectorValue.z()).Append(')');
+                            }
+                        }
+                        break;
+                        case DATATYPE_VECTOR3D:
+                        {
+                            PDVVector3D vectorValue;
+                            if (item->GetVectorDouble3(vectorValue) == PDV_RESULT_NO_ERROR)
+                            {
+                                text.Append('(').AppendGeneral(vectorValue.x()).Append(',').AppendGeneral(vectorValue.y())
+                                    .Append(',').AppendGeneral(vectorValue.z()).Append(')');
+                            }
+                        }
+                        break;
+                        }
+
+                        attributes[keyStr] = text.GetText();
+                    }
+                }
+            }
+        }
+    }
+}
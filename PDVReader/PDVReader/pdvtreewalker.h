@@ -0,0 +1,178 @@
+/**
+ * @file pdvtreewalker.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：模型树的单次遍历
+ * @details 所有模型树按深度优先顺序只遍历一次，每个节点依次分发给注册的输出对象（CSV、BRep存档、节点STL、控制台信息等）。
+ *          输出对象声明自己需要的节点字段，字段在第一次使用时读取并缓存，同一节点上的各输出对象共用，不重复调用接口和转换编码。
+ */
+
+#ifndef PDVTREEWALKER_H
+#define PDVTREEWALKER_H
+
+#include "DftBase.h"
+#include "PDVMath.h"
+#include <map>
+#include <string>
+#include <vector>
+
+namespace kernel
+{
+namespace pdv
+{
+class ISceneData;
+class IModelTree;
+class IModelTreeNode;
+class IModel;
+class IAttribute;
+class IAnnotation;
+} // namespace pdv
+} // namespace kernel
+
+/** @brief 节点字段，输出对象据此声明需要读取的数据 */
+enum NodeField
+{
+    NODE_FIELD_NONE = 0x00,        ///< 不需要额外字段
+    NODE_FIELD_NAME = 0x01,        ///< 节点名称
+    NODE_FIELD_TRANSFORM = 0x02,   ///< 世界变换
+    NODE_FIELD_VISIBLE = 0x04,     ///< 可见性
+    NODE_FIELD_MODEL_NAME = 0x08,  ///< 模型名称
+    NODE_FIELD_ATTRIBUTES = 0x10,  ///< 属性表（键值对）
+    NODE_FIELD_PMI = 0x20,         ///< PMI标注
+    NODE_FIELD_ALL = 0x3F,         ///< 全部字段
+};
+
+/** @brief 一条PMI标注 */
+struct NodePMIData
+{
+    DftUInt64 annotationID;
+    std::string annotationType;
+    std::string annotationName;
+    std::string viewMode;
+    std::map<std::string, std::string> properties;
+};
+
+/** @brief 遍历中的当前节点，字段在第一次访问时读取 */
+class CNodeContext
+{
+public:
+    CNodeContext(kernel::pdv::IModelTreeNode* iNode, DftUInt64 iParentID, int iDepth);
+
+    /** @brief 节点 */
+    kernel::pdv::IModelTreeNode* GetNode() const { return m_Node; }
+    /** @brief 节点ID */
+    DftUInt64 GetID() const { return m_ID; }
+    /** @brief 父节点ID，根节点为0 */
+    DftUInt64 GetParentID() const { return m_ParentID; }
+    /** @brief 节点深度，根节点为0 */
+    int GetDepth() const { return m_Depth; }
+    /** @brief 节点是否关联模型 */
+    bool HasModel() const { return m_HasModel; }
+    /** @brief 关联的模型，未关联或获取失败时为NULL */
+    kernel::pdv::IModel* GetModel() const { return m_Model; }
+
+    /** @brief 节点名称（多字节编码） */
+    const std::string& GetName();
+    /** @brief 世界变换，节点没有世界变换时依次退回局部变换和单位矩阵 */
+    const PDVMatrix4F& GetWorldTransform();
+    /** @brief 节点是否直接带有世界变换 */
+    bool HasWorldTransform();
+    /** @brief 可见性 */
+    bool GetVisible();
+    /** @brief 模型名称（多字节编码），未关联模型时为空 */
+    const std::string& GetModelName();
+    /** @brief 模型属性表 */
+    const std::map<std::string, std::string>& GetAttributes();
+    /** @brief 模型PMI标注 */
+    const std::vector<NodePMIData>& GetPMIData();
+
+    /**
+     * @brief 按字段掩码预先读取字段
+     * @param[in] iFields NodeField的组合
+     */
+    void Fetch(DftUInt iFields);
+
+private:
+    kernel::pdv::IModelTreeNode* m_Node;            ///< 节点
+    kernel::pdv::IModel* m_Model;                   ///< 关联的模型
+    DftUInt64 m_ID;                                 ///< 节点ID
+    DftUInt64 m_ParentID;                           ///< 父节点ID
+    int m_Depth;                                    ///< 深度
+    bool m_HasModel;                                ///< 是否关联模型
+    DftUInt m_Fetched;                              ///< 已读取的字段
+    std::string m_Name;                             ///< 节点名称
+    PDVMatrix4F m_WorldTransform;                   ///< 世界变换
+    bool m_HasWorldTransform;                       ///< 是否直接带有世界变换
+    bool m_Visible;                                 ///< 可见性
+    std::string m_ModelName;                        ///< 模型名称
+    std::map<std::string, std::string> m_Attributes; ///< 属性表
+    std::vector<NodePMIData> m_PMIData;             ///< PMI标注
+};
+
+/** @brief 遍历的输出对象 */
+class INodeSink
+{
+public:
+    virtual ~INodeSink() {}
+
+    /** @brief 需要的节点字段，NodeField的组合 */
+    virtual DftUInt GetRequiredFields() const = 0;
+
+    /**
+     * @brief 遍历开始
+     * @param[in] iSceneData 场景数据
+     * @param[in] iTrees 所有模型树
+     */
+    virtual void OnBegin(kernel::pdv::ISceneData* /*iSceneData*/, const std::vector<kernel::pdv::IModelTree*>& /*iTrees*/) {}
+
+    /**
+     * @brief 开始遍历一棵模型树
+     * @param[in] iTree 模型树
+     */
+    virtual void OnTree(kernel::pdv::IModelTree* /*iTree*/) {}
+
+    /**
+     * @brief 访问一个节点，节点按深度优先先序到达
+     * @param[in,out] ioNode 当前节点
+     */
+    virtual void OnNode(CNodeContext& ioNode) = 0;
+
+    /** @brief 遍历结束 */
+    virtual void OnEnd() {}
+};
+
+/** @brief 模型树遍历器 */
+class CModelTreeWalker
+{
+public:
+    /**
+     * @brief 注册输出对象，节点按注册顺序分发
+     * @param[in] iSink 输出对象，由调用方管理生命周期
+     */
+    void AddSink(INodeSink* iSink);
+
+    /**
+     * @brief 遍历场景中的所有模型树
+     * @param[in] iSceneData 场景数据
+     */
+    void Walk(kernel::pdv::ISceneData* iSceneData);
+
+private:
+    std::vector<INodeSink*> m_Sinks; ///< 输出对象
+};
+
+/**
+ * @brief 收集属性表中的键值对
+ * @param[in] iAttribute 属性
+ * @param[out] oAttributes 键值对
+ */
+void CollectAttributes(kernel::pdv::IAttribute* iAttribute, std::map<std::string, std::string>& oAttributes);
+
+/**
+ * @brief 收集PMI标注信息
+ * @param[in] iAnnotation 标注
+ * @param[out] oPMIData 标注信息
+ */
+void CollectPMIData(kernel::pdv::IAnnotation* iAnnotation, std::vector<NodePMIData>& oPMIData);
+
+#endif
@@ -0,0 +1,150 @@
+#include "pdvvertexstreams.h"
+#include "pdvprofiler.h"
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PDV_VERTEX_STREAMS_SSE 1
+#include <xmmintrin.h>
+#endif
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+void DeinterleaveScalar(const DftByte* iSrc, size_t iStride, size_t iBegin, size_t iEnd, int iComponents, DftFloat* const* oDst)
+{
+    for (size_t i = iBegin; i < iEnd; i++)
+    {
+        const DftFloat* p = reinterpret_cast<const DftFloat*>(iSrc + i * iStride);
+        for (int c = 0; c < iComponents; c++)
+            oDst[c][i] = p[c];
+    }
+}
+
+// 把按字节间隔存放的2或3个float拆分到各分量数组
+void Deinterleave(const void* iSrc, size_t iStride, size_t iCount, int iComponents, vector<DftFloat>* oDst)
+{
+    DftFloat* dst[3] = { NULL, NULL, NULL };
+    for (int c = 0; c < iComponents; c++)
+    {
+        oDst[c].resize(iCount);
+        if (iCount)
+            dst[c] = &oDst[c][0];
+    }
+
+    const DftByte* src = static_cast<const DftByte*>(iSrc);
+    size_t i = 0;
+#if defined(PDV_VERTEX_STREAMS_SSE)
+    // 每条记录读入16字节，多读的部分落在记录余下的分量或下一条记录中，因此每组之后至少还要有一条记录
+    for (; i + 4 < iCount; i += 4)
+    {
+        __m128 r0 = _mm_loadu_ps(reinterpret_cast<const DftFloat*>(src + i * iStride));
+        __m128 r1 = _mm_loadu_ps(reinterpret_cast<const DftFloat*>(src + (i + 1) * iStride));
+        __m128 r2 = _mm_loadu_ps(reinterpret_cast<const DftFloat*>(src + (i + 2) * iStride));
+        __m128 r3 = _mm_loadu_ps(reinterpret_cast<const DftFloat*>(src + (i + 3) * iStride));
+        _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+        _mm_storeu_ps(dst[0] + i, r0);
+        _mm_storeu_ps(dst[1] + i, r1);
+        if (iComponents > 2)
+            _mm_storeu_ps(dst[2] + i, r2);
+    }
+#endif
+    DeinterleaveScalar(src, iStride, i, iCount, iComponents, dst);
+}
+
+void ExtractColors(const StridedSpan<RGBColor>& iColors, const StridedSpan<DftUInt8>& iOpacities, vector<DftFloat>* oDst)
+{
+    const DftFloat scale = 1.0f / 255.0f;
+    size_t count = iColors.Size();
+    for (int c = 0; c < 4; c++)
+        oDst[c].resize(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        const RGBColor& color = iColors[i];
+        oDst[0][i] = color._red * scale;
+        oDst[1][i] = color._green * scale;
+        oDst[2][i] = color._blue * scale;
+        oDst[3][i] = iOpacities[i] * scale;
+    }
+}
+
+void ClearStreams(vector<DftFloat>* ioStreams, int iComponents)
+{
+    for (int c = 0; c < iComponents; c++)
+        ioStreams[c].clear();
+}
+
+} // namespace
+
+size_t VertexStreams::GetByteSize() const
+{
+    size_t count = 0;
+    for (int c = 0; c < 3; c++)
+        count += _positions[c].size() + _normals[c].size();
+    for (int c = 0; c < 2; c++)
+        count += _uvs[c].size();
+    for (int c = 0; c < 4; c++)
+        count += _colors[c].size();
+    return count * sizeof(DftFloat);
+}
+
+DftBool ExtractVertexStreams(const CVertexView& iView, DftUInt8 iRequest, VertexStreams& ioStreams)
+{
+    ioStreams._count = iView.GetCount();
+    ioStreams._mask = RENDER_VERTEX_MASK_NULL;
+
+    const StridedSpan<PDVVector3F>& positions = iView.GetPositions();
+    if ((iRequest & RENDER_VERTEX_MASK_POSITION) && positions.Size() == ioStreams._count)
+    {
+        Deinterleave(positions.Data(), positions.Stride(), positions.Size(), 3, ioStreams._positions);
+        ioStreams._mask |= RENDER_VERTEX_MASK_POSITION;
+    }
+    else
+        ClearStreams(ioStreams._positions, 3);
+
+    const StridedSpan<PDVVector3F>& normals = iView.GetNormals();
+    if ((iRequest & RENDER_VERTEX_MASK_NORMAL) && normals.Size() == ioStreams._count && !normals.Empty())
+    {
+        Deinterleave(normals.Data(), normals.Stride(), normals.Size(), 3, ioStreams._normals);
+        ioStreams._mask |= RENDER_VERTEX_MASK_NORMAL;
+    }
+    else
+        ClearStreams(ioStreams._normals, 3);
+
+    const StridedSpan<PDVVector2F>& uvs = iView.GetUVs();
+    if ((iRequest & RENDER_VERTEX_MASK_UV) && uvs.Size() == ioStreams._count && !uvs.Empty())
+    {
+        Deinterleave(uvs.Data(), uvs.Stride(), uvs.Size(), 2, ioStreams._uvs);
+        ioStreams._mask |= RENDER_VERTEX_MASK_UV;
+    }
+    else
+        ClearStreams(ioStreams._uvs, 2);
+
+    const StridedSpan<RGBColor>& colors = iView.GetColors();
+    if ((iRequest & RENDER_VERTEX_MASK_COLOR_OPACITY) && colors.Size() == ioStreams._count && !colors.Empty())
+    {
+        ExtractColors(colors, iView.GetOpacities(), ioStreams._colors);
+        ioStreams._mask |= RENDER_VERTEX_MASK_COLOR_OPACITY;
+    }
+    else
+        ClearStreams(ioStreams._colors, 4);
+
+    return ioStreams._count > 0 ? TRUE : FALSE;
+}
+
+DftBool ExtractVertexStreams(IRenderVertex* iVertex, DftUInt8 iRequest, VertexStreams& ioStreams)
+{
+    static thread_local CVertexView view;
+
+    PDV_PROFILE_SCOPE(PROFILE_PHASE_VERTEX_FETCH);
+    if (!view.Attach(iVertex))
+    {
+        ioStreams._count = 0;
+        ioStreams._mask = RENDER_VERTEX_MASK_NULL;
+        return FALSE;
+    }
+    PDV_PROFILE_COUNT(PROFILE_COUNTER_VERTEXES, view.GetCount());
+    ExtractVertexStreams(view, iRequest, ioStreams);
+    return TRUE;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file pdvvertexstreams.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：按标识位把顶点分量提取为分量数组（SoA）
+ * @details VertexData把坐标、法向、UV、颜色、透明度和索引放在一条记录里，GetVertexes总是完整拷贝出整条记录，
+ *          即使标识位表明UV、颜色与透明度并不存在。这里根据调用者请求的分量与数据的标识位取交集，
+ *          只把需要的分量按x、y、z等各自写入紧密排列的float数组，不请求或不存在的分量不读取也不分配。
+ *          坐标、法向与UV在x86上用SSE一次读入4条记录后转置拆分，其他平台使用标量实现。
+ */
+
+#ifndef PDVVERTEXSTREAMS_H
+#define PDVVERTEXSTREAMS_H
+
+#include "pdvvertexview.h"
+#include <vector>
+
+/** @brief 提取全部浮点分量（坐标、法向、UV、颜色与透明度） */
+#define PDV_VERTEX_STREAMS_ALL \
+    (kernel::pdv::RENDER_VERTEX_MASK_POSITION | kernel::pdv::RENDER_VERTEX_MASK_NORMAL | \
+        kernel::pdv::RENDER_VERTEX_MASK_UV | kernel::pdv::RENDER_VERTEX_MASK_COLOR_OPACITY)
+
+/** @brief 按分量分别存放的顶点数据，对象可重复使用以复用数组内存 */
+struct VertexStreams
+{
+    DftUInt _count;                       ///< 顶点个数
+    DftUInt8 _mask;                       ///< 实际提取的分量，为请求分量与数据标识位的交集
+    std::vector<DftFloat> _positions[3];  ///< 顶点坐标的x、y、z分量
+    std::vector<DftFloat> _normals[3];    ///< 顶点法向的x、y、z分量
+    std::vector<DftFloat> _uvs[2];        ///< 纹理坐标的u、v分量
+    std::vector<DftFloat> _colors[4];     ///< 颜色的r、g、b分量与透明度，取值范围[0, 1]
+
+    VertexStreams() : _count(0), _mask(kernel::pdv::RENDER_VERTEX_MASK_NULL) {}
+
+    /** 是否包含指定分量 */
+    DftBool Has(DftUInt8 iAttribute) const { return (_mask & iAttribute) == iAttribute ? TRUE : FALSE; }
+
+    /** 提取结果占用的字节数，不含预留的容量 */
+    size_t GetByteSize() const;
+};
+
+/**
+ * @brief 从顶点视图中提取分量
+ * @return DftBool 视图是否包含顶点
+ * @param[in] iView 已关联顶点数据的视图
+ * @param[in] iRequest 请求的分量，RENDER_VERTEX_MASK_*的组合，索引分量忽略
+ * @param[out] ioStreams 提取结果，未提取的分量数组被清空但保留容量
+ */
+DftBool ExtractVertexStreams(const CVertexView& iView, DftUInt8 iRequest, VertexStreams& ioStreams);
+
+/**
+ * @brief 从顶点数据中提取分量
+ * @return DftBool 是否成功
+ * @param[in] iVertex 顶点数据
+ * @param[in] iRequest 请求的分量，RENDER_VERTEX_MASK_*的组合，索引分量忽略
+ * @param[out] ioStreams 提取结果
+ */
+DftBool ExtractVertexStreams(kernel::pdv::IRenderVertex* iVertex, DftUInt8 iRequest, VertexStreams& ioStreams);
+
+#endif
@@ -0,0 +1,196 @@
+#include "pdvvertexview.h"
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+using namespace std;
+using namespace kernel::pdv;
+
+namespace
+{
+
+/** 顶点数据流的记录布局 */
+enum VertexLayout
+{
+    VERTEX_LAYOUT_UNKNOWN = 0, ///< 尚未确认
+    VERTEX_LAYOUT_STRUCT = 1,  ///< 与VertexData结构体相同
+    VERTEX_LAYOUT_PACKED = 2,  ///< 按标识位只保存存在的分量，紧密排列
+    VERTEX_LAYOUT_COPY = 3,    ///< 无法确认，退回GetVertexes拷贝
+};
+
+struct LayoutDesc
+{
+    size_t _stride;        ///< 记录长度
+    size_t _normalOffset;  ///< 法向在记录中的偏移
+    size_t _uvOffset;      ///< UV在记录中的偏移
+    size_t _colorOffset;   ///< 颜色在记录中的偏移
+    size_t _opacityOffset; ///< 透明度在记录中的偏移
+};
+
+// 紧密排列时各分量的长度：坐标12、法向12、UV 8、颜色与透明度4、索引4
+LayoutDesc GetPackedLayout(DftUInt8 iMask)
+{
+    LayoutDesc desc;
+    desc._stride = 0;
+    if (iMask & RENDER_VERTEX_MASK_POSITION)
+        desc._stride += sizeof(PDVVector3F);
+    desc._normalOffset = desc._stride;
+    if (iMask & RENDER_VERTEX_MASK_NORMAL)
+        desc._stride += sizeof(PDVVector3F);
+    desc._uvOffset = desc._stride;
+    if (iMask & RENDER_VERTEX_MASK_UV)
+        desc._stride += sizeof(PDVVector2F);
+    desc._colorOffset = desc._stride;
+    desc._opacityOffset = desc._stride + sizeof(RGBColor);
+    if (iMask & RENDER_VERTEX_MASK_COLOR_OPACITY)
+        desc._stride += sizeof(RGBColor) + sizeof(DftUInt8);
+    if (iMask & RENDER_VERTEX_MASK_INDEX)
+        desc._stride += sizeof(DftUInt32);
+    return desc;
+}
+
+LayoutDesc GetLayoutDesc(VertexLayout iLayout, DftUInt8 iMask)
+{
+    if (iLayout == VERTEX_LAYOUT_PACKED)
+        return GetPackedLayout(iMask);
+    LayoutDesc desc;
+    desc._stride = sizeof(VertexData);
+    desc._normalOffset = offsetof(VertexData, _normal);
+    desc._uvOffset = offsetof(VertexData, _uv);
+    desc._colorOffset = offsetof(VertexData, _color);
+    desc._opacityOffset = offsetof(VertexData, _opacity);
+    return desc;
+}
+
+// 只有长度恰为顶点数乘记录长度的字节数时才直接访问；长度为顶点个数时无法确定实际分配的大小，退回拷贝
+bool SizeMatches(DftUInt32 iSize, DftUInt iCount, size_t iStride)
+{
+    return static_cast<size_t>(iSize) == static_cast<size_t>(iCount) * iStride;
+}
+
+bool LayoutMatches(const DftByte* iBuffer, const vector<VertexData>& iVertexes, const LayoutDesc& iDesc, DftUInt8 iMask)
+{
+    for (size_t i = 0; i < iVertexes.size(); i++)
+    {
+        const DftByte* record = iBuffer + i * iDesc._stride;
+        const VertexData& vertex = iVertexes[i];
+        if (memcmp(record, &vertex._position, sizeof(PDVVector3F)) != 0)
+            return false;
+        if ((iMask & RENDER_VERTEX_MASK_NORMAL) && memcmp(record + iDesc._normalOffset, &vertex._normal, sizeof(PDVVector3F)) != 0)
+            return false;
+        if ((iMask & RENDER_VERTEX_MASK_UV) && memcmp(record + iDesc._uvOffset, &vertex._uv, sizeof(PDVVector2F)) != 0)
+            return false;
+        if ((iMask & RENDER_VERTEX_MASK_COLOR_OPACITY) &&
+            (record[iDesc._colorOffset] != vertex._color._red || record[iDesc._colorOffset + 1] != vertex._color._green ||
+                record[iDesc._colorOffset + 2] != vertex._color._blue || record[iDesc._opacityOffset] != vertex._opacity))
+            return false;
+    }
+    return true;
+}
+
+// 每种标识位对应的布局，第一次遇到时确认
+atomic<unsigned char> g_Layouts[256];
+
+} // namespace
+
+CVertexView::CVertexView()
+    : m_Count(0)
+    , m_Mask(RENDER_VERTEX_MASK_NULL)
+    , m_ZeroCopy(FALSE)
+{
+}
+
+DftBool CVertexView::Attach(IRenderVertex* iVertex)
+{
+    m_Positions = StridedSpan<PDVVector3F>();
+    m_Normals = StridedSpan<PDVVector3F>();
+    m_UVs = StridedSpan<PDVVector2F>();
+    m_Colors = StridedSpan<RGBColor>();
+    m_Opacities = StridedSpan<DftUInt8>();
+    m_Count = 0;
+    m_Mask = RENDER_VERTEX_MASK_NULL;
+    m_ZeroCopy = FALSE;
+    if (!iVertex)
+        return FALSE;
+
+    m_Mask = iVertex->GetVertexMask();
+    m_Count = iVertex->GetVertexCount();
+    bool hasNormal = (m_Mask & RENDER_VERTEX_MASK_NORMAL) != 0;
+    if (!(m_Mask & RENDER_VERTEX_MASK_POSITION) || m_Count == 0)
+        return AttachCopy(iVertex);
+
+    DftByte* buffer = NULL;
+    DftUInt32 size = 0;
+    if (iVertex->GetVertexesBuffer(buffer, size) != PDV_RESULT_NO_ERROR || !buffer)
+        return AttachCopy(iVertex);
+
+    VertexLayout layout = static_cast<VertexLayout>(g_Layouts[m_Mask].load(memory_order_relaxed));
+    if (layout == VERTEX_LAYOUT_COPY)
+        return AttachCopy(iVertex);
+
+    if (layout == VERTEX_LAYOUT_UNKNOWN)
+    {
+        // 用一次拷贝的结果确认数据流布局，之后同一标识位的数据都直接访问
+        if (!AttachCopy(iVertex))
+            return FALSE;
+        layout = VERTEX_LAYOUT_COPY;
+        const VertexLayout candidates[] = { VERTEX_LAYOUT_PACKED, VERTEX_LAYOUT_STRUCT };
+        for (size_t c = 0; c < sizeof(candidates) / sizeof(candidates[0]); c++)
+        {
+            LayoutDesc desc = GetLayoutDesc(candidates[c], m_Mask);
+            if (m_Copy.size() == m_Count && SizeMatches(size, m_Count, desc._stride) &&
+                LayoutMatches(buffer, m_Copy, desc, m_Mask))
+            {
+                layout = candidates[c];
+                break;
+            }
+        }
+        g_Layouts[m_Mask].store(static_cast<unsigned char>(layout), memory_order_relaxed);
+        return TRUE;
+    }
+
+    LayoutDesc desc = GetLayoutDesc(layout, m_Mask);
+    if (!SizeMatches(size, m_Count, desc._stride))
+        return AttachCopy(iVertex);
+
+    m_Positions = StridedSpan<PDVVector3F>(buffer, desc._stride, m_Count);
+    if (hasNormal)
+        m_Normals = StridedSpan<PDVVector3F>(buffer + desc._normalOffset, desc._stride, m_Count);
+    AttachOptional(buffer, desc._stride, desc._uvOffset, desc._colorOffset, desc._opacityOffset);
+    m_ZeroCopy = TRUE;
+    return TRUE;
+}
+
+DftBool CVertexView::AttachCopy(IRenderVertex* iVertex)
+{
+    m_Copy.clear();
+    if (iVertex->GetVertexes(m_Copy) != PDV_RESULT_NO_ERROR)
+    {
+        m_Count = 0;
+        return FALSE;
+    }
+    m_Count = static_cast<DftUInt>(m_Copy.size());
+    if (m_Count == 0)
+        return TRUE;
+
+    const DftByte* base = reinterpret_cast<const DftByte*>(&m_Copy[0]);
+    m_Positions = StridedSpan<PDVVector3F>(base + offsetof(VertexData, _position), sizeof(VertexData), m_Count);
+    if (m_Mask & RENDER_VERTEX_MASK_NORMAL)
+        m_Normals = StridedSpan<PDVVector3F>(base + offsetof(VertexData, _normal), sizeof(VertexData), m_Count);
+    AttachOptional(base, sizeof(VertexData), offsetof(VertexData, _uv), offsetof(VertexData, _color),
+        offsetof(VertexData, _opacity));
+    return TRUE;
+}
+
+void CVertexView::AttachOptional(const DftByte* iBase, size_t iStride, size_t iUVOffset, size_t iColorOffset,
+    size_t iOpacityOffset)
+{
+    // 标识位中不存在的分量在拷贝结果中只是默认值，不提供给调用者
+    if (m_Mask & RENDER_VERTEX_MASK_UV)
+        m_UVs = StridedSpan<PDVVector2F>(iBase + iUVOffset, iStride, m_Count);
+    if (m_Mask & RENDER_VERTEX_MASK_COLOR_OPACITY)
+    {
+        m_Colors = StridedSpan<RGBColor>(iBase + iColorOffset, iStride, m_Count);
+        m_Opacities = StridedSpan<DftUInt8>(iBase + iOpacityOffset, iStride, m_Count);
+    }
+}
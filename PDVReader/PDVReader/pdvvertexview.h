@@ -0,0 +1,96 @@
+/**
+ * @file pdvvertexview.h
+ * @version 1.0
+ * @date 2026-10-18
+ * @brief 概述：渲染顶点数据的只读视图
+ * @details 通过GetVertexesBuffer与GetVertexMask直接在顶点数据流上按字节间隔访问坐标、法向、UV与颜色，不再拷贝出VertexData数组。
+ *          数据流的记录布局在每种标识位第一次出现时与GetVertexes的结果比对确认，无法确认或数据流长度不是记录长度的整数倍时退回拷贝方式。
+ */
+
+#ifndef PDVVERTEXVIEW_H
+#define PDVVERTEXVIEW_H
+
+#include "PDVIRenderVertex.h"
+#include <vector>
+
+/** @brief 按固定字节间隔访问的只读数组 */
+template <typename T>
+class StridedSpan
+{
+public:
+    StridedSpan() : m_Data(NULL), m_Stride(sizeof(T)), m_Count(0) {}
+    StridedSpan(const void* iData, size_t iStride, size_t iCount)
+        : m_Data(static_cast<const DftByte*>(iData)), m_Stride(iStride), m_Count(iCount) {}
+
+    /** 第iIndex个元素 */
+    const T& operator[](size_t iIndex) const { return *reinterpret_cast<const T*>(m_Data + iIndex * m_Stride); }
+
+    /** 第一个元素的地址 */
+    const void* Data() const { return m_Data; }
+    /** 相邻元素之间的字节间隔 */
+    size_t Stride() const { return m_Stride; }
+    /** 元素个数 */
+    size_t Size() const { return m_Count; }
+    /** 是否为空 */
+    DftBool Empty() const { return m_Count == 0 ? TRUE : FALSE; }
+
+private:
+    const DftByte* m_Data; ///< 第一个元素的地址
+    size_t m_Stride;       ///< 元素间的字节间隔
+    size_t m_Count;        ///< 元素个数
+};
+
+/** @brief 渲染顶点数据视图，对象可重复Attach以复用退回拷贝时的内存 */
+class CVertexView
+{
+public:
+    CVertexView();
+
+    /**
+     * @brief 关联顶点数据
+     * @return DftBool 是否成功
+     * @param[in] iVertex 顶点数据
+     * @note 视图在顶点数据被修改或释放之前有效
+     */
+    DftBool Attach(kernel::pdv::IRenderVertex* iVertex);
+
+    /** @brief 顶点个数 */
+    DftUInt GetCount() const { return m_Count; }
+
+    /** @brief 顶点标识位 */
+    DftUInt8 GetMask() const { return m_Mask; }
+
+    /** @brief 顶点坐标 */
+    const StridedSpan<PDVVector3F>& GetPositions() const { return m_Positions; }
+
+    /** @brief 顶点法向，标识位中不包含法向时为空 */
+    const StridedSpan<PDVVector3F>& GetNormals() const { return m_Normals; }
+
+    /** @brief 纹理坐标，标识位中不包含UV时为空 */
+    const StridedSpan<PDVVector2F>& GetUVs() const { return m_UVs; }
+
+    /** @brief 顶点颜色，标识位中不包含颜色时为空 */
+    const StridedSpan<kernel::pdv::RGBColor>& GetColors() const { return m_Colors; }
+
+    /** @brief 透明度，与颜色同时存在 */
+    const StridedSpan<DftUInt8>& GetOpacities() const { return m_Opacities; }
+
+    /** @brief 是否直接引用了顶点数据流（否则为拷贝） */
+    DftBool IsZeroCopy() const { return m_ZeroCopy; }
+
+private:
+    DftBool AttachCopy(kernel::pdv::IRenderVertex* iVertex);
+    void AttachOptional(const DftByte* iBase, size_t iStride, size_t iUVOffset, size_t iColorOffset, size_t iOpacityOffset);
+
+    std::vector<kernel::pdv::VertexData> m_Copy; ///< 退回拷贝方式时的顶点数据
+    StridedSpan<PDVVector3F> m_Positions;        ///< 顶点坐标
+    StridedSpan<PDVVector3F> m_Normals;          ///< 顶点法向
+    StridedSpan<PDVVector2F> m_UVs;              ///< 纹理坐标
+    StridedSpan<kernel::pdv::RGBColor> m_Colors; ///< 顶点颜色
+    StridedSpan<DftUInt8> m_Opacities;           ///< 透明度
+    DftUInt m_Count;                             ///< 顶点个数
+    DftUInt8 m_Mask;                             ///< 顶点标识位
+    DftBool m_ZeroCopy;                          ///< 是否直接引用数据流
+};
+
+#endif